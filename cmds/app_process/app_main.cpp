@@ -335,6 +335,14 @@ int main(int argc, char* const argv[])
     if (zygote) {
         runtime.start("com.android.internal.os.ZygoteInit", args, zygote);
     } else if (className) {
+        // Non-zygote invocations (the am/pm shell wrappers and other tools)
+        // pay full runtime startup here on every call. Don't try to fix that
+        // at this layer with a pre-initialized template process: forking a
+        // started VM is only safe under the ZygoteHooks pre/post-fork
+        // discipline that the zygote's Java side drives, which is why the
+        // zygote is the template process. Callers that need fast startup
+        // should go through the zygote or a cmd binder service instead of a
+        // fresh app_process.
         runtime.start("com.android.internal.os.RuntimeInit", args, zygote);
     } else {
         fprintf(stderr, "Error: no class name or --zygote supplied.\n");
@@ -43,6 +43,10 @@ static int usage(int /* argc */, const char** argv)
     return 1;
 }
 
+// Note that this debugging tool does not carry the backup stream itself.
+// Full backups run through the bu shell command, which hands the transport
+// socket to adb; the byte-moving loop lives on the adb side, not here, so
+// throughput work (splice relays, pipe sizing) belongs there.
 static int perform_full_backup()
 {
     printf("this would have written all of your data to stdout\n");
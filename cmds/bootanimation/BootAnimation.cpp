@@ -17,6 +17,7 @@
 #define LOG_NDEBUG 0
 #define LOG_TAG "BootAnimation"
 
+#include <algorithm>
 #include <vector>
 
 #include <stdint.h>
@@ -219,18 +220,23 @@ status_t BootAnimation::initTexture(Texture* texture, AssetManager& assets,
     return NO_ERROR;
 }
 
-status_t BootAnimation::initTexture(FileMap* map, int* width, int* height) {
-    SkBitmap bitmap;
+status_t BootAnimation::decodeFrame(FileMap* map, SkBitmap* bitmap) {
     sk_sp<SkData> data = SkData::MakeWithoutCopy(map->getDataPtr(),
             map->getDataLength());
     sk_sp<SkImage> image = SkImage::MakeFromEncoded(data);
-    image->asLegacyBitmap(&bitmap, SkImage::kRO_LegacyBitmapMode);
+    if (image != nullptr) {
+        image->asLegacyBitmap(bitmap, SkImage::kRO_LegacyBitmapMode);
+    }
 
     // FileMap memory is never released until application exit.
-    // Release it now as the texture is already loaded and the memory used for
+    // Release it now as the bitmap is decoded and the memory used for
     // the packed resource can be released.
     delete map;
 
+    return image != nullptr ? NO_ERROR : NO_INIT;
+}
+
+status_t BootAnimation::uploadTexture(const SkBitmap& bitmap, int* width, int* height) {
     const int w = bitmap.width();
     const int h = bitmap.height();
     const void* p = bitmap.getPixels();
@@ -277,6 +283,15 @@ status_t BootAnimation::initTexture(FileMap* map, int* width, int* height) {
     return NO_ERROR;
 }
 
+status_t BootAnimation::initTexture(FileMap* map, int* width, int* height) {
+    SkBitmap bitmap;
+    const status_t status = decodeFrame(map, &bitmap);
+    if (status != NO_ERROR) {
+        return status;
+    }
+    return uploadTexture(bitmap, width, height);
+}
+
 class BootAnimation::DisplayEventCallback : public LooperCallback {
     BootAnimation* mBootAnimation;
 
@@ -459,6 +474,14 @@ status_t BootAnimation::readyToRun() {
     mFlingerSurface = s;
     mTargetInset = -1;
 
+    // Swap with damage rects when the driver supports it, so SurfaceFlinger
+    // only recomposes the part of the display the animation touched.
+    const char* eglExtensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (eglExtensions != nullptr && strstr(eglExtensions, "EGL_KHR_swap_buffers_with_damage")) {
+        mEglSwapBuffersWithDamage = reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(
+                eglGetProcAddress("eglSwapBuffersWithDamageKHR"));
+    }
+
     // Register a display event receiver
     mDisplayEventReceiver = std::make_unique<DisplayEventReceiver>();
     status_t status = mDisplayEventReceiver->initCheck();
@@ -498,6 +521,9 @@ void BootAnimation::resizeSurface(int newWidth, int newHeight) {
     glScissor(0, 0, mWidth, mHeight);
 
     mSurface = surface;
+    // The new surface has no presented content yet, so the next swap must
+    // report full damage.
+    mHavePrevFrameRect = false;
 }
 
 bool BootAnimation::preloadAnimation() {
@@ -632,7 +658,9 @@ bool BootAnimation::android() {
         glBindTexture(GL_TEXTURE_2D, mAndroid[0].name);
         glDrawTexiOES(xc, yc, 0, mAndroid[0].w, mAndroid[0].h);
 
-        EGLBoolean res = eglSwapBuffers(mDisplay, mSurface);
+        // The rest of the buffer stays black from frame to frame, so only
+        // the logo area needs to be recomposed.
+        EGLBoolean res = swapWithDamage(updateRect);
         if (res == EGL_FALSE)
             break;
 
@@ -1098,6 +1126,68 @@ bool BootAnimation::movie() {
     return false;
 }
 
+void BootAnimation::startFrameDecode(const Animation::Part& part) {
+    mDecodeExit = false;
+    mDecodeThread = std::thread([this, &part] {
+        const size_t fcount = part.frames.size();
+        for (size_t j = 0; j < fcount; j++) {
+            auto bitmap = std::make_unique<SkBitmap>();
+            if (decodeFrame(part.frames[j].map, bitmap.get()) != NO_ERROR) {
+                SLOGE("Failed to decode frame %s", part.frames[j].name.string());
+                bitmap = nullptr;
+            }
+            std::unique_lock<std::mutex> lock(mDecodedFramesLock);
+            mDecodedFramesCondition.wait(lock, [this] {
+                return mDecodedFrames.size() < kDecodeAheadDepth || mDecodeExit;
+            });
+            if (mDecodeExit) {
+                return;
+            }
+            mDecodedFrames.push(std::move(bitmap));
+            lock.unlock();
+            mDecodedFramesCondition.notify_all();
+        }
+    });
+}
+
+bool BootAnimation::nextDecodedFrame(std::unique_ptr<SkBitmap>* bitmap) {
+    std::unique_lock<std::mutex> lock(mDecodedFramesLock);
+    // The worker pushes exactly one entry per frame (a null bitmap when the
+    // decode failed), so this never waits for an entry that will not come.
+    mDecodedFramesCondition.wait(lock, [this] { return !mDecodedFrames.empty(); });
+    *bitmap = std::move(mDecodedFrames.front());
+    mDecodedFrames.pop();
+    lock.unlock();
+    mDecodedFramesCondition.notify_all();
+    return *bitmap != nullptr;
+}
+
+void BootAnimation::finishFrameDecode() {
+    {
+        std::lock_guard<std::mutex> lock(mDecodedFramesLock);
+        mDecodeExit = true;
+    }
+    mDecodedFramesCondition.notify_all();
+    if (mDecodeThread.joinable()) {
+        mDecodeThread.join();
+    }
+    // Discard frames the GL thread never consumed (early exit).
+    std::queue<std::unique_ptr<SkBitmap>> empty;
+    mDecodedFrames.swap(empty);
+}
+
+EGLBoolean BootAnimation::swapWithDamage(const Rect& damage) {
+    if (mEglSwapBuffersWithDamage != nullptr) {
+        // EGL damage rects use GL conventions: origin at the bottom left.
+        EGLint rect[4] = { damage.left, mHeight - damage.bottom, damage.width(),
+                           damage.height() };
+        if (mEglSwapBuffersWithDamage(mDisplay, mSurface, rect, 1) == EGL_TRUE) {
+            return EGL_TRUE;
+        }
+    }
+    return eglSwapBuffers(mDisplay, mSurface);
+}
+
 bool BootAnimation::playAnimation(const Animation& animation) {
     const size_t pcount = animation.parts.size();
     nsecs_t frameDuration = s2ns(1) / animation.fps;
@@ -1130,6 +1220,15 @@ bool BootAnimation::playAnimation(const Animation& animation) {
                     part.backgroundColor[2],
                     1.0f);
 
+            // On the first playthrough the frame PNGs still need to be
+            // decoded; do that ahead of time on a worker thread so the GL
+            // thread only uploads. Later playthroughs reuse the textures.
+            const bool decodeAhead = (r == 0);
+            if (decodeAhead) {
+                startFrameDecode(part);
+            }
+            mHavePrevFrameRect = false;
+
             for (size_t j=0 ; j<fcount && (!exitPending() || part.playUntilComplete) ; j++) {
                 processDisplayEvents();
 
@@ -1148,8 +1247,11 @@ bool BootAnimation::playAnimation(const Animation& animation) {
                         glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
                         glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
                     }
-                    int w, h;
-                    initTexture(frame.map, &w, &h);
+                    std::unique_ptr<SkBitmap> bitmap;
+                    if (nextDecodedFrame(&bitmap)) {
+                        int w, h;
+                        uploadTexture(*bitmap, &w, &h);
+                    }
                 }
 
                 const int xc = animationX + frame.trimX;
@@ -1171,12 +1273,27 @@ bool BootAnimation::playAnimation(const Animation& animation) {
                 // which is equivalent to mHeight - (yc + frame.trimHeight)
                 glDrawTexiOES(xc, mHeight - (yc + frame.trimHeight),
                               0, frame.trimWidth, frame.trimHeight);
-                if (mClockEnabled && mTimeIsAccurate && validClock(part)) {
+                const bool clockDrawn = mClockEnabled && mTimeIsAccurate && validClock(part);
+                if (clockDrawn) {
                     drawClock(animation.clockFont, part.clockPosX, part.clockPosY);
                 }
                 handleViewport(frameDuration);
 
-                eglSwapBuffers(mDisplay, mSurface);
+                // The background is static, so only the union of this frame's
+                // and the previous frame's trim rects changed on screen. The
+                // clock can be anywhere, so frames with a clock report full
+                // damage.
+                const Rect frameRect(xc, yc, xc + frame.trimWidth, yc + frame.trimHeight);
+                Rect damage(mWidth, mHeight);
+                if (!clockDrawn && mHavePrevFrameRect) {
+                    damage.left = std::min(frameRect.left, mPrevFrameRect.left);
+                    damage.top = std::min(frameRect.top, mPrevFrameRect.top);
+                    damage.right = std::max(frameRect.right, mPrevFrameRect.right);
+                    damage.bottom = std::max(frameRect.bottom, mPrevFrameRect.bottom);
+                }
+                swapWithDamage(damage);
+                mPrevFrameRect = frameRect;
+                mHavePrevFrameRect = true;
 
                 nsecs_t now = systemTime();
                 nsecs_t delay = frameDuration - (now - lastFrame);
@@ -1196,6 +1313,10 @@ bool BootAnimation::playAnimation(const Animation& animation) {
                 checkExit();
             }
 
+            if (decodeAhead) {
+                finishFrameDecode();
+            }
+
             usleep(part.pause * ns2us(frameDuration));
 
             // For infinite parts, we've now played them at least once, so perhaps exit
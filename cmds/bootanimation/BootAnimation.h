@@ -17,19 +17,25 @@
 #ifndef ANDROID_BOOTANIMATION_H
 #define ANDROID_BOOTANIMATION_H
 
-#include <vector>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <queue>
+#include <thread>
+#include <vector>
 
 #include <stdint.h>
 #include <sys/types.h>
 
 #include <androidfw/AssetManager.h>
 #include <gui/DisplayEventReceiver.h>
+#include <ui/Rect.h>
 #include <utils/Looper.h>
 #include <utils/Thread.h>
 #include <binder/IBinder.h>
 
 #include <EGL/egl.h>
+#include <EGL/eglext.h>
 #include <GLES/gl.h>
 
 class SkBitmap;
@@ -155,6 +161,12 @@ private:
 
     status_t initTexture(Texture* texture, AssetManager& asset, const char* name);
     status_t initTexture(FileMap* map, int* width, int* height);
+    static status_t decodeFrame(FileMap* map, SkBitmap* bitmap);
+    status_t uploadTexture(const SkBitmap& bitmap, int* width, int* height);
+    void startFrameDecode(const Animation::Part& part);
+    bool nextDecodedFrame(std::unique_ptr<SkBitmap>* bitmap);
+    void finishFrameDecode();
+    EGLBoolean swapWithDamage(const Rect& damage);
     status_t initFont(Font* font, const char* fallback);
     bool android();
     bool movie();
@@ -204,6 +216,22 @@ private:
     Animation* mAnimation = nullptr;
     std::unique_ptr<DisplayEventReceiver> mDisplayEventReceiver;
     sp<Looper> mLooper;
+
+    // Decode-ahead pipeline for animation frames. A worker thread decodes
+    // upcoming frame PNGs into bitmaps so the GL thread only has to upload
+    // them. The queue depth bounds how far the worker may run ahead.
+    static constexpr size_t kDecodeAheadDepth = 3;
+    std::thread mDecodeThread;
+    std::mutex mDecodedFramesLock;
+    std::condition_variable mDecodedFramesCondition;
+    std::queue<std::unique_ptr<SkBitmap>> mDecodedFrames;
+    bool mDecodeExit = false;
+
+    // eglSwapBuffersWithDamageKHR when the driver exposes it, so mostly
+    // static frames do not force full-display composition.
+    PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC mEglSwapBuffersWithDamage = nullptr;
+    Rect mPrevFrameRect;
+    bool mHavePrevFrameRect = false;
 };
 
 // ---------------------------------------------------------------------------
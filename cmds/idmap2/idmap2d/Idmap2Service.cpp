@@ -21,6 +21,7 @@
 #include <unistd.h>
 
 #include <cerrno>
+#include <cstdint>
 #include <cstring>
 #include <fstream>
 #include <memory>
@@ -88,6 +89,78 @@ Status GetCrc(const std::string& apk_path, uint32_t* out_crc) {
 
 namespace android::os {
 
+std::optional<Idmap2Service::ApkFingerprint> Idmap2Service::FingerprintFor(
+    const std::string& apk_path) {
+  struct stat st;
+  if (::stat(apk_path.c_str(), &st) != 0) {
+    return std::nullopt;
+  }
+  ApkFingerprint fingerprint;
+  fingerprint.dev = st.st_dev;
+  fingerprint.inode = st.st_ino;
+  fingerprint.size = st.st_size;
+  fingerprint.mtime_ns = st.st_mtim.tv_sec * INT64_C(1000000000) + st.st_mtim.tv_nsec;
+  return fingerprint;
+}
+
+Status Idmap2Service::GetCachedCrc(const std::string& apk_path, uint32_t* out_crc) {
+  if (apk_path == kFrameworkPath) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    if (android_crc_) {
+      *out_crc = *android_crc_;
+      return ok();
+    }
+  }
+
+  const auto fingerprint = FingerprintFor(apk_path);
+  if (fingerprint) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    const auto iter = crc_cache_.find(apk_path);
+    if (iter != crc_cache_.end() && iter->second.fingerprint == *fingerprint) {
+      *out_crc = iter->second.crc;
+      return ok();
+    }
+  }
+
+  // Loading a zip can take several milliseconds. Remember the crc so repeated verification
+  // of the same unchanged apks during boot opens each zip only once.
+  uint32_t crc;
+  auto crc_status = GetCrc(apk_path, &crc);
+  if (!crc_status.isOk()) {
+    return crc_status;
+  }
+
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  if (apk_path == kFrameworkPath) {
+    // The crc of the framework resource apk cannot change without a reboot, so it does not
+    // need to be validated against a fingerprint.
+    android_crc_ = crc;
+  } else if (fingerprint) {
+    crc_cache_[apk_path] = CrcCacheEntry{*fingerprint, crc};
+  }
+  *out_crc = crc;
+  return ok();
+}
+
+std::shared_ptr<const ApkAssets> Idmap2Service::GetCachedTargetApkAssets(
+    const std::string& target_apk_path) {
+  const auto fingerprint = FingerprintFor(target_apk_path);
+  if (fingerprint) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    if (target_apk_cache_ && target_apk_cache_->path == target_apk_path &&
+        target_apk_cache_->fingerprint == *fingerprint) {
+      return target_apk_cache_->apk_assets;
+    }
+  }
+
+  std::shared_ptr<const ApkAssets> target_apk = ApkAssets::Load(target_apk_path);
+  if (target_apk && fingerprint) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    target_apk_cache_ = TargetApkCacheEntry{target_apk_path, *fingerprint, target_apk};
+  }
+  return target_apk;
+}
+
 Status Idmap2Service::getIdmapPath(const std::string& overlay_apk_path,
                                    int32_t user_id ATTRIBUTE_UNUSED, std::string* _aidl_return) {
   assert(_aidl_return);
@@ -132,24 +205,14 @@ Status Idmap2Service::verifyIdmap(const std::string& target_apk_path,
   }
 
   uint32_t target_crc;
-  if (target_apk_path == kFrameworkPath && android_crc_) {
-    target_crc = *android_crc_;
-  } else {
-    auto target_crc_status = GetCrc(target_apk_path, &target_crc);
-    if (!target_crc_status.isOk()) {
-      *_aidl_return = false;
-      return target_crc_status;
-    }
-
-    // Loading the framework zip can take several milliseconds. Cache the crc of the framework
-    // resource APK to reduce repeated work during boot.
-    if (target_apk_path == kFrameworkPath) {
-      android_crc_ = target_crc;
-    }
+  auto target_crc_status = GetCachedCrc(target_apk_path, &target_crc);
+  if (!target_crc_status.isOk()) {
+    *_aidl_return = false;
+    return target_crc_status;
   }
 
   uint32_t overlay_crc;
-  auto overlay_crc_status = GetCrc(overlay_apk_path, &overlay_crc);
+  auto overlay_crc_status = GetCachedCrc(overlay_apk_path, &overlay_crc);
   if (!overlay_crc_status.isOk()) {
     *_aidl_return = false;
     return overlay_crc_status;
@@ -180,7 +243,7 @@ Status Idmap2Service::createIdmap(const std::string& target_apk_path,
                                     idmap_path.c_str(), uid));
   }
 
-  const std::unique_ptr<const ApkAssets> target_apk = ApkAssets::Load(target_apk_path);
+  const std::shared_ptr<const ApkAssets> target_apk = GetCachedTargetApkAssets(target_apk_path);
   if (!target_apk) {
     return error("failed to load apk " + target_apk_path);
   }
@@ -20,8 +20,16 @@
 #include <android-base/unique_fd.h>
 #include <binder/BinderService.h>
 #include <binder/Nullable.h>
+#include <sys/stat.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
 
 #include "android/os/BnIdmap2.h"
+#include "androidfw/ApkAssets.h"
 
 namespace android::os {
 
@@ -48,8 +56,48 @@ class Idmap2Service : public BinderService<Idmap2Service>, public BnIdmap2 {
                              aidl::nullable<std::string>* _aidl_return) override;
 
  private:
+  // Fingerprint of an apk on disk. While the fingerprint is unchanged the apk's bytes are
+  // assumed unchanged, and data derived from them can be reused without re-opening the zip.
+  struct ApkFingerprint {
+    dev_t dev = 0;
+    ino_t inode = 0;
+    off_t size = 0;
+    int64_t mtime_ns = 0;
+
+    bool operator==(const ApkFingerprint& rhs) const {
+      return dev == rhs.dev && inode == rhs.inode && size == rhs.size &&
+             mtime_ns == rhs.mtime_ns;
+    }
+  };
+
+  static std::optional<ApkFingerprint> FingerprintFor(const std::string& apk_path);
+
+  binder::Status GetCachedCrc(const std::string& apk_path, uint32_t* out_crc);
+
+  std::shared_ptr<const ApkAssets> GetCachedTargetApkAssets(const std::string& target_apk_path);
+
+  // Guards the caches below; binder requests are dispatched on a thread pool.
+  std::mutex cache_mutex_;
+
   // Cache the crc of the android framework package since the crc cannot change without a reboot.
   std::optional<uint32_t> android_crc_;
+
+  // Cache of apk crcs keyed by path, each validated against the file's fingerprint, so that
+  // verifying idmaps for unchanged apks does not re-read their zip central directories.
+  struct CrcCacheEntry {
+    ApkFingerprint fingerprint;
+    uint32_t crc;
+  };
+  std::map<std::string, CrcCacheEntry> crc_cache_;
+
+  // The most recently loaded target apk. Boot-time idmap creation issues one createIdmap call
+  // per overlay against the same target, so a single parse serves the whole batch.
+  struct TargetApkCacheEntry {
+    std::string path;
+    ApkFingerprint fingerprint;
+    std::shared_ptr<const ApkAssets> apk_assets;
+  };
+  std::optional<TargetApkCacheEntry> target_apk_cache_;
 };
 
 }  // namespace android::os
@@ -19,6 +19,8 @@
 #include "ih_util.h"
 
 #include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
 #include <sstream>
 #include <unistd.h>
 
@@ -48,10 +50,6 @@ static inline std::string trimDefault(const std::string& s) {
     return trim(s, DEFAULT_WHITESPACE);
 }
 
-static inline std::string trimHeader(const std::string& s) {
-    return toLowerStr(trimDefault(s));
-}
-
 static inline bool isNumber(const std::string& s) {
     std::string::const_iterator it = s.begin();
     while (it != s.end() && std::isdigit(*it)) ++it;
@@ -60,17 +58,24 @@ static inline bool isNumber(const std::string& s) {
 
 // This is similiar to Split in android-base/file.h, but it won't add empty string
 static void split(const std::string& line, std::vector<std::string>& words,
-        const trans_func& func, const std::string& delimiters) {
+        const std::string& delimiters, bool lowercase) {
     words.clear();  // clear the buffer before split
 
     size_t base = 0;
     size_t found;
     while (true) {
         found = line.find_first_of(delimiters, base);
-        if (found != base) {
-            std::string word = (*func) (line.substr(base, found - base));
-            if (!word.empty()) {
-                words.push_back(word);
+        const size_t end = (found == line.npos) ? line.size() : found;
+        if (end > base) {
+            // Trim by index so each word is copied out of the line only once.
+            const size_t head = line.find_first_not_of(DEFAULT_WHITESPACE, base);
+            if (head != line.npos && head < end) {
+                const size_t tail = line.find_last_not_of(DEFAULT_WHITESPACE, end - 1);
+                words.push_back(line.substr(head, tail - head + 1));
+                if (lowercase) {
+                    std::string& word = words.back();
+                    std::transform(word.begin(), word.end(), word.begin(), ::tolower);
+                }
             }
         }
         if (found == line.npos) break;
@@ -80,15 +85,13 @@ static void split(const std::string& line, std::vector<std::string>& words,
 
 header_t parseHeader(const std::string& line, const std::string& delimiters) {
     header_t header;
-    trans_func f = &trimHeader;
-    split(line, header, f, delimiters);
+    split(line, header, delimiters, true);
     return header;
 }
 
 record_t parseRecord(const std::string& line, const std::string& delimiters) {
     record_t record;
-    trans_func f = &trimDefault;
-    split(line, record, f, delimiters);
+    split(line, record, delimiters, false);
     return record;
 }
 
@@ -235,32 +238,47 @@ double toDouble(const std::string& s) {
 
 // ==============================================================================
 Reader::Reader(const int fd)
+        :mPos(0)
 {
-    mFile = fdopen(fd, "r");
-    mBuffer = new char[1024];
-    mStatus = mFile == nullptr ? "Invalid fd " + std::to_string(fd) : "";
+    if (fcntl(fd, F_GETFD) == -1) {
+        mStatus = "Invalid fd " + std::to_string(fd);
+        return;
+    }
+
+    // Read the whole section up front so the parse loop doesn't pay a read
+    // syscall and a getline allocation per line; sections piped to
+    // incident_helper are at most a few hundred kilobytes.
+    char buffer[32 * 1024];
+    ssize_t amt;
+    while ((amt = TEMP_FAILURE_RETRY(read(fd, buffer, sizeof(buffer)))) > 0) {
+        mData.append(buffer, amt);
+    }
+    if (amt < 0) {
+        mStatus = "Error reading file. Errno: " + std::to_string(errno);
+    }
+    close(fd);
 }
 
 Reader::~Reader()
 {
-    if (mFile != nullptr) fclose(mFile);
-    delete[] mBuffer;
 }
 
 bool Reader::readLine(std::string* line) {
-    if (mFile == nullptr) return false;
+    if (!mStatus.empty() || mPos >= mData.size()) return false;
 
-    size_t len = 0;
-    ssize_t read = getline(&mBuffer, &len, mFile);
-    if (read != -1) {
-        std::string s(mBuffer);
-        line->assign(trim(s, DEFAULT_NEWLINE));
-        return true;
-    }
-    if (!feof(mFile)) {
-        mStatus = "Error reading file. Ferror: " + std::to_string(ferror(mFile));
-    }
-    return false;
+    const size_t newline = mData.find('\n', mPos);
+    const size_t lineEnd = (newline == std::string::npos) ? mData.size() : newline;
+
+    // Trim the newline charset by index; the line is copied out of the
+    // buffer exactly once.
+    size_t head = mPos;
+    while (head < lineEnd && (mData[head] == '\r' || mData[head] == '\n')) head++;
+    size_t tail = lineEnd;
+    while (tail > head && (mData[tail - 1] == '\r' || mData[tail - 1] == '\n')) tail--;
+    line->assign(mData, head, tail - head);
+
+    mPos = (newline == std::string::npos) ? mData.size() : newline + 1;
+    return true;
 }
 
 bool Reader::ok(std::string* error) {
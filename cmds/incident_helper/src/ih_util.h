@@ -28,7 +28,6 @@ using namespace android::util;
 
 typedef std::vector<std::string> header_t;
 typedef std::vector<std::string> record_t;
-typedef std::string (*trans_func) (const std::string&);
 
 const std::string DEFAULT_WHITESPACE = " \t";
 const std::string DEFAULT_NEWLINE = "\r\n";
@@ -103,8 +102,10 @@ long long toLongLong(const std::string& s);
 double toDouble(const std::string& s);
 
 /**
- * Reader class reads data from given fd in streaming fashion.
- * The buffer size is controlled by capacity parameter.
+ * Reader class bulk-reads all data from the given fd at construction and
+ * then serves lines out of that single buffer, so the parse loop doesn't
+ * pay a read syscall and a line allocation per line. The fd is consumed
+ * and closed by the constructor.
  */
 class Reader
 {
@@ -116,8 +117,8 @@ public:
     bool ok(std::string* error);
 
 private:
-    FILE* mFile;
-    char* mBuffer;
+    std::string mData;
+    size_t mPos;
     std::string mStatus;
 };
 
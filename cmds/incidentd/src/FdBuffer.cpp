@@ -24,6 +24,7 @@
 
 #include <fcntl.h>
 #include <poll.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <wait.h>
 
@@ -33,6 +34,9 @@ namespace incidentd {
 
 const ssize_t BUFFER_SIZE = 16 * 1024;  // 16 KB
 const ssize_t MAX_BUFFER_SIZE = 96 * 1024 * 1024;  // 96 MB
+// Number of buffer chunks filled per readv() call. Large sections (logcat, dropbox)
+// used to pay one read syscall per chunk.
+const size_t READ_IOV_COUNT = 4;
 
 FdBuffer::FdBuffer(): FdBuffer(get_buffer_from_pool(), /* isBufferPooled= */ true)  {
 }
@@ -89,8 +93,13 @@ status_t FdBuffer::read(int fd, int64_t timeout) {
                 VLOG("return event has error %s", strerror(errno));
                 return errno != 0 ? -errno : UNKNOWN_ERROR;
             } else {
-                ssize_t amt = TEMP_FAILURE_RETRY(
-                        ::read(fd, mBuffer->writeBuffer(), mBuffer->currentToWrite()));
+                struct iovec iov[READ_IOV_COUNT];
+                const size_t iovCount = mBuffer->writeBuffers(iov, READ_IOV_COUNT);
+                if (iovCount == 0) {
+                    VLOG("No memory");
+                    return NO_MEMORY;
+                }
+                ssize_t amt = TEMP_FAILURE_RETRY(::readv(fd, iov, iovCount));
                 if (amt < 0) {
                     if (errno == EAGAIN || errno == EWOULDBLOCK) {
                         continue;
@@ -120,13 +129,14 @@ status_t FdBuffer::readFully(int fd) {
             VLOG("Truncating data");
             break;
         }
-        if (mBuffer->writeBuffer() == NULL) {
+        struct iovec iov[READ_IOV_COUNT];
+        const size_t iovCount = mBuffer->writeBuffers(iov, READ_IOV_COUNT);
+        if (iovCount == 0) {
             VLOG("No memory");
             return NO_MEMORY;
         }
 
-        ssize_t amt =
-                TEMP_FAILURE_RETRY(::read(fd, mBuffer->writeBuffer(), mBuffer->currentToWrite()));
+        ssize_t amt = TEMP_FAILURE_RETRY(::readv(fd, iov, iovCount));
         if (amt < 0) {
             VLOG("Fail to read %d: %s", fd, strerror(errno));
             return -errno;
@@ -261,8 +271,13 @@ status_t FdBuffer::readProcessedDataInStream(int fd, unique_fd toFd, unique_fd f
         }
 
         // read from parsing process
-        ssize_t amt = TEMP_FAILURE_RETRY(
-                ::read(fromFd.get(), mBuffer->writeBuffer(), mBuffer->currentToWrite()));
+        struct iovec iov[READ_IOV_COUNT];
+        const size_t iovCount = mBuffer->writeBuffers(iov, READ_IOV_COUNT);
+        if (iovCount == 0) {
+            VLOG("No memory");
+            return NO_MEMORY;
+        }
+        ssize_t amt = TEMP_FAILURE_RETRY(::readv(fromFd.get(), iov, iovCount));
         if (amt < 0) {
             if (!(errno == EAGAIN || errno == EWOULDBLOCK)) {
                 VLOG("Fail to read fromFd %d: %s", fromFd.get(), strerror(errno));
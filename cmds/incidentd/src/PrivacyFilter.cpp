@@ -26,6 +26,8 @@
 #include <android/util/ProtoFileReader.h>
 #include <log/log.h>
 
+#include <memory>
+
 namespace android {
 namespace os {
 namespace incidentd {
@@ -77,18 +79,45 @@ void write_field_or_skip(ProtoOutputStream* out, const sp<ProtoReader>& in,
     }
 }
 
+// ================================================================================
+/**
+ * One output level of the single-pass strip: the level's privacy spec and the
+ * stream into which the bytes surviving that level are accumulated.
+ */
+struct StripLevel {
+    explicit StripLevel(uint8_t privacyPolicy)
+            :spec(privacyPolicy),
+             encodedBuffer(get_buffer_from_pool()),
+             proto(encodedBuffer),
+             keep(false) {
+    }
+
+    ~StripLevel() {
+        return_buffer_to_pool(encodedBuffer);
+    }
+
+    const PrivacySpec spec;
+    const sp<EncodedBuffer> encodedBuffer;
+    ProtoOutputStream proto;
+
+    // Scratch for the leaf field currently being decoded: whether it survives
+    // this level.
+    bool keep;
+};
+
 /**
- * Strip next field based on its private policy and request spec, then stores data in buf.
- * Return NO_ERROR if succeeds, otherwise BAD_VALUE is returned to indicate bad data in
- * FdBuffer.
+ * Strip the next field into every output level at once.  The field is decoded
+ * a single time; each level's privacy spec decides whether the decoded bytes
+ * are appended to that level's stream.  Return NO_ERROR if it succeeds,
+ * otherwise BAD_VALUE is returned to indicate bad data in FdBuffer.
  *
  * The iterator must point to the head of a protobuf formatted field for successful operation.
  * After exit with NO_ERROR, iterator points to the next protobuf field's head.
  *
  * depth is the depth of recursion, for debugging.
  */
-status_t strip_field(ProtoOutputStream* out, const sp<ProtoReader>& in,
-        const Privacy* parentPolicy, const PrivacySpec& spec, int depth) {
+status_t strip_field_to_levels(const vector<unique_ptr<StripLevel>>& levels,
+        const sp<ProtoReader>& in, const Privacy* parentPolicy, int depth) {
     if (!in->hasNext() || parentPolicy == NULL) {
         return BAD_VALUE;
     }
@@ -97,18 +126,70 @@ status_t strip_field(ProtoOutputStream* out, const sp<ProtoReader>& in,
     const Privacy* policy = lookup(parentPolicy, fieldId);
 
     if (policy == NULL || policy->children == NULL) {
-        bool skip = !spec.CheckPremission(policy, parentPolicy->policy);
-        // iterator will point to head of next field
-        size_t currentAt = in->bytesRead();
-        write_field_or_skip(out, in, fieldTag, skip);
+        const uint8_t wireType = read_wire_type(fieldTag);
+        for (const unique_ptr<StripLevel>& level: levels) {
+            level->keep = level->spec.CheckPremission(policy, parentPolicy->policy);
+        }
+
+        uint64_t varint = 0;
+        size_t bytesToWrite = 0;
+        switch (wireType) {
+            case WIRE_TYPE_VARINT:
+                varint = in->readRawVarint();
+                for (const unique_ptr<StripLevel>& level: levels) {
+                    if (level->keep) {
+                        level->proto.writeRawVarint(fieldTag);
+                        level->proto.writeRawVarint(varint);
+                    }
+                }
+                return NO_ERROR;
+            case WIRE_TYPE_FIXED64:
+                bytesToWrite = 8;
+                break;
+            case WIRE_TYPE_LENGTH_DELIMITED:
+                bytesToWrite = in->readRawVarint();
+                break;
+            case WIRE_TYPE_FIXED32:
+                bytesToWrite = 4;
+                break;
+        }
+        bool keepAny = false;
+        for (const unique_ptr<StripLevel>& level: levels) {
+            if (!level->keep) {
+                continue;
+            }
+            keepAny = true;
+            if (wireType == WIRE_TYPE_LENGTH_DELIMITED) {
+                level->proto.writeLengthDelimitedHeader(read_field_id(fieldTag), bytesToWrite);
+            } else {
+                level->proto.writeRawVarint(fieldTag);
+            }
+        }
+        if (!keepAny) {
+            in->move(bytesToWrite);
+            return NO_ERROR;
+        }
+        for (size_t i = 0; i < bytesToWrite; i++) {
+            const uint8_t val = in->next();
+            for (const unique_ptr<StripLevel>& level: levels) {
+                if (level->keep) {
+                    level->proto.writeRawByte(val);
+                }
+            }
+        }
         return NO_ERROR;
     }
+
     // current field is message type and its sub-fields have extra privacy policies
     uint32_t msgSize = in->readRawVarint();
     size_t start = in->bytesRead();
-    uint64_t token = out->start(encode_field_id(policy));
+    vector<uint64_t> tokens;
+    tokens.reserve(levels.size());
+    for (const unique_ptr<StripLevel>& level: levels) {
+        tokens.push_back(level->proto.start(encode_field_id(policy)));
+    }
     while (in->bytesRead() - start != msgSize) {
-        status_t err = strip_field(out, in, policy, spec, depth + 1);
+        status_t err = strip_field_to_levels(levels, in, policy, depth + 1);
         if (err != NO_ERROR) {
             ALOGW("Bad value when stripping id %d, wiretype %d, tag %#x, depth %d, size %d, "
                     "relative pos %zu, ", fieldId, read_wire_type(fieldTag), fieldTag, depth,
@@ -116,124 +197,21 @@ status_t strip_field(ProtoOutputStream* out, const sp<ProtoReader>& in,
             return err;
         }
     }
-    out->end(token);
-    return NO_ERROR;
-}
-
-// ================================================================================
-class FieldStripper {
-public:
-    FieldStripper(const Privacy* restrictions, const sp<ProtoReader>& data,
-            uint8_t bufferLevel);
-
-    ~FieldStripper();
-
-    /**
-     * Take the data that we have, and filter it down so that no fields
-     * are more sensitive than the given privacy policy.
-     */
-    status_t strip(uint8_t privacyPolicy);
-
-    /**
-     * At the current filter level, how many bytes of data there is.
-     */
-    ssize_t dataSize() const { return mSize; }
-
-    /**
-     * Write the data from the current filter level to the file descriptor.
-     */
-    status_t writeData(int fd);
-
-private:
-    /**
-     * The global set of field --> required privacy level mapping.
-     */
-    const Privacy* mRestrictions;
-
-    /**
-     * The current buffer.
-     */
-    sp<ProtoReader> mData;
-
-    /**
-     * The current size of the buffer inside mData.
-     */
-    ssize_t mSize;
-
-    /**
-     * The current privacy policy that the data is filtered to, as an optimization
-     * so we don't always re-filter data that has already been filtered.
-     */
-    uint8_t mCurrentLevel;
-
-    sp<EncodedBuffer> mEncodedBuffer;
-};
-
-FieldStripper::FieldStripper(const Privacy* restrictions, const sp<ProtoReader>& data,
-            uint8_t bufferLevel)
-        :mRestrictions(restrictions),
-         mData(data),
-         mSize(data->size()),
-         mCurrentLevel(bufferLevel),
-         mEncodedBuffer(get_buffer_from_pool()) {
-    if (mSize < 0) {
-        ALOGW("FieldStripper constructed with a ProtoReader that doesn't support size."
-                " Data will be missing.");
-    }
-}
-
-FieldStripper::~FieldStripper() {
-    return_buffer_to_pool(mEncodedBuffer);
-}
-
-status_t FieldStripper::strip(const uint8_t privacyPolicy) {
-    // If the current strip level is less (fewer fields retained) than what's already in the
-    // buffer, then we can skip it.
-    if (mCurrentLevel < privacyPolicy) {
-        PrivacySpec spec(privacyPolicy);
-        mEncodedBuffer->clear();
-        ProtoOutputStream proto(mEncodedBuffer);
-
-        // Optimization when no strip happens.
-        if (mRestrictions == NULL || spec.RequireAll()) {
-            if (spec.CheckPremission(mRestrictions)) {
-                mSize = mData->size();
-            }
-            return NO_ERROR;
-        }
-
-        while (mData->hasNext()) {
-            status_t err = strip_field(&proto, mData, mRestrictions, spec, 0);
-            if (err != NO_ERROR) {
-                return err; // Error logged in strip_field.
-            }
-        }
-
-        if (mData->bytesRead() != mData->size()) {
-            ALOGW("Buffer corrupted: expect %zu bytes, read %zu bytes", mData->size(),
-                    mData->bytesRead());
-            return BAD_VALUE;
-        }
-
-        mData = proto.data();
-        mSize = proto.size();
-        mCurrentLevel = privacyPolicy;
+    for (size_t i = 0; i < levels.size(); i++) {
+        levels[i]->proto.end(tokens[i]);
     }
     return NO_ERROR;
 }
 
-status_t FieldStripper::writeData(int fd) {
-    status_t err = NO_ERROR;
-    sp<ProtoReader> reader = mData;
-    if (mData == nullptr) {
-        // There had been an error processing the data. We won't write anything,
-        // but we also won't return an error, because errors are fatal.
-        return NO_ERROR;
-    }
+/**
+ * Write everything the reader has left to the file descriptor.
+ */
+static status_t write_all(int fd, const sp<ProtoReader>& reader) {
     while (reader->readBuffer() != NULL) {
-        err = WriteFully(fd, reader->readBuffer(), reader->currentToRead()) ? NO_ERROR : -errno;
-        reader->move(reader->currentToRead());
+        status_t err = WriteFully(fd, reader->readBuffer(), reader->currentToRead())
+                ? NO_ERROR : -errno;
         if (err != NO_ERROR) return err;
+        reader->move(reader->currentToRead());
     }
     return NO_ERROR;
 }
@@ -270,29 +248,77 @@ status_t PrivacyFilter::writeData(const FdBuffer& buffer, uint8_t bufferLevel,
         *maxSize = 0;
     }
 
-    // Order the writes by privacy filter, with increasing levels of filtration,k
-    // so we can do the filter once, and then write many times.
+    // Order the writes by privacy filter, with increasing levels of filtration,
+    // so outputs that share a level share a filtered buffer.
     sort(mOutputs.begin(), mOutputs.end(),
         [](const sp<FilterFd>& a, const sp<FilterFd>& b) -> bool {
             return a->getPrivacyPolicy() < b->getPrivacyPolicy();
         });
 
-    uint8_t privacyPolicy = PRIVACY_POLICY_LOCAL; // a.k.a. no filtering
-    FieldStripper fieldStripper(mRestrictions, buffer.data()->read(), bufferLevel);
+    // Build one StripLevel per distinct privacy policy that actually requires
+    // stripping.  Outputs whose policy keeps every field just get the buffer
+    // as-is.  All levels are then filled in a single decode pass over the data.
+    vector<unique_ptr<StripLevel>> levels;
+    bool stripFailed = false;
     for (const sp<FilterFd>& output: mOutputs) {
-        // Do another level of filtering if necessary
-        if (privacyPolicy != output->getPrivacyPolicy()) {
-            privacyPolicy = output->getPrivacyPolicy();
-            err = fieldStripper.strip(privacyPolicy);
+        const uint8_t privacyPolicy = output->getPrivacyPolicy();
+        if (privacyPolicy <= bufferLevel) {
+            continue;  // Already filtered at least this far.
+        }
+        PrivacySpec spec(privacyPolicy);
+        if (mRestrictions == NULL || spec.RequireAll()) {
+            continue;  // Nothing to strip for this output.
+        }
+        if (levels.size() > 0 && levels.back()->spec.getPolicy() == spec.getPolicy()) {
+            continue;  // Same level as the previous output.
+        }
+        levels.push_back(make_unique<StripLevel>(privacyPolicy));
+    }
+
+    if (levels.size() > 0) {
+        sp<ProtoReader> data = buffer.data()->read();
+        while (data->hasNext()) {
+            err = strip_field_to_levels(levels, data, mRestrictions, 0);
             if (err != NO_ERROR) {
                 // We can't successfully strip this data.  We will skip
-                // the rest of this section.
-                return NO_ERROR;
+                // the filtered outputs for this section.  Error logged
+                // in strip_field_to_levels.
+                stripFailed = true;
+                break;
+            }
+        }
+        if (!stripFailed && data->bytesRead() != data->size()) {
+            ALOGW("Buffer corrupted: expect %zu bytes, read %zu bytes", data->size(),
+                    data->bytesRead());
+            stripFailed = true;
+        }
+    }
+
+    for (const sp<FilterFd>& output: mOutputs) {
+        // Find the stripped buffer for this output's level, if there is one.
+        sp<ProtoReader> reader;
+        ssize_t dataSize;
+        const uint8_t privacyPolicy = output->getPrivacyPolicy();
+        const PrivacySpec spec(privacyPolicy);
+        if (privacyPolicy <= bufferLevel || mRestrictions == NULL || spec.RequireAll()) {
+            reader = buffer.data()->read();
+            dataSize = buffer.size();
+        } else {
+            if (stripFailed) {
+                continue;
+            }
+            StripLevel* level = NULL;
+            for (const unique_ptr<StripLevel>& l: levels) {
+                if (l->spec.getPolicy() == spec.getPolicy()) {
+                    level = l.get();
+                    break;
+                }
             }
+            reader = level->proto.data();
+            dataSize = level->proto.size();
         }
 
         // Write the resultant buffer to the fd, along with the header.
-        ssize_t dataSize = fieldStripper.dataSize();
         if (dataSize > 0) {
             err = write_section_header(output->getFd(), mSectionId, dataSize);
             if (err != NO_ERROR) {
@@ -300,7 +326,7 @@ status_t PrivacyFilter::writeData(const FdBuffer& buffer, uint8_t bufferLevel,
                 continue;
             }
 
-            err = fieldStripper.writeData(output->getFd());
+            err = write_all(output->getFd(), reader);
             if (err != NO_ERROR) {
                 output->onWriteError(err);
                 continue;
@@ -38,7 +38,10 @@
 #include <sys/prctl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <algorithm>
+#include <atomic>
 #include <string>
+#include <thread>
 #include <time.h>
 #include <wait.h>
 
@@ -56,6 +59,10 @@ const int FIELD_ID_METADATA = 2;
 // Args for exec gzip
 static const char* GZIP[] = {"/system/bin/gzip", NULL};
 
+// Sections are captured on up to this many threads at once.  The output still
+// reaches the file descriptors in section list order.
+const size_t MAX_SECTION_WORKER_THREADS = 4;
+
 IncidentMetadata_Destination privacy_policy_to_dest(uint8_t privacyPolicy) {
     switch (privacyPolicy) {
         case PRIVACY_POLICY_AUTOMATIC:
@@ -220,6 +227,7 @@ ReportBatch::ReportBatch() {}
 ReportBatch::~ReportBatch() {}
 
 void ReportBatch::addPersistedReport(const IncidentReportArgs& args) {
+    scoped_lock<mutex> lock(mLock);
     ComponentName component(args.receiverPkg(), args.receiverCls());
     map<ComponentName, sp<ReportRequest>>::iterator found = mPersistedRequests.find(component);
     if (found == mPersistedRequests.end()) {
@@ -234,14 +242,22 @@ void ReportBatch::addPersistedReport(const IncidentReportArgs& args) {
 
 void ReportBatch::addStreamingReport(const IncidentReportArgs& args,
         const sp<IIncidentReportStatusListener>& listener, int streamFd) {
+    scoped_lock<mutex> lock(mLock);
     mStreamingRequests.push_back(new ReportRequest(args, listener, streamFd));
 }
 
 bool ReportBatch::empty() const {
+    scoped_lock<mutex> lock(mLock);
     return mPersistedRequests.size() == 0 && mStreamingRequests.size() == 0;
 }
 
+bool ReportBatch::hasPersistedReports() const {
+    scoped_lock<mutex> lock(mLock);
+    return mPersistedRequests.size() > 0;
+}
+
 sp<ReportRequest> ReportBatch::getPersistedRequest(const ComponentName& component) {
+    scoped_lock<mutex> lock(mLock);
     map<ComponentName, sp<ReportRequest>>::iterator it = mPersistedRequests.find(component);
     if (it != mPersistedRequests.find(component)) {
         return it->second;
@@ -250,32 +266,45 @@ sp<ReportRequest> ReportBatch::getPersistedRequest(const ComponentName& componen
     }
 }
 
+void ReportBatch::getAllRequests(vector<sp<ReportRequest>>* persisted,
+        vector<sp<ReportRequest>>* streaming) const {
+    scoped_lock<mutex> lock(mLock);
+    if (persisted != nullptr) {
+        for (map<ComponentName, sp<ReportRequest>>::const_iterator it = mPersistedRequests.begin();
+                it != mPersistedRequests.end(); it++) {
+            persisted->push_back(it->second);
+        }
+    }
+    if (streaming != nullptr) {
+        for (vector<sp<ReportRequest>>::const_iterator request = mStreamingRequests.begin();
+                request != mStreamingRequests.end(); request++) {
+            streaming->push_back(*request);
+        }
+    }
+}
+
 void ReportBatch::forEachPersistedRequest(const function<void (const sp<ReportRequest>&)>& func) {
-    for (map<ComponentName, sp<ReportRequest>>::iterator it = mPersistedRequests.begin();
-            it != mPersistedRequests.end(); it++) {
-        func(it->second);
+    vector<sp<ReportRequest>> requests;
+    getAllRequests(&requests, nullptr);
+    for (const sp<ReportRequest>& request: requests) {
+        func(request);
     }
 }
 
 void ReportBatch::forEachStreamingRequest(const function<void (const sp<ReportRequest>&)>& func) {
-    for (vector<sp<ReportRequest>>::iterator request = mStreamingRequests.begin();
-            request != mStreamingRequests.end(); request++) {
-        func(*request);
+    vector<sp<ReportRequest>> requests;
+    getAllRequests(nullptr, &requests);
+    for (const sp<ReportRequest>& request: requests) {
+        func(request);
     }
 }
 
 void ReportBatch::forEachListener(
         const function<void (const sp<IIncidentReportStatusListener>&)>& func) {
-    for (map<ComponentName, sp<ReportRequest>>::iterator it = mPersistedRequests.begin();
-            it != mPersistedRequests.end(); it++) {
-        sp<IIncidentReportStatusListener> listener = it->second->getListener();
-        if (listener != nullptr) {
-            func(listener);
-        }
-    }
-    for (vector<sp<ReportRequest>>::iterator request = mStreamingRequests.begin();
-            request != mStreamingRequests.end(); request++) {
-        sp<IIncidentReportStatusListener> listener = (*request)->getListener();
+    vector<sp<ReportRequest>> requests;
+    getAllRequests(&requests, &requests);
+    for (const sp<ReportRequest>& request: requests) {
+        sp<IIncidentReportStatusListener> listener = request->getListener();
         if (listener != nullptr) {
             func(listener);
         }
@@ -284,19 +313,11 @@ void ReportBatch::forEachListener(
 
 void ReportBatch::forEachListener(int sectionId,
         const function<void (const sp<IIncidentReportStatusListener>&)>& func) {
-    for (map<ComponentName, sp<ReportRequest>>::iterator it = mPersistedRequests.begin();
-            it != mPersistedRequests.end(); it++) {
-        if (it->second->containsSection(sectionId)) {
-            sp<IIncidentReportStatusListener> listener = it->second->getListener();
-            if (listener != nullptr) {
-                func(listener);
-            }
-        }
-    }
-    for (vector<sp<ReportRequest>>::iterator request = mStreamingRequests.begin();
-            request != mStreamingRequests.end(); request++) {
-        if ((*request)->containsSection(sectionId)) {
-            sp<IIncidentReportStatusListener> listener = (*request)->getListener();
+    vector<sp<ReportRequest>> requests;
+    getAllRequests(&requests, &requests);
+    for (const sp<ReportRequest>& request: requests) {
+        if (request->containsSection(sectionId)) {
+            sp<IIncidentReportStatusListener> listener = request->getListener();
             if (listener != nullptr) {
                 func(listener);
             }
@@ -305,6 +326,7 @@ void ReportBatch::forEachListener(int sectionId,
 }
 
 void ReportBatch::getCombinedPersistedArgs(IncidentReportArgs* result) {
+    scoped_lock<mutex> lock(mLock);
     for (map<ComponentName, sp<ReportRequest>>::iterator it = mPersistedRequests.begin();
             it != mPersistedRequests.end(); it++) {
         result->merge(it->second->args);
@@ -314,6 +336,7 @@ void ReportBatch::getCombinedPersistedArgs(IncidentReportArgs* result) {
 bool ReportBatch::containsSection(int sectionId) {
     // We don't cache this, because in case of error, we remove requests
     // from the batch, and this is easier than recomputing the set.
+    scoped_lock<mutex> lock(mLock);
     for (map<ComponentName, sp<ReportRequest>>::iterator it = mPersistedRequests.begin();
             it != mPersistedRequests.end(); it++) {
         if (it->second->containsSection(sectionId)) {
@@ -330,10 +353,12 @@ bool ReportBatch::containsSection(int sectionId) {
 }
 
 void ReportBatch::clearPersistedRequests() {
+    scoped_lock<mutex> lock(mLock);
     mPersistedRequests.clear();
 }
 
 void ReportBatch::transferStreamingRequests(const sp<ReportBatch>& that) {
+    scoped_lock<mutex> lock(mLock);
     for (vector<sp<ReportRequest>>::iterator request = mStreamingRequests.begin();
             request != mStreamingRequests.end(); request++) {
         that->mStreamingRequests.push_back(*request);
@@ -342,6 +367,7 @@ void ReportBatch::transferStreamingRequests(const sp<ReportBatch>& that) {
 }
 
 void ReportBatch::transferPersistedRequests(const sp<ReportBatch>& that) {
+    scoped_lock<mutex> lock(mLock);
     for (map<ComponentName, sp<ReportRequest>>::iterator it = mPersistedRequests.begin();
             it != mPersistedRequests.end(); it++) {
         that->mPersistedRequests[it->first] = it->second;
@@ -350,6 +376,7 @@ void ReportBatch::transferPersistedRequests(const sp<ReportBatch>& that) {
 }
 
 void ReportBatch::getFailedRequests(vector<sp<ReportRequest>>* requests) {
+    scoped_lock<mutex> lock(mLock);
     for (map<ComponentName, sp<ReportRequest>>::iterator it = mPersistedRequests.begin();
             it != mPersistedRequests.end(); it++) {
         if (it->second->getStatus() != NO_ERROR) {
@@ -365,6 +392,7 @@ void ReportBatch::getFailedRequests(vector<sp<ReportRequest>>* requests) {
 }
 
 void ReportBatch::removeRequest(const sp<ReportRequest>& request) {
+    scoped_lock<mutex> lock(mLock);
     for (map<ComponentName, sp<ReportRequest>>::iterator it = mPersistedRequests.begin();
             it != mPersistedRequests.end(); it++) {
         if (it->second == request) {
@@ -381,11 +409,47 @@ void ReportBatch::removeRequest(const sp<ReportRequest>& request) {
     }
 }
 
+// ================================================================================
+SectionWriteOrder::SectionWriteOrder()
+        :mNextIndex(0),
+         mAborted(false) {
+}
+
+SectionWriteOrder::~SectionWriteOrder() {
+}
+
+bool SectionWriteOrder::waitForTurn(size_t index) {
+    unique_lock<mutex> lock(mLock);
+    mCondition.wait(lock, [this, index] { return mAborted || mNextIndex >= index; });
+    return !mAborted;
+}
+
+void SectionWriteOrder::finishTurn(size_t index) {
+    scoped_lock<mutex> lock(mLock);
+    if (mNextIndex == index) {
+        mNextIndex = index + 1;
+        mCondition.notify_all();
+    }
+}
+
+void SectionWriteOrder::abort() {
+    scoped_lock<mutex> lock(mLock);
+    mAborted = true;
+    mCondition.notify_all();
+}
+
+bool SectionWriteOrder::isAborted() {
+    scoped_lock<mutex> lock(mLock);
+    return mAborted;
+}
+
 // ================================================================================
 ReportWriter::ReportWriter(const sp<ReportBatch>& batch)
         :mBatch(batch),
          mPersistedFile(),
-         mMaxPersistedPrivacyPolicy(PRIVACY_POLICY_UNSET) {
+         mMaxPersistedPrivacyPolicy(PRIVACY_POLICY_UNSET),
+         mSectionOrder(),
+         mSectionOrderIndex(0) {
 }
 
 ReportWriter::~ReportWriter() {
@@ -399,6 +463,11 @@ void ReportWriter::setMaxPersistedPrivacyPolicy(uint8_t privacyPolicy) {
     mMaxPersistedPrivacyPolicy = privacyPolicy;
 }
 
+void ReportWriter::setSectionOrder(const sp<SectionWriteOrder>& order, size_t index) {
+    mSectionOrder = order;
+    mSectionOrderIndex = index;
+}
+
 void ReportWriter::startSection(int sectionId) {
     mCurrentSectionId = sectionId;
     mSectionStartTimeMs = uptimeMillis();
@@ -411,6 +480,7 @@ void ReportWriter::startSection(int sectionId) {
     mSectionBufferSuccess = false;
     mHadError = false;
     mSectionErrors.clear();
+    mMaxSectionDataFilteredSize = 0;
 }
 
 void ReportWriter::setSectionStats(const FdBuffer& buffer) {
@@ -493,10 +563,18 @@ void ReportWriter::vflog(const Section* section, status_t err, int level, const
 
 // Reads data from FdBuffer and writes it to the requests file descriptor.
 status_t ReportWriter::writeSection(const FdBuffer& buffer) {
+    // Sections are captured concurrently but streamed out one at a time, in
+    // section list order.
+    if (mSectionOrder != nullptr && !mSectionOrder->waitForTurn(mSectionOrderIndex)) {
+        // An earlier section failed the report; there is nothing left to write to.
+        return NO_ERROR;
+    }
+
     PrivacyFilter filter(mCurrentSectionId, get_privacy_of_section(mCurrentSectionId));
 
-    // Add the fd for the persisted requests
-    if (mPersistedFile != nullptr) {
+    // Add the fd for the persisted requests.  If an earlier section hit a write
+    // error, the file has already been closed and abandoned.
+    if (mPersistedFile != nullptr && mPersistedFile->getWriteError() == NO_ERROR) {
         filter.addFd(new PersistedFilterFd(mMaxPersistedPrivacyPolicy,
                     mPersistedFile->getDataFileFd(), mPersistedFile));
     }
@@ -520,8 +598,8 @@ Reporter::Reporter(const sp<WorkDirectory>& workDirectory,
                    const sp<ReportBatch>& batch,
                    const vector<BringYourOwnSection*>& registeredSections)
         :mWorkDirectory(workDirectory),
-         mWriter(batch),
          mBatch(batch),
+         mMaxPersistedPrivacyPolicy(PRIVACY_POLICY_UNSET),
          mRegisteredSections(registeredSections) {
 }
 
@@ -567,7 +645,7 @@ void Reporter::runReport(size_t* reportByteSize) {
                 mWorkDirectory->remove(mPersistedFile);
                 mPersistedFile = nullptr;
             }
-            mWriter.setMaxPersistedPrivacyPolicy(persistedPrivacyPolicy);
+            mMaxPersistedPrivacyPolicy = persistedPrivacyPolicy;
         }
 
         if (mPersistedFile != nullptr) {
@@ -578,9 +656,7 @@ void Reporter::runReport(size_t* reportByteSize) {
             }
         }
 
-        if (mPersistedFile != nullptr) {
-            mWriter.setPersistedFile(mPersistedFile);
-        } else {
+        if (mPersistedFile == nullptr) {
             ALOGW("Error creating the persisted file, so clearing persisted reports.");
             // If we couldn't open the file (permissions err, etc), then
             // we still want to proceed with any streaming reports, but
@@ -633,21 +709,24 @@ void Reporter::runReport(size_t* reportByteSize) {
     // sections for it.
     cancel_and_remove_failed_requests();
 
-    // For each of the report fields, see if we need it, and if so, execute the command
-    // and report to those that care that we're doing it.
-    for (const Section** section = SECTION_LIST; *section; section++) {
-        if (execute_section(*section, &metadata, reportByteSize) != NO_ERROR) {
-            goto DONE;
+    // For each of the report fields, see if we need it, and if so, capture it.
+    // The sections are captured on a pool of worker threads, but their output
+    // reaches the file descriptors serially, in section list order.
+    {
+        vector<const Section*> sections;
+        for (const Section** section = SECTION_LIST; *section; section++) {
+            if (mBatch->containsSection((*section)->id)) {
+                sections.push_back(*section);
+            }
         }
-    }
-
-    for (const Section* section : mRegisteredSections) {
-        if (execute_section(section, &metadata, reportByteSize) != NO_ERROR) {
-            goto DONE;
+        for (const Section* section : mRegisteredSections) {
+            if (mBatch->containsSection(section->id)) {
+                sections.push_back(section);
+            }
         }
+        err = execute_sections(sections, &metadata, reportByteSize);
     }
 
-DONE:
     // Finish up the persisted file.
     if (mPersistedFile != nullptr) {
         mPersistedFile->closeDataFile();
@@ -702,17 +781,65 @@ DONE:
     ALOGI("Done taking incident report err=%s", strerror(-err));
 }
 
-status_t Reporter::execute_section(const Section* section, IncidentMetadata* metadata,
-        size_t* reportByteSize) {
+status_t Reporter::execute_sections(const vector<const Section*>& sections,
+        IncidentMetadata* metadata, size_t* reportByteSize) {
+    const size_t sectionCount = sections.size();
+
+    // Pre-allocate the metadata entries, so the worker threads fill in their own
+    // slot instead of mutating the repeated field concurrently.
+    vector<IncidentMetadata::SectionStats*> sectionStats;
+    sectionStats.reserve(sectionCount);
+    for (size_t i = 0; i < sectionCount; i++) {
+        sectionStats.push_back(metadata->add_sections());
+    }
+
+    sp<SectionWriteOrder> order = new SectionWriteOrder();
+    status_t fatalErr = NO_ERROR;
+
+    // Sections are claimed in list order, so the section holding the turn is
+    // always already running, and the pool cannot deadlock on the write order.
+    atomic<size_t> nextSection(0);
+    auto worker = [&]() {
+        size_t index;
+        while (!order->isAborted() && (index = nextSection.fetch_add(1)) < sectionCount) {
+            execute_section(sections[index], sectionStats[index], order, index, reportByteSize,
+                    &fatalErr);
+        }
+    };
+
+    const size_t numThreads = min(sectionCount, MAX_SECTION_WORKER_THREADS);
+    if (numThreads <= 1) {
+        worker();
+    } else {
+        vector<thread> threads;
+        for (size_t i = 0; i < numThreads; i++) {
+            threads.emplace_back(worker);
+        }
+        for (thread& th : threads) {
+            th.join();
+        }
+    }
+
+    return fatalErr;
+}
+
+void Reporter::execute_section(const Section* section,
+        IncidentMetadata::SectionStats* sectionMetadata, const sp<SectionWriteOrder>& order,
+        size_t index, size_t* reportByteSize, status_t* fatalErr) {
     const int sectionId = section->id;
+    sectionMetadata->set_id(sectionId);
 
-    // If nobody wants this section, skip it.
+    // If nobody wants this section any more (requests are removed when their
+    // stream hits a write error), skip it.  We still have to take our turn so
+    // the later sections aren't blocked.
     if (!mBatch->containsSection(sectionId)) {
-        return NO_ERROR;
+        if (order->waitForTurn(index)) {
+            order->finishTurn(index);
+        }
+        return;
     }
 
     ALOGD("Start incident report section %d '%s'", sectionId, section->name.string());
-    IncidentMetadata::SectionStats* sectionMetadata = metadata->add_sections();
 
     // Notify listener of starting
     mBatch->forEachListener(sectionId, [sectionId](const auto& listener) {
@@ -720,15 +847,36 @@ status_t Reporter::execute_section(const Section* section, IncidentMetadata* met
                 sectionId, IIncidentReportStatusListener::STATUS_STARTING);
     });
 
-    // Go get the data and write it into the file descriptors.
-    mWriter.startSection(sectionId);
-    status_t err = section->Execute(&mWriter);
-    mWriter.endSection(sectionMetadata);
+    // The persisted file may have been abandoned by an earlier section's write
+    // error, so take the current one under the lock.
+    sp<ReportFile> persistedFile;
+    {
+        scoped_lock<mutex> lock(mLock);
+        persistedFile = mPersistedFile;
+    }
+
+    // Go get the data and write it into the file descriptors.  Each section
+    // gets its own writer; writeSection waits for this section's turn.
+    ReportWriter writer(mBatch);
+    writer.setPersistedFile(persistedFile);
+    writer.setMaxPersistedPrivacyPolicy(mMaxPersistedPrivacyPolicy);
+    writer.setSectionOrder(order, index);
+    writer.startSection(sectionId);
+    status_t err = section->Execute(&writer);
+    writer.endSection(sectionMetadata);
+
+    // Take (or keep) the turn for the serialized bookkeeping below, whether or
+    // not Execute got as far as writing anything.
+    if (!order->waitForTurn(index)) {
+        return;
+    }
 
     // Sections returning errors are fatal. Most errors should not be fatal.
     if (err != NO_ERROR) {
-        mWriter.error(section, err, "Section failed. Stopping report.");
-        return err;
+        writer.error(section, err, "Section failed. Stopping report.");
+        *fatalErr = err;
+        order->abort();
+        return;
     }
 
     // The returned max data size is used for throttling too many incident reports.
@@ -748,15 +896,20 @@ status_t Reporter::execute_section(const Section* section, IncidentMetadata* met
     });
 
     ALOGD("Finish incident report section %d '%s'", sectionId, section->name.string());
-    return NO_ERROR;
+    order->finishTurn(index);
 }
 
 void Reporter::cancel_and_remove_failed_requests() {
     // Handle a failure in the persisted file
-    if (mPersistedFile != nullptr) {
-        if (mPersistedFile->getWriteError() != NO_ERROR) {
+    sp<ReportFile> persistedFile;
+    {
+        scoped_lock<mutex> lock(mLock);
+        persistedFile = mPersistedFile;
+    }
+    if (persistedFile != nullptr) {
+        if (persistedFile->getWriteError() != NO_ERROR) {
             ALOGW("Error writing to the persisted file (%s). Closing it and canceling.",
-                    strerror(-mPersistedFile->getWriteError()));
+                    strerror(-persistedFile->getWriteError()));
             mBatch->forEachPersistedRequest([this](const sp<ReportRequest>& request) {
                 sp<IIncidentReportStatusListener> listener = request->getListener();
                 if (listener != nullptr) {
@@ -764,10 +917,12 @@ void Reporter::cancel_and_remove_failed_requests() {
                 }
                 mBatch->removeRequest(request);
             });
-            mWriter.setPersistedFile(nullptr);
-            mPersistedFile->closeDataFile();
-            mWorkDirectory->remove(mPersistedFile);
-            mPersistedFile = nullptr;
+            {
+                scoped_lock<mutex> lock(mLock);
+                mPersistedFile = nullptr;
+            }
+            persistedFile->closeDataFile();
+            mWorkDirectory->remove(persistedFile);
         }
     }
 
@@ -26,7 +26,9 @@
 #include <android/os/IncidentReportArgs.h>
 #include <android/util/protobuf.h>
 
+#include <condition_variable>
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -111,13 +113,20 @@ public:
     /**
      * Returns whether there are any persisted records.
      */
-    bool hasPersistedReports() const { return mPersistedRequests.size() > 0; }
+    bool hasPersistedReports() const;
 
     /**
      * Return the persisted request for the given component, or nullptr.
      */
     sp<ReportRequest> getPersistedRequest(const ComponentName& component);
 
+    /**
+     * Snapshot the persisted and/or streaming requests under the lock.  Either
+     * output may be null; passing the same vector twice appends both lists.
+     */
+    void getAllRequests(vector<sp<ReportRequest>>* persisted,
+            vector<sp<ReportRequest>>* streaming) const;
+
     /**
      * Call func(request) for each Request.
      */
@@ -184,10 +193,52 @@ public:
 
 
 private:
+    // Sections are captured on several worker threads, so the request lists are
+    // guarded by a lock.  The forEach methods snapshot the list and invoke the
+    // callback without the lock held, so callbacks may call back into the batch.
+    mutable mutex mLock;
     map<ComponentName, sp<ReportRequest>> mPersistedRequests;
     vector<sp<ReportRequest>> mStreamingRequests;
 };
 
+// ================================================================================
+/**
+ * Serializes section output while captures run concurrently.  Sections are
+ * captured by a pool of worker threads, but each section's bytes reach the
+ * output file descriptors in section list order, one section at a time.
+ */
+class SectionWriteOrder : public virtual RefBase {
+public:
+    SectionWriteOrder();
+    virtual ~SectionWriteOrder();
+
+    /**
+     * Block until it is this section's turn to write.  Returns false if the
+     * report was aborted by an earlier section's fatal error, in which case
+     * nothing more should be written.
+     */
+    bool waitForTurn(size_t index);
+
+    /**
+     * Advance the turn to the next section.  Must be called exactly once per
+     * index, by the thread that owns that turn.
+     */
+    void finishTurn(size_t index);
+
+    /**
+     * Stop the report.  Sections that have not yet written are skipped.
+     */
+    void abort();
+
+    bool isAborted();
+
+private:
+    mutex mLock;
+    condition_variable mCondition;
+    size_t mNextIndex;
+    bool mAborted;
+};
+
 // ================================================================================
 class ReportWriter {
 public:
@@ -197,6 +248,12 @@ public:
     void setPersistedFile(sp<ReportFile> file);
     void setMaxPersistedPrivacyPolicy(uint8_t privacyPolicy);
 
+    /**
+     * Make writeSection wait for this section's turn in the given order, so
+     * concurrently captured sections stream out in section list order.
+     */
+    void setSectionOrder(const sp<SectionWriteOrder>& order, size_t index);
+
     void startSection(int sectionId);
     void endSection(IncidentMetadata::SectionStats* sectionStats);
 
@@ -222,6 +279,12 @@ private:
      */
     uint8_t mMaxPersistedPrivacyPolicy;
 
+    /**
+     * If set, writeSection blocks until it is this section's turn to write.
+     */
+    sp<SectionWriteOrder> mSectionOrder;
+    size_t mSectionOrderIndex;
+
     /**
      * The current section that is being written.
      */
@@ -269,14 +332,26 @@ public:
 
 private:
     sp<WorkDirectory> mWorkDirectory;
-    ReportWriter mWriter;
     sp<ReportBatch> mBatch;
+    // Guards mPersistedFile while section workers are running; it is cleared
+    // if the file hits a write error mid-report.
+    mutable mutex mLock;
     sp<ReportFile> mPersistedFile;
+    uint8_t mMaxPersistedPrivacyPolicy;
     const vector<BringYourOwnSection*>& mRegisteredSections;
 
-    status_t execute_section(const Section* section, IncidentMetadata* metadata,
+    // Capture the given sections on a bounded pool of worker threads, writing
+    // the completed ones to the output in list order.  Returns the first fatal
+    // section error, or NO_ERROR.
+    status_t execute_sections(const vector<const Section*>& sections, IncidentMetadata* metadata,
         size_t* reportByteSize);
 
+    // Runs on a worker thread.  Captures one section and, once it owns the
+    // turn for the given index, does the post-section bookkeeping.
+    void execute_section(const Section* section, IncidentMetadata::SectionStats* sectionMetadata,
+        const sp<SectionWriteOrder>& order, size_t index, size_t* reportByteSize,
+        status_t* fatalErr);
+
     void cancel_and_remove_failed_requests();
 };
 
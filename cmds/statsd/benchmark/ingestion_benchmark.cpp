@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <vector>
+#include "benchmark/benchmark.h"
+#include "logd/LogEvent.h"
+#include "stats_log_util.h"
+#include "metric_util.h"
+
+namespace android {
+namespace os {
+namespace statsd {
+
+using std::vector;
+
+// End-to-end ingestion benchmarks: synthetic atom mixes pushed through a real
+// StatsLogProcessor with a representative config. The socket and queue stages
+// run in other threads on a device and are not reproducible in-process, so
+// events enter at OnLogEvent(); events/sec falls out of SetItemsProcessed()
+// and latency percentiles come from --benchmark_repetitions aggregates.
+
+// A config that keeps every stage of the pipeline busy: six matchers, three
+// simple predicates plus a combination, and one metric of each of the event,
+// count, and duration flavors.
+static StatsdConfig CreateIngestionConfig() {
+    StatsdConfig config;
+    *config.add_atom_matcher() = CreateScreenTurnedOnAtomMatcher();
+    *config.add_atom_matcher() = CreateScreenTurnedOffAtomMatcher();
+    *config.add_atom_matcher() = CreateSyncStartAtomMatcher();
+    *config.add_atom_matcher() = CreateSyncEndAtomMatcher();
+    *config.add_atom_matcher() = CreateStartScheduledJobAtomMatcher();
+    *config.add_atom_matcher() = CreateFinishScheduledJobAtomMatcher();
+
+    auto screenIsOffPredicate = CreateScreenIsOffPredicate();
+
+    auto isSyncingPredicate = CreateIsSyncingPredicate();
+    auto syncDimension = isSyncingPredicate.mutable_simple_predicate()->mutable_dimensions();
+    *syncDimension = CreateAttributionUidAndTagDimensions(android::util::SYNC_STATE_CHANGED,
+                                                          {Position::FIRST});
+
+    auto scheduledJobPredicate = CreateScheduledJobPredicate();
+    auto jobDimensions = scheduledJobPredicate.mutable_simple_predicate()->mutable_dimensions();
+    jobDimensions->set_field(android::util::SCHEDULED_JOB_STATE_CHANGED);
+    jobDimensions->add_child()->set_field(2);  // job name field.
+
+    *config.add_predicate() = screenIsOffPredicate;
+    *config.add_predicate() = isSyncingPredicate;
+    *config.add_predicate() = scheduledJobPredicate;
+    auto combinationPredicate = config.add_predicate();
+    combinationPredicate->set_id(StringToId("ScreenOffAndSyncing"));
+    combinationPredicate->mutable_combination()->set_operation(LogicalOperation::AND);
+    addPredicateToPredicateCombination(screenIsOffPredicate, combinationPredicate);
+    addPredicateToPredicateCombination(isSyncingPredicate, combinationPredicate);
+
+    auto eventMetric = config.add_event_metric();
+    eventMetric->set_id(StringToId("ScreenEvents"));
+    eventMetric->set_what(StringToId("ScreenTurnedOn"));
+
+    auto countMetric = config.add_count_metric();
+    countMetric->set_id(StringToId("SyncCount"));
+    countMetric->set_what(StringToId("SyncStart"));
+    countMetric->set_condition(screenIsOffPredicate.id());
+    countMetric->set_bucket(FIVE_MINUTES);
+    *countMetric->mutable_dimensions_in_what() = CreateAttributionUidAndTagDimensions(
+            android::util::SYNC_STATE_CHANGED, {Position::FIRST});
+
+    auto durationMetric = config.add_duration_metric();
+    durationMetric->set_id(StringToId("JobDuration"));
+    durationMetric->set_what(scheduledJobPredicate.id());
+    durationMetric->set_condition(combinationPredicate->id());
+    durationMetric->set_aggregation_type(DurationMetric::SUM);
+    durationMetric->set_bucket(FIVE_MINUTES);
+    auto durationDimensions = durationMetric->mutable_dimensions_in_what();
+    durationDimensions->set_field(android::util::SCHEDULED_JOB_STATE_CHANGED);
+    durationDimensions->add_child()->set_field(2);  // job name field.
+    return config;
+}
+
+// Generates eventCount events: sync and scheduled job start/stop pairs spread
+// over a handful of uids, with a screen state toggle every conditionInterval
+// events so the condition trackers see churn at a controlled rate.
+static void GenerateEventMix(int64_t baseTimeNs, int eventCount, int conditionInterval,
+                             vector<std::unique_ptr<LogEvent>>* events) {
+    const vector<int> uids[] = {{111}, {222, 333, 333}, {444}};
+    const vector<string> tags[] = {{"App1"}, {"App2", "GMSCoreModule1", "GMSCoreModule2"},
+                                   {"App3"}};
+    const string syncNames[] = {"ReadEmail", "ReadDoc"};
+    const string jobNames[] = {"job1", "job2"};
+    bool screenOn = false;
+    for (int i = 0; i < eventCount; i++) {
+        const int64_t timeNs = baseTimeNs + i * 10;
+        if (i % conditionInterval == 0) {
+            events->push_back(CreateScreenStateChangedEvent(
+                    timeNs, screenOn ? android::view::DISPLAY_STATE_OFF
+                                     : android::view::DISPLAY_STATE_ON));
+            screenOn = !screenOn;
+            continue;
+        }
+        const int app = i % 3;
+        switch (i % 4) {
+            case 0:
+                events->push_back(CreateSyncStartEvent(timeNs, uids[app], tags[app],
+                                                       syncNames[i % 2]));
+                break;
+            case 1:
+                events->push_back(CreateSyncEndEvent(timeNs, uids[app], tags[app],
+                                                     syncNames[i % 2]));
+                break;
+            case 2:
+                events->push_back(CreateStartScheduledJobEvent(timeNs, uids[app], tags[app],
+                                                               jobNames[i % 2]));
+                break;
+            default:
+                events->push_back(CreateFinishScheduledJobEvent(timeNs, uids[app], tags[app],
+                                                                jobNames[i % 2]));
+                break;
+        }
+    }
+}
+
+// Arg: events between screen state toggles. Small values stress condition
+// re-evaluation; large values approximate a steady matched-event stream.
+static void BM_IngestMixedEventStream(benchmark::State& state) {
+    ConfigKey cfgKey;
+    auto config = CreateIngestionConfig();
+    int64_t bucketStartTimeNs = 10000000000;
+
+    vector<std::unique_ptr<LogEvent>> events;
+    GenerateEventMix(bucketStartTimeNs + 1, 2000, state.range(0), &events);
+
+    while (state.KeepRunning()) {
+        auto processor = CreateStatsLogProcessor(bucketStartTimeNs / NS_PER_SEC, config, cfgKey);
+        for (const auto& event : events) {
+            processor->OnLogEvent(event.get());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * events.size());
+}
+
+BENCHMARK(BM_IngestMixedEventStream)->Arg(2)->Arg(20)->Arg(200);
+
+// Arg: number of configs registered. Every event fans out to each matching
+// config, which is where per-event work concentrates on multi-tenant devices.
+static void BM_IngestEventStreamManyConfigs(benchmark::State& state) {
+    auto config = CreateIngestionConfig();
+    int64_t bucketStartTimeNs = 10000000000;
+
+    vector<std::unique_ptr<LogEvent>> events;
+    GenerateEventMix(bucketStartTimeNs + 1, 2000, 20, &events);
+
+    while (state.KeepRunning()) {
+        auto processor = CreateStatsLogProcessor(bucketStartTimeNs / NS_PER_SEC, config,
+                                                 ConfigKey(0, StringToId("Config0")));
+        for (int i = 1; i < state.range(0); i++) {
+            processor->OnConfigUpdated(bucketStartTimeNs, ConfigKey(i, StringToId("Config")),
+                                       config);
+        }
+        for (const auto& event : events) {
+            processor->OnLogEvent(event.get());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * events.size());
+}
+
+BENCHMARK(BM_IngestEventStreamManyConfigs)->Arg(1)->Arg(5)->Arg(20);
+
+// Ingests a stream and then serializes the report, covering the path a
+// GET_DATA_CALLED broadcast triggers once buckets have accumulated state.
+static void BM_IngestAndDumpReport(benchmark::State& state) {
+    ConfigKey cfgKey;
+    auto config = CreateIngestionConfig();
+    int64_t bucketStartTimeNs = 10000000000;
+
+    vector<std::unique_ptr<LogEvent>> events;
+    GenerateEventMix(bucketStartTimeNs + 1, 2000, 20, &events);
+    const int64_t dumpTimeNs = bucketStartTimeNs + 2000 * 10 + 1;
+
+    while (state.KeepRunning()) {
+        auto processor = CreateStatsLogProcessor(bucketStartTimeNs / NS_PER_SEC, config, cfgKey);
+        for (const auto& event : events) {
+            processor->OnLogEvent(event.get());
+        }
+        vector<uint8_t> bytes;
+        processor->onDumpReport(cfgKey, dumpTimeNs, true /* include_current_partial_bucket */,
+                                true /* erase_data */, GET_DATA_CALLED, NO_TIME_CONSTRAINTS,
+                                &bytes);
+        benchmark::DoNotOptimize(bytes);
+    }
+    state.SetItemsProcessed(state.iterations() * events.size());
+}
+
+BENCHMARK(BM_IngestAndDumpReport);
+
+}  //  namespace statsd
+}  //  namespace os
+}  //  namespace android
@@ -163,6 +163,32 @@ Value::Value(const Value& from) {
     }
 }
 
+Value::Value(Value&& from) noexcept {
+    type = from.getType();
+    switch (type) {
+        case INT:
+            int_value = from.int_value;
+            break;
+        case LONG:
+            long_value = from.long_value;
+            break;
+        case FLOAT:
+            float_value = from.float_value;
+            break;
+        case DOUBLE:
+            double_value = from.double_value;
+            break;
+        case STRING:
+            str_value = std::move(from.str_value);
+            break;
+        case STORAGE:
+            storage_value = std::move(from.storage_value);
+            break;
+        default:
+            break;
+    }
+}
+
 std::string Value::toString() const {
     switch (type) {
         case INT:
@@ -367,6 +393,33 @@ Value& Value::operator=(const Value& that) {
     return *this;
 }
 
+Value& Value::operator=(Value&& that) noexcept {
+    type = that.type;
+    switch (type) {
+        case INT:
+            int_value = that.int_value;
+            break;
+        case LONG:
+            long_value = that.long_value;
+            break;
+        case FLOAT:
+            float_value = that.float_value;
+            break;
+        case DOUBLE:
+            double_value = that.double_value;
+            break;
+        case STRING:
+            str_value = std::move(that.str_value);
+            break;
+        case STORAGE:
+            storage_value = std::move(that.storage_value);
+            break;
+        default:
+            break;
+    }
+    return *this;
+}
+
 Value& Value::operator+=(const Value& that) {
     if (type != that.type) {
         ALOGE("Can't operate on different value types, %d, %d", type, that.type);
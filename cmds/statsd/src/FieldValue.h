@@ -299,11 +299,21 @@ struct Value {
         type = STRING;
     }
 
+    Value(std::string&& v) {
+        str_value = std::move(v);
+        type = STRING;
+    }
+
     Value(const std::vector<uint8_t>& v) {
         storage_value = v;
         type = STORAGE;
     }
 
+    Value(std::vector<uint8_t>&& v) {
+        storage_value = std::move(v);
+        type = STORAGE;
+    }
+
     void setInt(int32_t v) {
         int_value = v;
         type = INT;
@@ -347,6 +357,10 @@ struct Value {
 
     Value(const Value& from);
 
+    // Moves keep string and storage payloads instead of reallocating them, so growing a
+    // FieldValue vector or handing a parsed value off does not copy the heap data.
+    Value(Value&& from) noexcept;
+
     bool operator==(const Value& that) const;
     bool operator!=(const Value& that) const;
 
@@ -356,6 +370,7 @@ struct Value {
     Value operator-(const Value& that) const;
     Value& operator+=(const Value& that);
     Value& operator=(const Value& that);
+    Value& operator=(Value&& that) noexcept;
 };
 
 class Annotations {
@@ -415,6 +430,8 @@ struct FieldValue {
     FieldValue() {}
     FieldValue(const Field& field, const Value& value) : mField(field), mValue(value) {
     }
+    FieldValue(const Field& field, Value&& value) : mField(field), mValue(std::move(value)) {
+    }
     bool operator==(const FieldValue& that) const {
         return mField == that.mField && mValue == that.mValue;
     }
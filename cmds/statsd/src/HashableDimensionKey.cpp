@@ -121,8 +121,15 @@ StatsDimensionsValueParcel HashableDimensionKey::toStatsDimensionsValueParcel()
 }
 
 android::hash_t hashDimension(const HashableDimensionKey& value) {
+    return value.hash();
+}
+
+android::hash_t HashableDimensionKey::hash() const {
+    if (mHashValid) {
+        return mHash;
+    }
     android::hash_t hash = 0;
-    for (const auto& fieldValue : value.getValues()) {
+    for (const auto& fieldValue : mValues) {
         hash = android::JenkinsHashMix(hash, android::hash_type((int)fieldValue.mField.getField()));
         hash = android::JenkinsHashMix(hash, android::hash_type((int)fieldValue.mField.getTag()));
         hash = android::JenkinsHashMix(hash, android::hash_type((int)fieldValue.mValue.getType()));
@@ -148,7 +155,9 @@ android::hash_t hashDimension(const HashableDimensionKey& value) {
                 break;
         }
     }
-    return JenkinsHashWhiten(hash);
+    mHash = JenkinsHashWhiten(hash);
+    mHashValid = true;
+    return mHash;
 }
 
 bool filterValues(const Matcher& matcherField, const vector<FieldValue>& values,
@@ -307,6 +316,9 @@ bool HashableDimensionKey::operator!=(const HashableDimensionKey& that) const {
 }
 
 bool HashableDimensionKey::operator==(const HashableDimensionKey& that) const {
+    if (mHashValid && that.mHashValid && mHash != that.mHash) {
+        return false;
+    }
     if (mValues.size() != that.getValues().size()) {
         return false;
     }
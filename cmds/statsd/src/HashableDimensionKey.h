@@ -49,10 +49,12 @@ public:
 
     HashableDimensionKey() {};
 
-    HashableDimensionKey(const HashableDimensionKey& that) : mValues(that.getValues()){};
+    HashableDimensionKey(const HashableDimensionKey& that)
+        : mValues(that.getValues()), mHash(that.mHash), mHashValid(that.mHashValid){};
 
     inline void addValue(const FieldValue& value) {
         mValues.push_back(value);
+        mHashValid = false;
     }
 
     inline const std::vector<FieldValue>& getValues() const {
@@ -60,16 +62,26 @@ public:
     }
 
     inline std::vector<FieldValue>* mutableValues() {
+        mHashValid = false;
         return &mValues;
     }
 
     inline FieldValue* mutableValue(size_t i) {
         if (i >= 0 && i < mValues.size()) {
+            mHashValid = false;
             return &(mValues[i]);
         }
         return nullptr;
     }
 
+    /**
+     * Hash over all values, computed once and then reused across map probes
+     * until the key is mutated. Sliced metrics probe maps with the same key
+     * many times per event, so the hash of a vector of variants is worth
+     * caching.
+     */
+    android::hash_t hash() const;
+
     StatsDimensionsValueParcel toStatsDimensionsValueParcel() const;
 
     std::string toString() const;
@@ -84,6 +96,10 @@ public:
 
 private:
     std::vector<FieldValue> mValues;
+
+    // Cached result of hash(); invalidated by the mutable accessors above.
+    mutable android::hash_t mHash = 0;
+    mutable bool mHashValid = false;
 };
 
 class MetricDimensionKey {
@@ -386,7 +386,7 @@ void StatsLogProcessor::OnLogEvent(LogEvent* event) {
 }
 
 void StatsLogProcessor::OnLogEvent(LogEvent* event, int64_t elapsedRealtimeNs) {
-    std::lock_guard<std::mutex> lock(mMetricsMutex);
+    std::unique_lock<std::mutex> lock(mMetricsMutex);
 
     // Tell StatsdStats about new event
     const int64_t eventElapsedTimeNs = event->GetElapsedTimestampNs();
@@ -437,10 +437,17 @@ void StatsLogProcessor::OnLogEvent(LogEvent* event, int64_t elapsedRealtimeNs) {
         mLastPullerCacheClearTimeSec = curTimeSec;
     }
 
+    // Snapshot the registry so the event can be handed to each config without holding the
+    // registry lock. Each MetricsManager serializes itself under its own lock, so a slow
+    // dump of one config only blocks that config, not live event processing for the others.
+    std::vector<std::pair<ConfigKey, sp<MetricsManager>>> metricsManagers(
+            mMetricsManagers.begin(), mMetricsManagers.end());
+    lock.unlock();
+
     std::unordered_set<int> uidsWithActiveConfigsChanged;
     std::unordered_map<int, std::vector<int64_t>> activeConfigsPerUid;
     // pass the event to metrics managers.
-    for (auto& pair : mMetricsManagers) {
+    for (auto& pair : metricsManagers) {
         int uid = pair.first.GetUid();
         int64_t configId = pair.first.GetId();
         bool isPrevActive = pair.second->isActive();
@@ -463,6 +470,11 @@ void StatsLogProcessor::OnLogEvent(LogEvent* event, int64_t elapsedRealtimeNs) {
             uidsWithActiveConfigsChanged.insert(uid);
             StatsdStats::getInstance().noteActiveStatusChanged(pair.first, isCurActive);
         }
+    }
+
+    // The guardrail checks touch the cross-config bookkeeping, so retake the registry lock.
+    lock.lock();
+    for (auto& pair : metricsManagers) {
         flushIfNecessaryLocked(pair.first, *(pair.second));
     }
 
@@ -510,9 +522,17 @@ void StatsLogProcessor::GetActiveConfigsLocked(const int uid, vector<int64_t>& o
 
 void StatsLogProcessor::OnConfigUpdated(const int64_t timestampNs, const ConfigKey& key,
                                         const StatsdConfig& config) {
+    std::lock_guard<std::mutex> configLock(mConfigUpdateMutex);
+    VLOG("Updated configuration for key %s", key.ToString().c_str());
+    // Parsing the config and building all matchers, conditions and metric producers is
+    // the expensive part of a config push and only touches the new manager, so it runs
+    // without mMetricsMutex held and events keep flowing until the brief swap below.
+    sp<MetricsManager> newMetricsManager =
+            new MetricsManager(key, config, mTimeBaseNs, timestampNs, mUidMap, mPullerManager,
+                               mAnomalyAlarmMonitor, mPeriodicAlarmMonitor);
     std::lock_guard<std::mutex> lock(mMetricsMutex);
     WriteDataToDiskLocked(key, timestampNs, CONFIG_UPDATED, NO_TIME_CONSTRAINTS);
-    OnConfigUpdatedLocked(timestampNs, key, config);
+    installMetricsManagerLocked(timestampNs, key, newMetricsManager);
 }
 
 void StatsLogProcessor::OnConfigUpdatedLocked(
@@ -521,6 +541,12 @@ void StatsLogProcessor::OnConfigUpdatedLocked(
     sp<MetricsManager> newMetricsManager =
             new MetricsManager(key, config, mTimeBaseNs, timestampNs, mUidMap, mPullerManager,
                                mAnomalyAlarmMonitor, mPeriodicAlarmMonitor);
+    installMetricsManagerLocked(timestampNs, key, newMetricsManager);
+}
+
+void StatsLogProcessor::installMetricsManagerLocked(const int64_t timestampNs,
+                                                    const ConfigKey& key,
+                                                    const sp<MetricsManager>& newMetricsManager) {
     if (newMetricsManager->isConfigValid()) {
         newMetricsManager->init();
         mUidMap->OnConfigUpdated(key);
@@ -568,7 +594,20 @@ void StatsLogProcessor::onDumpReport(const ConfigKey& key, const int64_t dumpTim
                                      const DumpReportReason dumpReportReason,
                                      const DumpLatency dumpLatency,
                                      ProtoOutputStream* proto) {
-    std::lock_guard<std::mutex> lock(mMetricsMutex);
+    // Only hold the registry lock long enough to look up the config. The actual
+    // serialization happens under the manager's own lock so that events for the other
+    // configs keep flowing while this one is dumped.
+    sp<MetricsManager> metricsManager;
+    {
+        std::lock_guard<std::mutex> lock(mMetricsMutex);
+        auto it = mMetricsManagers.find(key);
+        if (it != mMetricsManagers.end()) {
+            metricsManager = it->second;
+            // This allows another broadcast to be sent within the rate-limit period if we
+            // get close to filling the buffer again soon.
+            mLastBroadcastTimes.erase(key);
+        }
+    }
 
     // Start of ConfigKey.
     uint64_t configKeyToken = proto->start(FIELD_TYPE_MESSAGE | FIELD_ID_CONFIG_KEY);
@@ -577,11 +616,7 @@ void StatsLogProcessor::onDumpReport(const ConfigKey& key, const int64_t dumpTim
     proto->end(configKeyToken);
     // End of ConfigKey.
 
-    bool keepFile = false;
-    auto it = mMetricsManagers.find(key);
-    if (it != mMetricsManagers.end() && it->second->shouldPersistLocalHistory()) {
-        keepFile = true;
-    }
+    bool keepFile = metricsManager != nullptr && metricsManager->shouldPersistLocalHistory();
 
     // Then, check stats-data directory to see there's any file containing
     // ConfigMetricsReport from previous shutdowns to concatenate to reports.
@@ -589,15 +624,12 @@ void StatsLogProcessor::onDumpReport(const ConfigKey& key, const int64_t dumpTim
             key, proto, erase_data && !keepFile /* should remove file after appending it */,
             dumpReportReason == ADB_DUMP /*if caller is adb*/);
 
-    if (it != mMetricsManagers.end()) {
-        // This allows another broadcast to be sent within the rate-limit period if we get close to
-        // filling the buffer again soon.
-        mLastBroadcastTimes.erase(key);
-
+    if (metricsManager != nullptr) {
         vector<uint8_t> buffer;
-        onConfigMetricsReportLocked(key, dumpTimeStampNs, include_current_partial_bucket,
-                                    erase_data, dumpReportReason, dumpLatency,
-                                    false /* is this data going to be saved on disk */, &buffer);
+        onConfigMetricsReport(key, metricsManager, dumpTimeStampNs,
+                              include_current_partial_bucket, erase_data, dumpReportReason,
+                              dumpLatency, false /* is this data going to be saved on disk */,
+                              &buffer);
         proto->write(FIELD_TYPE_MESSAGE | FIELD_COUNT_REPEATED | FIELD_ID_REPORTS,
                      reinterpret_cast<char*>(buffer.data()), buffer.size());
     } else {
@@ -627,37 +659,34 @@ void StatsLogProcessor::onDumpReport(const ConfigKey& key, const int64_t dumpTim
 }
 
 /*
- * onConfigMetricsReportLocked dumps serialized ConfigMetricsReport into outData.
+ * onConfigMetricsReport dumps serialized ConfigMetricsReport into outData. The metrics
+ * manager dumps itself under its own lock, so this runs without mMetricsMutex held.
  */
-void StatsLogProcessor::onConfigMetricsReportLocked(
-        const ConfigKey& key, const int64_t dumpTimeStampNs,
+void StatsLogProcessor::onConfigMetricsReport(
+        const ConfigKey& key, const sp<MetricsManager>& metricsManager,
+        const int64_t dumpTimeStampNs,
         const bool include_current_partial_bucket, const bool erase_data,
         const DumpReportReason dumpReportReason, const DumpLatency dumpLatency,
         const bool dataSavedOnDisk, vector<uint8_t>* buffer) {
-    // We already checked whether key exists in mMetricsManagers in
-    // WriteDataToDisk.
-    auto it = mMetricsManagers.find(key);
-    if (it == mMetricsManagers.end()) {
-        return;
-    }
-    int64_t lastReportTimeNs = it->second->getLastReportTimeNs();
-    int64_t lastReportWallClockNs = it->second->getLastReportWallClockNs();
+    int64_t lastReportTimeNs = metricsManager->getLastReportTimeNs();
+    int64_t lastReportWallClockNs = metricsManager->getLastReportWallClockNs();
 
     std::set<string> str_set;
 
     ProtoOutputStream tempProto;
     // First, fill in ConfigMetricsReport using current data on memory, which
     // starts from filling in StatsLogReport's.
-    it->second->onDumpReport(dumpTimeStampNs, include_current_partial_bucket, erase_data,
-                             dumpLatency, &str_set, &tempProto);
+    metricsManager->onDumpReport(dumpTimeStampNs, include_current_partial_bucket, erase_data,
+                                 dumpLatency, &str_set, &tempProto);
 
     // Fill in UidMap if there is at least one metric to report.
     // This skips the uid map if it's an empty config.
-    if (it->second->getNumMetrics() > 0) {
+    if (metricsManager->getNumMetrics() > 0) {
         uint64_t uidMapToken = tempProto.start(FIELD_TYPE_MESSAGE | FIELD_ID_UID_MAP);
         mUidMap->appendUidMap(
-                dumpTimeStampNs, key, it->second->hashStringInReport() ? &str_set : nullptr,
-                it->second->versionStringsInReport(), it->second->installerInReport(), &tempProto);
+                dumpTimeStampNs, key, metricsManager->hashStringInReport() ? &str_set : nullptr,
+                metricsManager->versionStringsInReport(), metricsManager->installerInReport(),
+                &tempProto);
         tempProto.end(uidMapToken);
     }
 
@@ -680,11 +709,14 @@ void StatsLogProcessor::onConfigMetricsReportLocked(
     flushProtoToBuffer(tempProto, buffer);
 
     // save buffer to disk if needed
-    if (erase_data && !dataSavedOnDisk && it->second->shouldPersistLocalHistory()) {
+    if (erase_data && !dataSavedOnDisk && metricsManager->shouldPersistLocalHistory()) {
         VLOG("save history to disk");
         string file_name = StorageManager::getDataHistoryFileName((long)getWallClockSec(),
                                                                   key.GetUid(), key.GetId());
-        StorageManager::writeFile(file_name.c_str(), buffer->data(), buffer->size());
+        StorageManager::writeCompressedFile(file_name.c_str(), buffer->data(), buffer->size(),
+                                            dumpLatency == FAST
+                                                    ? StorageManager::kCompressionLevelFast
+                                                    : StorageManager::kCompressionLevelDefault);
     }
 }
 
@@ -798,17 +830,20 @@ void StatsLogProcessor::WriteDataToDiskLocked(const ConfigKey& key,
                                               const int64_t timestampNs,
                                               const DumpReportReason dumpReportReason,
                                               const DumpLatency dumpLatency) {
-    if (mMetricsManagers.find(key) == mMetricsManagers.end() ||
-        !mMetricsManagers.find(key)->second->shouldWriteToDisk()) {
+    auto it = mMetricsManagers.find(key);
+    if (it == mMetricsManagers.end() || !it->second->shouldWriteToDisk()) {
         return;
     }
     vector<uint8_t> buffer;
-    onConfigMetricsReportLocked(key, timestampNs, true /* include_current_partial_bucket*/,
-                                true /* erase_data */, dumpReportReason, dumpLatency, true,
-                                &buffer);
+    onConfigMetricsReport(key, it->second, timestampNs,
+                          true /* include_current_partial_bucket*/, true /* erase_data */,
+                          dumpReportReason, dumpLatency, true, &buffer);
     string file_name =
             StorageManager::getDataFileName((long)getWallClockSec(), key.GetUid(), key.GetId());
-    StorageManager::writeFile(file_name.c_str(), buffer.data(), buffer.size());
+    StorageManager::writeCompressedFile(file_name.c_str(), buffer.data(), buffer.size(),
+                                        dumpLatency == FAST
+                                                ? StorageManager::kCompressionLevelFast
+                                                : StorageManager::kCompressionLevelDefault);
 
     // We were able to write the ConfigMetricsReport to disk, so we should trigger collection ASAP.
     mOnDiskDataConfigs.insert(key);
@@ -158,8 +158,17 @@ private:
         return mPeriodicAlarmMonitor;
     }
 
+    // Guards the config registry and the cross-config bookkeeping below. Metric state that
+    // belongs to an individual config is guarded by that MetricsManager's own lock, which
+    // may be acquired while this mutex is held but never the other way around.
     mutable mutex mMetricsMutex;
 
+    // Serializes config pushes with each other. The expensive MetricsManager construction
+    // runs under this mutex but outside mMetricsMutex, so two pushes for the same key
+    // cannot interleave while events keep flowing. Acquired before mMetricsMutex, never
+    // the other way around.
+    mutable mutex mConfigUpdateMutex;
+
     std::unordered_map<ConfigKey, sp<MetricsManager>> mMetricsManagers;
 
     std::unordered_map<ConfigKey, int64_t> mLastBroadcastTimes;
@@ -188,6 +197,11 @@ private:
     void OnConfigUpdatedLocked(
         const int64_t currentTimestampNs, const ConfigKey& key, const StatsdConfig& config);
 
+    // Installs an already-constructed MetricsManager for the config key, replacing any
+    // existing one. The caller must hold mMetricsMutex.
+    void installMetricsManagerLocked(const int64_t currentTimestampNs, const ConfigKey& key,
+                                     const sp<MetricsManager>& newMetricsManager);
+
     void GetActiveConfigsLocked(const int uid, vector<int64_t>& outActiveConfigs);
 
     void WriteActiveConfigsToProtoOutputStreamLocked(
@@ -211,8 +225,11 @@ private:
                                const DumpReportReason dumpReportReason,
                                const DumpLatency dumpLatency);
 
-    void onConfigMetricsReportLocked(
-            const ConfigKey& key, const int64_t dumpTimeStampNs,
+    /* Serializes one config's ConfigMetricsReport. The metrics manager dumps itself under
+     * its own lock, so callers do not need to hold mMetricsMutex. */
+    void onConfigMetricsReport(
+            const ConfigKey& key, const sp<MetricsManager>& metricsManager,
+            const int64_t dumpTimeStampNs,
             const bool include_current_partial_bucket, const bool erase_data,
             const DumpReportReason dumpReportReason, const DumpLatency dumpLatency,
             /*if dataSavedToDisk is true, it indicates the caller will write the data to disk
@@ -45,9 +45,8 @@ void AlarmMonitor::setStatsCompanionService(
         return;
     }
     VLOG("Creating link to statsCompanionService");
-    const sp<const InternalAlarm> top = mPq.top();
-    if (top != nullptr) {
-        updateRegisteredAlarmTime_l(top->timestampSec);
+    if (!mAlarms.empty()) {
+        updateRegisteredAlarmTime_l(mAlarms.begin()->first);
     }
 }
 
@@ -64,7 +63,7 @@ void AlarmMonitor::add(sp<const InternalAlarm> alarm) {
     }
     // TODO(b/110563466): Ensure that refractory period is respected.
     VLOG("Adding alarm with time %u", alarm->timestampSec);
-    mPq.push(alarm);
+    mAlarms[alarm->timestampSec].insert(alarm);
     if (mRegisteredAlarmTimeSec < 1 ||
         alarm->timestampSec + mMinUpdateTimeSec < mRegisteredAlarmTimeSec) {
         updateRegisteredAlarmTime_l(alarm->timestampSec);
@@ -78,41 +77,44 @@ void AlarmMonitor::remove(sp<const InternalAlarm> alarm) {
         return;
     }
     VLOG("Removing alarm with time %u", alarm->timestampSec);
-    bool wasPresent = mPq.remove(alarm);
-    if (!wasPresent) return;
-    if (mPq.empty()) {
+    auto bucketIt = mAlarms.find(alarm->timestampSec);
+    if (bucketIt == mAlarms.end() || bucketIt->second.erase(alarm) == 0) return;
+    if (bucketIt->second.empty()) {
+        mAlarms.erase(bucketIt);
+    }
+    if (mAlarms.empty()) {
         VLOG("Queue is empty. Cancel any alarm.");
         cancelRegisteredAlarmTime_l();
         return;
     }
-    uint32_t soonestAlarmTimeSec = mPq.top()->timestampSec;
+    uint32_t soonestAlarmTimeSec = mAlarms.begin()->first;
     VLOG("Soonest alarm is %u", soonestAlarmTimeSec);
     if (soonestAlarmTimeSec > mRegisteredAlarmTimeSec + mMinUpdateTimeSec) {
         updateRegisteredAlarmTime_l(soonestAlarmTimeSec);
     }
 }
 
-// More efficient than repeatedly calling remove(mPq.top()) since it batches the
-// updates to the registered alarm.
+// More efficient than repeatedly calling remove() on the soonest alarm since it expires
+// whole buckets and batches the updates to the registered alarm.
 unordered_set<sp<const InternalAlarm>, SpHash<InternalAlarm>> AlarmMonitor::popSoonerThan(
         uint32_t timestampSec) {
     VLOG("Removing alarms with time <= %u", timestampSec);
     unordered_set<sp<const InternalAlarm>, SpHash<InternalAlarm>> oldAlarms;
     std::lock_guard<std::mutex> lock(mLock);
 
-    for (sp<const InternalAlarm> t = mPq.top(); t != nullptr && t->timestampSec <= timestampSec;
-        t = mPq.top()) {
-        oldAlarms.insert(t);
-        mPq.pop();  // remove t
+    auto bucketIt = mAlarms.begin();
+    while (bucketIt != mAlarms.end() && bucketIt->first <= timestampSec) {
+        oldAlarms.insert(bucketIt->second.begin(), bucketIt->second.end());
+        bucketIt = mAlarms.erase(bucketIt);
     }
     // Always update registered alarm time (if anything has changed).
     if (!oldAlarms.empty()) {
-        if (mPq.empty()) {
+        if (mAlarms.empty()) {
             VLOG("Queue is empty. Cancel any alarm.");
             cancelRegisteredAlarmTime_l();
         } else {
             // Always update the registered alarm in this case (unlike remove()).
-            updateRegisteredAlarmTime_l(mPq.top()->timestampSec);
+            updateRegisteredAlarmTime_l(mAlarms.begin()->first);
         }
     }
     return oldAlarms;
@@ -21,6 +21,7 @@
 #include <aidl/android/os/IStatsCompanionService.h>
 #include <utils/RefBase.h>
 
+#include <map>
 #include <unordered_set>
 #include <vector>
 
@@ -46,13 +47,6 @@ struct InternalAlarm : public RefBase {
     }
 
     const uint32_t timestampSec;
-
-    /** InternalAlarm a is smaller (higher priority) than b if its timestamp is sooner. */
-    struct SmallerTimestamp {
-        bool operator()(sp<const InternalAlarm> a, sp<const InternalAlarm> b) const {
-            return (a->timestampSec < b->timestampSec);
-        }
-    };
 };
 
 /**
@@ -119,9 +113,13 @@ private:
     uint32_t mRegisteredAlarmTimeSec;
 
     /**
-     * Priority queue of alarms, prioritized by soonest alarm.timestampSec.
+     * Alarms bucketed by their whole-second expiry time, soonest bucket first. Alarm
+     * timestamps have second granularity, so with many short-lived alarms sharing few
+     * distinct seconds this behaves like a timing wheel: adding or cancelling an alarm
+     * only touches its own bucket, and expiry pops whole buckets at once instead of
+     * sifting a heap once per alarm.
      */
-    indexed_priority_queue<InternalAlarm, InternalAlarm::SmallerTimestamp> mPq;
+    std::map<uint32_t, unordered_set<sp<const InternalAlarm>, SpHash<InternalAlarm>>> mAlarms;
 
     /**
      * Binder interface for communicating with StatsCompanionService.
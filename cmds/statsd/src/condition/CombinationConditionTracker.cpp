@@ -113,6 +113,12 @@ void CombinationConditionTracker::isConditionMet(
         const ConditionKey& conditionParameters, const vector<sp<ConditionTracker>>& allConditions,
         const bool isPartialLink,
         vector<ConditionState>& conditionCache) const {
+    // Non-sliced combinations keep their value memoized in evaluateCondition, so queries
+    // can be served without walking the tree.
+    if (!mSliced && mUnSlicedPartCondition != ConditionState::kUnknown) {
+        conditionCache[mIndex] = mUnSlicedPartCondition;
+        return;
+    }
     // So far, this is fine as there is at most one child having sliced output.
     for (const int childIndex : mChildren) {
         if (conditionCache[childIndex] == ConditionState::kNotEvaluated) {
@@ -135,6 +141,7 @@ void CombinationConditionTracker::evaluateCondition(
         return;
     }
 
+    bool anyChildChanged = false;
     for (const int childIndex : mChildren) {
         // So far, this is fine as there is at most one child having sliced output.
         if (nonSlicedConditionCache[childIndex] == ConditionState::kNotEvaluated) {
@@ -142,29 +149,40 @@ void CombinationConditionTracker::evaluateCondition(
             child->evaluateCondition(event, eventMatcherValues, mAllConditions,
                                      nonSlicedConditionCache, conditionChangedCache);
         }
+        anyChildChanged |= conditionChangedCache[childIndex];
     }
 
-    ConditionState newCondition =
-            evaluateCombinationCondition(mChildren, mLogicalOperation, nonSlicedConditionCache);
     if (!mSliced) {
+        // None of the children flipped, so the combination cannot have flipped either.
+        // Serve the memoized value instead of re-evaluating the boolean tree.
+        if (!anyChildChanged && mUnSlicedPartCondition != ConditionState::kUnknown) {
+            nonSlicedConditionCache[mIndex] = mUnSlicedPartCondition;
+            conditionChangedCache[mIndex] = false;
+            return;
+        }
+
+        ConditionState newCondition =
+                evaluateCombinationCondition(mChildren, mLogicalOperation, nonSlicedConditionCache);
         bool nonSlicedChanged = (mUnSlicedPartCondition != newCondition);
         mUnSlicedPartCondition = newCondition;
 
         nonSlicedConditionCache[mIndex] = mUnSlicedPartCondition;
         conditionChangedCache[mIndex] = nonSlicedChanged;
     } else {
-        mUnSlicedPartCondition = evaluateCombinationCondition(mUnSlicedChildren, mLogicalOperation,
-                                                              nonSlicedConditionCache);
-
-        for (const int childIndex : mChildren) {
-            // If any of the sliced condition in children condition changes, the combination
-            // condition may be changed too.
+        // The unsliced part only moves when one of the unsliced children flipped.
+        for (const int childIndex : mUnSlicedChildren) {
             if (conditionChangedCache[childIndex]) {
-                conditionChangedCache[mIndex] = true;
+                mUnSlicedPartCondition = evaluateCombinationCondition(
+                        mUnSlicedChildren, mLogicalOperation, nonSlicedConditionCache);
                 break;
             }
         }
-        nonSlicedConditionCache[mIndex] = newCondition;
+
+        // If any of the sliced condition in children condition changes, the combination
+        // condition may be changed too.
+        conditionChangedCache[mIndex] = anyChildChanged;
+        nonSlicedConditionCache[mIndex] =
+                evaluateCombinationCondition(mChildren, mLogicalOperation, nonSlicedConditionCache);
         VLOG("CombinationPredicate %lld sliced may changed? %d", (long long)mConditionId,
             conditionChangedCache[mIndex] == true);
     }
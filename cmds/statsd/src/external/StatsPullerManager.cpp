@@ -103,26 +103,47 @@ bool StatsPullerManager::Pull(int tagId, const vector<int32_t>& uids, const int6
     return PullLocked(tagId, uids, eventTimeNs, data, useUids);
 }
 
+bool StatsPullerManager::GetPullUidsLocked(int tagId, const ConfigKey& configKey,
+                                           vector<int32_t>* uids) {
+    auto uidProviderIt = mPullUidProviders.find(configKey);
+    if (uidProviderIt == mPullUidProviders.end()) {
+        ALOGE("Error pulling tag %d. No pull uid provider for config key %s", tagId,
+              configKey.ToString().c_str());
+        StatsdStats::getInstance().notePullUidProviderNotFound(tagId);
+        return false;
+    }
+    sp<PullUidProvider> pullUidProvider = uidProviderIt->second.promote();
+    if (pullUidProvider == nullptr) {
+        ALOGE("Error pulling tag %d, pull uid provider for config %s is gone.", tagId,
+              configKey.ToString().c_str());
+        StatsdStats::getInstance().notePullUidProviderNotFound(tagId);
+        return false;
+    }
+    *uids = pullUidProvider->getPullAtomUids(tagId);
+    return true;
+}
+
+bool StatsPullerManager::FindPullerUidLocked(int tagId, const vector<int32_t>& uids, bool useUids,
+                                             int* pullerUid) const {
+    if (!useUids) {
+        *pullerUid = -1;
+        return kAllPullAtomInfo.find({.atomTag = tagId, .uid = -1}) != kAllPullAtomInfo.end();
+    }
+    for (int32_t uid : uids) {
+        if (kAllPullAtomInfo.find({.atomTag = tagId, .uid = uid}) != kAllPullAtomInfo.end()) {
+            *pullerUid = uid;
+            return true;
+        }
+    }
+    return false;
+}
+
 bool StatsPullerManager::PullLocked(int tagId, const ConfigKey& configKey,
                                     const int64_t eventTimeNs, vector<shared_ptr<LogEvent>>* data,
                                     bool useUids) {
     vector<int32_t> uids;
-    if (useUids) {
-        auto uidProviderIt = mPullUidProviders.find(configKey);
-        if (uidProviderIt == mPullUidProviders.end()) {
-            ALOGE("Error pulling tag %d. No pull uid provider for config key %s", tagId,
-                  configKey.ToString().c_str());
-            StatsdStats::getInstance().notePullUidProviderNotFound(tagId);
-            return false;
-        }
-        sp<PullUidProvider> pullUidProvider = uidProviderIt->second.promote();
-        if (pullUidProvider == nullptr) {
-            ALOGE("Error pulling tag %d, pull uid provider for config %s is gone.", tagId,
-                  configKey.ToString().c_str());
-            StatsdStats::getInstance().notePullUidProviderNotFound(tagId);
-            return false;
-        }
-        uids = pullUidProvider->getPullAtomUids(tagId);
+    if (useUids && !GetPullUidsLocked(tagId, configKey, &uids)) {
+        return false;
     }
     return PullLocked(tagId, uids, eventTimeNs, data, useUids);
 }
@@ -131,36 +152,21 @@ bool StatsPullerManager::PullLocked(int tagId, const vector<int32_t>& uids,
                                     const int64_t eventTimeNs, vector<shared_ptr<LogEvent>>* data,
                                     bool useUids) {
     VLOG("Initiating pulling %d", tagId);
-    if (useUids) {
-        for (int32_t uid : uids) {
-            PullerKey key = {.atomTag = tagId, .uid = uid};
-            auto pullerIt = kAllPullAtomInfo.find(key);
-            if (pullerIt != kAllPullAtomInfo.end()) {
-                bool ret = pullerIt->second->Pull(eventTimeNs, data);
-                VLOG("pulled %zu items", data->size());
-                if (!ret) {
-                    StatsdStats::getInstance().notePullFailed(tagId);
-                }
-                return ret;
-            }
-        }
-        StatsdStats::getInstance().notePullerNotFound(tagId);
-        ALOGW("StatsPullerManager: Unknown tagId %d", tagId);
-        return false;  // Return early since we don't know what to pull.
-    } else {
-        PullerKey key = {.atomTag = tagId, .uid = -1};
-        auto pullerIt = kAllPullAtomInfo.find(key);
-        if (pullerIt != kAllPullAtomInfo.end()) {
-            bool ret = pullerIt->second->Pull(eventTimeNs, data);
-            VLOG("pulled %zu items", data->size());
-            if (!ret) {
-                StatsdStats::getInstance().notePullFailed(tagId);
-            }
-            return ret;
+    int pullerUid;
+    if (!FindPullerUidLocked(tagId, uids, useUids, &pullerUid)) {
+        if (useUids) {
+            StatsdStats::getInstance().notePullerNotFound(tagId);
         }
         ALOGW("StatsPullerManager: Unknown tagId %d", tagId);
         return false;  // Return early since we don't know what to pull.
     }
+    auto pullerIt = kAllPullAtomInfo.find({.atomTag = tagId, .uid = pullerUid});
+    bool ret = pullerIt->second->Pull(eventTimeNs, data);
+    VLOG("pulled %zu items", data->size());
+    if (!ret) {
+        StatsdStats::getInstance().notePullFailed(tagId);
+    }
+    return ret;
 }
 
 bool StatsPullerManager::PullerForMatcherExists(int tagId) const {
@@ -290,26 +296,53 @@ void StatsPullerManager::OnAlarmFired(int64_t elapsedTimeNs) {
             }
         }
     }
+    // Pulls already performed at this alarm tick, keyed by the resolved puller. Bucket
+    // boundaries that land on the same tick across configs share one pull and one
+    // timestamped result set instead of going back to the puller per config.
+    std::map<PullerKey, std::pair<bool, vector<shared_ptr<LogEvent>>>> pulledThisTick;
     for (const auto& pullInfo : needToPull) {
+        const int tagId = pullInfo.first->atomTag;
         vector<shared_ptr<LogEvent>> data;
-        bool pullSuccess = PullLocked(pullInfo.first->atomTag, pullInfo.first->configKey,
-                                      elapsedTimeNs, &data);
+        bool pullSuccess = false;
+
+        vector<int32_t> uids;
+        int pullerUid;
+        if (!GetPullUidsLocked(tagId, pullInfo.first->configKey, &uids)) {
+            // Already noted by GetPullUidsLocked.
+        } else if (!FindPullerUidLocked(tagId, uids, /*useUids=*/true, &pullerUid)) {
+            StatsdStats::getInstance().notePullerNotFound(tagId);
+            ALOGW("StatsPullerManager: Unknown tagId %d", tagId);
+        } else {
+            PullerKey pullerKey = {.atomTag = tagId, .uid = pullerUid};
+            auto pulledIt = pulledThisTick.find(pullerKey);
+            if (pulledIt != pulledThisTick.end()) {
+                pullSuccess = pulledIt->second.first;
+                data = pulledIt->second.second;
+            } else {
+                pullSuccess = kAllPullAtomInfo.find(pullerKey)->second->Pull(elapsedTimeNs, &data);
+                VLOG("pulled %zu items", data.size());
+                if (!pullSuccess) {
+                    StatsdStats::getInstance().notePullFailed(tagId);
+                }
+
+                // Convention is to mark pull atom timestamp at request time.
+                // If we pull at t0, puller starts at t1, finishes at t2, and send back
+                // at t3, we mark t0 as its timestamp, which should correspond to its
+                // triggering event, such as condition change at t0.
+                // Here the triggering event is alarm fired from AlarmManager.
+                // In ValueMetricProducer and GaugeMetricProducer we do same thing
+                // when pull on condition change, etc.
+                for (auto& event : data) {
+                    event->setElapsedTimestampNs(elapsedTimeNs);
+                    event->setLogdWallClockTimestampNs(wallClockNs);
+                }
+                pulledThisTick.emplace(pullerKey, std::make_pair(pullSuccess, data));
+            }
+        }
         if (!pullSuccess) {
             VLOG("pull failed at %lld, will try again later", (long long)elapsedTimeNs);
         }
 
-        // Convention is to mark pull atom timestamp at request time.
-        // If we pull at t0, puller starts at t1, finishes at t2, and send back
-        // at t3, we mark t0 as its timestamp, which should correspond to its
-        // triggering event, such as condition change at t0.
-        // Here the triggering event is alarm fired from AlarmManager.
-        // In ValueMetricProducer and GaugeMetricProducer we do same thing
-        // when pull on condition change, etc.
-        for (auto& event : data) {
-            event->setElapsedTimestampNs(elapsedTimeNs);
-            event->setLogdWallClockTimestampNs(wallClockNs);
-        }
-
         for (const auto& receiverInfo : pullInfo.second) {
             sp<PullDataReceiver> receiverPtr = receiverInfo->receiver.promote();
             if (receiverPtr != nullptr) {
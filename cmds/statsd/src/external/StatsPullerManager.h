@@ -158,6 +158,16 @@ private:
     bool PullLocked(int tagId, const vector<int32_t>& uids, const int64_t eventTimeNs,
                     vector<std::shared_ptr<LogEvent>>* data, bool useUids);
 
+    // Resolves the uids that tagId may be pulled from for configKey using the config's
+    // registered PullUidProvider. Returns false (and notes the miss) when the provider is
+    // missing or gone.
+    bool GetPullUidsLocked(int tagId, const ConfigKey& configKey, vector<int32_t>* uids);
+
+    // Finds the uid whose registered puller serves tagId among the given uids. Returns
+    // false when no puller is registered for any of them.
+    bool FindPullerUidLocked(int tagId, const vector<int32_t>& uids, bool useUids,
+                             int* pullerUid) const;
+
     // locks for data receiver and StatsCompanionService changes
     std::mutex mLock;
 
@@ -120,8 +120,7 @@ const std::map<int, std::pair<size_t, size_t>> StatsdStats::kAtomDimensionKeySiz
         {util::CPU_TIME_PER_UID_FREQ, {6000, 10000}},
 };
 
-StatsdStats::StatsdStats() {
-    mPushedAtomStats.resize(kMaxPushedAtomId + 1);
+StatsdStats::StatsdStats() : mPushedAtomStats(kMaxPushedAtomId + 1) {
     mStartTimeSec = getWallClockSec();
 }
 
@@ -369,8 +368,37 @@ void StatsdStats::noteMetricDimensionInConditionSize(
 }
 
 void StatsdStats::noteMatcherMatched(const ConfigKey& key, const int64_t& id) {
-    lock_guard<std::mutex> lock(mLock);
+    // Hot path: called once per matched event.  Bump a striped atomic
+    // counter instead of taking mLock; the stripes are folded into
+    // matcher_stats at report time.
+    const size_t hash = std::hash<int64_t>()(id) ^ (std::hash<int64_t>()(key.GetId()) << 1) ^
+                        (std::hash<int32_t>()(key.GetUid()) << 2);
+    size_t slot = hash & (kMatcherCounterSlots - 1);
+    for (size_t probe = 0; probe < kMaxMatcherCounterProbes; probe++) {
+        MatcherCounterSlot& s = mMatcherCounters[slot];
+        const int32_t state = s.state.load(std::memory_order_acquire);
+        if (state == kSlotReady) {
+            if (s.configUid == key.GetUid() && s.configId == key.GetId() && s.matcherId == id) {
+                s.count.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        } else if (state == kSlotEmpty) {
+            int32_t expected = kSlotEmpty;
+            if (s.state.compare_exchange_strong(expected, kSlotClaiming,
+                                                std::memory_order_acq_rel)) {
+                s.configUid = key.GetUid();
+                s.configId = key.GetId();
+                s.matcherId = id;
+                s.count.store(1, std::memory_order_relaxed);
+                s.state.store(kSlotReady, std::memory_order_release);
+                return;
+            }
+        }
+        slot = (slot + 1) & (kMatcherCounterSlots - 1);
+    }
 
+    // Table saturated (or all probed slots mid-claim): locked slow path.
+    lock_guard<std::mutex> lock(mLock);
     auto statsIt = mConfigStats.find(key);
     if (statsIt == mConfigStats.end()) {
         return;
@@ -378,6 +406,26 @@ void StatsdStats::noteMatcherMatched(const ConfigKey& key, const int64_t& id) {
     statsIt->second->matcher_stats[id]++;
 }
 
+void StatsdStats::flushMatcherCountersLocked() const {
+    for (size_t i = 0; i < kMatcherCounterSlots; i++) {
+        const MatcherCounterSlot& s = mMatcherCounters[i];
+        if (s.state.load(std::memory_order_acquire) != kSlotReady) {
+            continue;
+        }
+        const int32_t count = s.count.exchange(0, std::memory_order_relaxed);
+        if (count == 0) {
+            continue;
+        }
+        auto statsIt = mConfigStats.find(ConfigKey(s.configUid, s.configId));
+        if (statsIt == mConfigStats.end()) {
+            // Config no longer tracked; drop the counts, matching the
+            // behavior of the locked path.
+            continue;
+        }
+        statsIt->second->matcher_stats[s.matcherId] += count;
+    }
+}
+
 void StatsdStats::noteAnomalyDeclared(const ConfigKey& key, const int64_t& id) {
     lock_guard<std::mutex> lock(mLock);
     auto statsIt = mConfigStats.find(key);
@@ -457,14 +505,16 @@ void StatsdStats::notePullExceedMaxDelay(int pullAtomId) {
 }
 
 void StatsdStats::noteAtomLogged(int atomId, int32_t timeSec) {
-    lock_guard<std::mutex> lock(mLock);
+    if (atomId >= 0 && atomId <= kMaxPushedAtomId) {
+        // Hot path: called once per logged event; per-atom counters are
+        // atomics so no lock is needed.
+        mPushedAtomStats[atomId].fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
 
-    if (atomId <= kMaxPushedAtomId) {
-        mPushedAtomStats[atomId]++;
-    } else {
-        if (mNonPlatformPushedAtomStats.size() < kMaxNonPlatformPushedAtoms) {
-            mNonPlatformPushedAtomStats[atomId]++;
-        }
+    lock_guard<std::mutex> lock(mLock);
+    if (mNonPlatformPushedAtomStats.size() < kMaxNonPlatformPushedAtoms) {
+        mNonPlatformPushedAtomStats[atomId]++;
     }
 }
 
@@ -597,7 +647,10 @@ void StatsdStats::resetInternalLocked() {
     // Reset the historical data, but keep the active ConfigStats
     mStartTimeSec = getWallClockSec();
     mIceBox.clear();
-    std::fill(mPushedAtomStats.begin(), mPushedAtomStats.end(), 0);
+    flushMatcherCountersLocked();
+    for (auto& count : mPushedAtomStats) {
+        count.store(0, std::memory_order_relaxed);
+    }
     mNonPlatformPushedAtomStats.clear();
     mAnomalyAlarmRegisteredStats = 0;
     mPeriodicAlarmRegisteredStats = 0;
@@ -666,6 +719,7 @@ int StatsdStats::getPushedAtomErrors(int atomId) const {
 
 void StatsdStats::dumpStats(int out) const {
     lock_guard<std::mutex> lock(mLock);
+    flushMatcherCountersLocked();
     time_t t = mStartTimeSec;
     struct tm* tm = localtime(&t);
     char timeBuffer[80];
@@ -767,8 +821,9 @@ void StatsdStats::dumpStats(int out) const {
     dprintf(out, "********Pushed Atom stats***********\n");
     const size_t atomCounts = mPushedAtomStats.size();
     for (size_t i = 2; i < atomCounts; i++) {
-        if (mPushedAtomStats[i] > 0) {
-            dprintf(out, "Atom %zu->(total count)%d, (error count)%d\n", i, mPushedAtomStats[i],
+        const int count = mPushedAtomStats[i].load(std::memory_order_relaxed);
+        if (count > 0) {
+            dprintf(out, "Atom %zu->(total count)%d, (error count)%d\n", i, count,
                     getPushedAtomErrors((int)i));
         }
     }
@@ -966,6 +1021,7 @@ void addConfigStatsToProto(const ConfigStats& configStats, ProtoOutputStream* pr
 
 void StatsdStats::dumpStats(std::vector<uint8_t>* output, bool reset) {
     lock_guard<std::mutex> lock(mLock);
+    flushMatcherCountersLocked();
 
     ProtoOutputStream proto;
     proto.write(FIELD_TYPE_INT32 | FIELD_ID_BEGIN_TIME, mStartTimeSec);
@@ -981,11 +1037,12 @@ void StatsdStats::dumpStats(std::vector<uint8_t>* output, bool reset) {
 
     const size_t atomCounts = mPushedAtomStats.size();
     for (size_t i = 2; i < atomCounts; i++) {
-        if (mPushedAtomStats[i] > 0) {
+        const int count = mPushedAtomStats[i].load(std::memory_order_relaxed);
+        if (count > 0) {
             uint64_t token =
                     proto.start(FIELD_TYPE_MESSAGE | FIELD_ID_ATOM_STATS | FIELD_COUNT_REPEATED);
             proto.write(FIELD_TYPE_INT32 | FIELD_ID_ATOM_STATS_TAG, (int32_t)i);
-            proto.write(FIELD_TYPE_INT32 | FIELD_ID_ATOM_STATS_COUNT, mPushedAtomStats[i]);
+            proto.write(FIELD_TYPE_INT32 | FIELD_ID_ATOM_STATS_COUNT, count);
             int errors = getPushedAtomErrors(i);
             if (errors > 0) {
                 proto.write(FIELD_TYPE_INT32 | FIELD_ID_ATOM_STATS_ERROR_COUNT, errors);
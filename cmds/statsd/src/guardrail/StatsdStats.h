@@ -19,6 +19,7 @@
 
 #include <gtest/gtest_prod.h>
 #include <log/log_time.h>
+#include <atomic>
 #include <list>
 #include <mutex>
 #include <string>
@@ -565,8 +566,35 @@ private:
     // Stores the number of times a pushed atom is logged.
     // The size of the vector is the largest pushed atom id in atoms.proto + 1. Atoms
     // out of that range will be put in mNonPlatformPushedAtomStats.
-    // This is a vector, not a map because it will be accessed A LOT -- for each stats log.
-    std::vector<int> mPushedAtomStats;
+    // This is a vector of atomics, not a map, because it is bumped once for
+    // every logged event and must not take mLock on that path.
+    std::vector<std::atomic<int>> mPushedAtomStats;
+
+    // Striped lock-free counters for matcher matches, the other per-event
+    // counter.  A slot is claimed for a (config, matcher) pair with a CAS on
+    // its state and then only ever incremented; the counts are folded into
+    // the per-config matcher_stats under mLock at report/reset time.  When
+    // the table is saturated the locked path is used directly.
+    static constexpr size_t kMatcherCounterSlots = 256;  // must be a power of two
+    static constexpr size_t kMaxMatcherCounterProbes = 8;
+    static constexpr int32_t kSlotEmpty = 0;
+    static constexpr int32_t kSlotClaiming = 1;
+    static constexpr int32_t kSlotReady = 2;
+
+    struct MatcherCounterSlot {
+        std::atomic<int32_t> state{kSlotEmpty};
+        // Written only by the claiming thread before state becomes ready.
+        int32_t configUid = 0;
+        int64_t configId = 0;
+        int64_t matcherId = 0;
+        mutable std::atomic<int32_t> count{0};
+    };
+
+    mutable std::vector<MatcherCounterSlot> mMatcherCounters{kMatcherCounterSlots};
+
+    // Folds the striped matcher counters into matcher_stats.  Must be called
+    // with mLock held.
+    void flushMatcherCountersLocked() const;
 
     // Stores the number of times a pushed atom is logged for atom ids above kMaxPushedAtomId.
     // The max size of the map is kMaxNonPlatformPushedAtoms.
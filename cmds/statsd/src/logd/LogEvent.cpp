@@ -127,7 +127,7 @@ void LogEvent::parseString(int32_t* pos, int32_t depth, bool* last, uint8_t numA
     string value = string((char*)mBuf, numBytes);
     mBuf += numBytes;
     mRemainingLen -= numBytes;
-    addToValues(pos, depth, value, last);
+    addToValues(pos, depth, std::move(value), last);
     parseAnnotations(numAnnotations);
 }
 
@@ -154,7 +154,7 @@ void LogEvent::parseByteArray(int32_t* pos, int32_t depth, bool* last, uint8_t n
     vector<uint8_t> value(mBuf, mBuf + numBytes);
     mBuf += numBytes;
     mRemainingLen -= numBytes;
-    addToValues(pos, depth, value, last);
+    addToValues(pos, depth, std::move(value), last);
     parseAnnotations(numAnnotations);
 }
 
@@ -413,6 +413,44 @@ bool LogEvent::parseBuffer(uint8_t* buf, size_t len) {
     return mValid;
 }
 
+bool LogEvent::parseBufferLazily(uint8_t* buf, size_t len) {
+    mBuf = buf;
+    mRemainingLen = (uint32_t)len;
+
+    // Decode only the fixed prefix; see parseBuffer for the full layout.
+    // Beginning of buffer is OBJECT_TYPE | NUM_FIELDS | TIMESTAMP | ATOM_ID
+    uint8_t typeInfo = readNextValue<uint8_t>();
+    if (getTypeId(typeInfo) != OBJECT_TYPE) mValid = false;
+
+    uint8_t numElements = readNextValue<uint8_t>();
+    if (numElements < 2 || numElements > 127) mValid = false;
+
+    typeInfo = readNextValue<uint8_t>();
+    if (getTypeId(typeInfo) != INT64_TYPE) mValid = false;
+    mElapsedTimestampNs = readNextValue<int64_t>();
+
+    typeInfo = readNextValue<uint8_t>();
+    if (getTypeId(typeInfo) != INT32_TYPE) mValid = false;
+    mTagId = readNextValue<int32_t>();
+
+    mBuf = nullptr;
+    if (!mValid) return false;
+
+    // The caller's buffer is reused for the next event, so the undecoded bytes
+    // must be copied out to survive until the deferred decode.
+    mRawBuffer.assign(buf, buf + len);
+    mParseDeferred = true;
+    return true;
+}
+
+void LogEvent::decodeDeferredBuffer() {
+    mParseDeferred = false;
+    // parseBuffer re-reads the prefix too, which keeps the two parse paths from
+    // diverging; the prefix fields are simply assigned the same values again.
+    std::vector<uint8_t> raw = std::move(mRawBuffer);
+    parseBuffer(raw.data(), raw.size());
+}
+
 uint8_t LogEvent::getTypeId(uint8_t typeInfo) {
     return typeInfo & 0x0F;  // type id in lower 4 bytes
 }
@@ -423,6 +461,7 @@ uint8_t LogEvent::getNumAnnotations(uint8_t typeInfo) {
 
 int64_t LogEvent::GetLong(size_t key, status_t* err) const {
     // TODO(b/110561208): encapsulate the magical operations in Field struct as static functions
+    ensureDecoded();
     int field = getSimpleField(key);
     for (const auto& value : mValues) {
         if (value.mField.getField() == field) {
@@ -445,6 +484,7 @@ int64_t LogEvent::GetLong(size_t key, status_t* err) const {
 }
 
 int LogEvent::GetInt(size_t key, status_t* err) const {
+    ensureDecoded();
     int field = getSimpleField(key);
     for (const auto& value : mValues) {
         if (value.mField.getField() == field) {
@@ -465,6 +505,7 @@ int LogEvent::GetInt(size_t key, status_t* err) const {
 }
 
 const char* LogEvent::GetString(size_t key, status_t* err) const {
+    ensureDecoded();
     int field = getSimpleField(key);
     for (const auto& value : mValues) {
         if (value.mField.getField() == field) {
@@ -485,6 +526,7 @@ const char* LogEvent::GetString(size_t key, status_t* err) const {
 }
 
 bool LogEvent::GetBool(size_t key, status_t* err) const {
+    ensureDecoded();
     int field = getSimpleField(key);
     for (const auto& value : mValues) {
         if (value.mField.getField() == field) {
@@ -507,6 +549,7 @@ bool LogEvent::GetBool(size_t key, status_t* err) const {
 }
 
 float LogEvent::GetFloat(size_t key, status_t* err) const {
+    ensureDecoded();
     int field = getSimpleField(key);
     for (const auto& value : mValues) {
         if (value.mField.getField() == field) {
@@ -527,6 +570,7 @@ float LogEvent::GetFloat(size_t key, status_t* err) const {
 }
 
 std::vector<uint8_t> LogEvent::GetStorage(size_t key, status_t* err) const {
+    ensureDecoded();
     int field = getSimpleField(key);
     for (const auto& value : mValues) {
         if (value.mField.getField() == field) {
@@ -547,6 +591,7 @@ std::vector<uint8_t> LogEvent::GetStorage(size_t key, status_t* err) const {
 }
 
 string LogEvent::ToString() const {
+    ensureDecoded();
     string result;
     result += StringPrintf("{ uid(%d) %lld %lld (%d)", mLogUid, (long long)mLogdTimestampNs,
                            (long long)mElapsedTimestampNs, mTagId);
@@ -563,6 +608,7 @@ void LogEvent::ToProto(ProtoOutputStream& protoOutput) const {
 }
 
 bool LogEvent::hasAttributionChain(std::pair<int, int>* indexRange) const {
+    ensureDecoded();
     if (mAttributionChainStartIndex == -1 || mAttributionChainEndIndex == -1) {
         return false;
     }
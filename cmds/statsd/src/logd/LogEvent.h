@@ -62,6 +62,19 @@ public:
      */
     bool parseBuffer(uint8_t* buf, size_t len);
 
+    /**
+     * Lazy alternative to parseBuffer: decodes only the leading timestamp and
+     * atom ID and retains a copy of the raw buffer. The FieldValue vector and
+     * annotations are decoded on the first accessor that needs them, so events
+     * that are dropped before anything looks past the atom ID never pay for a
+     * full decode, and the decode that does happen runs on the consuming
+     * thread instead of the socket thread.
+     *
+     * \return whether the buffer prefix was valid. Validation of the remaining
+     * fields happens at the deferred decode; isValid() reflects it from then on.
+     */
+    bool parseBufferLazily(uint8_t* buf, size_t len);
+
     // Constructs a BinaryPushStateChanged LogEvent from API call.
     explicit LogEvent(const std::string& trainName, int64_t trainVersionCode, bool requiresStaging,
                       bool rollbackEnabled, bool requiresLowLatencyMonitor, int32_t state,
@@ -133,19 +146,23 @@ public:
     }
 
     inline int size() const {
+        ensureDecoded();
         return mValues.size();
     }
 
     const std::vector<FieldValue>& getValues() const {
+        ensureDecoded();
         return mValues;
     }
 
     std::vector<FieldValue>* getMutableValues() {
+        ensureDecoded();
         return &mValues;
     }
 
     // Default value = false
     inline bool shouldTruncateTimestamp() const {
+        ensureDecoded();
         return mTruncateTimestamp;
     }
 
@@ -160,6 +177,7 @@ public:
     //    }
     // Note that atomIndex is 1-indexed.
     inline int getUidFieldIndex() {
+        ensureDecoded();
         return static_cast<int>(mUidFieldIndex);
     }
 
@@ -179,12 +197,14 @@ public:
     //    }
     // Note that atomIndex is 1-indexed.
     inline int getExclusiveStateFieldIndex() const {
+        ensureDecoded();
         return static_cast<int>(mExclusiveStateFieldIndex);
     }
 
     // If a reset state is not sent in the StatsEvent, returns -1. Note that a
     // reset state is sent if and only if a reset should be triggered.
     inline int getResetState() const {
+        ensureDecoded();
         return mResetState;
     }
 
@@ -194,6 +214,7 @@ public:
 
     template <class T>
     status_t updateValue(size_t key, T& value, Type type) {
+        ensureDecoded();
         int field = getSimpleField(key);
         for (auto& fieldValue : mValues) {
             if (fieldValue.mField.getField() == field) {
@@ -209,6 +230,9 @@ public:
     }
 
     bool isValid() const {
+        // Corruption past the buffer prefix is only detectable by decoding, so a
+        // lazily parsed event is fully validated here before the result is returned.
+        ensureDecoded();
         return mValid;
     }
 
@@ -278,20 +302,36 @@ private:
     }
 
     template <class T>
-    void addToValues(int32_t* pos, int32_t depth, T& value, bool* last) {
+    void addToValues(int32_t* pos, int32_t depth, T&& value, bool* last) {
         Field f = Field(mTagId, pos, depth);
         // do not decorate last position at depth 0
         for (int i = 1; i < depth; i++) {
             if (last[i]) f.decorateLastPos(i);
         }
 
-        Value v = Value(value);
-        mValues.push_back(FieldValue(f, v));
+        // Forwarding lets string and byte-array payloads be moved into place instead of
+        // being reallocated once per intermediate copy.
+        Value v = Value(std::forward<T>(value));
+        mValues.push_back(FieldValue(f, std::move(v)));
     }
 
     uint8_t getTypeId(uint8_t typeInfo);
     uint8_t getNumAnnotations(uint8_t typeInfo);
 
+    /**
+     * Runs the deferred decode of a lazily parsed event, if there is one.
+     * Conceptually const: decoding only materializes state that is already
+     * determined by the retained buffer.
+     */
+    void ensureDecoded() const {
+        if (mParseDeferred) const_cast<LogEvent*>(this)->decodeDeferredBuffer();
+    }
+    void decodeDeferredBuffer();
+
+    // Raw atom bytes retained by parseBufferLazily until the deferred decode runs.
+    std::vector<uint8_t> mRawBuffer;
+    bool mParseDeferred = false;
+
     // The items are naturally sorted in DFS order as we read them. this allows us to do fast
     // matching.
     std::vector<FieldValue> mValues;
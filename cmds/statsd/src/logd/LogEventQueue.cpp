@@ -26,35 +26,64 @@ namespace statsd {
 using std::unique_lock;
 using std::unique_ptr;
 
+namespace {
+
+size_t nextPowerOfTwo(size_t n) {
+    size_t result = 1;
+    while (result < n) result <<= 1;
+    return result;
+}
+
+}  // namespace
+
+LogEventQueue::LogEventQueue(size_t maxSize)
+    : mQueueLimit(maxSize),
+      mSlotMask(nextPowerOfTwo(maxSize) - 1),
+      mSlots(mSlotMask + 1) {
+}
+
 unique_ptr<LogEvent> LogEventQueue::waitPop() {
-    std::unique_lock<std::mutex> lock(mMutex);
+    const int64_t read = mReadIndex.load(std::memory_order_relaxed);
 
-    if (mQueue.empty()) {
-        mCondition.wait(lock, [this] { return !this->mQueue.empty(); });
+    if (read == mWriteIndex.load(std::memory_order_acquire)) {
+        unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [this, read] {
+            return read != mWriteIndex.load(std::memory_order_acquire);
+        });
     }
 
-    unique_ptr<LogEvent> item = std::move(mQueue.front());
-    mQueue.pop();
+    unique_ptr<LogEvent> item = std::move(mSlots[read & mSlotMask].event);
+    mReadIndex.store(read + 1, std::memory_order_release);
 
     return item;
 }
 
 bool LogEventQueue::push(unique_ptr<LogEvent> item, int64_t* oldestTimestampNs) {
-    bool success;
-    {
-        std::unique_lock<std::mutex> lock(mMutex);
-        if (mQueue.size() < mQueueLimit) {
-            mQueue.push(std::move(item));
-            success = true;
-        } else {
-            // safe operation as queue must not be empty.
-            *oldestTimestampNs = mQueue.front()->GetElapsedTimestampNs();
-            success = false;
-        }
+    const int64_t write = mWriteIndex.load(std::memory_order_relaxed);
+
+    if (write - mReadIndex.load(std::memory_order_acquire) >= (int64_t)mQueueLimit) {
+        // The slot under the read cursor holds the oldest event. Its timestamp copy is
+        // producer-owned, so reading it here cannot race with the consumer moving the
+        // event out of the slot.
+        *oldestTimestampNs = mSlots[mReadIndex.load(std::memory_order_relaxed) & mSlotMask]
+                                     .timestampNs;
+        mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
     }
 
-    mCondition.notify_one();
-    return success;
+    Slot& slot = mSlots[write & mSlotMask];
+    slot.timestampNs = item->GetElapsedTimestampNs();
+    slot.event = std::move(item);
+    mWriteIndex.store(write + 1, std::memory_order_release);
+
+    // Wake the consumer only when it may have drained everything up to this event and
+    // gone to sleep. Taking the mutex here is what makes the wakeup race-free: the
+    // consumer checks the cursors under the same mutex before it blocks.
+    if (mReadIndex.load(std::memory_order_acquire) >= write) {
+        unique_lock<std::mutex> lock(mMutex);
+        mCondition.notify_one();
+    }
+    return true;
 }
 
 }  // namespace statsd
@@ -18,9 +18,10 @@
 
 #include "LogEvent.h"
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
-#include <queue>
+#include <vector>
 
 namespace android {
 namespace os {
@@ -28,10 +29,16 @@ namespace statsd {
 
 /**
  * A zero copy thread safe queue buffer for producing and consuming LogEvent.
+ *
+ * Implemented as a bounded single-producer/single-consumer ring buffer: the socket
+ * listener thread is the only producer and the event processing thread the only
+ * consumer. push() never takes a lock on the hot path, so a slow consumer cannot
+ * stall the socket thread; the mutex below exists solely to park the consumer
+ * while the ring is empty.
  */
 class LogEventQueue {
 public:
-    explicit LogEventQueue(size_t maxSize) : mQueueLimit(maxSize){};
+    explicit LogEventQueue(size_t maxSize);
 
     /**
      * Blocking read one event from the queue.
@@ -45,11 +52,39 @@ public:
      */
     bool push(std::unique_ptr<LogEvent> event, int64_t* oldestTimestampNs);
 
+    /**
+     * Total number of events rejected by push() because the queue was full.
+     */
+    int64_t getDroppedCount() const {
+        return mDroppedCount.load(std::memory_order_relaxed);
+    }
+
 private:
+    struct Slot {
+        std::unique_ptr<LogEvent> event;
+        // Written by the producer before the slot is published. Read by the producer on
+        // overflow to report the oldest queued timestamp without touching the consumer's
+        // unique_ptr.
+        int64_t timestampNs = 0;
+    };
+
     const size_t mQueueLimit;
+    // Ring size minus one; the ring is sized to the next power of two >= mQueueLimit so
+    // cursors can be mapped to slots with a mask instead of a modulo.
+    const size_t mSlotMask;
+    std::vector<Slot> mSlots;
+
+    // Monotonic cursors. mWriteIndex is advanced only by the producer after it fills a
+    // slot; mReadIndex only by the consumer after it empties one. Queue depth is exactly
+    // mWriteIndex - mReadIndex.
+    std::atomic<int64_t> mWriteIndex{0};
+    std::atomic<int64_t> mReadIndex{0};
+
+    std::atomic<int64_t> mDroppedCount{0};
+
+    // Only used for the empty->nonempty handoff; never held while the ring has events.
     std::condition_variable mCondition;
     std::mutex mMutex;
-    std::queue<std::unique_ptr<LogEvent>> mQueue;
 };
 
 }  // namespace statsd
@@ -84,6 +84,10 @@ MetricsManager::MetricsManager(const ConfigKey& key, const StatsdConfig& config,
             mActivationAtomTrackerToMetricMap, mDeactivationAtomTrackerToMetricMap,
             mAlertTrackerMap, mMetricIndexesWithActivation, mNoReportMetricIds);
 
+    if (mConfigValid) {
+        initAtomMatcherIndex();
+    }
+
     mHashStringsInReport = config.hash_strings_in_metric_report();
     mVersionStringsInReport = config.version_strings_in_metric_report();
     mInstallerInReport = config.installer_in_metric_report();
@@ -169,7 +173,7 @@ MetricsManager::MetricsManager(const ConfigKey& key, const StatsdConfig& config,
         isActive |= mAllMetricProducers[metric]->isActive();
     }
     mIsActive = isActive;
-    VLOG("mIsActive is initialized to %d", mIsActive)
+    VLOG("mIsActive is initialized to %d", mIsActive.load())
 
     // no matter whether this config is valid, log it in the stats.
     StatsdStats::getInstance().noteConfigReceived(
@@ -195,6 +199,14 @@ MetricsManager::~MetricsManager() {
     VLOG("~MetricsManager()");
 }
 
+void MetricsManager::initAtomMatcherIndex() {
+    for (size_t i = 0; i < mAllAtomMatchers.size(); i++) {
+        for (const int atomId : mAllAtomMatchers[i]->getAtomIds()) {
+            mAtomMatchersByTag[atomId].push_back(i);
+        }
+    }
+}
+
 void MetricsManager::initLogSourceWhiteList() {
     std::lock_guard<std::mutex> lock(mAllowedLogSourcesMutex);
     mAllowedLogSources.clear();
@@ -231,6 +243,7 @@ bool MetricsManager::isConfigValid() const {
 
 void MetricsManager::notifyAppUpgrade(const int64_t& eventTimeNs, const string& apk, const int uid,
                                       const int64_t version) {
+    std::lock_guard<std::mutex> lock(mMutex);
     // Inform all metric producers.
     for (const auto& it : mAllMetricProducers) {
         it->notifyAppUpgrade(eventTimeNs);
@@ -252,6 +265,7 @@ void MetricsManager::notifyAppUpgrade(const int64_t& eventTimeNs, const string&
 
 void MetricsManager::notifyAppRemoved(const int64_t& eventTimeNs, const string& apk,
                                       const int uid) {
+    std::lock_guard<std::mutex> lock(mMutex);
     // Inform all metric producers.
     for (const auto& it : mAllMetricProducers) {
         it->notifyAppRemoved(eventTimeNs);
@@ -272,6 +286,7 @@ void MetricsManager::notifyAppRemoved(const int64_t& eventTimeNs, const string&
 }
 
 void MetricsManager::onUidMapReceived(const int64_t& eventTimeNs) {
+    std::lock_guard<std::mutex> lock(mMutex);
     // Purposefully don't inform metric producers on a new snapshot
     // because we don't need to flush partial buckets.
     // This occurs if a new user is added/removed or statsd crashes.
@@ -284,6 +299,7 @@ void MetricsManager::onUidMapReceived(const int64_t& eventTimeNs) {
 }
 
 void MetricsManager::onStatsdInitCompleted(const int64_t& eventTimeNs) {
+    std::lock_guard<std::mutex> lock(mMutex);
     // Inform all metric producers.
     for (const auto& it : mAllMetricProducers) {
         it->onStatsdInitCompleted(eventTimeNs);
@@ -308,6 +324,7 @@ vector<int32_t> MetricsManager::getPullAtomUids(int32_t atomId) {
 }
 
 void MetricsManager::dumpStates(FILE* out, bool verbose) {
+    std::lock_guard<std::mutex> lock(mMutex);
     fprintf(out, "ConfigKey %s, allowed source:", mConfigKey.ToString().c_str());
     {
         std::lock_guard<std::mutex> lock(mAllowedLogSourcesMutex);
@@ -322,6 +339,7 @@ void MetricsManager::dumpStates(FILE* out, bool verbose) {
 }
 
 void MetricsManager::dropData(const int64_t dropTimeNs) {
+    std::lock_guard<std::mutex> lock(mMutex);
     for (const auto& producer : mAllMetricProducers) {
         producer->dropData(dropTimeNs);
     }
@@ -333,6 +351,7 @@ void MetricsManager::onDumpReport(const int64_t dumpTimeStampNs,
                                   const DumpLatency dumpLatency,
                                   std::set<string> *str_set,
                                   ProtoOutputStream* protoOutput) {
+    std::lock_guard<std::mutex> lock(mMutex);
     VLOG("=========================Metric Reports Start==========================");
     // one StatsLogReport per MetricProduer
     for (const auto& producer : mAllMetricProducers) {
@@ -446,6 +465,7 @@ bool MetricsManager::eventSanityCheck(const LogEvent& event) {
 
 // Consume the stats log if it's interesting to this metric.
 void MetricsManager::onLogEvent(const LogEvent& event) {
+    std::lock_guard<std::mutex> lock(mMutex);
     if (!mConfigValid) {
         return;
     }
@@ -479,16 +499,19 @@ void MetricsManager::onLogEvent(const LogEvent& event) {
 
     mIsActive = isActive || !activeMetricsIndices.empty();
 
-    if (mTagIds.find(tagId) == mTagIds.end()) {
+    const auto subscribedMatchers = mAtomMatchersByTag.find(tagId);
+    if (subscribedMatchers == mAtomMatchersByTag.end()) {
         // Not interesting...
         return;
     }
 
     vector<MatchingState> matcherCache(mAllAtomMatchers.size(), MatchingState::kNotComputed);
 
-    // Evaluate all atom matchers.
-    for (auto& matcher : mAllAtomMatchers) {
-        matcher->onLogEvent(event, mAllAtomMatchers, matcherCache);
+    // Evaluate only the matchers subscribed to this atom ID. Every skipped matcher would
+    // have computed kNotMatched for this event, and the consumers below treat a leftover
+    // kNotComputed the same way, since they only ever test for kMatched.
+    for (const int matcherIndex : subscribedMatchers->second) {
+        mAllAtomMatchers[matcherIndex]->onLogEvent(event, mAllAtomMatchers, matcherCache);
     }
 
     // Set of metrics that received an activation cancellation.
@@ -597,6 +620,7 @@ void MetricsManager::onLogEvent(const LogEvent& event) {
 void MetricsManager::onAnomalyAlarmFired(
         const int64_t& timestampNs,
         unordered_set<sp<const InternalAlarm>, SpHash<InternalAlarm>>& alarmSet) {
+    std::lock_guard<std::mutex> lock(mMutex);
     for (const auto& itr : mAllAnomalyTrackers) {
         itr->informAlarmsFired(timestampNs, alarmSet);
     }
@@ -605,6 +629,7 @@ void MetricsManager::onAnomalyAlarmFired(
 void MetricsManager::onPeriodicAlarmFired(
         const int64_t& timestampNs,
         unordered_set<sp<const InternalAlarm>, SpHash<InternalAlarm>>& alarmSet) {
+    std::lock_guard<std::mutex> lock(mMutex);
     for (const auto& itr : mAllPeriodicAlarmTrackers) {
         itr->informAlarmsFired(timestampNs, alarmSet);
     }
@@ -612,6 +637,7 @@ void MetricsManager::onPeriodicAlarmFired(
 
 // Returns the total byte size of all metrics managed by a single config source.
 size_t MetricsManager::byteSize() {
+    std::lock_guard<std::mutex> lock(mMutex);
     size_t totalSize = 0;
     for (const auto& metricProducer : mAllMetricProducers) {
         totalSize += metricProducer->byteSize();
@@ -620,6 +646,7 @@ size_t MetricsManager::byteSize() {
 }
 
 void MetricsManager::loadActiveConfig(const ActiveConfig& config, int64_t currentTimeNs) {
+    std::lock_guard<std::mutex> lock(mMutex);
     if (config.metric_size() == 0) {
         ALOGW("No active metric for config %s", mConfigKey.ToString().c_str());
         return;
@@ -636,7 +663,9 @@ void MetricsManager::loadActiveConfig(const ActiveConfig& config, int64_t curren
                     StatsdStats::getInstance().noteActiveStatusChanged(mConfigKey,
                                                                        /*activate=*/ true);
                 }
-                mIsActive |= metric->isActive();
+                if (metric->isActive()) {
+                    mIsActive = true;
+                }
             }
         }
     }
@@ -644,6 +673,7 @@ void MetricsManager::loadActiveConfig(const ActiveConfig& config, int64_t curren
 
 void MetricsManager::writeActiveConfigToProtoOutputStream(
         int64_t currentTimeNs, const DumpReportReason reason, ProtoOutputStream* proto) {
+    std::lock_guard<std::mutex> lock(mMutex);
     proto->write(FIELD_TYPE_INT64 | FIELD_ID_ACTIVE_CONFIG_ID, (long long)mConfigKey.GetId());
     proto->write(FIELD_TYPE_INT32 | FIELD_ID_ACTIVE_CONFIG_UID, mConfigKey.GetUid());
     for (int metricIndex : mMetricIndexesWithActivation) {
@@ -658,6 +688,7 @@ void MetricsManager::writeActiveConfigToProtoOutputStream(
 bool MetricsManager::writeMetadataToProto(int64_t currentWallClockTimeNs,
                                           int64_t systemElapsedTimeNs,
                                           metadata::StatsMetadata* statsMetadata) {
+    std::lock_guard<std::mutex> lock(mMutex);
     bool metadataWritten = false;
     metadata::ConfigKey* configKey = statsMetadata->mutable_config_key();
     configKey->set_config_id(mConfigKey.GetId());
@@ -677,6 +708,7 @@ bool MetricsManager::writeMetadataToProto(int64_t currentWallClockTimeNs,
 void MetricsManager::loadMetadata(const metadata::StatsMetadata& metadata,
                                   int64_t currentWallClockTimeNs,
                                   int64_t systemElapsedTimeNs) {
+    std::lock_guard<std::mutex> lock(mMutex);
     for (const metadata::AlertMetadata& alertMetadata : metadata.alert_metadata()) {
         int64_t alertId = alertMetadata.alert_id();
         auto it = mAlertTrackerMap.find(alertId);
@@ -29,6 +29,8 @@
 #include "metrics/MetricProducer.h"
 #include "packages/UidMap.h"
 
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
 
 namespace android {
@@ -160,6 +162,13 @@ private:
 
     const ConfigKey mConfigKey;
 
+    // Guards the metric-processing state of this config: matchers, conditions, metric
+    // producers and report timestamps. Serializing onLogEvent against onDumpReport here
+    // lets one config be dumped while the other configs keep processing events.
+    // Lock ordering: StatsLogProcessor's mMetricsMutex may be held when this lock is
+    // acquired, never the reverse; mAllowedLogSourcesMutex is a leaf taken after this one.
+    mutable std::mutex mMutex;
+
     sp<UidMap> mUidMap;
 
     bool mConfigValid = false;
@@ -213,6 +222,11 @@ private:
     // All event tags that are interesting to my metrics.
     std::set<int> mTagIds;
 
+    // Maps an atom ID to the indices of the matchers subscribed to it, so per-event matcher
+    // work is proportional to the subscribers of that atom rather than all matchers in the
+    // config. Built once from mAllAtomMatchers after the config is initialized.
+    std::unordered_map<int, std::vector<int>> mAtomMatchersByTag;
+
     // We only store the sp of LogMatchingTracker, MetricProducer, and ConditionTracker in
     // MetricsManager. There are relationships between them, and the relationships are denoted by
     // index instead of pointers. The reasons for this are: (1) the relationship between them are
@@ -271,13 +285,17 @@ private:
 
     void initLogSourceWhiteList();
 
+    // Populates mAtomMatchersByTag from the atom IDs each matcher subscribes to.
+    void initAtomMatcherIndex();
+
     void initPullAtomSources();
 
     // The metrics that don't need to be uploaded or even reported.
     std::set<int64_t> mNoReportMetricIds;
 
    // The config is active if any metric in the config is active.
-    bool mIsActive;
+   // Atomic because it is read by isActive() without holding mMutex.
+    std::atomic<bool> mIsActive;
 
     // The config is always active if any metric in the config does not have an activation signal.
     bool mIsAlwaysActive;
@@ -239,6 +239,7 @@ void ValueMetricProducer::dropDataLocked(const int64_t dropTimeNs) {
 
 void ValueMetricProducer::clearPastBucketsLocked(const int64_t dumpTimeNs) {
     mPastBuckets.clear();
+    mStagedBucketInfos.clear();
     mSkippedBuckets.clear();
 }
 
@@ -331,48 +332,22 @@ void ValueMetricProducer::onDumpReportLocked(const int64_t dumpTimeNs,
             protoOutput->end(stateToken);
         }
 
-        // Then fill bucket_info (ValueBucketInfo).
-        for (const auto& bucket : pair.second) {
-            uint64_t bucketInfoToken = protoOutput->start(
-                    FIELD_TYPE_MESSAGE | FIELD_COUNT_REPEATED | FIELD_ID_BUCKET_INFO);
-
-            if (bucket.mBucketEndNs - bucket.mBucketStartNs != mBucketSizeNs) {
-                protoOutput->write(FIELD_TYPE_INT64 | FIELD_ID_START_BUCKET_ELAPSED_MILLIS,
-                                   (long long)NanoToMillis(bucket.mBucketStartNs));
-                protoOutput->write(FIELD_TYPE_INT64 | FIELD_ID_END_BUCKET_ELAPSED_MILLIS,
-                                   (long long)NanoToMillis(bucket.mBucketEndNs));
-            } else {
-                protoOutput->write(FIELD_TYPE_INT64 | FIELD_ID_BUCKET_NUM,
-                                   (long long)(getBucketNumFromEndTimeNs(bucket.mBucketEndNs)));
+        // Then fill bucket_info (ValueBucketInfo). Buckets are staged in wire format when
+        // they are closed, so the common case just splices the pre-serialized bytes.
+        const auto staged = mStagedBucketInfos.find(dimensionKey);
+        if (staged != mStagedBucketInfos.end() && staged->second.size() == pair.second.size()) {
+            for (const std::string& bucketBytes : staged->second) {
+                protoOutput->write(
+                        FIELD_TYPE_MESSAGE | FIELD_COUNT_REPEATED | FIELD_ID_BUCKET_INFO,
+                        bucketBytes.data(), bucketBytes.size());
             }
-            // only write the condition timer value if the metric has a condition.
-            if (mConditionTrackerIndex >= 0) {
-                protoOutput->write(FIELD_TYPE_INT64 | FIELD_ID_CONDITION_TRUE_NS,
-                                   (long long)bucket.mConditionTrueNs);
-            }
-            for (int i = 0; i < (int)bucket.valueIndex.size(); i++) {
-                int index = bucket.valueIndex[i];
-                const Value& value = bucket.values[i];
-                uint64_t valueToken = protoOutput->start(
-                        FIELD_TYPE_MESSAGE | FIELD_COUNT_REPEATED | FIELD_ID_VALUES);
-                protoOutput->write(FIELD_TYPE_INT32 | FIELD_ID_VALUE_INDEX,
-                                   index);
-                if (value.getType() == LONG) {
-                    protoOutput->write(FIELD_TYPE_INT64 | FIELD_ID_VALUE_LONG,
-                                       (long long)value.long_value);
-                    VLOG("\t bucket [%lld - %lld] value %d: %lld", (long long)bucket.mBucketStartNs,
-                         (long long)bucket.mBucketEndNs, index, (long long)value.long_value);
-                } else if (value.getType() == DOUBLE) {
-                    protoOutput->write(FIELD_TYPE_DOUBLE | FIELD_ID_VALUE_DOUBLE,
-                                       value.double_value);
-                    VLOG("\t bucket [%lld - %lld] value %d: %.2f", (long long)bucket.mBucketStartNs,
-                         (long long)bucket.mBucketEndNs, index, value.double_value);
-                } else {
-                    VLOG("Wrong value type for ValueMetric output: %d", value.getType());
-                }
-                protoOutput->end(valueToken);
+        } else {
+            for (const auto& bucket : pair.second) {
+                uint64_t bucketInfoToken = protoOutput->start(
+                        FIELD_TYPE_MESSAGE | FIELD_COUNT_REPEATED | FIELD_ID_BUCKET_INFO);
+                writeBucketToProto(bucket, protoOutput);
+                protoOutput->end(bucketInfoToken);
             }
-            protoOutput->end(bucketInfoToken);
         }
         protoOutput->end(wrapperToken);
     }
@@ -381,10 +356,57 @@ void ValueMetricProducer::onDumpReportLocked(const int64_t dumpTimeNs,
     VLOG("metric %lld dump report now...", (long long)mMetricId);
     if (erase_data) {
         mPastBuckets.clear();
+        mStagedBucketInfos.clear();
         mSkippedBuckets.clear();
     }
 }
 
+void ValueMetricProducer::writeBucketToProto(const ValueBucket& bucket,
+                                             ProtoOutputStream* protoOutput) const {
+    if (bucket.mBucketEndNs - bucket.mBucketStartNs != mBucketSizeNs) {
+        protoOutput->write(FIELD_TYPE_INT64 | FIELD_ID_START_BUCKET_ELAPSED_MILLIS,
+                           (long long)NanoToMillis(bucket.mBucketStartNs));
+        protoOutput->write(FIELD_TYPE_INT64 | FIELD_ID_END_BUCKET_ELAPSED_MILLIS,
+                           (long long)NanoToMillis(bucket.mBucketEndNs));
+    } else {
+        protoOutput->write(FIELD_TYPE_INT64 | FIELD_ID_BUCKET_NUM,
+                           (long long)(getBucketNumFromEndTimeNs(bucket.mBucketEndNs)));
+    }
+    // only write the condition timer value if the metric has a condition.
+    if (mConditionTrackerIndex >= 0) {
+        protoOutput->write(FIELD_TYPE_INT64 | FIELD_ID_CONDITION_TRUE_NS,
+                           (long long)bucket.mConditionTrueNs);
+    }
+    for (int i = 0; i < (int)bucket.valueIndex.size(); i++) {
+        int index = bucket.valueIndex[i];
+        const Value& value = bucket.values[i];
+        uint64_t valueToken =
+                protoOutput->start(FIELD_TYPE_MESSAGE | FIELD_COUNT_REPEATED | FIELD_ID_VALUES);
+        protoOutput->write(FIELD_TYPE_INT32 | FIELD_ID_VALUE_INDEX, index);
+        if (value.getType() == LONG) {
+            protoOutput->write(FIELD_TYPE_INT64 | FIELD_ID_VALUE_LONG,
+                               (long long)value.long_value);
+            VLOG("\t bucket [%lld - %lld] value %d: %lld", (long long)bucket.mBucketStartNs,
+                 (long long)bucket.mBucketEndNs, index, (long long)value.long_value);
+        } else if (value.getType() == DOUBLE) {
+            protoOutput->write(FIELD_TYPE_DOUBLE | FIELD_ID_VALUE_DOUBLE, value.double_value);
+            VLOG("\t bucket [%lld - %lld] value %d: %.2f", (long long)bucket.mBucketStartNs,
+                 (long long)bucket.mBucketEndNs, index, value.double_value);
+        } else {
+            VLOG("Wrong value type for ValueMetric output: %d", value.getType());
+        }
+        protoOutput->end(valueToken);
+    }
+}
+
+std::string ValueMetricProducer::serializeBucket(const ValueBucket& bucket) const {
+    ProtoOutputStream proto;
+    writeBucketToProto(bucket, &proto);
+    std::string bytes;
+    proto.serializeToString(&bytes);
+    return bytes;
+}
+
 void ValueMetricProducer::invalidateCurrentBucketWithoutResetBase(const int64_t dropTimeNs,
                                                                   const BucketDropReason reason) {
     if (!mCurrentBucketIsSkipped) {
@@ -992,6 +1014,9 @@ void ValueMetricProducer::flushCurrentBucketLocked(const int64_t& eventTimeNs,
             if (bucket.valueIndex.size() > 0) {
                 auto& bucketList = mPastBuckets[slice.first];
                 bucketList.push_back(bucket);
+                // Stage the closed bucket in wire format now so the dump report only has
+                // to splice bytes; the serialization inputs are all fixed at this point.
+                mStagedBucketInfos[slice.first].push_back(serializeBucket(bucket));
                 bucketHasData = true;
             }
         }
@@ -208,6 +208,11 @@ private:
     // Save the past buckets and we can clear when the StatsLogReport is dumped.
     std::unordered_map<MetricDimensionKey, std::vector<ValueBucket>> mPastBuckets;
 
+    // Each closed bucket serialized to ValueBucketInfo wire format at flush time, parallel
+    // to mPastBuckets. Dump reports splice these staged bytes instead of re-serializing the
+    // whole history, so dump latency does not grow with the per-bucket value count.
+    std::unordered_map<MetricDimensionKey, std::vector<std::string>> mStagedBucketInfos;
+
     const int64_t mMinBucketSizeNs;
 
     // Util function to check whether the specified dimension hits the guardrail.
@@ -225,6 +230,14 @@ private:
     ValueBucket buildPartialBucket(int64_t bucketEndTime,
                                    const std::vector<Interval>& intervals);
 
+    // Writes the fields of one ValueBucketInfo message; used both to stage a closed
+    // bucket and as the fallback serialization path at dump time.
+    void writeBucketToProto(const ValueBucket& bucket,
+                            android::util::ProtoOutputStream* protoOutput) const;
+
+    // Serializes one closed bucket to ValueBucketInfo bytes for mStagedBucketInfos.
+    std::string serializeBucket(const ValueBucket& bucket) const;
+
     void initCurrentSlicedBucket(int64_t nextBucketStartTimeNs);
 
     void appendToFullBucket(const bool isFullBucketReached);
@@ -65,7 +65,7 @@ const int FIELD_ID_CHANGE_PREV_VERSION_STRING = 9;
 const int FIELD_ID_CHANGE_NEW_VERSION_STRING_HASH = 10;
 const int FIELD_ID_CHANGE_PREV_VERSION_STRING_HASH = 11;
 
-UidMap::UidMap() : mBytesUsed(0) {}
+UidMap::UidMap() : mSnapshot(std::make_shared<const PackageSnapshot>()), mBytesUsed(0) {}
 
 UidMap::~UidMap() {}
 
@@ -74,11 +74,23 @@ sp<UidMap> UidMap::getInstance() {
     return sInstance;
 }
 
-bool UidMap::hasApp(int uid, const string& packageName) const {
-    lock_guard<mutex> lock(mMutex);
+std::shared_ptr<const UidMap::PackageSnapshot> UidMap::getSnapshot() const {
+    return std::atomic_load_explicit(&mSnapshot, std::memory_order_acquire);
+}
+
+void UidMap::publishSnapshotLocked(PackageMap packages) {
+    auto snapshot = std::make_shared<PackageSnapshot>();
+    snapshot->version = getSnapshot()->version + 1;
+    snapshot->packages = std::move(packages);
+    std::atomic_store_explicit(&mSnapshot,
+                               std::shared_ptr<const PackageSnapshot>(std::move(snapshot)),
+                               std::memory_order_release);
+}
 
-    auto it = mMap.find(std::make_pair(uid, packageName));
-    return it != mMap.end() && !it->second.deleted;
+bool UidMap::hasApp(int uid, const string& packageName) const {
+    const auto snapshot = getSnapshot();
+    auto it = snapshot->packages.find(std::make_pair(uid, packageName));
+    return it != snapshot->packages.end() && !it->second.deleted;
 }
 
 string UidMap::normalizeAppName(const string& appName) const {
@@ -88,13 +100,14 @@ string UidMap::normalizeAppName(const string& appName) const {
 }
 
 std::set<string> UidMap::getAppNamesFromUid(const int32_t& uid, bool returnNormalized) const {
-    lock_guard<mutex> lock(mMutex);
-    return getAppNamesFromUidLocked(uid,returnNormalized);
+    return getAppNamesFromUidLocked(*getSnapshot(), uid, returnNormalized);
 }
 
-std::set<string> UidMap::getAppNamesFromUidLocked(const int32_t& uid, bool returnNormalized) const {
+std::set<string> UidMap::getAppNamesFromUidLocked(const PackageSnapshot& snapshot,
+                                                  const int32_t& uid,
+                                                  bool returnNormalized) const {
     std::set<string> names;
-    for (const auto& kv : mMap) {
+    for (const auto& kv : snapshot.packages) {
         if (kv.first.first == uid && !kv.second.deleted) {
             names.insert(returnNormalized ? normalizeAppName(kv.first.second) : kv.first.second);
         }
@@ -103,10 +116,9 @@ std::set<string> UidMap::getAppNamesFromUidLocked(const int32_t& uid, bool retur
 }
 
 int64_t UidMap::getAppVersion(int uid, const string& packageName) const {
-    lock_guard<mutex> lock(mMutex);
-
-    auto it = mMap.find(std::make_pair(uid, packageName));
-    if (it == mMap.end() || it->second.deleted) {
+    const auto snapshot = getSnapshot();
+    auto it = snapshot->packages.find(std::make_pair(uid, packageName));
+    if (it == snapshot->packages.end() || it->second.deleted) {
         return 0;
     }
     return it->second.versionCode;
@@ -119,30 +131,31 @@ void UidMap::updateMap(const int64_t& timestamp, const vector<int32_t>& uid,
     {
         lock_guard<mutex> lock(mMutex);  // Exclusively lock for updates.
 
-        std::unordered_map<std::pair<int, string>, AppData, PairHash> deletedApps;
+        PackageMap deletedApps;
 
         // Copy all the deleted apps.
-        for (const auto& kv : mMap) {
+        for (const auto& kv : getSnapshot()->packages) {
             if (kv.second.deleted) {
                 deletedApps[kv.first] = kv.second;
             }
         }
 
-        mMap.clear();
+        PackageMap newMap;
         for (size_t j = 0; j < uid.size(); j++) {
             string package = string(String8(packageName[j]).string());
-            mMap[std::make_pair(uid[j], package)] =
+            newMap[std::make_pair(uid[j], package)] =
                     AppData(versionCode[j], string(String8(versionString[j]).string()),
                             string(String8(installer[j]).string()));
         }
 
         for (const auto& kv : deletedApps) {
-            auto mMapIt = mMap.find(kv.first);
-            if (mMapIt != mMap.end()) {
+            auto newMapIt = newMap.find(kv.first);
+            if (newMapIt != newMap.end()) {
                 // Insert this deleted app back into the current map.
-                mMap[kv.first] = kv.second;
+                newMap[kv.first] = kv.second;
             }
         }
+        publishSnapshotLocked(std::move(newMap));
 
         ensureBytesUsedBelowLimit();
         StatsdStats::getInstance().setCurrentUidMapMemory(mBytesUsed);
@@ -169,8 +182,9 @@ void UidMap::updateApp(const int64_t& timestamp, const String16& app_16, const i
         string prevVersionString = "";
         string newVersionString = string(String8(versionString).string());
         bool found = false;
-        auto it = mMap.find(std::make_pair(uid, appName));
-        if (it != mMap.end()) {
+        PackageMap newMap = getSnapshot()->packages;  // COW: updates are rare.
+        auto it = newMap.find(std::make_pair(uid, appName));
+        if (it != newMap.end()) {
             found = true;
             prevVersion = it->second.versionCode;
             prevVersionString = it->second.versionString;
@@ -181,7 +195,7 @@ void UidMap::updateApp(const int64_t& timestamp, const String16& app_16, const i
         }
         if (!found) {
             // Otherwise, we need to add an app at this uid.
-            mMap[std::make_pair(uid, appName)] =
+            newMap[std::make_pair(uid, appName)] =
                     AppData(versionCode, newVersionString, string(String8(installer).string()));
         } else {
             // Only notify the listeners if this is an app upgrade. If this app is being installed
@@ -190,6 +204,7 @@ void UidMap::updateApp(const int64_t& timestamp, const String16& app_16, const i
             // app after deletion.
             broadcast = mSubscriber;
         }
+        publishSnapshotLocked(std::move(newMap));
         mChanges.emplace_back(false, timestamp, appName, uid, versionCode, newVersionString,
                               prevVersion, prevVersionString);
         mBytesUsed += kBytesChangeRecord;
@@ -230,8 +245,9 @@ void UidMap::removeApp(const int64_t& timestamp, const String16& app_16, const i
         int64_t prevVersion = 0;
         string prevVersionString = "";
         auto key = std::make_pair(uid, app);
-        auto it = mMap.find(key);
-        if (it != mMap.end() && !it->second.deleted) {
+        PackageMap newMap = getSnapshot()->packages;  // COW: removals are rare.
+        auto it = newMap.find(key);
+        if (it != newMap.end() && !it->second.deleted) {
             prevVersion = it->second.versionCode;
             prevVersionString = it->second.versionString;
             it->second.deleted = true;
@@ -241,9 +257,10 @@ void UidMap::removeApp(const int64_t& timestamp, const String16& app_16, const i
             // Delete the oldest one.
             auto oldest = mDeletedApps.front();
             mDeletedApps.pop_front();
-            mMap.erase(oldest);
+            newMap.erase(oldest);
             StatsdStats::getInstance().noteUidMapAppDeletionDropped();
         }
+        publishSnapshotLocked(std::move(newMap));
         mChanges.emplace_back(true, timestamp, app, uid, 0, "", prevVersion, prevVersionString);
         mBytesUsed += kBytesChangeRecord;
         ensureBytesUsedBelowLimit();
@@ -312,21 +329,23 @@ size_t UidMap::getBytesUsed() const {
     return mBytesUsed;
 }
 
+int64_t UidMap::getSnapshotVersion() const {
+    return getSnapshot()->version;
+}
+
 void UidMap::writeUidMapSnapshot(int64_t timestamp, bool includeVersionStrings,
                                  bool includeInstaller, const std::set<int32_t>& interestingUids,
                                  std::set<string>* str_set, ProtoOutputStream* proto) {
-    lock_guard<mutex> lock(mMutex);
-
-    writeUidMapSnapshotLocked(timestamp, includeVersionStrings, includeInstaller, interestingUids,
-                              str_set, proto);
+    writeUidMapSnapshotLocked(*getSnapshot(), timestamp, includeVersionStrings, includeInstaller,
+                              interestingUids, str_set, proto);
 }
 
-void UidMap::writeUidMapSnapshotLocked(int64_t timestamp, bool includeVersionStrings,
-                                       bool includeInstaller,
+void UidMap::writeUidMapSnapshotLocked(const PackageSnapshot& snapshot, int64_t timestamp,
+                                       bool includeVersionStrings, bool includeInstaller,
                                        const std::set<int32_t>& interestingUids,
                                        std::set<string>* str_set, ProtoOutputStream* proto) {
     proto->write(FIELD_TYPE_INT64 | FIELD_ID_SNAPSHOT_TIMESTAMP, (long long)timestamp);
-    for (const auto& kv : mMap) {
+    for (const auto& kv : snapshot.packages) {
         if (!interestingUids.empty() &&
             interestingUids.find(kv.first.first) == interestingUids.end()) {
             continue;
@@ -412,7 +431,7 @@ void UidMap::appendUidMap(const int64_t& timestamp, const ConfigKey& key, std::s
     // Write snapshot from current uid map state.
     uint64_t snapshotsToken =
             proto->start(FIELD_TYPE_MESSAGE | FIELD_COUNT_REPEATED | FIELD_ID_SNAPSHOTS);
-    writeUidMapSnapshotLocked(timestamp, includeVersionStrings, includeInstaller,
+    writeUidMapSnapshotLocked(*getSnapshot(), timestamp, includeVersionStrings, includeInstaller,
                               std::set<int32_t>() /*empty uid set means including every uid*/,
                               str_set, proto);
     proto->end(snapshotsToken);
@@ -438,9 +457,8 @@ void UidMap::appendUidMap(const int64_t& timestamp, const ConfigKey& key, std::s
 }
 
 void UidMap::printUidMap(int out) const {
-    lock_guard<mutex> lock(mMutex);
-
-    for (const auto& kv : mMap) {
+    const auto snapshot = getSnapshot();
+    for (const auto& kv : snapshot->packages) {
         if (!kv.second.deleted) {
             dprintf(out, "%s, v%" PRId64 ", %s, %s (%i)\n", kv.first.second.c_str(),
                     kv.second.versionCode, kv.second.versionString.c_str(),
@@ -458,10 +476,9 @@ void UidMap::OnConfigRemoved(const ConfigKey& key) {
 }
 
 set<int32_t> UidMap::getAppUid(const string& package) const {
-    lock_guard<mutex> lock(mMutex);
-
+    const auto snapshot = getSnapshot();
     set<int32_t> results;
-    for (const auto& kv : mMap) {
+    for (const auto& kv : snapshot->packages) {
         if (kv.first.second == package && !kv.second.deleted) {
             results.insert(kv.first.first);
         }
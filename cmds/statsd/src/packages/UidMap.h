@@ -27,6 +27,7 @@
 #include <utils/String16.h>
 
 #include <list>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <string>
@@ -149,6 +150,10 @@ public:
     // Get currently cached value of memory used by UID map.
     size_t getBytesUsed() const;
 
+    // Version of the currently published package snapshot; incremented on
+    // every package-change event.
+    int64_t getSnapshotVersion() const;
+
     virtual std::set<int32_t> getAppUid(const string& package) const;
 
     // Write current PackageInfoSnapshot to ProtoOutputStream.
@@ -161,16 +166,6 @@ public:
                              ProtoOutputStream* proto);
 
 private:
-    std::set<string> getAppNamesFromUidLocked(const int32_t& uid, bool returnNormalized) const;
-    string normalizeAppName(const string& appName) const;
-
-    void writeUidMapSnapshotLocked(int64_t timestamp, bool includeVersionStrings,
-                                   bool includeInstaller, const std::set<int32_t>& interestingUids,
-                                   std::set<string>* str_set, ProtoOutputStream* proto);
-
-    mutable mutex mMutex;
-    mutable mutex mIsolatedMutex;
-
     struct PairHash {
         size_t operator()(std::pair<int, string> p) const noexcept {
             std::hash<std::string> hash_fn;
@@ -178,7 +173,38 @@ private:
         }
     };
     // Maps uid and package name to application data.
-    std::unordered_map<std::pair<int, string>, AppData, PairHash> mMap;
+    using PackageMap = std::unordered_map<std::pair<int, string>, AppData, PairHash>;
+
+    // Immutable, versioned view of the package map.  Updates build a new map
+    // and publish it with an atomic store, so report generation and uid
+    // lookups read the current snapshot without taking mMutex.
+    struct PackageSnapshot {
+        int64_t version = 0;
+        PackageMap packages;
+    };
+
+    // Returns the current snapshot; lock-free.
+    std::shared_ptr<const PackageSnapshot> getSnapshot() const;
+
+    // Publishes a new snapshot built from the given map, bumping the version.
+    // Caller must hold mMutex so concurrent updates stay serialized.
+    void publishSnapshotLocked(PackageMap packages);
+
+    std::set<string> getAppNamesFromUidLocked(const PackageSnapshot& snapshot, const int32_t& uid,
+                                              bool returnNormalized) const;
+    string normalizeAppName(const string& appName) const;
+
+    void writeUidMapSnapshotLocked(const PackageSnapshot& snapshot, int64_t timestamp,
+                                   bool includeVersionStrings, bool includeInstaller,
+                                   const std::set<int32_t>& interestingUids,
+                                   std::set<string>* str_set, ProtoOutputStream* proto);
+
+    mutable mutex mMutex;
+    mutable mutex mIsolatedMutex;
+
+    // Current package snapshot; read with std::atomic_load and replaced with
+    // std::atomic_store under mMutex.
+    mutable std::shared_ptr<const PackageSnapshot> mSnapshot;
 
     // Maps isolated uid to the parent uid. Any metrics for an isolated uid will instead contribute
     // to the parent uid.
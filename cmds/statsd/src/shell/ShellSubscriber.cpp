@@ -41,6 +41,9 @@ void ShellSubscriber::startNewSubscription(int in, int out, int timeoutSec) {
 
     {
         std::unique_lock<std::mutex> lock(mMutex);
+        // Drop anything still batched for the previous subscription.
+        mProto.clear();
+        mBatchStartMs = 0;
         mSubscriptionInfo = mySubscriptionInfo;
         spawnHelperThread(myToken);
         waitForSubscriptionToEndLocked(mySubscriptionInfo, myToken, lock, timeoutSec);
@@ -153,6 +156,12 @@ void ShellSubscriber::pullAndSendHeartbeats(int myToken) {
                 pullInfo.mPrevPullElapsedRealtimeMs = nowMillis;
             }
 
+            // Flush any batched pushed atoms that have been waiting too long for more
+            // events to fill up the batch.
+            if (mProto.size() > 0 && nowMillis - mBatchStartMs >= kMsBetweenBatches) {
+                flushBatchLocked();
+            }
+
             // Send a heartbeat, consisting of a data size of 0, if perfd hasn't recently received
             // data from statsd. When it receives the data size of 0, perfd will not expect any
             // atoms and recheck whether the subscription should end.
@@ -166,6 +175,10 @@ void ShellSubscriber::pullAndSendHeartbeats(int myToken) {
                 int64_t timeBeforePull = nextPullTime - nowMillis; // guaranteed to be non-negative
                 if (timeBeforePull < sleepTimeMs) sleepTimeMs = timeBeforePull;
             }
+            if (mProto.size() > 0) {
+                int64_t timeBeforeBatchFlush = (mBatchStartMs + kMsBetweenBatches) - nowMillis;
+                if (timeBeforeBatchFlush < sleepTimeMs) sleepTimeMs = timeBeforeBatchFlush;
+            }
             int64_t timeBeforeHeartbeat = (mLastWriteMs + kMsBetweenHeartbeats) - nowMillis;
             if (timeBeforeHeartbeat < sleepTimeMs) sleepTimeMs = timeBeforeHeartbeat;
         }
@@ -188,7 +201,9 @@ void ShellSubscriber::getUidsForPullAtom(vector<int32_t>* uids, const PullInfo&
 
 void ShellSubscriber::writePulledAtomsLocked(const vector<std::shared_ptr<LogEvent>>& data,
                                              const SimpleAtomMatcher& matcher) {
-    mProto.clear();
+    // Batched pushed atoms go out first so the stream stays ordered.
+    flushBatchLocked();
+
     int count = 0;
     for (const auto& event : data) {
         if (matchesSimple(*mUidMap, matcher, *event)) {
@@ -201,22 +216,40 @@ void ShellSubscriber::writePulledAtomsLocked(const vector<std::shared_ptr<LogEve
     }
 
     if (count > 0) attemptWriteToPipeLocked(mProto.size());
+    mProto.clear();
 }
 
 void ShellSubscriber::onLogEvent(const LogEvent& event) {
     std::lock_guard<std::mutex> lock(mMutex);
     if (!mSubscriptionInfo) return;
 
-    mProto.clear();
     for (const auto& matcher : mSubscriptionInfo->mPushedMatchers) {
         if (matchesSimple(*mUidMap, matcher, event)) {
+            if (mProto.size() == 0) {
+                mBatchStartMs = getElapsedRealtimeMillis();
+            }
             uint64_t atomToken = mProto.start(util::FIELD_TYPE_MESSAGE |
                                               util::FIELD_COUNT_REPEATED | FIELD_ID_ATOM);
             event.ToProto(mProto);
             mProto.end(atomToken);
-            attemptWriteToPipeLocked(mProto.size());
         }
     }
+
+    // Large batches are flushed right away; small ones wait for more events until the
+    // batch ages out, checked here (high-rate atoms arrive long before the deadline)
+    // and by the helper thread.
+    if (mProto.size() >= kMaxBytesPerBatch ||
+        (mProto.size() > 0 &&
+         getElapsedRealtimeMillis() - mBatchStartMs >= kMsBetweenBatches)) {
+        flushBatchLocked();
+    }
+}
+
+void ShellSubscriber::flushBatchLocked() {
+    if (mProto.size() == 0) return;
+    attemptWriteToPipeLocked(mProto.size());
+    mProto.clear();
+    mBatchStartMs = 0;
 }
 
 // Tries to write the atom encoded in mProto to the pipe. If the write fails
@@ -54,6 +54,11 @@ namespace statsd {
  * The stream would be in the following format:
  * |size_t|shellData proto|size_t|shellData proto|....
  *
+ * Pushed atoms are not written one message per event: matched events are batched into a
+ * single ShellData message and flushed once the batch grows large enough or has been
+ * pending for a short interval, so high-rate subscriptions do not pay a write syscall
+ * per event.
+ *
  * Only one shell subscriber is allowed at a time because each shell subscriber blocks one thread
  * until it exits.
  */
@@ -119,6 +124,9 @@ private:
 
     void attemptWriteToPipeLocked(size_t dataSize);
 
+    // Flushes any batched pushed atoms to the pipe as a single ShellData message.
+    void flushBatchLocked();
+
     sp<UidMap> mUidMap;
 
     sp<StatsPullerManager> mPullerMgr;
@@ -139,6 +147,16 @@ private:
     // when next to send a heartbeat.
     int64_t mLastWriteMs = 0;
     const int64_t kMsBetweenHeartbeats = 1000;
+
+    // Elapsed time when the first atom of the pending pushed-atom batch was matched.
+    // 0 when no batch is pending.
+    int64_t mBatchStartMs = 0;
+
+    // A pushed-atom batch is flushed once it reaches kMaxBytesPerBatch or has been
+    // pending for kMsBetweenBatches. High-rate subscriptions hit the size limit; the
+    // helper thread flushes stragglers when it wakes up.
+    const size_t kMaxBytesPerBatch = 16 * 1024;
+    const int64_t kMsBetweenBatches = 100;
 };
 
 }  // namespace statsd
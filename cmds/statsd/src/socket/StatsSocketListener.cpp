@@ -19,6 +19,7 @@
 #include <ctype.h>
 #include <limits.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/cdefs.h>
 #include <sys/prctl.h>
 #include <sys/socket.h>
@@ -36,8 +37,20 @@ namespace android {
 namespace os {
 namespace statsd {
 
+namespace {
+
+// One datagram: android_log_header_t + max payload, + 1 to ensure null terminator
+// if a MAX_PAYLOAD buffer is received.
+constexpr size_t kDatagramSize = sizeof(android_log_header_t) + LOGGER_ENTRY_MAX_PAYLOAD + 1;
+
+}  // namespace
+
 StatsSocketListener::StatsSocketListener(std::shared_ptr<LogEventQueue> queue)
     : SocketListener(getLogSocket(), false /*start listen*/), mQueue(queue) {
+    mBatchBuffers.reserve(kMaxBatchSize);
+    for (size_t i = 0; i < kMaxBatchSize; i++) {
+        mBatchBuffers.emplace_back(new char[kDatagramSize]);
+    }
 }
 
 StatsSocketListener::~StatsSocketListener() {
@@ -50,22 +63,41 @@ bool StatsSocketListener::onDataAvailable(SocketClient* cli) {
         name_set = true;
     }
 
-    // + 1 to ensure null terminator if MAX_PAYLOAD buffer is received
-    char buffer[sizeof(android_log_header_t) + LOGGER_ENTRY_MAX_PAYLOAD + 1];
-    struct iovec iov = {buffer, sizeof(buffer) - 1};
-
-    alignas(4) char control[CMSG_SPACE(sizeof(struct ucred))];
-    struct msghdr hdr = {
-            NULL, 0, &iov, 1, control, sizeof(control), 0,
-    };
+    struct mmsghdr msgs[kMaxBatchSize];
+    struct iovec iovs[kMaxBatchSize];
+    alignas(4) char controls[kMaxBatchSize][CMSG_SPACE(sizeof(struct ucred))];
+    memset(msgs, 0, sizeof(msgs));
+    for (size_t i = 0; i < kMaxBatchSize; i++) {
+        iovs[i] = {mBatchBuffers[i].get(), kDatagramSize - 1};
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = controls[i];
+        msgs[i].msg_hdr.msg_controllen = sizeof(controls[i]);
+    }
 
     int socket = cli->getSocket();
 
+    // Drain every datagram already queued on the socket in one syscall. Under log
+    // storms this turns one poll wakeup + recvmsg per event into one per batch; the
+    // processor thread is also woken at most once since the whole batch is parsed and
+    // pushed before the queue drains again.
+    int count = TEMP_FAILURE_RETRY(recvmmsg(socket, msgs, kMaxBatchSize, MSG_DONTWAIT, nullptr));
+    if (count <= 0) {
+        return false;
+    }
+
+    bool result = false;
+    for (int i = 0; i < count; i++) {
+        result |= processMessage(&msgs[i].msg_hdr, mBatchBuffers[i].get(), msgs[i].msg_len);
+    }
+    return result;
+}
+
+bool StatsSocketListener::processMessage(struct msghdr* hdr, char* buffer, ssize_t n) {
     // To clear the entire buffer is secure/safe, but this contributes to 1.68%
     // overhead under logging load. We are safe because we check counts, but
     // still need to clear null terminator
-    // memset(buffer, 0, sizeof(buffer));
-    ssize_t n = recvmsg(socket, &hdr, 0);
+    // memset(buffer, 0, kDatagramSize);
     if (n <= (ssize_t)(sizeof(android_log_header_t))) {
         return false;
     }
@@ -74,13 +106,13 @@ bool StatsSocketListener::onDataAvailable(SocketClient* cli) {
 
     struct ucred* cred = NULL;
 
-    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(hdr);
     while (cmsg != NULL) {
         if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_CREDENTIALS) {
             cred = (struct ucred*)CMSG_DATA(cmsg);
             break;
         }
-        cmsg = CMSG_NXTHDR(&hdr, cmsg);
+        cmsg = CMSG_NXTHDR(hdr, cmsg);
     }
 
     struct ucred fake_cred;
@@ -127,7 +159,10 @@ bool StatsSocketListener::onDataAvailable(SocketClient* cli) {
 
     int64_t oldestTimestamp;
     std::unique_ptr<LogEvent> logEvent = std::make_unique<LogEvent>(uid, pid);
-    logEvent->parseBuffer(msg, len);
+    // Lazy parse: only the timestamp and atom ID are decoded here, so the socket
+    // thread gets back to draining the socket quickly. The full field decode runs
+    // on the processor thread, and never runs for events dropped on overflow.
+    logEvent->parseBufferLazily(msg, len);
 
     if (!mQueue->push(std::move(logEvent), &oldestTimestamp)) {
         StatsdStats::getInstance().noteEventQueueOverflow(oldestTimestamp);
@@ -17,6 +17,10 @@
 
 #include <sysutils/SocketListener.h>
 #include <utils/RefBase.h>
+
+#include <memory>
+#include <vector>
+
 #include "logd/LogEventQueue.h"
 
 // DEFAULT_OVERFLOWUID is defined in linux/highuid.h, which is not part of
@@ -44,6 +48,25 @@ protected:
 
 private:
     static int getLogSocket();
+
+    /**
+     * Parses one received datagram and pushes the resulting LogEvent to the queue.
+     * hdr is the message header recvmmsg filled in for this datagram; buffer holds
+     * n received bytes and has room for a null terminator.
+     */
+    bool processMessage(struct msghdr* hdr, char* buffer, ssize_t n);
+
+    /**
+     * Maximum number of datagrams drained from the socket per wakeup.
+     */
+    static constexpr size_t kMaxBatchSize = 16;
+
+    /**
+     * Preallocated receive buffers for batched ingestion, one datagram each. Only
+     * touched from the SocketListener thread.
+     */
+    std::vector<std::unique_ptr<char[]>> mBatchBuffers;
+
     /**
      * Who is going to get the events when they're read.
      */
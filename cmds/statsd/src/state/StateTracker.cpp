@@ -59,10 +59,62 @@ void StateTracker::onLogEvent(const LogEvent& event) {
     }
 
     const bool nested = newState.mAnnotations.isNested();
-    StateValueInfo* stateValueInfo = &mStateMap[primaryKey];
+    StateValueInfo* stateValueInfo = getOrCreateStateInfo(primaryKey);
     updateStateForPrimaryKey(eventTimeNs, primaryKey, newState, nested, stateValueInfo);
 }
 
+int StateTracker::getDenseKey(const HashableDimensionKey& primaryKey) const {
+    const std::vector<FieldValue>& values = primaryKey.getValues();
+    if (values.size() != 1 || values[0].mValue.getType() != INT) {
+        return -1;
+    }
+    if (mHaveDensePrimaryField && values[0].mField != mDensePrimaryField) {
+        return -1;
+    }
+    const int key = values[0].mValue.int_value;
+    if (key < 0 || key >= kMaxDenseKey) {
+        return -1;
+    }
+    return key;
+}
+
+HashableDimensionKey StateTracker::denseKeyFor(int key) const {
+    HashableDimensionKey primaryKey;
+    primaryKey.addValue(FieldValue(mDensePrimaryField, Value(key)));
+    return primaryKey;
+}
+
+StateValueInfo* StateTracker::getOrCreateStateInfo(const HashableDimensionKey& primaryKey) {
+    const int key = getDenseKey(primaryKey);
+    if (key < 0) {
+        return &mStateMap[primaryKey];
+    }
+    if (!mHaveDensePrimaryField) {
+        mDensePrimaryField = primaryKey.getValues()[0].mField;
+        mHaveDensePrimaryField = true;
+    }
+    if (key >= (int)mDenseStates.size()) {
+        mDenseStates.resize(key + 1);
+    }
+    DenseStateEntry& entry = mDenseStates[key];
+    if (entry.generation != mDenseGeneration) {
+        entry.generation = mDenseGeneration;
+        entry.info = StateValueInfo();
+    }
+    return &entry.info;
+}
+
+void StateTracker::eraseStateForPrimaryKey(const HashableDimensionKey& primaryKey) {
+    const int key = getDenseKey(primaryKey);
+    if (key >= 0) {
+        if (key < (int)mDenseStates.size()) {
+            mDenseStates[key].generation = 0;
+        }
+        return;
+    }
+    mStateMap.erase(primaryKey);
+}
+
 void StateTracker::registerListener(wp<StateListener> listener) {
     mListeners.insert(listener);
 }
@@ -74,6 +126,16 @@ void StateTracker::unregisterListener(wp<StateListener> listener) {
 bool StateTracker::getStateValue(const HashableDimensionKey& queryKey, FieldValue* output) const {
     output->mField = mField;
 
+    if (const int key = getDenseKey(queryKey); key >= 0) {
+        if (key < (int)mDenseStates.size() &&
+            mDenseStates[key].generation == mDenseGeneration) {
+            output->mValue = mDenseStates[key].info.state;
+            return true;
+        }
+        output->mValue = kStateUnknown;
+        return false;
+    }
+
     if (const auto it = mStateMap.find(queryKey); it != mStateMap.end()) {
         output->mValue = it->second.state;
         return true;
@@ -91,17 +153,37 @@ void StateTracker::handleReset(const int64_t eventTimeNs, const FieldValue& newS
                                  false /* nested; treat this state change as not nested */,
                                  &stateValueInfo);
     }
+    for (int key = 0; key < (int)mDenseStates.size(); key++) {
+        DenseStateEntry& entry = mDenseStates[key];
+        if (entry.generation != mDenseGeneration) {
+            continue;
+        }
+        updateStateForPrimaryKey(eventTimeNs, denseKeyFor(key), newState,
+                                 false /* nested; treat this state change as not nested */,
+                                 &entry.info);
+    }
 }
 
 void StateTracker::clearStateForPrimaryKey(const int64_t eventTimeNs,
                                            const HashableDimensionKey& primaryKey) {
     VLOG("StateTracker clear state for primary key");
+    const FieldValue state(mField, Value(kStateUnknown));
+
+    if (const int key = getDenseKey(primaryKey); key >= 0) {
+        if (key < (int)mDenseStates.size() &&
+            mDenseStates[key].generation == mDenseGeneration) {
+            updateStateForPrimaryKey(eventTimeNs, primaryKey, state,
+                                     false /* nested; treat this state change as not nested */,
+                                     &mDenseStates[key].info);
+        }
+        return;
+    }
+
     const std::unordered_map<HashableDimensionKey, StateValueInfo>::iterator it =
             mStateMap.find(primaryKey);
 
     // If there is no entry for the primaryKey in mStateMap, then the state is already
     // kStateUnknown.
-    const FieldValue state(mField, Value(kStateUnknown));
     if (it != mStateMap.end()) {
         updateStateForPrimaryKey(eventTimeNs, primaryKey, state,
                                  false /* nested; treat this state change as not nested */,
@@ -120,7 +202,7 @@ void StateTracker::updateStateForPrimaryKey(const int64_t eventTimeNs,
     const int32_t newStateValue = newState.mValue.int_value;
 
     if (kStateUnknown == newStateValue) {
-        mStateMap.erase(primaryKey);
+        eraseStateForPrimaryKey(primaryKey);
     }
 
     // Update state map for non-nested counting case.
@@ -22,6 +22,7 @@
 #include "state/StateListener.h"
 
 #include <unordered_map>
+#include <vector>
 
 namespace android {
 namespace os {
@@ -65,9 +66,45 @@ private:
 
     Field mField;
 
-    // Maps primary key to state value info
+    // Maps primary key to state value info.  Only used for composite primary
+    // keys; the overwhelmingly common single-uid keys live in mDenseStates.
     std::unordered_map<HashableDimensionKey, StateValueInfo> mStateMap;
 
+    // Dense fast path for single int-valued primary keys (in practice a uid).
+    // The state lives in a flat array indexed by the key value, so per-event
+    // lookups cost an index instead of hashing the full dimension key.  A
+    // slot is occupied only while its generation matches mDenseGeneration;
+    // erasing a key just zeroes its generation, so no tombstones accumulate.
+    struct DenseStateEntry {
+        StateValueInfo info;
+        uint32_t generation = 0;
+    };
+
+    // Keys with values at or above this fall back to mStateMap.
+    static const int kMaxDenseKey = 32768;
+
+    std::vector<DenseStateEntry> mDenseStates;  // sized lazily up to kMaxDenseKey
+    uint32_t mDenseGeneration = 1;
+
+    // The field shared by all dense primary keys; set on first dense insert.
+    // Keys with a different field (or more than one value) use mStateMap.
+    Field mDensePrimaryField;
+    bool mHaveDensePrimaryField = false;
+
+    // Returns the dense index for the key, or -1 if the key is composite,
+    // out of range, or its field does not match mDensePrimaryField.
+    int getDenseKey(const HashableDimensionKey& primaryKey) const;
+
+    // Rebuilds the single-field primary key for a dense index (needed when
+    // notifying listeners from reset/clear paths).
+    HashableDimensionKey denseKeyFor(int key) const;
+
+    // Returns the state info slot for the key, creating it if needed.
+    StateValueInfo* getOrCreateStateInfo(const HashableDimensionKey& primaryKey);
+
+    // Removes the state entry for the key from whichever store holds it.
+    void eraseStateForPrimaryKey(const HashableDimensionKey& primaryKey);
+
     // Set of all StateListeners (objects listening for state changes)
     std::set<wp<StateListener>> mListeners;
 
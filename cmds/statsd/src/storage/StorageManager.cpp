@@ -24,7 +24,9 @@
 
 #include <android-base/file.h>
 #include <private/android_filesystem_config.h>
-#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
 
 namespace android {
 namespace os {
@@ -46,6 +48,12 @@ using std::map;
 // Magic word at the start of the train info file, change this if changing the file format
 const uint32_t TRAIN_INFO_FILE_MAGIC = 0xfb7447bf;
 
+// Magic word at the start of a compressed report file, followed by the uncompressed size
+// as a uint32_t and then a zlib deflate stream. The leading byte (0x7e) decodes as proto
+// wire type 6, which does not exist, so a raw protobuf report can never start with this
+// word and readers can tell the two formats apart. Change this if changing the format.
+const uint32_t COMPRESSED_REPORT_FILE_MAGIC = 0x9c64da7e;
+
 // for ConfigMetricsReportList
 const int FIELD_ID_REPORTS = 2;
 
@@ -54,6 +62,78 @@ std::mutex StorageManager::sTrainInfoMutex;
 using android::base::StringPrintf;
 using std::unique_ptr;
 
+namespace {
+
+// Read-only mapping of a whole file. Reports and configs are written once and then only
+// read back in full, so mapping them lets the bytes go straight from the page cache into
+// the output without first being copied through a userspace buffer.
+class MappedFile {
+public:
+    explicit MappedFile(const char* file) {
+        int fd = open(file, O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            VLOG("Failed to open %s", file);
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                mData = static_cast<const char*>(map);
+                mSize = st.st_size;
+            } else {
+                VLOG("Failed to mmap %s", file);
+            }
+        }
+        // The mapping stays valid after the fd is closed.
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (mData != nullptr) {
+            munmap(const_cast<char*>(mData), mSize);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool valid() const { return mData != nullptr; }
+    const char* data() const { return mData; }
+    size_t size() const { return mSize; }
+
+private:
+    const char* mData = nullptr;
+    size_t mSize = 0;
+};
+
+// Inflates a compressed report file (COMPRESSED_REPORT_FILE_MAGIC format) into out.
+// Returns false if the stream is corrupt or does not match the recorded size.
+bool inflateReportFile(const MappedFile& file, vector<uint8_t>* out) {
+    const size_t headerSize = 2 * sizeof(uint32_t);
+    if (file.size() < headerSize) {
+        return false;
+    }
+    uint32_t uncompressedSize;
+    memcpy(&uncompressedSize, file.data() + sizeof(uint32_t), sizeof(uncompressedSize));
+    out->resize(uncompressedSize);
+
+    z_stream strm = {};
+    if (inflateInit(&strm) != Z_OK) {
+        return false;
+    }
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(file.data() + headerSize));
+    strm.avail_in = file.size() - headerSize;
+    strm.next_out = out->data();
+    strm.avail_out = uncompressedSize;
+    const int ret = inflate(&strm, Z_FINISH);
+    const bool ok = (ret == Z_STREAM_END && strm.total_out == uncompressedSize);
+    inflateEnd(&strm);
+    return ok;
+}
+
+}  // namespace
+
 struct FileName {
     int64_t mTimestampSec;
     int mUid;
@@ -146,6 +226,65 @@ void StorageManager::writeFile(const char* file, const void* buffer, int numByte
     close(fd);
 }
 
+void StorageManager::writeCompressedFile(const char* file, const void* buffer, int numBytes,
+                                         int compressionLevel) {
+    int fd = open(file, O_WRONLY | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        VLOG("Attempt to access %s but failed", file);
+        return;
+    }
+    trimToFit(STATS_SERVICE_DIR);
+    trimToFit(STATS_DATA_DIR);
+
+    z_stream strm = {};
+    if (deflateInit(&strm, compressionLevel) != Z_OK) {
+        // Compression is only an optimization; fall back to the raw format, which
+        // appendConfigMetricsReport still understands.
+        ALOGE("Failed to init compression for %s, writing raw", file);
+        if (!android::base::WriteFully(fd, buffer, numBytes)) {
+            ALOGE("Failed to write %s", file);
+        }
+    } else {
+        const uint32_t header[2] = {COMPRESSED_REPORT_FILE_MAGIC, (uint32_t)numBytes};
+        bool success = android::base::WriteFully(fd, header, sizeof(header));
+
+        // Compress in fixed-size chunks so the deflate output never has to be
+        // buffered in full alongside the report itself.
+        strm.next_in = reinterpret_cast<Bytef*>(const_cast<void*>(buffer));
+        strm.avail_in = numBytes;
+        uint8_t chunk[32 * 1024];
+        int ret = Z_OK;
+        while (success && ret != Z_STREAM_END) {
+            strm.next_out = chunk;
+            strm.avail_out = sizeof(chunk);
+            ret = deflate(&strm, Z_FINISH);
+            if (ret == Z_STREAM_ERROR) {
+                success = false;
+                break;
+            }
+            const size_t have = sizeof(chunk) - strm.avail_out;
+            if (have > 0 && !android::base::WriteFully(fd, chunk, have)) {
+                success = false;
+            }
+        }
+        deflateEnd(&strm);
+
+        if (success) {
+            VLOG("Successfully wrote %s (%d -> %lld bytes)", file, numBytes,
+                 (long long)(sizeof(header) + strm.total_out));
+        } else {
+            ALOGE("Failed to write %s", file);
+        }
+    }
+
+    int result = fchown(fd, AID_STATSD, AID_STATSD);
+    if (result) {
+        VLOG("Failed to chown %s to statsd", file);
+    }
+
+    close(fd);
+}
+
 bool StorageManager::writeTrainInfo(const InstallTrainInfo& trainInfo) {
     std::lock_guard<std::mutex> lock(sTrainInfoMutex);
 
@@ -527,14 +666,24 @@ void StorageManager::appendConfigMetricsReport(const ConfigKey& key, ProtoOutput
         }
 
         auto fullPathName = StringPrintf("%s/%s", STATS_DATA_DIR, fileName.c_str());
-        int fd = open(fullPathName.c_str(), O_RDONLY | O_CLOEXEC);
-        if (fd != -1) {
-            string content;
-            if (android::base::ReadFdToString(fd, &content)) {
+        MappedFile report(fullPathName.c_str());
+        if (report.valid()) {
+            uint32_t magic = 0;
+            if (report.size() >= sizeof(magic)) {
+                memcpy(&magic, report.data(), sizeof(magic));
+            }
+            if (magic == COMPRESSED_REPORT_FILE_MAGIC) {
+                vector<uint8_t> inflated;
+                if (inflateReportFile(report, &inflated)) {
+                    proto->write(FIELD_TYPE_MESSAGE | FIELD_COUNT_REPEATED | FIELD_ID_REPORTS,
+                                 reinterpret_cast<const char*>(inflated.data()), inflated.size());
+                } else {
+                    ALOGE("failed to inflate report file %s", fullPathName.c_str());
+                }
+            } else {
                 proto->write(FIELD_TYPE_MESSAGE | FIELD_COUNT_REPEATED | FIELD_ID_REPORTS,
-                             content.c_str(), content.size());
+                             report.data(), report.size());
             }
-            close(fd);
         } else {
             ALOGE("file cannot be opened");
         }
@@ -584,18 +733,14 @@ void StorageManager::readConfigFromDisk(map<ConfigKey, StatsdConfig>& configsMap
         parseFileName(name, &output);
         if (output.mTimestampSec == -1) continue;
         string file_name = output.getFullFileName(STATS_SERVICE_DIR);
-        int fd = open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
-        if (fd != -1) {
-            string content;
-            if (android::base::ReadFdToString(fd, &content)) {
-                StatsdConfig config;
-                if (config.ParseFromString(content)) {
-                    configsMap[ConfigKey(output.mUid, output.mConfigId)] = config;
-                    VLOG("map key uid=%lld|configID=%lld", (long long)output.mUid,
-                         (long long)output.mConfigId);
-                }
+        MappedFile file(file_name.c_str());
+        if (file.valid()) {
+            StatsdConfig config;
+            if (config.ParseFromArray(file.data(), file.size())) {
+                configsMap[ConfigKey(output.mUid, output.mConfigId)] = config;
+                VLOG("map key uid=%lld|configID=%lld", (long long)output.mUid,
+                     (long long)output.mConfigId);
             }
-            close(fd);
         }
     }
 }
@@ -623,16 +768,14 @@ bool StorageManager::readConfigFromDisk(const ConfigKey& key, string* content) {
         }
         size_t nameLen = strlen(name);
         size_t suffixLen = suffix.length();
-        // There can be at most one file that matches this suffix (config key).
+        // There can be at most one file that matches this suffix (config key); the file
+        // name carries the config key, so only the matching config is ever read.
         if (suffixLen <= nameLen &&
             strncmp(name + nameLen - suffixLen, suffix.c_str(), suffixLen) == 0) {
-            int fd = open(StringPrintf("%s/%s", STATS_SERVICE_DIR, name).c_str(),
-                                  O_RDONLY | O_CLOEXEC);
-            if (fd != -1) {
-                if (android::base::ReadFdToString(fd, content)) {
-                    return true;
-                }
-                close(fd);
+            MappedFile file(StringPrintf("%s/%s", STATS_SERVICE_DIR, name).c_str());
+            if (file.valid()) {
+                content->assign(file.data(), file.size());
+                return true;
             }
         }
     }
@@ -643,10 +786,8 @@ bool StorageManager::hasIdenticalConfig(const ConfigKey& key,
                                         const vector<uint8_t>& config) {
     string content;
     if (StorageManager::readConfigFromDisk(key, &content)) {
-        vector<uint8_t> vec(content.begin(), content.end());
-        if (vec == config) {
-            return true;
-        }
+        return content.size() == config.size() &&
+               memcmp(content.data(), config.data(), content.size()) == 0;
     }
     return false;
 }
@@ -709,12 +850,11 @@ void StorageManager::trimToFit(const char* path, bool parseTimestampOnly) {
             continue;
         }
 
-        ifstream file(file_name.c_str(), ifstream::in | ifstream::binary);
+        // stat() is enough to learn the size; don't open every file just to seek to its end.
+        struct stat st;
         int fileSize = 0;
-        if (file.is_open()) {
-            file.seekg(0, ios::end);
-            fileSize = file.tellg();
-            file.close();
+        if (stat(file_name.c_str(), &st) == 0) {
+            fileSize = st.st_size;
             totalFileSize += fileSize;
         }
         fileNames.emplace_back(file_name, output.mIsHistory, fileSize, fileAge);
@@ -761,13 +901,10 @@ void StorageManager::printDirStats(int outFd, const char* path) {
                 (long long)output.mTimestampSec, output.mUid, (long long)output.mConfigId,
                 (output.mIsHistory ? "local history" : ""));
         string file_name = output.getFullFileName(path);
-        ifstream file(file_name.c_str(), ifstream::in | ifstream::binary);
-        if (file.is_open()) {
-            file.seekg(0, ios::end);
-            int fileSize = file.tellg();
-            file.close();
-            dprintf(outFd, ", File Size: %d bytes", fileSize);
-            totalFileSize += fileSize;
+        struct stat st;
+        if (stat(file_name.c_str(), &st) == 0) {
+            dprintf(outFd, ", File Size: %d bytes", (int)st.st_size);
+            totalFileSize += st.st_size;
         }
         dprintf(outFd, "\n");
         fileCount++;
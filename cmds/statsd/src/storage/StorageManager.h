@@ -49,6 +49,21 @@ public:
      */
     static void writeFile(const char* file, const void* buffer, int numBytes);
 
+    // zlib compression levels for writeCompressedFile. Fast is Z_BEST_SPEED for
+    // time-constrained dumps (e.g. statsd is being killed); default is zlib's
+    // default level for everything else.
+    static const int kCompressionLevelFast = 1;
+    static const int kCompressionLevelDefault = 6;
+
+    /**
+     * Writes a given byte array as a deflate-compressed file to the specified
+     * file path. The file starts with a magic word so that readers can tell
+     * compressed report files from raw ones; appendConfigMetricsReport
+     * transparently inflates such files when folding them back into a report.
+     */
+    static void writeCompressedFile(const char* file, const void* buffer, int numBytes,
+                                    int compressionLevel);
+
     /**
      * Writes train info.
      */
@@ -129,6 +129,31 @@ TEST(HashableDimensionKeyTest, TestContainsLinkedStateValues_AllConditionsMet) {
     EXPECT_TRUE(containsLinkedStateValues(whatKey, primaryKey, mMetric2StateLinks, stateAtomId));
 }
 
+/**
+ * Test that the cached hash is invalidated when a key is mutated after it was
+ * first hashed.
+ */
+TEST(HashableDimensionKeyTest, TestHashInvalidatedOnMutation) {
+    int32_t uid1 = 1000;
+    int32_t uid2 = 2000;
+
+    HashableDimensionKey key;
+    getUidProcessKey(uid1, &key);
+    HashableDimensionKey copy(key);
+
+    EXPECT_EQ(key.hash(), copy.hash());
+    EXPECT_EQ(key.hash(), key.hash());
+
+    HashableDimensionKey mutated;
+    getUidProcessKey(uid2, &mutated);
+    // Hash before mutating so the cache is populated, then mutate.
+    EXPECT_NE(key.hash(), mutated.hash());
+    mutated.mutableValue(0)->mValue.setInt(uid1);
+
+    EXPECT_EQ(key.hash(), mutated.hash());
+    EXPECT_TRUE(key == mutated);
+}
+
 }  // namespace statsd
 }  // namespace os
 }  // namespace android
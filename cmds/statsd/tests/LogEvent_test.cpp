@@ -127,6 +127,36 @@ TEST(LogEventTest, TestPrimitiveParsing) {
     AStatsEvent_release(event);
 }
 
+TEST(LogEventTest, TestLazyParsing) {
+    AStatsEvent* event = AStatsEvent_obtain();
+    AStatsEvent_setAtomId(event, 100);
+    AStatsEvent_writeInt32(event, 10);
+    AStatsEvent_writeInt64(event, 0x123456789);
+    AStatsEvent_build(event);
+
+    size_t size;
+    uint8_t* buf = AStatsEvent_getBuffer(event, &size);
+
+    LogEvent logEvent(/*uid=*/1000, /*pid=*/1001);
+    EXPECT_TRUE(logEvent.parseBufferLazily(buf, size));
+
+    // The prefix is available without a full decode.
+    EXPECT_EQ(100, logEvent.GetTagId());
+    EXPECT_EQ(1000, logEvent.GetUid());
+    EXPECT_EQ(1001, logEvent.GetPid());
+
+    // Scribble over the source buffer to prove the deferred decode does not
+    // depend on it staying alive.
+    memset(buf, 0xab, size);
+    AStatsEvent_release(event);
+
+    EXPECT_TRUE(logEvent.isValid());
+    const vector<FieldValue>& values = logEvent.getValues();
+    ASSERT_EQ(2, values.size());
+    EXPECT_EQ(10, values[0].mValue.int_value);
+    EXPECT_EQ(0x123456789, values[1].mValue.long_value);
+}
+
 TEST(LogEventTest, TestStringAndByteArrayParsing) {
     AStatsEvent* event = AStatsEvent_obtain();
     AStatsEvent_setAtomId(event, 100);
@@ -90,6 +90,8 @@ TEST(LogEventQueue_test, TestSlowConsumer) {
         EXPECT_TRUE(failure_count >= 45);
         // The oldest event must be at least the 6th event.
         EXPECT_TRUE(oldestEventNs <= (100 + 5 * 1000));
+        // Every rejected push is accounted for.
+        EXPECT_EQ(failure_count, queue.getDroppedCount());
     });
 
     std::thread reader([&queue, timeBaseNs] {
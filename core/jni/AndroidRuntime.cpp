@@ -31,11 +31,15 @@
 #include <cutils/properties.h>
 #include <dirent.h>
 #include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <nativehelper/JNIHelp.h>
 #include <nativehelper/JniInvocation.h>
 #include <server_configurable_flags/get_flags.h>
 #include <signal.h>
 #include <stdio.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <utils/Log.h>
@@ -1125,6 +1129,69 @@ jstring AndroidRuntime::NewStringLatin1(JNIEnv* env, const char* bytes) {
 }
 
 
+/*
+ * Pin the files named in the device's pin map into the page cache before the
+ * zygote starts preloading.  The pin map is a text file (one entry per line:
+ * a path, optionally followed by the number of leading bytes to mlock) named
+ * by ro.zygote.pin_config, typically generated for a device by recording
+ * which framework files the top apps touch during cold starts.  Each file is
+ * mapped read-only and advised MADV_WILLNEED so its pages are read ahead in
+ * one pass; the mappings are deliberately never unmapped, since the zygote's
+ * children inherit them and the pages stay shared and resident.
+ */
+static void preloadPinnedFiles()
+{
+    char pinConfigBuf[PROPERTY_VALUE_MAX];
+    property_get("ro.zygote.pin_config", pinConfigBuf, "");
+    if (pinConfigBuf[0] == '\0') {
+        return;
+    }
+
+    FILE* config = fopen(pinConfigBuf, "re");
+    if (config == NULL) {
+        ALOGW("Unable to open pin config %s: %s", pinConfigBuf, strerror(errno));
+        return;
+    }
+
+    char line[PATH_MAX + 32];
+    while (fgets(line, sizeof(line), config) != NULL) {
+        char path[PATH_MAX];
+        long long lockBytes = 0;
+        if (sscanf(line, "%4095s %lld", path, &lockBytes) < 1 || path[0] == '#') {
+            continue;
+        }
+
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            ALOGW("Unable to pin %s: %s", path, strerror(errno));
+            continue;
+        }
+        struct stat sb;
+        if (fstat(fd, &sb) != 0 || sb.st_size == 0) {
+            close(fd);
+            continue;
+        }
+        void* addr = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED) {
+            ALOGW("Unable to map %s for pinning: %s", path, strerror(errno));
+            continue;
+        }
+
+        madvise(addr, sb.st_size, MADV_WILLNEED);
+        if (lockBytes > 0) {
+            if (lockBytes > sb.st_size) {
+                lockBytes = sb.st_size;
+            }
+            if (mlock(addr, lockBytes) != 0) {
+                ALOGW("Unable to mlock %lld bytes of %s: %s", lockBytes, path, strerror(errno));
+            }
+        }
+        ALOGV("Pinned %s (%lld bytes locked)", path, lockBytes);
+    }
+    fclose(config);
+}
+
 /*
  * Start the Android runtime.  This involves starting the virtual machine
  * and calling the "static void main(String[] args)" method in the class
@@ -1186,6 +1253,14 @@ void AndroidRuntime::start(const char* className, const Vector<String8>& options
     //const char* kernelHack = getenv("LD_ASSUME_KERNEL");
     //ALOGD("Found LD_ASSUME_KERNEL='%s'\n", kernelHack);
 
+    /*
+     * Warm the page cache for the device's pinned framework files before the
+     * VM starts preloading classes and resources out of them.
+     */
+    if (zygote) {
+        preloadPinnedFiles();
+    }
+
     /* start the virtual machine */
     JniInvocation jni_invocation;
     jni_invocation.Init(NULL);
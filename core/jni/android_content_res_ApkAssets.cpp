@@ -16,6 +16,15 @@
 
 #define ATRACE_TAG ATRACE_TAG_RESOURCES
 
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "android-base/logging.h"
 #include "android-base/macros.h"
 #include "android-base/stringprintf.h"
@@ -157,6 +166,135 @@ class LoaderAssetsProvider : public AssetsProvider {
   jobject assets_provider_;
 };
 
+// Preload scheduler: ResourcesManager announces APK paths it expects to load
+// soon (for example the splits named by a launch intent), the paths are parsed
+// on worker threads via ApkAssets::LoadMany, and a later nativeLoad for the
+// same path claims the parsed ApkAssets instead of parsing on the calling
+// (usually UI) thread. Entries are keyed by path; a claim must also match the
+// format and property flags or the entry is ignored.
+struct PreloadEntry {
+  format_type_t format;
+  jint property_flags;
+  bool done = false;
+  std::unique_ptr<const ApkAssets> apk_assets;
+};
+
+static std::mutex gPreloadLock;
+static std::condition_variable gPreloadDone;
+static std::unordered_map<std::string, PreloadEntry> gPreloads;
+
+// Completed entries the app never claimed are dropped once the table grows
+// past this, so a misbehaving caller cannot pin parsed tables indefinitely.
+static constexpr size_t kMaxPreloadEntries = 32;
+
+// Removes and returns the preloaded ApkAssets for `path`, waiting for an
+// in-flight parse to finish. Returns null if no matching preload exists, the
+// preload failed, or the APK changed on disk after it was parsed.
+static std::unique_ptr<const ApkAssets> ClaimPreload(const std::string& path,
+                                                     const format_type_t format,
+                                                     const jint property_flags) {
+  std::unique_lock<std::mutex> lock(gPreloadLock);
+  auto it = gPreloads.find(path);
+  if (it == gPreloads.end() || it->second.format != format ||
+      it->second.property_flags != property_flags) {
+    return nullptr;
+  }
+
+  // A concurrent claimant may erase the entry while this thread waits, so
+  // look it up again once the parse has finished.
+  gPreloadDone.wait(lock, [&path] {
+    auto cur = gPreloads.find(path);
+    return cur == gPreloads.end() || cur->second.done;
+  });
+  it = gPreloads.find(path);
+  if (it == gPreloads.end() || it->second.format != format ||
+      it->second.property_flags != property_flags) {
+    return nullptr;
+  }
+
+  std::unique_ptr<const ApkAssets> apk_assets = std::move(it->second.apk_assets);
+  gPreloads.erase(it);
+  if (apk_assets != nullptr && !apk_assets->IsUpToDate()) {
+    return nullptr;
+  }
+  return apk_assets;
+}
+
+static void NativePreload(JNIEnv* env, jclass /*clazz*/, jobjectArray java_paths,
+                          jintArray java_formats, const jint property_flags) {
+  ATRACE_NAME("PreloadApkAssets");
+
+  const jsize count = env->GetArrayLength(java_paths);
+  if (java_formats == nullptr || env->GetArrayLength(java_formats) != count) {
+    jniThrowException(env, "java/lang/IllegalArgumentException",
+                      "paths and formats must have the same length");
+    return;
+  }
+
+  std::vector<ApkAssets::LoadParams> candidates;
+  candidates.reserve(count);
+  for (jsize i = 0; i < count; i++) {
+    jstring java_path = (jstring)env->GetObjectArrayElement(java_paths, i);
+    {
+      ScopedUtfChars path(env, java_path);
+      if (path.c_str() == nullptr) {
+        return;
+      }
+
+      jint format;
+      env->GetIntArrayRegion(java_formats, i, 1, &format);
+      if (format != FORMAT_APK && format != FORMAT_IDMAP) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                          base::StringPrintf("Unsupported format type %d", format).c_str());
+        return;
+      }
+
+      candidates.push_back(ApkAssets::LoadParams{
+          path.c_str(), static_cast<package_property_t>(property_flags),
+          format == FORMAT_IDMAP});
+    }
+    env->DeleteLocalRef(java_path);
+  }
+
+  std::vector<ApkAssets::LoadParams> requests;
+  requests.reserve(candidates.size());
+  {
+    std::lock_guard<std::mutex> lock(gPreloadLock);
+    if (gPreloads.size() >= kMaxPreloadEntries) {
+      for (auto it = gPreloads.begin(); it != gPreloads.end();) {
+        it = it->second.done ? gPreloads.erase(it) : ++it;
+      }
+    }
+
+    for (ApkAssets::LoadParams& candidate : candidates) {
+      // A path already pending or parked keeps its original entry.
+      if (gPreloads.find(candidate.path) != gPreloads.end()) {
+        continue;
+      }
+      gPreloads[candidate.path] =
+          PreloadEntry{candidate.overlay ? FORMAT_IDMAP : FORMAT_APK, property_flags};
+      requests.push_back(std::move(candidate));
+    }
+  }
+
+  if (requests.empty()) {
+    return;
+  }
+
+  std::thread([requests = std::move(requests)]() {
+    std::vector<std::unique_ptr<const ApkAssets>> results = ApkAssets::LoadMany(requests);
+    std::lock_guard<std::mutex> lock(gPreloadLock);
+    for (size_t i = 0; i < requests.size(); i++) {
+      auto it = gPreloads.find(requests[i].path);
+      if (it != gPreloads.end() && !it->second.done) {
+        it->second.apk_assets = std::move(results[i]);
+        it->second.done = true;
+      }
+    }
+    gPreloadDone.notify_all();
+  }).detach();
+}
+
 static jlong NativeLoad(JNIEnv* env, jclass /*clazz*/, const format_type_t format,
                         jstring java_path, const jint property_flags, jobject assets_provider) {
   ScopedUtfChars path(env, java_path);
@@ -166,6 +304,15 @@ static jlong NativeLoad(JNIEnv* env, jclass /*clazz*/, const format_type_t forma
 
   ATRACE_NAME(base::StringPrintf("LoadApkAssets(%s)", path.c_str()).c_str());
 
+  // Preloads never carry an assets provider, so loads with one cannot claim.
+  if (assets_provider == nullptr && (format == FORMAT_APK || format == FORMAT_IDMAP)) {
+    std::unique_ptr<const ApkAssets> preloaded =
+        ClaimPreload(path.c_str(), format, property_flags);
+    if (preloaded != nullptr) {
+      return reinterpret_cast<jlong>(preloaded.release());
+    }
+  }
+
   auto loader_assets = LoaderAssetsProvider::Create(env, assets_provider);
   std::unique_ptr<const ApkAssets> apk_assets;
   switch (format) {
@@ -414,6 +561,7 @@ static jboolean NativeDefinesOverlayable(JNIEnv* env, jclass /*clazz*/, jlong pt
 static const JNINativeMethod gApkAssetsMethods[] = {
     {"nativeLoad", "(ILjava/lang/String;ILandroid/content/res/loader/AssetsProvider;)J",
      (void*)NativeLoad},
+    {"nativePreload", "([Ljava/lang/String;[II)V", (void*)NativePreload},
     {"nativeLoadEmpty", "(ILandroid/content/res/loader/AssetsProvider;)J", (void*)NativeLoadEmpty},
     {"nativeLoadFd",
      "(ILjava/io/FileDescriptor;Ljava/lang/String;ILandroid/content/res/loader/AssetsProvider;)J",
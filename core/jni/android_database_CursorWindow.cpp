@@ -179,6 +179,34 @@ static void nativeFreeLastRow(JNIEnv* env, jclass clazz, jlong windowPtr) {
     window->freeLastRow();
 }
 
+/**
+ * Returns the window's contents as a direct ByteBuffer, so the managed side can
+ * decode field slots and string payloads in place instead of making one JNI call
+ * per cell. The buffer is only valid while the window is alive and must be
+ * treated as read-only.
+ */
+static jobject nativeGetDirectBuffer(JNIEnv* env, jclass clazz, jlong windowPtr) {
+    CursorWindow* window = reinterpret_cast<CursorWindow*>(windowPtr);
+    return env->NewDirectByteBuffer(window->data(), window->size());
+}
+
+/**
+ * Returns the byte offset of the field-slot directory for the given row within
+ * the buffer returned by nativeGetDirectBuffer, or -1 if the row is not in the
+ * window. The directory is getNumColumns() packed 12-byte field slots: an
+ * int32 type tag followed by an 8-byte value (long, double, or a uint32
+ * offset/size pair locating string and blob payloads in the same buffer).
+ */
+static jint nativeGetRowSlotOffset(JNIEnv* env, jclass clazz, jlong windowPtr, jint row) {
+    CursorWindow* window = reinterpret_cast<CursorWindow*>(windowPtr);
+    CursorWindow::FieldSlot* fieldSlot = window->getFieldSlot(row, 0);
+    if (!fieldSlot) {
+        return -1;
+    }
+    return static_cast<jint>(reinterpret_cast<uint8_t*>(fieldSlot)
+            - static_cast<uint8_t*>(window->data()));
+}
+
 static jint nativeGetType(JNIEnv* env, jclass clazz, jlong windowPtr,
         jint row, jint column) {
     CursorWindow* window = reinterpret_cast<CursorWindow*>(windowPtr);
@@ -526,6 +554,8 @@ static const JNINativeMethod sMethods[] =
 
     { "nativeGetName", "(J)Ljava/lang/String;",
             (void*)nativeGetName },
+    { "nativeGetDirectBuffer", "(J)Ljava/nio/ByteBuffer;",
+            (void*)nativeGetDirectBuffer },
     { "nativeGetBlob", "(JII)[B",
             (void*)nativeGetBlob },
     { "nativeGetString", "(JII)Ljava/lang/String;",
@@ -550,6 +580,8 @@ static const JNINativeMethod sMethods[] =
             (void*)nativeFreeLastRow },
     { "nativeGetType", "(JII)I",
             (void*)nativeGetType },
+    { "nativeGetRowSlotOffset", "(JI)I",
+            (void*)nativeGetRowSlotOffset },
     { "nativeGetLong", "(JII)J",
             (void*)nativeGetLong },
     { "nativeGetDouble", "(JII)D",
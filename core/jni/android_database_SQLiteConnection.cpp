@@ -556,6 +556,135 @@ static jlong nativeExecuteForLastInsertedRowId(JNIEnv* env, jclass clazz,
             ? sqlite3_last_insert_rowid(connection->db) : -1;
 }
 
+/*
+ * Value type tags in the flat batch parameter buffer consumed by
+ * nativeExecuteBatch.  Must be kept in sync with the managed batch writer.
+ */
+enum {
+    BATCH_VALUE_NULL = 0,
+    BATCH_VALUE_LONG = 1,    // followed by 8 bytes, little-endian
+    BATCH_VALUE_DOUBLE = 2,  // followed by 8 bytes, little-endian
+    BATCH_VALUE_STRING = 3,  // followed by 4-byte length, then UTF-8 bytes
+    BATCH_VALUE_BLOB = 4,    // followed by 4-byte length, then raw bytes
+};
+
+/*
+ * Binds and steps the statement once per row of parameters packed in the
+ * flat buffer, so a bulk insert pays one JNI transition for the whole batch
+ * instead of one per bind and one per step.  Each row holds one tagged value
+ * per statement parameter.  Returns the total number of rows changed.
+ */
+static jint nativeExecuteBatch(JNIEnv* env, jclass clazz, jlong connectionPtr,
+        jlong statementPtr, jbyteArray dataArray, jint rowCount) {
+    SQLiteConnection* connection = reinterpret_cast<SQLiteConnection*>(connectionPtr);
+    sqlite3_stmt* statement = reinterpret_cast<sqlite3_stmt*>(statementPtr);
+
+    const int parameterCount = sqlite3_bind_parameter_count(statement);
+    jsize dataLength = env->GetArrayLength(dataArray);
+    jbyte* data = env->GetByteArrayElements(dataArray, NULL);
+    if (data == NULL) {
+        return -1;
+    }
+
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    const uint8_t* end = p + dataLength;
+    int totalChanges = 0;
+    int err = SQLITE_OK;
+    bool malformed = false;
+
+    for (jint row = 0; row < rowCount && err == SQLITE_OK && !malformed; row++) {
+        for (int index = 1; index <= parameterCount; index++) {
+            if (p >= end) {
+                malformed = true;
+                break;
+            }
+            uint8_t type = *p++;
+            uint32_t length;
+            switch (type) {
+                case BATCH_VALUE_NULL:
+                    err = sqlite3_bind_null(statement, index);
+                    break;
+                case BATCH_VALUE_LONG: {
+                    int64_t value;
+                    if (end - p < 8) {
+                        malformed = true;
+                        break;
+                    }
+                    memcpy(&value, p, 8);
+                    p += 8;
+                    err = sqlite3_bind_int64(statement, index, value);
+                    break;
+                }
+                case BATCH_VALUE_DOUBLE: {
+                    double value;
+                    if (end - p < 8) {
+                        malformed = true;
+                        break;
+                    }
+                    memcpy(&value, p, 8);
+                    p += 8;
+                    err = sqlite3_bind_double(statement, index, value);
+                    break;
+                }
+                case BATCH_VALUE_STRING:
+                case BATCH_VALUE_BLOB:
+                    if (end - p < 4) {
+                        malformed = true;
+                        break;
+                    }
+                    memcpy(&length, p, 4);
+                    p += 4;
+                    if (static_cast<uint32_t>(end - p) < length) {
+                        malformed = true;
+                        break;
+                    }
+                    if (type == BATCH_VALUE_STRING) {
+                        err = sqlite3_bind_text(statement, index,
+                                reinterpret_cast<const char*>(p), length, SQLITE_TRANSIENT);
+                    } else {
+                        err = sqlite3_bind_blob(statement, index, p, length, SQLITE_TRANSIENT);
+                    }
+                    p += length;
+                    break;
+                default:
+                    malformed = true;
+                    break;
+            }
+            if (err != SQLITE_OK) {
+                break;
+            }
+        }
+        if (malformed || err != SQLITE_OK) {
+            break;
+        }
+
+        err = sqlite3_step(statement);
+        if (err == SQLITE_DONE) {
+            totalChanges += sqlite3_changes(connection->db);
+            err = sqlite3_reset(statement);
+        }
+    }
+
+    env->ReleaseByteArrayElements(dataArray, data, JNI_ABORT);
+    sqlite3_reset(statement);
+
+    if (malformed) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                "Malformed batch parameter buffer");
+        return -1;
+    }
+    if (err == SQLITE_ROW) {
+        throw_sqlite3_exception(env,
+                "Queries can be performed using SQLiteDatabase query or rawQuery methods only.");
+        return -1;
+    }
+    if (err != SQLITE_OK && err != SQLITE_DONE) {
+        throw_sqlite3_exception(env, connection->db);
+        return -1;
+    }
+    return totalChanges;
+}
+
 static int executeOneRowQuery(JNIEnv* env, SQLiteConnection* connection, sqlite3_stmt* statement) {
     int err = sqlite3_step(statement);
     if (err != SQLITE_ROW) {
@@ -924,6 +1053,8 @@ static const JNINativeMethod sMethods[] =
             (void*)nativeExecuteForChangedRowCount },
     { "nativeExecuteForLastInsertedRowId", "(JJ)J",
             (void*)nativeExecuteForLastInsertedRowId },
+    { "nativeExecuteBatch", "(JJ[BI)I",
+            (void*)nativeExecuteBatch },
     { "nativeExecuteForCursorWindow", "(JJJIIZ)J",
             (void*)nativeExecuteForCursorWindow },
     { "nativeGetDbLookaside", "(J)I",
@@ -33,6 +33,9 @@
 #include <utils/Looper.h>
 #include <utils/Vector.h>
 
+#include <stdint.h>
+#include <string.h>
+
 #include <map>
 
 namespace {
@@ -42,6 +45,7 @@ using namespace android;
 struct {
     jclass clazz;
     jmethodID dispatchSensorEvent;
+    jmethodID dispatchSensorEventBatch;
     jmethodID dispatchFlushCompleteEvent;
     jmethodID dispatchAdditionalInfoEvent;
 } gBaseEventQueueClassInfo;
@@ -291,11 +295,27 @@ static jint nativeSetOperationParameter(JNIEnv *_env, jclass _this, jlong sensor
 //----------------------------------------------------------------------------
 
 class Receiver : public LooperCallback {
+    enum {
+        BATCH_CAPACITY = 16,    // Matches the event read chunk size below.
+        BATCH_HEADER_INTS = 2,  // Per event: sensor handle, accuracy status.
+        BATCH_DATA_FLOATS = 16, // Per event: the full data payload.
+    };
     sp<SensorEventQueue> mSensorQueue;
     sp<MessageQueue> mMessageQueue;
     jobject mReceiverWeakGlobal;
     jfloatArray mFloatScratch;
     jintArray   mIntScratch;
+    jintArray   mBatchHeaderScratch;
+    jfloatArray mBatchDataScratch;
+    jintArray   mBatchDeltaScratch;
+    // Staging area for batched data events; timestamps are delta-compressed against the
+    // previous event in the batch, so only the first timestamp crosses JNI as a jlong.
+    int32_t mBatchHeader[BATCH_CAPACITY * BATCH_HEADER_INTS];
+    float mBatchData[BATCH_CAPACITY * BATCH_DATA_FLOATS];
+    int32_t mBatchDeltas[BATCH_CAPACITY];
+    int64_t mBatchBaseTimestamp;
+    int64_t mBatchLastTimestamp;
+    size_t mBatchCount;
 public:
     Receiver(const sp<SensorEventQueue>& sensorQueue,
             const sp<MessageQueue>& messageQueue,
@@ -307,12 +327,23 @@ public:
 
         mIntScratch = (jintArray) env->NewGlobalRef(env->NewIntArray(16));
         mFloatScratch = (jfloatArray) env->NewGlobalRef(env->NewFloatArray(16));
+        mBatchHeaderScratch = (jintArray) env->NewGlobalRef(
+                env->NewIntArray(BATCH_CAPACITY * BATCH_HEADER_INTS));
+        mBatchDataScratch = (jfloatArray) env->NewGlobalRef(
+                env->NewFloatArray(BATCH_CAPACITY * BATCH_DATA_FLOATS));
+        mBatchDeltaScratch = (jintArray) env->NewGlobalRef(env->NewIntArray(BATCH_CAPACITY));
+        mBatchBaseTimestamp = 0;
+        mBatchLastTimestamp = 0;
+        mBatchCount = 0;
     }
     ~Receiver() {
         JNIEnv* env = AndroidRuntime::getJNIEnv();
         env->DeleteGlobalRef(mReceiverWeakGlobal);
         env->DeleteGlobalRef(mFloatScratch);
         env->DeleteGlobalRef(mIntScratch);
+        env->DeleteGlobalRef(mBatchHeaderScratch);
+        env->DeleteGlobalRef(mBatchDataScratch);
+        env->DeleteGlobalRef(mBatchDeltaScratch);
     }
     sp<SensorEventQueue> getSensorEventQueue() const {
         return mSensorQueue;
@@ -329,6 +360,29 @@ private:
                 ALOOPER_EVENT_INPUT, this, mSensorQueue.get());
     }
 
+    // Delivers all accumulated data events to the Java queue in a single upcall. Leaves any
+    // exception raised by the upcall pending for the caller to handle.
+    void flushBatch(JNIEnv* env, jobject receiverObj) {
+        if (mBatchCount == 0) {
+            return;
+        }
+        if (receiverObj != nullptr) {
+            env->SetIntArrayRegion(mBatchHeaderScratch, 0, mBatchCount * BATCH_HEADER_INTS,
+                                   mBatchHeader);
+            env->SetFloatArrayRegion(mBatchDataScratch, 0, mBatchCount * BATCH_DATA_FLOATS,
+                                     mBatchData);
+            env->SetIntArrayRegion(mBatchDeltaScratch, 0, mBatchCount, mBatchDeltas);
+            env->CallVoidMethod(receiverObj,
+                                gBaseEventQueueClassInfo.dispatchSensorEventBatch,
+                                static_cast<jint>(mBatchCount),
+                                mBatchHeaderScratch,
+                                mBatchDataScratch,
+                                static_cast<jlong>(mBatchBaseTimestamp),
+                                mBatchDeltaScratch);
+        }
+        mBatchCount = 0;
+    }
+
     virtual int handleEvent(int fd, int events, void* data) {
         JNIEnv* env = AndroidRuntime::getJNIEnv();
         sp<SensorEventQueue> q = reinterpret_cast<SensorEventQueue *>(data);
@@ -338,36 +392,24 @@ private:
         ASensorEvent buffer[16];
         while ((n = q->read(buffer, 16)) > 0) {
             for (int i=0 ; i<n ; i++) {
-                if (buffer[i].type == SENSOR_TYPE_STEP_COUNTER) {
-                    // step-counter returns a uint64, but the java API only deals with floats
-                    float value = float(buffer[i].u64.step_counter);
-                    env->SetFloatArrayRegion(mFloatScratch, 0, 1, &value);
-                } else if (buffer[i].type == SENSOR_TYPE_DYNAMIC_SENSOR_META) {
-                    float value[2];
-                    value[0] = buffer[i].dynamic_sensor_meta.connected ? 1.f: 0.f;
-                    value[1] = float(buffer[i].dynamic_sensor_meta.handle);
-                    env->SetFloatArrayRegion(mFloatScratch, 0, 2, value);
-                } else if (buffer[i].type == SENSOR_TYPE_ADDITIONAL_INFO) {
-                    env->SetIntArrayRegion(mIntScratch, 0, 14,
-                                           buffer[i].additional_info.data_int32);
-                    env->SetFloatArrayRegion(mFloatScratch, 0, 14,
-                                             buffer[i].additional_info.data_float);
-                } else {
-                    env->SetFloatArrayRegion(mFloatScratch, 0, 16, buffer[i].data);
-                }
-
                 if (buffer[i].type == SENSOR_TYPE_META_DATA) {
-                    // This is a flush complete sensor event. Call dispatchFlushCompleteEvent
-                    // method.
-                    if (receiverObj.get()) {
+                    // This is a flush complete sensor event. Deliver any batched data events
+                    // first to preserve ordering, then call dispatchFlushCompleteEvent method.
+                    flushBatch(env, receiverObj.get());
+                    if (receiverObj.get() && !env->ExceptionCheck()) {
                         env->CallVoidMethod(receiverObj.get(),
                                             gBaseEventQueueClassInfo.dispatchFlushCompleteEvent,
                                             buffer[i].meta_data.sensor);
                     }
                 } else if (buffer[i].type == SENSOR_TYPE_ADDITIONAL_INFO) {
-                    // This is a flush complete sensor event. Call dispatchAdditionalInfoEvent
-                    // method.
-                    if (receiverObj.get()) {
+                    // This is an additional info sensor event. Deliver any batched data events
+                    // first to preserve ordering, then call dispatchAdditionalInfoEvent method.
+                    flushBatch(env, receiverObj.get());
+                    if (receiverObj.get() && !env->ExceptionCheck()) {
+                        env->SetIntArrayRegion(mIntScratch, 0, 14,
+                                               buffer[i].additional_info.data_int32);
+                        env->SetFloatArrayRegion(mFloatScratch, 0, 14,
+                                                 buffer[i].additional_info.data_float);
                         int type = buffer[i].additional_info.type;
                         int serial = buffer[i].additional_info.serial;
                         env->CallVoidMethod(receiverObj.get(),
@@ -378,7 +420,7 @@ private:
                                             mIntScratch,
                                             buffer[i].timestamp);
                     }
-                }else {
+                } else {
                     int8_t status;
                     switch (buffer[i].type) {
                     case SENSOR_TYPE_ORIENTATION:
@@ -396,13 +438,45 @@ private:
                         status = SENSOR_STATUS_ACCURACY_HIGH;
                         break;
                     }
-                    if (receiverObj.get()) {
-                        env->CallVoidMethod(receiverObj.get(),
-                                            gBaseEventQueueClassInfo.dispatchSensorEvent,
-                                            buffer[i].sensor,
-                                            mFloatScratch,
-                                            status,
-                                            buffer[i].timestamp);
+
+                    if (mBatchCount != 0) {
+                        // Timestamp deltas are 32-bit; start a new batch on the rare jump
+                        // that does not fit.
+                        int64_t delta = buffer[i].timestamp - mBatchLastTimestamp;
+                        if (delta > INT32_MAX || delta < INT32_MIN) {
+                            flushBatch(env, receiverObj.get());
+                        }
+                    }
+                    if (env->ExceptionCheck()) {
+                        mSensorQueue->sendAck(buffer, n);
+                        ALOGE("Exception dispatching input event.");
+                        return 1;
+                    }
+
+                    if (mBatchCount == 0) {
+                        mBatchBaseTimestamp = buffer[i].timestamp;
+                        mBatchDeltas[0] = 0;
+                    } else {
+                        mBatchDeltas[mBatchCount] =
+                                static_cast<int32_t>(buffer[i].timestamp - mBatchLastTimestamp);
+                    }
+                    mBatchLastTimestamp = buffer[i].timestamp;
+
+                    float* slot = &mBatchData[mBatchCount * BATCH_DATA_FLOATS];
+                    memcpy(slot, buffer[i].data, sizeof(float) * BATCH_DATA_FLOATS);
+                    if (buffer[i].type == SENSOR_TYPE_STEP_COUNTER) {
+                        // step-counter returns a uint64, but the java API only deals with floats
+                        slot[0] = float(buffer[i].u64.step_counter);
+                    } else if (buffer[i].type == SENSOR_TYPE_DYNAMIC_SENSOR_META) {
+                        slot[0] = buffer[i].dynamic_sensor_meta.connected ? 1.f: 0.f;
+                        slot[1] = float(buffer[i].dynamic_sensor_meta.handle);
+                    }
+                    mBatchHeader[mBatchCount * BATCH_HEADER_INTS] = buffer[i].sensor;
+                    mBatchHeader[mBatchCount * BATCH_HEADER_INTS + 1] = status;
+                    mBatchCount++;
+
+                    if (mBatchCount == BATCH_CAPACITY) {
+                        flushBatch(env, receiverObj.get());
                     }
                 }
                 if (env->ExceptionCheck()) {
@@ -411,6 +485,12 @@ private:
                     return 1;
                 }
             }
+            flushBatch(env, receiverObj.get());
+            if (env->ExceptionCheck()) {
+                mSensorQueue->sendAck(buffer, n);
+                ALOGE("Exception dispatching input event.");
+                return 1;
+            }
             mSensorQueue->sendAck(buffer, n);
         }
         if (n<0 && n != -EAGAIN) {
@@ -558,6 +638,9 @@ int register_android_hardware_SensorManager(JNIEnv *env)
     gBaseEventQueueClassInfo.dispatchSensorEvent = GetMethodIDOrDie(env,
             gBaseEventQueueClassInfo.clazz, "dispatchSensorEvent", "(I[FIJ)V");
 
+    gBaseEventQueueClassInfo.dispatchSensorEventBatch = GetMethodIDOrDie(env,
+            gBaseEventQueueClassInfo.clazz, "dispatchSensorEventBatch", "(I[I[FJ[I)V");
+
     gBaseEventQueueClassInfo.dispatchFlushCompleteEvent = GetMethodIDOrDie(env,
             gBaseEventQueueClassInfo.clazz, "dispatchFlushCompleteEvent", "(I)V");
 
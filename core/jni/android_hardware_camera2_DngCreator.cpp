@@ -322,7 +322,9 @@ public:
     status_t close();
 private:
     enum {
-        BYTE_ARRAY_LENGTH = 4096
+        // One JNI transition is made per BYTE_ARRAY_LENGTH bytes moved, so use large
+        // transfers to keep the JNI overhead negligible for full-resolution RAW images.
+        BYTE_ARRAY_LENGTH = 65536
     };
     jobject mOutputStream;
     JNIEnv* mEnv;
@@ -397,7 +399,7 @@ public:
     virtual ~JniInputStream();
 private:
     enum {
-        BYTE_ARRAY_LENGTH = 4096
+        BYTE_ARRAY_LENGTH = 65536
     };
     jobject mInStream;
     JNIEnv* mEnv;
@@ -484,7 +486,7 @@ public:
     virtual ~JniInputByteBuffer();
 private:
     enum {
-        BYTE_ARRAY_LENGTH = 4096
+        BYTE_ARRAY_LENGTH = 65536
     };
     jobject mInBuf;
     JNIEnv* mEnv;
@@ -556,6 +558,9 @@ public:
 
     virtual uint32_t getIfd() const;
 protected:
+    enum {
+        MAX_BLOCK_SIZE = 1 << 20, // Read pixel data in blocks of up to 1 MiB.
+    };
     uint32_t mIfd;
     Input* mInput;
     uint32_t mWidth;
@@ -588,6 +593,14 @@ status_t InputStripSource::writeToStream(Output& stream, uint32_t count) {
         return BAD_VALUE;
     }
 
+    if (mPixStride != mBytesPerSample * mSamplesPerPixel) {
+        jniThrowException(mEnv, "java/lang/IllegalStateException",
+                "Per-pixel strides are not supported for RAW16 -- pixels must be contiguous");
+        return BAD_VALUE;
+
+        // TODO: Add support for non-contiguous pixels if needed.
+    }
+
     // Skip offset
     while (offset > 0) {
         ssize_t skipped = mInput->skip(offset);
@@ -609,24 +622,33 @@ status_t InputStripSource::writeToStream(Output& stream, uint32_t count) {
         offset -= skipped;
     }
 
-    Vector<uint8_t> row;
-    if (row.resize(mRowStride) < 0) {
-        jniThrowException(mEnv, "java/lang/OutOfMemoryError", "Could not allocate row vector.");
+    // Copy the pixel data in multi-row blocks rather than row by row; every read from the
+    // input and write to the output crosses the JNI boundary, so per-row transfers dominate
+    // the copy cost for full-resolution RAW images.
+    uint32_t bytesPerRow = mBytesPerSample * mSamplesPerPixel * mWidth;
+    uint32_t rowsPerBlock = std::max(static_cast<uint32_t>(MAX_BLOCK_SIZE) / mRowStride, 1u);
+    rowsPerBlock = std::min(rowsPerBlock, mHeight);
+
+    Vector<uint8_t> block;
+    if (block.resize(rowsPerBlock * mRowStride) < 0) {
+        jniThrowException(mEnv, "java/lang/OutOfMemoryError", "Could not allocate block vector.");
         return BAD_VALUE;
     }
 
-    uint8_t* rowBytes = row.editArray();
+    uint8_t* blockBytes = block.editArray();
 
-    for (uint32_t i = 0; i < mHeight; ++i) {
-        size_t rowFillAmt = 0;
-        size_t rowSize = mRowStride;
+    for (uint32_t i = 0; i < mHeight; i += rowsPerBlock) {
+        uint32_t rows = std::min(rowsPerBlock, mHeight - i);
+        size_t blockFillAmt = 0;
+        size_t blockSize = rows * mRowStride;
 
-        while (rowFillAmt < mRowStride) {
-            ssize_t bytesRead = mInput->read(rowBytes, rowFillAmt, rowSize);
+        while (blockFillAmt < blockSize) {
+            ssize_t bytesRead = mInput->read(blockBytes, blockFillAmt, blockSize - blockFillAmt);
             if (bytesRead <= 0) {
                 if (bytesRead == NOT_ENOUGH_DATA || bytesRead == 0) {
                     ALOGE("%s: Early EOF on row %" PRIu32 ", received bytesRead %zd",
-                            __FUNCTION__, i, bytesRead);
+                            __FUNCTION__, i + static_cast<uint32_t>(blockFillAmt / mRowStride),
+                            bytesRead);
                     jniThrowExceptionFmt(mEnv, "java/io/IOException",
                             "Early EOF encountered, not enough pixel data for image of size %"
                             PRIu32, fullSize);
@@ -639,14 +661,13 @@ status_t InputStripSource::writeToStream(Output& stream, uint32_t count) {
                 }
                 return bytesRead;
             }
-            rowFillAmt += bytesRead;
-            rowSize -= bytesRead;
+            blockFillAmt += bytesRead;
         }
 
-        if (mPixStride == mBytesPerSample * mSamplesPerPixel) {
-            ALOGV("%s: Using stream per-row write for strip.", __FUNCTION__);
+        if (mRowStride == bytesPerRow) {
+            ALOGV("%s: Using stream block write for strip.", __FUNCTION__);
 
-            if (stream.write(rowBytes, 0, mBytesPerSample * mSamplesPerPixel * mWidth) != OK ||
+            if (stream.write(blockBytes, 0, rows * bytesPerRow) != OK ||
                     mEnv->ExceptionCheck()) {
                 if (!mEnv->ExceptionCheck()) {
                     jniThrowException(mEnv, "java/io/IOException", "Failed to write pixel data");
@@ -654,12 +675,19 @@ status_t InputStripSource::writeToStream(Output& stream, uint32_t count) {
                 return BAD_VALUE;
             }
         } else {
-            ALOGV("%s: Using stream per-pixel write for strip.", __FUNCTION__);
-            jniThrowException(mEnv, "java/lang/IllegalStateException",
-                    "Per-pixel strides are not supported for RAW16 -- pixels must be contiguous");
-            return BAD_VALUE;
+            // Strip the row padding while writing.
+            ALOGV("%s: Using stream per-row write for strip.", __FUNCTION__);
 
-            // TODO: Add support for non-contiguous pixels if needed.
+            for (uint32_t j = 0; j < rows; ++j) {
+                if (stream.write(blockBytes, j * mRowStride, bytesPerRow) != OK ||
+                        mEnv->ExceptionCheck()) {
+                    if (!mEnv->ExceptionCheck()) {
+                        jniThrowException(mEnv, "java/io/IOException",
+                                "Failed to write pixel data");
+                    }
+                    return BAD_VALUE;
+                }
+            }
         }
     }
     return OK;
@@ -20,6 +20,7 @@
 #define LOG_TAG "AudioSystem-JNI"
 #include <utils/Log.h>
 
+#include <atomic>
 #include <sstream>
 #include <vector>
 #include <jni.h>
@@ -167,10 +168,18 @@ static struct {
     jmethodID    postEventFromNative;
 } gAudioPortEventHandlerMethods;
 
-static struct {
-    jmethodID postDynPolicyEventFromNative;
-    jmethodID postRecordConfigEventFromNative;
-} gAudioPolicyEventHandlerMethods;
+// The audio policy callbacks below fire on audioserver binder threads, often
+// hundreds of times a second, so their ids are lazily cached with audit
+// counters instead of being re-looked-up per call.
+static CachedJniStaticMethod gErrorCallbackMethod(kClassPathName, "errorCallbackFromNative",
+                                                  "(I)V");
+static CachedJniStaticMethod gDynPolicyCallbackMethod(kClassPathName,
+                                                      "dynamicPolicyCallbackFromNative",
+                                                      "(ILjava/lang/String;I)V");
+static CachedJniStaticMethod gRecordingCallbackMethod(
+        kClassPathName, "recordingCallbackFromNative",
+        "(IIIIIIZ[I[Landroid/media/audiofx/AudioEffect$Descriptor;"
+        "[Landroid/media/audiofx/AudioEffect$Descriptor;I)V");
 
 //
 // JNI Initialization for OpenSLES routing
@@ -199,6 +208,26 @@ enum  {
 
 #define MAX_PORT_GENERATION_SYNC_ATTEMPTS 5
 
+// Keep list-update notifications at one in flight per event type. Device-switch
+// storms (e.g. a BT connect) fire dozens of port/patch callbacks back to back,
+// and each one used to cross into Java individually. Once a notification has
+// been posted, the refresh it triggers in listAudioPorts()/listAudioPatches()
+// queries audioserver's current state and therefore observes every change made
+// in the meantime, so further posts before that refresh carry no information.
+// The flags are re-armed at the start of the corresponding list query.
+static std::atomic<bool> gPortListRefreshPending(false);
+static std::atomic<bool> gPatchListRefreshPending(false);
+
+// Snapshot of the last port list handed to Java, keyed by the audioserver
+// generation that produced it. Listeners re-query the full list on every
+// event, and during a storm most of those queries see an unchanged list;
+// serving the cached objects skips the second binder round trip and the
+// per-port JNI object construction. Guarded by gPortCacheLock.
+static Mutex gPortCacheLock;
+static std::vector<jobject> gCachedPorts;  // global refs
+static unsigned int gCachedPortGeneration;
+static bool gCachedPortsValid = false;
+
 // ----------------------------------------------------------------------------
 // ref-counted object for audio port callbacks
 class JNIAudioPortCallback: public AudioSystem::AudioPortCallback
@@ -248,6 +277,15 @@ JNIAudioPortCallback::~JNIAudioPortCallback()
 
 void JNIAudioPortCallback::sendEvent(int event)
 {
+    if (event == AUDIOPORT_EVENT_PORT_LIST_UPDATED) {
+        if (gPortListRefreshPending.exchange(true)) {
+            return;
+        }
+    } else if (event == AUDIOPORT_EVENT_PATCH_LIST_UPDATED) {
+        if (gPatchListRefreshPending.exchange(true)) {
+            return;
+        }
+    }
     JNIEnv *env = AndroidRuntime::getJNIEnv();
     if (env == NULL) {
         return;
@@ -440,13 +478,8 @@ android_media_AudioSystem_error_callback(status_t err)
         return;
     }
 
-    jclass clazz = env->FindClass(kClassPathName);
-
-    env->CallStaticVoidMethod(clazz, env->GetStaticMethodID(clazz,
-                              "errorCallbackFromNative","(I)V"),
+    env->CallStaticVoidMethod(gErrorCallbackMethod.GetClass(env), gErrorCallbackMethod.Get(env),
                               check_AudioSystem_Command(err));
-
-    env->DeleteLocalRef(clazz);
 }
 
 static void
@@ -457,15 +490,13 @@ android_media_AudioSystem_dyn_policy_callback(int event, String8 regId, int val)
         return;
     }
 
-    jclass clazz = env->FindClass(kClassPathName);
     const char* zechars = regId.string();
     jstring zestring = env->NewStringUTF(zechars);
 
-    env->CallStaticVoidMethod(clazz, gAudioPolicyEventHandlerMethods.postDynPolicyEventFromNative,
-            event, zestring, val);
+    env->CallStaticVoidMethod(gDynPolicyCallbackMethod.GetClass(env),
+                              gDynPolicyCallbackMethod.Get(env), event, zestring, val);
 
     env->ReleaseStringUTFChars(zestring, zechars);
-    env->DeleteLocalRef(clazz);
 }
 
 static void
@@ -514,15 +545,11 @@ android_media_AudioSystem_recording_callback(int event,
     convertAudioEffectDescriptorVectorFromNative(env, &jEffects, effects);
 
     // callback into java
-    jclass clazz = env->FindClass(kClassPathName);
-
-    env->CallStaticVoidMethod(clazz,
-                              gAudioPolicyEventHandlerMethods.postRecordConfigEventFromNative,
-                              event, (jint) clientInfo->riid, (jint) clientInfo->uid,
-                              clientInfo->session, clientInfo->source, clientInfo->port_id,
-                              clientInfo->silenced, recParamArray, jClientEffects, jEffects,
-                              source);
-    env->DeleteLocalRef(clazz);
+    env->CallStaticVoidMethod(gRecordingCallbackMethod.GetClass(env),
+                              gRecordingCallbackMethod.Get(env), event, (jint)clientInfo->riid,
+                              (jint)clientInfo->uid, clientInfo->session, clientInfo->source,
+                              clientInfo->port_id, clientInfo->silenced, recParamArray,
+                              jClientEffects, jEffects, source);
     env->DeleteLocalRef(recParamArray);
     env->DeleteLocalRef(jClientEffects);
     env->DeleteLocalRef(jEffects);
@@ -1428,6 +1455,10 @@ android_media_AudioSystem_listAudioPorts(JNIEnv *env, jobject clazz,
         return (jint)AUDIO_JAVA_BAD_VALUE;
     }
 
+    // Re-arm coalescing: changes committed after this point must trigger a new
+    // notification, since this query may not observe them.
+    gPortListRefreshPending.store(false, std::memory_order_relaxed);
+
     status_t status;
     unsigned int generation1;
     unsigned int generation;
@@ -1436,6 +1467,7 @@ android_media_AudioSystem_listAudioPorts(JNIEnv *env, jobject clazz,
     struct audio_port *nPorts = NULL;
     int attempts = MAX_PORT_GENERATION_SYNC_ATTEMPTS;
     jint jStatus;
+    std::vector<jobject> jCachedPorts;
 
     // get the port count and all the ports until they both return the same generation
     do {
@@ -1458,6 +1490,21 @@ android_media_AudioSystem_listAudioPorts(JNIEnv *env, jobject clazz,
             jStatus = (jint)AUDIO_JAVA_SUCCESS;
             goto exit;
         }
+
+        // An unchanged generation means an unchanged list: serve the cached
+        // objects and skip the full query and the per-port conversion.
+        {
+            Mutex::Autolock l(gPortCacheLock);
+            if (gCachedPortsValid && gCachedPortGeneration == generation1 &&
+                    gCachedPorts.size() == (size_t)numPorts) {
+                for (jobject jAudioPort : gCachedPorts) {
+                    env->CallBooleanMethod(jPorts, gArrayListMethods.add, jAudioPort);
+                }
+                jStatus = (jint)AUDIO_JAVA_SUCCESS;
+                goto exit;
+            }
+        }
+
         nPorts = (struct audio_port *)realloc(nPorts, numPorts * sizeof(struct audio_port));
 
         status = AudioSystem::listAudioPorts(AUDIO_PORT_ROLE_NONE,
@@ -1482,11 +1529,25 @@ android_media_AudioSystem_listAudioPorts(JNIEnv *env, jobject clazz,
         }
         env->CallBooleanMethod(jPorts, gArrayListMethods.add, jAudioPort);
         if (jAudioPort != NULL) {
+            jCachedPorts.push_back(MakeGlobalRefOrDie(env, jAudioPort));
             env->DeleteLocalRef(jAudioPort);
         }
     }
 
+    // Publish the refreshed snapshot; the previous one is released below.
+    {
+        Mutex::Autolock l(gPortCacheLock);
+        gCachedPorts.swap(jCachedPorts);
+        gCachedPortGeneration = generation1;
+        gCachedPortsValid = (gCachedPorts.size() == (size_t)numPorts);
+    }
+
 exit:
+    // On success jCachedPorts holds the snapshot just replaced; on failure it
+    // holds the partially built one. Either way the references are dropped.
+    for (jobject jAudioPort : jCachedPorts) {
+        env->DeleteGlobalRef(jAudioPort);
+    }
     nGeneration = env->GetIntArrayElements(jGeneration, NULL);
     if (nGeneration == NULL) {
         jStatus = (jint)AUDIO_JAVA_ERROR;
@@ -1654,6 +1715,10 @@ android_media_AudioSystem_listAudioPatches(JNIEnv *env, jobject clazz,
         return (jint)AUDIO_JAVA_BAD_VALUE;
     }
 
+    // Re-arm coalescing: changes committed after this point must trigger a new
+    // notification, since this query may not observe them.
+    gPatchListRefreshPending.store(false, std::memory_order_relaxed);
+
     status_t status;
     unsigned int generation1;
     unsigned int generation;
@@ -2688,13 +2753,6 @@ int register_android_media_AudioSystem(JNIEnv *env)
     gEventHandlerFields.mJniCallback = GetFieldIDOrDie(env,
                                                     eventHandlerClass, "mJniCallback", "J");
 
-    gAudioPolicyEventHandlerMethods.postDynPolicyEventFromNative =
-            GetStaticMethodIDOrDie(env, env->FindClass(kClassPathName),
-                    "dynamicPolicyCallbackFromNative", "(ILjava/lang/String;I)V");
-    gAudioPolicyEventHandlerMethods.postRecordConfigEventFromNative =
-            GetStaticMethodIDOrDie(env, env->FindClass(kClassPathName),
-                    "recordingCallbackFromNative", "(IIIIIIZ[I[Landroid/media/audiofx/AudioEffect$Descriptor;[Landroid/media/audiofx/AudioEffect$Descriptor;I)V");
-
     jclass audioMixClass = FindClassOrDie(env, "android/media/audiopolicy/AudioMix");
     gAudioMixClass = MakeGlobalRefOrDie(env, audioMixClass);
     gAudioMixFields.mRule = GetFieldIDOrDie(env, audioMixClass, "mRule",
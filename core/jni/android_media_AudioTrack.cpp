@@ -84,6 +84,11 @@ public:
     sp<JNIDeviceCallback> mDeviceCallback;
     sp<JNIAudioTrackCallback> mAudioTrackCallback;
 
+    // In-flight region handed to Java by native_obtain_direct_region, consumed
+    // by native_release_direct_region. Only touched from the writer thread.
+    AudioTrack::Buffer mDirectBuffer;
+    bool mDirectBufferPending = false;
+
     bool allocSharedMem(int sizeInBytes) {
         mMemHeap = new MemoryHeapBase(sizeInBytes, 0, "AudioTrack Heap Base");
         if (mMemHeap->getHeapID() < 0) {
@@ -782,6 +787,83 @@ static jint android_media_AudioTrack_write_native_bytes(JNIEnv *env,  jobject th
     return written;
 }
 
+// ----------------------------------------------------------------------------
+// Zero-copy write path. Instead of copying every write() through a Java array,
+// a PCM writer can obtain a region of the track's own shared-memory ring as a
+// direct ByteBuffer, fill frames in place from Java, and publish the batch
+// with a single JNI call. obtainBuffer/releaseBuffer operate directly on the
+// track control block, so no staging copy remains on the publish side.
+static jobject android_media_AudioTrack_obtain_direct_region(JNIEnv *env, jobject thiz,
+                                                             jint sizeInFrames,
+                                                             jboolean isBlocking) {
+    sp<AudioTrack> lpTrack = getAudioTrack(env, thiz);
+    if (lpTrack == NULL) {
+        jniThrowException(env, "java/lang/IllegalStateException",
+                "Unable to retrieve AudioTrack pointer for obtainDirectRegion()");
+        return NULL;
+    }
+    if (!audio_is_linear_pcm(lpTrack->format())) {
+        jniThrowException(env, "java/lang/IllegalStateException",
+                "Direct regions require a linear PCM track");
+        return NULL;
+    }
+    AudioTrackJniStorage* pJniStorage = (AudioTrackJniStorage *)env->GetLongField(
+        thiz, javaAudioTrackFields.jniData);
+    if (pJniStorage == NULL || pJniStorage->mDirectBufferPending) {
+        jniThrowException(env, "java/lang/IllegalStateException",
+                "A direct region is already obtained and not yet released");
+        return NULL;
+    }
+
+    AudioTrack::Buffer buffer;
+    buffer.frameCount = sizeInFrames;
+    status_t status = lpTrack->obtainBuffer(&buffer, isBlocking == JNI_TRUE ? -1 : 0);
+    if (status == WOULD_BLOCK) {
+        // Ring is full; the Java layer surfaces this as an empty region.
+        return NULL;
+    }
+    if (status != NO_ERROR) {
+        ALOGE("Error %d obtaining a direct region", status);
+        return NULL;
+    }
+
+    pJniStorage->mDirectBuffer = buffer;
+    pJniStorage->mDirectBufferPending = true;
+    return env->NewDirectByteBuffer(buffer.raw, buffer.size);
+}
+
+static jint android_media_AudioTrack_release_direct_region(JNIEnv *env, jobject thiz,
+                                                           jint framesWritten) {
+    sp<AudioTrack> lpTrack = getAudioTrack(env, thiz);
+    if (lpTrack == NULL) {
+        jniThrowException(env, "java/lang/IllegalStateException",
+                "Unable to retrieve AudioTrack pointer for releaseDirectRegion()");
+        return (jint)AUDIO_JAVA_INVALID_OPERATION;
+    }
+    AudioTrackJniStorage* pJniStorage = (AudioTrackJniStorage *)env->GetLongField(
+        thiz, javaAudioTrackFields.jniData);
+    if (pJniStorage == NULL || !pJniStorage->mDirectBufferPending) {
+        jniThrowException(env, "java/lang/IllegalStateException",
+                "No direct region is pending release");
+        return (jint)AUDIO_JAVA_INVALID_OPERATION;
+    }
+
+    AudioTrack::Buffer& buffer = pJniStorage->mDirectBuffer;
+    if (framesWritten < 0 || (size_t)framesWritten > buffer.frameCount) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                "framesWritten exceeds the obtained region");
+        return (jint)AUDIO_JAVA_BAD_VALUE;
+    }
+
+    // Publishing fewer frames than obtained is allowed; releaseBuffer consumes
+    // buffer.size bytes.
+    buffer.size = framesWritten * lpTrack->frameSize();
+    buffer.frameCount = framesWritten;
+    lpTrack->releaseBuffer(&buffer);
+    pJniStorage->mDirectBufferPending = false;
+    return framesWritten;
+}
+
 // ----------------------------------------------------------------------------
 static jint android_media_AudioTrack_get_buffer_size_frames(JNIEnv *env,  jobject thiz) {
     sp<AudioTrack> lpTrack = getAudioTrack(env, thiz);
@@ -1443,6 +1525,10 @@ static const JNINativeMethod gMethods[] = {
          (void *)android_media_AudioTrack_writeArray<jshortArray>},
         {"native_write_float", "([FIIIZ)I",
          (void *)android_media_AudioTrack_writeArray<jfloatArray>},
+        {"native_obtain_direct_region", "(IZ)Ljava/nio/ByteBuffer;",
+         (void *)android_media_AudioTrack_obtain_direct_region},
+        {"native_release_direct_region", "(I)I",
+         (void *)android_media_AudioTrack_release_direct_region},
         {"native_setVolume", "(FF)V", (void *)android_media_AudioTrack_set_volume},
         {"native_get_buffer_size_frames", "()I",
          (void *)android_media_AudioTrack_get_buffer_size_frames},
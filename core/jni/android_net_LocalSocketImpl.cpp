@@ -32,6 +32,9 @@
 #include <errno.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
+
+#include <vector>
 
 #include <android-base/cmsg.h>
 #include <android-base/macros.h>
@@ -120,30 +123,14 @@ socket_bind_local (JNIEnv *env, jobject object, jobject fileDescriptor,
 }
 
 /**
- * Reads data from a socket into buf, processing any ancillary data
- * and adding it to thisJ.
+ * Stores received ancillary file descriptors in thisJ's
+ * inboundFileDescriptors field.
  *
- * Returns the length of normal data read, or -1 if an exception has
- * been thrown in this function.
+ * Returns 0 on success or -1 if an exception has been thrown.
  */
-static ssize_t socket_read_all(JNIEnv *env, jobject thisJ, int fd,
-        void *buffer, size_t len)
+static int socket_publish_inbound_fds(JNIEnv *env, jobject thisJ,
+        std::vector<android::base::unique_fd>& received_fds)
 {
-    ssize_t ret;
-    std::vector<android::base::unique_fd> received_fds;
-
-    ret = ReceiveFileDescriptorVector(fd, buffer, len, 64, &received_fds);
-
-    if (ret < 0) {
-        if (errno == EPIPE) {
-            // Treat this as an end of stream
-            return 0;
-        }
-
-        jniThrowIOException(env, errno);
-        return -1;
-    }
-
     if (received_fds.size() > 0) {
         jobjectArray fdArray = env->NewObjectArray(received_fds.size(), class_FileDescriptor, NULL);
 
@@ -174,6 +161,38 @@ static ssize_t socket_read_all(JNIEnv *env, jobject thisJ, int fd,
         env->SetObjectField(thisJ, field_inboundFileDescriptors, fdArray);
     }
 
+    return 0;
+}
+
+/**
+ * Reads data from a socket into buf, processing any ancillary data
+ * and adding it to thisJ.
+ *
+ * Returns the length of normal data read, or -1 if an exception has
+ * been thrown in this function.
+ */
+static ssize_t socket_read_all(JNIEnv *env, jobject thisJ, int fd,
+        void *buffer, size_t len)
+{
+    ssize_t ret;
+    std::vector<android::base::unique_fd> received_fds;
+
+    ret = ReceiveFileDescriptorVector(fd, buffer, len, 64, &received_fds);
+
+    if (ret < 0) {
+        if (errno == EPIPE) {
+            // Treat this as an end of stream
+            return 0;
+        }
+
+        jniThrowIOException(env, errno);
+        return -1;
+    }
+
+    if (socket_publish_inbound_fds(env, thisJ, received_fds) < 0) {
+        return -1;
+    }
+
     return ret;
 }
 
@@ -314,6 +333,151 @@ static jint socket_readba (JNIEnv *env, jobject object,
     return (jint) ((ret == 0) ? -1 : ret);
 }
 
+/**
+ * Reads into a caller-pooled direct ByteBuffer, avoiding the per-read
+ * array pin and copy of readba_native. Ancillary file descriptors are
+ * processed the same way as the array path.
+ */
+static jint socket_read_direct (JNIEnv *env, jobject object,
+        jobject buffer, jint pos, jint len, jobject fileDescriptor)
+{
+    if (fileDescriptor == NULL || buffer == NULL) {
+        jniThrowNullPointerException(env, NULL);
+        return (jint)-1;
+    }
+
+    unsigned char* base = (unsigned char*)env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (base == NULL || pos < 0 || len < 0 || (jlong)pos + len > capacity) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                "Buffer must be direct with a valid position and length");
+        return (jint)-1;
+    }
+
+    if (len == 0) {
+        // because socket_read_all returns 0 on EOF
+        return 0;
+    }
+
+    int fd = jniGetFDFromFileDescriptor(env, fileDescriptor);
+
+    if (env->ExceptionCheck()) {
+        return (jint)-1;
+    }
+
+    ssize_t ret = socket_read_all(env, object, fd, base + pos, len);
+
+    // A return of -1 above means an exception is pending
+
+    return (jint) ((ret == 0) ? -1 : ret);
+}
+
+/**
+ * Drains the socket into several pooled direct buffers with a single
+ * recvmsg, so one JNI call fills as many ring segments as the kernel
+ * has data for. Returns the total bytes read, or -1 on end of stream.
+ */
+static jint socket_readv_direct (JNIEnv *env, jobject object,
+        jobjectArray buffers, jintArray positions, jintArray lengths,
+        jobject fileDescriptor)
+{
+    if (fileDescriptor == NULL || buffers == NULL || positions == NULL || lengths == NULL) {
+        jniThrowNullPointerException(env, NULL);
+        return (jint)-1;
+    }
+
+    const jsize count = env->GetArrayLength(buffers);
+    if (count == 0 || env->GetArrayLength(positions) != count ||
+            env->GetArrayLength(lengths) != count) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                "Mismatched buffer and index array lengths");
+        return (jint)-1;
+    }
+
+    int fd = jniGetFDFromFileDescriptor(env, fileDescriptor);
+
+    if (env->ExceptionCheck()) {
+        return (jint)-1;
+    }
+
+    std::vector<struct iovec> iov(count);
+    {
+        jint* pos = env->GetIntArrayElements(positions, NULL);
+        jint* len = env->GetIntArrayElements(lengths, NULL);
+        if (pos == NULL || len == NULL) {
+            if (pos != NULL) env->ReleaseIntArrayElements(positions, pos, JNI_ABORT);
+            return (jint)-1;
+        }
+        int err = 0;
+        for (jsize i = 0; i < count; i++) {
+            jobject jBuffer = env->GetObjectArrayElement(buffers, i);
+            unsigned char* base = jBuffer == NULL
+                    ? NULL : (unsigned char*)env->GetDirectBufferAddress(jBuffer);
+            jlong capacity = jBuffer == NULL ? 0 : env->GetDirectBufferCapacity(jBuffer);
+            if (jBuffer != NULL) {
+                env->DeleteLocalRef(jBuffer);
+            }
+            if (base == NULL || pos[i] < 0 || len[i] < 0 ||
+                    (jlong)pos[i] + len[i] > capacity) {
+                err = -1;
+                break;
+            }
+            iov[i].iov_base = base + pos[i];
+            iov[i].iov_len = len[i];
+        }
+        env->ReleaseIntArrayElements(positions, pos, JNI_ABORT);
+        env->ReleaseIntArrayElements(lengths, len, JNI_ABORT);
+        if (err != 0) {
+            jniThrowException(env, "java/lang/IllegalArgumentException",
+                    "Buffers must be direct with valid positions and lengths");
+            return (jint)-1;
+        }
+    }
+
+    char cmsgbuf[CMSG_SPACE(64 * sizeof(int))];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = count;
+    msg.msg_control = cmsgbuf;
+    msg.msg_controllen = sizeof(cmsgbuf);
+
+    ssize_t ret = TEMP_FAILURE_RETRY(recvmsg(fd, &msg, MSG_CMSG_CLOEXEC));
+
+    if (ret < 0) {
+        if (errno == EPIPE) {
+            // Treat this as an end of stream
+            return (jint)-1;
+        }
+        jniThrowIOException(env, errno);
+        return (jint)-1;
+    }
+
+    std::vector<android::base::unique_fd> received_fds;
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+            cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        const int* cmsg_fds = (const int*)CMSG_DATA(cmsg);
+        size_t num_fds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < num_fds; i++) {
+            received_fds.emplace_back(cmsg_fds[i]);
+        }
+    }
+    if ((msg.msg_flags & MSG_CTRUNC) != 0) {
+        // The fds received so far are owned by received_fds and closed here.
+        jniThrowIOException(env, EMSGSIZE);
+        return (jint)-1;
+    }
+
+    if (socket_publish_inbound_fds(env, object, received_fds) < 0) {
+        return (jint)-1;
+    }
+
+    return (jint) ((ret == 0) ? -1 : ret);
+}
+
 static void socket_write (JNIEnv *env, jobject object,
         jint b, jobject fileDescriptor)
 {
@@ -421,6 +585,10 @@ static const JNINativeMethod gMethods[] = {
     {"bindLocal", "(Ljava/io/FileDescriptor;Ljava/lang/String;I)V", (void*)socket_bind_local},
     {"read_native", "(Ljava/io/FileDescriptor;)I", (void*) socket_read},
     {"readba_native", "([BIILjava/io/FileDescriptor;)I", (void*) socket_readba},
+    {"readDirect_native", "(Ljava/nio/ByteBuffer;IILjava/io/FileDescriptor;)I",
+                                                (void*) socket_read_direct},
+    {"readvDirect_native", "([Ljava/nio/ByteBuffer;[I[ILjava/io/FileDescriptor;)I",
+                                                (void*) socket_readv_direct},
     {"writeba_native", "([BIILjava/io/FileDescriptor;)V", (void*) socket_writeba},
     {"write_native", "(ILjava/io/FileDescriptor;)V", (void*) socket_write},
     {"getPeerCredentials_native",
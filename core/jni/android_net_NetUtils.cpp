@@ -199,8 +199,10 @@ static jobject android_net_utils_resNetworkResult(JNIEnv *env, jobject thiz, job
                 reinterpret_cast<jbyte*>(buf.data()));
     }
 
-    jclass class_DnsResponse = env->FindClass("android/net/DnsResolver$DnsResponse");
-    jmethodID ctor = env->GetMethodID(class_DnsResponse, "<init>", "([BI)V");
+    // Resolved once; DNS responses arrive far too often to re-run FindClass per result.
+    static jclass class_DnsResponse =
+            MakeGlobalRefOrDie(env, FindClassOrDie(env, "android/net/DnsResolver$DnsResponse"));
+    static jmethodID ctor = env->GetMethodID(class_DnsResponse, "<init>", "([BI)V");
 
     return env->NewObject(class_DnsResponse, ctor, answer, rcode);
 }
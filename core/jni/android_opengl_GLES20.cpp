@@ -6445,6 +6445,253 @@ android_glViewport__IIII
     );
 }
 
+/* Hand-written, not generated: batched command replay.
+ *
+ * Replays a packed command buffer of GL calls with a single JNI transition.
+ * The buffer is a direct ByteBuffer holding a stream of 32-bit words in
+ * native byte order: an opcode word followed by that opcode's fixed
+ * arguments, with any payload (uniform values, buffer data) inline and
+ * padded to a word boundary.  Apps that make thousands of small uniform and
+ * buffer updates per frame can pack them in Java and pay one transition
+ * instead of one per call.
+ */
+
+/* Opcode values.  Must be kept in sync with android.opengl.GLES20's batch
+ * command writer. */
+enum {
+    kBatchOpBindBuffer               = 1,   // target, buffer
+    kBatchOpUseProgram               = 2,   // program
+    kBatchOpEnable                   = 3,   // cap
+    kBatchOpDisable                  = 4,   // cap
+    kBatchOpActiveTexture            = 5,   // texture
+    kBatchOpBindTexture              = 6,   // target, texture
+    kBatchOpUniform1f                = 7,   // location, x
+    kBatchOpUniform2f                = 8,   // location, x, y
+    kBatchOpUniform3f                = 9,   // location, x, y, z
+    kBatchOpUniform4f                = 10,  // location, x, y, z, w
+    kBatchOpUniform1i                = 11,  // location, x
+    kBatchOpUniform2i                = 12,  // location, x, y
+    kBatchOpUniform3i                = 13,  // location, x, y, z
+    kBatchOpUniform4i                = 14,  // location, x, y, z, w
+    kBatchOpUniformMatrix2fv         = 15,  // location, count, transpose, floats[4*count]
+    kBatchOpUniformMatrix3fv         = 16,  // location, count, transpose, floats[9*count]
+    kBatchOpUniformMatrix4fv         = 17,  // location, count, transpose, floats[16*count]
+    kBatchOpUniform1fv               = 18,  // location, count, floats[count]
+    kBatchOpUniform2fv               = 19,  // location, count, floats[2*count]
+    kBatchOpUniform3fv               = 20,  // location, count, floats[3*count]
+    kBatchOpUniform4fv               = 21,  // location, count, floats[4*count]
+    kBatchOpBufferSubData            = 22,  // target, offset, size, bytes[size] (word padded)
+    kBatchOpDrawArrays               = 23,  // mode, first, count
+    kBatchOpDrawElements             = 24,  // mode, count, type, offset
+    kBatchOpVertexAttribPointer      = 25,  // indx, size, type, normalized, stride, offset
+    kBatchOpEnableVertexAttribArray  = 26,  // index
+    kBatchOpDisableVertexAttribArray = 27,  // index
+};
+
+/* void glBatchCommands ( java.nio.Buffer commands, int length ) */
+static void
+android_glBatchCommands__Ljava_nio_Buffer_2I
+  (JNIEnv *_env, jobject _this, jobject commands_buf, jint length) {
+    jint _position;
+    jint _limit;
+    jint _elementSizeShift;
+    jlong _pointer = jniGetNioBufferFields(_env, commands_buf, &_position, &_limit,
+            &_elementSizeShift);
+    if (_pointer == 0) {
+        jniThrowException(_env, "java/lang/IllegalArgumentException",
+                          "Must use a native order direct Buffer");
+        return;
+    }
+    /* length is caller-supplied; bound it by the buffer's remaining bytes the
+     * same way the generated wrappers bound counts by _remaining. */
+    jlong _remainingBytes = ((jlong) (_limit - _position)) << _elementSizeShift;
+    if (length < 0 || length > _remainingBytes) {
+        jniThrowException(_env, "java/lang/IllegalArgumentException",
+                "remaining() < needed");
+        return;
+    }
+    const GLuint* words = reinterpret_cast<const GLuint*>(
+            _pointer + (_position << _elementSizeShift));
+    GLsizei remaining = length / sizeof(GLuint);
+
+    while (remaining > 0) {
+        GLuint op = words[0];
+        GLsizei argWords;   // words consumed by this command, including the opcode
+        switch (op) {
+            case kBatchOpUseProgram:
+            case kBatchOpEnable:
+            case kBatchOpDisable:
+            case kBatchOpActiveTexture:
+            case kBatchOpEnableVertexAttribArray:
+            case kBatchOpDisableVertexAttribArray:
+                argWords = 2;
+                break;
+            case kBatchOpBindBuffer:
+            case kBatchOpBindTexture:
+            case kBatchOpUniform1f:
+            case kBatchOpUniform1i:
+            case kBatchOpUniform1fv:
+            case kBatchOpUniform2fv:
+            case kBatchOpUniform3fv:
+            case kBatchOpUniform4fv:
+                argWords = 3;
+                break;
+            case kBatchOpUniform2f:
+            case kBatchOpUniform2i:
+            case kBatchOpUniformMatrix2fv:
+            case kBatchOpUniformMatrix3fv:
+            case kBatchOpUniformMatrix4fv:
+            case kBatchOpBufferSubData:
+            case kBatchOpDrawArrays:
+                argWords = 4;
+                break;
+            case kBatchOpUniform3f:
+            case kBatchOpUniform3i:
+            case kBatchOpDrawElements:
+                argWords = 5;
+                break;
+            case kBatchOpUniform4f:
+            case kBatchOpUniform4i:
+                argWords = 6;
+                break;
+            case kBatchOpVertexAttribPointer:
+                argWords = 7;
+                break;
+            default:
+                jniThrowException(_env, "java/lang/IllegalArgumentException",
+                        "unknown batch opcode");
+                return;
+        }
+
+        if (remaining < argWords) {
+            jniThrowException(_env, "java/lang/IllegalArgumentException",
+                    "truncated batch command");
+            return;
+        }
+
+        /* Variable-length commands carry their payload after the fixed
+         * arguments; compute and validate the full length before touching
+         * any of it. The math is done in 64 bits so hostile counts cannot
+         * wrap past the check and reach the driver. */
+        int64_t payloadWords64 = 0;
+        switch (op) {
+            case kBatchOpUniformMatrix2fv: payloadWords64 = 4 * (int64_t)(GLint)words[2]; break;
+            case kBatchOpUniformMatrix3fv: payloadWords64 = 9 * (int64_t)(GLint)words[2]; break;
+            case kBatchOpUniformMatrix4fv: payloadWords64 = 16 * (int64_t)(GLint)words[2]; break;
+            case kBatchOpUniform1fv: payloadWords64 = 1 * (int64_t)(GLint)words[2]; break;
+            case kBatchOpUniform2fv: payloadWords64 = 2 * (int64_t)(GLint)words[2]; break;
+            case kBatchOpUniform3fv: payloadWords64 = 3 * (int64_t)(GLint)words[2]; break;
+            case kBatchOpUniform4fv: payloadWords64 = 4 * (int64_t)(GLint)words[2]; break;
+            case kBatchOpBufferSubData:
+                payloadWords64 = ((int64_t)(GLint)words[3] + 3) / 4;
+                break;
+            default: break;
+        }
+        if (payloadWords64 < 0 || payloadWords64 > (int64_t)(remaining - argWords)) {
+            jniThrowException(_env, "java/lang/IllegalArgumentException",
+                    "truncated batch command");
+            return;
+        }
+        GLsizei payloadWords = (GLsizei) payloadWords64;
+
+        const GLfloat* floatArgs = (const GLfloat*) &words[1];
+        const GLint* intArgs = (const GLint*) &words[1];
+        switch (op) {
+            case kBatchOpBindBuffer:
+                glBindBuffer((GLenum)words[1], (GLuint)words[2]);
+                break;
+            case kBatchOpUseProgram:
+                glUseProgram((GLuint)words[1]);
+                break;
+            case kBatchOpEnable:
+                glEnable((GLenum)words[1]);
+                break;
+            case kBatchOpDisable:
+                glDisable((GLenum)words[1]);
+                break;
+            case kBatchOpActiveTexture:
+                glActiveTexture((GLenum)words[1]);
+                break;
+            case kBatchOpBindTexture:
+                glBindTexture((GLenum)words[1], (GLuint)words[2]);
+                break;
+            case kBatchOpUniform1f:
+                glUniform1f(intArgs[0], floatArgs[1]);
+                break;
+            case kBatchOpUniform2f:
+                glUniform2f(intArgs[0], floatArgs[1], floatArgs[2]);
+                break;
+            case kBatchOpUniform3f:
+                glUniform3f(intArgs[0], floatArgs[1], floatArgs[2], floatArgs[3]);
+                break;
+            case kBatchOpUniform4f:
+                glUniform4f(intArgs[0], floatArgs[1], floatArgs[2], floatArgs[3], floatArgs[4]);
+                break;
+            case kBatchOpUniform1i:
+                glUniform1i(intArgs[0], intArgs[1]);
+                break;
+            case kBatchOpUniform2i:
+                glUniform2i(intArgs[0], intArgs[1], intArgs[2]);
+                break;
+            case kBatchOpUniform3i:
+                glUniform3i(intArgs[0], intArgs[1], intArgs[2], intArgs[3]);
+                break;
+            case kBatchOpUniform4i:
+                glUniform4i(intArgs[0], intArgs[1], intArgs[2], intArgs[3], intArgs[4]);
+                break;
+            case kBatchOpUniformMatrix2fv:
+                glUniformMatrix2fv(intArgs[0], (GLsizei)words[2], (GLboolean)words[3],
+                        (const GLfloat*) &words[4]);
+                break;
+            case kBatchOpUniformMatrix3fv:
+                glUniformMatrix3fv(intArgs[0], (GLsizei)words[2], (GLboolean)words[3],
+                        (const GLfloat*) &words[4]);
+                break;
+            case kBatchOpUniformMatrix4fv:
+                glUniformMatrix4fv(intArgs[0], (GLsizei)words[2], (GLboolean)words[3],
+                        (const GLfloat*) &words[4]);
+                break;
+            case kBatchOpUniform1fv:
+                glUniform1fv(intArgs[0], (GLsizei)words[2], (const GLfloat*) &words[3]);
+                break;
+            case kBatchOpUniform2fv:
+                glUniform2fv(intArgs[0], (GLsizei)words[2], (const GLfloat*) &words[3]);
+                break;
+            case kBatchOpUniform3fv:
+                glUniform3fv(intArgs[0], (GLsizei)words[2], (const GLfloat*) &words[3]);
+                break;
+            case kBatchOpUniform4fv:
+                glUniform4fv(intArgs[0], (GLsizei)words[2], (const GLfloat*) &words[3]);
+                break;
+            case kBatchOpBufferSubData:
+                glBufferSubData((GLenum)words[1], (GLintptr)(GLint)words[2],
+                        (GLsizeiptr)(GLint)words[3], (const GLvoid*) &words[4]);
+                break;
+            case kBatchOpDrawArrays:
+                glDrawArrays((GLenum)words[1], intArgs[1], (GLsizei)words[3]);
+                break;
+            case kBatchOpDrawElements:
+                glDrawElements((GLenum)words[1], (GLsizei)words[2], (GLenum)words[3],
+                        reinterpret_cast<GLvoid *>(words[4]));
+                break;
+            case kBatchOpVertexAttribPointer:
+                glVertexAttribPointer((GLuint)words[1], intArgs[1], (GLenum)words[3],
+                        (GLboolean)words[4], (GLsizei)words[5],
+                        reinterpret_cast<GLvoid *>(words[6]));
+                break;
+            case kBatchOpEnableVertexAttribArray:
+                glEnableVertexAttribArray((GLuint)words[1]);
+                break;
+            case kBatchOpDisableVertexAttribArray:
+                glDisableVertexAttribArray((GLuint)words[1]);
+                break;
+        }
+
+        words += argWords + payloadWords;
+        remaining -= argWords + payloadWords;
+    }
+}
+
 static const char *classPathName = "android/opengl/GLES20";
 
 static const JNINativeMethod methods[] = {
@@ -6642,6 +6889,7 @@ static const JNINativeMethod methods[] = {
 {"glVertexAttribPointer", "(IIIZII)V", (void *) android_glVertexAttribPointer__IIIZII },
 {"glVertexAttribPointerBounds", "(IIIZILjava/nio/Buffer;I)V", (void *) android_glVertexAttribPointerBounds__IIIZILjava_nio_Buffer_2I },
 {"glViewport", "(IIII)V", (void *) android_glViewport__IIII },
+{"glBatchCommands", "(Ljava/nio/Buffer;I)V", (void *) android_glBatchCommands__Ljava_nio_Buffer_2I },
 };
 
 int register_android_opengl_jni_GLES20(JNIEnv *_env)
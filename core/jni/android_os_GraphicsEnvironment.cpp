@@ -17,9 +17,19 @@
 #define LOG_TAG "GraphicsEnvironment"
 
 #include <graphicsenv/GraphicsEnv.h>
+#include <log/log.h>
 #include <nativehelper/ScopedUtfChars.h>
 #include <nativeloader/native_loader.h>
 #include "core_jni_helpers.h"
+#include "gpu_capability_snapshot.h"
+
+#include <android-base/unique_fd.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 namespace {
 
@@ -93,6 +103,48 @@ void hintActivityLaunch_native(JNIEnv* env, jobject clazz) {
     android::GraphicsEnv::getInstance().hintActivityLaunch();
 }
 
+// Maps the GPU capability snapshot written by GpuService (see
+// gpu_capability_snapshot.h) read-only and returns it as a direct ByteBuffer,
+// or null if the snapshot is missing or malformed. The mapping is kept for
+// the life of the process; it is a single page shared across all readers.
+jobject mapGpuCapabilities_native(JNIEnv* env, jobject clazz, jstring path) {
+    ScopedUtfChars pathChars(env, path);
+    if (pathChars.c_str() == nullptr) {
+        return nullptr;
+    }
+
+    android::base::unique_fd fd(open(pathChars.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd.get() < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd.get(), &st) != 0 ||
+        st.st_size < (off_t)sizeof(android::GpuCapabilitySnapshot)) {
+        return nullptr;
+    }
+
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd.get(), 0);
+    if (map == MAP_FAILED) {
+        ALOGE("Failed to map gpu capability snapshot: %s", strerror(errno));
+        return nullptr;
+    }
+
+    const auto* snapshot = static_cast<const android::GpuCapabilitySnapshot*>(map);
+    if (snapshot->magic != android::GPU_CAPS_MAGIC ||
+        snapshot->version != android::GPU_CAPS_VERSION ||
+        snapshot->totalSize != (uint32_t)st.st_size ||
+        snapshot->driverVersionNameOffset != sizeof(*snapshot) ||
+        snapshot->extensionsOffset !=
+                snapshot->driverVersionNameOffset + snapshot->driverVersionNameLength ||
+        snapshot->extensionsOffset + snapshot->extensionsLength != snapshot->totalSize) {
+        ALOGE("Rejecting malformed gpu capability snapshot %s", pathChars.c_str());
+        munmap(map, st.st_size);
+        return nullptr;
+    }
+
+    return env->NewDirectByteBuffer(map, st.st_size);
+}
+
 const JNINativeMethod g_methods[] = {
     { "isDebuggable", "()Z", reinterpret_cast<void*>(isDebuggable_native) },
     { "setDriverPathAndSphalLibraries", "(Ljava/lang/String;Ljava/lang/String;)V", reinterpret_cast<void*>(setDriverPathAndSphalLibraries_native) },
@@ -104,6 +156,7 @@ const JNINativeMethod g_methods[] = {
     { "setDebugLayers", "(Ljava/lang/String;)V", reinterpret_cast<void*>(setDebugLayers_native) },
     { "setDebugLayersGLES", "(Ljava/lang/String;)V", reinterpret_cast<void*>(setDebugLayersGLES_native) },
     { "hintActivityLaunch", "()V", reinterpret_cast<void*>(hintActivityLaunch_native) },
+    { "mapGpuCapabilities", "(Ljava/lang/String;)Ljava/nio/ByteBuffer;", reinterpret_cast<void*>(mapGpuCapabilities_native) },
 };
 
 const char* const kGraphicsEnvironmentName = "android/os/GraphicsEnvironment";
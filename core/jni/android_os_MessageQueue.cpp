@@ -23,6 +23,8 @@
 #include <utils/Log.h>
 #include "android_os_MessageQueue.h"
 
+#include <atomic>
+
 #include "core_jni_helpers.h"
 
 namespace android {
@@ -47,6 +49,7 @@ public:
 
     void pollOnce(JNIEnv* env, jobject obj, int timeoutMillis);
     void wake();
+    void getWakeupStats(uint64_t* outRequested, uint64_t* outWritten);
     void setFileDescriptorEvents(int fd, int events);
 
     virtual int handleEvent(int fd, int events, void* data);
@@ -55,6 +58,14 @@ private:
     JNIEnv* mPollEnv;
     jobject mPollObj;
     jthrowable mExceptionObj;
+
+    // Wakeup coalescing: producers increment mPendingWakeups and only the
+    // 0->1 transition writes the looper's eventfd; the poll thread drains
+    // the count in one exchange per poll.  The other counters feed the
+    // wakeup statistics reported to Java.
+    std::atomic<uint64_t> mPendingWakeups{0};
+    std::atomic<uint64_t> mWakeupsRequested{0};
+    std::atomic<uint64_t> mWakeupsWritten{0};
 };
 
 
@@ -105,6 +116,15 @@ void NativeMessageQueue::raiseException(JNIEnv* env, const char* msg, jthrowable
 }
 
 void NativeMessageQueue::pollOnce(JNIEnv* env, jobject pollObj, int timeoutMillis) {
+    uint64_t pending = mPendingWakeups.exchange(0, std::memory_order_acq_rel);
+    if (pending > 1) {
+        // At least one producer skipped the eventfd write since the last
+        // drain.  Its message may have been enqueued after the caller's
+        // queue check, so force an immediate pass rather than blocking.
+        mWakeupsWritten.fetch_add(1, std::memory_order_relaxed);
+        mLooper->wake();
+    }
+
     mPollEnv = env;
     mPollObj = pollObj;
     mLooper->pollOnce(timeoutMillis);
@@ -119,7 +139,16 @@ void NativeMessageQueue::pollOnce(JNIEnv* env, jobject pollObj, int timeoutMilli
 }
 
 void NativeMessageQueue::wake() {
-    mLooper->wake();
+    mWakeupsRequested.fetch_add(1, std::memory_order_relaxed);
+    if (mPendingWakeups.fetch_add(1, std::memory_order_acq_rel) == 0) {
+        mWakeupsWritten.fetch_add(1, std::memory_order_relaxed);
+        mLooper->wake();
+    }
+}
+
+void NativeMessageQueue::getWakeupStats(uint64_t* outRequested, uint64_t* outWritten) {
+    *outRequested = mWakeupsRequested.load(std::memory_order_relaxed);
+    *outWritten = mWakeupsWritten.load(std::memory_order_relaxed);
 }
 
 void NativeMessageQueue::setFileDescriptorEvents(int fd, int events) {
@@ -196,6 +225,22 @@ static void android_os_MessageQueue_nativeWake(JNIEnv* env, jclass clazz, jlong
     nativeMessageQueue->wake();
 }
 
+static jlongArray android_os_MessageQueue_nativeGetWakeupStats(JNIEnv* env, jclass clazz,
+        jlong ptr) {
+    NativeMessageQueue* nativeMessageQueue = reinterpret_cast<NativeMessageQueue*>(ptr);
+    uint64_t requested;
+    uint64_t written;
+    nativeMessageQueue->getWakeupStats(&requested, &written);
+
+    jlongArray array = env->NewLongArray(2);
+    if (array == NULL) { // NewLongArray already threw OutOfMemoryError.
+        return NULL;
+    }
+    jlong stats[2] = { static_cast<jlong>(requested), static_cast<jlong>(written) };
+    env->SetLongArrayRegion(array, 0, 2, stats);
+    return array;
+}
+
 static jboolean android_os_MessageQueue_nativeIsPolling(JNIEnv* env, jclass clazz, jlong ptr) {
     NativeMessageQueue* nativeMessageQueue = reinterpret_cast<NativeMessageQueue*>(ptr);
     return nativeMessageQueue->getLooper()->isPolling();
@@ -215,6 +260,7 @@ static const JNINativeMethod gMessageQueueMethods[] = {
     { "nativeDestroy", "(J)V", (void*)android_os_MessageQueue_nativeDestroy },
     { "nativePollOnce", "(JI)V", (void*)android_os_MessageQueue_nativePollOnce },
     { "nativeWake", "(J)V", (void*)android_os_MessageQueue_nativeWake },
+    { "nativeGetWakeupStats", "(J)[J", (void*)android_os_MessageQueue_nativeGetWakeupStats },
     { "nativeIsPolling", "(J)Z", (void*)android_os_MessageQueue_nativeIsPolling },
     { "nativeSetFileDescriptorEvents", "(JII)V",
             (void*)android_os_MessageQueue_nativeSetFileDescriptorEvents },
@@ -191,6 +191,105 @@ static void android_os_Parcel_writeByteArray(JNIEnv* env, jclass clazz, jlong na
     }
 }
 
+// The bulk array paths below memcpy whole primitive array payloads in and
+// out of the parcel.  That matches the wire format of the per-element
+// writeInt/writeLong/... loops only because the parcel stores values in
+// host byte order; both sides of a parcel always run on the same
+// byte order, but make the assumption explicit.
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+        "bulk parcel array paths assume a little-endian host");
+
+template <typename T>
+static void android_os_Parcel_writePrimitiveArray(JNIEnv* env, jclass clazz, jlong nativePtr,
+                                                  jarray data, jint offset, jint length)
+{
+    Parcel* parcel = reinterpret_cast<Parcel*>(nativePtr);
+    if (parcel == NULL) {
+        return;
+    }
+
+    if (data == NULL) {
+        const status_t err = parcel->writeInt32(-1);
+        if (err != NO_ERROR) {
+            signalExceptionForError(env, clazz, err);
+        }
+        return;
+    }
+
+    const status_t err = parcel->writeInt32(length);
+    if (err != NO_ERROR) {
+        signalExceptionForError(env, clazz, err);
+        return;
+    }
+
+    void* dest = parcel->writeInplace(length * sizeof(T));
+    if (dest == NULL) {
+        signalExceptionForError(env, clazz, NO_MEMORY);
+        return;
+    }
+
+    T* ar = (T*)env->GetPrimitiveArrayCritical(data, 0);
+    if (ar) {
+        memcpy(dest, ar + offset, length * sizeof(T));
+        env->ReleasePrimitiveArrayCritical(data, ar, 0);
+    }
+}
+
+// Reads a length-prefixed primitive array payload into a freshly allocated
+// Java array with a single memcpy; returns NULL for a null (-1) marker or
+// a corrupt length.
+template <typename T, typename JArrayT>
+static JArrayT android_os_Parcel_createPrimitiveArray(JNIEnv* env, jlong nativePtr,
+                                                      JArrayT (JNIEnv::*newArray)(jsize))
+{
+    Parcel* parcel = reinterpret_cast<Parcel*>(nativePtr);
+    if (parcel == NULL) {
+        return NULL;
+    }
+
+    int32_t len = parcel->readInt32();
+    if (len < 0 || len * sizeof(T) > parcel->dataAvail()) {
+        return NULL;
+    }
+
+    JArrayT ret = (env->*newArray)(len);
+    if (ret == NULL) { // newArray already threw OutOfMemoryError.
+        return NULL;
+    }
+
+    const void* data = parcel->readInplace(len * sizeof(T));
+    if (data == NULL) {
+        return NULL;
+    }
+
+    T* ar = (T*)env->GetPrimitiveArrayCritical(ret, 0);
+    if (ar) {
+        memcpy(ar, data, len * sizeof(T));
+        env->ReleasePrimitiveArrayCritical(ret, ar, 0);
+    }
+    return ret;
+}
+
+static jintArray android_os_Parcel_createIntArray(JNIEnv* env, jclass clazz, jlong nativePtr)
+{
+    return android_os_Parcel_createPrimitiveArray<jint>(env, nativePtr, &JNIEnv::NewIntArray);
+}
+
+static jlongArray android_os_Parcel_createLongArray(JNIEnv* env, jclass clazz, jlong nativePtr)
+{
+    return android_os_Parcel_createPrimitiveArray<jlong>(env, nativePtr, &JNIEnv::NewLongArray);
+}
+
+static jfloatArray android_os_Parcel_createFloatArray(JNIEnv* env, jclass clazz, jlong nativePtr)
+{
+    return android_os_Parcel_createPrimitiveArray<jfloat>(env, nativePtr, &JNIEnv::NewFloatArray);
+}
+
+static jdoubleArray android_os_Parcel_createDoubleArray(JNIEnv* env, jclass clazz, jlong nativePtr)
+{
+    return android_os_Parcel_createPrimitiveArray<jdouble>(env, nativePtr, &JNIEnv::NewDoubleArray);
+}
+
 static void android_os_Parcel_writeBlob(JNIEnv* env, jclass clazz, jlong nativePtr, jobject data,
                                         jint offset, jint length) {
     Parcel* parcel = reinterpret_cast<Parcel*>(nativePtr);
@@ -230,6 +329,72 @@ static void android_os_Parcel_writeBlob(JNIEnv* env, jclass clazz, jlong nativeP
     blob.release();
 }
 
+static void android_os_Parcel_writeBlobBuffer(JNIEnv* env, jclass clazz, jlong nativePtr,
+                                              jobject buffer, jint offset, jint length) {
+    Parcel* parcel = reinterpret_cast<Parcel*>(nativePtr);
+    if (parcel == NULL) {
+        return;
+    }
+
+    void* data = env->GetDirectBufferAddress(buffer);
+    if (data == NULL) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                          "Buffer is not a direct ByteBuffer");
+        return;
+    }
+
+    const status_t err = parcel->writeInt32(length);
+    if (err != NO_ERROR) {
+        signalExceptionForError(env, clazz, err);
+        return;
+    }
+
+    android::Parcel::WritableBlob blob;
+    const status_t err2 = parcel->writeBlob(length, false, &blob);
+    if (err2 != NO_ERROR) {
+        signalExceptionForError(env, clazz, err2);
+        return;
+    }
+
+    memcpy(blob.data(), static_cast<uint8_t*>(data) + offset, length);
+    blob.release();
+}
+
+static jint android_os_Parcel_readBlobBuffer(JNIEnv* env, jclass clazz, jlong nativePtr,
+                                             jobject buffer, jint offset, jint capacity) {
+    Parcel* parcel = reinterpret_cast<Parcel*>(nativePtr);
+    if (parcel == NULL) {
+        return -1;
+    }
+
+    void* data = env->GetDirectBufferAddress(buffer);
+    if (data == NULL) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                          "Buffer is not a direct ByteBuffer");
+        return -1;
+    }
+
+    int32_t len = parcel->readInt32();
+    if (len < 0) {
+        return -1;
+    }
+    if (len > capacity) {
+        signalExceptionForError(env, clazz, NO_MEMORY);
+        return -1;
+    }
+
+    android::Parcel::ReadableBlob blob;
+    const status_t err = parcel->readBlob(len, &blob);
+    if (err != NO_ERROR) {
+        signalExceptionForError(env, clazz, err);
+        return -1;
+    }
+
+    memcpy(static_cast<uint8_t*>(data) + offset, blob.data(), len);
+    blob.release();
+    return len;
+}
+
 static void android_os_Parcel_writeInt(JNIEnv* env, jclass clazz, jlong nativePtr, jint val) {
     Parcel* parcel = reinterpret_cast<Parcel*>(nativePtr);
     if (parcel != NULL) {
@@ -747,7 +912,20 @@ static const JNINativeMethod gParcelMethods[] = {
     {"nativeRestoreAllowFds",     "(JZ)V", (void*)android_os_Parcel_restoreAllowFds},
 
     {"nativeWriteByteArray",      "(J[BII)V", (void*)android_os_Parcel_writeByteArray},
+    {"nativeWriteIntArray",       "(J[III)V",
+            (void*)android_os_Parcel_writePrimitiveArray<jint>},
+    {"nativeWriteLongArray",      "(J[JII)V",
+            (void*)android_os_Parcel_writePrimitiveArray<jlong>},
+    {"nativeWriteFloatArray",     "(J[FII)V",
+            (void*)android_os_Parcel_writePrimitiveArray<jfloat>},
+    {"nativeWriteDoubleArray",    "(J[DII)V",
+            (void*)android_os_Parcel_writePrimitiveArray<jdouble>},
+    {"nativeCreateIntArray",      "(J)[I", (void*)android_os_Parcel_createIntArray},
+    {"nativeCreateLongArray",     "(J)[J", (void*)android_os_Parcel_createLongArray},
+    {"nativeCreateFloatArray",    "(J)[F", (void*)android_os_Parcel_createFloatArray},
+    {"nativeCreateDoubleArray",   "(J)[D", (void*)android_os_Parcel_createDoubleArray},
     {"nativeWriteBlob",           "(J[BII)V", (void*)android_os_Parcel_writeBlob},
+    {"nativeWriteBlobBuffer",     "(JLjava/nio/ByteBuffer;II)V", (void*)android_os_Parcel_writeBlobBuffer},
     // @FastNative
     {"nativeWriteInt",            "(JI)V", (void*)android_os_Parcel_writeInt},
     // @FastNative
@@ -768,6 +946,7 @@ static const JNINativeMethod gParcelMethods[] = {
     {"nativeCreateByteArray",     "(J)[B", (void*)android_os_Parcel_createByteArray},
     {"nativeReadByteArray",       "(J[BI)Z", (void*)android_os_Parcel_readByteArray},
     {"nativeReadBlob",            "(J)[B", (void*)android_os_Parcel_readBlob},
+    {"nativeReadBlobBuffer",      "(JLjava/nio/ByteBuffer;II)I", (void*)android_os_Parcel_readBlobBuffer},
     // @CriticalNative
     {"nativeReadInt",             "(J)I", (void*)android_os_Parcel_readInt},
     // @CriticalNative
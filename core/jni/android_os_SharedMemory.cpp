@@ -28,7 +28,11 @@
 #include <algorithm>
 #include <errno.h>
 #include <limits>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
 #include <unistd.h>
+#include <vector>
 
 namespace {
 
@@ -90,10 +94,138 @@ jint SharedMemory_nSetProt(JNIEnv* env, jobject, jobject fileDescriptor, jint pr
     return err;
 }
 
+// Slice batching. Caches built on one large mapping (e.g. an image cache)
+// carve it into logical slices and advise the kernel per slice on every trim,
+// which used to mean one JNI crossing and one syscall per slice. The batch
+// entry points below take the slices as packed (offset, length) pairs over an
+// already-mapped region so a whole trim is one JNI call, and use
+// process_madvise(2) to cover all slices in a single syscall where the kernel
+// and the advice allow it.
+
+// Returns a pidfd for the current process, or -1 if the kernel has no
+// pidfd_open(2). Opened once and kept for the life of the process.
+int selfPidFd() {
+#if defined(__NR_pidfd_open)
+    static int fd = syscall(__NR_pidfd_open, getpid(), 0);
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+jint SharedMemory_nMadviseSlices(JNIEnv* env, jobject, jlong address, jlongArray jSlices,
+                                 jint advice) {
+    const jsize count = env->GetArrayLength(jSlices);
+    if (address == 0 || count == 0 || (count & 1) != 0) {
+        return -EINVAL;
+    }
+    jlong* slices = env->GetLongArrayElements(jSlices, nullptr);
+    if (slices == nullptr) {
+        return -ENOMEM;
+    }
+
+    const size_t pageSize = sysconf(_SC_PAGESIZE);
+    std::vector<struct iovec> ranges;
+    ranges.reserve(count / 2);
+    int err = 0;
+    for (jsize i = 0; i < count; i += 2) {
+        const jlong offset = slices[i];
+        const jlong length = slices[i + 1];
+        if (offset < 0 || length <= 0) {
+            err = -EINVAL;
+            break;
+        }
+        // madvise operates on whole pages; round each slice outward.
+        uintptr_t start = (uintptr_t)address + (uintptr_t)offset;
+        uintptr_t end = (start + (uintptr_t)length + pageSize - 1) & ~(pageSize - 1);
+        start &= ~(pageSize - 1);
+        ranges.push_back({reinterpret_cast<void*>(start), end - start});
+    }
+    env->ReleaseLongArrayElements(jSlices, slices, JNI_ABORT);
+    if (err != 0) {
+        return err;
+    }
+
+#if defined(__NR_process_madvise) && defined(MADV_COLD) && defined(MADV_PAGEOUT)
+    // process_madvise covers every slice in one syscall but only accepts the
+    // reclaim hints (MADV_COLD/MADV_PAGEOUT); MADV_DONTNEED and MADV_WILLNEED
+    // fall through to the per-slice loop below.
+    if (advice == MADV_COLD || advice == MADV_PAGEOUT) {
+        const int pidFd = selfPidFd();
+        if (pidFd >= 0) {
+            for (size_t done = 0; done < ranges.size();) {
+                const size_t batch = std::min(ranges.size() - done, (size_t)IOV_MAX);
+                if (syscall(__NR_process_madvise, pidFd, &ranges[done], batch, advice, 0) < 0) {
+                    break;  // ENOSYS or EINVAL on older kernels: use the loop.
+                }
+                done += batch;
+                if (done == ranges.size()) {
+                    return 0;
+                }
+            }
+        }
+    }
+#endif
+
+    for (const struct iovec& range : ranges) {
+        if (madvise(range.iov_base, range.iov_len, advice) != 0) {
+            return -errno;
+        }
+    }
+    return 0;
+}
+
+jint SharedMemory_nSliceResidency(JNIEnv* env, jobject, jlong address, jlongArray jSlices,
+                                  jlongArray jResidentBytes) {
+    const jsize count = env->GetArrayLength(jSlices);
+    if (address == 0 || count == 0 || (count & 1) != 0 ||
+            env->GetArrayLength(jResidentBytes) != count / 2) {
+        return -EINVAL;
+    }
+    jlong* slices = env->GetLongArrayElements(jSlices, nullptr);
+    if (slices == nullptr) {
+        return -ENOMEM;
+    }
+
+    const size_t pageSize = sysconf(_SC_PAGESIZE);
+    std::vector<jlong> resident(count / 2, 0);
+    std::vector<unsigned char> vec;
+    int err = 0;
+    for (jsize i = 0; i < count; i += 2) {
+        const jlong offset = slices[i];
+        const jlong length = slices[i + 1];
+        if (offset < 0 || length <= 0) {
+            err = -EINVAL;
+            break;
+        }
+        uintptr_t start = ((uintptr_t)address + (uintptr_t)offset) & ~(pageSize - 1);
+        uintptr_t end = ((uintptr_t)address + (uintptr_t)offset + (uintptr_t)length +
+                pageSize - 1) & ~(pageSize - 1);
+        vec.resize((end - start) / pageSize);
+        if (mincore(reinterpret_cast<void*>(start), end - start, vec.data()) != 0) {
+            err = -errno;
+            break;
+        }
+        size_t pages = 0;
+        for (unsigned char entry : vec) {
+            pages += entry & 1;
+        }
+        resident[i / 2] = (jlong)(pages * pageSize);
+    }
+    env->ReleaseLongArrayElements(jSlices, slices, JNI_ABORT);
+    if (err != 0) {
+        return err;
+    }
+    env->SetLongArrayRegion(jResidentBytes, 0, count / 2, resident.data());
+    return 0;
+}
+
 const JNINativeMethod methods[] = {
   NATIVE_METHOD(SharedMemory, nCreate, "(Ljava/lang/String;I)Ljava/io/FileDescriptor;"),
   NATIVE_METHOD(SharedMemory, nGetSize, "(Ljava/io/FileDescriptor;)I"),
-  NATIVE_METHOD(SharedMemory, nSetProt, "(Ljava/io/FileDescriptor;I)I")
+  NATIVE_METHOD(SharedMemory, nSetProt, "(Ljava/io/FileDescriptor;I)I"),
+  NATIVE_METHOD(SharedMemory, nMadviseSlices, "(J[JI)I"),
+  NATIVE_METHOD(SharedMemory, nSliceResidency, "(J[J[J)I")
 };
 
 } // anonymous namespace
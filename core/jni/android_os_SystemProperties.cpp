@@ -17,8 +17,14 @@
 
 #define LOG_TAG "SysPropJNI"
 
-#include <utility>
+#include <string.h>
+
+#include <atomic>
+#include <mutex>
 #include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "android-base/logging.h"
 #include "android-base/parsebool.h"
@@ -176,6 +182,114 @@ jboolean SystemProperties_get_booleanH(CRITICAL_JNI_PARAMS_COMMA jlong propJ, jb
     return jbooleanFromParseBoolResult(parseResult, defJ);
 }
 
+/*
+ * Watched property snapshots.
+ *
+ * native_watch registers a fixed set of property keys against a
+ * caller-supplied direct ByteBuffer and keeps a snapshot of their values
+ * in it, refreshed from the sysprop change callback.  The buffer starts
+ * with a 4-byte version counter followed by one 92-byte null-terminated
+ * UTF-8 value slot per key, in registration order.  The counter is
+ * incremented to an odd value before the slots are rewritten and to an
+ * even value afterwards (a seqlock), so Java can poll the buffer
+ * lock-free and retry the rare torn read.
+ */
+
+constexpr size_t kWatchValueSlotSize = 92;  // PROP_VALUE_MAX
+
+struct WatchSet {
+    std::vector<std::string> keys;
+    // Resolved lazily; a key may not exist yet when the watch is registered.
+    std::vector<const prop_info*> props;
+    jobject bufferRef;  // global ref keeping the direct buffer alive
+    uint8_t* table;
+};
+
+std::mutex gWatchLock;
+std::vector<WatchSet> gWatchSets;
+bool gWatchCallbackAdded = false;
+
+void RefreshWatchSetLocked(WatchSet& ws) {
+    auto* version = reinterpret_cast<std::atomic<uint32_t>*>(ws.table);
+    version->fetch_add(1, std::memory_order_release);  // now odd: update in progress
+    for (size_t i = 0; i < ws.keys.size(); i++) {
+        char* slot = reinterpret_cast<char*>(ws.table) + sizeof(uint32_t)
+                + i * kWatchValueSlotSize;
+        if (ws.props[i] == nullptr) {
+#if defined(__BIONIC__)
+            ws.props[i] = __system_property_find(ws.keys[i].c_str());
+#endif
+        }
+        if (ws.props[i] != nullptr) {
+            ReadProperty(ws.props[i], [&](const char* value) {
+                strlcpy(slot, value, kWatchValueSlotSize);
+            });
+        } else {
+            slot[0] = '\0';
+        }
+    }
+    version->fetch_add(1, std::memory_order_release);  // even again: stable
+}
+
+void RefreshWatchSets() {
+    std::lock_guard<std::mutex> lock(gWatchLock);
+    for (WatchSet& ws : gWatchSets) {
+        RefreshWatchSetLocked(ws);
+    }
+}
+
+jint SystemProperties_watch(JNIEnv* env, jclass, jobjectArray keysJ, jobject bufferJ)
+{
+#if defined(__BIONIC__)
+    if (keysJ == nullptr || bufferJ == nullptr) {
+        jniThrowNullPointerException(env, nullptr);
+        return 0;
+    }
+
+    auto* table = reinterpret_cast<uint8_t*>(env->GetDirectBufferAddress(bufferJ));
+    if (table == nullptr) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                          "snapshot buffer must be a direct ByteBuffer");
+        return 0;
+    }
+
+    const jsize count = env->GetArrayLength(keysJ);
+    const jint required = sizeof(uint32_t) + count * kWatchValueSlotSize;
+    if (env->GetDirectBufferCapacity(bufferJ) < required) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                          "snapshot buffer too small for watched key set");
+        return 0;
+    }
+
+    WatchSet ws;
+    for (jsize i = 0; i < count; i++) {
+        auto keyJ = reinterpret_cast<jstring>(env->GetObjectArrayElement(keysJ, i));
+        ScopedUtfChars key(env, keyJ);
+        if (!key.c_str()) {
+            return 0;
+        }
+        ws.keys.emplace_back(key.c_str());
+        ws.props.push_back(nullptr);
+        env->DeleteLocalRef(keyJ);
+    }
+    ws.bufferRef = env->NewGlobalRef(bufferJ);
+    ws.table = table;
+    *reinterpret_cast<uint32_t*>(table) = 0;
+
+    std::lock_guard<std::mutex> lock(gWatchLock);
+    gWatchSets.push_back(std::move(ws));
+    RefreshWatchSetLocked(gWatchSets.back());
+    if (!gWatchCallbackAdded) {
+        gWatchCallbackAdded = true;
+        add_sysprop_change_callback(RefreshWatchSets, -9000);
+    }
+    return required;
+#else
+    LOG(FATAL) << "fast property access supported only on device";
+    __builtin_unreachable();  // Silence warning
+#endif
+}
+
 void SystemProperties_set(JNIEnv *env, jobject clazz, jstring keyJ,
                           jstring valJ)
 {
@@ -267,6 +381,8 @@ int register_android_os_SystemProperties(JNIEnv *env)
           (void*) SystemProperties_get_integralH<jlong> },
         { "native_get_boolean", "(JZ)Z",
           (void*) SystemProperties_get_booleanH },
+        { "native_watch", "([Ljava/lang/String;Ljava/nio/ByteBuffer;)I",
+          (void*) SystemProperties_watch },
         { "native_set", "(Ljava/lang/String;Ljava/lang/String;)V",
           (void*) SystemProperties_set },
         { "native_add_change_callback", "()V",
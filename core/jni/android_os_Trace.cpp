@@ -19,11 +19,191 @@
 #include <cutils/trace.h>
 #include <log/log.h>
 #include <nativehelper/JNIHelp.h>
+#include <string.h>
+#include <utils/Timers.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace android {
 
+/*
+ * Optional asynchronous buffering for high-frequency trace events.
+ *
+ * When enabled, counter and async begin/end events are recorded into a
+ * lock-free per-thread ring and replayed to trace_marker by a background
+ * flusher thread, so the instrumented thread pays a few stores per event
+ * instead of a write() syscall.  Events are sorted on their capture
+ * timestamps before replay, preserving cross-thread ordering; absolute
+ * event times shift by up to the flush interval.
+ *
+ * Synchronous begin/end markers are deliberately not buffered: ftrace
+ * attributes "B"/"E" slices to the tid that writes the marker, so
+ * replaying them from the flusher would collapse every slice onto the
+ * flusher's thread.
+ */
+
+static constexpr size_t kMaxEventNameLength = 64;
+static constexpr int kFlushIntervalMs = 10;
+
+enum BufferedEventType {
+    EVENT_COUNTER,
+    EVENT_ASYNC_BEGIN,
+    EVENT_ASYNC_END,
+};
+
+struct BufferedTraceEvent {
+    nsecs_t timestamp;
+    uint64_t tag;
+    int32_t type;
+    int32_t cookie;
+    int64_t value;
+    char name[kMaxEventNameLength];
+};
+
+// Single-producer (the owning thread) single-consumer (the flusher) ring.
+class TraceEventRing {
+public:
+    bool push(const BufferedTraceEvent& event) {
+        uint32_t head = mHead.load(std::memory_order_relaxed);
+        uint32_t tail = mTail.load(std::memory_order_acquire);
+        if (head - tail >= kSize) {
+            return false;
+        }
+        mEvents[head & (kSize - 1)] = event;
+        mHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    void drain(std::vector<BufferedTraceEvent>& out) {
+        uint32_t tail = mTail.load(std::memory_order_relaxed);
+        uint32_t head = mHead.load(std::memory_order_acquire);
+        for (uint32_t i = tail; i != head; i++) {
+            out.push_back(mEvents[i & (kSize - 1)]);
+        }
+        mTail.store(head, std::memory_order_release);
+    }
+
+    // Set by the owning thread's destructor; once observed true by the
+    // flusher no further pushes can happen and the ring may be freed.
+    std::atomic<bool> detached{false};
+
+private:
+    static constexpr size_t kSize = 256;  // must be a power of two
+
+    std::atomic<uint32_t> mHead{0};
+    std::atomic<uint32_t> mTail{0};
+    BufferedTraceEvent mEvents[kSize];
+};
+
+static std::atomic<bool> gAsyncBuffering{false};
+static std::mutex gRingsLock;
+static std::vector<TraceEventRing*> gRings;
+static std::mutex gFlusherLock;
+static std::condition_variable gFlusherCondition;
+static bool gFlusherStarted = false;
+
+struct ThreadRingHolder {
+    TraceEventRing* ring = nullptr;
+    ~ThreadRingHolder() {
+        if (ring != nullptr) {
+            ring->detached.store(true, std::memory_order_release);
+        }
+    }
+};
+static thread_local ThreadRingHolder gThreadRing;
+
+static TraceEventRing* threadRing() {
+    if (gThreadRing.ring == nullptr) {
+        TraceEventRing* ring = new TraceEventRing();
+        {
+            std::lock_guard<std::mutex> lock(gRingsLock);
+            gRings.push_back(ring);
+        }
+        gThreadRing.ring = ring;
+    }
+    return gThreadRing.ring;
+}
+
+// Returns true if the event was handled (buffered, or dropped because the
+// tag is disabled); the caller falls back to the synchronous atrace call
+// otherwise, so a full ring never loses events.
+static bool bufferTraceEvent(int32_t type, uint64_t tag, const char* name,
+        int32_t cookie, int64_t value) {
+    if (!gAsyncBuffering.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    if (!atrace_is_tag_enabled(tag)) {
+        return true;
+    }
+    BufferedTraceEvent event;
+    event.timestamp = systemTime(SYSTEM_TIME_MONOTONIC);
+    event.tag = tag;
+    event.type = type;
+    event.cookie = cookie;
+    event.value = value;
+    strlcpy(event.name, name, sizeof(event.name));
+    return threadRing()->push(event);
+}
+
+static void replayTraceEvent(const BufferedTraceEvent& event) {
+    switch (event.type) {
+        case EVENT_COUNTER:
+            atrace_int64(event.tag, event.name, event.value);
+            break;
+        case EVENT_ASYNC_BEGIN:
+            atrace_async_begin(event.tag, event.name, event.cookie);
+            break;
+        case EVENT_ASYNC_END:
+            atrace_async_end(event.tag, event.name, event.cookie);
+            break;
+    }
+}
+
+static void traceFlusherLoop() {
+    std::vector<BufferedTraceEvent> events;
+    std::unique_lock<std::mutex> lock(gFlusherLock);
+    for (;;) {
+        if (gAsyncBuffering.load(std::memory_order_relaxed)) {
+            gFlusherCondition.wait_for(lock, std::chrono::milliseconds(kFlushIntervalMs));
+        } else {
+            gFlusherCondition.wait(lock);
+        }
+        lock.unlock();
+
+        events.clear();
+        {
+            std::lock_guard<std::mutex> ringsLock(gRingsLock);
+            for (auto it = gRings.begin(); it != gRings.end();) {
+                TraceEventRing* ring = *it;
+                const bool detached = ring->detached.load(std::memory_order_acquire);
+                ring->drain(events);
+                if (detached) {
+                    delete ring;
+                    it = gRings.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        std::stable_sort(events.begin(), events.end(),
+                [](const BufferedTraceEvent& a, const BufferedTraceEvent& b) {
+                    return a.timestamp < b.timestamp;
+                });
+        for (const BufferedTraceEvent& event : events) {
+            replayTraceEvent(event);
+        }
+
+        lock.lock();
+    }
+}
+
 inline static void sanitizeString(char* str) {
     while (*str) {
         char c = *str;
@@ -53,7 +233,9 @@ inline static void withString(JNIEnv* env, jstring jstr, F callback) {
 static void android_os_Trace_nativeTraceCounter(JNIEnv* env, jclass,
         jlong tag, jstring nameStr, jlong value) {
     withString(env, nameStr, [tag, value](char* str) {
-        atrace_int64(tag, str, value);
+        if (!bufferTraceEvent(EVENT_COUNTER, tag, str, 0, value)) {
+            atrace_int64(tag, str, value);
+        }
     });
 }
 
@@ -71,14 +253,18 @@ static void android_os_Trace_nativeTraceEnd(JNIEnv*, jclass, jlong tag) {
 static void android_os_Trace_nativeAsyncTraceBegin(JNIEnv* env, jclass,
         jlong tag, jstring nameStr, jint cookie) {
     withString(env, nameStr, [tag, cookie](char* str) {
-        atrace_async_begin(tag, str, cookie);
+        if (!bufferTraceEvent(EVENT_ASYNC_BEGIN, tag, str, cookie, 0)) {
+            atrace_async_begin(tag, str, cookie);
+        }
     });
 }
 
 static void android_os_Trace_nativeAsyncTraceEnd(JNIEnv* env, jclass,
         jlong tag, jstring nameStr, jint cookie) {
     withString(env, nameStr, [tag, cookie](char* str) {
-        atrace_async_end(tag, str, cookie);
+        if (!bufferTraceEvent(EVENT_ASYNC_END, tag, str, cookie, 0)) {
+            atrace_async_end(tag, str, cookie);
+        }
     });
 }
 
@@ -90,6 +276,20 @@ static void android_os_Trace_nativeSetTracingEnabled(JNIEnv*, jclass, jboolean e
     atrace_set_tracing_enabled(enabled);
 }
 
+static void android_os_Trace_nativeSetAsyncEventBuffering(JNIEnv*, jclass, jboolean enabled) {
+    if (enabled) {
+        std::lock_guard<std::mutex> lock(gFlusherLock);
+        if (!gFlusherStarted) {
+            gFlusherStarted = true;
+            std::thread(traceFlusherLoop).detach();
+        }
+    }
+    gAsyncBuffering.store(enabled, std::memory_order_release);
+    // Wake the flusher so residual buffered events are drained promptly
+    // after the mode changes.
+    gFlusherCondition.notify_all();
+}
+
 static const JNINativeMethod gTraceMethods[] = {
     /* name, signature, funcPtr */
     { "nativeSetAppTracingAllowed",
@@ -98,6 +298,9 @@ static const JNINativeMethod gTraceMethods[] = {
     { "nativeSetTracingEnabled",
             "(Z)V",
             (void*)android_os_Trace_nativeSetTracingEnabled },
+    { "nativeSetAsyncEventBuffering",
+            "(Z)V",
+            (void*)android_os_Trace_nativeSetAsyncEventBuffering },
 
     // ----------- @FastNative  ----------------
 
@@ -20,12 +20,28 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <string>
+#include <unordered_map>
 
 #include <core_jni_helpers.h>
 #include <minikin/Hyphenator.h>
+#include <nativehelper/ScopedUtfChars.h>
 
 namespace android {
 
+struct PatternFile {
+    const uint8_t* ptr;
+    size_t size;
+};
+
+// Keeps the mapping of each pattern file registered with minikin, so the pages backing a
+// locale can be pinned or prefetched later. Only written from init(), which runs once
+// during Zygote preload; afterwards it is read-only and safe to consult from any thread.
+static std::unordered_map<std::string, PatternFile>& patternFileRegistry() {
+    static std::unordered_map<std::string, PatternFile> registry;
+    return registry;
+}
+
 static std::string buildFileName(const std::string& locale) {
     constexpr char SYSTEM_HYPHENATOR_PREFIX[] = "/system/usr/hyphen-data/hyph-";
     constexpr char SYSTEM_HYPHENATOR_SUFFIX[] = ".hyb";
@@ -53,9 +69,32 @@ static const uint8_t* mmapPatternFile(const std::string& locale) {
     if (ptr == MAP_FAILED) {
         return nullptr;
     }
+    patternFileRegistry().emplace(locale,
+            PatternFile{reinterpret_cast<const uint8_t*>(ptr), static_cast<size_t>(st.st_size)});
     return reinterpret_cast<const uint8_t*>(ptr);
 }
 
+// Faults in every page of the pattern file. The mappings are MAP_SHARED, so once the pages
+// are in the page cache every process using this pattern benefits.
+static void touchPatternFile(const PatternFile& file) {
+    static const size_t pageSize = sysconf(_SC_PAGESIZE);
+    volatile uint8_t sink = 0;
+    for (size_t offset = 0; offset < file.size; offset += pageSize) {
+        sink ^= file.ptr[offset];
+    }
+    (void) sink;
+}
+
+// Pins the pattern file in memory. The Zygote lives for the lifetime of the system, so an
+// mlock here keeps the file-backed pages resident for every app that inherits or re-maps
+// them. Pinning is best effort: if mlock fails (e.g. RLIMIT_MEMLOCK), fall back to just
+// faulting the pages in now so first text layout in apps doesn't take the page faults.
+static void pinPatternFile(const PatternFile& file) {
+    if (mlock(file.ptr, file.size) != 0) {
+        touchPatternFile(file);
+    }
+}
+
 static void addHyphenatorWithoutPatternFile(const std::string& locale, int minPrefix,
         int minSuffix) {
     minikin::addHyphenator(locale, minikin::Hyphenator::loadBinary(
@@ -172,10 +211,43 @@ static void init() {
     addHyphenatorAlias("und-Orya", "or");  // Oriya
     addHyphenatorAlias("und-Taml", "ta");  // Tamil
     addHyphenatorAlias("und-Telu", "te");  // Telugu
+
+    // This runs during Zygote preload, so pin the patterns most likely to be needed by the
+    // first text layout in a new app process. The remaining locales stay mapped but are
+    // paged in on demand (or via nWarmLocale). Aliased locales share the target's mapping,
+    // so pinning en-US and en-GB covers all English locales.
+    static constexpr const char* kPinnedLocales[] = {
+            "en-US", "en-GB", "es", "fr", "de-1996", "pt",
+    };
+    const auto& registry = patternFileRegistry();
+    for (const char* locale : kPinnedLocales) {
+        const auto it = registry.find(locale);
+        if (it != registry.end()) {
+            pinPatternFile(it->second);
+        }
+    }
+}
+
+// Asynchronously callable warm-up for one locale: prefetches the pattern pages off the UI
+// thread so a later layout in that locale doesn't stall on page faults and I/O.
+static void warmLocale(JNIEnv* env, jclass /* clazz */, jstring locale) {
+    ScopedUtfChars localeChars(env, locale);
+    if (localeChars.c_str() == nullptr) {
+        return;
+    }
+
+    const auto& registry = patternFileRegistry();
+    const auto it = registry.find(localeChars.c_str());
+    if (it == registry.end()) {
+        return;  // No pattern file for this locale (or it is an alias of one already mapped).
+    }
+    madvise(const_cast<uint8_t*>(it->second.ptr), it->second.size, MADV_WILLNEED);
+    touchPatternFile(it->second);
 }
 
 static const JNINativeMethod gMethods[] = {
     {"nInit", "()V", (void*) init},
+    {"nWarmLocale", "(Ljava/lang/String;)V", (void*) warmLocale},
 };
 
 int register_android_text_Hyphenator(JNIEnv* env) {
@@ -64,6 +64,27 @@ static void android_util_EventLog_readEventsOnWrapping(JNIEnv* env, jobject claz
             timestamp, out);
 }
 
+/*
+ * In class android.util.EventLog:
+ *  static native int readEventsBatch(int[] tags, ByteBuffer buffer, int[] offsets)
+ *
+ *  Drains all available events matching tags into the direct buffer in one
+ *  call, recording per-event start offsets in the index; decoding happens
+ *  lazily on the Java side. Returns the number of events written.
+ */
+static jint android_util_EventLog_readEventsBatch(JNIEnv* env, jobject clazz ATTRIBUTE_UNUSED,
+                                                  jintArray tags,
+                                                  jobject buffer,
+                                                  jintArray offsets) {
+    if (tags == NULL || buffer == NULL || offsets == NULL) {
+        jniThrowNullPointerException(env, NULL);
+        return -1;
+    }
+
+    return ELog::readEventsBatch(env, ANDROID_LOG_RDONLY | ANDROID_LOG_NONBLOCK, tags, 0,
+            buffer, offsets);
+}
+
 /*
  * JNI registration.
  */
@@ -82,6 +103,10 @@ static const JNINativeMethod gRegisterMethods[] = {
       "([IJLjava/util/Collection;)V",
       (void*) android_util_EventLog_readEventsOnWrapping
     },
+    { "readEventsBatch",
+      "([ILjava/nio/ByteBuffer;[I)I",
+      (void*) android_util_EventLog_readEventsBatch
+    },
 };
 
 int register_android_util_EventLog(JNIEnv* env) {
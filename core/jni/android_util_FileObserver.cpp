@@ -31,6 +31,8 @@
 #include <sys/ioctl.h>
 #include <errno.h>
 
+#include <vector>
+
 #if defined(__linux__)
 #include <sys/inotify.h>
 #endif
@@ -38,6 +40,8 @@
 namespace android {
 
 static jmethodID method_onEvent;
+static jmethodID method_onEvents;
+static jclass class_string;
 
 static jint android_os_fileobserver_init(JNIEnv* env, jobject object)
 {
@@ -100,6 +104,106 @@ static void android_os_fileobserver_observe(JNIEnv* env, jobject object, jint fd
 #endif
 }
 
+static void android_os_fileobserver_observeBatched(JNIEnv* env, jobject object, jint fd)
+{
+#if defined(__linux__)
+
+    // One read() returns every event queued since the last wake, so an inotify
+    // storm (e.g. a download landing in a watched tree) is delivered as a
+    // single up-call instead of one JNI crossing per event. Events that repeat
+    // the same (wd, mask, name) within the batch are reported once.
+    char event_buf[4096];
+
+    while (1)
+    {
+        int num_bytes = read(fd, event_buf, sizeof(event_buf));
+
+        if (num_bytes < (int)sizeof(struct inotify_event))
+        {
+            if (errno == EINTR)
+                continue;
+
+            ALOGE("***** ERROR! android_os_fileobserver_observeBatched() got a short event!");
+            return;
+        }
+
+        std::vector<const struct inotify_event*> events;
+        int event_pos = 0;
+        while (num_bytes >= (int)sizeof(struct inotify_event))
+        {
+            const struct inotify_event* event =
+                    (const struct inotify_event *)(event_buf + event_pos);
+
+            bool duplicate = false;
+            for (const struct inotify_event* seen : events)
+            {
+                if (seen->wd == event->wd && seen->mask == event->mask &&
+                        seen->len == event->len &&
+                        (event->len == 0 || !strcmp(seen->name, event->name)))
+                {
+                    duplicate = true;
+                    break;
+                }
+            }
+            if (!duplicate)
+            {
+                events.push_back(event);
+            }
+
+            int event_size = sizeof(*event) + event->len;
+            num_bytes -= event_size;
+            event_pos += event_size;
+        }
+
+        const jsize count = events.size();
+        jintArray wfds = env->NewIntArray(count);
+        jintArray masks = env->NewIntArray(count);
+        jobjectArray paths = env->NewObjectArray(count, class_string, NULL);
+        if (wfds == NULL || masks == NULL || paths == NULL)
+        {
+            return;
+        }
+
+        {
+            ScopedIntArrayRW nWfds(env, wfds);
+            ScopedIntArrayRW nMasks(env, masks);
+            if (nWfds.get() == nullptr || nMasks.get() == nullptr)
+            {
+                return;
+            }
+            for (jsize i = 0; i < count; ++i)
+            {
+                nWfds[i] = events[i]->wd;
+                nMasks[i] = events[i]->mask;
+            }
+        }
+        for (jsize i = 0; i < count; ++i)
+        {
+            if (events[i]->len > 0)
+            {
+                jstring path = env->NewStringUTF(events[i]->name);
+                if (path == NULL)
+                {
+                    return;
+                }
+                env->SetObjectArrayElement(paths, i, path);
+                env->DeleteLocalRef(path);
+            }
+        }
+
+        env->CallVoidMethod(object, method_onEvents, wfds, masks, paths);
+        if (env->ExceptionCheck()) {
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+        }
+        env->DeleteLocalRef(wfds);
+        env->DeleteLocalRef(masks);
+        env->DeleteLocalRef(paths);
+    }
+
+#endif
+}
+
 static void android_os_fileobserver_startWatching(JNIEnv* env, jobject object, jint fd,
                                                        jobjectArray pathStrings, jint mask,
                                                        jintArray wfdArray)
@@ -147,6 +251,7 @@ static const JNINativeMethod sMethods[] = {
      /* name, signature, funcPtr */
     { "init", "()I", (void*)android_os_fileobserver_init },
     { "observe", "(I)V", (void*)android_os_fileobserver_observe },
+    { "observeBatched", "(I)V", (void*)android_os_fileobserver_observeBatched },
     { "startWatching", "(I[Ljava/lang/String;I[I)V", (void*)android_os_fileobserver_startWatching },
     { "stopWatching", "(I[I)V", (void*)android_os_fileobserver_stopWatching }
 
@@ -157,6 +262,8 @@ int register_android_os_FileObserver(JNIEnv* env)
     jclass clazz = FindClassOrDie(env, "android/os/FileObserver$ObserverThread");
 
     method_onEvent = GetMethodIDOrDie(env, clazz, "onEvent", "(IILjava/lang/String;)V");
+    method_onEvents = GetMethodIDOrDie(env, clazz, "onEvents", "([I[I[Ljava/lang/String;)V");
+    class_string = MakeGlobalRefOrDie(env, FindClassOrDie(env, "java/lang/String"));
 
     return RegisterMethodsOrDie(env, "android/os/FileObserver$ObserverThread", sMethods,
                                 NELEM(sMethods));
@@ -1323,6 +1323,117 @@ static jint android_os_Process_nativePidFdOpen(JNIEnv* env, jobject, jint pid, j
     return fd;
 }
 
+// Wrapper function to the syscall pidfd_send_signal, which sends a signal to
+// the process referred to by the pidfd. Unlike kill(2) this cannot hit a
+// recycled pid.
+static inline int sys_pidfd_send_signal(int pidfd, int sig) {
+    return syscall(__NR_pidfd_send_signal, pidfd, sig, NULL, 0);
+}
+
+// Signals a set of processes and waits for all of them to exit on one epoll
+// set. Process cleanup under memory pressure used to serialize a kill plus an
+// exit wait per pid; doing the batch here means one JNI call and the waits
+// overlap instead of adding up. Returns a result per pid: 0 once the process
+// is gone, ETIMEDOUT for processes still alive when timeoutMs elapses, or the
+// errno from opening or signaling that pid. A signal of 0 only waits.
+static jintArray android_os_Process_nativeSignalAndWaitPids(JNIEnv* env, jobject, jintArray jPids,
+                                                            jint signal, jint timeoutMs) {
+    if (jPids == NULL) {
+        jniThrowNullPointerException(env, NULL);
+        return NULL;
+    }
+    const jsize count = env->GetArrayLength(jPids);
+    std::vector<jint> results(count, 0);
+    std::vector<int> pidFds(count, -1);
+
+    jint* pids = env->GetIntArrayElements(jPids, NULL);
+    if (pids == NULL) {
+        jniThrowException(env, "java/lang/OutOfMemoryError", NULL);
+        return NULL;
+    }
+
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        env->ReleaseIntArrayElements(jPids, pids, JNI_ABORT);
+        throwErrnoException(env, "nativeSignalAndWaitPids", errno);
+        return NULL;
+    }
+
+    int remaining = 0;
+    for (jsize i = 0; i < count; i++) {
+        int fd = sys_pidfd_open(pids[i], 0);
+        if (fd < 0) {
+            // ESRCH means the process is already gone, which is the outcome
+            // the caller wants.
+            results[i] = (errno == ESRCH) ? 0 : errno;
+            continue;
+        }
+        if (signal != 0 && sys_pidfd_send_signal(fd, signal) < 0) {
+            results[i] = errno;
+            close(fd);
+            continue;
+        }
+        // A pidfd polls readable once the process exits, whether or not we
+        // are its parent.
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u32 = i;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            results[i] = errno;
+            close(fd);
+            continue;
+        }
+        pidFds[i] = fd;
+        remaining++;
+    }
+    env->ReleaseIntArrayElements(jPids, pids, JNI_ABORT);
+
+    const nsecs_t deadline = (timeoutMs < 0)
+            ? -1 : systemTime(SYSTEM_TIME_MONOTONIC) + milliseconds_to_nanoseconds(timeoutMs);
+    while (remaining > 0) {
+        int waitMs = -1;
+        if (deadline >= 0) {
+            nsecs_t left = deadline - systemTime(SYSTEM_TIME_MONOTONIC);
+            waitMs = (left > 0) ? (int)nanoseconds_to_milliseconds(left + 999999) : 0;
+        }
+        struct epoll_event events[32];
+        int ready = TEMP_FAILURE_RETRY(epoll_wait(epollFd, events, NELEM(events), waitMs));
+        if (ready <= 0) {
+            // Timeout or unexpected error: report the stragglers and stop.
+            for (jsize i = 0; i < count; i++) {
+                if (pidFds[i] >= 0) {
+                    results[i] = (ready == 0) ? ETIMEDOUT : errno;
+                }
+            }
+            break;
+        }
+        for (int n = 0; n < ready; n++) {
+            const jsize i = events[n].data.u32;
+            results[i] = 0;
+            close(pidFds[i]);
+            pidFds[i] = -1;
+            remaining--;
+        }
+    }
+
+    for (jsize i = 0; i < count; i++) {
+        if (pidFds[i] >= 0) {
+            close(pidFds[i]);
+        }
+    }
+    close(epollFd);
+
+    jintArray resultArray = env->NewIntArray(count);
+    if (resultArray == NULL) {
+        jniThrowException(env, "java/lang/OutOfMemoryError", NULL);
+        return NULL;
+    }
+    if (count > 0) {
+        env->SetIntArrayRegion(resultArray, 0, count, results.data());
+    }
+    return resultArray;
+}
+
 static const JNINativeMethod methods[] = {
         {"getUidForName", "(Ljava/lang/String;)I", (void*)android_os_Process_getUidForName},
         {"getGidForName", "(Ljava/lang/String;)I", (void*)android_os_Process_getGidForName},
@@ -1363,6 +1474,8 @@ static const JNINativeMethod methods[] = {
         {"killProcessGroup", "(II)I", (void*)android_os_Process_killProcessGroup},
         {"removeAllProcessGroups", "()V", (void*)android_os_Process_removeAllProcessGroups},
         {"nativePidFdOpen", "(II)I", (void*)android_os_Process_nativePidFdOpen},
+        {"nativeSignalAndWaitPids", "([III)[I",
+                (void*)android_os_Process_nativeSignalAndWaitPids},
 };
 
 int register_android_os_Process(JNIEnv* env)
@@ -24,8 +24,10 @@
 #include <utils/Log.h>
 
 #include <androidfw/ResourceTypes.h>
+#include <utils/Unicode.h>
 
 #include <stdio.h>
+#include <string.h>
 
 namespace android {
 
@@ -95,6 +97,95 @@ static jstring android_content_StringBlock_nativeGetString(JNIEnv* env, jobject
     return env->NewString((const jchar*)str, len);
 }
 
+/*
+ * Decodes a batch of string indices in one JNI call into the caller's
+ * direct ByteBuffer (native byte order), so the managed side can build the
+ * strings (and cache the hottest ones) without a JNI transition and a
+ * UTF-8 re-decode per string.
+ *
+ * The buffer starts with two ints per requested index:
+ *   0: offset of the string in the char region, in jchars, or -1 if the
+ *      index could not be decoded
+ *   1: length of the string in jchars
+ * The char region follows the header and holds the UTF-16 chars of each
+ * decoded string back to back.  UTF-8 pool strings are converted straight
+ * into the char region, bypassing the pool's per-string decode cache.
+ *
+ * Returns the total number of jchars in the char region.  If the buffer
+ * cannot hold the header plus that many chars the output is truncated and
+ * the caller is expected to retry with a larger buffer.
+ */
+static jint android_content_StringBlock_nativeGetStrings(JNIEnv* env, jobject clazz,
+                                                         jlong token, jintArray indices,
+                                                         jobject outBuf)
+{
+    ResStringPool* osb = reinterpret_cast<ResStringPool*>(token);
+    if (osb == NULL || indices == NULL || outBuf == NULL) {
+        jniThrowNullPointerException(env, NULL);
+        return 0;
+    }
+
+    jbyte* out = reinterpret_cast<jbyte*>(env->GetDirectBufferAddress(outBuf));
+    if (out == NULL) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                "decode buffer must be a direct ByteBuffer");
+        return 0;
+    }
+    const size_t capacity = env->GetDirectBufferCapacity(outBuf);
+
+    const jsize count = env->GetArrayLength(indices);
+    jint* idx = env->GetIntArrayElements(indices, NULL);
+    if (idx == NULL) { // GetIntArrayElements already threw OutOfMemoryError.
+        return 0;
+    }
+
+    const size_t headerBytes = count * 2 * sizeof(jint);
+    jint* header = reinterpret_cast<jint*>(out);
+    jchar* chars = reinterpret_cast<jchar*>(out + headerBytes);
+    const size_t charCapacity =
+            capacity > headerBytes ? (capacity - headerBytes) / sizeof(jchar) : 0;
+    const bool haveHeader = capacity >= headerBytes;
+
+    size_t used = 0;
+    for (jsize i = 0; i < count; i++) {
+        jint offset = -1;
+        jint length = 0;
+        size_t len;
+        const char* str8 = osb->string8At(idx[i], &len);
+        if (str8 != NULL) {
+            ssize_t len16 = utf8_to_utf16_length(
+                    reinterpret_cast<const uint8_t*>(str8), len);
+            if (len16 >= 0) {
+                offset = static_cast<jint>(used);
+                length = static_cast<jint>(len16);
+                if (used + len16 <= charCapacity) {
+                    utf8_to_utf16_no_null_terminator(
+                            reinterpret_cast<const uint8_t*>(str8), len,
+                            reinterpret_cast<char16_t*>(chars) + used, len16);
+                }
+                used += len16;
+            }
+        } else {
+            const char16_t* str = osb->stringAt(idx[i], &len);
+            if (str != NULL) {
+                offset = static_cast<jint>(used);
+                length = static_cast<jint>(len);
+                if (used + len <= charCapacity) {
+                    memcpy(chars + used, str, len * sizeof(jchar));
+                }
+                used += len;
+            }
+        }
+        if (haveHeader) {
+            header[2 * i] = offset;
+            header[2 * i + 1] = length;
+        }
+    }
+
+    env->ReleaseIntArrayElements(indices, idx, JNI_ABORT);
+    return static_cast<jint>(used);
+}
+
 static jintArray android_content_StringBlock_nativeGetStyle(JNIEnv* env, jobject clazz,
                                                          jlong token, jint idx)
 {
@@ -163,6 +254,8 @@ static const JNINativeMethod gStringBlockMethods[] = {
             (void*) android_content_StringBlock_nativeGetSize },
     { "nativeGetString",    "(JI)Ljava/lang/String;",
             (void*) android_content_StringBlock_nativeGetString },
+    { "nativeGetStrings",   "(J[ILjava/nio/ByteBuffer;)I",
+            (void*) android_content_StringBlock_nativeGetStrings },
     { "nativeGetStyle",    "(JI)[I",
             (void*) android_content_StringBlock_nativeGetStyle },
     { "nativeDestroy",      "(J)V",
@@ -92,6 +92,128 @@ static jlong android_content_XmlBlock_nativeCreateParseState(JNIEnv* env, jobjec
     return reinterpret_cast<jlong>(st);
 }
 
+/*
+ * Walks the whole document once and writes a flat int stream into the
+ * caller's direct ByteBuffer (native byte order), so the managed side can
+ * iterate the document without a JNI transition per event or attribute.
+ *
+ * Each event is emitted as an 8-int header:
+ *   0: event code, using the same values nativeNext returns
+ *   1: line number
+ *   2: element namespace string index, or -1
+ *   3: element name string index (START_TAG/END_TAG) or text string index (TEXT)
+ *   4: "id" attribute value string index, or -1 (START_TAG only)
+ *   5: "class" attribute value string index, or -1 (START_TAG only)
+ *   6: style attribute reference, or 0 (START_TAG only)
+ *   7: attribute count (0 except for START_TAG)
+ * followed by 6 ints per attribute:
+ *   namespace string index, name string index, name resource id,
+ *   value data type, value data, value string index.
+ *
+ * Returns the total number of ints in the tokenized document.  If that is
+ * larger than the buffer's capacity the output is truncated and the caller
+ * is expected to retry with a larger buffer.
+ */
+static jint android_content_XmlBlock_nativeTokenizeDocument(JNIEnv* env, jobject clazz,
+                                                            jlong token, jobject outBuf)
+{
+    ResXMLTree* osb = reinterpret_cast<ResXMLTree*>(token);
+    if (osb == NULL || outBuf == NULL) {
+        jniThrowNullPointerException(env, NULL);
+        return 0;
+    }
+
+    jint* out = reinterpret_cast<jint*>(env->GetDirectBufferAddress(outBuf));
+    if (out == NULL) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                "tokenize buffer must be a direct ByteBuffer");
+        return 0;
+    }
+    const size_t capacity = env->GetDirectBufferCapacity(outBuf) / sizeof(jint);
+
+    ResXMLParser st(*osb);
+    st.restart();
+
+    size_t used = 0;
+    auto emit = [&](jint value) {
+        if (used < capacity) {
+            out[used] = value;
+        }
+        used++;
+    };
+
+    for (;;) {
+        ResXMLParser::event_code_t code = st.next();
+        jint event;
+        switch (code) {
+            case ResXMLParser::START_TAG:
+                event = 2;
+                break;
+            case ResXMLParser::END_TAG:
+                event = 3;
+                break;
+            case ResXMLParser::TEXT:
+                event = 4;
+                break;
+            case ResXMLParser::END_DOCUMENT:
+                event = 1;
+                break;
+            case ResXMLParser::BAD_DOCUMENT:
+                jniThrowException(env, "org/xmlpull/v1/XmlPullParserException",
+                        "Corrupt XML binary file");
+                return 0;
+            default:
+                // START_DOCUMENT and namespace events are skipped, as in nativeNext.
+                continue;
+        }
+
+        emit(event);
+        emit(static_cast<jint>(st.getLineNumber()));
+        emit(static_cast<jint>(st.getElementNamespaceID()));
+        emit(static_cast<jint>(event == 4 ? st.getTextID() : st.getElementNameID()));
+
+        if (event == 2) {
+            ssize_t idIdx = st.indexOfID();
+            emit(idIdx >= 0 ? static_cast<jint>(st.getAttributeValueStringID(idIdx)) : -1);
+
+            ssize_t classIdx = st.indexOfClass();
+            emit(classIdx >= 0 ? static_cast<jint>(st.getAttributeValueStringID(classIdx)) : -1);
+
+            jint styleRef = 0;
+            ssize_t styleIdx = st.indexOfStyle();
+            Res_value value;
+            if (styleIdx >= 0 && st.getAttributeValue(styleIdx, &value) >= 0
+                    && (value.dataType == value.TYPE_REFERENCE
+                            || value.dataType == value.TYPE_ATTRIBUTE)) {
+                styleRef = value.data;
+            }
+            emit(styleRef);
+
+            const size_t attrCount = st.getAttributeCount();
+            emit(static_cast<jint>(attrCount));
+            for (size_t i = 0; i < attrCount; i++) {
+                emit(static_cast<jint>(st.getAttributeNamespaceID(i)));
+                emit(static_cast<jint>(st.getAttributeNameID(i)));
+                emit(static_cast<jint>(st.getAttributeNameResID(i)));
+                emit(static_cast<jint>(st.getAttributeDataType(i)));
+                emit(static_cast<jint>(st.getAttributeData(i)));
+                emit(static_cast<jint>(st.getAttributeValueStringID(i)));
+            }
+        } else {
+            emit(-1);
+            emit(-1);
+            emit(0);
+            emit(0);
+        }
+
+        if (event == 1) {
+            break;
+        }
+    }
+
+    return static_cast<jint>(used);
+}
+
 static jint android_content_XmlBlock_nativeNext(JNIEnv* env, jobject clazz,
                                              jlong token)
 {
@@ -388,6 +510,8 @@ static const JNINativeMethod gXmlBlockMethods[] = {
             (void*) android_content_XmlBlock_nativeDestroyParseState },
     { "nativeDestroy",              "(J)V",
             (void*) android_content_XmlBlock_nativeDestroy },
+    { "nativeTokenizeDocument",     "(JLjava/nio/ByteBuffer;)I",
+            (void*) android_content_XmlBlock_nativeTokenizeDocument },
 
     // ------------------- @FastNative ----------------------
 
@@ -17,8 +17,13 @@
 
 #define LOG_TAG "StrictJarFile"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include <log/log.h>
 
@@ -126,6 +131,125 @@ jobject StrictJarFile_nativeNextEntry(JNIEnv* env, jobject, jlong iterationHandl
   return newZipEntry(env, data, entryNameString.get());
 }
 
+jobjectArray StrictJarFile_nativeGetAllEntries(JNIEnv* env, jobject, jlong nativeHandle,
+                                               jstring prefix) {
+  // Walking a large archive through nativeNextEntry costs one JNI call per
+  // entry; this returns the whole central directory in one call. The
+  // directory is mmapped once by OpenArchiveFd and shared by every iteration.
+  ScopedUtfChars prefixChars(env, prefix);
+  if (prefixChars.c_str() == NULL) {
+    return NULL;
+  }
+
+  void* cookie = NULL;
+  int32_t error = StartIteration(reinterpret_cast<ZipArchiveHandle>(nativeHandle),
+                                 &cookie, prefixChars.c_str(), "");
+  if (error) {
+    throwIoException(env, error);
+    return NULL;
+  }
+
+  std::vector<std::pair<std::string, ZipEntry>> entries;
+  ZipEntry data;
+  std::string entryName;
+  while ((error = Next(cookie, &data, &entryName)) == 0) {
+    entries.emplace_back(entryName, data);
+  }
+  EndIteration(cookie);
+  if (error != -1) {  // -1 is the end-of-iteration sentinel.
+    throwIoException(env, error);
+    return NULL;
+  }
+
+  jobjectArray result = env->NewObjectArray(entries.size(), zipEntryClass, NULL);
+  if (result == NULL) {
+    return NULL;
+  }
+  for (size_t i = 0; i < entries.size(); ++i) {
+    ScopedLocalRef<jstring> name(env, env->NewStringUTF(entries[i].first.c_str()));
+    ScopedLocalRef<jobject> entry(env, newZipEntry(env, entries[i].second, name.get()));
+    if (entry.get() == NULL) {
+      return NULL;
+    }
+    env->SetObjectArrayElement(result, i, entry.get());
+  }
+  return result;
+}
+
+bool DiscardProcessFunction(const uint8_t*, size_t, void*) {
+  return true;
+}
+
+jstring StrictJarFile_nativeVerifyEntries(JNIEnv* env, jobject, jlong nativeHandle,
+                                          jint numThreads) {
+  // Decompresses every entry across a worker pool, letting libziparchive
+  // check each stored CRC against the payload. Entry reads go through
+  // pread(2) on the shared fd and inflate state is per call, so workers can
+  // verify concurrently against one handle. Returns the name of the first
+  // entry that fails, or null when the whole archive checks out.
+  ZipArchiveHandle handle = reinterpret_cast<ZipArchiveHandle>(nativeHandle);
+
+  void* cookie = NULL;
+  int32_t error = StartIteration(handle, &cookie, "", "");
+  if (error) {
+    throwIoException(env, error);
+    return NULL;
+  }
+
+  std::vector<std::pair<std::string, ZipEntry>> entries;
+  ZipEntry data;
+  std::string entryName;
+  while ((error = Next(cookie, &data, &entryName)) == 0) {
+    entries.emplace_back(entryName, data);
+  }
+  EndIteration(cookie);
+  if (error != -1) {
+    throwIoException(env, error);
+    return NULL;
+  }
+  if (entries.empty()) {
+    return NULL;
+  }
+
+  size_t threadCount = std::max(1, numThreads);
+  threadCount = std::min(threadCount, entries.size());
+  threadCount = std::min(threadCount, std::max<size_t>(1, std::thread::hardware_concurrency()));
+
+  std::atomic<size_t> nextEntry(0);
+  std::atomic<size_t> firstFailure(entries.size());
+  auto worker = [&]() {
+    size_t i;
+    while ((i = nextEntry.fetch_add(1)) < entries.size()) {
+      if (firstFailure.load(std::memory_order_relaxed) < entries.size()) {
+        return;  // Another worker already found a bad entry.
+      }
+      if (ProcessZipEntryContents(handle, &entries[i].second, DiscardProcessFunction,
+                                  NULL) != 0) {
+        // Keep the earliest failure for a deterministic report.
+        size_t expected = entries.size();
+        while (expected > i && !firstFailure.compare_exchange_weak(expected, i)) {
+        }
+        return;
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < threadCount; ++t) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : workers) {
+    thread.join();
+  }
+
+  const size_t failed = firstFailure.load();
+  if (failed < entries.size()) {
+    return env->NewStringUTF(entries[failed].first.c_str());
+  }
+  return NULL;
+}
+
 jobject StrictJarFile_nativeFindEntry(JNIEnv* env, jobject, jlong nativeHandle,
                                              jstring entryName) {
   ScopedUtfChars entryNameChars(env, entryName);
@@ -151,6 +275,9 @@ JNINativeMethod gMethods[] = {
   NATIVE_METHOD(StrictJarFile, nativeOpenJarFile, "(Ljava/lang/String;I)J"),
   NATIVE_METHOD(StrictJarFile, nativeStartIteration, "(JLjava/lang/String;)J"),
   NATIVE_METHOD(StrictJarFile, nativeNextEntry, "(J)Ljava/util/zip/ZipEntry;"),
+  NATIVE_METHOD(StrictJarFile, nativeGetAllEntries,
+                "(JLjava/lang/String;)[Ljava/util/zip/ZipEntry;"),
+  NATIVE_METHOD(StrictJarFile, nativeVerifyEntries, "(JI)Ljava/lang/String;"),
   NATIVE_METHOD(StrictJarFile, nativeFindEntry, "(JLjava/lang/String;)Ljava/util/zip/ZipEntry;"),
   NATIVE_METHOD(StrictJarFile, nativeClose, "(J)V"),
 };
@@ -37,6 +37,7 @@
 #include <nativehelper/ScopedUtfChars.h>
 #include <private/gui/ComposerService.h>
 #include <stdio.h>
+#include <string.h>
 #include <system/graphics.h>
 #include <ui/ConfigStoreTypes.h>
 #include <ui/DeviceProductInfo.h>
@@ -385,6 +386,165 @@ static void nativeMergeTransaction(JNIEnv* env, jclass clazz,
     transaction->merge(std::move(*otherTransaction));
 }
 
+static void nativeClearTransaction(JNIEnv* env, jclass clazz, jlong transactionObj) {
+    auto transaction = reinterpret_cast<SurfaceComposerClient::Transaction*>(transactionObj);
+    transaction->clear();
+}
+
+/**
+ * Opcodes for nativeApplyBatch. Must match the managed batch writer. Each
+ * command is the opcode, the surface control pointer, then the listed args,
+ * one 64-bit word each; floats travel as their raw bits in the low 32 bits.
+ */
+enum {
+    BATCH_OP_SET_LAYER = 1,                          // zorder
+    BATCH_OP_SET_RELATIVE_LAYER = 2,                 // relative surface, zorder
+    BATCH_OP_SET_POSITION = 3,                       // x, y
+    BATCH_OP_SET_SIZE = 4,                           // w, h
+    BATCH_OP_SET_ALPHA = 5,                          // alpha
+    BATCH_OP_SET_MATRIX = 6,                         // dsdx, dtdx, dtdy, dsdy
+    BATCH_OP_SET_WINDOW_CROP = 7,                    // l, t, r, b
+    BATCH_OP_SET_CORNER_RADIUS = 8,                  // cornerRadius
+    BATCH_OP_SET_BACKGROUND_BLUR_RADIUS = 9,         // blurRadius
+    BATCH_OP_SET_SHADOW_RADIUS = 10,                 // shadowRadius
+    BATCH_OP_SET_FLAGS = 11,                         // flags, mask
+    BATCH_OP_SET_LAYER_STACK = 12,                   // layerStack
+    BATCH_OP_SET_COLOR = 13,                         // r, g, b
+    BATCH_OP_SET_FRAME_RATE_SELECTION_PRIORITY = 14, // priority
+};
+
+static inline float batchArgFloat(jlong word) {
+    float f;
+    int32_t bits = static_cast<int32_t>(word);
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+/**
+ * Replays a flat command buffer into the transaction with a single JNI
+ * transition, instead of one nativeSet* call per setter. Only scalar setters
+ * are batchable; setters taking objects keep their dedicated entry points.
+ */
+static void nativeApplyBatch(JNIEnv* env, jclass clazz, jlong transactionObj,
+        jlongArray commandArray, jint length) {
+    auto transaction = reinterpret_cast<SurfaceComposerClient::Transaction*>(transactionObj);
+
+    if (length < 0 || length > env->GetArrayLength(commandArray)) {
+        doThrowIAE(env, "length is out of bounds");
+        return;
+    }
+
+    // The setters below only mutate client-side state, so holding the array
+    // critically for the whole replay is safe.
+    jlong* words = static_cast<jlong*>(env->GetPrimitiveArrayCritical(commandArray, nullptr));
+    if (words == nullptr) {
+        return;
+    }
+
+    bool malformed = false;
+    jint pos = 0;
+    while (pos < length) {
+        jint argWords;
+        switch (words[pos]) {
+            case BATCH_OP_SET_LAYER:
+            case BATCH_OP_SET_ALPHA:
+            case BATCH_OP_SET_CORNER_RADIUS:
+            case BATCH_OP_SET_BACKGROUND_BLUR_RADIUS:
+            case BATCH_OP_SET_SHADOW_RADIUS:
+            case BATCH_OP_SET_LAYER_STACK:
+            case BATCH_OP_SET_FRAME_RATE_SELECTION_PRIORITY:
+                argWords = 1;
+                break;
+            case BATCH_OP_SET_RELATIVE_LAYER:
+            case BATCH_OP_SET_POSITION:
+            case BATCH_OP_SET_SIZE:
+            case BATCH_OP_SET_FLAGS:
+                argWords = 2;
+                break;
+            case BATCH_OP_SET_COLOR:
+                argWords = 3;
+                break;
+            case BATCH_OP_SET_MATRIX:
+            case BATCH_OP_SET_WINDOW_CROP:
+                argWords = 4;
+                break;
+            default:
+                argWords = -1;
+                break;
+        }
+        if (argWords < 0 || length - pos < 2 + argWords) {
+            malformed = true;
+            break;
+        }
+
+        SurfaceControl* const ctrl = reinterpret_cast<SurfaceControl*>(words[pos + 1]);
+        const jlong* args = &words[pos + 2];
+        switch (words[pos]) {
+            case BATCH_OP_SET_LAYER:
+                transaction->setLayer(ctrl, static_cast<int32_t>(args[0]));
+                break;
+            case BATCH_OP_SET_RELATIVE_LAYER: {
+                auto relative = reinterpret_cast<SurfaceControl*>(args[0]);
+                transaction->setRelativeLayer(ctrl, relative->getHandle(),
+                        static_cast<int32_t>(args[1]));
+                break;
+            }
+            case BATCH_OP_SET_POSITION:
+                transaction->setPosition(ctrl, batchArgFloat(args[0]), batchArgFloat(args[1]));
+                break;
+            case BATCH_OP_SET_SIZE:
+                transaction->setSize(ctrl, static_cast<int32_t>(args[0]),
+                        static_cast<int32_t>(args[1]));
+                break;
+            case BATCH_OP_SET_ALPHA:
+                transaction->setAlpha(ctrl, batchArgFloat(args[0]));
+                break;
+            case BATCH_OP_SET_MATRIX:
+                transaction->setMatrix(ctrl, batchArgFloat(args[0]), batchArgFloat(args[1]),
+                        batchArgFloat(args[2]), batchArgFloat(args[3]));
+                break;
+            case BATCH_OP_SET_WINDOW_CROP: {
+                Rect crop(static_cast<int32_t>(args[0]), static_cast<int32_t>(args[1]),
+                        static_cast<int32_t>(args[2]), static_cast<int32_t>(args[3]));
+                transaction->setCrop_legacy(ctrl, crop);
+                break;
+            }
+            case BATCH_OP_SET_CORNER_RADIUS:
+                transaction->setCornerRadius(ctrl, batchArgFloat(args[0]));
+                break;
+            case BATCH_OP_SET_BACKGROUND_BLUR_RADIUS:
+                transaction->setBackgroundBlurRadius(ctrl, static_cast<int32_t>(args[0]));
+                break;
+            case BATCH_OP_SET_SHADOW_RADIUS:
+                transaction->setShadowRadius(ctrl, batchArgFloat(args[0]));
+                break;
+            case BATCH_OP_SET_FLAGS:
+                transaction->setFlags(ctrl, static_cast<int32_t>(args[0]),
+                        static_cast<int32_t>(args[1]));
+                break;
+            case BATCH_OP_SET_LAYER_STACK:
+                transaction->setLayerStack(ctrl, static_cast<int32_t>(args[0]));
+                break;
+            case BATCH_OP_SET_COLOR: {
+                half3 color(batchArgFloat(args[0]), batchArgFloat(args[1]),
+                        batchArgFloat(args[2]));
+                transaction->setColor(ctrl, color);
+                break;
+            }
+            case BATCH_OP_SET_FRAME_RATE_SELECTION_PRIORITY:
+                transaction->setFrameRateSelectionPriority(ctrl,
+                        static_cast<int32_t>(args[0]));
+                break;
+        }
+        pos += 2 + argWords;
+    }
+
+    env->ReleasePrimitiveArrayCritical(commandArray, words, JNI_ABORT);
+    if (malformed) {
+        doThrowIAE(env, "malformed transaction command buffer");
+    }
+}
+
 static void nativeSetAnimationTransaction(JNIEnv* env, jclass clazz, jlong transactionObj) {
     auto transaction = reinterpret_cast<SurfaceComposerClient::Transaction*>(transactionObj);
     transaction->setAnimationTransaction();
@@ -1507,6 +1667,10 @@ static const JNINativeMethod sSurfaceControlMethods[] = {
             (void*)nativeGetNativeTransactionFinalizer },
     {"nativeMergeTransaction", "(JJ)V",
             (void*)nativeMergeTransaction },
+    {"nativeClearTransaction", "(J)V",
+            (void*)nativeClearTransaction },
+    {"nativeApplyBatch", "(J[JI)V",
+            (void*)nativeApplyBatch },
     {"nativeSetAnimationTransaction", "(J)V",
             (void*)nativeSetAnimationTransaction },
     {"nativeSetEarlyWakeup", "(J)V",
@@ -34,6 +34,7 @@
 #include <sys/types.h>
 #include <dirent.h>
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <functional>
@@ -111,6 +112,7 @@ using android::base::StringAppendF;
 using android::base::StringPrintf;
 using android::base::WriteStringToFile;
 using android::base::GetBoolProperty;
+using android::base::GetIntProperty;
 
 #define CREATE_ERROR(...) StringPrintf("%s:%d: ", __FILE__, __LINE__). \
                               append(StringPrintf(__VA_ARGS__))
@@ -305,6 +307,24 @@ class UsapTableEntry {
  */
 static std::array<UsapTableEntry, USAP_POOL_SIZE_MAX_LIMIT> gUsapTable;
 
+/**
+ * The number of recent USAP launches remembered for launch-rate tracking.
+ */
+static constexpr size_t USAP_LAUNCH_HISTORY_SIZE = 64;
+
+/**
+ * The window over which USAP launches are counted when computing the
+ * suggested pool size.
+ */
+static constexpr int64_t USAP_LAUNCH_RATE_WINDOW_MS = 10'000;
+
+/**
+ * A ring of CLOCK_MONOTONIC timestamps (milliseconds) of recent USAP
+ * launches.  Only accessed from the ZygoteServer poll loop thread.
+ */
+static std::array<int64_t, USAP_LAUNCH_HISTORY_SIZE> gUsapLaunchTimesMs = {};
+static size_t gUsapLaunchTimesIndex = 0;
+
 /**
  * The list of open zygote file descriptors.
  */
@@ -2316,7 +2336,18 @@ static jintArray com_android_internal_os_Zygote_nativeGetUsapPipeFDs(JNIEnv* env
 }
 
 /**
- * A JNI wrapper around RemoveUsapTableEntry.
+ * @return The current CLOCK_MONOTONIC time in milliseconds.
+ */
+static int64_t MonotonicTimeMs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1'000'000;
+}
+
+/**
+ * A JNI wrapper around RemoveUsapTableEntry.  Removals through this entry
+ * point come from the ZygoteServer poll loop when a USAP reports that it has
+ * specialized, so they are also recorded as launches for pool sizing.
  *
  * @param env  Managed runtime environment
  * @param usap_pid  Process ID of the USAP entry to invalidate
@@ -2324,7 +2355,12 @@ static jintArray com_android_internal_os_Zygote_nativeGetUsapPipeFDs(JNIEnv* env
  */
 static jboolean com_android_internal_os_Zygote_nativeRemoveUsapTableEntry(JNIEnv* env, jclass,
                                                                           jint usap_pid) {
-  return RemoveUsapTableEntry(usap_pid);
+  if (RemoveUsapTableEntry(usap_pid)) {
+    gUsapLaunchTimesMs[gUsapLaunchTimesIndex] = MonotonicTimeMs();
+    gUsapLaunchTimesIndex = (gUsapLaunchTimesIndex + 1) % gUsapLaunchTimesMs.size();
+    return JNI_TRUE;
+  }
+  return JNI_FALSE;
 }
 
 /**
@@ -2353,6 +2389,35 @@ static jint com_android_internal_os_Zygote_nativeGetUsapPoolCount(JNIEnv* env, j
   return gUsapPoolCount;
 }
 
+/**
+ * Computes a suggested USAP pool size from the recent launch rate: the number
+ * of USAPs consumed in the last USAP_LAUNCH_RATE_WINDOW_MS, clamped to the
+ * per-device bounds.  The bounds come from the runtime_native device config
+ * namespace, so they can be tuned per device without a system image change.
+ * Burst launches raise the suggestion, so refills fork ahead of demand; idle
+ * periods let it decay back to the minimum.
+ *
+ * @param env  Managed runtime environment
+ * @return The suggested number of USAPs to keep in the pool
+ */
+static jint com_android_internal_os_Zygote_nativeGetUsapPoolTargetSize(JNIEnv* env, jclass) {
+  int pool_size_min =
+      GetIntProperty("persist.device_config.runtime_native.usap_pool_size_min", 1);
+  int pool_size_max =
+      std::min(GetIntProperty("persist.device_config.runtime_native.usap_pool_size_max", 3),
+               USAP_POOL_SIZE_MAX_LIMIT);
+
+  const int64_t window_start = MonotonicTimeMs() - USAP_LAUNCH_RATE_WINDOW_MS;
+  int recent_launches = 0;
+  for (int64_t launch_time_ms : gUsapLaunchTimesMs) {
+    if (launch_time_ms > window_start) {
+      ++recent_launches;
+    }
+  }
+
+  return std::clamp(recent_launches, pool_size_min, pool_size_max);
+}
+
 /**
  * Kills all processes currently in the USAP pool and closes their read pipe
  * FDs.
@@ -2469,6 +2534,8 @@ static const JNINativeMethod gMethods[] = {
          (void*)com_android_internal_os_Zygote_nativeGetUsapPoolEventFD},
         {"nativeGetUsapPoolCount", "()I",
          (void*)com_android_internal_os_Zygote_nativeGetUsapPoolCount},
+        {"nativeGetUsapPoolTargetSize", "()I",
+         (void*)com_android_internal_os_Zygote_nativeGetUsapPoolTargetSize},
         {"nativeEmptyUsapPool", "()V", (void*)com_android_internal_os_Zygote_nativeEmptyUsapPool},
         {"nativeBlockSigTerm", "()V", (void*)com_android_internal_os_Zygote_nativeBlockSigTerm},
         {"nativeUnblockSigTerm", "()V", (void*)com_android_internal_os_Zygote_nativeUnblockSigTerm},
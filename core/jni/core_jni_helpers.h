@@ -22,6 +22,13 @@
 #include <nativehelper/scoped_utf_chars.h>
 #include <android_runtime/AndroidRuntime.h>
 
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 // Host targets (layoutlib) do not differentiate between regular and critical native methods,
 // and they need all the JNI methods to have JNIEnv* and jclass/jobject as their first two arguments.
 // The following macro allows to have those arguments when compiling for host while omitting them when
@@ -90,6 +97,93 @@ static inline int RegisterMethodsOrDie(JNIEnv* env, const char* className,
     return res;
 }
 
+/**
+ * Lazily-resolved, process-wide cache for a static Java callback method.
+ *
+ * Registration-time id caching (the OrDie helpers above) does not cover
+ * native->Java callbacks that fire on binder or media threads, and several of
+ * those historically re-ran FindClass/GetStaticMethodID on every invocation.
+ * A CachedJniStaticMethod resolves once on first use from whichever thread
+ * calls it, promotes the class to a global ref, and counts cache hits vs
+ * resolutions so regressions show up in the audit dump
+ * (DumpCachedJniStaticMethods below).
+ *
+ * Instances are expected to be file-scope statics next to their call site.
+ */
+class CachedJniStaticMethod {
+public:
+    CachedJniStaticMethod(const char* class_name, const char* method_name,
+                          const char* method_signature)
+        : class_name_(class_name), method_name_(method_name),
+          method_signature_(method_signature) {
+        std::lock_guard<std::mutex> guard(RegistryLock());
+        Registry().push_back(this);
+    }
+
+    jclass GetClass(JNIEnv* env) {
+        Resolve(env);
+        return class_.load(std::memory_order_relaxed);
+    }
+
+    jmethodID Get(JNIEnv* env) {
+        Resolve(env);
+        return method_;
+    }
+
+    static void Dump(int fd) {
+        std::lock_guard<std::mutex> guard(RegistryLock());
+        dprintf(fd, "Cached JNI static methods (%zu):\n", Registry().size());
+        for (const CachedJniStaticMethod* method : Registry()) {
+            dprintf(fd, "  %s.%s: %" PRIu64 " hits, %" PRIu64 " resolutions\n",
+                    method->class_name_, method->method_name_,
+                    method->hits_.load(std::memory_order_relaxed),
+                    method->resolutions_.load(std::memory_order_relaxed));
+        }
+    }
+
+private:
+    void Resolve(JNIEnv* env) {
+        if (class_.load(std::memory_order_acquire) != nullptr) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::lock_guard<std::mutex> guard(lock_);
+        if (class_.load(std::memory_order_relaxed) != nullptr) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        resolutions_.fetch_add(1, std::memory_order_relaxed);
+        jclass clazz = FindClassOrDie(env, class_name_);
+        method_ = GetStaticMethodIDOrDie(env, clazz, method_name_, method_signature_);
+        // Publish the class last: once it is visible the method id is too.
+        class_.store(MakeGlobalRefOrDie(env, clazz), std::memory_order_release);
+    }
+
+    // Single per-process registry shared by every translation unit.
+    static std::mutex& RegistryLock() {
+        static std::mutex lock;
+        return lock;
+    }
+    static std::vector<const CachedJniStaticMethod*>& Registry() {
+        static std::vector<const CachedJniStaticMethod*> registry;
+        return registry;
+    }
+
+    const char* const class_name_;
+    const char* const method_name_;
+    const char* const method_signature_;
+
+    std::mutex lock_;
+    std::atomic<jclass> class_{nullptr};
+    jmethodID method_ = nullptr;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> resolutions_{0};
+};
+
+static inline void DumpCachedJniStaticMethods(int fd) {
+    CachedJniStaticMethod::Dump(fd);
+}
+
 /**
  * Read the specified field from jobject, and convert to std::string.
  * If the field cannot be obtained, return defaultValue.
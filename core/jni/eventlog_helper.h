@@ -219,6 +219,106 @@ public:
         }
     }
 
+    // Drains every available record into a caller-provided direct buffer in
+    // one native call. Records are packed back to back as raw logger entries;
+    // jOffsets receives the start offset of each record plus one final entry
+    // holding the end of the last record, so record i spans
+    // [offsets[i], offsets[i + 1]). Returns the number of records written.
+    // The caller decodes records (and creates strings) lazily on access.
+    // Stops early when either the buffer or the index fills; the remaining
+    // records are picked up by the next call.
+    static jint readEventsBatch(JNIEnv* env, int loggerMode, jintArray jTags, jlong startTime,
+            jobject jBuffer, jintArray jOffsets) {
+        uint8_t* buffer = static_cast<uint8_t*>(env->GetDirectBufferAddress(jBuffer));
+        const jlong capacity = env->GetDirectBufferCapacity(jBuffer);
+        if (buffer == nullptr || capacity < 0) {
+            jniThrowException(env, "java/lang/IllegalArgumentException",
+                    "buffer must be a direct ByteBuffer");
+            return -1;
+        }
+        const jsize maxOffsets = env->GetArrayLength(jOffsets);
+        if (maxOffsets < 2) {
+            jniThrowException(env, "java/lang/IllegalArgumentException",
+                    "offset index must hold at least two entries");
+            return -1;
+        }
+
+        std::unique_ptr<struct logger_list, decltype(&android_logger_list_close)> logger_list(
+                nullptr, android_logger_list_close);
+        if (startTime) {
+            logger_list.reset(android_logger_list_alloc_time(loggerMode,
+                    log_time(startTime / NS_PER_SEC, startTime % NS_PER_SEC), 0));
+        } else {
+            logger_list.reset(android_logger_list_alloc(loggerMode, 0, 0));
+        }
+        if (!logger_list) {
+            jniThrowIOException(env, errno);
+            return -1;
+        }
+
+        if (!android_logger_open(logger_list.get(), LogID)) {
+            jniThrowIOException(env, errno);
+            return -1;
+        }
+
+        ScopedIntArrayRO tags(env);
+        if (jTags != nullptr) {
+            tags.reset(jTags);
+        }
+        ScopedIntArrayRW offsets(env, jOffsets);
+        if (offsets.get() == nullptr) {
+            return -1;
+        }
+
+        jint count = 0;
+        jlong used = 0;
+        while (count + 1 < maxOffsets) {
+            log_msg log_msg;
+            int ret = android_logger_list_read(logger_list.get(), &log_msg);
+
+            if (ret == 0 || ret == -EAGAIN) {
+                break;
+            }
+            if (ret < 0) {
+                if (ret == -EINTR) {
+                    continue;
+                }
+                if (ret == -EINVAL) {
+                    jniThrowException(env, "java/io/IOException", "Event too short");
+                } else {
+                    jniThrowIOException(env, -ret);
+                }
+                return -1;
+            }
+
+            if (log_msg.id() != LogID) {
+                continue;
+            }
+
+            int32_t tag = * (int32_t *) log_msg.msg();
+
+            if (jTags != nullptr) {
+                bool found = false;
+                for (size_t i = 0; !found && i < tags.size(); ++i) {
+                    found = (tag == tags[i]);
+                }
+                if (!found) {
+                    continue;
+                }
+            }
+
+            if (used + ret > capacity) {
+                break;
+            }
+            offsets[count] = (jint)used;
+            memcpy(buffer + used, log_msg.buf, ret);
+            used += ret;
+            ++count;
+        }
+        offsets[count] = (jint)used;
+        return count;
+    }
+
 private:
     static jclass gCollectionClass;
     static jmethodID gCollectionAddID;
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ANDROID_GPU_CAPABILITY_SNAPSHOT_H
+#define _ANDROID_GPU_CAPABILITY_SNAPSHOT_H
+
+#include <stdint.h>
+
+namespace android {
+
+// On-disk layout of the boot-persisted GPU capability snapshot. GpuService
+// writes the file atomically (temp file + rename) once per boot; app
+// processes map it read-only through GraphicsEnvironment, so driver version
+// and ANGLE eligibility checks during app launch are a shared-memory read
+// instead of a round of driver probing.
+//
+// The header is followed by a string table; all offsets are relative to the
+// start of the file. Bump GPU_CAPS_VERSION on any layout change.
+
+constexpr uint32_t GPU_CAPS_MAGIC = 0x47504331; // 'GPC1'
+constexpr uint32_t GPU_CAPS_VERSION = 1;
+
+constexpr uint32_t GPU_CAPS_FLAG_ANGLE_SUPPORTED = 1u << 0;
+
+struct GpuCapabilitySnapshot {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t totalSize; // header plus string table
+    uint32_t flags;     // GPU_CAPS_FLAG_*
+    int64_t driverVersionCode;
+    int64_t driverBuildTime;
+    uint32_t driverVersionNameOffset;
+    uint32_t driverVersionNameLength;
+    uint32_t extensionsOffset;
+    uint32_t extensionsLength;
+};
+
+} // namespace android
+
+#endif // _ANDROID_GPU_CAPABILITY_SNAPSHOT_H
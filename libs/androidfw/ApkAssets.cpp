@@ -17,6 +17,8 @@
 #include "androidfw/ApkAssets.h"
 
 #include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include "android-base/errors.h"
 #include "android-base/file.h"
@@ -399,6 +401,45 @@ std::unique_ptr<const ApkAssets> ApkAssets::LoadOverlay(const std::string& idmap
                   : nullptr;
 }
 
+std::vector<std::unique_ptr<const ApkAssets>> ApkAssets::LoadMany(
+    const std::vector<LoadParams>& requests, size_t max_threads) {
+  std::vector<std::unique_ptr<const ApkAssets>> results(requests.size());
+
+  const auto load_one = [&requests, &results](size_t i) {
+    const LoadParams& request = requests[i];
+    results[i] = request.overlay ? LoadOverlay(request.path, request.flags)
+                                 : Load(request.path, request.flags);
+  };
+
+  size_t thread_count = max_threads != 0U ? max_threads
+                                          : std::max(1U, std::thread::hardware_concurrency() / 2U);
+  thread_count = std::min(thread_count, requests.size());
+  if (thread_count <= 1U || requests.size() < 4U) {
+    for (size_t i = 0; i < requests.size(); i++) {
+      load_one(i);
+    }
+    return results;
+  }
+
+  // Each worker claims the next unloaded index; every result lands in its own slot, so the
+  // output order (and thus the caller's cookie assignment) is independent of scheduling.
+  std::atomic<size_t> next_index(0);
+  std::vector<std::thread> workers;
+  workers.reserve(thread_count);
+  for (size_t t = 0; t < thread_count; t++) {
+    workers.emplace_back([&load_one, &next_index, count = requests.size()]() {
+      size_t i;
+      while ((i = next_index.fetch_add(1, std::memory_order_relaxed)) < count) {
+        load_one(i);
+      }
+    });
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  return results;
+}
+
 std::unique_ptr<const ApkAssets> ApkAssets::LoadFromDir(
     const std::string& path, const package_property_t flags,
     std::unique_ptr<const AssetsProvider> override_asset) {
@@ -247,7 +247,7 @@ bool AssetManager::addOverlayPath(const String8& packagePath, int32_t* cookie)
      }
 
     Asset* idmap = NULL;
-    if ((idmap = openAssetFromFileLocked(idmapPath, Asset::ACCESS_BUFFER)) == NULL) {
+    if ((idmap = openAssetFromFile(idmapPath, Asset::ACCESS_BUFFER)) == NULL) {
         ALOGW("failed to open idmap file %s\n", idmapPath.string());
         return false;
     }
@@ -340,7 +340,7 @@ bool AssetManager::createIdmap(const char* targetApkPath, const char* overlayApk
             asset_path ap;
             ap.type = kFileTypeRegular;
             ap.path = paths[i];
-            assets[i] = openNonAssetInPathLocked("resources.arsc",
+            assets[i] = openNonAssetInPath("resources.arsc",
                     Asset::ACCESS_BUFFER, ap);
             if (assets[i] == NULL) {
                 ALOGW("failed to find resources.arsc in %s\n", ap.path.string());
@@ -434,24 +434,25 @@ void AssetManager::getConfiguration(ResTable_config* outConfig) const
  */
 Asset* AssetManager::open(const char* fileName, AccessMode mode)
 {
-    AutoMutex _l(mLock);
+    Vector<asset_path> assetPaths = snapshotAssetPaths();
 
-    LOG_FATAL_IF(mAssetPaths.size() == 0, "No assets added to AssetManager");
+    LOG_FATAL_IF(assetPaths.size() == 0, "No assets added to AssetManager");
 
     String8 assetName(kAssetsRoot);
     assetName.appendPath(fileName);
 
     /*
-     * For each top-level asset path, search for the asset.
+     * For each top-level asset path, search for the asset.  The search runs
+     * on the snapshot, without mLock, so concurrent opens don't serialize.
      */
 
-    size_t i = mAssetPaths.size();
+    size_t i = assetPaths.size();
     while (i > 0) {
         i--;
         ALOGV("Looking for asset '%s' in '%s'\n",
-                assetName.string(), mAssetPaths.itemAt(i).path.string());
-        Asset* pAsset = openNonAssetInPathLocked(assetName.string(), mode,
-                mAssetPaths.editItemAt(i));
+                assetName.string(), assetPaths.itemAt(i).path.string());
+        Asset* pAsset = openNonAssetInPath(assetName.string(), mode,
+                assetPaths.editItemAt(i));
         if (pAsset != NULL) {
             return pAsset != kExcludedAsset ? pAsset : NULL;
         }
@@ -467,20 +468,20 @@ Asset* AssetManager::open(const char* fileName, AccessMode mode)
  */
 Asset* AssetManager::openNonAsset(const char* fileName, AccessMode mode, int32_t* outCookie)
 {
-    AutoMutex _l(mLock);
+    Vector<asset_path> assetPaths = snapshotAssetPaths();
 
-    LOG_FATAL_IF(mAssetPaths.size() == 0, "No assets added to AssetManager");
+    LOG_FATAL_IF(assetPaths.size() == 0, "No assets added to AssetManager");
 
     /*
      * For each top-level asset path, search for the asset.
      */
 
-    size_t i = mAssetPaths.size();
+    size_t i = assetPaths.size();
     while (i > 0) {
         i--;
-        ALOGV("Looking for non-asset '%s' in '%s'\n", fileName, mAssetPaths.itemAt(i).path.string());
-        Asset* pAsset = openNonAssetInPathLocked(
-            fileName, mode, mAssetPaths.editItemAt(i));
+        ALOGV("Looking for non-asset '%s' in '%s'\n", fileName, assetPaths.itemAt(i).path.string());
+        Asset* pAsset = openNonAssetInPath(
+            fileName, mode, assetPaths.editItemAt(i));
         if (pAsset != NULL) {
             if (outCookie != NULL) *outCookie = static_cast<int32_t>(i + 1);
             return pAsset != kExcludedAsset ? pAsset : NULL;
@@ -494,15 +495,15 @@ Asset* AssetManager::openNonAsset(const int32_t cookie, const char* fileName, Ac
 {
     const size_t which = static_cast<size_t>(cookie) - 1;
 
-    AutoMutex _l(mLock);
+    Vector<asset_path> assetPaths = snapshotAssetPaths();
 
-    LOG_FATAL_IF(mAssetPaths.size() == 0, "No assets added to AssetManager");
+    LOG_FATAL_IF(assetPaths.size() == 0, "No assets added to AssetManager");
 
-    if (which < mAssetPaths.size()) {
+    if (which < assetPaths.size()) {
         ALOGV("Looking for non-asset '%s' in '%s'\n", fileName,
-                mAssetPaths.itemAt(which).path.string());
-        Asset* pAsset = openNonAssetInPathLocked(
-            fileName, mode, mAssetPaths.editItemAt(which));
+                assetPaths.itemAt(which).path.string());
+        Asset* pAsset = openNonAssetInPath(
+            fileName, mode, assetPaths.editItemAt(which));
         if (pAsset != NULL) {
             return pAsset != kExcludedAsset ? pAsset : NULL;
         }
@@ -511,6 +512,26 @@ Asset* AssetManager::openNonAsset(const int32_t cookie, const char* fileName, Ac
     return NULL;
 }
 
+/*
+ * Copy the asset path list so a search can proceed without holding mLock.
+ *
+ * Fd-backed zips are resolved here, under the lock, because SharedZip::create
+ * takes ownership of the fd and therefore must run exactly once per entry.
+ * Path-backed zips are resolved lazily through the thread-safe ZipSet.
+ */
+Vector<AssetManager::asset_path> AssetManager::snapshotAssetPaths()
+{
+    AutoMutex _l(mLock);
+    const size_t N = mAssetPaths.size();
+    for (size_t i = 0; i < N; i++) {
+        asset_path& ap = mAssetPaths.editItemAt(i);
+        if (ap.type != kFileTypeDirectory && ap.zip == NULL && ap.rawFd >= 0) {
+            ap.zip = SharedZip::create(ap.rawFd, ap.path);
+        }
+    }
+    return mAssetPaths;
+}
+
 /*
  * Get the type of a file in the asset namespace.
  *
@@ -567,7 +588,7 @@ bool AssetManager::appendPathToResTable(asset_path& ap, bool appAsLib) const {
             if (ass == NULL) {
                 ALOGV("loading resource table %s\n", ap.path.string());
                 ass = const_cast<AssetManager*>(this)->
-                    openNonAssetInPathLocked("resources.arsc",
+                    openNonAssetInPath("resources.arsc",
                                              Asset::ACCESS_BUFFER,
                                              ap);
                 if (ass != NULL && ass != kExcludedAsset) {
@@ -598,7 +619,7 @@ bool AssetManager::appendPathToResTable(asset_path& ap, bool appAsLib) const {
     } else {
         ALOGV("loading resource table %s\n", ap.path.string());
         ass = const_cast<AssetManager*>(this)->
-            openNonAssetInPathLocked("resources.arsc",
+            openNonAssetInPath("resources.arsc",
                                      Asset::ACCESS_BUFFER,
                                      ap);
         shared = false;
@@ -690,7 +711,7 @@ Asset* AssetManager::openIdmapLocked(const struct asset_path& ap) const
     Asset* ass = NULL;
     if (ap.idmap.size() != 0) {
         ass = const_cast<AssetManager*>(this)->
-            openAssetFromFileLocked(ap.idmap, Asset::ACCESS_BUFFER);
+            openAssetFromFile(ap.idmap, Asset::ACCESS_BUFFER);
         if (ass) {
             ALOGV("loading idmap %s\n", ap.idmap.string());
         } else {
@@ -732,7 +753,7 @@ void AssetManager::addSystemOverlays(const char* pathOverlaysList,
         oap.isSystemOverlay = true;
 
         Asset* oass = const_cast<AssetManager*>(this)->
-            openNonAssetInPathLocked("resources.arsc",
+            openNonAssetInPath("resources.arsc",
                     Asset::ACCESS_BUFFER,
                     oap);
 
@@ -779,7 +800,7 @@ void AssetManager::getLocales(Vector<String8>* locales, bool includeSystemLocale
  * Pass in a NULL values for "appName" if the common app directory should
  * be used.
  */
-Asset* AssetManager::openNonAssetInPathLocked(const char* fileName, AccessMode mode,
+Asset* AssetManager::openNonAssetInPath(const char* fileName, AccessMode mode,
     asset_path& ap)
 {
     Asset* pAsset = NULL;
@@ -791,12 +812,12 @@ Asset* AssetManager::openNonAssetInPathLocked(const char* fileName, AccessMode m
         String8 path(ap.path);
         path.appendPath(fileName);
 
-        pAsset = openAssetFromFileLocked(path, mode);
+        pAsset = openAssetFromFile(path, mode);
 
         if (pAsset == NULL) {
             /* try again, this time with ".gz" */
             path.append(".gz");
-            pAsset = openAssetFromFileLocked(path, mode);
+            pAsset = openAssetFromFile(path, mode);
         }
 
         if (pAsset != NULL) {
@@ -809,13 +830,13 @@ Asset* AssetManager::openNonAssetInPathLocked(const char* fileName, AccessMode m
         String8 path(fileName);
 
         /* check the appropriate Zip file */
-        ZipFileRO* pZip = getZipFileLocked(ap);
+        ZipFileRO* pZip = getZipFile(ap);
         if (pZip != NULL) {
             ALOGV("GOT zip, checking NA '%s'", (const char*) path);
             ZipEntryRO entry = pZip->findEntryByName(path.string());
             if (entry != NULL) {
                 ALOGV("FOUND NA in Zip file for %s", (const char*) path);
-                pAsset = openAssetFromZipLocked(pZip, entry, mode, path);
+                pAsset = openAssetFromZip(pZip, entry, mode, path);
                 pZip->releaseEntry(entry);
             }
         }
@@ -861,19 +882,21 @@ String8 AssetManager::createPathNameLocked(const asset_path& ap, const char* roo
  * Return a pointer to one of our open Zip archives.  Returns NULL if no
  * matching Zip file exists.
  */
-ZipFileRO* AssetManager::getZipFileLocked(asset_path& ap)
+ZipFileRO* AssetManager::getZipFile(asset_path& ap)
 {
-    ALOGV("getZipFileLocked() in %p: ap=%p zip=%p", this, &ap, ap.zip.get());
+    ALOGV("getZipFile() in %p: ap=%p zip=%p", this, &ap, ap.zip.get());
 
     if (ap.zip != NULL) {
         return ap.zip->getZip();
     }
 
     if (ap.rawFd < 0) {
-        ALOGV("getZipFileLocked: Creating new zip from path %s", ap.path.string());
+        ALOGV("getZipFile: Creating new zip from path %s", ap.path.string());
         ap.zip = mZipSet.getSharedZip(ap.path);
     } else {
-        ALOGV("getZipFileLocked: Creating new zip from fd %d", ap.rawFd);
+        // Only reached with mLock held; snapshotAssetPaths() resolves
+        // fd-backed entries before a lock-free search starts.
+        ALOGV("getZipFile: Creating new zip from fd %d", ap.rawFd);
         ap.zip = SharedZip::create(ap.rawFd, ap.path);
 
     }
@@ -892,7 +915,7 @@ ZipFileRO* AssetManager::getZipFileLocked(asset_path& ap)
  * This returns NULL if the file doesn't exist, couldn't be opened, or
  * claims to be a ".gz" but isn't.
  */
-Asset* AssetManager::openAssetFromFileLocked(const String8& pathName,
+Asset* AssetManager::openAssetFromFile(const String8& pathName,
     AccessMode mode)
 {
     Asset* pAsset = NULL;
@@ -914,7 +937,7 @@ Asset* AssetManager::openAssetFromFileLocked(const String8& pathName,
  * If the entry is uncompressed, we may want to create or share a
  * slice of shared memory.
  */
-Asset* AssetManager::openAssetFromZipLocked(const ZipFileRO* pZipFile,
+Asset* AssetManager::openAssetFromZip(const ZipFileRO* pZipFile,
     const ZipEntryRO entry, AccessMode mode, const String8& entryName)
 {
     Asset* pAsset = NULL;
@@ -1452,16 +1475,28 @@ AssetManager::SharedZip::SharedZip(int fd, const String8& path)
 sp<AssetManager::SharedZip> AssetManager::SharedZip::get(const String8& path,
         bool createIfNotPresent)
 {
-    AutoMutex _l(gLock);
     time_t modWhen = getFileModDate(path);
-    sp<SharedZip> zip = gOpen.valueFor(path).promote();
-    if (zip != NULL && zip->mModWhen == modWhen) {
-        return zip;
+    {
+        AutoMutex _l(gLock);
+        sp<SharedZip> zip = gOpen.valueFor(path).promote();
+        if (zip != NULL && zip->mModWhen == modWhen) {
+            return zip;
+        }
+        if (zip == NULL && !createIfNotPresent) {
+            return NULL;
+        }
     }
-    if (zip == NULL && !createIfNotPresent) {
-        return NULL;
+
+    // Parse the central directory without holding the global lock, so other
+    // threads' registry lookups don't stall behind this zip's open.
+    sp<SharedZip> zip = new SharedZip(path, modWhen);
+
+    AutoMutex _l(gLock);
+    sp<SharedZip> existing = gOpen.valueFor(path).promote();
+    if (existing != NULL && existing->mModWhen == modWhen) {
+        // Another thread opened the same zip while we were parsing.
+        return existing;
     }
-    zip = new SharedZip(path, modWhen);
     gOpen.add(path, zip);
     return zip;
 }
@@ -1562,21 +1597,12 @@ AssetManager::SharedZip::~SharedZip()
  */
 
 /*
- * Destructor.  Close any open archives.
+ * Grab the current snapshot.  The lock only covers the pointer copy.
  */
-AssetManager::ZipSet::~ZipSet(void)
+sp<const AssetManager::ZipSet::Snapshot> AssetManager::ZipSet::getSnapshot() const
 {
-    size_t N = mZipFile.size();
-    for (size_t i = 0; i < N; i++)
-        closeZip(i);
-}
-
-/*
- * Close a Zip file and reset the entry.
- */
-void AssetManager::ZipSet::closeZip(int idx)
-{
-    mZipFile.editItemAt(idx) = NULL;
+    AutoMutex _l(mLock);
+    return mSnapshot;
 }
 
 /*
@@ -1589,53 +1615,62 @@ ZipFileRO* AssetManager::ZipSet::getZip(const String8& path)
 
 const sp<AssetManager::SharedZip> AssetManager::ZipSet::getSharedZip(const String8& path)
 {
-    int idx = getIndex(path);
-    sp<SharedZip> zip = mZipFile[idx];
-    if (zip == NULL) {
-        zip = SharedZip::get(path);
-        mZipFile.editItemAt(idx) = zip;
+    sp<const Snapshot> snapshot = getSnapshot();
+    if (snapshot != NULL) {
+        const size_t N = snapshot->paths.size();
+        for (size_t i = 0; i < N; i++) {
+            if (snapshot->paths[i] == path) {
+                return snapshot->zips[i];
+            }
+        }
+    }
+
+    // Resolve the zip without holding the set's lock, then publish a new
+    // snapshot with it added.  If another thread raced us, keep its entry.
+    sp<SharedZip> zip = SharedZip::get(path);
+
+    AutoMutex _l(mLock);
+    const sp<const Snapshot> current = mSnapshot;
+    if (current != NULL) {
+        const size_t N = current->paths.size();
+        for (size_t i = 0; i < N; i++) {
+            if (current->paths[i] == path) {
+                return current->zips[i];
+            }
+        }
     }
+
+    sp<Snapshot> updated = new Snapshot();
+    if (current != NULL) {
+        updated->paths = current->paths;
+        updated->zips = current->zips;
+    }
+    updated->paths.add(path);
+    updated->zips.add(zip);
+    mSnapshot = updated;
     return zip;
 }
 
 Asset* AssetManager::ZipSet::getZipResourceTableAsset(const String8& path)
 {
-    int idx = getIndex(path);
-    sp<SharedZip> zip = mZipFile[idx];
-    if (zip == NULL) {
-        zip = SharedZip::get(path);
-        mZipFile.editItemAt(idx) = zip;
-    }
-    return zip->getResourceTableAsset();
+    return getSharedZip(path)->getResourceTableAsset();
 }
 
 Asset* AssetManager::ZipSet::setZipResourceTableAsset(const String8& path,
                                                  Asset* asset)
 {
-    int idx = getIndex(path);
-    sp<SharedZip> zip = mZipFile[idx];
-    // doesn't make sense to call before previously accessing.
-    return zip->setResourceTableAsset(asset);
+    return getSharedZip(path)->setResourceTableAsset(asset);
 }
 
 ResTable* AssetManager::ZipSet::getZipResourceTable(const String8& path)
 {
-    int idx = getIndex(path);
-    sp<SharedZip> zip = mZipFile[idx];
-    if (zip == NULL) {
-        zip = SharedZip::get(path);
-        mZipFile.editItemAt(idx) = zip;
-    }
-    return zip->getResourceTable();
+    return getSharedZip(path)->getResourceTable();
 }
 
 ResTable* AssetManager::ZipSet::setZipResourceTable(const String8& path,
                                                     ResTable* res)
 {
-    int idx = getIndex(path);
-    sp<SharedZip> zip = mZipFile[idx];
-    // doesn't make sense to call before previously accessing.
-    return zip->setResourceTable(res);
+    return getSharedZip(path)->setResourceTable(res);
 }
 
 /*
@@ -1651,9 +1686,13 @@ ResTable* AssetManager::ZipSet::setZipResourceTable(const String8& path,
 
 bool AssetManager::ZipSet::isUpToDate()
 {
-    const size_t N = mZipFile.size();
+    sp<const Snapshot> snapshot = getSnapshot();
+    if (snapshot == NULL) {
+        return true;
+    }
+    const size_t N = snapshot->zips.size();
     for (size_t i=0; i<N; i++) {
-        if (mZipFile[i] != NULL && !mZipFile[i]->isUpToDate()) {
+        if (snapshot->zips[i] != NULL && !snapshot->zips[i]->isUpToDate()) {
             return false;
         }
     }
@@ -1662,9 +1701,7 @@ bool AssetManager::ZipSet::isUpToDate()
 
 void AssetManager::ZipSet::addOverlay(const String8& path, const asset_path& overlay)
 {
-    int idx = getIndex(path);
-    sp<SharedZip> zip = mZipFile[idx];
-    zip->addOverlay(overlay);
+    getSharedZip(path)->addOverlay(overlay);
 }
 
 bool AssetManager::ZipSet::getOverlay(const String8& path, size_t idx, asset_path* out) const
@@ -1675,24 +1712,3 @@ bool AssetManager::ZipSet::getOverlay(const String8& path, size_t idx, asset_pat
     }
     return zip->getOverlay(idx, out);
 }
-
-/*
- * Compute the zip file's index.
- *
- * "appName", "locale", and "vendor" should be set to NULL to indicate the
- * default directory.
- */
-int AssetManager::ZipSet::getIndex(const String8& zip) const
-{
-    const size_t N = mZipPath.size();
-    for (size_t i=0; i<N; i++) {
-        if (mZipPath[i] == zip) {
-            return i;
-        }
-    }
-
-    mZipPath.add(zip);
-    mZipFile.add(NULL);
-
-    return mZipPath.size()-1;
-}
@@ -38,34 +38,6 @@
 
 namespace android {
 
-struct FindEntryResult {
-  // A pointer to the resource table entry for this resource.
-  // If the size of the entry is > sizeof(ResTable_entry), it can be cast to
-  // a ResTable_map_entry and processed as a bag/map.
-  ResTable_entry_handle entry;
-
-  // The configuration for which the resulting entry was defined. This is already swapped to host
-  // endianness.
-  ResTable_config config;
-
-  // The bitmask of configuration axis with which the resource value varies.
-  uint32_t type_flags;
-
-  // The dynamic package ID map for the package from which this resource came from.
-  const DynamicRefTable* dynamic_ref_table;
-
-  // The package name of the resource.
-  const std::string* package_name;
-
-  // The string pool reference to the type's name. This uses a different string pool than
-  // the global string pool, but this is hidden from the caller.
-  StringPoolRef type_string_ref;
-
-  // The string pool reference to the entry's name. This uses a different string pool than
-  // the global string pool, but this is hidden from the caller.
-  StringPoolRef entry_string_ref;
-};
-
 AssetManager2::AssetManager2() {
   memset(&configuration_, 0, sizeof(configuration_));
 }
@@ -524,6 +496,20 @@ ApkAssetsCookie AssetManager2::FindEntry(uint32_t resid, uint16_t density_overri
     desired_config = &density_override_config;
   }
 
+  // Resolutions against the set configuration are cached, so repeated lookups of the same
+  // resource ID cost a single hash probe instead of a package-group scan. Lookups that
+  // override the density or ignore the configuration bypass the cache, as does resolution
+  // logging, which needs to observe every step.
+  const bool use_resolution_cache = desired_config == &configuration_ && !ignore_configuration &&
+                                    !resource_resolution_logging_enabled_;
+  if (use_resolution_cache) {
+    const auto cached = cached_resolved_entries_.find(resid);
+    if (cached != cached_resolved_entries_.cend()) {
+      *out_entry = cached->second.second;
+      return cached->second.first;
+    }
+  }
+
   // Retrieve the package group from the package id of the resource id.
   if (!is_valid_resid(resid)) {
     LOG(ERROR) << base::StringPrintf("Invalid ID 0x%08x.", resid);
@@ -597,6 +583,10 @@ ApkAssetsCookie AssetManager2::FindEntry(uint32_t resid, uint16_t density_overri
     last_resolution_.entry_string_ref = out_entry->entry_string_ref;
   }
 
+  if (use_resolution_cache) {
+    cached_resolved_entries_[resid] = std::make_pair(cookie, *out_entry);
+  }
+
   return cookie;
 }
 
@@ -1296,6 +1286,7 @@ void AssetManager2::InvalidateCaches(uint32_t diff) {
   if (diff == 0xffffffffu) {
     // Everything must go.
     cached_bags_.clear();
+    cached_resolved_entries_.clear();
     return;
   }
 
@@ -1308,6 +1299,16 @@ void AssetManager2::InvalidateCaches(uint32_t diff) {
       ++iter;
     }
   }
+
+  // Same treatment for cached resolutions: only purge entries whose value could change
+  // with respect to the configuration axis that changed.
+  for (auto iter = cached_resolved_entries_.cbegin(); iter != cached_resolved_entries_.cend();) {
+    if (diff & iter->second.second.type_flags) {
+      iter = cached_resolved_entries_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
 }
 
 uint8_t AssetManager2::GetAssignedPackageId(const LoadedPackage* package) const {
@@ -1345,12 +1346,26 @@ struct ThemeType {
 
 constexpr size_t kTypeCount = std::numeric_limits<uint8_t>::max() + 1;
 
+// Allocates a zeroed ThemeType with space for `entry_count` entries stored
+// contiguously after it. The result may be shared between Theme instances by
+// SetTo(); free() is the matching deleter for the single allocation.
+std::shared_ptr<ThemeType> MakeThemeType(int entry_count) {
+  auto type = reinterpret_cast<ThemeType*>(
+      calloc(sizeof(ThemeType) + entry_count * sizeof(ThemeEntry), 1));
+  type->entry_count = entry_count;
+  return std::shared_ptr<ThemeType>(type, free);
+}
+
 }  // namespace
 
 struct Theme::Package {
   // Each element of Type will be a dynamically sized object
   // allocated to have the entries stored contiguously with the Type.
-  std::array<util::unique_cptr<ThemeType>, kTypeCount> types;
+  // The entry tables are shared between Themes of the same AssetManager after
+  // SetTo() and copied on the first subsequent write; Themes that share tables
+  // are externally synchronized through their AssetManager, like all other
+  // AssetManager2 state.
+  std::array<std::shared_ptr<ThemeType>, kTypeCount> types;
 };
 
 bool Theme::ApplyStyle(uint32_t resid, bool force) {
@@ -1401,24 +1416,18 @@ bool Theme::ApplyStyle(uint32_t resid, bool force) {
     }
 
     if (last_type_idx != type_idx) {
-      util::unique_cptr<ThemeType>& type = last_package->types[type_idx];
+      std::shared_ptr<ThemeType>& type = last_package->types[type_idx];
       if (type == nullptr) {
         // Allocate enough memory to contain this entry_idx. Since we're iterating in reverse over
         // a sorted list of attributes, this shouldn't be resized again during this method call.
-        type.reset(reinterpret_cast<ThemeType*>(
-            calloc(sizeof(ThemeType) + (entry_idx + 1) * sizeof(ThemeEntry), 1)));
-        type->entry_count = entry_idx + 1;
-      } else if (entry_idx >= type->entry_count) {
-        // Reallocate the memory to contain this entry_idx. Since we're iterating in reverse over
-        // a sorted list of attributes, this shouldn't be resized again during this method call.
-        const int new_count = entry_idx + 1;
-        type.reset(reinterpret_cast<ThemeType*>(
-            realloc(type.release(), sizeof(ThemeType) + (new_count * sizeof(ThemeEntry)))));
-
-        // Clear out the newly allocated space (which isn't zeroed).
-        memset(type->entries + type->entry_count, 0,
-               (new_count - type->entry_count) * sizeof(ThemeEntry));
-        type->entry_count = new_count;
+        type = MakeThemeType(entry_idx + 1);
+      } else if (entry_idx >= type->entry_count || type.use_count() > 1) {
+        // Grow the table to contain this entry_idx, and unshare it if it is still a snapshot
+        // shared with another Theme via SetTo(): this is the first write since the snapshot.
+        std::shared_ptr<ThemeType> new_type =
+            MakeThemeType(std::max(entry_idx + 1, type->entry_count));
+        memcpy(new_type->entries, type->entries, type->entry_count * sizeof(ThemeEntry));
+        type = std::move(new_type);
       }
       last_type_idx = type_idx;
       last_type = type.get();
@@ -1529,18 +1538,10 @@ void Theme::SetTo(const Theme& o) {
       }
 
       for (size_t t = 0; t < package->types.size(); t++) {
-        const ThemeType *type = package->types[t].get();
-        if (type == nullptr) {
-          // The other theme doesn't have this type, clear ours.
-          packages_[p]->types[t].reset();
-          continue;
-        }
-
-        // Create a new type and update it to theirs.
-        const size_t type_alloc_size = sizeof(ThemeType) + (type->entry_count * sizeof(ThemeEntry));
-        void *copied_data = malloc(type_alloc_size);
-        memcpy(copied_data, type, type_alloc_size);
-        packages_[p]->types[t].reset(reinterpret_cast<ThemeType *>(copied_data));
+        // Share the other theme's entry table rather than copying it. Whichever theme next
+        // mutates the table in ApplyStyle makes its own copy then, so rebasing a theme costs
+        // allocations only for the packages that subsequently change.
+        packages_[p]->types[t] = package->types[t];
       }
     }
   } else {
@@ -1686,21 +1687,17 @@ void Theme::SetTo(const Theme& o) {
           }
 
           // Lazily instantiate and resize the destination type.
-          util::unique_cptr<ThemeType>& dest_type = dest_package->types[t];
+          std::shared_ptr<ThemeType>& dest_type = dest_package->types[t];
           if (dest_type == nullptr || dest_type->entry_count < type->entry_count) {
-            const size_t type_alloc_size = sizeof(ThemeType)
-                + (type->entry_count * sizeof(ThemeEntry));
-            void* dest_data = malloc(type_alloc_size);
-            memset(dest_data, 0, type->entry_count * sizeof(ThemeEntry));
+            std::shared_ptr<ThemeType> new_type = MakeThemeType(type->entry_count);
 
             // Copy the existing destination type values if the type is resized.
             if (dest_type != nullptr) {
-              memcpy(dest_data, type, sizeof(ThemeType)
-                                      + (dest_type->entry_count * sizeof(ThemeEntry)));
+              memcpy(new_type->entries, dest_type->entries,
+                     dest_type->entry_count * sizeof(ThemeEntry));
             }
 
-            dest_type.reset(reinterpret_cast<ThemeType *>(dest_data));
-            dest_type->entry_count = type->entry_count;
+            dest_type = std::move(new_type);
           }
 
           dest_type->entries[e].cookie = data_dest_cookie;
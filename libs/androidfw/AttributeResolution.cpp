@@ -16,7 +16,9 @@
 
 #include "androidfw/AttributeResolution.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
 
 #include <log/log.h>
 
@@ -61,6 +63,73 @@ class BagAttributeFinder
   }
 };
 
+// Attribute arrays generated by aapt (the R.styleable arrays) are sorted, which the
+// backtracking finders above rely on to complete a whole ApplyStyle/ResolveAttrs call in
+// one merged forward pass over the style bags. Arrays constructed at runtime are not
+// always sorted, and every out-of-order attribute used to degrade the finder into a
+// backtracking scan over the bag. This computes, once per call, the order in which to
+// resolve the requested attributes so that every bag cursor only ever moves forward;
+// results are still written at the caller's positions. The index buffer lives on the
+// stack for typical attribute counts to keep the hot path allocation-free.
+class SortedAttributeOrder {
+ public:
+  SortedAttributeOrder(const uint32_t* attrs, size_t attrs_length) {
+    for (size_t i = 1; i < attrs_length; i++) {
+      if (attrs[i - 1] > attrs[i]) {
+        already_sorted_ = false;
+        break;
+      }
+    }
+
+    if (already_sorted_) {
+      return;
+    }
+
+    if (attrs_length > kStackIndexCount) {
+      heap_indices_.reset(new size_t[attrs_length]);
+      indices_ = heap_indices_.get();
+    } else {
+      indices_ = stack_indices_;
+    }
+
+    for (size_t i = 0; i < attrs_length; i++) {
+      indices_[i] = i;
+    }
+    std::sort(indices_, indices_ + attrs_length,
+              [attrs](size_t lhs, size_t rhs) { return attrs[lhs] < attrs[rhs]; });
+  }
+
+  // Maps iteration position to the caller's attribute index.
+  inline size_t at(size_t i) const {
+    return already_sorted_ ? i : indices_[i];
+  }
+
+ private:
+  static constexpr size_t kStackIndexCount = 64;
+
+  bool already_sorted_ = true;
+  size_t* indices_ = nullptr;
+  size_t stack_indices_[kStackIndexCount];
+  std::unique_ptr<size_t[]> heap_indices_;
+};
+
+// Fills out_indices (counted array of positions that resolved to a value) from the
+// written out-values. Doing this in a final pass keeps the indices in ascending caller
+// order even when the attributes were resolved in sorted order.
+static void WriteResolvedIndices(const uint32_t* out_values, size_t attrs_length,
+                                 uint32_t* out_indices) {
+  uint32_t indices_idx = 0;
+  for (size_t ii = 0; ii < attrs_length; ii++) {
+    const uint32_t* entry = out_values + (ii * STYLE_NUM_ENTRIES);
+    if (entry[STYLE_TYPE] != Res_value::TYPE_NULL ||
+        entry[STYLE_DATA] == Res_value::DATA_NULL_EMPTY) {
+      indices_idx++;
+      out_indices[indices_idx] = ii;
+    }
+  }
+  out_indices[0] = indices_idx;
+}
+
 bool ResolveAttrs(Theme* theme, uint32_t def_style_attr, uint32_t def_style_res,
                   uint32_t* src_values, size_t src_values_length, uint32_t* attrs,
                   size_t attrs_length, uint32_t* out_values, uint32_t* out_indices) {
@@ -73,8 +142,6 @@ bool ResolveAttrs(Theme* theme, uint32_t def_style_attr, uint32_t def_style_res,
   ResTable_config config;
   Res_value value;
 
-  int indices_idx = 0;
-
   // Load default style from attribute, if specified...
   uint32_t def_style_flags = 0u;
   if (def_style_attr != 0) {
@@ -97,10 +164,14 @@ bool ResolveAttrs(Theme* theme, uint32_t def_style_attr, uint32_t def_style_res,
 
   BagAttributeFinder def_style_attr_finder(default_style_bag);
 
+  SortedAttributeOrder order(attrs, attrs_length);
+
   // Now iterate through all of the attributes that the client has requested,
   // filling in each with whatever data we can find.
-  for (size_t ii = 0; ii < attrs_length; ii++) {
+  for (size_t i = 0; i < attrs_length; i++) {
+    const size_t ii = order.at(i);
     const uint32_t cur_ident = attrs[ii];
+    uint32_t* const out_entry = out_values + (ii * STYLE_NUM_ENTRIES);
 
     if (kDebugStyles) {
       ALOGI("RETRIEVING ATTR 0x%08x...", cur_ident);
@@ -180,24 +251,16 @@ bool ResolveAttrs(Theme* theme, uint32_t def_style_attr, uint32_t def_style_res,
     }
 
     // Write the final value back to Java.
-    out_values[STYLE_TYPE] = value.dataType;
-    out_values[STYLE_DATA] = value.data;
-    out_values[STYLE_ASSET_COOKIE] = ApkAssetsCookieToJavaCookie(cookie);
-    out_values[STYLE_RESOURCE_ID] = resid;
-    out_values[STYLE_CHANGING_CONFIGURATIONS] = type_set_flags;
-    out_values[STYLE_DENSITY] = config.density;
-
-    if (out_indices != nullptr &&
-        (value.dataType != Res_value::TYPE_NULL || value.data == Res_value::DATA_NULL_EMPTY)) {
-      indices_idx++;
-      out_indices[indices_idx] = ii;
-    }
-
-    out_values += STYLE_NUM_ENTRIES;
+    out_entry[STYLE_TYPE] = value.dataType;
+    out_entry[STYLE_DATA] = value.data;
+    out_entry[STYLE_ASSET_COOKIE] = ApkAssetsCookieToJavaCookie(cookie);
+    out_entry[STYLE_RESOURCE_ID] = resid;
+    out_entry[STYLE_CHANGING_CONFIGURATIONS] = type_set_flags;
+    out_entry[STYLE_DENSITY] = config.density;
   }
 
   if (out_indices != nullptr) {
-    out_indices[0] = indices_idx;
+    WriteResolvedIndices(out_values, attrs_length, out_indices);
   }
   return true;
 }
@@ -214,8 +277,6 @@ void ApplyStyle(Theme* theme, ResXMLParser* xml_parser, uint32_t def_style_attr,
   ResTable_config config;
   Res_value value;
 
-  int indices_idx = 0;
-
   // Load default style from attribute, if specified...
   uint32_t def_style_flags = 0u;
   if (def_style_attr != 0) {
@@ -271,10 +332,14 @@ void ApplyStyle(Theme* theme, ResXMLParser* xml_parser, uint32_t def_style_attr,
   // Retrieve the XML attributes, if requested.
   XmlAttributeFinder xml_attr_finder(xml_parser);
 
+  SortedAttributeOrder order(attrs, attrs_length);
+
   // Now iterate through all of the attributes that the client has requested,
   // filling in each with whatever data we can find.
-  for (size_t ii = 0; ii < attrs_length; ii++) {
+  for (size_t i = 0; i < attrs_length; i++) {
+    const size_t ii = order.at(i);
     const uint32_t cur_ident = attrs[ii];
+    uint32_t* const out_entry = out_values + (ii * STYLE_NUM_ENTRIES);
 
     if (kDebugStyles) {
       ALOGI("RETRIEVING ATTR 0x%08x...", cur_ident);
@@ -382,25 +447,17 @@ void ApplyStyle(Theme* theme, ResXMLParser* xml_parser, uint32_t def_style_attr,
     }
 
     // Write the final value back to Java.
-    out_values[STYLE_TYPE] = value.dataType;
-    out_values[STYLE_DATA] = value.data;
-    out_values[STYLE_ASSET_COOKIE] = ApkAssetsCookieToJavaCookie(cookie);
-    out_values[STYLE_RESOURCE_ID] = resid;
-    out_values[STYLE_CHANGING_CONFIGURATIONS] = type_set_flags;
-    out_values[STYLE_DENSITY] = config.density;
-    out_values[STYLE_SOURCE_RESOURCE_ID] = value_source_resid;
-
-    if (value.dataType != Res_value::TYPE_NULL || value.data == Res_value::DATA_NULL_EMPTY) {
-      indices_idx++;
-
-      // out_indices must NOT be nullptr.
-      out_indices[indices_idx] = ii;
-    }
-    out_values += STYLE_NUM_ENTRIES;
+    out_entry[STYLE_TYPE] = value.dataType;
+    out_entry[STYLE_DATA] = value.data;
+    out_entry[STYLE_ASSET_COOKIE] = ApkAssetsCookieToJavaCookie(cookie);
+    out_entry[STYLE_RESOURCE_ID] = resid;
+    out_entry[STYLE_CHANGING_CONFIGURATIONS] = type_set_flags;
+    out_entry[STYLE_DENSITY] = config.density;
+    out_entry[STYLE_SOURCE_RESOURCE_ID] = value_source_resid;
   }
 
   // out_indices must NOT be nullptr.
-  out_indices[0] = indices_idx;
+  WriteResolvedIndices(out_values, attrs_length, out_indices);
 }
 
 bool RetrieveAttributes(AssetManager2* assetmanager, ResXMLParser* xml_parser, uint32_t* attrs,
@@ -408,17 +465,21 @@ bool RetrieveAttributes(AssetManager2* assetmanager, ResXMLParser* xml_parser, u
   ResTable_config config;
   Res_value value;
 
-  int indices_idx = 0;
-
   // Retrieve the XML attributes, if requested.
   const size_t xml_attr_count = xml_parser->getAttributeCount();
   size_t ix = 0;
   uint32_t cur_xml_attr = xml_parser->getAttributeNameResID(ix);
 
+  SortedAttributeOrder order(attrs, attrs_length);
+
   // Now iterate through all of the attributes that the client has requested,
-  // filling in each with whatever data we can find.
-  for (size_t ii = 0; ii < attrs_length; ii++) {
+  // filling in each with whatever data we can find. The XML cursor below never
+  // backtracks, so resolving in sorted order also guarantees that out-of-order
+  // attribute arrays cannot step past their XML attributes.
+  for (size_t i = 0; i < attrs_length; i++) {
+    const size_t ii = order.at(i);
     const uint32_t cur_ident = attrs[ii];
+    uint32_t* const out_entry = out_values + (ii * STYLE_NUM_ENTRIES);
     ApkAssetsCookie cookie = kInvalidCookie;
     uint32_t type_set_flags = 0u;
 
@@ -457,24 +518,16 @@ bool RetrieveAttributes(AssetManager2* assetmanager, ResXMLParser* xml_parser, u
     }
 
     // Write the final value back to Java.
-    out_values[STYLE_TYPE] = value.dataType;
-    out_values[STYLE_DATA] = value.data;
-    out_values[STYLE_ASSET_COOKIE] = ApkAssetsCookieToJavaCookie(cookie);
-    out_values[STYLE_RESOURCE_ID] = resid;
-    out_values[STYLE_CHANGING_CONFIGURATIONS] = type_set_flags;
-    out_values[STYLE_DENSITY] = config.density;
-
-    if (out_indices != nullptr &&
-        (value.dataType != Res_value::TYPE_NULL || value.data == Res_value::DATA_NULL_EMPTY)) {
-      indices_idx++;
-      out_indices[indices_idx] = ii;
-    }
-
-    out_values += STYLE_NUM_ENTRIES;
+    out_entry[STYLE_TYPE] = value.dataType;
+    out_entry[STYLE_DATA] = value.data;
+    out_entry[STYLE_ASSET_COOKIE] = ApkAssetsCookieToJavaCookie(cookie);
+    out_entry[STYLE_RESOURCE_ID] = resid;
+    out_entry[STYLE_CHANGING_CONFIGURATIONS] = type_set_flags;
+    out_entry[STYLE_DENSITY] = config.density;
   }
 
   if (out_indices != nullptr) {
-    out_indices[0] = indices_idx;
+    WriteResolvedIndices(out_values, attrs_length, out_indices);
   }
   return true;
 }
@@ -30,6 +30,11 @@
 #include <utime.h>
 #include <zlib.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include <log/log.h>
 #include <utils/ByteOrder.h>
 #include <utils/KeyedVector.h>
@@ -74,6 +79,11 @@ static const bool kIsDebug = false;
 #define LOGP(x...) if (kIsDebug) ALOGD(x)
 #endif
 
+// CRC computation for files that can't reuse the previous snapshot's CRC is
+// fanned out across at most this many worker threads.  Backups run in the
+// background, so the pool is kept small on purpose.
+const static size_t MAX_CRC_WORKER_THREADS = 4;
+
 const static int ROUND_UP[4] = { 0, 3, 2, 1 };
 
 static inline int
@@ -345,6 +355,7 @@ back_up_files(int oldSnapshotFD, BackupDataWriter* dataStream, int newSnapshotFD
         }
     }
 
+    std::vector<String8> pendingCrcKeys;
     for (int i=0; i<fileCount; i++) {
         String8 key(keys[i]);
         FileRec r;
@@ -369,13 +380,69 @@ back_up_files(int oldSnapshotFD, BackupDataWriter* dataStream, int newSnapshotFD
                 return -1;
             }
 
-            // compute the CRC
-            if (compute_crc32(file, &r) != NO_ERROR) {
-                ALOGW("Unable to open file %s", file);
-                continue;
+            // A file whose modTime, mode and size all match the previous
+            // snapshot keeps the previous CRC without being read again;
+            // everything else is queued up to be hashed below.
+            ssize_t oldIndex = oldSnapshot.indexOfKey(key);
+            if (oldIndex >= 0) {
+                const FileState& f = oldSnapshot.valueAt(oldIndex);
+                if (f.modTime_sec == r.s.modTime_sec && f.modTime_nsec == r.s.modTime_nsec
+                        && f.mode == r.s.mode && f.size == r.s.size) {
+                    r.s.crc32 = f.crc32;
+                    newSnapshot.add(key, r);
+                    continue;
+                }
             }
         }
         newSnapshot.add(key, r);
+        pendingCrcKeys.push_back(key);
+    }
+
+    // Compute the CRCs of new and modified files.  Each file is hashed
+    // independently, so the work is spread over a small worker pool.
+    if (!pendingCrcKeys.empty()) {
+        std::vector<FileRec*> pendingRecs;
+        pendingRecs.reserve(pendingCrcKeys.size());
+        for (const String8& key : pendingCrcKeys) {
+            pendingRecs.push_back(&newSnapshot.editValueFor(key));
+        }
+
+        std::vector<uint8_t> failed(pendingRecs.size(), 0);
+        std::atomic<size_t> nextRec(0);
+        auto hashFiles = [&pendingRecs, &failed, &nextRec] {
+            size_t i;
+            while ((i = nextRec.fetch_add(1)) < pendingRecs.size()) {
+                FileRec* r = pendingRecs[i];
+                if (compute_crc32(r->file.string(), r) != NO_ERROR) {
+                    ALOGW("Unable to open file %s", r->file.string());
+                    failed[i] = 1;
+                }
+            }
+        };
+
+        size_t numWorkers = std::min<size_t>(
+                {pendingRecs.size(), MAX_CRC_WORKER_THREADS,
+                 std::max<size_t>(1, std::thread::hardware_concurrency())});
+        if (numWorkers <= 1) {
+            hashFiles();
+        } else {
+            std::vector<std::thread> workers;
+            workers.reserve(numWorkers);
+            for (size_t i = 0; i < numWorkers; i++) {
+                workers.emplace_back(hashFiles);
+            }
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+        }
+
+        // Files that couldn't be read are dropped from the snapshot, just as
+        // if they had been deleted.
+        for (size_t i = 0; i < pendingRecs.size(); i++) {
+            if (failed[i]) {
+                newSnapshot.removeItem(pendingCrcKeys[i]);
+            }
+        }
     }
 
     int n = 0;
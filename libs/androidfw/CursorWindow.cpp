@@ -32,7 +32,8 @@ namespace android {
 
 CursorWindow::CursorWindow(const String8& name, int ashmemFd,
         void* data, size_t size, bool readOnly) :
-        mName(name), mAshmemFd(ashmemFd), mData(data), mSize(size), mReadOnly(readOnly) {
+        mName(name), mAshmemFd(ashmemFd), mData(data), mSize(size), mReadOnly(readOnly),
+        mLastChunkOffset(0), mLastChunkStartRow(0) {
     mHeader = static_cast<Header*>(mData);
 }
 
@@ -160,6 +161,9 @@ status_t CursorWindow::clear() {
 
     RowSlotChunk* firstChunk = static_cast<RowSlotChunk*>(offsetToPtr(mHeader->firstChunkOffset));
     firstChunk->nextChunkOffset = 0;
+
+    mLastChunkOffset = 0;
+    mLastChunkStartRow = 0;
     return OK;
 }
 
@@ -241,21 +245,39 @@ uint32_t CursorWindow::alloc(size_t size, bool aligned) {
 
 CursorWindow::RowSlot* CursorWindow::getRowSlot(uint32_t row) {
     uint32_t chunkPos = row;
-    RowSlotChunk* chunk = static_cast<RowSlotChunk*>(
-            offsetToPtr(mHeader->firstChunkOffset));
+    uint32_t chunkOffset = mHeader->firstChunkOffset;
+    // Resume the walk from the last chunk visited so that sequential fills
+    // touch each chunk once instead of rescanning the list per cell. The
+    // cursor is writer-only because read-only windows may be shared between
+    // threads.
+    if (!mReadOnly && mLastChunkOffset && row >= mLastChunkStartRow) {
+        chunkOffset = mLastChunkOffset;
+        chunkPos = row - mLastChunkStartRow;
+    }
+    RowSlotChunk* chunk = static_cast<RowSlotChunk*>(offsetToPtr(chunkOffset));
     while (chunkPos >= ROW_SLOT_CHUNK_NUM_ROWS) {
-        chunk = static_cast<RowSlotChunk*>(offsetToPtr(chunk->nextChunkOffset));
+        chunkOffset = chunk->nextChunkOffset;
+        chunk = static_cast<RowSlotChunk*>(offsetToPtr(chunkOffset));
         chunkPos -= ROW_SLOT_CHUNK_NUM_ROWS;
     }
+    if (!mReadOnly) {
+        mLastChunkOffset = chunkOffset;
+        mLastChunkStartRow = row - chunkPos;
+    }
     return &chunk->slots[chunkPos];
 }
 
 CursorWindow::RowSlot* CursorWindow::allocRowSlot() {
     uint32_t chunkPos = mHeader->numRows;
-    RowSlotChunk* chunk = static_cast<RowSlotChunk*>(
-            offsetToPtr(mHeader->firstChunkOffset));
+    uint32_t chunkOffset = mHeader->firstChunkOffset;
+    if (mLastChunkOffset && chunkPos >= mLastChunkStartRow) {
+        chunkOffset = mLastChunkOffset;
+        chunkPos -= mLastChunkStartRow;
+    }
+    RowSlotChunk* chunk = static_cast<RowSlotChunk*>(offsetToPtr(chunkOffset));
     while (chunkPos > ROW_SLOT_CHUNK_NUM_ROWS) {
-        chunk = static_cast<RowSlotChunk*>(offsetToPtr(chunk->nextChunkOffset));
+        chunkOffset = chunk->nextChunkOffset;
+        chunk = static_cast<RowSlotChunk*>(offsetToPtr(chunkOffset));
         chunkPos -= ROW_SLOT_CHUNK_NUM_ROWS;
     }
     if (chunkPos == ROW_SLOT_CHUNK_NUM_ROWS) {
@@ -265,10 +287,13 @@ CursorWindow::RowSlot* CursorWindow::allocRowSlot() {
                 return NULL;
             }
         }
-        chunk = static_cast<RowSlotChunk*>(offsetToPtr(chunk->nextChunkOffset));
+        chunkOffset = chunk->nextChunkOffset;
+        chunk = static_cast<RowSlotChunk*>(offsetToPtr(chunkOffset));
         chunk->nextChunkOffset = 0;
         chunkPos = 0;
     }
+    mLastChunkOffset = chunkOffset;
+    mLastChunkStartRow = mHeader->numRows - chunkPos;
     mHeader->numRows += 1;
     return &chunk->slots[chunkPos];
 }
@@ -368,4 +393,56 @@ status_t CursorWindow::putNull(uint32_t row, uint32_t column) {
     return OK;
 }
 
+status_t CursorWindow::putRow(const RowField* fields, size_t count) {
+    if (mReadOnly) {
+        return INVALID_OPERATION;
+    }
+    if (count != mHeader->numColumns) {
+        ALOGE("Trying to put a row with %zu fields into a CursorWindow "
+                "with %d columns.", count, mHeader->numColumns);
+        return BAD_VALUE;
+    }
+
+    status_t result = allocRow();
+    if (result) {
+        return result;
+    }
+
+    // Fetch the field directory once and fill every column from it, instead of
+    // walking the row slot chunks again for each cell.
+    RowSlot* rowSlot = getRowSlot(mHeader->numRows - 1);
+    FieldSlot* fieldDir = static_cast<FieldSlot*>(offsetToPtr(rowSlot->offset));
+    for (size_t i = 0; i < count; i++) {
+        const RowField& field = fields[i];
+        FieldSlot* fieldSlot = &fieldDir[i];
+        switch (field.type) {
+            case FIELD_TYPE_INTEGER:
+                fieldSlot->type = FIELD_TYPE_INTEGER;
+                fieldSlot->data.l = field.value.l;
+                break;
+            case FIELD_TYPE_FLOAT:
+                fieldSlot->type = FIELD_TYPE_FLOAT;
+                fieldSlot->data.d = field.value.d;
+                break;
+            case FIELD_TYPE_STRING:
+            case FIELD_TYPE_BLOB: {
+                uint32_t offset = alloc(field.value.buffer.size);
+                if (!offset) {
+                    freeLastRow();
+                    return NO_MEMORY;
+                }
+                memcpy(offsetToPtr(offset), field.value.buffer.data, field.value.buffer.size);
+                fieldSlot->type = field.type;
+                fieldSlot->data.buffer.offset = offset;
+                fieldSlot->data.buffer.size = field.value.buffer.size;
+                break;
+            }
+            default:
+                // allocRow() left the slot as FIELD_TYPE_NULL.
+                break;
+        }
+    }
+    return OK;
+}
+
 }; // namespace android
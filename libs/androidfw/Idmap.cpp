@@ -106,10 +106,12 @@ status_t OverlayDynamicRefTable::lookupResourceIdNoRewrite(uint32_t* resId) cons
 
 IdmapResMap::IdmapResMap(const Idmap_data_header* data_header,
                          const Idmap_target_entry* entries,
+                         const std::unordered_map<uint32_t, uint32_t>* entry_index,
                          uint8_t target_assigned_package_id,
                          const OverlayDynamicRefTable* overlay_ref_table)
     : data_header_(data_header),
       entries_(entries),
+      entry_index_(entry_index),
       target_assigned_package_id_(target_assigned_package_id),
       overlay_ref_table_(overlay_ref_table) { };
 
@@ -123,13 +125,23 @@ IdmapResMap::Result IdmapResMap::Lookup(uint32_t target_res_id) const {
   target_res_id = (0x00FFFFFFU & target_res_id)
       | (((uint32_t) data_header_->target_package_id) << 24);
 
-  const Idmap_target_entry* first_entry = entries_;
-  const Idmap_target_entry* end_entry = entries_ + dtohl(data_header_->target_entry_count);
-  auto entry = std::lower_bound(first_entry, end_entry, target_res_id, compare_target_entries);
-
-  if (entry == end_entry || dtohl(entry->target_id) != target_res_id) {
-    // A mapping for the target resource id could not be found.
-    return {};
+  const Idmap_target_entry* entry;
+  if (entry_index_ != nullptr && !entry_index_->empty()) {
+    const auto index_iter = entry_index_->find(target_res_id);
+    if (index_iter == entry_index_->end()) {
+      // A mapping for the target resource id could not be found.
+      return {};
+    }
+    entry = entries_ + index_iter->second;
+  } else {
+    // No index was built for this idmap; fall back to binary searching the entry array.
+    const Idmap_target_entry* first_entry = entries_;
+    const Idmap_target_entry* end_entry = entries_ + dtohl(data_header_->target_entry_count);
+    entry = std::lower_bound(first_entry, end_entry, target_res_id, compare_target_entries);
+    if (entry == end_entry || dtohl(entry->target_id) != target_res_id) {
+      // A mapping for the target resource id could not be found.
+      return {};
+    }
   }
 
   // A reference should be treated as an alias of the resource. Instead of returning the table
@@ -215,6 +227,14 @@ LoadedIdmap::LoadedIdmap(std::string&& idmap_path,
   length = strnlen(reinterpret_cast<const char*>(header_->target_path),
                           arraysize(header_->target_path));
   target_apk_path_.assign(reinterpret_cast<const char*>(header_->target_path), length);
+
+  // Index the target entries by resource id so the hot resolution path does a single hashed
+  // load instead of a binary search per lookup.
+  const uint32_t target_entry_count = dtohl(data_header_->target_entry_count);
+  target_entry_index_.reserve(target_entry_count);
+  for (uint32_t i = 0; i < target_entry_count; i++) {
+    target_entry_index_[dtohl(target_entries_[i].target_id)] = i;
+  }
 }
 
 std::unique_ptr<const LoadedIdmap> LoadedIdmap::Load(const StringPiece& idmap_path,
@@ -81,6 +81,104 @@ class TypeSpecPtrBuilder {
   std::vector<const ResTable_type*> types_;
 };
 
+// On-disk layout of the serialized index produced by LoadedArsc::SerializeIndex.
+// Fields are in host byte order; the index is a device-local cache that is never
+// shipped across ABIs, so no swapping is performed.
+constexpr uint32_t kIndexMagic = 0x58444941u;  // "AIDX", little endian.
+constexpr uint32_t kIndexVersion = 1u;
+constexpr uint64_t kIndexNoChunk = std::numeric_limits<uint64_t>::max();
+
+struct IndexHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t arsc_size;
+  uint64_t arsc_fingerprint;
+  uint64_t global_pool_offset;
+  uint64_t global_pool_size;
+  uint32_t package_count;
+};
+
+// Fingerprints the table cheaply by hashing its first and last pages together with its
+// size. The index lives next to the APK at the same trust level, so this only guards
+// against pairing an index with a different or rebuilt table, not against tampering.
+uint64_t FingerprintArsc(const void* data, size_t len) {
+  constexpr size_t kSampleSize = 4096u;
+  uint64_t hash = 0xcbf29ce484222325ull;  // FNV-1a offset basis.
+  const auto mix = [&hash](const uint8_t* bytes, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+  };
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  mix(bytes, std::min(len, kSampleSize));
+  if (len > kSampleSize) {
+    mix(bytes + len - kSampleSize, kSampleSize);
+  }
+  return hash ^ static_cast<uint64_t>(len);
+}
+
+template <typename T>
+void WriteIndexPod(const T& value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void WriteIndexString(const std::string& str, std::string* out) {
+  WriteIndexPod(static_cast<uint32_t>(str.size()), out);
+  out->append(str);
+}
+
+// Bounds-checked sequential reader over a serialized index blob.
+class IndexReader {
+ public:
+  IndexReader(const void* data, size_t len)
+      : cursor_(reinterpret_cast<const uint8_t*>(data)), end_(cursor_ + len) {
+  }
+
+  template <typename T>
+  bool Read(T* out) {
+    if (static_cast<size_t>(end_ - cursor_) < sizeof(T)) {
+      return false;
+    }
+    memcpy(out, cursor_, sizeof(T));
+    cursor_ += sizeof(T);
+    return true;
+  }
+
+  bool ReadString(std::string* out) {
+    uint32_t size;
+    if (!Read(&size) || static_cast<size_t>(end_ - cursor_) < size) {
+      return false;
+    }
+    out->assign(reinterpret_cast<const char*>(cursor_), size);
+    cursor_ += size;
+    return true;
+  }
+
+ private:
+  const uint8_t* cursor_;
+  const uint8_t* end_;
+};
+
+// Translates a stored chunk offset back into a pointer into `data`, ensuring at least
+// `min_size` bytes are available past the offset. Returns nullptr on any violation.
+const void* ResolveIndexChunk(const StringPiece& data, uint64_t offset, size_t min_size) {
+  if (offset >= data.size() || data.size() - offset < min_size) {
+    return nullptr;
+  }
+  return data.data() + offset;
+}
+
+// Computes the offset of a chunk pointer relative to the table base, returning
+// kIndexNoChunk if the pointer does not lie within the table.
+uint64_t IndexChunkOffset(const StringPiece& data, const void* chunk) {
+  const uint8_t* base = reinterpret_cast<const uint8_t*>(data.data());
+  const uint8_t* target = reinterpret_cast<const uint8_t*>(chunk);
+  if (target < base || target >= base + data.size()) {
+    return kIndexNoChunk;
+  }
+  return static_cast<uint64_t>(target - base);
+}
+
 }  // namespace
 
 LoadedPackage::LoadedPackage() = default;
@@ -691,6 +789,7 @@ bool LoadedArsc::LoadTable(const Chunk& chunk, const LoadedIdmap* loaded_idmap,
 
   if (loaded_idmap != nullptr) {
     global_string_pool_ = util::make_unique<OverlayStringPool>(loaded_idmap);
+    has_idmap_ = true;
   }
 
   const size_t package_count = dtohl(header->packageCount);
@@ -786,4 +885,221 @@ std::unique_ptr<const LoadedArsc> LoadedArsc::CreateEmpty() {
   return std::unique_ptr<LoadedArsc>(new LoadedArsc());
 }
 
+bool LoadedArsc::SerializeIndex(const StringPiece& data, std::string* out) const {
+  out->clear();
+
+  if (has_idmap_) {
+    // The overlay string pool references idmap memory that a later process will map at
+    // a different location; such tables must be parsed the regular way.
+    return false;
+  }
+
+  for (const auto& package : packages_) {
+    if (package->defines_overlayable_ || !package->overlayable_map_.empty()) {
+      // <overlayable> policy state is not modeled by the flat index yet.
+      return false;
+    }
+  }
+
+  IndexHeader header;
+  header.magic = kIndexMagic;
+  header.version = kIndexVersion;
+  header.arsc_size = data.size();
+  header.arsc_fingerprint = FingerprintArsc(data.data(), data.size());
+  header.global_pool_offset = kIndexNoChunk;
+  header.global_pool_size = 0u;
+  header.package_count = static_cast<uint32_t>(packages_.size());
+  if (global_string_pool_->data() != nullptr) {
+    header.global_pool_offset = IndexChunkOffset(data, global_string_pool_->data());
+    header.global_pool_size = global_string_pool_->bytes();
+    if (header.global_pool_offset == kIndexNoChunk) {
+      return false;
+    }
+  }
+  WriteIndexPod(header, out);
+
+  for (const auto& package : packages_) {
+    WriteIndexPod(static_cast<uint32_t>(package->package_id_), out);
+    WriteIndexPod(static_cast<uint32_t>(package->type_id_offset_), out);
+    WriteIndexPod(static_cast<uint32_t>(package->property_flags_), out);
+    WriteIndexString(package->package_name_, out);
+
+    for (const ResStringPool* pool :
+         {&package->type_string_pool_, &package->key_string_pool_}) {
+      uint64_t pool_offset = kIndexNoChunk;
+      uint64_t pool_size = 0u;
+      if (pool->data() != nullptr) {
+        pool_offset = IndexChunkOffset(data, pool->data());
+        pool_size = pool->bytes();
+        if (pool_offset == kIndexNoChunk) {
+          out->clear();
+          return false;
+        }
+      }
+      WriteIndexPod(pool_offset, out);
+      WriteIndexPod(pool_size, out);
+    }
+
+    WriteIndexPod(static_cast<uint32_t>(package->dynamic_package_map_.size()), out);
+    for (const DynamicPackageEntry& entry : package->dynamic_package_map_) {
+      WriteIndexString(entry.package_name, out);
+      WriteIndexPod(static_cast<uint32_t>(entry.package_id), out);
+    }
+
+    std::vector<const TypeSpec*> type_specs;
+    for (size_t i = 0; i < package->type_specs_.size(); i++) {
+      const TypeSpecPtr& type_spec = package->type_specs_[i];
+      if (type_spec != nullptr) {
+        type_specs.push_back(type_spec.get());
+      }
+    }
+
+    WriteIndexPod(static_cast<uint32_t>(type_specs.size()), out);
+    for (const TypeSpec* type_spec : type_specs) {
+      const uint64_t spec_offset = IndexChunkOffset(data, type_spec->type_spec);
+      if (spec_offset == kIndexNoChunk) {
+        out->clear();
+        return false;
+      }
+      WriteIndexPod(spec_offset, out);
+      WriteIndexPod(static_cast<uint32_t>(type_spec->type_count), out);
+      for (size_t i = 0; i < type_spec->type_count; i++) {
+        const uint64_t type_offset = IndexChunkOffset(data, type_spec->types[i]);
+        if (type_offset == kIndexNoChunk) {
+          out->clear();
+          return false;
+        }
+        WriteIndexPod(type_offset, out);
+      }
+    }
+  }
+  return true;
+}
+
+std::unique_ptr<const LoadedArsc> LoadedArsc::LoadFromIndex(const StringPiece& data,
+                                                            const StringPiece& index) {
+  ATRACE_NAME("LoadedArsc::LoadFromIndex");
+
+  IndexReader reader(index.data(), index.size());
+  IndexHeader header;
+  if (!reader.Read(&header) || header.magic != kIndexMagic ||
+      header.version != kIndexVersion || header.arsc_size != data.size() ||
+      header.arsc_fingerprint != FingerprintArsc(data.data(), data.size())) {
+    return {};
+  }
+
+  // Not using make_unique because the constructor is private.
+  std::unique_ptr<LoadedArsc> loaded_arsc(new LoadedArsc());
+
+  if (header.global_pool_offset != kIndexNoChunk) {
+    const void* pool_data =
+        ResolveIndexChunk(data, header.global_pool_offset, header.global_pool_size);
+    if (pool_data == nullptr ||
+        loaded_arsc->global_string_pool_->setTo(pool_data, header.global_pool_size) !=
+            NO_ERROR) {
+      return {};
+    }
+  }
+
+  loaded_arsc->packages_.reserve(header.package_count);
+  for (uint32_t i = 0; i < header.package_count; i++) {
+    std::unique_ptr<LoadedPackage> loaded_package(new LoadedPackage());
+
+    uint32_t package_id, type_id_offset, property_flags;
+    if (!reader.Read(&package_id) || !reader.Read(&type_id_offset) ||
+        !reader.Read(&property_flags) ||
+        !reader.ReadString(&loaded_package->package_name_)) {
+      return {};
+    }
+    loaded_package->package_id_ = static_cast<int>(package_id);
+    loaded_package->type_id_offset_ = static_cast<int>(type_id_offset);
+    loaded_package->property_flags_ = property_flags;
+
+    for (ResStringPool* pool :
+         {&loaded_package->type_string_pool_, &loaded_package->key_string_pool_}) {
+      uint64_t pool_offset, pool_size;
+      if (!reader.Read(&pool_offset) || !reader.Read(&pool_size)) {
+        return {};
+      }
+      if (pool_offset == kIndexNoChunk) {
+        continue;
+      }
+      const void* pool_data = ResolveIndexChunk(data, pool_offset, pool_size);
+      if (pool_data == nullptr || pool->setTo(pool_data, pool_size) != NO_ERROR) {
+        return {};
+      }
+    }
+
+    uint32_t dynamic_count;
+    if (!reader.Read(&dynamic_count)) {
+      return {};
+    }
+    loaded_package->dynamic_package_map_.reserve(dynamic_count);
+    for (uint32_t j = 0; j < dynamic_count; j++) {
+      std::string entry_name;
+      uint32_t entry_id;
+      if (!reader.ReadString(&entry_name) || !reader.Read(&entry_id)) {
+        return {};
+      }
+      loaded_package->dynamic_package_map_.emplace_back(std::move(entry_name),
+                                                        static_cast<int>(entry_id));
+    }
+
+    uint32_t type_spec_count;
+    if (!reader.Read(&type_spec_count)) {
+      return {};
+    }
+    for (uint32_t j = 0; j < type_spec_count; j++) {
+      uint64_t spec_offset;
+      uint32_t type_count;
+      if (!reader.Read(&spec_offset) || !reader.Read(&type_count)) {
+        return {};
+      }
+
+      const ResTable_typeSpec* type_spec = reinterpret_cast<const ResTable_typeSpec*>(
+          ResolveIndexChunk(data, spec_offset, sizeof(ResTable_typeSpec)));
+      if (type_spec == nullptr || type_spec->id == 0 ||
+          dtohl(type_spec->header.size) > data.size() - spec_offset) {
+        return {};
+      }
+
+      const size_t spec_size = dtohl(type_spec->header.size);
+      const size_t spec_header_size = dtohs(type_spec->header.headerSize);
+      const size_t entry_count = dtohl(type_spec->entryCount);
+      if (spec_header_size > spec_size ||
+          entry_count > std::numeric_limits<uint16_t>::max() ||
+          entry_count * sizeof(uint32_t) > spec_size - spec_header_size) {
+        return {};
+      }
+
+      TypeSpecPtrBuilder builder(type_spec);
+      for (uint32_t k = 0; k < type_count; k++) {
+        uint64_t type_offset;
+        if (!reader.Read(&type_offset)) {
+          return {};
+        }
+        const ResTable_type* type = reinterpret_cast<const ResTable_type*>(
+            ResolveIndexChunk(data, type_offset, kResTableTypeMinSize));
+        if (type == nullptr || dtohl(type->header.size) > data.size() - type_offset ||
+            !VerifyResTableType(type)) {
+          return {};
+        }
+        builder.AddType(type);
+      }
+
+      TypeSpecPtr type_spec_ptr = builder.Build();
+      if (type_spec_ptr == nullptr) {
+        return {};
+      }
+      loaded_package->resource_ids_.set(type_spec->id, entry_count);
+      loaded_package->type_specs_.editItemAt(type_spec->id - 1) = std::move(type_spec_ptr);
+    }
+
+    loaded_arsc->packages_.push_back(std::move(loaded_package));
+  }
+
+  // Need to force a move for mingw32.
+  return std::move(loaded_arsc);
+}
+
 }  // namespace android
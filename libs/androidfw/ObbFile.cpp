@@ -19,8 +19,14 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 #define LOG_TAG "ObbFile"
 
 #include <androidfw/ObbFile.h>
@@ -72,6 +78,30 @@
 
 namespace android {
 
+namespace {
+
+/*
+ * Cache of parsed OBB footers.  Mount checks parse the same OBB over and over
+ * (every mount, every package scan), so the parsed metadata is kept around
+ * keyed by path and validated against the file's mtime and size.
+ */
+struct ObbCacheEntry {
+    time_t modTime;
+    off64_t fileSize;
+    String8 packageName;
+    int32_t version;
+    int32_t flags;
+    unsigned char salt[8];
+    size_t footerStart;
+};
+
+const size_t kMaxCacheEntries = 64;
+
+std::mutex gObbCacheLock;
+std::unordered_map<std::string, ObbCacheEntry> gObbCache;
+
+} // namespace
+
 ObbFile::ObbFile()
         : mPackageName("")
         , mVersion(-1)
@@ -87,6 +117,13 @@ bool ObbFile::readFrom(const char* filename)
 {
     int fd;
     bool success = false;
+    bool haveStat;
+    struct stat st;
+
+    haveStat = stat(filename, &st) == 0;
+    if (haveStat && readFromCache(filename, st)) {
+        return true;
+    }
 
     fd = ::open(filename, O_RDONLY);
     if (fd < 0) {
@@ -98,12 +135,62 @@ bool ObbFile::readFrom(const char* filename)
 
     if (!success) {
         ALOGW("failed to read from %s (fd=%d)\n", filename, fd);
+    } else if (haveStat) {
+        writeToCache(filename, st);
     }
 
 out:
     return success;
 }
 
+bool ObbFile::readFromCache(const char* filename, const struct stat& st)
+{
+    std::lock_guard<std::mutex> lock(gObbCacheLock);
+
+    auto it = gObbCache.find(filename);
+    if (it == gObbCache.end()) {
+        return false;
+    }
+
+    const ObbCacheEntry& entry = it->second;
+    if (entry.modTime != st.st_mtime || entry.fileSize != st.st_size) {
+        gObbCache.erase(it);
+        return false;
+    }
+
+    mPackageName = entry.packageName;
+    mVersion = entry.version;
+    mFlags = entry.flags;
+    memcpy(mSalt, entry.salt, sizeof(mSalt));
+    mFooterStart = entry.footerStart;
+    return true;
+}
+
+void ObbFile::writeToCache(const char* filename, const struct stat& st) const
+{
+    std::lock_guard<std::mutex> lock(gObbCacheLock);
+
+    if (gObbCache.size() >= kMaxCacheEntries && gObbCache.count(filename) == 0) {
+        gObbCache.clear();
+    }
+
+    ObbCacheEntry& entry = gObbCache[filename];
+    entry.modTime = st.st_mtime;
+    entry.fileSize = st.st_size;
+    entry.packageName = mPackageName;
+    entry.version = mVersion;
+    entry.flags = mFlags;
+    memcpy(entry.salt, mSalt, sizeof(entry.salt));
+    entry.footerStart = mFooterStart;
+}
+
+void ObbFile::invalidateCache(const char* filename)
+{
+    std::lock_guard<std::mutex> lock(gObbCacheLock);
+
+    gObbCache.erase(filename);
+}
+
 bool ObbFile::readFrom(int fd)
 {
     if (fd < 0) {
@@ -127,94 +214,108 @@ bool ObbFile::parseObbFile(int fd)
         return false;
     }
 
-    ssize_t actual;
-    size_t footerSize;
+    // Both the footer tag and the footer itself live within the last
+    // kMaxBufSize + kFooterTagSize bytes of the file, so one page-aligned
+    // mapping of the tail covers everything the parser touches.
+    const size_t maxTail = kMaxBufSize + kFooterTagSize;
+    off64_t tailStart = fileLength > (off64_t)maxTail ? fileLength - maxTail : 0;
+    size_t tailLength = fileLength - tailStart;
+    const size_t pageSize = getpagesize();
+    off64_t mapStart = tailStart - (tailStart % pageSize);
+    size_t mapLength = fileLength - mapStart;
+
+    bool result;
+    void* map = mmap64(NULL, mapLength, PROT_READ, MAP_PRIVATE, fd, mapStart);
+    if (map != MAP_FAILED) {
+        result = parseFooter((const unsigned char*)map + (tailStart - mapStart),
+                tailLength, fileLength);
+        munmap(map, mapLength);
+        return result;
+    }
 
-    {
-        lseek64(fd, fileLength - kFooterTagSize, SEEK_SET);
+    // Not every fd can be mapped; fall back to reading the whole tail region
+    // with a single read.
+    unsigned char* tail = (unsigned char*)malloc(tailLength);
+    if (tail == NULL) {
+        ALOGW("couldn't allocate footer buffer: %s\n", strerror(errno));
+        return false;
+    }
 
-        char footer[kFooterTagSize];
-        actual = TEMP_FAILURE_RETRY(read(fd, footer, kFooterTagSize));
-        if (actual != kFooterTagSize) {
-            ALOGW("couldn't read footer signature: %s\n", strerror(errno));
-            return false;
-        }
+    if (lseek64(fd, tailStart, SEEK_SET) != tailStart) {
+        ALOGW("seek %lld failed: %s\n", (long long int)tailStart, strerror(errno));
+        free(tail);
+        return false;
+    }
 
-        unsigned int fileSig = get4LE((unsigned char*)footer + sizeof(int32_t));
-        if (fileSig != kSignature) {
-            ALOGW("footer didn't match magic string (expected 0x%08x; got 0x%08x)\n",
-                    kSignature, fileSig);
-            return false;
-        }
+    ssize_t actual = TEMP_FAILURE_RETRY(read(fd, tail, tailLength));
+    if (actual != (ssize_t)tailLength) {
+        ALOGI("couldn't read ObbFile footer: %s\n", strerror(errno));
+        free(tail);
+        return false;
+    }
 
-        footerSize = get4LE((unsigned char*)footer);
-        if (footerSize > (size_t)fileLength - kFooterTagSize
-                || footerSize > kMaxBufSize) {
-            ALOGW("claimed footer size is too large (0x%08zx; file size is 0x%08lld)\n",
-                    footerSize, (long long int)fileLength);
-            return false;
-        }
+    result = parseFooter(tail, tailLength, fileLength);
+    free(tail);
+    return result;
+}
 
-        if (footerSize < (kFooterMinSize - kFooterTagSize)) {
-            ALOGW("claimed footer size is too small (0x%zx; minimum size is 0x%x)\n",
-                    footerSize, kFooterMinSize - kFooterTagSize);
-            return false;
-        }
-    }
+bool ObbFile::parseFooter(const unsigned char* tail, size_t tailLength, off64_t fileLength)
+{
+    const unsigned char* footerTag = tail + tailLength - kFooterTagSize;
 
-    off64_t fileOffset = fileLength - footerSize - kFooterTagSize;
-    if (lseek64(fd, fileOffset, SEEK_SET) != fileOffset) {
-        ALOGW("seek %lld failed: %s\n", (long long int)fileOffset, strerror(errno));
+    unsigned int fileSig = get4LE(footerTag + sizeof(int32_t));
+    if (fileSig != kSignature) {
+        ALOGW("footer didn't match magic string (expected 0x%08x; got 0x%08x)\n",
+                kSignature, fileSig);
         return false;
     }
 
-    mFooterStart = fileOffset;
-
-    char* scanBuf = (char*)malloc(footerSize);
-    if (scanBuf == NULL) {
-        ALOGW("couldn't allocate scanBuf: %s\n", strerror(errno));
+    size_t footerSize = get4LE(footerTag);
+    if (footerSize > (size_t)fileLength - kFooterTagSize
+            || footerSize > kMaxBufSize) {
+        ALOGW("claimed footer size is too large (0x%08zx; file size is 0x%08lld)\n",
+                footerSize, (long long int)fileLength);
         return false;
     }
 
-    actual = TEMP_FAILURE_RETRY(read(fd, scanBuf, footerSize));
-    // readAmount is guaranteed to be less than kMaxBufSize
-    if (actual != (ssize_t)footerSize) {
-        ALOGI("couldn't read ObbFile footer: %s\n", strerror(errno));
-        free(scanBuf);
+    if (footerSize < (kFooterMinSize - kFooterTagSize)) {
+        ALOGW("claimed footer size is too small (0x%zx; minimum size is 0x%x)\n",
+                footerSize, kFooterMinSize - kFooterTagSize);
         return false;
     }
 
+    mFooterStart = fileLength - footerSize - kFooterTagSize;
+
+    // The bounds checks above guarantee the footer lies within the tail.
+    const unsigned char* footer = footerTag - footerSize;
+
 #ifdef DEBUG
-    for (int i = 0; i < footerSize; ++i) {
-        ALOGI("char: 0x%02x\n", scanBuf[i]);
+    for (size_t i = 0; i < footerSize; ++i) {
+        ALOGI("char: 0x%02x\n", footer[i]);
     }
 #endif
 
-    uint32_t sigVersion = get4LE((unsigned char*)scanBuf);
+    uint32_t sigVersion = get4LE(footer);
     if (sigVersion != kSigVersion) {
         ALOGW("Unsupported ObbFile version %d\n", sigVersion);
-        free(scanBuf);
         return false;
     }
 
-    mVersion = (int32_t) get4LE((unsigned char*)scanBuf + kPackageVersionOffset);
-    mFlags = (int32_t) get4LE((unsigned char*)scanBuf + kFlagsOffset);
+    mVersion = (int32_t) get4LE(footer + kPackageVersionOffset);
+    mFlags = (int32_t) get4LE(footer + kFlagsOffset);
 
-    memcpy(&mSalt, (unsigned char*)scanBuf + kSaltOffset, sizeof(mSalt));
+    memcpy(&mSalt, footer + kSaltOffset, sizeof(mSalt));
 
-    size_t packageNameLen = get4LE((unsigned char*)scanBuf + kPackageNameLenOffset);
+    size_t packageNameLen = get4LE(footer + kPackageNameLenOffset);
     if (packageNameLen == 0
             || packageNameLen > (footerSize - kPackageNameOffset)) {
         ALOGW("bad ObbFile package name length (0x%04zx; 0x%04zx possible)\n",
                 packageNameLen, footerSize - kPackageNameOffset);
-        free(scanBuf);
         return false;
     }
 
-    char* packageName = reinterpret_cast<char*>(scanBuf + kPackageNameOffset);
-    mPackageName = String8(const_cast<char*>(packageName), packageNameLen);
-
-    free(scanBuf);
+    mPackageName = String8(reinterpret_cast<const char*>(footer + kPackageNameOffset),
+            packageNameLen);
 
 #ifdef DEBUG
     ALOGI("Obb scan succeeded: packageName=%s, version=%d\n", mPackageName.string(), mVersion);
@@ -234,6 +335,7 @@ bool ObbFile::writeTo(const char* filename)
     }
     success = writeTo(fd);
     close(fd);
+    invalidateCache(filename);
 
 out:
     if (!success) {
@@ -319,6 +421,7 @@ bool ObbFile::removeFrom(const char* filename)
     }
     success = removeFrom(fd);
     close(fd);
+    invalidateCache(filename);
 
 out:
     if (!success) {
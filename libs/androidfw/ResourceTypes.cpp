@@ -29,6 +29,7 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <string>
 #include <type_traits>
 
 #include <android-base/macros.h>
@@ -46,6 +47,18 @@
 #include <binder/TextOutput.h>
 #endif
 
+// Vectorized configuration matching can be disabled (e.g. for debugging) by defining
+// ANDROID_RESTABLE_NO_SIMD_MATCH; the scalar fallback is always compiled on other targets.
+#if !defined(ANDROID_RESTABLE_NO_SIMD_MATCH)
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ANDROID_RESTABLE_USE_NEON_MATCH 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ANDROID_RESTABLE_USE_SSE2_MATCH 1
+#endif
+#endif
+
 #ifndef INT32_MAX
 #define INT32_MAX ((int32_t)(2147483647))
 #endif
@@ -420,12 +433,14 @@ Res_png_9patch* Res_png_9patch::deserialize(void* inData)
 // --------------------------------------------------------------------
 
 ResStringPool::ResStringPool()
-    : mError(NO_INIT), mOwnedData(NULL), mHeader(NULL), mCache(NULL)
+    : mError(NO_INIT), mOwnedData(NULL), mHeader(NULL), mCache(NULL),
+      mSharedDecodeCache(NULL), mSharedDecodeCacheSize(0)
 {
 }
 
 ResStringPool::ResStringPool(const void* data, size_t size, bool copyData)
-    : mError(NO_INIT), mOwnedData(NULL), mHeader(NULL), mCache(NULL)
+    : mError(NO_INIT), mOwnedData(NULL), mHeader(NULL), mCache(NULL),
+      mSharedDecodeCache(NULL), mSharedDecodeCacheSize(0)
 {
     setTo(data, size, copyData);
 }
@@ -668,6 +683,8 @@ void ResStringPool::uninit()
         free(mOwnedData);
         mOwnedData = NULL;
     }
+    mSharedDecodeCache = NULL;
+    mSharedDecodeCacheSize = 0;
 }
 
 /**
@@ -746,6 +763,15 @@ const char16_t* ResStringPool::stringAt(size_t idx, size_t* u16len) const
 
                 // encLen must be less than 0x7FFF due to encoding.
                 if ((uint32_t)(u8str+u8len-strings) < mStringPoolSize) {
+                    // A shared pre-decoded cache serves hits without taking the decode
+                    // lock or touching private memory.
+                    if (mSharedDecodeCache != NULL) {
+                        const char16_t* cached = sharedDecodeCacheAt(idx, u16len);
+                        if (cached != NULL) {
+                            return cached;
+                        }
+                    }
+
                     AutoMutex lock(mDecodeLock);
 
                     if (mCache != NULL && mCache[idx] != NULL) {
@@ -1078,12 +1104,129 @@ bool ResStringPool::isUTF8() const
     return (mHeader->flags&ResStringPool_header::UTF8_FLAG)!=0;
 }
 
+// Layout of the shared pre-decoded cache blob built by serializeDecodeCache(). The
+// header is followed by stringCount entries and then an array of char16_t holding the
+// decoded, null-terminated strings. Only offsets are stored, never pointers, so the
+// blob can be mapped at any address in any process.
+struct SharedDecodeCacheHeader {
+    enum : uint32_t {
+        MAGIC = 0x43454453u,  // "SDEC", little endian
+        VERSION = 1u,
+    };
+    uint32_t magic;
+    uint32_t version;
+    uint32_t stringCount;
+    uint32_t poolSize;  // bytes() of the pool the cache was built from
+};
+
+struct SharedDecodeCacheEntry {
+    enum : uint32_t { NO_STRING = 0xffffffffu };
+    uint32_t offset;  // in char16_t units from the start of the string area
+    uint32_t length;  // in char16_t units, excluding the null terminator
+};
+
+status_t ResStringPool::serializeDecodeCache(std::string* out) const
+{
+    out->clear();
+    if (mError != NO_ERROR) {
+        return mError;
+    }
+    if ((mHeader->flags&ResStringPool_header::UTF8_FLAG) == 0) {
+        // UTF-16 pools are read straight out of the mapped file; nothing to pre-decode.
+        return BAD_TYPE;
+    }
+
+    const uint32_t count = mHeader->stringCount;
+    SharedDecodeCacheHeader header;
+    header.magic = SharedDecodeCacheHeader::MAGIC;
+    header.version = SharedDecodeCacheHeader::VERSION;
+    header.stringCount = count;
+    header.poolSize = static_cast<uint32_t>(bytes());
+    out->append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    Vector<SharedDecodeCacheEntry> entries;
+    entries.resize(count);
+    std::u16string stringArea;
+    for (uint32_t i = 0; i < count; i++) {
+        size_t len;
+        const char16_t* str = stringAt(i, &len);
+        SharedDecodeCacheEntry& entry = entries.editItemAt(i);
+        if (str == NULL) {
+            entry.offset = SharedDecodeCacheEntry::NO_STRING;
+            entry.length = 0;
+            continue;
+        }
+        entry.offset = static_cast<uint32_t>(stringArea.size());
+        entry.length = static_cast<uint32_t>(len);
+        stringArea.append(str, len);
+        stringArea.push_back(0);
+    }
+    out->append(reinterpret_cast<const char*>(entries.array()),
+                count*sizeof(SharedDecodeCacheEntry));
+    out->append(reinterpret_cast<const char*>(stringArea.data()),
+                stringArea.size()*sizeof(char16_t));
+    return NO_ERROR;
+}
+
+status_t ResStringPool::setDecodeCache(const void* data, size_t size)
+{
+    if (mError != NO_ERROR) {
+        return mError;
+    }
+    if (data == NULL || size < sizeof(SharedDecodeCacheHeader)) {
+        return BAD_TYPE;
+    }
+    const SharedDecodeCacheHeader* header = static_cast<const SharedDecodeCacheHeader*>(data);
+    if (header->magic != SharedDecodeCacheHeader::MAGIC
+            || header->version != SharedDecodeCacheHeader::VERSION
+            || header->stringCount != mHeader->stringCount
+            || header->poolSize != bytes()) {
+        ALOGW("Rejecting decode cache that was not built from this string pool");
+        return BAD_TYPE;
+    }
+    if ((size-sizeof(SharedDecodeCacheHeader))/sizeof(SharedDecodeCacheEntry)
+            < header->stringCount) {
+        ALOGW("Decode cache too small to hold %u entries", header->stringCount);
+        return BAD_TYPE;
+    }
+    mSharedDecodeCache = data;
+    mSharedDecodeCacheSize = size;
+    return NO_ERROR;
+}
+
+const char16_t* ResStringPool::sharedDecodeCacheAt(size_t idx, size_t* u16len) const
+{
+    const SharedDecodeCacheHeader* header =
+            static_cast<const SharedDecodeCacheHeader*>(mSharedDecodeCache);
+    if (idx >= header->stringCount) {
+        return NULL;
+    }
+    const SharedDecodeCacheEntry* entries =
+            reinterpret_cast<const SharedDecodeCacheEntry*>(header+1);
+    const SharedDecodeCacheEntry& entry = entries[idx];
+    if (entry.offset == SharedDecodeCacheEntry::NO_STRING) {
+        return NULL;
+    }
+    const size_t stringAreaOffset = sizeof(SharedDecodeCacheHeader)
+            + header->stringCount*sizeof(SharedDecodeCacheEntry);
+    const size_t stringAreaChars = (mSharedDecodeCacheSize-stringAreaOffset)/sizeof(char16_t);
+    // The entry must fit in the string area including its null terminator.
+    if (entry.offset >= stringAreaChars || stringAreaChars-entry.offset <= entry.length) {
+        ALOGW("Bad decode cache: string #%d extends past the end of the cache", (int)idx);
+        return NULL;
+    }
+    const char16_t* strings = reinterpret_cast<const char16_t*>(
+            reinterpret_cast<const uint8_t*>(mSharedDecodeCache)+stringAreaOffset);
+    *u16len = entry.length;
+    return strings+entry.offset;
+}
+
 // --------------------------------------------------------------------
 // --------------------------------------------------------------------
 // --------------------------------------------------------------------
 
 ResXMLParser::ResXMLParser(const ResXMLTree& tree)
-    : mTree(tree), mEventCode(BAD_DOCUMENT)
+    : mTree(tree), mEventCode(BAD_DOCUMENT), mAttributeIndexExt(NULL)
 {
 }
 
@@ -1091,6 +1234,10 @@ void ResXMLParser::restart()
 {
     mCurNode = NULL;
     mEventCode = mTree.mError == NO_ERROR ? START_DOCUMENT : BAD_DOCUMENT;
+    // The tree's data may have been replaced, so a new element could land at
+    // the address the attribute index was built for.
+    mAttributeIndex.clear();
+    mAttributeIndexExt = NULL;
 }
 const ResStringPool& ResXMLParser::getStrings() const
 {
@@ -1404,6 +1551,57 @@ ssize_t ResXMLParser::indexOfAttribute(const char* ns, const char* attr) const
                             attrStr.string(), attrStr.size());
 }
 
+int ResXMLParser::compareAttributeIndexEntry(const AttributeIndexEntry* lhs,
+                                             const AttributeIndexEntry* rhs)
+{
+    if (lhs->ns != rhs->ns) {
+        return lhs->ns < rhs->ns ? -1 : 1;
+    }
+    if (lhs->name != rhs->name) {
+        return lhs->name < rhs->name ? -1 : 1;
+    }
+    return 0;
+}
+
+ssize_t ResXMLParser::searchAttributeIndex(uint32_t nsIndex, uint32_t nameIndex) const
+{
+    if (mCurExt != mAttributeIndexExt) {
+        // First query against this element; build the sorted index.
+        mAttributeIndex.clear();
+        const ResXMLTree_attrExt* tag = (const ResXMLTree_attrExt*)mCurExt;
+        const size_t N = dtohs(tag->attributeCount);
+        for (size_t i=0; i<N; i++) {
+            const ResXMLTree_attribute* attr = (const ResXMLTree_attribute*)
+                (((const uint8_t*)tag)
+                 + dtohs(tag->attributeStart)
+                 + (dtohs(tag->attributeSize)*i));
+            AttributeIndexEntry entry;
+            entry.ns = dtohl(attr->ns.index);
+            entry.name = dtohl(attr->name.index);
+            entry.index = i;
+            mAttributeIndex.add(entry);
+        }
+        mAttributeIndex.sort(compareAttributeIndexEntry);
+        mAttributeIndexExt = mCurExt;
+    }
+
+    const AttributeIndexEntry* entries = mAttributeIndex.array();
+    ssize_t lo = 0;
+    ssize_t hi = mAttributeIndex.size() - 1;
+    while (lo <= hi) {
+        const ssize_t mid = (lo + hi) / 2;
+        const AttributeIndexEntry& entry = entries[mid];
+        if (entry.ns < nsIndex || (entry.ns == nsIndex && entry.name < nameIndex)) {
+            lo = mid + 1;
+        } else if (entry.ns > nsIndex || entry.name > nameIndex) {
+            hi = mid - 1;
+        } else {
+            return entry.index;
+        }
+    }
+    return NAME_NOT_FOUND;
+}
+
 ssize_t ResXMLParser::indexOfAttribute(const char16_t* ns, size_t nsLen,
                                        const char16_t* attr, size_t attrLen) const
 {
@@ -1411,6 +1609,33 @@ ssize_t ResXMLParser::indexOfAttribute(const char16_t* ns, size_t nsLen,
         if (attr == NULL) {
             return NAME_NOT_FOUND;
         }
+
+        // Fast path: map the query strings to their indices in the tree's
+        // string pool and binary search the per-element attribute index,
+        // avoiding a string comparison per attribute.  A string that isn't
+        // in the pool can still match through the comparison loops below if
+        // the pool happens to carry duplicate content, so a miss here only
+        // skips the fast path rather than answering NAME_NOT_FOUND.
+        const ssize_t nameIndex = mTree.mStrings.indexOfString(attr, attrLen);
+        if (nameIndex >= 0) {
+            uint32_t nsIndex = 0xFFFFFFFFu;
+            bool nsFound = true;
+            if (ns != NULL) {
+                const ssize_t found = mTree.mStrings.indexOfString(ns, nsLen);
+                nsFound = found >= 0;
+                if (nsFound) {
+                    nsIndex = static_cast<uint32_t>(found);
+                }
+            }
+            if (nsFound) {
+                const ssize_t idx = searchAttributeIndex(nsIndex,
+                        static_cast<uint32_t>(nameIndex));
+                if (idx >= 0) {
+                    return idx;
+                }
+            }
+        }
+
         const size_t N = getAttributeCount();
         if (mTree.mStrings.isUTF8()) {
             String8 ns8, attr8;
@@ -2676,7 +2901,61 @@ bool ResTable_config::isBetterThan(const ResTable_config& o,
     return isMoreSpecificThan(o);
 }
 
+// Compares the eight packed configuration words of a config against the settings,
+// returning true if every word is either unset (zero, meaning "any") or exactly equal
+// to the corresponding settings word. On NEON/SSE2 targets all eight words are compared
+// in parallel rather than axis by axis.
+static inline bool configWordsWildcardOrEqual(const uint32_t config[8],
+                                              const uint32_t settings[8]) {
+#if defined(ANDROID_RESTABLE_USE_NEON_MATCH)
+    uint32x4_t ok = vdupq_n_u32(0xffffffffu);
+    for (int i = 0; i < 8; i += 4) {
+        const uint32x4_t c = vld1q_u32(config + i);
+        const uint32x4_t s = vld1q_u32(settings + i);
+        ok = vandq_u32(ok, vorrq_u32(vceqq_u32(c, vdupq_n_u32(0)), vceqq_u32(c, s)));
+    }
+    const uint32x2_t folded = vand_u32(vget_low_u32(ok), vget_high_u32(ok));
+    return vget_lane_u32(vpmin_u32(folded, folded), 0) == 0xffffffffu;
+#elif defined(ANDROID_RESTABLE_USE_SSE2_MATCH)
+    __m128i ok = _mm_set1_epi32(-1);
+    for (int i = 0; i < 8; i += 4) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(config + i));
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(settings + i));
+        ok = _mm_and_si128(ok, _mm_or_si128(_mm_cmpeq_epi32(c, _mm_setzero_si128()),
+                                            _mm_cmpeq_epi32(c, s)));
+    }
+    return _mm_movemask_epi8(ok) == 0xffff;
+#else
+    for (int i = 0; i < 8; i++) {
+        if (config[i] != 0 && config[i] != settings[i]) {
+            return false;
+        }
+    }
+    return true;
+#endif
+}
+
 bool ResTable_config::match(const ResTable_config& settings) const {
+    // Fast accept path: if every populated configuration word of this config is identical
+    // to the corresponding settings word, the axis-by-axis checks below cannot fail. This
+    // covers both the default configuration (all words zero) and exact-configuration
+    // entries, which together dominate real lookups. A miss here is never a rejection;
+    // it only means the precise per-axis rules must run.
+    {
+        const uint32_t myWords[8] = {imsi, locale, screenType, input,
+                                     screenSize, version, screenConfig, screenSizeDp};
+        const uint32_t setWords[8] = {settings.imsi, settings.locale, settings.screenType,
+                                      settings.input, settings.screenSize, settings.version,
+                                      settings.screenConfig, settings.screenSizeDp};
+        if (configWordsWildcardOrEqual(myWords, setWords)
+                && (screenConfig2 == 0 || screenConfig2 == settings.screenConfig2)
+                && (locale == 0
+                        || memcmp(localeScript, settings.localeScript,
+                                  sizeof(localeScript)) == 0)) {
+            return true;
+        }
+    }
+
     if (imsi != 0) {
         if (mcc != 0 && mcc != settings.mcc) {
             return false;
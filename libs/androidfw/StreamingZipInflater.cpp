@@ -53,6 +53,8 @@ using namespace android;
 StreamingZipInflater::StreamingZipInflater(int fd, off64_t compDataStart,
         size_t uncompSize, size_t compSize) {
     mFd = fd;
+    mCacheRecentWindows = false;
+    mWindowUseCounter = 0;
     mDataMap = NULL;
     mInFileStart = compDataStart;
     mOutTotalSize = uncompSize;
@@ -72,6 +74,8 @@ StreamingZipInflater::StreamingZipInflater(int fd, off64_t compDataStart,
  */
 StreamingZipInflater::StreamingZipInflater(FileMap* dataMap, size_t uncompSize) {
     mFd = -1;
+    mCacheRecentWindows = false;
+    mWindowUseCounter = 0;
     mDataMap = dataMap;
     mOutTotalSize = uncompSize;
     mInTotalSize = dataMap->getDataLength();
@@ -108,6 +112,7 @@ void StreamingZipInflater::initInflateState() {
     mInflateState.data_type = Z_UNKNOWN;
 
     mOutLastDecoded = mOutDeliverable = mOutCurPosition = 0;
+    mOutBufStart = mStreamPosition = 0;
     mInNextChunkOffset = 0;
     mStreamNeedsInit = true;
 
@@ -138,72 +143,159 @@ ssize_t StreamingZipInflater::read(void* outBuf, size_t count) {
     size_t bytesRead = 0;
     size_t toRead = min_of(count, size_t(mOutTotalSize - mOutCurPosition));
     while (toRead > 0) {
-        // First, write from whatever we already have decoded and ready to go
-        size_t deliverable = min_of(toRead, mOutLastDecoded - mOutDeliverable);
+        // First, write from whatever we already have decoded and ready to go,
+        // either in the live output window or in a recently retained one.
+        const uint8_t* source = NULL;
+        size_t deliverable = 0;
+        if (mOutCurPosition >= mOutBufStart
+                && mOutCurPosition < mOutBufStart + (off64_t) mOutLastDecoded) {
+            mOutDeliverable = mOutCurPosition - mOutBufStart;
+            source = mOutBuf + mOutDeliverable;
+            deliverable = min_of(toRead, mOutLastDecoded - mOutDeliverable);
+        } else {
+            const RecentWindow* window = findRecentWindow(mOutCurPosition);
+            if (window != NULL) {
+                const size_t windowOffset = mOutCurPosition - window->start;
+                source = window->data.get() + windowOffset;
+                deliverable = min_of(toRead, window->length - windowOffset);
+            }
+        }
+
         if (deliverable > 0) {
-            if (outBuf != NULL) memcpy(dest, mOutBuf + mOutDeliverable, deliverable);
+            if (outBuf != NULL) memcpy(dest, source, deliverable);
             mOutDeliverable += deliverable;
             mOutCurPosition += deliverable;
             dest += deliverable;
             bytesRead += deliverable;
             toRead -= deliverable;
+            continue;
         }
 
-        // need more data?  time to decode some.
-        if (toRead > 0) {
-            // if we don't have any data to decode, read some in.  If we're working
-            // from mmapped data this won't happen, because the clipping to total size
-            // will prevent reading off the end of the mapped input chunk.
-            if ((mInflateState.avail_in == 0) && (mDataMap == NULL)) {
-                int err = readNextChunk();
-                if (err < 0) {
-                    ALOGE("Unable to access asset data: %d", err);
-                    if (!mStreamNeedsInit) {
-                        ::inflateEnd(&mInflateState);
-                        initInflateState();
-                    }
-                    return -1;
-                }
-            }
-            // we know we've drained whatever is in the out buffer now, so just
-            // start from scratch there, reading all the input we have at present.
-            mInflateState.next_out = (Bytef*) mOutBuf;
-            mInflateState.avail_out = mOutBufSize;
-
-            /*
-            ALOGV("Inflating to outbuf: avail_in=%u avail_out=%u next_in=%p next_out=%p",
-                    mInflateState.avail_in, mInflateState.avail_out,
-                    mInflateState.next_in, mInflateState.next_out);
-            */
-            int result = Z_OK;
-            if (mStreamNeedsInit) {
-                ALOGV("Initializing zlib to inflate");
-                result = inflateInit2(&mInflateState, -MAX_WBITS);
-                mStreamNeedsInit = false;
+        // Nothing decoded covers the current position, so the stream has to
+        // produce it. If the position is behind the stream, rewind and decode
+        // forward again; windows decoded on the way are retained when the
+        // recent-window cache is active, so repeat seeks get cheaper.
+        if (mOutCurPosition < mStreamPosition) {
+            const off64_t position = mOutCurPosition;
+            if (!mStreamNeedsInit) {
+                ::inflateEnd(&mInflateState);
             }
-            if (result == Z_OK) result = ::inflate(&mInflateState, Z_SYNC_FLUSH);
-            if (result < 0) {
-                // Whoops, inflation failed
-                ALOGE("Error inflating asset: %d", result);
+            initInflateState();
+            mOutCurPosition = position;
+        }
+
+        int err = decodeNextWindow();
+        if (err < 0) {
+            ALOGE("Unable to access asset data: %d", err);
+            if (!mStreamNeedsInit) {
                 ::inflateEnd(&mInflateState);
                 initInflateState();
-                return -1;
-            } else {
-                if (result == Z_STREAM_END) {
-                    // we know we have to have reached the target size here and will
-                    // not try to read any further, so just wind things up.
-                    ::inflateEnd(&mInflateState);
-                }
-
-                // Note how much data we got, and off we go
-                mOutDeliverable = 0;
-                mOutLastDecoded = mOutBufSize - mInflateState.avail_out;
             }
+            return -1;
         }
     }
     return bytesRead;
 }
 
+/*
+ * Decodes the next window of output at mStreamPosition into mOutBuf, stashing the
+ * previous window in the recent-window cache when that cache is active.
+ */
+int StreamingZipInflater::decodeNextWindow() {
+    // if we don't have any data to decode, read some in.  If we're working
+    // from mmapped data this won't happen, because the clipping to total size
+    // will prevent reading off the end of the mapped input chunk.
+    if ((mInflateState.avail_in == 0) && (mDataMap == NULL)) {
+        int err = readNextChunk();
+        if (err < 0) {
+            return err;
+        }
+    }
+
+    if (mCacheRecentWindows) {
+        stashCurrentWindow();
+    }
+
+    // we know we've drained whatever is in the out buffer now, so just
+    // start from scratch there, reading all the input we have at present.
+    mInflateState.next_out = (Bytef*) mOutBuf;
+    mInflateState.avail_out = mOutBufSize;
+
+    /*
+    ALOGV("Inflating to outbuf: avail_in=%u avail_out=%u next_in=%p next_out=%p",
+            mInflateState.avail_in, mInflateState.avail_out,
+            mInflateState.next_in, mInflateState.next_out);
+    */
+    int result = Z_OK;
+    if (mStreamNeedsInit) {
+        ALOGV("Initializing zlib to inflate");
+        result = inflateInit2(&mInflateState, -MAX_WBITS);
+        mStreamNeedsInit = false;
+    }
+    if (result == Z_OK) result = ::inflate(&mInflateState, Z_SYNC_FLUSH);
+    if (result < 0) {
+        // Whoops, inflation failed
+        ALOGE("Error inflating asset: %d", result);
+        return -1;
+    }
+
+    if (result == Z_STREAM_END) {
+        // we know we have to have reached the target size here and will
+        // not try to read any further, so just wind things up.
+        ::inflateEnd(&mInflateState);
+    }
+
+    // Note how much data we got, and off we go
+    mOutDeliverable = 0;
+    mOutBufStart = mStreamPosition;
+    mOutLastDecoded = mOutBufSize - mInflateState.avail_out;
+    mStreamPosition += mOutLastDecoded;
+    return 0;
+}
+
+/*
+ * Copies the live output window into the recent-window cache, replacing the least
+ * recently used slot.
+ */
+void StreamingZipInflater::stashCurrentWindow() {
+    if (mOutLastDecoded == 0) {
+        return;
+    }
+    RecentWindow* victim = &mRecentWindows[0];
+    for (size_t i = 0; i < RECENT_WINDOW_COUNT; i++) {
+        RecentWindow& window = mRecentWindows[i];
+        if (window.start == mOutBufStart && window.length == mOutLastDecoded) {
+            // Already stashed during an earlier pass over this range.
+            window.lastUse = ++mWindowUseCounter;
+            return;
+        }
+        if (window.data == NULL || window.lastUse < victim->lastUse) {
+            victim = &window;
+        }
+    }
+    if (victim->data == NULL) {
+        victim->data.reset(new uint8_t[mOutBufSize]);
+    }
+    memcpy(victim->data.get(), mOutBuf, mOutLastDecoded);
+    victim->start = mOutBufStart;
+    victim->length = mOutLastDecoded;
+    victim->lastUse = ++mWindowUseCounter;
+}
+
+const StreamingZipInflater::RecentWindow* StreamingZipInflater::findRecentWindow(
+        off64_t position) const {
+    for (size_t i = 0; i < RECENT_WINDOW_COUNT; i++) {
+        const RecentWindow& window = mRecentWindows[i];
+        if (window.data != NULL && position >= window.start
+                && position < window.start + (off64_t) window.length) {
+            const_cast<StreamingZipInflater*>(this)->mWindowUseCounter++;
+            const_cast<RecentWindow&>(window).lastUse = mWindowUseCounter;
+            return &window;
+        }
+    }
+    return NULL;
+}
+
 int StreamingZipInflater::readNextChunk() {
     assert(mDataMap == NULL);
 
@@ -221,6 +313,17 @@ int StreamingZipInflater::readNextChunk() {
                 mInNextChunkOffset += didRead;
                 mInflateState.next_in = (Bytef*) mInBuf;
                 mInflateState.avail_in = didRead;
+#if defined(__linux__)
+                // Hint the kernel to start paging in the next window of compressed
+                // data while we inflate this one, so the inflate loop does not
+                // stall on synchronous reads.
+                if (mInNextChunkOffset < mInTotalSize) {
+                    const size_t readahead =
+                            min_of(mInBufSize, mInTotalSize - mInNextChunkOffset);
+                    (void) ::posix_fadvise(mFd, mInFileStart + mInNextChunkOffset,
+                            readahead, POSIX_FADV_WILLNEED);
+                }
+#endif
             }
         }
     }
@@ -232,12 +335,11 @@ int StreamingZipInflater::readNextChunk() {
 // position to the destination.
 off64_t StreamingZipInflater::seekAbsolute(off64_t absoluteInputPosition) {
     if (absoluteInputPosition < mOutCurPosition) {
-        // rewind and reprocess the data from the beginning
-        if (!mStreamNeedsInit) {
-            ::inflateEnd(&mInflateState);
-        }
-        initInflateState();
-        read(NULL, absoluteInputPosition);
+        // This consumer seeks backwards, so start retaining decoded windows; the
+        // read path then serves positions covered by the live output window or a
+        // retained one directly, and only rewinds the stream for the rest.
+        mCacheRecentWindows = true;
+        mOutCurPosition = absoluteInputPosition;
     } else if (absoluteInputPosition > mOutCurPosition) {
         read(NULL, absoluteInputPosition - mOutCurPosition);
     }
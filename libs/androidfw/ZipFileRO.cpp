@@ -94,19 +94,34 @@ ZipFileRO::~ZipFileRO() {
 
 ZipEntryRO ZipFileRO::findEntryByName(const char* entryName) const
 {
-    _ZipEntryRO* data = new _ZipEntryRO;
-
-    data->name = entryName;
-
-    const int32_t error = FindEntry(mHandle, entryName, &(data->entry));
+    // Probe the central-directory hash table before allocating, so misses cost
+    // nothing beyond the lookup itself.
+    ZipEntry entry;
+    const int32_t error = FindEntry(mHandle, entryName, &entry);
     if (error) {
-        delete data;
         return NULL;
     }
 
+    _ZipEntryRO* data = new _ZipEntryRO;
+    data->entry = entry;
+    data->name = entryName;
+
     return (ZipEntryRO) data;
 }
 
+size_t ZipFileRO::findEntriesByName(const char* const* entryNames, size_t count,
+    ZipEntryRO* outEntries) const
+{
+    size_t found = 0;
+    for (size_t i = 0; i < count; i++) {
+        outEntries[i] = findEntryByName(entryNames[i]);
+        if (outEntries[i] != NULL) {
+            found++;
+        }
+    }
+    return found;
+}
+
 /*
  * Get the useful fields from the zip entry.
  *
@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "android-base/macros.h"
 #include "android-base/unique_fd.h"
@@ -108,6 +109,23 @@ class ApkAssets {
   static std::unique_ptr<const ApkAssets> LoadOverlay(const std::string& idmap_path,
                                                       package_property_t flags = 0U);
 
+  // Describes one entry for LoadMany(): the path to load and the property flags Load() or
+  // LoadOverlay() would receive for it. When `overlay` is true, `path` is an idmap path and the
+  // entry is loaded with LoadOverlay().
+  struct LoadParams {
+    std::string path;
+    package_property_t flags = 0U;
+    bool overlay = false;
+  };
+
+  // Loads several APKs concurrently, returning results in the same order as `requests` so the
+  // caller's cookie assignment is identical to issuing the Load()/LoadOverlay() calls one by one.
+  // Entries that fail to load are null in the returned vector, matching the single-load contract.
+  // At most `max_threads` worker threads are used (0 selects a count from hardware_concurrency());
+  // small request counts are loaded sequentially since thread spawn cost would dominate.
+  static std::vector<std::unique_ptr<const ApkAssets>> LoadMany(
+      const std::vector<LoadParams>& requests, size_t max_threads = 0U);
+
   // Creates an ApkAssets from the directory path. File-based resources are read within the
   // directory as if the directory is an APK.
   static std::unique_ptr<const ApkAssets> LoadFromDir(
@@ -229,15 +229,20 @@ private:
         sp<SharedZip> zip;
     };
 
-    Asset* openNonAssetInPathLocked(const char* fileName, AccessMode mode,
+    // Safe to call either with mLock held or on a private copy of the
+    // asset_path, since the zip registry is internally thread-safe.
+    Asset* openNonAssetInPath(const char* fileName, AccessMode mode,
         asset_path& path);
     String8 createPathNameLocked(const asset_path& path, const char* rootDir);
     String8 createZipSourceNameLocked(const String8& zipFileName,
         const String8& dirName, const String8& fileName);
 
-    ZipFileRO* getZipFileLocked(asset_path& path);
-    Asset* openAssetFromFileLocked(const String8& fileName, AccessMode mode);
-    Asset* openAssetFromZipLocked(const ZipFileRO* pZipFile,
+    // Copy the asset path list so a search can proceed without mLock.
+    Vector<asset_path> snapshotAssetPaths();
+
+    ZipFileRO* getZipFile(asset_path& path);
+    Asset* openAssetFromFile(const String8& fileName, AccessMode mode);
+    Asset* openAssetFromZip(const ZipFileRO* pZipFile,
         const ZipEntryRO entry, AccessMode mode, const String8& entryName);
 
     bool scanAndMergeDirLocked(SortedVector<AssetDir::FileInfo>* pMergedInfo,
@@ -301,13 +306,14 @@ private:
      * Manage a set of Zip files.  For each file we need a pointer to the
      * ZipFile and a time_t with the file's modification date.
      *
-     * We currently only have two zip files (current app, "common" app).
-     * (This was originally written for 8, based on app/locale/vendor.)
+     * The set is read-mostly: lookups grab an immutable snapshot under a
+     * brief lock and search it unlocked, and the rare insertion publishes a
+     * copied snapshot, so concurrent asset opens never serialize on the
+     * registry or wait behind another thread's zip parse.
      */
     class ZipSet {
     public:
         ZipSet() = default;
-        ~ZipSet();
 
         /*
          * Return a ZipFileRO structure for a ZipFileRO with the specified
@@ -332,11 +338,17 @@ private:
         bool getOverlay(const String8& path, size_t idx, asset_path* out) const;
 
     private:
-        void closeZip(int idx);
+        // Immutable once published; replaced wholesale when a zip is added.
+        struct Snapshot : public RefBase {
+            Vector<String8> paths;
+            Vector<sp<SharedZip> > zips;
+        };
+
+        sp<const Snapshot> getSnapshot() const;
 
-        int getIndex(const String8& zip) const;
-        mutable Vector<String8> mZipPath;
-        mutable Vector<sp<SharedZip> > mZipFile;
+        // Guards only the snapshot pointer; never held across zip I/O.
+        mutable Mutex mLock;
+        sp<const Snapshot> mSnapshot;
     };
 
     // Protect all internal state.
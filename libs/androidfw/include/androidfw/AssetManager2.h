@@ -72,7 +72,33 @@ struct ResolvedBag {
   Entry entries[0];
 };
 
-struct FindEntryResult;
+struct FindEntryResult {
+  // A pointer to the resource table entry for this resource.
+  // If the size of the entry is > sizeof(ResTable_entry), it can be cast to
+  // a ResTable_map_entry and processed as a bag/map.
+  ResTable_entry_handle entry;
+
+  // The configuration for which the resulting entry was defined. This is already swapped to host
+  // endianness.
+  ResTable_config config;
+
+  // The bitmask of configuration axis with which the resource value varies.
+  uint32_t type_flags;
+
+  // The dynamic package ID map for the package from which this resource came from.
+  const DynamicRefTable* dynamic_ref_table;
+
+  // The package name of the resource.
+  const std::string* package_name;
+
+  // The string pool reference to the type's name. This uses a different string pool than
+  // the global string pool, but this is hidden from the caller.
+  StringPoolRef type_string_ref;
+
+  // The string pool reference to the entry's name. This uses a different string pool than
+  // the global string pool, but this is hidden from the caller.
+  StringPoolRef entry_string_ref;
+};
 
 // AssetManager2 is the main entry point for accessing assets and resources.
 // AssetManager2 provides caching of resources retrieved via the underlying ApkAssets.
@@ -400,6 +426,14 @@ class AssetManager2 {
   // a number of times for each view during View inspection.
   std::unordered_map<uint32_t, std::vector<uint32_t>> cached_bag_resid_stacks_;
 
+  // Cached results of FindEntry for the set configuration. The hot path for the system UI
+  // resolves the same handful of resource IDs over and over again, so a hit here turns a
+  // package-group scan into a single hash probe. Entries are purged by InvalidateCaches()
+  // using the same type_flags logic as cached_bags_. Mutable because FindEntry is const;
+  // AssetManager2 is externally synchronized, so no locking is needed here.
+  mutable std::unordered_map<uint32_t, std::pair<ApkAssetsCookie, FindEntryResult>>
+      cached_resolved_entries_;
+
   // Whether or not to save resource resolution steps
   bool resource_resolution_logging_enabled_ = false;
 
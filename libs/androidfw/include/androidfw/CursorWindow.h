@@ -88,6 +88,7 @@ public:
 
     inline String8 name() { return mName; }
     inline size_t size() { return mSize; }
+    inline void* data() { return mData; }
     inline size_t freeSpace() { return mSize - mHeader->freeOffset; }
     inline uint32_t getNumRows() { return mHeader->numRows; }
     inline uint32_t getNumColumns() { return mHeader->numColumns; }
@@ -108,6 +109,31 @@ public:
     status_t putDouble(uint32_t row, uint32_t column, double value);
     status_t putNull(uint32_t row, uint32_t column);
 
+    /**
+     * One column of a row handed to putRow(). For FIELD_TYPE_STRING the size
+     * includes the null terminator, matching putString().
+     */
+    struct RowField {
+        int32_t type;                // FIELD_TYPE_*
+        union {
+            int64_t l;               // FIELD_TYPE_INTEGER
+            double d;                // FIELD_TYPE_FLOAT
+            struct {
+                const void* data;
+                size_t size;
+            } buffer;                // FIELD_TYPE_STRING / FIELD_TYPE_BLOB
+        } value;
+    };
+
+    /**
+     * Appends a whole row in one pass: allocates the row directory once, then
+     * writes every column with a single bounds check and one payload copy per
+     * field, instead of a slot walk per cell. 'count' must equal the window's
+     * column count. On failure the partial row is backed out and the error
+     * returned, matching the allocRow/put* contract.
+     */
+    status_t putRow(const RowField* fields, size_t count);
+
     /**
      * Gets the field slot at the specified row and column.
      * Returns null if the requested row or column is not in the window.
@@ -168,6 +194,13 @@ private:
     bool mReadOnly;
     Header* mHeader;
 
+    // Writer-side cursor over the row slot chunk list, so sequential fills and
+    // appends resume from the chunk they last touched instead of rescanning the
+    // list from the front for every cell. Read-only windows never use it, as
+    // they may be shared between threads.
+    uint32_t mLastChunkOffset;
+    uint32_t mLastChunkStartRow;
+
     inline void* offsetToPtr(uint32_t offset, uint32_t bufferSize = 0) {
         if (offset >= mSize) {
             ALOGE("Offset %" PRIu32 " out of bounds, max value %zu", offset, mSize);
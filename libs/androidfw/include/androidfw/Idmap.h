@@ -123,11 +123,17 @@ class IdmapResMap {
  private:
   explicit IdmapResMap(const Idmap_data_header* data_header,
                        const Idmap_target_entry* entries,
+                       const std::unordered_map<uint32_t, uint32_t>* entry_index,
                        uint8_t target_assigned_package_id,
                        const OverlayDynamicRefTable* overlay_ref_table);
 
   const Idmap_data_header* data_header_;
   const Idmap_target_entry* entries_;
+
+  // Index from target resource id to the position of its entry in `entries_`, built once when
+  // the idmap is loaded. May be null or empty, in which case lookups binary search `entries_`.
+  const std::unordered_map<uint32_t, uint32_t>* entry_index_;
+
   const uint8_t target_assigned_package_id_;
   const OverlayDynamicRefTable* overlay_ref_table_;
 
@@ -163,8 +169,8 @@ class LoadedIdmap {
   // Returns a mapping from target resource ids to overlay values.
   inline const IdmapResMap GetTargetResourcesMap(
       uint8_t target_assigned_package_id, const OverlayDynamicRefTable* overlay_ref_table) const {
-    return IdmapResMap(data_header_, target_entries_, target_assigned_package_id,
-                       overlay_ref_table);
+    return IdmapResMap(data_header_, target_entries_, &target_entry_index_,
+                       target_assigned_package_id, overlay_ref_table);
   }
 
   // Returns a dynamic reference table for a loaded overlay package.
@@ -187,6 +193,11 @@ class LoadedIdmap {
   const Idmap_overlay_entry* overlay_entries_;
   const std::unique_ptr<ResStringPool> string_pool_;
 
+  // Index from target resource id to the position of its entry in `target_entries_`. Overlay
+  // resolution sits on the AssetManager2 hot path of every themed process, so lookups use this
+  // single hashed load instead of a binary search over the mapped entry array.
+  std::unordered_map<uint32_t, uint32_t> target_entry_index_;
+
   const std::string idmap_path_;
   std::string overlay_apk_path_;
   std::string target_apk_path_;
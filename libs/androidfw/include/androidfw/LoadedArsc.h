@@ -271,6 +271,9 @@ class LoadedPackage {
  private:
   DISALLOW_COPY_AND_ASSIGN(LoadedPackage);
 
+  // LoadedArsc serializes and reconstructs packages when building its pre-parsed index.
+  friend class LoadedArsc;
+
   LoadedPackage();
 
   ResStringPool type_string_pool_;
@@ -307,6 +310,22 @@ class LoadedArsc {
   // Create an empty LoadedArsc. This is used when an APK has no resources.arsc.
   static std::unique_ptr<const LoadedArsc> CreateEmpty();
 
+  // Serializes the pre-parsed package/type-spec index of this table into a flat,
+  // relocatable blob that can be persisted next to the APK (like the idmap cache) and
+  // later passed to LoadFromIndex to skip the chunk-by-chunk parse. `data` must be the
+  // same memory this table was loaded from; its size and a cheap content hash are
+  // recorded so a stale index is rejected. Returns false (leaving `out` empty) if the
+  // table uses features the index format does not carry (currently <overlayable>
+  // definitions and idmap-backed tables), in which case callers keep using Load().
+  bool SerializeIndex(const StringPiece& data, std::string* out) const;
+
+  // Loads a resource table from `data` using an index previously produced by
+  // SerializeIndex against the same table. Every offset in the index is validated
+  // against the bounds of `data` and the stored fingerprint must match, so a stale or
+  // corrupt index degrades to a nullptr return and the caller falls back to Load().
+  static std::unique_ptr<const LoadedArsc> LoadFromIndex(const StringPiece& data,
+                                                         const StringPiece& index);
+
   // Returns the string pool where all string resource values
   // (Res_value::dataType == Res_value::TYPE_STRING) are indexed.
   inline const ResStringPool* GetStringPool() const {
@@ -331,6 +350,10 @@ class LoadedArsc {
 
   std::unique_ptr<ResStringPool> global_string_pool_ = util::make_unique<ResStringPool>();
   std::vector<std::unique_ptr<const LoadedPackage>> packages_;
+
+  // True if the global string pool is backed by an idmap. Such tables reference memory
+  // outside of resources.arsc and cannot be represented by the serialized index.
+  bool has_idmap_ = false;
 };
 
 }  // namespace android
@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 #include <strings.h>
+#include <sys/stat.h>
 
 #include <utils/RefBase.h>
 #include <utils/String8.h>
@@ -132,6 +133,13 @@ private:
     size_t mFooterStart;
 
     bool parseObbFile(int fd);
+    bool parseFooter(const unsigned char* tail, size_t tailLength, off64_t fileLength);
+
+    /* Process-wide cache of parsed footers, keyed by (path, mtime, size), so
+     * repeated mounts of the same OBB do not re-read the file. */
+    bool readFromCache(const char* filename, const struct stat& st);
+    void writeToCache(const char* filename, const struct stat& st) const;
+    static void invalidateCache(const char* filename);
 };
 
 }
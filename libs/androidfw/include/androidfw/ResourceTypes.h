@@ -37,6 +37,7 @@
 
 #include <array>
 #include <memory>
+#include <string>
 
 namespace android {
 
@@ -531,6 +532,19 @@ public:
     bool isSorted() const;
     bool isUTF8() const;
 
+    // Flattens every decoded UTF-8 string of this pool into a relocatable blob that can
+    // be placed in shared memory (e.g. by the zygote) and attached to the same pool in
+    // other processes with setDecodeCache(), so the decode work is done once instead of
+    // per process. Returns BAD_TYPE for UTF-16 pools, which are read directly from the
+    // mapped file and need no decode cache.
+    status_t serializeDecodeCache(std::string* out) const;
+
+    // Attaches a blob previously produced by serializeDecodeCache() for this same pool.
+    // The memory is not owned and must outlive this pool (like setTo without copyData).
+    // The blob is validated against the pool's string count and size; cache hits are
+    // served from the blob without taking the decode lock or allocating.
+    status_t setDecodeCache(const void* data, size_t size);
+
 private:
     status_t                    mError;
     void*                       mOwnedData;
@@ -544,9 +558,12 @@ private:
     uint32_t                    mStringPoolSize;    // number of uint16_t
     const uint32_t*             mStyles;
     uint32_t                    mStylePoolSize;    // number of uint32_t
+    const void*                 mSharedDecodeCache; // not owned, see setDecodeCache()
+    size_t                      mSharedDecodeCacheSize;
 
     const char* stringDecodeAt(size_t idx, const uint8_t* str, const size_t encLen,
                                size_t* outLen) const;
+    const char16_t* sharedDecodeCacheAt(size_t idx, size_t* u16len) const;
 };
 
 /**
@@ -791,14 +808,34 @@ public:
 
 private:
     friend class ResXMLTree;
-    
+
     event_code_t nextNode();
 
+    // One attribute of the current START_TAG, keyed by its namespace and name
+    // string pool indices so lookups compare integers instead of strings.
+    struct AttributeIndexEntry {
+        uint32_t ns;    // namespace string pool index, or 0xFFFFFFFFu if none
+        uint32_t name;  // name string pool index
+        uint32_t index; // position of the attribute in the element
+    };
+    static int compareAttributeIndexEntry(const AttributeIndexEntry* lhs,
+                                          const AttributeIndexEntry* rhs);
+
+    // Binary search the current element's attributes for the given string
+    // pool indices, building the sorted index on the first query against the
+    // element.  Returns the attribute position or NAME_NOT_FOUND.
+    ssize_t searchAttributeIndex(uint32_t nsIndex, uint32_t nameIndex) const;
+
     const ResXMLTree&           mTree;
     event_code_t                mEventCode;
     const ResXMLTree_node*      mCurNode;
     const void*                 mCurExt;
     uint32_t                    mSourceResourceId;
+
+    // Lazily built sorted attribute index; valid while mCurExt is still the
+    // element it was built for.
+    mutable Vector<AttributeIndexEntry> mAttributeIndex;
+    mutable const void*         mAttributeIndexExt;
 };
 
 class DynamicRefTable;
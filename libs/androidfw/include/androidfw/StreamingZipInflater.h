@@ -19,6 +19,7 @@
 
 #include <unistd.h>
 #include <inttypes.h>
+#include <memory>
 #include <zlib.h>
 
 #include <utils/Compat.h>
@@ -50,6 +51,9 @@ public:
 private:
     void initInflateState();
     int readNextChunk();
+    int decodeNextWindow();
+    void stashCurrentWindow();
+    const struct RecentWindow* findRecentWindow(off64_t position) const;
 
     // where to find the uncompressed data
     int mFd;
@@ -77,6 +81,24 @@ private:
     // input state bookkeeping
     size_t mInNextChunkOffset;  // offset from start of blob at which the next input chunk lies
     // the z_stream contains state about input block consumption
+
+    // Backward seeks normally force re-inflating from the start of the stream. Once a
+    // consumer has sought backwards (fonts and XML blocks do this constantly), we start
+    // keeping copies of the most recently decoded output windows so that local backward
+    // seeks are served from memory instead.
+    static const size_t RECENT_WINDOW_COUNT = 4;
+    struct RecentWindow {
+        off64_t start = 0;               // absolute uncompressed offset of the window
+        size_t length = 0;               // decoded bytes held in data
+        size_t lastUse = 0;              // replacement order; larger is more recent
+        std::unique_ptr<uint8_t[]> data;
+    };
+    RecentWindow mRecentWindows[RECENT_WINDOW_COUNT];
+    bool mCacheRecentWindows;   // begins caching after the first backward seek
+    size_t mWindowUseCounter;
+
+    off64_t mOutBufStart;       // absolute uncompressed offset of the first byte in mOutBuf
+    off64_t mStreamPosition;    // absolute offset of the next byte inflate will produce
 };
 
 }
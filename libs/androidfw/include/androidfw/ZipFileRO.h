@@ -92,6 +92,18 @@ public:
      */
     ZipEntryRO findEntryByName(const char* entryName) const;
 
+    /*
+     * Find several entries by name in one call, writing an entry identifier or
+     * NULL per name into 'outEntries' (which must hold 'count' elements). Each
+     * lookup is a single probe of the central-directory hash table and misses
+     * allocate nothing, so this is the preferred way to resolve the batches of
+     * names AssetManager produces when opening assets. Returns the number of
+     * entries found. Found entries must be released individually with
+     * releaseEntry.
+     */
+    size_t findEntriesByName(const char* const* entryNames, size_t count,
+        ZipEntryRO* outEntries) const;
+
 
     /*
      * Start iterating over the list of entries in the zip file. Requires
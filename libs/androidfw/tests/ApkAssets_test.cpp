@@ -28,6 +28,7 @@ using ::android::base::unique_fd;
 using ::com::android::basic::R;
 using ::testing::Eq;
 using ::testing::Ge;
+using ::testing::IsNull;
 using ::testing::NotNull;
 using ::testing::SizeIs;
 using ::testing::StrEq;
@@ -59,6 +60,26 @@ TEST(ApkAssetsTest, LoadApkFromFd) {
   ASSERT_THAT(loaded_apk->GetAssetsProvider()->Open("res/layout/main.xml"), NotNull());
 }
 
+TEST(ApkAssetsTest, LoadManyPreservesRequestOrder) {
+  std::vector<ApkAssets::LoadParams> requests;
+  requests.push_back({GetTestDataPath() + "/basic/basic.apk"});
+  requests.push_back({GetTestDataPath() + "/does-not-exist.apk"});
+  requests.push_back({GetTestDataPath() + "/lib_one/lib_one.apk"});
+  requests.push_back({GetTestDataPath() + "/lib_two/lib_two.apk"});
+  requests.push_back({GetTestDataPath() + "/styles/styles.apk"});
+
+  std::vector<std::unique_ptr<const ApkAssets>> loaded = ApkAssets::LoadMany(requests);
+  ASSERT_THAT(loaded, SizeIs(requests.size()));
+  for (size_t i = 0; i < requests.size(); i++) {
+    if (i == 1u) {
+      EXPECT_THAT(loaded[i], IsNull());
+      continue;
+    }
+    ASSERT_THAT(loaded[i], NotNull());
+    EXPECT_THAT(loaded[i]->GetPath(), StrEq(requests[i].path));
+  }
+}
+
 TEST(ApkAssetsTest, LoadApkAsSharedLibrary) {
   std::unique_ptr<const ApkAssets> loaded_apk =
       ApkAssets::Load(GetTestDataPath() + "/appaslib/appaslib.apk");
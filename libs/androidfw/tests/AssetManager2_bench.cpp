@@ -128,6 +128,68 @@ static void BM_AssetManagerGetResourceFrameworkLocaleOld(benchmark::State& state
 }
 BENCHMARK(BM_AssetManagerGetResourceFrameworkLocaleOld);
 
+// Loads `count` copies of basic.apk. The copies share package id 0x7f, so the
+// AssetManager builds one package group with `count` cookies, the same shape
+// as an app shipped as a large collection of feature/density splits.
+static bool LoadSplitFixture(benchmark::State& state, size_t count,
+                             std::vector<std::unique_ptr<const ApkAssets>>* apk_assets,
+                             std::vector<const ApkAssets*>* apk_assets_ptrs) {
+  const std::string path = GetTestDataPath() + "/basic/basic.apk";
+  for (size_t i = 0; i < count; i++) {
+    std::unique_ptr<const ApkAssets> apk = ApkAssets::Load(path);
+    if (apk == nullptr) {
+      state.SkipWithError("Failed to load assets");
+      return false;
+    }
+    apk_assets_ptrs->push_back(apk.get());
+    apk_assets->push_back(std::move(apk));
+  }
+  return true;
+}
+
+static void BM_AssetManagerGetResourceManySplits(benchmark::State& state) {
+  std::vector<std::unique_ptr<const ApkAssets>> apk_assets;
+  std::vector<const ApkAssets*> apk_assets_ptrs;
+  if (!LoadSplitFixture(state, state.range(0), &apk_assets, &apk_assets_ptrs)) {
+    return;
+  }
+
+  AssetManager2 assets;
+  assets.SetApkAssets(apk_assets_ptrs);
+
+  Res_value value;
+  ResTable_config selected_config;
+  uint32_t flags;
+
+  while (state.KeepRunning()) {
+    ApkAssetsCookie cookie =
+        assets.GetResource(basic::R::integer::number1, false /* may_be_bag */,
+                           0u /* density_override */, &value, &selected_config, &flags);
+    benchmark::DoNotOptimize(cookie);
+  }
+}
+BENCHMARK(BM_AssetManagerGetResourceManySplits)->Arg(2)->Arg(10)->Arg(30);
+
+static void BM_AssetManagerSetConfigurationManySplits(benchmark::State& state) {
+  std::vector<std::unique_ptr<const ApkAssets>> apk_assets;
+  std::vector<const ApkAssets*> apk_assets_ptrs;
+  if (!LoadSplitFixture(state, state.range(0), &apk_assets, &apk_assets_ptrs)) {
+    return;
+  }
+
+  AssetManager2 assets;
+  assets.SetApkAssets(apk_assets_ptrs);
+
+  ResTable_config config;
+  memset(&config, 0, sizeof(config));
+
+  while (state.KeepRunning()) {
+    config.sdkVersion = ~config.sdkVersion;
+    assets.SetConfiguration(config);
+  }
+}
+BENCHMARK(BM_AssetManagerSetConfigurationManySplits)->Arg(2)->Arg(10)->Arg(30);
+
 static void BM_AssetManagerGetBag(benchmark::State& state) {
   std::unique_ptr<const ApkAssets> apk = ApkAssets::Load(GetTestDataPath() + "/styles/styles.apk");
   if (apk == nullptr) {
@@ -71,6 +71,105 @@ TEST(LoadedArscTest, LoadSinglePackageArsc) {
   ASSERT_THAT(LoadedPackage::GetEntry(type, entry_index), NotNull());
 }
 
+TEST(LoadedArscTest, SerializedIndexRoundTrip) {
+  std::string contents;
+  ASSERT_TRUE(ReadFileFromZipToString(GetTestDataPath() + "/styles/styles.apk", "resources.arsc",
+                                      &contents));
+
+  std::unique_ptr<const LoadedArsc> loaded_arsc = LoadedArsc::Load(StringPiece(contents));
+  ASSERT_THAT(loaded_arsc, NotNull());
+
+  std::string index;
+  ASSERT_TRUE(loaded_arsc->SerializeIndex(StringPiece(contents), &index));
+
+  std::unique_ptr<const LoadedArsc> indexed_arsc =
+      LoadedArsc::LoadFromIndex(StringPiece(contents), StringPiece(index));
+  ASSERT_THAT(indexed_arsc, NotNull());
+
+  const LoadedPackage* package =
+      indexed_arsc->GetPackageById(get_package_id(app::R::string::string_one));
+  ASSERT_THAT(package, NotNull());
+  EXPECT_THAT(package->GetPackageName(), StrEq("com.android.app"));
+  EXPECT_THAT(package->GetPackageId(), Eq(0x7f));
+
+  const uint8_t type_index = get_type_id(app::R::string::string_one) - 1;
+  const uint16_t entry_index = get_entry_id(app::R::string::string_one);
+
+  const TypeSpec* type_spec = package->GetTypeSpecByTypeIndex(type_index);
+  ASSERT_THAT(type_spec, NotNull());
+  ASSERT_THAT(type_spec->type_count, Ge(1u));
+  ASSERT_THAT(LoadedPackage::GetEntry(type_spec->types[0], entry_index), NotNull());
+}
+
+TEST(LoadedArscTest, SharedDecodeCacheRoundTrip) {
+  std::string contents;
+  ASSERT_TRUE(ReadFileFromZipToString(GetTestDataPath() + "/basic/basic.apk", "resources.arsc",
+                                      &contents));
+
+  std::unique_ptr<const LoadedArsc> loaded_arsc = LoadedArsc::Load(StringPiece(contents));
+  ASSERT_THAT(loaded_arsc, NotNull());
+
+  // Build the pre-decoded cache from one load of the pool (the zygote side)...
+  std::string decode_cache;
+  const status_t err = loaded_arsc->GetStringPool()->serializeDecodeCache(&decode_cache);
+  if (err == BAD_TYPE) {
+    GTEST_SKIP() << "test table uses a UTF-16 string pool; nothing to pre-decode";
+  }
+  ASSERT_THAT(err, Eq(NO_ERROR));
+
+  // ...and attach it to a second load of the same table (the child side).
+  std::unique_ptr<const LoadedArsc> other_arsc = LoadedArsc::Load(StringPiece(contents));
+  ASSERT_THAT(other_arsc, NotNull());
+  ResStringPool* other_pool = const_cast<ResStringPool*>(other_arsc->GetStringPool());
+  ASSERT_THAT(other_pool->setDecodeCache(decode_cache.data(), decode_cache.size()), Eq(NO_ERROR));
+
+  const ResStringPool* pool = loaded_arsc->GetStringPool();
+  ASSERT_THAT(pool->size(), Eq(other_pool->size()));
+  for (size_t i = 0; i < pool->size(); i++) {
+    size_t len, other_len;
+    const char16_t* str = pool->stringAt(i, &len);
+    const char16_t* other_str = other_pool->stringAt(i, &other_len);
+    ASSERT_THAT(other_len, Eq(len));
+    if (str != nullptr) {
+      ASSERT_THAT(other_str, NotNull());
+      ASSERT_THAT(std::u16string(other_str, other_len), Eq(std::u16string(str, len)));
+    }
+  }
+}
+
+TEST(LoadedArscTest, SerializedIndexRejectsMismatchedTable) {
+  std::string contents;
+  ASSERT_TRUE(ReadFileFromZipToString(GetTestDataPath() + "/styles/styles.apk", "resources.arsc",
+                                      &contents));
+
+  std::unique_ptr<const LoadedArsc> loaded_arsc = LoadedArsc::Load(StringPiece(contents));
+  ASSERT_THAT(loaded_arsc, NotNull());
+
+  std::string index;
+  ASSERT_TRUE(loaded_arsc->SerializeIndex(StringPiece(contents), &index));
+
+  std::string other_contents;
+  ASSERT_TRUE(ReadFileFromZipToString(GetTestDataPath() + "/basic/basic.apk", "resources.arsc",
+                                      &other_contents));
+
+  // The fingerprint of a different table must not validate against this index.
+  EXPECT_THAT(LoadedArsc::LoadFromIndex(StringPiece(other_contents), StringPiece(index)),
+              IsNull());
+}
+
+TEST(LoadedArscTest, SerializedIndexRefusesOverlayable) {
+  std::string contents;
+  ASSERT_TRUE(ReadFileFromZipToString(GetTestDataPath() + "/overlayable/overlayable.apk",
+                                      "resources.arsc", &contents));
+
+  std::unique_ptr<const LoadedArsc> loaded_arsc = LoadedArsc::Load(StringPiece(contents));
+  ASSERT_THAT(loaded_arsc, NotNull());
+
+  std::string index;
+  EXPECT_FALSE(loaded_arsc->SerializeIndex(StringPiece(contents), &index));
+  EXPECT_THAT(index, SizeIs(0u));
+}
+
 TEST(LoadedArscTest, LoadSparseEntryApp) {
   std::string contents;
   ASSERT_TRUE(ReadFileFromZipToString(GetTestDataPath() + "/sparse/sparse.apk", "resources.arsc",
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unistd.h>
+
+#include "benchmark/benchmark.h"
+
+#include "androidfw/ApkAssets.h"
+#include "androidfw/AssetManager2.h"
+#include "androidfw/ResourceTypes.h"
+
+#include "BenchmarkHelpers.h"
+#include "data/overlayable/R.h"
+
+namespace overlayable = com::android::overlayable;
+
+namespace android {
+
+namespace {
+
+// Loads the target/overlayable fixture plus `overlay_count` stacked instances
+// of the overlay idmap, approximating an idmap-heavy device configuration.
+// Returns false (after calling SkipWithError) if any fixture fails to load.
+bool LoadOverlayFixture(benchmark::State& state, size_t overlay_count,
+                        std::vector<std::unique_ptr<const ApkAssets>>* apk_assets,
+                        std::vector<const ApkAssets*>* apk_assets_ptrs) {
+  // Move to the test data directory so the idmap can locate the overlay APK.
+  chdir(GetTestDataPath().c_str());
+
+  std::unique_ptr<const ApkAssets> system_assets = ApkAssets::Load("system/system.apk");
+  if (system_assets == nullptr) {
+    state.SkipWithError("Failed to load system assets");
+    return false;
+  }
+  apk_assets_ptrs->push_back(system_assets.get());
+  apk_assets->push_back(std::move(system_assets));
+
+  std::unique_ptr<const ApkAssets> overlayable_assets =
+      ApkAssets::Load("overlayable/overlayable.apk");
+  if (overlayable_assets == nullptr) {
+    state.SkipWithError("Failed to load overlayable assets");
+    return false;
+  }
+  apk_assets_ptrs->push_back(overlayable_assets.get());
+  apk_assets->push_back(std::move(overlayable_assets));
+
+  for (size_t i = 0; i < overlay_count; i++) {
+    std::unique_ptr<const ApkAssets> overlay_assets =
+        ApkAssets::LoadOverlay("overlay/overlay.idmap");
+    if (overlay_assets == nullptr) {
+      state.SkipWithError("Failed to load overlay assets");
+      return false;
+    }
+    apk_assets_ptrs->push_back(overlay_assets.get());
+    apk_assets->push_back(std::move(overlay_assets));
+  }
+  return true;
+}
+
+}  // namespace
+
+static void BM_OverlayGetOverlaidResource(benchmark::State& state) {
+  std::vector<std::unique_ptr<const ApkAssets>> apk_assets;
+  std::vector<const ApkAssets*> apk_assets_ptrs;
+  if (!LoadOverlayFixture(state, state.range(0), &apk_assets, &apk_assets_ptrs)) {
+    return;
+  }
+
+  AssetManager2 assetmanager;
+  assetmanager.SetApkAssets(apk_assets_ptrs);
+
+  Res_value value;
+  ResTable_config selected_config;
+  uint32_t flags;
+
+  while (state.KeepRunning()) {
+    ApkAssetsCookie cookie = assetmanager.GetResource(
+        overlayable::R::string::overlayable5, false /* may_be_bag */, 0u /* density_override */,
+        &value, &selected_config, &flags);
+    benchmark::DoNotOptimize(cookie);
+  }
+}
+BENCHMARK(BM_OverlayGetOverlaidResource)->Arg(1)->Arg(4)->Arg(8);
+
+static void BM_OverlayGetNotOverlaidResource(benchmark::State& state) {
+  std::vector<std::unique_ptr<const ApkAssets>> apk_assets;
+  std::vector<const ApkAssets*> apk_assets_ptrs;
+  if (!LoadOverlayFixture(state, state.range(0), &apk_assets, &apk_assets_ptrs)) {
+    return;
+  }
+
+  AssetManager2 assetmanager;
+  assetmanager.SetApkAssets(apk_assets_ptrs);
+
+  Res_value value;
+  ResTable_config selected_config;
+  uint32_t flags;
+
+  while (state.KeepRunning()) {
+    // Walks every overlay layer without finding an override, the worst case
+    // for the idmap lookup path.
+    ApkAssetsCookie cookie = assetmanager.GetResource(
+        overlayable::R::string::not_overlayable, false /* may_be_bag */, 0u /* density_override */,
+        &value, &selected_config, &flags);
+    benchmark::DoNotOptimize(cookie);
+  }
+}
+BENCHMARK(BM_OverlayGetNotOverlaidResource)->Arg(1)->Arg(4)->Arg(8);
+
+static void BM_OverlaySetConfiguration(benchmark::State& state) {
+  std::vector<std::unique_ptr<const ApkAssets>> apk_assets;
+  std::vector<const ApkAssets*> apk_assets_ptrs;
+  if (!LoadOverlayFixture(state, state.range(0), &apk_assets, &apk_assets_ptrs)) {
+    return;
+  }
+
+  AssetManager2 assetmanager;
+  assetmanager.SetApkAssets(apk_assets_ptrs);
+
+  ResTable_config config;
+  memset(&config, 0, sizeof(config));
+
+  while (state.KeepRunning()) {
+    config.sdkVersion = ~config.sdkVersion;
+    assetmanager.SetConfiguration(config);
+  }
+}
+BENCHMARK(BM_OverlaySetConfiguration)->Arg(1)->Arg(4)->Arg(8);
+
+}  // namespace android
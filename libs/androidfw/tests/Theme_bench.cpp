@@ -61,6 +61,49 @@ static void BM_ThemeApplyStyleFrameworkOld(benchmark::State& state) {
 }
 BENCHMARK(BM_ThemeApplyStyleFrameworkOld);
 
+static void BM_ThemeSetToFramework(benchmark::State& state) {
+  std::unique_ptr<const ApkAssets> apk = ApkAssets::Load(kFrameworkPath);
+  if (apk == nullptr) {
+    state.SkipWithError("Failed to load assets");
+    return;
+  }
+
+  AssetManager2 assets;
+  assets.SetApkAssets({apk.get()});
+
+  auto source = assets.NewTheme();
+  source->ApplyStyle(kStyleId, false /* force */);
+  auto dest = assets.NewTheme();
+
+  // Exercises the copy taken when a theme is cloned from a populated one, the
+  // path activity launch hits when deriving a theme from the base theme.
+  while (state.KeepRunning()) {
+    dest->SetTo(*source);
+  }
+}
+BENCHMARK(BM_ThemeSetToFramework);
+
+static void BM_ThemeRebaseFramework(benchmark::State& state) {
+  std::unique_ptr<const ApkAssets> apk = ApkAssets::Load(kFrameworkPath);
+  if (apk == nullptr) {
+    state.SkipWithError("Failed to load assets");
+    return;
+  }
+
+  AssetManager2 assets;
+  assets.SetApkAssets({apk.get()});
+
+  auto theme = assets.NewTheme();
+
+  // Configuration changes rebuild themes by clearing and reapplying the style
+  // stack; measure that full churn rather than a one-shot apply.
+  while (state.KeepRunning()) {
+    theme->Clear();
+    theme->ApplyStyle(kStyleId, false /* force */);
+  }
+}
+BENCHMARK(BM_ThemeRebaseFramework);
+
 static void BM_ThemeGetAttribute(benchmark::State& state) {
   std::unique_ptr<const ApkAssets> apk = ApkAssets::Load(kFrameworkPath);
 
@@ -281,6 +281,39 @@ TEST_F(ThemeTest, CopyThemeSameAssetManager) {
   EXPECT_EQ(static_cast<uint32_t>(ResTable_typeSpec::SPEC_PUBLIC), flags);
 }
 
+TEST_F(ThemeTest, CopiedThemesDoNotAliasEachOther) {
+  AssetManager2 assetmanager;
+  assetmanager.SetApkAssets({style_assets_.get()});
+
+  std::unique_ptr<Theme> theme_one = assetmanager.NewTheme();
+  ASSERT_TRUE(theme_one->ApplyStyle(app::R::style::StyleTwo));
+
+  std::unique_ptr<Theme> theme_two = assetmanager.NewTheme();
+  theme_two->SetTo(*theme_one);
+
+  // Mutating the source after the copy must not change the copy.
+  ASSERT_TRUE(theme_one->ApplyStyle(app::R::style::StyleThree, true /* force */));
+
+  Res_value value;
+  uint32_t flags;
+  ApkAssetsCookie cookie;
+
+  // theme_one has the forced attr_five from StyleThree.
+  cookie = theme_one->GetAttribute(app::R::attr::attr_five, &value, &flags);
+  ASSERT_NE(kInvalidCookie, cookie);
+  EXPECT_EQ(Res_value::TYPE_INT_DEC, value.dataType);
+  EXPECT_EQ(5u, value.data);
+
+  // theme_two still sees the attr_five reference from StyleTwo.
+  cookie = theme_two->GetAttribute(app::R::attr::attr_five, &value, &flags);
+  ASSERT_NE(kInvalidCookie, cookie);
+  EXPECT_EQ(Res_value::TYPE_REFERENCE, value.dataType);
+  EXPECT_EQ(app::R::string::string_one, value.data);
+
+  // And attr_six from StyleThree never reached theme_two.
+  EXPECT_EQ(kInvalidCookie, theme_two->GetAttribute(app::R::attr::attr_six, &value, &flags));
+}
+
 TEST_F(ThemeTest, OnlyCopySameAssetsThemeWhenAssetManagersDiffer) {
   AssetManager2 assetmanager_dst;
   assetmanager_dst.SetApkAssets({system_assets_.get(), lib_one_assets_.get(), style_assets_.get(),
@@ -83,6 +83,7 @@ void BaseRenderNodeAnimator::setStartDelay(nsecs_t startDelay) {
 void BaseRenderNodeAnimator::attach(RenderNode* target) {
     mStagingTarget = target;
     onAttached();
+    mCachedDirtyMask = dirtyMask();
 }
 
 void BaseRenderNodeAnimator::start() {
@@ -92,6 +92,11 @@ public:
 
     ANDROID_API virtual uint32_t dirtyMask() = 0;
 
+    // The dirty mask of an animator never changes once it is attached, so the
+    // per-frame animate loop reads this cached copy instead of paying a
+    // virtual call per animator.
+    uint32_t cachedDirtyMask() const { return mCachedDirtyMask; }
+
     void forceEndNow(AnimationContext& context);
     RenderNode* target() { return mTarget; }
     RenderNode* stagingTarget() { return mStagingTarget; }
@@ -153,6 +158,7 @@ protected:
     // Play Time tracks the progress of animation, it should always be [0, mDuration], 0 being
     // the beginning of the animation, will reach mDuration at the end of an animation.
     nsecs_t mPlayTime;
+    uint32_t mCachedDirtyMask = 0;
 
     sp<AnimationListener> mListener;
 
@@ -98,7 +98,7 @@ public:
             : mInfo(info), mContext(context), mDirtyMask(outDirtyMask) {}
 
     bool operator()(sp<BaseRenderNodeAnimator>& animator) {
-        *mDirtyMask |= animator->dirtyMask();
+        *mDirtyMask |= animator->cachedDirtyMask();
         bool remove = animator->animate(mContext);
         if (remove) {
             animator->detach();
@@ -141,6 +141,14 @@ void AnimatorManager::animateNoDamage(TreeInfo& info) {
 }
 
 uint32_t AnimatorManager::animateCommon(TreeInfo& info) {
+    // Note: evaluating animators grouped by property in one batch loop was
+    // considered for heavy scenes, but it doesn't fit this architecture: each
+    // manager only holds the animators of its own node, every animator has
+    // its own interpolator and play-state machine, and subclasses hook
+    // onPlayTimeChanged (e.g. PropertyValuesAnimatorSet), so the per-animator
+    // virtual advance is the contract. The cheap wins are keeping this loop
+    // free of redundant virtual calls and letting remove_if compact the list
+    // in a single pass.
     uint32_t dirtyMask = 0;
     AnimateFunctor functor(info, mAnimationHandle->context(), &dirtyMask);
     auto newEnd = std::remove_if(mAnimators.begin(), mAnimators.end(), functor);
@@ -26,6 +26,8 @@
 
 #include <algorithm>
 #include <cmath>
+#include <mutex>
+#include <unordered_map>
 
 #include <log/log.h>
 #include <SkHighContrastFilter.h>
@@ -54,6 +56,43 @@ static SkColor makeDark(SkColor color) {
     }
 }
 
+// Force-dark rewrites blend-mode color filters while recording, and used to allocate a
+// fresh SkColorFilter for every draw op. The rewritten filters come from a small set of
+// theme colors, so share them across display lists instead. Recording mostly happens on a
+// single thread, but one process can record for several windows at once, hence the lock.
+static sk_sp<SkColorFilter> blendFilterFor(SkColor color, SkBlendMode mode) {
+    static std::mutex sCacheLock;
+    static std::unordered_map<uint64_t, sk_sp<SkColorFilter>> sFilterCache;
+    constexpr size_t kMaxCacheSize = 64;
+
+    const uint64_t key = (static_cast<uint64_t>(color) << 32) | static_cast<uint64_t>(mode);
+    std::lock_guard<std::mutex> lock(sCacheLock);
+    auto it = sFilterCache.find(key);
+    if (it != sFilterCache.end()) {
+        return it->second;
+    }
+    sk_sp<SkColorFilter> filter = SkColorFilters::Blend(color, mode);
+    if (sFilterCache.size() >= kMaxCacheSize) {
+        // The working set is tiny in practice; dumping everything on overflow keeps the
+        // bookkeeping trivial and the next frames repopulate it immediately.
+        sFilterCache.clear();
+    }
+    sFilterCache.emplace(key, filter);
+    return filter;
+}
+
+// The lightness-inverting filter used for mismatched bitmap palettes never varies, so all
+// inverted draws share a single instance and only the composition with the paint's own
+// filter is built per op.
+static sk_sp<SkColorFilter> invertLightnessFilter() {
+    static sk_sp<SkColorFilter> sFilter = [] {
+        SkHighContrastConfig config;
+        config.fInvertStyle = SkHighContrastConfig::InvertStyle::kInvertLightness;
+        return SkHighContrastFilter::Make(config);
+    }();
+    return sFilter;
+}
+
 static SkColor transformColor(ColorTransform transform, SkColor color) {
     switch (transform) {
         case ColorTransform::Light:
@@ -99,10 +138,9 @@ static void applyColorTransform(ColorTransform transform, SkPaint& paint) {
     if (paint.getColorFilter()) {
         SkBlendMode mode;
         SkColor color;
-        // TODO: LRU this or something to avoid spamming new color mode filters
         if (paint.getColorFilter()->asAColorMode(&color, &mode)) {
             color = transformColor(transform, color);
-            paint.setColorFilter(SkColorFilters::Blend(color, mode));
+            paint.setColorFilter(blendFilterFor(color, mode));
         }
     }
 }
@@ -139,9 +177,7 @@ bool transformPaint(ColorTransform transform, SkPaint* paint, BitmapPalette pale
         shouldInvert = true;
     }
     if (shouldInvert) {
-        SkHighContrastConfig config;
-        config.fInvertStyle = SkHighContrastConfig::InvertStyle::kInvertLightness;
-        paint->setColorFilter(SkHighContrastFilter::Make(config)->makeComposed(paint->refColorFilter()));
+        paint->setColorFilter(invertLightnessFilter()->makeComposed(paint->refColorFilter()));
     }
     return shouldInvert;
 }
@@ -24,6 +24,79 @@
 namespace android {
 namespace uirenderer {
 
+void DamageRegion::set(const SkRect& rect) {
+    if (rect.isEmpty()) {
+        mCount = 0;
+    } else {
+        mCount = 1;
+        mRects[0] = rect;
+    }
+}
+
+void DamageRegion::add(const SkRect& rect) {
+    if (rect.isEmpty()) return;
+
+    // Fold into any rect this one already touches; keeping rects separate only
+    // pays off when the damage is disjoint.
+    for (int i = 0; i < mCount; i++) {
+        if (SkRect::Intersects(mRects[i], rect)) {
+            mRects[i].join(rect);
+            return;
+        }
+    }
+
+    if (mCount < kMaxRects) {
+        mRects[mCount++] = rect;
+        return;
+    }
+
+    // The set is full; merge into whichever rect grows the least.
+    int bestIndex = 0;
+    float bestGrowth = 0;
+    for (int i = 0; i < mCount; i++) {
+        SkRect joined = mRects[i];
+        joined.join(rect);
+        const float growth = joined.width() * joined.height() -
+                             mRects[i].width() * mRects[i].height();
+        if (i == 0 || growth < bestGrowth) {
+            bestIndex = i;
+            bestGrowth = growth;
+        }
+    }
+    mRects[bestIndex].join(rect);
+}
+
+void DamageRegion::join(const DamageRegion& other) {
+    for (int i = 0; i < other.mCount; i++) {
+        add(other.mRects[i]);
+    }
+}
+
+void DamageRegion::intersect(const SkRect& bounds) {
+    int kept = 0;
+    for (int i = 0; i < mCount; i++) {
+        SkRect rect = mRects[i];
+        if (rect.intersect(bounds)) {
+            mRects[kept++] = rect;
+        }
+    }
+    mCount = kept;
+}
+
+void DamageRegion::roundOut() {
+    for (int i = 0; i < mCount; i++) {
+        mRects[i].roundOut(&mRects[i]);
+    }
+}
+
+SkRect DamageRegion::computeBounds() const {
+    SkRect bounds = SkRect::MakeEmpty();
+    for (int i = 0; i < mCount; i++) {
+        bounds.join(mRects[i]);
+    }
+    return bounds;
+}
+
 enum TransformType {
     TransformInvalid = 0,
     TransformRenderNode,
@@ -37,9 +110,9 @@ struct DirtyStack {
         const RenderNode* renderNode;
         const Matrix4* matrix4;
     };
-    // When this frame is pop'd, this rect is mapped through the above transform
-    // and applied to the previous (aka parent) frame
-    SkRect pendingDirty;
+    // When this frame is pop'd, these rects are mapped through the above
+    // transform and applied to the previous (aka parent) frame
+    DamageRegion pendingDirty;
     DirtyStack* prev;
     DirtyStack* next;
 };
@@ -133,8 +206,16 @@ static inline void mapRect(const Matrix4* matrix, const SkRect& in, SkRect* out)
     out->join({RECT_ARGS(temp)});
 }
 
+static inline void mapRegion(const Matrix4* matrix, const DamageRegion& in, DamageRegion* out) {
+    for (int i = 0; i < in.count(); i++) {
+        SkRect mapped = SkRect::MakeEmpty();
+        mapRect(matrix, in[i], &mapped);
+        out->add(mapped);
+    }
+}
+
 void DamageAccumulator::applyMatrix4Transform(DirtyStack* frame) {
-    mapRect(frame->matrix4, frame->pendingDirty, &mHead->pendingDirty);
+    mapRegion(frame->matrix4, frame->pendingDirty, &mHead->pendingDirty);
 }
 
 static inline void applyMatrix(const SkMatrix* transform, SkRect* rect) {
@@ -163,6 +244,15 @@ static inline void mapRect(const RenderProperties& props, const SkRect& in, SkRe
     out->join(temp);
 }
 
+static inline void mapRegion(const RenderProperties& props, const DamageRegion& in,
+                             DamageRegion* out) {
+    for (int i = 0; i < in.count(); i++) {
+        SkRect mapped = SkRect::MakeEmpty();
+        mapRect(props, in[i], &mapped);
+        out->add(mapped);
+    }
+}
+
 static DirtyStack* findParentRenderNode(DirtyStack* frame) {
     while (frame->prev != frame) {
         frame = frame->prev;
@@ -186,13 +276,15 @@ static DirtyStack* findProjectionReceiver(DirtyStack* frame) {
 }
 
 static void applyTransforms(DirtyStack* frame, DirtyStack* end) {
-    SkRect* rect = &frame->pendingDirty;
+    DamageRegion* region = &frame->pendingDirty;
     while (frame != end) {
+        DamageRegion mapped;
         if (frame->type == TransformRenderNode) {
-            mapRect(frame->renderNode->properties(), *rect, rect);
+            mapRegion(frame->renderNode->properties(), *region, &mapped);
         } else {
-            mapRect(frame->matrix4, *rect, rect);
+            mapRegion(frame->matrix4, *region, &mapped);
         }
+        *region = mapped;
         frame = frame->prev;
     }
 }
@@ -209,13 +301,11 @@ void DamageAccumulator::applyRenderNodeTransform(DirtyStack* frame) {
 
     // Perform clipping
     if (props.getClipDamageToBounds() && !frame->pendingDirty.isEmpty()) {
-        if (!frame->pendingDirty.intersect(SkRect::MakeIWH(props.getWidth(), props.getHeight()))) {
-            frame->pendingDirty.setEmpty();
-        }
+        frame->pendingDirty.intersect(SkRect::MakeIWH(props.getWidth(), props.getHeight()));
     }
 
     // apply all transforms
-    mapRect(props, frame->pendingDirty, &mHead->pendingDirty);
+    mapRegion(props, frame->pendingDirty, &mHead->pendingDirty);
 
     // project backwards if necessary
     if (props.getProjectBackwards() && !frame->pendingDirty.isEmpty()) {
@@ -233,21 +323,30 @@ void DamageAccumulator::applyRenderNodeTransform(DirtyStack* frame) {
 }
 
 void DamageAccumulator::dirty(float left, float top, float right, float bottom) {
-    mHead->pendingDirty.join({left, top, right, bottom});
+    mHead->pendingDirty.add({left, top, right, bottom});
 }
 
 void DamageAccumulator::peekAtDirty(SkRect* dest) const {
-    *dest = mHead->pendingDirty;
+    *dest = mHead->pendingDirty.computeBounds();
 }
 
 void DamageAccumulator::finish(SkRect* totalDirty) {
     LOG_ALWAYS_FATAL_IF(mHead->prev != mHead, "Cannot finish, mismatched push/pop calls! %p vs. %p",
                         mHead->prev, mHead);
     // Root node never has a transform, so this is the fully mapped dirty rect
-    *totalDirty = mHead->pendingDirty;
+    *totalDirty = mHead->pendingDirty.computeBounds();
     totalDirty->roundOut(totalDirty);
     mHead->pendingDirty.setEmpty();
 }
 
+void DamageAccumulator::finish(DamageRegion* totalDirty) {
+    LOG_ALWAYS_FATAL_IF(mHead->prev != mHead, "Cannot finish, mismatched push/pop calls! %p vs. %p",
+                        mHead->prev, mHead);
+    // Root node never has a transform, so these are the fully mapped dirty rects
+    *totalDirty = mHead->pendingDirty;
+    totalDirty->roundOut();
+    mHead->pendingDirty.setEmpty();
+}
+
 } /* namespace uirenderer */
 } /* namespace android */
@@ -36,6 +36,35 @@ struct DirtyStack;
 class RenderNode;
 class Matrix4;
 
+// A bounded collection of dirty rects. Damage accumulates as up to kMaxRects
+// separate rects; once the set is full an incoming rect is folded into
+// whichever existing rect its union grows the least. This keeps disjoint
+// damage (e.g. two corners of an ambient clock) as two small rects instead of
+// one near-fullscreen union, while never growing beyond a fixed size.
+class DamageRegion {
+public:
+    static constexpr int kMaxRects = 4;
+
+    void setEmpty() { mCount = 0; }
+    bool isEmpty() const { return mCount == 0; }
+    int count() const { return mCount; }
+    const SkRect& operator[](int index) const { return mRects[index]; }
+
+    // Replaces the current contents with the single given rect.
+    void set(const SkRect& rect);
+    // Adds a dirty rect, merging with existing rects as described above.
+    void add(const SkRect& rect);
+    void join(const DamageRegion& other);
+    // Clips every rect to the given bounds, dropping rects that fall outside.
+    void intersect(const SkRect& bounds);
+    void roundOut();
+    SkRect computeBounds() const;
+
+private:
+    int mCount = 0;
+    SkRect mRects[kMaxRects];
+};
+
 class DamageAccumulator {
     PREVENT_COPY_AND_ASSIGN(DamageAccumulator);
 
@@ -62,6 +91,10 @@ public:
 
     void finish(SkRect* totalDirty);
 
+    // Like finish(SkRect*), but returns the damage as the accumulated set of
+    // rects rather than their bounding box.
+    void finish(DamageRegion* totalDirty);
+
 private:
     void pushCommon();
     void applyMatrix4Transform(DirtyStack* frame);
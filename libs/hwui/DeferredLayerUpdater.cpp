@@ -21,6 +21,7 @@
 // TODO: Use public SurfaceTexture APIs once available and include public NDK header file instead.
 #include <surfacetexture/surface_texture_platform.h>
 #include "AutoBackendTextureRelease.h"
+#include "DeviceInfo.h"
 #include "Matrix.h"
 #include "Properties.h"
 #include "renderstate/RenderState.h"
@@ -118,6 +119,40 @@ static status_t fenceWait(int fence, void* handle) {
     return err;
 }
 
+void DeferredLayerUpdater::updateTexImage() {
+    const nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+    if (mLastFrameAvailable > 0) {
+        // Smooth the producer cadence; one long gap (stream start, dropped
+        // frame) shouldn't flip the latch decision for several frames.
+        const nsecs_t interval = now - mLastFrameAvailable;
+        mFrameInterval = mFrameInterval > 0 ? (mFrameInterval * 3 + interval) / 4 : interval;
+    }
+    mLastFrameAvailable = now;
+    mUpdateTexImage = true;
+}
+
+bool DeferredLayerUpdater::shouldDeferLatch() const {
+    if (mLatchDeferred) {
+        // Never defer twice in a row; the frame must land eventually.
+        return false;
+    }
+    if (mImageSlots.empty()) {
+        // Nothing older to show instead, so a stall beats a blank layer.
+        return false;
+    }
+    const nsecs_t vsyncPeriod = DeviceInfo::getVsyncPeriod();
+    if (mFrameInterval < vsyncPeriod + vsyncPeriod / 2) {
+        // The producer keeps up with the display; there is no spare vsync to
+        // defer into, and its fences are usually signaled by sync anyway.
+        return false;
+    }
+    // A slow producer (30fps camera against a 60Hz consumer) tends to queue
+    // right around our sync point with the acquire fence still pending. If
+    // the frame arrived that close to sync, keep the previous image for this
+    // frame; the slow cadence guarantees a spare vsync to latch it in.
+    return systemTime(SYSTEM_TIME_MONOTONIC) - mLastFrameAvailable < vsyncPeriod / 4;
+}
+
 void DeferredLayerUpdater::apply() {
     if (!mLayer) {
         mLayer = new Layer(mRenderState, mColorFilter, mAlpha, mMode);
@@ -132,8 +167,16 @@ void DeferredLayerUpdater::apply() {
             mUpdateTexImage = true;
             ASurfaceTexture_takeConsumerOwnership(mSurfaceTexture.get());
         }
-        if (mUpdateTexImage) {
+        if (mUpdateTexImage && shouldDeferLatch()) {
+            // Leave mUpdateTexImage set: the pending frame (or whatever has
+            // superseded it by then) is latched on the next sync. The fence
+            // waits below are GPU-side on both pipelines, but waiting on a
+            // fence the producer has not signaled yet still stalls the whole
+            // frame's GPU work behind the camera/video pipeline.
+            mLatchDeferred = true;
+        } else if (mUpdateTexImage) {
             mUpdateTexImage = false;
+            mLatchDeferred = false;
             float transformMatrix[16];
             android_dataspace dataspace;
             int slot;
@@ -22,6 +22,7 @@
 #include <android/hardware_buffer.h>
 #include <cutils/compiler.h>
 #include <android/surface_texture.h>
+#include <utils/Timers.h>
 
 #include <map>
 #include <memory>
@@ -70,7 +71,7 @@ public:
 
     ANDROID_API void setSurfaceTexture(AutoTextureRelease&& consumer);
 
-    ANDROID_API void updateTexImage() { mUpdateTexImage = true; }
+    ANDROID_API void updateTexImage();
 
     ANDROID_API void setTransform(const SkMatrix* matrix) {
         delete mTransform;
@@ -101,6 +102,12 @@ private:
      * DeferredLayerUpdater maintains about a slot. Slot id comes from
      * ASurfaceTexture_dequeueBuffer. Usually there are at most 3 slots active at a time.
      */
+    /**
+     * Decides whether this sync should skip latching and keep the previous
+     * image for one more frame. See the comment in apply().
+     */
+    bool shouldDeferLatch() const;
+
     class ImageSlot {
     public:
         ~ImageSlot() { clear(); }
@@ -143,6 +150,12 @@ private:
     bool mGLContextAttached;
     bool mUpdateTexImage;
 
+    // Producer cadence tracking, used to predict whether a frame that arrived
+    // right before sync still has a pending acquire fence.
+    nsecs_t mLastFrameAvailable = 0;
+    nsecs_t mFrameInterval = 0;
+    bool mLatchDeferred = false;
+
     Layer* mLayer;
 };
 
@@ -32,7 +32,12 @@
 #include <utils/GLUtils.h>
 #include <utils/Trace.h>
 #include <utils/TraceUtils.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace android::uirenderer {
 
@@ -184,11 +189,11 @@ private:
 
         {
             ATRACE_FORMAT("CPU -> gralloc transfer (%dx%d)", bitmap.width(), bitmap.height());
-            EGLSyncKHR fence = mUploadThread->queue().runSync([&]() -> EGLSyncKHR {
+            bool uploaded = mUploadThread->queue().runSync([&]() -> bool {
                 AutoSkiaGlTexture glTexture;
                 glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, autoImage.image);
                 if (GLUtils::dumpGLErrors()) {
-                    return EGL_NO_SYNC_KHR;
+                    return false;
                 }
 
                 // glTexSubImage2D is synchronous in sense that it memcpy() from pointer that we
@@ -197,33 +202,72 @@ private:
                 // when we first use it in drawing
                 glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, bitmap.width(), bitmap.height(),
                                 format.format, format.type, bitmap.getPixels());
-                if (GLUtils::dumpGLErrors()) {
-                    return EGL_NO_SYNC_KHR;
-                }
+                return !GLUtils::dumpGLErrors();
+            });
+
+            if (!uploaded) {
+                return false;
+            }
+
+            uint64_t uploadId;
+            {
+                std::lock_guard _lock{mFenceLock};
+                uploadId = ++mSubmittedUploads;
+            }
+            return waitForUploadFence(display, uploadId);
+        }
+    }
+
+    // Blocks until the GPU has consumed the staging pixels of the given upload. All GL work is
+    // serialized on the single upload thread, so one fence created after upload N also covers
+    // every earlier upload; when several decode threads finish a burst of bitmaps at once, the
+    // first waiter creates a fence for the whole batch and the rest piggyback on its signal
+    // instead of each creating and waiting their own.
+    bool waitForUploadFence(EGLDisplay display, uint64_t uploadId) {
+        std::unique_lock lock{mFenceLock};
+        while (uploadId > mSignaledUploads) {
+            if (uploadId <= mFencedUploads) {
+                // Another thread is already waiting on a fence that covers this upload.
+                mFenceSignaled.wait(lock);
+                continue;
+            }
 
+            const uint64_t fencedUploads = mSubmittedUploads;
+            EGLSyncKHR fence = mUploadThread->queue().runSync([]() -> EGLSyncKHR {
                 EGLSyncKHR uploadFence =
                         eglCreateSyncKHR(eglGetCurrentDisplay(), EGL_SYNC_FENCE_KHR, NULL);
                 if (uploadFence == EGL_NO_SYNC_KHR) {
                     ALOGW("Could not create sync fence %#x", eglGetError());
-                };
+                }
                 glFlush();
                 GLUtils::dumpGLErrors();
                 return uploadFence;
             });
-
             if (fence == EGL_NO_SYNC_KHR) {
                 return false;
             }
+            mFencedUploads = fencedUploads;
+
+            lock.unlock();
             EGLint waitStatus = eglClientWaitSyncKHR(display, fence, 0, FENCE_TIMEOUT);
             ALOGE_IF(waitStatus != EGL_CONDITION_SATISFIED_KHR,
                     "Failed to wait for the fence %#x", eglGetError());
-
             eglDestroySyncKHR(display, fence);
+            lock.lock();
+
+            mSignaledUploads = std::max(mSignaledUploads, fencedUploads);
+            mFenceSignaled.notify_all();
         }
         return true;
     }
 
     renderthread::EglManager mEglManager;
+
+    std::mutex mFenceLock;
+    std::condition_variable mFenceSignaled;
+    uint64_t mSubmittedUploads = 0;
+    uint64_t mFencedUploads = 0;
+    uint64_t mSignaledUploads = 0;
 };
 
 class VkUploader : public AHBUploader {
@@ -353,16 +397,89 @@ static FormatInfo determineFormat(const SkBitmap& skBitmap, bool usingGL) {
     return formatInfo;
 }
 
+// The only CPU staging memory this path allocates is the temporary bitmap used to convert
+// unsupported color types (ARGB_4444, GRAY_8 on Vulkan, FP16 without gralloc support) before
+// upload; the GraphicBuffer itself becomes the hardware bitmap's storage and cannot be reused.
+// A burst of decodes hits the conversion once per bitmap, so recycle the backing allocations in
+// power-of-two size tiers instead of paying a fresh allocation and page faults every time. Only
+// small buffers are pooled; anything larger is allocated and freed directly.
+class StagingBufferPool {
+public:
+    static StagingBufferPool& instance() {
+        static StagingBufferPool sPool;
+        return sPool;
+    }
+
+    bool allocateStaging(const SkImageInfo& info, SkBitmap* bitmap) {
+        const size_t rowBytes = info.minRowBytes();
+        const size_t requested = info.computeByteSize(rowBytes);
+        if (requested > kMaxPooledBufferSize) {
+            return false;
+        }
+        const size_t size = tierSize(requested);
+        void* pixels = nullptr;
+        {
+            std::lock_guard _lock{mLock};
+            auto it = mFreeBuffers.find(size);
+            if (it != mFreeBuffers.end() && !it->second.empty()) {
+                pixels = it->second.back();
+                it->second.pop_back();
+                mPooledBytes -= size;
+            }
+        }
+        if (!pixels) {
+            pixels = malloc(size);
+            if (!pixels) {
+                return false;
+            }
+        }
+        return bitmap->installPixels(info, pixels, rowBytes, releaseStaging,
+                                     reinterpret_cast<void*>(size));
+    }
+
+private:
+    static constexpr size_t kMinTierSize = 16 * 1024;
+    static constexpr size_t kMaxPooledBufferSize = 512 * 1024;
+    static constexpr size_t kMaxPooledBytes = 2 * 1024 * 1024;
+
+    static size_t tierSize(size_t requested) {
+        size_t tier = kMinTierSize;
+        while (tier < requested) {
+            tier <<= 1;
+        }
+        return tier;
+    }
+
+    static void releaseStaging(void* pixels, void* context) {
+        const size_t size = reinterpret_cast<size_t>(context);
+        StagingBufferPool& pool = instance();
+        std::lock_guard _lock{pool.mLock};
+        if (pool.mPooledBytes + size <= kMaxPooledBytes) {
+            pool.mFreeBuffers[size].push_back(pixels);
+            pool.mPooledBytes += size;
+        } else {
+            free(pixels);
+        }
+    }
+
+    std::mutex mLock;
+    std::unordered_map<size_t, std::vector<void*>> mFreeBuffers;
+    size_t mPooledBytes = 0;
+};
+
 static SkBitmap makeHwCompatible(const FormatInfo& format, const SkBitmap& source) {
     if (format.isSupported) {
         return source;
     } else {
         SkBitmap bitmap;
-        const SkImageInfo& info = source.info();
-        bitmap.allocPixels(info.makeColorType(kN32_SkColorType));
+        const SkImageInfo info = source.info().makeColorType(kN32_SkColorType);
+        if (!StagingBufferPool::instance().allocateStaging(info, &bitmap)) {
+            bitmap.allocPixels(info);
+        }
 
         SkCanvas canvas(bitmap);
-        canvas.drawColor(0);
+        // Recycled staging memory holds stale pixels, so clear rather than blend over it.
+        canvas.clear(0);
         canvas.drawBitmap(source, 0.0f, 0.0f, nullptr);
 
         return bitmap;
@@ -240,6 +240,13 @@ void JankTracker::finishGpuDraw(const FrameInfo& frame) {
     if (totalGPUDrawTime >= 0) {
         mData->reportGPUFrame(totalGPUDrawTime);
         (*mGlobalData)->reportGPUFrame(totalGPUDrawTime);
+        // finishFrame attributed this frame from CPU-side timestamps alone. Now that the
+        // GPU timeline is known, separately attribute frames where the GPU work itself
+        // overran the frame interval, so telemetry can tell GPU-bound jank from CPU-bound.
+        if (totalGPUDrawTime > mFrameInterval) {
+            mData->reportJankType(JankType::kSlowGpu);
+            (*mGlobalData)->reportJankType(JankType::kSlowGpu);
+        }
     }
 }
 
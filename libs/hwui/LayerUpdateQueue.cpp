@@ -32,6 +32,19 @@ void LayerUpdateQueue::enqueueLayerWithDamage(RenderNode* renderNode, Rect damag
         for (Entry& entry : mEntries) {
             if (CC_UNLIKELY(entry.renderNode == renderNode)) {
                 entry.damage.unionWith(damage);
+                for (Rect& rect : entry.damageRects) {
+                    if (rect.intersects(damage)) {
+                        rect.unionWith(damage);
+                        return;
+                    }
+                }
+                if (entry.damageRects.size() < kMaxDamageRects) {
+                    entry.damageRects.push_back(damage);
+                } else {
+                    // Too fragmented to track separately; fall back to the union.
+                    entry.damageRects.clear();
+                    entry.damageRects.push_back(entry.damage);
+                }
                 return;
             }
         }
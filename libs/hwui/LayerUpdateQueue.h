@@ -36,11 +36,18 @@ class LayerUpdateQueue {
 public:
     struct Entry {
         Entry(RenderNode* renderNode, const Rect& damage)
-                : renderNode(renderNode), damage(damage) {}
+                : renderNode(renderNode), damage(damage), damageRects{damage} {}
         sp<RenderNode> renderNode;
+        // Union of all damage enqueued for the layer.
         Rect damage;
+        // The same damage tracked as separate regions while they stay disjoint, so two small
+        // updates in opposite corners of a large layer don't cost a full-layer repaint. Once
+        // kMaxDamageRects regions accumulate, they collapse back to the union.
+        std::vector<Rect> damageRects;
     };
 
+    static constexpr size_t kMaxDamageRects = 4;
+
     LayerUpdateQueue() {}
     void enqueueLayerWithDamage(RenderNode* renderNode, Rect dirty);
     void clear();
@@ -24,6 +24,18 @@
 
 #include "Matrix.h"
 
+// Vectorized matrix math can be disabled (e.g. for debugging) by defining
+// ANDROID_HWUI_NO_SIMD_MATRIX; the scalar fallback is always compiled on other targets.
+#if !defined(ANDROID_HWUI_NO_SIMD_MATRIX)
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ANDROID_HWUI_USE_NEON_MATRIX 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ANDROID_HWUI_USE_SSE2_MATRIX 1
+#endif
+#endif
+
 namespace android {
 namespace uirenderer {
 
@@ -375,6 +387,34 @@ void Matrix4::loadRotate(float angle, float x, float y, float z) {
 }
 
 void Matrix4::loadMultiply(const Matrix4& u, const Matrix4& v) {
+#if defined(ANDROID_HWUI_USE_NEON_MATRIX)
+    // Load both operands up front so the stores below cannot alias them.
+    const float32x4_t u0 = vld1q_f32(u.data);
+    const float32x4_t u1 = vld1q_f32(u.data + 4);
+    const float32x4_t u2 = vld1q_f32(u.data + 8);
+    const float32x4_t u3 = vld1q_f32(u.data + 12);
+    for (int i = 0; i < 4; i++) {
+        const float* col = v.data + i * 4;
+        float32x4_t r = vmulq_n_f32(u0, col[0]);
+        r = vmlaq_n_f32(r, u1, col[1]);
+        r = vmlaq_n_f32(r, u2, col[2]);
+        r = vmlaq_n_f32(r, u3, col[3]);
+        vst1q_f32(data + i * 4, r);
+    }
+#elif defined(ANDROID_HWUI_USE_SSE2_MATRIX)
+    const __m128 u0 = _mm_loadu_ps(u.data);
+    const __m128 u1 = _mm_loadu_ps(u.data + 4);
+    const __m128 u2 = _mm_loadu_ps(u.data + 8);
+    const __m128 u3 = _mm_loadu_ps(u.data + 12);
+    for (int i = 0; i < 4; i++) {
+        const float* col = v.data + i * 4;
+        __m128 r = _mm_mul_ps(u0, _mm_set1_ps(col[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(u1, _mm_set1_ps(col[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(u2, _mm_set1_ps(col[2])));
+        r = _mm_add_ps(r, _mm_mul_ps(u3, _mm_set1_ps(col[3])));
+        _mm_storeu_ps(data + i * 4, r);
+    }
+#else
     for (int i = 0; i < 4; i++) {
         float x = 0;
         float y = 0;
@@ -394,6 +434,7 @@ void Matrix4::loadMultiply(const Matrix4& u, const Matrix4& v) {
         set(i, 2, z);
         set(i, 3, w);
     }
+#endif
 
     mType = kTypeUnknown;
 }
@@ -476,6 +517,61 @@ void Matrix4::mapRect(Rect& r) const {
 
     float vertices[] = {r.left, r.top, r.right, r.top, r.right, r.bottom, r.left, r.bottom};
 
+#if defined(ANDROID_HWUI_USE_NEON_MATRIX)
+    {
+        // Transform all four corners at once; the perspective divide stays
+        // scalar to keep the 'if (z)' semantics of the fallback exactly.
+        const float32x4_t px = {r.left, r.right, r.right, r.left};
+        const float32x4_t py = {r.top, r.top, r.bottom, r.bottom};
+        const float32x4_t x = vmlaq_n_f32(
+                vmlaq_n_f32(vdupq_n_f32(data[kTranslateX]), px, data[kScaleX]), py, data[kSkewX]);
+        const float32x4_t y = vmlaq_n_f32(
+                vmlaq_n_f32(vdupq_n_f32(data[kTranslateY]), px, data[kSkewY]), py, data[kScaleY]);
+        const float32x4_t z =
+                vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(data[kPerspective2]), px, data[kPerspective0]),
+                            py, data[kPerspective1]);
+        float zs[4];
+        vst1q_f32(zs, z);
+        for (int i = 0; i < 4; i++) {
+            if (zs[i]) zs[i] = 1.0f / zs[i];
+        }
+        const float32x4_t iz = vld1q_f32(zs);
+        float xs[4], ys[4];
+        vst1q_f32(xs, vmulq_f32(x, iz));
+        vst1q_f32(ys, vmulq_f32(y, iz));
+        for (int i = 0; i < 4; i++) {
+            vertices[i * 2] = xs[i];
+            vertices[i * 2 + 1] = ys[i];
+        }
+    }
+#elif defined(ANDROID_HWUI_USE_SSE2_MATRIX)
+    {
+        const __m128 px = _mm_setr_ps(r.left, r.right, r.right, r.left);
+        const __m128 py = _mm_setr_ps(r.top, r.top, r.bottom, r.bottom);
+        const __m128 x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(data[kScaleX])),
+                                               _mm_mul_ps(py, _mm_set1_ps(data[kSkewX]))),
+                                    _mm_set1_ps(data[kTranslateX]));
+        const __m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(data[kSkewY])),
+                                               _mm_mul_ps(py, _mm_set1_ps(data[kScaleY]))),
+                                    _mm_set1_ps(data[kTranslateY]));
+        const __m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(data[kPerspective0])),
+                                               _mm_mul_ps(py, _mm_set1_ps(data[kPerspective1]))),
+                                    _mm_set1_ps(data[kPerspective2]));
+        float zs[4];
+        _mm_storeu_ps(zs, z);
+        for (int i = 0; i < 4; i++) {
+            if (zs[i]) zs[i] = 1.0f / zs[i];
+        }
+        const __m128 iz = _mm_loadu_ps(zs);
+        float xs[4], ys[4];
+        _mm_storeu_ps(xs, _mm_mul_ps(x, iz));
+        _mm_storeu_ps(ys, _mm_mul_ps(y, iz));
+        for (int i = 0; i < 4; i++) {
+            vertices[i * 2] = xs[i];
+            vertices[i * 2 + 1] = ys[i];
+        }
+    }
+#else
     float x, y, z;
 
     for (int i = 0; i < 8; i += 2) {
@@ -490,13 +586,14 @@ void Matrix4::mapRect(Rect& r) const {
         vertices[i] = x * z;
         vertices[i + 1] = y * z;
     }
+#endif
 
     r.left = r.right = vertices[0];
     r.top = r.bottom = vertices[1];
 
     for (int i = 2; i < 8; i += 2) {
-        x = vertices[i];
-        y = vertices[i + 1];
+        const float x = vertices[i];
+        const float y = vertices[i + 1];
 
         if (x < r.left)
             r.left = x;
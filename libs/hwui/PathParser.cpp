@@ -21,13 +21,28 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <utils/Log.h>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace android {
 namespace uirenderer {
 
+/**
+ * Identical path strings are very common across drawables (icon packs reuse
+ * the same path data), so completed parses are interned here. Entries are
+ * copied out on hit: PathData is mutated in place by morphing and
+ * interpolation, so instances cannot be shared between drawables.
+ */
+static std::mutex sPathCacheMutex;
+static std::unordered_map<std::string, PathData>& pathCacheLocked() {
+    static std::unordered_map<std::string, PathData> sCache;
+    return sCache;
+}
+static constexpr size_t kPathCacheMaxEntries = 200;
+
 static size_t nextStart(const char* s, size_t length, size_t startIndex) {
     size_t index = startIndex;
     while (index < length) {
@@ -118,16 +133,17 @@ static float parseFloat(PathParser::ParseResult* result, const char* startPtr,
 }
 
 /**
- * Parse the floats in the string.
+ * Parse the floats in the string, appending them to the output vector.
  *
  * @param s the string containing a command and list of floats
- * @return true on success
+ * @return the number of floats appended
  */
-static void getFloats(std::vector<float>* outPoints, PathParser::ParseResult* result,
-                      const char* pathStr, int start, int end) {
+static size_t getFloats(std::vector<float>* outPoints, PathParser::ParseResult* result,
+                        const char* pathStr, int start, int end) {
     if (pathStr[start] == 'z' || pathStr[start] == 'Z') {
-        return;
+        return 0;
     }
+    const size_t initialCount = outPoints->size();
     int startPosition = start + 1;
     int endPosition = start;
 
@@ -141,7 +157,7 @@ static void getFloats(std::vector<float>* outPoints, PathParser::ParseResult* re
         if (startPosition < endPosition) {
             float currentValue = parseFloat(result, &pathStr[startPosition], end - startPosition);
             if (result->failureOccurred) {
-                return;
+                return outPoints->size() - initialCount;
             }
             outPoints->push_back(currentValue);
         }
@@ -153,7 +169,47 @@ static void getFloats(std::vector<float>* outPoints, PathParser::ParseResult* re
             startPosition = endPosition + 1;
         }
     }
-    return;
+    return outPoints->size() - initialCount;
+}
+
+/**
+ * Estimates the number of verbs and floats in a path string in a single pass,
+ * so the output vectors can be reserved up front. The counting mirrors the
+ * separator rules of extract(); small inaccuracies only affect reservation.
+ */
+static void countVerbsAndFloats(const char* s, size_t start, size_t length, size_t* outVerbs,
+                                size_t* outFloats) {
+    size_t verbs = 0;
+    size_t floats = 0;
+    bool inNumber = false;
+    bool seenDot = false;
+    bool prevExponential = false;
+    for (size_t i = start; i < length; i++) {
+        const char c = s[i];
+        if ((((c - 'A') * (c - 'Z') <= 0) || ((c - 'a') * (c - 'z') <= 0)) && c != 'e' &&
+            c != 'E') {
+            verbs++;
+            inNumber = false;
+        } else if (c == ' ' || c == ',') {
+            inNumber = false;
+        } else if (c == '-' && inNumber && !prevExponential) {
+            // A '-' inside a number starts the next one.
+            floats++;
+            seenDot = false;
+        } else if (c == '.' && inNumber && seenDot) {
+            // A second '.' inside a number starts the next one.
+            floats++;
+        } else if (!inNumber) {
+            floats++;
+            inNumber = true;
+            seenDot = c == '.';
+        } else if (c == '.') {
+            seenDot = true;
+        }
+        prevExponential = c == 'e' || c == 'E';
+    }
+    *outVerbs = verbs;
+    *outFloats = floats;
 }
 
 void PathParser::validateVerbAndPoints(char verb, size_t points, PathParser::ParseResult* result) {
@@ -222,6 +278,16 @@ void PathParser::getPathDataFromAsciiString(PathData* data, ParseResult* result,
         return;
     }
 
+    std::string key(pathStr, strLen);
+    {
+        std::lock_guard<std::mutex> lock(sPathCacheMutex);
+        auto it = pathCacheLocked().find(key);
+        if (it != pathCacheLocked().end()) {
+            *data = it->second;
+            return;
+        }
+    }
+
     size_t start = 0;
     // Skip leading spaces.
     while (isspace(pathStr[start]) && start < strLen) {
@@ -232,13 +298,20 @@ void PathParser::getPathDataFromAsciiString(PathData* data, ParseResult* result,
         result->failureMessage = "Path string cannot be empty.";
         return;
     }
+
+    size_t verbCount;
+    size_t floatCount;
+    countVerbsAndFloats(pathStr, start, strLen, &verbCount, &floatCount);
+    data->verbs.reserve(verbCount);
+    data->verbSizes.reserve(verbCount);
+    data->points.reserve(floatCount);
+
     size_t end = start + 1;
 
     while (end < strLen) {
         end = nextStart(pathStr, strLen, end);
-        std::vector<float> points;
-        getFloats(&points, result, pathStr, start, end);
-        validateVerbAndPoints(pathStr[start], points.size(), result);
+        const size_t pointCount = getFloats(&data->points, result, pathStr, start, end);
+        validateVerbAndPoints(pathStr[start], pointCount, result);
         if (result->failureOccurred) {
             // If either verb or points is not valid, return immediately.
             result->failureMessage += "Failure occurred at position " + std::to_string(start) +
@@ -246,8 +319,7 @@ void PathParser::getPathDataFromAsciiString(PathData* data, ParseResult* result,
             return;
         }
         data->verbs.push_back(pathStr[start]);
-        data->verbSizes.push_back(points.size());
-        data->points.insert(data->points.end(), points.begin(), points.end());
+        data->verbSizes.push_back(pointCount);
         start = end;
         end++;
     }
@@ -263,6 +335,11 @@ void PathParser::getPathDataFromAsciiString(PathData* data, ParseResult* result,
         data->verbs.push_back(pathStr[start]);
         data->verbSizes.push_back(0);
     }
+
+    std::lock_guard<std::mutex> lock(sPathCacheMutex);
+    if (pathCacheLocked().size() < kPathCacheMaxEntries) {
+        pathCacheLocked().emplace(std::move(key), *data);
+    }
 }
 
 void PathParser::dump(const PathData& data) {
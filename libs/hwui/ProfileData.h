@@ -35,6 +35,7 @@ enum JankType {
     kSlowSync,
     kSlowRT,
     kMissedDeadline,
+    kSlowGpu,
 
     // must be last
     NUM_BUCKETS,
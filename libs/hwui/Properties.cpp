@@ -79,6 +79,9 @@ bool Properties::isolatedProcess = false;
 int Properties::contextPriority = 0;
 int Properties::defaultRenderAhead = -1;
 
+int Properties::overlayCachePercent = 50;
+int Properties::alwaysOnCachePercent = 25;
+
 bool Properties::load() {
     bool prevDebugLayersUpdates = debugLayersUpdates;
     bool prevDebugOverdraw = debugOverdraw;
@@ -129,6 +132,11 @@ bool Properties::load() {
     defaultRenderAhead = std::max(-1, std::min(2, base::GetIntProperty(PROPERTY_RENDERAHEAD,
             render_ahead().value_or(0))));
 
+    overlayCachePercent =
+            std::max(5, std::min(100, base::GetIntProperty(PROPERTY_CACHE_PERCENT_OVERLAY, 50)));
+    alwaysOnCachePercent =
+            std::max(5, std::min(100, base::GetIntProperty(PROPERTY_CACHE_PERCENT_ALWAYS_ON, 25)));
+
     return (prevDebugLayersUpdates != debugLayersUpdates) || (prevDebugOverdraw != debugOverdraw);
 }
 
@@ -164,6 +164,21 @@ enum DebugLevel {
 
 #define PROPERTY_RENDERAHEAD "debug.hwui.render_ahead"
 
+/**
+ * Overrides the number of CommonPool worker threads. Unset or <= 0 selects a
+ * count based on the number of cores; values are capped at
+ * CommonPool::MAX_THREAD_COUNT.
+ */
+#define PROPERTY_TASK_THREAD_COUNT "debug.hwui.task_thread_count"
+
+/**
+ * Percentage of the default GPU resource and font cache budgets retained by
+ * processes that classified themselves via RenderProxy::setProcessMemoryPolicy.
+ * Values are clamped to [5, 100].
+ */
+#define PROPERTY_CACHE_PERCENT_OVERLAY "debug.hwui.cache_percent_overlay"
+#define PROPERTY_CACHE_PERCENT_ALWAYS_ON "debug.hwui.cache_percent_always_on"
+
 ///////////////////////////////////////////////////////////////////////////////
 // Misc
 ///////////////////////////////////////////////////////////////////////////////
@@ -179,6 +194,15 @@ enum class OverdrawColorSet { Default = 0, Deuteranomaly };
 
 enum class RenderPipelineType { SkiaGL, SkiaVulkan, NotInitialized = 128 };
 
+/**
+ * How a process expects to use its rendering caches. Default is a regular
+ * foreground app; SystemOverlay covers windows that draw often but little
+ * (status bar, IME); AlwaysOn covers processes that stay resident for days and
+ * rarely redraw (always-on-display, ambient services). CacheManager scales its
+ * cache budgets down for the latter two classes.
+ */
+enum class MemoryPolicy { Default = 0, SystemOverlay, AlwaysOn };
+
 /**
  * Renderthread-only singleton which manages several static rendering properties. Most of these
  * are driven by system properties which are queried once at initialization, and again if init()
@@ -249,6 +273,11 @@ public:
 
     static int defaultRenderAhead;
 
+    // Cache budget retained under each non-default MemoryPolicy, in percent of
+    // the default budgets. See PROPERTY_CACHE_PERCENT_*.
+    static int overlayCachePercent;
+    static int alwaysOnCachePercent;
+
 private:
     static ProfileType sProfileType;
     static bool sDisableProfileBars;
@@ -16,6 +16,7 @@
 
 #include "Readback.h"
 
+#include <GrContext.h>
 #include <sync/sync.h>
 #include <system/window.h>
 #include <ui/GraphicBuffer.h>
@@ -28,6 +29,7 @@
 #include "renderthread/VulkanManager.h"
 #include "utils/Color.h"
 #include "utils/MathUtils.h"
+#include "utils/TimeUtils.h"
 #include "utils/TraceUtils.h"
 
 using namespace android::uirenderer::renderthread;
@@ -35,16 +37,15 @@ using namespace android::uirenderer::renderthread;
 namespace android {
 namespace uirenderer {
 
-CopyResult Readback::copySurfaceInto(ANativeWindow* window, const Rect& srcRect, SkBitmap* bitmap) {
-    ATRACE_CALL();
+CopyResult Readback::acquireSurfaceImage(ANativeWindow* window, sk_sp<SkImage>* outImage,
+                                         Matrix4* outTexTransform) {
     // Setup the source
     AHardwareBuffer* rawSourceBuffer;
     int rawSourceFence;
-    Matrix4 texTransform;
     status_t err = ANativeWindow_getLastQueuedBuffer(window, &rawSourceBuffer, &rawSourceFence,
-                                                     texTransform.data);
+                                                     outTexTransform->data);
     base::unique_fd sourceFence(rawSourceFence);
-    texTransform.invalidateType();
+    outTexTransform->invalidateType();
     if (err != NO_ERROR) {
         ALOGW("Failed to get last queued buffer, error = %d", err);
         return CopyResult::UnknownError;
@@ -70,11 +71,154 @@ CopyResult Readback::copySurfaceInto(ANativeWindow* window, const Rect& srcRect,
 
     sk_sp<SkColorSpace> colorSpace = DataSpaceToColorSpace(
             static_cast<android_dataspace>(ANativeWindow_getBuffersDataSpace(window)));
-    sk_sp<SkImage> image =
+    *outImage =
             SkImage::MakeFromAHardwareBuffer(sourceBuffer.get(), kPremul_SkAlphaType, colorSpace);
+    return CopyResult::Success;
+}
+
+CopyResult Readback::copySurfaceInto(ANativeWindow* window, const Rect& srcRect, SkBitmap* bitmap) {
+    ATRACE_CALL();
+    sk_sp<SkImage> image;
+    Matrix4 texTransform;
+    CopyResult result = acquireSurfaceImage(window, &image, &texTransform);
+    if (result != CopyResult::Success) {
+        return result;
+    }
     return copyImageInto(image, texTransform, srcRect, bitmap);
 }
 
+void Readback::copySurfaceIntoAsync(ANativeWindow* window, const Rect& srcRect, SkBitmap* bitmap,
+                                    CopyFinishedCallback callback) {
+    ATRACE_CALL();
+    // Collecting finished transfers first may free up a ring slot.
+    processPendingReadbacks();
+    if (mPendingReadbacks.size() >= kMaxPendingReadbacks) {
+        ALOGW("Readback ring is full (%zu transfers in flight), dropping the copy request",
+              mPendingReadbacks.size());
+        callback(CopyResult::Timeout);
+        return;
+    }
+
+    sk_sp<SkImage> image;
+    Matrix4 texTransform;
+    CopyResult result = acquireSurfaceImage(window, &image, &texTransform);
+    if (result != CopyResult::Success) {
+        callback(result);
+        return;
+    }
+
+    if (Properties::getRenderPipelineType() == RenderPipelineType::SkiaGL) {
+        mRenderThread.requireGlContext();
+    } else {
+        mRenderThread.requireVkContext();
+    }
+    if (!image.get()) {
+        callback(CopyResult::UnknownError);
+        return;
+    }
+    int imgWidth = image->width();
+    int imgHeight = image->height();
+
+    int displayedWidth = imgWidth, displayedHeight = imgHeight;
+    // If this is a 90 or 270 degree rotation we need to swap width/height to get the device
+    // size.
+    if (texTransform[Matrix4::kSkewX] >= 0.5f || texTransform[Matrix4::kSkewX] <= -0.5f) {
+        std::swap(displayedWidth, displayedHeight);
+    }
+    SkRect skiaDestRect = SkRect::MakeWH(bitmap->width(), bitmap->height());
+    SkRect skiaSrcRect = srcRect.toSkRect();
+    if (skiaSrcRect.isEmpty()) {
+        skiaSrcRect = SkRect::MakeIWH(displayedWidth, displayedHeight);
+    }
+    if (!skiaSrcRect.intersect(SkRect::MakeIWH(displayedWidth, displayedHeight))) {
+        callback(CopyResult::UnknownError);
+        return;
+    }
+
+    sk_sp<SkSurface> tmpSurface = SkSurface::MakeRenderTarget(mRenderThread.getGrContext(),
+                                                              SkBudgeted::kYes, bitmap->info(), 0,
+                                                              kTopLeft_GrSurfaceOrigin, nullptr);
+    if (!tmpSurface.get()) {
+        // The destination format cannot be rendered on the GPU (e.g. 565); fall back to the
+        // synchronous path, which knows how to convert through 8888.
+        callback(copyImageInto(image, texTransform, srcRect, bitmap));
+        return;
+    }
+
+    Layer layer(mRenderThread.renderState(), nullptr, 255, SkBlendMode::kSrc);
+    layer.setSize(displayedWidth, displayedHeight);
+    texTransform.copyTo(layer.getTexTransform());
+    layer.setImage(image);
+    if (!skiapipeline::LayerDrawable::DrawLayer(mRenderThread.getGrContext(),
+                                                tmpSurface->getCanvas(), &layer, &skiaSrcRect,
+                                                &skiaDestRect, false)) {
+        ALOGW("Unable to draw content from GPU into the readback surface");
+        callback(CopyResult::UnknownError);
+        return;
+    }
+
+    auto pending = std::make_unique<PendingReadback>();
+    pending->surface = tmpSurface;
+    pending->bitmap = bitmap;
+    pending->callback = std::move(callback);
+    tmpSurface->asyncRescaleAndReadPixels(
+            bitmap->info(), SkIRect::MakeWH(bitmap->width(), bitmap->height()),
+            SkSurface::RescaleGamma::kSrc, kNone_SkFilterQuality, onAsyncReadbackDone,
+            pending.get());
+    // The transfer is not handed to the GPU until the surface is flushed.
+    tmpSurface->flush();
+    mPendingReadbacks.push_back(std::move(pending));
+    schedulePendingReadbackCheck();
+}
+
+void Readback::onAsyncReadbackDone(SkSurface::ReadPixelsContext context, const void* data,
+                                   size_t rowBytes) {
+    // Called on RenderThread, from inside a flush or checkAsyncWorkCompletion, once the
+    // transfer fence has signaled. A null data pointer reports failure.
+    PendingReadback* pending = static_cast<PendingReadback*>(context);
+    if (data) {
+        SkPixmap srcPixmap(pending->bitmap->info(), data, rowBytes);
+        if (pending->bitmap->writePixels(srcPixmap)) {
+            pending->bitmap->notifyPixelsChanged();
+            pending->result = CopyResult::Success;
+        }
+    }
+    pending->complete = true;
+}
+
+void Readback::processPendingReadbacks() {
+    if (mPendingReadbacks.empty()) {
+        return;
+    }
+    if (GrContext* grContext = mRenderThread.getGrContext()) {
+        // Gives Skia a chance to notice which transfer fences have signaled and run
+        // their completion callbacks.
+        grContext->checkAsyncWorkCompletion();
+    }
+    for (auto it = mPendingReadbacks.begin(); it != mPendingReadbacks.end();) {
+        if ((*it)->complete) {
+            (*it)->callback((*it)->result);
+            it = mPendingReadbacks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void Readback::schedulePendingReadbackCheck() {
+    if (mCheckScheduled || mPendingReadbacks.empty()) {
+        return;
+    }
+    mCheckScheduled = true;
+    // Poll roughly every quarter frame; the transfers typically finish with the
+    // frame they were issued against.
+    mRenderThread.queue().postAt(systemTime(SYSTEM_TIME_MONOTONIC) + 4_ms, [this]() {
+        mCheckScheduled = false;
+        processPendingReadbacks();
+        schedulePendingReadbackCheck();
+    });
+}
+
 CopyResult Readback::copyHWBitmapInto(Bitmap* hwBitmap, SkBitmap* bitmap) {
     LOG_ALWAYS_FATAL_IF(!hwBitmap->isHardware());
 
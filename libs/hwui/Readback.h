@@ -21,6 +21,11 @@
 #include "renderthread/RenderThread.h"
 
 #include <SkBitmap.h>
+#include <SkSurface.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
 
 namespace android {
 class Bitmap;
@@ -49,6 +54,17 @@ public:
      */
     CopyResult copySurfaceInto(ANativeWindow* window, const Rect& srcRect, SkBitmap* bitmap);
 
+    using CopyFinishedCallback = std::function<void(CopyResult)>;
+
+    /**
+     * Same as copySurfaceInto, but the GPU transfer runs asynchronously instead of stalling
+     * RenderThread; the callback is invoked on RenderThread once the pixels have landed in the
+     * bitmap. The bitmap must stay valid until then. At most kMaxPendingReadbacks transfers can
+     * be in flight; requests beyond that complete immediately with CopyResult::Timeout.
+     */
+    void copySurfaceIntoAsync(ANativeWindow* window, const Rect& srcRect, SkBitmap* bitmap,
+                              CopyFinishedCallback callback);
+
     CopyResult copyHWBitmapInto(Bitmap* hwBitmap, SkBitmap* bitmap);
 
     CopyResult copyLayerInto(DeferredLayerUpdater* layer, SkBitmap* bitmap);
@@ -60,7 +76,30 @@ private:
     bool copyLayerInto(Layer* layer, const SkRect* srcRect, const SkRect* dstRect,
                        SkBitmap* bitmap);
 
+    CopyResult acquireSurfaceImage(ANativeWindow* window, sk_sp<SkImage>* outImage,
+                                   Matrix4* outTexTransform);
+
+    struct PendingReadback {
+        // Keeps the GPU-side pixels alive until the transfer has been collected.
+        sk_sp<SkSurface> surface;
+        SkBitmap* bitmap;
+        CopyFinishedCallback callback;
+        bool complete = false;
+        CopyResult result = CopyResult::UnknownError;
+    };
+
+    static void onAsyncReadbackDone(SkSurface::ReadPixelsContext context, const void* data,
+                                    size_t rowBytes);
+    void processPendingReadbacks();
+    void schedulePendingReadbackCheck();
+
+    // Deep enough that a steady consumer reading frame N-2 never finds the ring full, small
+    // enough to bound the GPU memory pinned by in-flight transfers.
+    static constexpr size_t kMaxPendingReadbacks = 3;
+
     renderthread::RenderThread& mRenderThread;
+    std::vector<std::unique_ptr<PendingReadback>> mPendingReadbacks;
+    bool mCheckScheduled = false;
 };
 
 }  // namespace uirenderer
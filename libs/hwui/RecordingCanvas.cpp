@@ -34,6 +34,7 @@
 #include "SkTextBlob.h"
 #include "SkVertices.h"
 
+#include <algorithm>
 #include <experimental/type_traits>
 
 namespace android {
@@ -527,8 +528,11 @@ void* DisplayListData::push(size_t pod, Args&&... args) {
     SkASSERT(skip < (1 << 24));
     if (fUsed + skip > fReserved) {
         static_assert(SkIsPow2(SKLITEDL_PAGE), "This math needs updating for non-pow2.");
-        // Next greater multiple of SKLITEDL_PAGE.
-        fReserved = (fUsed + skip + SKLITEDL_PAGE) & ~(SKLITEDL_PAGE - 1);
+        // Grow geometrically, to the next greater multiple of SKLITEDL_PAGE. Growing one page
+        // at a time made recording a deep hierarchy quadratic in ops recorded: every page of
+        // growth paid a realloc that could copy the whole buffer.
+        size_t needed = (fUsed + skip + SKLITEDL_PAGE) & ~(SKLITEDL_PAGE - 1);
+        fReserved = std::max(needed, fReserved * 2);
         fBytes.realloc(fReserved);
     }
     SkASSERT(fUsed + skip <= fReserved);
@@ -713,20 +717,9 @@ void DisplayListData::drawWebView(skiapipeline::FunctorDrawable* drawable) {
     this->push<DrawWebView>(0, drawable);
 }
 
-typedef void (*draw_fn)(const void*, SkCanvas*, const SkMatrix&);
 typedef void (*void_fn)(const void*);
 typedef void (*color_transform_fn)(const void*, ColorTransform);
 
-// All ops implement draw().
-#define X(T)                                                    \
-    [](const void* op, SkCanvas* c, const SkMatrix& original) { \
-        ((const T*)op)->draw(c, original);                      \
-    },
-static const draw_fn draw_fns[] = {
-#include "DisplayListOps.in"
-};
-#undef X
-
 // Most state ops (matrix, clip, save, restore) have a trivial destructor.
 #define X(T)                                                                                 \
     !std::is_trivially_destructible<T>::value ? [](const void* op) { ((const T*)op)->~T(); } \
@@ -739,7 +732,25 @@ static const void_fn dtor_fns[] = {
 
 void DisplayListData::draw(SkCanvas* canvas) const {
     SkAutoCanvasRestore acr(canvas, false);
-    this->map(draw_fns, canvas, canvas->getTotalMatrix());
+    const SkMatrix original = canvas->getTotalMatrix();
+    // Replay is the hottest loop on the RenderThread, so unlike the other op
+    // walks this one dispatches through a generated switch rather than map():
+    // the compiler turns it into a single jump table and can inline the small
+    // hot ops (rects, rrects, text blobs) straight into the sweep instead of
+    // paying an indirect call per op.
+    auto end = fBytes.get() + fUsed;
+    for (const uint8_t* ptr = fBytes.get(); ptr < end;) {
+        auto op = (const Op*)ptr;
+        switch ((Type)op->type) {
+#define X(T)                                         \
+    case Type::T:                                    \
+        ((const T*)op)->draw(canvas, original);      \
+        break;
+#include "DisplayListOps.in"
+#undef X
+        }
+        ptr += op->skip;
+    }
 }
 
 DisplayListData::~DisplayListData() {
@@ -751,6 +762,8 @@ void DisplayListData::reset() {
 
     // Leave fBytes and fReserved alone.
     fUsed = 0;
+    mContentBounds.setEmpty();
+    mContentBoundsKnown = true;
 }
 
 template <class T>
@@ -814,6 +827,30 @@ sk_sp<SkSurface> RecordingCanvas::onNewSurface(const SkImageInfo&, const SkSurfa
     return nullptr;
 }
 
+void RecordingCanvas::trackDrawBounds(const SkRect& bounds, const SkPaint* paint) {
+    if (!fDL->mContentBoundsKnown) {
+        return;
+    }
+    SkRect mapped = bounds;
+    if (paint) {
+        if (!paint->canComputeFastBounds()) {
+            trackUnboundedDraw();
+            return;
+        }
+        mapped = paint->computeFastBounds(mapped, &mapped);
+    }
+    getTotalMatrix().mapRect(&mapped, mapped);
+    if (!mapped.isFinite()) {
+        trackUnboundedDraw();
+        return;
+    }
+    fDL->mContentBounds.join(mapped);
+}
+
+void RecordingCanvas::trackUnboundedDraw() {
+    fDL->mContentBoundsKnown = false;
+}
+
 void RecordingCanvas::onFlush() {
     fDL->flush();
 }
@@ -823,6 +860,12 @@ void RecordingCanvas::willSave() {
     fDL->save();
 }
 SkCanvas::SaveLayerStrategy RecordingCanvas::getSaveLayerStrategy(const SaveLayerRec& rec) {
+    // A backdrop or an image filter on the layer paint can draw beyond the
+    // bounds of the ops recorded inside the layer.
+    if (rec.fBackdrop || (rec.fPaint && (rec.fPaint->getImageFilter() ||
+                                         !rec.fPaint->canComputeFastBounds()))) {
+        trackUnboundedDraw();
+    }
     fDL->saveLayer(rec.fBounds, rec.fPaint, rec.fBackdrop, rec.fClipMask, rec.fClipMatrix,
                    rec.fSaveLayerFlags);
     return SkCanvas::kNoLayer_SaveLayerStrategy;
@@ -885,39 +928,62 @@ void RecordingCanvas::onClipRegion(const SkRegion& region, SkClipOp op) {
 }
 
 void RecordingCanvas::onDrawPaint(const SkPaint& paint) {
+    trackUnboundedDraw();  // fills whatever the clip is at draw time
     fDL->drawPaint(paint);
 }
 void RecordingCanvas::onDrawBehind(const SkPaint& paint) {
+    trackUnboundedDraw();  // fills whatever the clip is at draw time
     fDL->drawBehind(paint);
 }
 void RecordingCanvas::onDrawPath(const SkPath& path, const SkPaint& paint) {
+    if (path.isInverseFillType()) {
+        trackUnboundedDraw();
+    } else {
+        trackDrawBounds(path.getBounds(), &paint);
+    }
     fDL->drawPath(path, paint);
 }
 void RecordingCanvas::onDrawRect(const SkRect& rect, const SkPaint& paint) {
+    trackDrawBounds(rect, &paint);
     fDL->drawRect(rect, paint);
 }
 void RecordingCanvas::onDrawRegion(const SkRegion& region, const SkPaint& paint) {
+    trackDrawBounds(SkRect::Make(region.getBounds()), &paint);
     fDL->drawRegion(region, paint);
 }
 void RecordingCanvas::onDrawOval(const SkRect& oval, const SkPaint& paint) {
+    trackDrawBounds(oval, &paint);
     fDL->drawOval(oval, paint);
 }
 void RecordingCanvas::onDrawArc(const SkRect& oval, SkScalar startAngle, SkScalar sweepAngle,
                                 bool useCenter, const SkPaint& paint) {
+    trackDrawBounds(oval, &paint);
     fDL->drawArc(oval, startAngle, sweepAngle, useCenter, paint);
 }
 void RecordingCanvas::onDrawRRect(const SkRRect& rrect, const SkPaint& paint) {
+    trackDrawBounds(rrect.rect(), &paint);
     fDL->drawRRect(rrect, paint);
 }
 void RecordingCanvas::onDrawDRRect(const SkRRect& out, const SkRRect& in, const SkPaint& paint) {
+    trackDrawBounds(out.rect(), &paint);
     fDL->drawDRRect(out, in, paint);
 }
 
 void RecordingCanvas::onDrawDrawable(SkDrawable* drawable, const SkMatrix* matrix) {
+    SkRect bounds = drawable->getBounds();
+    if (matrix) {
+        matrix->mapRect(&bounds);
+    }
+    trackDrawBounds(bounds);
     fDL->drawDrawable(drawable, matrix);
 }
 void RecordingCanvas::onDrawPicture(const SkPicture* picture, const SkMatrix* matrix,
                                     const SkPaint* paint) {
+    SkRect bounds = picture->cullRect();
+    if (matrix) {
+        matrix->mapRect(&bounds);
+    }
+    trackDrawBounds(bounds, paint);
     fDL->drawPicture(picture, matrix, paint);
 }
 void RecordingCanvas::onDrawAnnotation(const SkRect& rect, const char key[], SkData* val) {
@@ -926,35 +992,44 @@ void RecordingCanvas::onDrawAnnotation(const SkRect& rect, const char key[], SkD
 
 void RecordingCanvas::onDrawTextBlob(const SkTextBlob* blob, SkScalar x, SkScalar y,
                                      const SkPaint& paint) {
+    trackDrawBounds(blob->bounds().makeOffset(x, y), &paint);
     fDL->drawTextBlob(blob, x, y, paint);
 }
 
 void RecordingCanvas::onDrawBitmap(const SkBitmap& bm, SkScalar x, SkScalar y,
                                    const SkPaint* paint) {
+    trackDrawBounds(SkRect::MakeXYWH(x, y, bm.width(), bm.height()), paint);
     fDL->drawImage(SkImage::MakeFromBitmap(bm), x, y, paint, BitmapPalette::Unknown);
 }
 void RecordingCanvas::onDrawBitmapNine(const SkBitmap& bm, const SkIRect& center, const SkRect& dst,
                                        const SkPaint* paint) {
+    trackDrawBounds(dst, paint);
     fDL->drawImageNine(SkImage::MakeFromBitmap(bm), center, dst, paint);
 }
 void RecordingCanvas::onDrawBitmapRect(const SkBitmap& bm, const SkRect* src, const SkRect& dst,
                                        const SkPaint* paint, SrcRectConstraint constraint) {
+    trackDrawBounds(dst, paint);
     fDL->drawImageRect(SkImage::MakeFromBitmap(bm), src, dst, paint, constraint,
                        BitmapPalette::Unknown);
 }
 void RecordingCanvas::onDrawBitmapLattice(const SkBitmap& bm, const SkCanvas::Lattice& lattice,
                                           const SkRect& dst, const SkPaint* paint) {
+    trackDrawBounds(dst, paint);
     fDL->drawImageLattice(SkImage::MakeFromBitmap(bm), lattice, dst, paint, BitmapPalette::Unknown);
 }
 
 void RecordingCanvas::drawImage(const sk_sp<SkImage>& image, SkScalar x, SkScalar y,
                                 const SkPaint* paint, BitmapPalette palette) {
+    if (image) {
+        trackDrawBounds(SkRect::MakeXYWH(x, y, image->width(), image->height()), paint);
+    }
     fDL->drawImage(image, x, y, paint, palette);
 }
 
 void RecordingCanvas::drawImageRect(const sk_sp<SkImage>& image, const SkRect& src,
                                     const SkRect& dst, const SkPaint* paint,
                                     SrcRectConstraint constraint, BitmapPalette palette) {
+    trackDrawBounds(dst, paint);
     fDL->drawImageRect(image, &src, dst, paint, constraint, palette);
 }
 
@@ -964,6 +1039,7 @@ void RecordingCanvas::drawImageLattice(const sk_sp<SkImage>& image, const Lattic
     if (!image || dst.isEmpty()) {
         return;
     }
+    trackDrawBounds(dst, paint);
 
     SkIRect bounds;
     Lattice latticePlusBounds = lattice;
@@ -982,49 +1058,71 @@ void RecordingCanvas::drawImageLattice(const sk_sp<SkImage>& image, const Lattic
 
 void RecordingCanvas::onDrawImage(const SkImage* img, SkScalar x, SkScalar y,
                                   const SkPaint* paint) {
+    if (img) {
+        trackDrawBounds(SkRect::MakeXYWH(x, y, img->width(), img->height()), paint);
+    }
     fDL->drawImage(sk_ref_sp(img), x, y, paint, BitmapPalette::Unknown);
 }
 void RecordingCanvas::onDrawImageNine(const SkImage* img, const SkIRect& center, const SkRect& dst,
                                       const SkPaint* paint) {
+    trackDrawBounds(dst, paint);
     fDL->drawImageNine(sk_ref_sp(img), center, dst, paint);
 }
 void RecordingCanvas::onDrawImageRect(const SkImage* img, const SkRect* src, const SkRect& dst,
                                       const SkPaint* paint, SrcRectConstraint constraint) {
+    trackDrawBounds(dst, paint);
     fDL->drawImageRect(sk_ref_sp(img), src, dst, paint, constraint, BitmapPalette::Unknown);
 }
 void RecordingCanvas::onDrawImageLattice(const SkImage* img, const SkCanvas::Lattice& lattice,
                                          const SkRect& dst, const SkPaint* paint) {
+    trackDrawBounds(dst, paint);
     fDL->drawImageLattice(sk_ref_sp(img), lattice, dst, paint, BitmapPalette::Unknown);
 }
 
 void RecordingCanvas::onDrawPatch(const SkPoint cubics[12], const SkColor colors[4],
                                   const SkPoint texCoords[4], SkBlendMode bmode,
                                   const SkPaint& paint) {
+    SkRect bounds;
+    bounds.setBounds(cubics, 12);
+    trackDrawBounds(bounds, &paint);
     fDL->drawPatch(cubics, colors, texCoords, bmode, paint);
 }
 void RecordingCanvas::onDrawPoints(SkCanvas::PointMode mode, size_t count, const SkPoint pts[],
                                    const SkPaint& paint) {
+    SkRect bounds;
+    bounds.setBounds(pts, count);
+    trackDrawBounds(bounds, &paint);
     fDL->drawPoints(mode, count, pts, paint);
 }
 void RecordingCanvas::onDrawVerticesObject(const SkVertices* vertices,
                                            const SkVertices::Bone bones[], int boneCount,
                                            SkBlendMode mode, const SkPaint& paint) {
+    trackDrawBounds(vertices->bounds(), &paint);
     fDL->drawVertices(vertices, bones, boneCount, mode, paint);
 }
 void RecordingCanvas::onDrawAtlas(const SkImage* atlas, const SkRSXform xforms[],
                                   const SkRect texs[], const SkColor colors[], int count,
                                   SkBlendMode bmode, const SkRect* cull, const SkPaint* paint) {
+    if (cull) {
+        trackDrawBounds(*cull, paint);
+    } else {
+        trackUnboundedDraw();
+    }
     fDL->drawAtlas(atlas, xforms, texs, colors, count, bmode, cull, paint);
 }
 void RecordingCanvas::onDrawShadowRec(const SkPath& path, const SkDrawShadowRec& rec) {
+    trackUnboundedDraw();  // the shadow extent depends on the light at draw time
     fDL->drawShadowRec(path, rec);
 }
 
 void RecordingCanvas::drawVectorDrawable(VectorDrawableRoot* tree) {
+    // The recorded op captures the staging bounds and draws within them.
+    trackDrawBounds(tree->stagingProperties().getBounds());
     fDL->drawVectorDrawable(tree);
 }
 
 void RecordingCanvas::drawWebView(skiapipeline::FunctorDrawable* drawable) {
+    trackDrawBounds(drawable->getBounds());
     fDL->drawWebView(drawable);
 }
 
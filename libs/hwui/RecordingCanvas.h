@@ -71,6 +71,21 @@ public:
     size_t usedSize() const { return fUsed; }
     size_t allocatedSize() const { return fReserved; }
 
+    /**
+     * Returns true if the union of the bounds of all recorded ops is known.
+     * Record-time bounds cannot be computed for every op (e.g. clip-filling
+     * draws or nested render nodes whose properties may change after this
+     * list was recorded); such ops leave the content bounds unknown.
+     */
+    bool hasContentBounds() const { return mContentBoundsKnown; }
+
+    /**
+     * The union of the bounds of the recorded ops in the space the list was
+     * recorded in, valid only when hasContentBounds() returns true. Empty if
+     * nothing was drawn.
+     */
+    const SkRect& contentBounds() const { return mContentBounds; }
+
 private:
     friend class RecordingCanvas;
 
@@ -138,6 +153,9 @@ private:
     size_t fUsed = 0;
     size_t fReserved = 0;
 
+    SkRect mContentBounds = SkRect::MakeEmpty();
+    bool mContentBoundsKnown = true;
+
     bool mHasText : 1;
 };
 
@@ -224,6 +242,20 @@ public:
 private:
     typedef SkCanvasVirtualEnforcer<SkNoDrawCanvas> INHERITED;
 
+    /**
+     * Folds the bounds of a draw into the content bounds retained on the
+     * DisplayListData, mapping by the current total matrix and outsetting for
+     * the paint. Marks the bounds unknown if they cannot be computed
+     * conservatively.
+     */
+    void trackDrawBounds(const SkRect& bounds, const SkPaint* paint = nullptr);
+
+    /**
+     * Marks the content bounds of the DisplayListData as unknown, for draws
+     * whose extent cannot be bounded at record time.
+     */
+    void trackUnboundedDraw();
+
     inline void setClipMayBeComplex() {
         if (!mClipMayBeComplex) {
             mComplexSaveCount = mSaveCount;
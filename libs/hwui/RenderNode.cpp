@@ -316,7 +316,10 @@ void RenderNode::syncDisplayList(TreeObserver& observer, TreeInfo* info) {
     if (mStagingDisplayList) {
         mStagingDisplayList->updateChildren([](RenderNode* child) { child->incParentRefCount(); });
     }
-    deleteDisplayList(observer, info);
+    // When a new list is replacing the old one the node is actively re-recording, so keep the
+    // old child drawables around for the next recording to claim. If the node stopped drawing,
+    // release them so they don't pin the child nodes.
+    deleteDisplayList(observer, info, mStagingDisplayList != nullptr);
     mDisplayList = mStagingDisplayList;
     mStagingDisplayList = nullptr;
     if (mDisplayList) {
@@ -376,11 +379,13 @@ void RenderNode::pushStagingDisplayListChanges(TreeObserver& observer, TreeInfo&
     }
 }
 
-void RenderNode::deleteDisplayList(TreeObserver& observer, TreeInfo* info) {
+void RenderNode::deleteDisplayList(TreeObserver& observer, TreeInfo* info,
+                                   bool keepChildrenForReuse) {
     if (mDisplayList) {
         mDisplayList->updateChildren(
                 [&observer, info](RenderNode* child) { child->decParentRefCount(observer, info); });
-        if (!mDisplayList->reuseDisplayList(this, info ? &info->canvasContext : nullptr)) {
+        if (!mDisplayList->reuseDisplayList(this, info ? &info->canvasContext : nullptr,
+                                            keepChildrenForReuse)) {
             delete mDisplayList;
         }
     }
@@ -232,7 +232,8 @@ private:
     void pushStagingDisplayListChanges(TreeObserver& observer, TreeInfo& info);
     void prepareLayer(TreeInfo& info, uint32_t dirtyMask);
     void pushLayerUpdate(TreeInfo& info);
-    void deleteDisplayList(TreeObserver& observer, TreeInfo* info = nullptr);
+    void deleteDisplayList(TreeObserver& observer, TreeInfo* info = nullptr,
+                           bool keepChildrenForReuse = false);
     void damageSelf(TreeInfo& info);
 
     void incParentRefCount() { mParentCount++; }
@@ -23,6 +23,9 @@
 #include "hwui/MinikinUtils.h"
 #include "hwui/PaintFilter.h"
 #include "pipeline/skia/AnimatedDrawables.h"
+#ifdef __ANDROID__ // Layoutlib does not compile the hwui thread pool
+#include "thread/CommonPool.h"
+#endif
 
 #include <SkAndroidFrameworkUtils.h>
 #include <SkAnimatedImage.h>
@@ -38,11 +41,15 @@
 #include <SkPicture.h>
 #include <SkRSXform.h>
 #include <SkShader.h>
+#include <SkSurface.h>
 #include <SkTemplates.h>
 #include <SkTextBlob.h>
 
+#include <cstring>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <unordered_set>
 #include <utility>
 
 namespace android {
@@ -728,6 +735,49 @@ void SkiaCanvas::drawVectorDrawable(VectorDrawableRoot* vectorDrawable) {
 // Canvas draw operations: Text
 // ----------------------------------------------------------------------------
 
+#ifdef __ANDROID__ // Layoutlib does not compile the hwui thread pool
+static uint64_t mixFloat(uint64_t key, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return key * 31 + bits;
+}
+
+// Rasterizing the glyphs of a fresh (typeface, size) strike is left to draw time inside Skia,
+// so the first RenderThread frame that shows a new text style pays several ms of scaler work.
+// When a recording canvas sees a strike for the first time, replay the run into a tiny
+// offscreen raster surface on a CommonPool worker: that fills the CPU strike cache the GPU
+// text renderer reads its masks from, leaving only the atlas upload for draw time. Strikes
+// drawn under a scaling transform may still re-rasterize, but the common unscaled case hits
+// the warmed masks directly.
+static void prewarmGlyphStrike(const SkFont& font, sk_sp<SkTextBlob> blob, const SkPaint& paint) {
+    static std::mutex sLock;
+    static std::unordered_set<uint64_t> sWarmedStrikes;
+    static constexpr size_t kMaxWarmedStrikes = 256;
+
+    uint64_t key = font.getTypefaceOrDefault()->uniqueID();
+    key = mixFloat(key, font.getSize());
+    key = mixFloat(key, font.getScaleX());
+    key = mixFloat(key, font.getSkewX());
+    key = key * 31 + static_cast<uint64_t>(font.getEdging());
+    key = key * 31 + (font.isEmbolden() ? 1 : 0);
+    {
+        std::lock_guard lock(sLock);
+        if (sWarmedStrikes.size() >= kMaxWarmedStrikes) {
+            sWarmedStrikes.clear();
+        }
+        if (!sWarmedStrikes.insert(key).second) {
+            return;
+        }
+    }
+    uirenderer::CommonPool::post([blob = std::move(blob), paint]() {
+        sk_sp<SkSurface> surface = SkSurface::MakeRasterN32Premul(1, 1);
+        if (surface) {
+            surface->getCanvas()->drawTextBlob(blob, 0, 0, paint);
+        }
+    });
+}
+#endif
+
 void SkiaCanvas::drawGlyphs(ReadGlyphFunc glyphFunc, int count, const Paint& paint, float x,
                             float y, float boundsLeft, float boundsTop, float boundsRight,
                             float boundsBottom, float totalAdvance) {
@@ -750,6 +800,12 @@ void SkiaCanvas::drawGlyphs(ReadGlyphFunc glyphFunc, int count, const Paint& pai
 
     sk_sp<SkTextBlob> textBlob(builder.make());
 
+#ifdef __ANDROID__
+    if (prewarmsGlyphs()) {
+        prewarmGlyphStrike(font, textBlob, paintCopy);
+    }
+#endif
+
     apply_looper(&paintCopy, [&](const SkPaint& p) {
         mCanvas->drawTextBlob(textBlob, 0, 0, p);
     });
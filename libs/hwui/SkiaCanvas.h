@@ -169,6 +169,10 @@ protected:
                                   const Paint& paint, const SkPath& path, size_t start,
                                   size_t end) override;
 
+    // Overridden by SkiaRecordingCanvas: warming the glyph strike cache only pays off when the
+    // actual rasterization happens later, on the RenderThread.
+    virtual bool prewarmsGlyphs() const { return false; }
+
     /** This class acts as a copy on write SkPaint.
      *
      *  Initially this will be the SkPaint passed to the contructor.
@@ -19,6 +19,7 @@
 #include <math.h>
 #include <string.h>
 #include <utils/Log.h>
+#include <utils/StrongPointer.h>
 
 #include "PathParser.h"
 #include "SkColorFilter.h"
@@ -28,6 +29,7 @@
 
 #ifdef __ANDROID__
 #include "renderthread/RenderThread.h"
+#include "thread/CommonPool.h"
 #endif
 
 #include "utils/Macros.h"
@@ -486,6 +488,12 @@ void Tree::getPaintFor(SkPaint* outPaint, const TreeProperties& prop) const {
 }
 
 Bitmap& Tree::getBitmapUpdateIfDirty() {
+    if (mPrefetchFuture.valid()) {
+        // A prefetch is in flight (or already finished); it owns the cache
+        // until it completes.
+        mPrefetchFuture.get();
+        mPrefetchFuture = std::future<void>();
+    }
     bool redrawNeeded = allocateBitmapIfNeeded(mCache, mProperties.getScaledWidth(),
                                                mProperties.getScaledHeight());
     if (redrawNeeded || mCache.dirty) {
@@ -495,6 +503,29 @@ Bitmap& Tree::getBitmapUpdateIfDirty() {
     return *mCache.bitmap;
 }
 
+void Tree::prefetchBitmapUpdate() {
+#ifdef __ANDROID__
+    if (mPrefetchFuture.valid()) {
+        // The same tree can appear in more than one display list; only the
+        // first prepare pass needs to schedule work.
+        return;
+    }
+    // Animators have already run for this frame by the time prepareTree reaches
+    // the display list, so mProperties is final, and RT does not touch mCache
+    // again until getBitmapUpdateIfDirty() collects the future. The worker
+    // therefore has exclusive access to the cache bitmap.
+    mPrefetchFuture = CommonPool::async([tree = sp<Tree>(this)]() {
+        bool redrawNeeded =
+                tree->allocateBitmapIfNeeded(tree->mCache, tree->mProperties.getScaledWidth(),
+                                             tree->mProperties.getScaledHeight());
+        if (redrawNeeded || tree->mCache.dirty) {
+            tree->updateBitmapCache(*tree->mCache.bitmap, false);
+            tree->mCache.dirty = false;
+        }
+    });
+#endif
+}
+
 void Tree::draw(SkCanvas* canvas, const SkRect& bounds, const SkPaint& inPaint) {
     if (canvas->quickReject(bounds)) {
         // The RenderNode is on screen, but the AVD is not.
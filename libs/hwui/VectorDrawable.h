@@ -36,6 +36,7 @@
 
 #include <cutils/compiler.h>
 #include <stddef.h>
+#include <future>
 #include <string>
 #include <vector>
 
@@ -516,6 +517,13 @@ public:
     void drawStaging(Canvas* canvas);
 
     Bitmap& getBitmapUpdateIfDirty();
+
+    /**
+     * Kicks rasterization of the bitmap cache to a CommonPool worker so it runs ahead of the
+     * draw pass. Called from prepareTree on RT, after this frame's properties are final;
+     * draw() blocks on the result, or rasterizes inline if no prefetch was scheduled.
+     */
+    void prefetchBitmapUpdate();
     void setAllowCaching(bool allowCaching) { mAllowCaching = allowCaching; }
     void syncProperties() {
         if (mStagingProperties.mNonAnimatablePropertiesDirty) {
@@ -678,6 +686,9 @@ private:
     Cache mStagingCache;
     Cache mCache;
 
+    // Pending cache rasterization scheduled by prefetchBitmapUpdate().
+    std::future<void> mPrefetchFuture;
+
     PropertyChangedListener mPropertyChangedListener =
             PropertyChangedListener(&mCache.dirty, &mStagingCache.dirty);
 
@@ -56,6 +56,10 @@ void WebViewFunctor_release(int functor) {
     WebViewFunctorManager::instance().releaseFunctor(functor);
 }
 
+void WebViewFunctor_reportContentChanged(int functor) {
+    WebViewFunctorManager::instance().reportContentChanged(functor);
+}
+
 static std::atomic_int sNextId{1};
 
 WebViewFunctor::WebViewFunctor(void* data, const WebViewFunctorCallbacks& callbacks,
@@ -74,10 +78,26 @@ WebViewFunctor::~WebViewFunctor() {
 }
 
 void WebViewFunctor::sync(const WebViewSyncData& syncData) const {
+    if (mChangeTrackingEnabled.load(std::memory_order_relaxed) &&
+        syncData.applyForceDark == mLastSyncedForceDark &&
+        !mContentChanged.exchange(false, std::memory_order_acq_rel)) {
+        // Nothing new was reported since the last delivered sync and the payload is identical,
+        // so the state pushed last time is still current; skip the callback and keep the GPU
+        // work it produced.
+        mSkippedSyncs.fetch_add(1, std::memory_order_relaxed);
+        ATRACE_NAME("WebViewFunctor::sync skipped (content unchanged)");
+        return;
+    }
     ATRACE_NAME("WebViewFunctor::sync");
+    mLastSyncedForceDark = syncData.applyForceDark;
     mCallbacks.onSync(mFunctor, mData, syncData);
 }
 
+void WebViewFunctor::reportContentChanged() {
+    mChangeTrackingEnabled.store(true, std::memory_order_relaxed);
+    mContentChanged.store(true, std::memory_order_release);
+}
+
 void WebViewFunctor::drawGl(const DrawGlInfo& drawInfo) {
     ATRACE_NAME("WebViewFunctor::drawGl");
     if (!mHasContext) {
@@ -182,6 +202,16 @@ void WebViewFunctorManager::destroyFunctor(int functor) {
     }
 }
 
+void WebViewFunctorManager::reportContentChanged(int functor) {
+    std::lock_guard _lock{mLock};
+    for (auto& iter : mFunctors) {
+        if (iter->id() == functor) {
+            iter->reportContentChanged();
+            return;
+        }
+    }
+}
+
 sp<WebViewFunctor::Handle> WebViewFunctorManager::handleFor(int functor) {
     std::lock_guard _lock{mLock};
     for (auto& iter : mActiveFunctors) {
@@ -24,6 +24,7 @@
 #endif
 
 #include <utils/LightRefBase.h>
+#include <atomic>
 #include <mutex>
 #include <vector>
 
@@ -56,6 +57,8 @@ public:
 
         void postDrawVk() { mReference.postDrawVk(); }
 
+        uint64_t skippedSyncCount() const { return mReference.skippedSyncCount(); }
+
     private:
         friend class WebViewFunctor;
 
@@ -71,6 +74,8 @@ public:
     void drawVk(const VkFunctorDrawParams& params);
     void postDrawVk();
     void destroyContext();
+    void reportContentChanged();
+    uint64_t skippedSyncCount() const { return mSkippedSyncs.load(std::memory_order_relaxed); }
 
     sp<Handle> createHandle() {
         LOG_ALWAYS_FATAL_IF(mCreatedHandle);
@@ -85,6 +90,15 @@ private:
     RenderMode mMode;
     bool mHasContext = false;
     bool mCreatedHandle = false;
+
+    // Change-detection handshake state, see WebViewFunctor_reportContentChanged. Until the
+    // embedder opts in by reporting a change, every sync is delivered as before.
+    std::atomic_bool mChangeTrackingEnabled{false};
+    mutable std::atomic_bool mContentChanged{true};
+    mutable std::atomic<uint64_t> mSkippedSyncs{0};
+    // The payload of the last delivered sync; a payload change is always delivered even when no
+    // new content was reported. Only touched on RenderThread.
+    mutable bool mLastSyncedForceDark = false;
 };
 
 class WebViewFunctorManager {
@@ -95,6 +109,7 @@ public:
     void releaseFunctor(int functor);
     void onContextDestroyed();
     void destroyFunctor(int functor);
+    void reportContentChanged(int functor);
 
     sp<WebViewFunctor::Handle> handleFor(int functor);
 
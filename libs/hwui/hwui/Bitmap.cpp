@@ -40,9 +40,82 @@
 #include <SkWebpEncoder.h>
 #include <SkHighContrastFilter.h>
 #include <limits>
+#include <mutex>
+#include <string.h>
+#include <unordered_map>
 
 namespace android {
 
+namespace {
+
+/*
+ * Identical small bitmaps (emoji, badges, list icons) are commonly decoded once per window
+ * with no sharing, so every copy costs its own texture upload and GPU allocation. Interning
+ * the SkImage by pixel content collapses them into one: Ganesh caches textures by image
+ * uniqueID, so every draw of equal content hits the same texture. Only immutable bitmaps are
+ * interned, and the shared image keeps its backing Bitmap alive through the pixel ref.
+ */
+constexpr int kImageCacheMaxDimension = 64;
+constexpr size_t kImageCacheMaxEntries = 64;
+
+std::mutex gImageCacheMutex;
+std::unordered_multimap<uint32_t, sk_sp<SkImage>>& imageCacheLocked() {
+    static auto* cache = new std::unordered_multimap<uint32_t, sk_sp<SkImage>>;
+    return *cache;
+}
+
+uint32_t hashPixels(const SkPixmap& pixmap) {
+    // FNV-1a over the meaningful bytes of each row.
+    uint32_t hash = 2166136261u;
+    const size_t bytesPerRow = pixmap.info().minRowBytes();
+    for (int y = 0; y < pixmap.height(); y++) {
+        const uint8_t* row = static_cast<const uint8_t*>(pixmap.addr(0, y));
+        for (size_t i = 0; i < bytesPerRow; i++) {
+            hash = (hash ^ row[i]) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+bool pixelsEqual(const SkPixmap& a, const SkPixmap& b) {
+    if (a.dimensions() != b.dimensions() || a.colorType() != b.colorType() ||
+        a.alphaType() != b.alphaType() ||
+        !SkColorSpace::Equals(a.colorSpace(), b.colorSpace())) {
+        return false;
+    }
+    const size_t bytesPerRow = a.info().minRowBytes();
+    for (int y = 0; y < a.height(); y++) {
+        if (memcmp(a.addr(0, y), b.addr(0, y), bytesPerRow) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+sk_sp<SkImage> findOrCreateSharedImage(const SkBitmap& skiaBitmap) {
+    SkPixmap pixmap;
+    if (!skiaBitmap.peekPixels(&pixmap)) {
+        return SkMakeImageFromRasterBitmap(skiaBitmap, kNever_SkCopyPixelsMode);
+    }
+    const uint32_t hash = hashPixels(pixmap);
+    std::lock_guard<std::mutex> lock(gImageCacheMutex);
+    auto& cache = imageCacheLocked();
+    auto range = cache.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        SkPixmap cachedPixmap;
+        if (it->second->peekPixels(&cachedPixmap) && pixelsEqual(pixmap, cachedPixmap)) {
+            return it->second;
+        }
+    }
+    sk_sp<SkImage> image = SkMakeImageFromRasterBitmap(skiaBitmap, kNever_SkCopyPixelsMode);
+    if (cache.size() < kImageCacheMaxEntries) {
+        cache.emplace(hash, image);
+    }
+    return image;
+}
+
+}  // namespace
+
 bool Bitmap::computeAllocationSize(size_t rowBytes, int height, size_t* size) {
     return 0 <= height && height <= std::numeric_limits<size_t>::max() &&
            !__builtin_mul_overflow(rowBytes, (size_t)height, size) &&
@@ -381,6 +454,10 @@ sk_sp<SkImage> Bitmap::makeImage() {
         SkBitmap skiaBitmap;
         skiaBitmap.setInfo(info(), rowBytes());
         skiaBitmap.setPixelRef(sk_ref_sp(this), 0, 0);
+        if (isImmutable() && info().width() <= kImageCacheMaxDimension &&
+            info().height() <= kImageCacheMaxDimension) {
+            return findOrCreateSharedImage(skiaBitmap);
+        }
         // Note we don't cache in this case, because the raster image holds a pointer to this Bitmap
         // internally and ~Bitmap won't be invoked.
         // TODO: refactor Bitmap to not derive from SkPixelRef, which would allow caching here.
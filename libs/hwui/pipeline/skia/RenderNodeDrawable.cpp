@@ -216,7 +216,22 @@ void RenderNodeDrawable::drawContent(SkCanvas* canvas) const {
 
     // TODO should we let the bound of the drawable do this for us?
     const SkRect bounds = SkRect::MakeWH(properties.getWidth(), properties.getHeight());
-    bool quickRejected = properties.getClipToBounds() && canvas->quickReject(bounds);
+    bool quickRejected;
+    if (renderNode->getLayerSurface() && mComposeLayer) {
+        // The layer snapshot is drawn over the full node bounds below.
+        quickRejected = properties.getClipToBounds() && canvas->quickReject(bounds);
+    } else if (displayList->mDisplayList.hasContentBounds()) {
+        // The retained record-time bounds reject nodes that do not clip to their
+        // bounds, and nodes whose recorded content covers less than their full
+        // width and height, before Skia replays their op stream.
+        SkRect contentBounds = displayList->mDisplayList.contentBounds();
+        if (properties.getClipToBounds() && !contentBounds.intersect(bounds)) {
+            contentBounds.setEmpty();
+        }
+        quickRejected = contentBounds.isEmpty() || canvas->quickReject(contentBounds);
+    } else {
+        quickRejected = properties.getClipToBounds() && canvas->quickReject(bounds);
+    }
     if (!quickRejected) {
         SkiaDisplayList* displayList = (SkiaDisplayList*)renderNode->getDisplayList();
         const LayerProperties& layerProperties = properties.layerProperties();
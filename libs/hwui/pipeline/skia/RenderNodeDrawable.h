@@ -76,6 +76,15 @@ public:
      */
     const SkMatrix& getRecordedMatrix() const { return mRecordedTransform; }
 
+    /**
+     * Returns whether drawing composes the existing layer contents rather than drawing into them.
+     * Used with isInReorderingSection by SkiaDisplayList::reuseChildNode to decide whether a
+     * recycled drawable can stand in for a newly recorded one.
+     */
+    bool getComposeLayer() const { return mComposeLayer; }
+
+    bool isInReorderingSection() const { return mInReorderingSection; }
+
     /**
      * Sets a pointer to a display list of the parent render node. The display list is used when
      * drawing backward projected nodes, when this node is a projection receiver.
@@ -18,6 +18,7 @@
 #include <GrContext.h>
 #include <log/log.h>
 #include <openssl/sha.h>
+#include <string.h>
 #include <algorithm>
 #include <array>
 #include <thread>
@@ -34,6 +35,10 @@ static const size_t maxKeySize = 1024;
 static const size_t maxValueSize = 512 * 1024;
 static const size_t maxTotalSize = 1024 * 1024;
 
+// Limit on the number of shader keys remembered for warm-up. Shader descriptor
+// keys are small, so this keeps the serialized index well under maxValueSize.
+static const size_t maxWarmUpKeys = 64;
+
 ShaderCache::ShaderCache() {
     // There is an "incomplete FileBlobCache type" compilation error, if ctor is moved to header.
 }
@@ -85,6 +90,7 @@ void ShaderCache::initShaderDiskCache(const void* identity, ssize_t size) {
     if (!Properties::runningInEmulator && mFilename.length() > 0) {
         mBlobCache.reset(new FileBlobCache(maxKeySize, maxValueSize, maxTotalSize, mFilename));
         validateCache(identity, size);
+        loadWarmUpKeyIndexLocked();
         mInitialized = true;
     }
 }
@@ -139,6 +145,69 @@ sk_sp<SkData> ShaderCache::load(const SkData& key) {
     return SkData::MakeFromMalloc(valueBuffer, valueSize);
 }
 
+void ShaderCache::recordWarmUpKeyLocked(const void* key, size_t keySize) {
+    if (mWarmUpKeys.size() >= maxWarmUpKeys) {
+        return;
+    }
+    auto* data = static_cast<const uint8_t*>(key);
+    for (const auto& knownKey : mWarmUpKeys) {
+        if (knownKey.size() == keySize && !memcmp(knownKey.data(), data, keySize)) {
+            return;
+        }
+    }
+    mWarmUpKeys.emplace_back(data, data + keySize);
+}
+
+void ShaderCache::loadWarmUpKeyIndexLocked() {
+    mWarmUpKeys.clear();
+    auto key = sKeyIndexKey;
+    size_t indexSize = mBlobCache->get(&key, sizeof(key), nullptr, 0);
+    if (!indexSize || indexSize > maxValueSize) {
+        return;
+    }
+    std::vector<uint8_t> index(indexSize);
+    if (mBlobCache->get(&key, sizeof(key), index.data(), index.size()) != indexSize) {
+        return;
+    }
+    // The index is a sequence of size-prefixed keys; stop at the first entry
+    // that does not parse, as the remainder cannot be trusted either.
+    size_t offset = 0;
+    while (mWarmUpKeys.size() < maxWarmUpKeys && offset + sizeof(uint32_t) <= indexSize) {
+        uint32_t keySize;
+        memcpy(&keySize, index.data() + offset, sizeof(keySize));
+        offset += sizeof(keySize);
+        if (!keySize || keySize > maxKeySize || offset + keySize > indexSize) {
+            break;
+        }
+        mWarmUpKeys.emplace_back(index.data() + offset, index.data() + offset + keySize);
+        offset += keySize;
+    }
+}
+
+void ShaderCache::saveWarmUpKeyIndexLocked() {
+    if (mWarmUpKeys.empty()) {
+        return;
+    }
+    size_t indexSize = 0;
+    for (const auto& warmUpKey : mWarmUpKeys) {
+        indexSize += sizeof(uint32_t) + warmUpKey.size();
+    }
+    if (indexSize > maxValueSize) {
+        return;
+    }
+    std::vector<uint8_t> index(indexSize);
+    size_t offset = 0;
+    for (const auto& warmUpKey : mWarmUpKeys) {
+        const uint32_t keySize = warmUpKey.size();
+        memcpy(index.data() + offset, &keySize, sizeof(keySize));
+        offset += sizeof(keySize);
+        memcpy(index.data() + offset, warmUpKey.data(), keySize);
+        offset += keySize;
+    }
+    auto key = sKeyIndexKey;
+    mBlobCache->set(&key, sizeof(key), index.data(), index.size());
+}
+
 void ShaderCache::saveToDiskLocked() {
     ATRACE_NAME("ShaderCache::saveToDiskLocked");
     if (mInitialized && mBlobCache && mSavePending) {
@@ -146,6 +215,7 @@ void ShaderCache::saveToDiskLocked() {
             auto key = sIDKey;
             mBlobCache->set(&key, sizeof(key), mIDHash.data(), mIDHash.size());
         }
+        saveWarmUpKeyIndexLocked();
         mBlobCache->writeToFile();
     }
     mSavePending = false;
@@ -186,6 +256,9 @@ void ShaderCache::store(const SkData& key, const SkData& data) {
         // Store pipeline cache on the next flush.
         mNewPipelineCacheSize = -1;
         mTryToStorePipelineCache = true;
+        if (keySize <= maxKeySize) {
+            recordWarmUpKeyLocked(key.data(), keySize);
+        }
     }
     bc->set(key.data(), keySize, value, valueSize);
 
@@ -206,6 +279,44 @@ void ShaderCache::store(const SkData& key, const SkData& data) {
     }
 }
 
+void ShaderCache::precompileShaders(GrContext* context) {
+    ATRACE_NAME("ShaderCache::precompileShaders");
+    // Copy the entries out under the lock; the driver compiles below may call
+    // back into load/store through the persistent cache hooks.
+    std::vector<std::pair<sk_sp<SkData>, sk_sp<SkData>>> entries;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mInitialized || mWarmUpKeys.empty()) {
+            return;
+        }
+        BlobCache* bc = getBlobCacheLocked();
+        entries.reserve(mWarmUpKeys.size());
+        for (const auto& warmUpKey : mWarmUpKeys) {
+            size_t valueSize = bc->get(warmUpKey.data(), warmUpKey.size(), nullptr, 0);
+            if (!valueSize || valueSize > maxValueSize) {
+                continue;
+            }
+            void* valueBuffer = malloc(valueSize);
+            if (!valueBuffer) {
+                return;
+            }
+            if (bc->get(warmUpKey.data(), warmUpKey.size(), valueBuffer, valueSize) != valueSize) {
+                free(valueBuffer);
+                continue;
+            }
+            entries.emplace_back(SkData::MakeWithCopy(warmUpKey.data(), warmUpKey.size()),
+                                 SkData::MakeFromMalloc(valueBuffer, valueSize));
+        }
+    }
+    for (const auto& entry : entries) {
+        if (!context->precompileShader(*entry.first, *entry.second)) {
+            if (CC_UNLIKELY(Properties::debugLevel & kDebugCaches)) {
+                ALOGW("ShaderCache::precompileShaders rejected a persisted entry");
+            }
+        }
+    }
+}
+
 void ShaderCache::onVkFrameFlushed(GrContext* context) {
     {
         std::lock_guard<std::mutex> lock(mMutex);
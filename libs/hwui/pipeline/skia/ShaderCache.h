@@ -75,6 +75,15 @@ public:
      */
     void store(const SkData& key, const SkData& data) override;
 
+    /**
+     * "precompileShaders" replays the shader programs persisted by previous runs
+     * of the process through the GrContext, so that the driver compiles them
+     * before the frames that need them. It must be called on the thread that
+     * owns the GrContext, and is intended to run once per context, after the
+     * frame pipeline is up and otherwise idle.
+     */
+    void precompileShaders(GrContext* context);
+
     /**
      * "onVkFrameFlushed" tries to store Vulkan pipeline cache state.
      * Pipeline cache is saved on disk only if the size of the data has changed or there was
@@ -111,6 +120,24 @@ private:
      */
     void saveToDiskLocked();
 
+    /**
+     * "recordWarmUpKeyLocked" remembers the key of a newly compiled shader, so
+     * that the next process knows which cache entries to precompile.
+     */
+    void recordWarmUpKeyLocked(const void* key, size_t keySize);
+
+    /**
+     * "loadWarmUpKeyIndexLocked" rebuilds mWarmUpKeys from the index blob
+     * persisted under sKeyIndexKey, if any.
+     */
+    void loadWarmUpKeyIndexLocked();
+
+    /**
+     * "saveWarmUpKeyIndexLocked" serializes mWarmUpKeys into the index blob
+     * stored under sKeyIndexKey.
+     */
+    void saveWarmUpKeyIndexLocked();
+
     /**
      * "mInitialized" indicates whether the ShaderCache is in the initialized
      * state.  It is initialized to false at construction time, and gets set to
@@ -200,6 +227,13 @@ private:
      */
     bool mCacheDirty = false;
 
+    /**
+     * "mWarmUpKeys" holds the keys of the shader programs compiled so far, in
+     * compilation order. It is rebuilt from disk by initShaderDiskCache and is
+     * the set of entries precompileShaders replays.
+     */
+    std::vector<std::vector<uint8_t>> mWarmUpKeys;
+
     /**
      * "sCache" is the singleton ShaderCache object.
      */
@@ -210,6 +244,11 @@ private:
      */
     static constexpr uint8_t sIDKey = 0;
 
+    /**
+     * "sKeyIndexKey" is the cache key of the shader key index used for warm-up.
+     */
+    static constexpr uint8_t sKeyIndexKey = 1;
+
     friend class ShaderCacheTestUtils;  // used for unit testing
 };
 
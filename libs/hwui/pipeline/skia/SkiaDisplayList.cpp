@@ -47,13 +47,45 @@ void SkiaDisplayList::syncContents(const WebViewSyncData& data) {
     }
 }
 
-bool SkiaDisplayList::reuseDisplayList(RenderNode* node, renderthread::CanvasContext* context) {
-    reset();
+bool SkiaDisplayList::reuseDisplayList(RenderNode* node, renderthread::CanvasContext* context,
+                                       bool keepChildrenForReuse) {
+    reset(keepChildrenForReuse);
     node->attachAvailableList(this);
     return true;
 }
 
-void SkiaDisplayList::updateChildren(std::function<void(RenderNode*)> updateFn) {
+RenderNodeDrawable* SkiaDisplayList::reuseChildNode(RenderNode* node, SkCanvas* canvas,
+                                                    bool composeLayer, bool inReorderingSection) {
+    if (mClaimedChildCount < mRecycledChildCount) {
+        RenderNodeDrawable& candidate = mChildNodes[mClaimedChildCount];
+        if (candidate.getRenderNode() == node &&
+            candidate.getRecordedMatrix() == canvas->getTotalMatrix() &&
+            candidate.getComposeLayer() == composeLayer &&
+            candidate.isInReorderingSection() == inReorderingSection) {
+            mClaimedChildCount++;
+            candidate.notifyDrawingChanged();
+            // The prepare pass only updates this on the current receiver, so clear any stale
+            // pointer left from the previous recording.
+            candidate.setProjectedDisplayList(nullptr);
+            return &candidate;
+        }
+        // The child order diverged from the previous recording; recycled drawables can only be
+        // claimed in order, so drop the leftovers.
+        trimRecycledChildren();
+    }
+    return nullptr;
+}
+
+void SkiaDisplayList::trimRecycledChildren() {
+    // Unclaimed recycled drawables are always the tail of the deque: new drawables are only
+    // appended once reuseChildNode has run out of (or given up on) recycled ones.
+    while (mRecycledChildCount > mClaimedChildCount) {
+        mChildNodes.pop_back();
+        mRecycledChildCount--;
+    }
+}
+
+void SkiaDisplayList::updateChildren(const std::function<void(RenderNode*)>& updateFn) {
     for (auto& child : mChildNodes) {
         updateFn(child.getRenderNode());
     }
@@ -84,7 +116,7 @@ static bool intersects(const SkISize screenSize, const Matrix4& mat, const SkRec
 
 bool SkiaDisplayList::prepareListAndChildren(
         TreeObserver& observer, TreeInfo& info, bool functorsNeedLayer,
-        std::function<void(RenderNode*, TreeObserver&, TreeInfo&, bool)> childFn) {
+        const std::function<void(RenderNode*, TreeObserver&, TreeInfo&, bool)>& childFn) {
     // If the prepare tree is triggered by the UI thread and no previous call to
     // pinImages has failed then we must pin all mutable images in the GPU cache
     // until the next UI thread draw.
@@ -140,24 +172,35 @@ bool SkiaDisplayList::prepareListAndChildren(
         }
     }
 
+    // The current transform is the same for every vector drawable in this list; resolving
+    // it walks the damage accumulator stack, so do it at most once.
+    bool haveCurrentTransform = false;
+    Matrix4 currentTransform;
     for (auto& [vectorDrawable, cachedMatrix] : mVectorDrawables) {
         // If any vector drawable in the display list needs update, damage the node.
         if (vectorDrawable->isDirty()) {
-            Matrix4 totalMatrix;
-            info.damageAccumulator->computeCurrentTransform(&totalMatrix);
+            if (!haveCurrentTransform) {
+                info.damageAccumulator->computeCurrentTransform(&currentTransform);
+                haveCurrentTransform = true;
+            }
+            Matrix4 totalMatrix(currentTransform);
             Matrix4 canvasMatrix(cachedMatrix);
             totalMatrix.multiply(canvasMatrix);
             const SkRect& bounds = vectorDrawable->properties().getBounds();
             if (intersects(info.screenSize, totalMatrix, bounds)) {
                 isDirty = true;
                 vectorDrawable->setPropertyChangeWillBeConsumed(true);
+                // Rasterize the cache on a worker ahead of the draw pass; the
+                // draw composites the finished bitmap, or rasterizes inline if
+                // the prefetch has not run by then.
+                vectorDrawable->prefetchBitmapUpdate();
             }
         }
     }
     return isDirty;
 }
 
-void SkiaDisplayList::reset() {
+void SkiaDisplayList::reset(bool keepChildrenForReuse) {
     mProjectionReceiver = nullptr;
 
     mDisplayList.reset();
@@ -166,10 +209,15 @@ void SkiaDisplayList::reset() {
     mVectorDrawables.clear();
     mAnimatedImages.clear();
     mChildFunctors.clear();
-    mChildNodes.clear();
+    if (keepChildrenForReuse) {
+        mRecycledChildCount = mChildNodes.size();
+    } else {
+        mChildNodes.clear();
+        mRecycledChildCount = 0;
+    }
+    mClaimedChildCount = 0;
 
-    allocator.~LinearAllocator();
-    new (&allocator) LinearAllocator();
+    allocator.rewind();
 }
 
 void SkiaDisplayList::output(std::ostream& output, uint32_t level) {
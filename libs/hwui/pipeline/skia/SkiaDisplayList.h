@@ -62,8 +62,29 @@ public:
      * This resets the DisplayList so that it behaves as if the object were newly
      * constructed.  The reuse avoids any overhead associated with destroying
      * the SkLiteDL as well as the deques and vectors.
+     *
+     * If keepChildrenForReuse is true the child RenderNodeDrawables are kept alive so the next
+     * recording of the same node can claim them in order via reuseChildNode() instead of
+     * destroying and re-creating one per child. Only pass it when a new recording is imminent
+     * (the display list was replaced during sync); otherwise the kept drawables would pin their
+     * child RenderNodes for no benefit.
+     */
+    void reset(bool keepChildrenForReuse = false);
+
+    /**
+     * Attempts to claim a child drawable kept alive by reset(true) for the given node. Recycled
+     * drawables can only be claimed in recording order; on the first mismatch the remaining
+     * leftovers are destroyed and nullptr is returned, telling the caller to record a fresh
+     * drawable.
      */
-    void reset();
+    RenderNodeDrawable* reuseChildNode(RenderNode* node, SkCanvas* canvas, bool composeLayer,
+                                       bool inReorderingSection);
+
+    /**
+     * Destroys any drawables kept alive by reset(true) that the current recording did not claim.
+     * Called when the recording finishes.
+     */
+    void trimRecycledChildren();
 
     /**
      * Use the linear allocator to create any SkDrawables needed by the display
@@ -98,7 +119,8 @@ public:
      *
      * @return true if the displayList will be reused and therefore should not be deleted
      */
-    bool reuseDisplayList(RenderNode* node, renderthread::CanvasContext* context);
+    bool reuseDisplayList(RenderNode* node, renderthread::CanvasContext* context,
+                          bool keepChildrenForReuse = false);
 
     /**
      * ONLY to be called by RenderNode::syncDisplayList so that we can notify any
@@ -124,12 +146,12 @@ public:
 
     bool prepareListAndChildren(
             TreeObserver& observer, TreeInfo& info, bool functorsNeedLayer,
-            std::function<void(RenderNode*, TreeObserver&, TreeInfo&, bool)> childFn);
+            const std::function<void(RenderNode*, TreeObserver&, TreeInfo&, bool)>& childFn);
 
     /**
      *  Calls the provided function once for each child of this DisplayList
      */
-    void updateChildren(std::function<void(RenderNode*)> updateFn);
+    void updateChildren(const std::function<void(RenderNode*)>& updateFn);
 
     /**
      *  Returns true if there is a child render node that is a projection receiver.
@@ -156,6 +178,12 @@ public:
     std::vector<SkImage*> mMutableImages;
 private:
     std::vector<Pair<VectorDrawableRoot*, SkMatrix>> mVectorDrawables;
+
+    // The leading [mClaimedChildCount, mRecycledChildCount) entries of mChildNodes are drawables
+    // kept from the previous recording by reset(true) that have not yet been claimed by the
+    // current one; see reuseChildNode().
+    size_t mRecycledChildCount = 0;
+    size_t mClaimedChildCount = 0;
 public:
     void appendVD(VectorDrawableRoot* r) {
         appendVD(r, SkMatrix::I());
@@ -103,15 +103,8 @@ void SkiaPipeline::renderLayersImpl(const LayerUpdateQueue& layers, bool opaque)
             return;
         }
 
-        const Rect& layerDamage = layers.entries()[i].damage;
-
         SkCanvas* layerCanvas = layerNode->getLayerSurface()->getCanvas();
 
-        int saveCount = layerCanvas->save();
-        SkASSERT(saveCount == 1);
-
-        layerCanvas->androidFramework_setDeviceClipRestriction(layerDamage.toSkIRect());
-
         // TODO: put localized light center calculation and storage to a drawable related code.
         // It does not seem right to store something localized in a global state
         // fix here and in recordLayers
@@ -123,19 +116,31 @@ void SkiaPipeline::renderLayersImpl(const LayerUpdateQueue& layers, bool opaque)
 
         const RenderProperties& properties = layerNode->properties();
         const SkRect bounds = SkRect::MakeWH(properties.getWidth(), properties.getHeight());
-        if (properties.getClipToBounds() && layerCanvas->quickReject(bounds)) {
-            return;
-        }
 
         ATRACE_FORMAT("drawLayer [%s] %.1f x %.1f", layerNode->getName(), bounds.width(),
                       bounds.height());
 
         layerNode->getSkiaLayer()->hasRenderedSinceRepaint = false;
-        layerCanvas->clear(SK_ColorTRANSPARENT);
 
-        RenderNodeDrawable root(layerNode, layerCanvas, false);
-        root.forceDraw(layerCanvas);
-        layerCanvas->restoreToCount(saveCount);
+        // Re-raster each damage region separately, so disjoint updates in a large layer
+        // don't pay for the pixels in between.
+        for (const Rect& layerDamage : layers.entries()[i].damageRects) {
+            int saveCount = layerCanvas->save();
+            SkASSERT(saveCount == 1);
+
+            layerCanvas->androidFramework_setDeviceClipRestriction(layerDamage.toSkIRect());
+
+            if (properties.getClipToBounds() && layerCanvas->quickReject(bounds)) {
+                layerCanvas->restoreToCount(saveCount);
+                continue;
+            }
+
+            layerCanvas->clear(SK_ColorTRANSPARENT);
+
+            RenderNodeDrawable root(layerNode, layerCanvas, false);
+            root.forceDraw(layerCanvas);
+            layerCanvas->restoreToCount(saveCount);
+        }
 
         LightingInfo::setLightCenterRaw(savedLightCenter);
 
@@ -212,7 +217,7 @@ void SkiaPipeline::prepareToDraw(const RenderThread& thread, Bitmap* bitmap) {
 }
 
 static void savePictureAsync(const sk_sp<SkData>& data, const std::string& filename) {
-    CommonPool::post([data, filename] {
+    CommonPool::postBackground([data, filename] {
         if (0 == access(filename.c_str(), F_OK)) {
             return;
         }
@@ -397,7 +402,7 @@ void SkiaPipeline::endCapture(SkSurface* surface) {
             // to a bare pointer because keeping it in a smart pointer makes the lambda
             // non-copyable. The lambda is only called once, so this is safe.
             SkFILEWStream* stream = mOpenMultiPicStream.release();
-            CommonPool::post([doc = std::move(mMultiPic), stream]{
+            CommonPool::postBackground([doc = std::move(mMultiPic), stream]{
                 ALOGD("Finalizing multi frame SKP");
                 doc->close();
                 delete stream;
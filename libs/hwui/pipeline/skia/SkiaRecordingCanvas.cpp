@@ -59,6 +59,8 @@ uirenderer::DisplayList* SkiaRecordingCanvas::finishRecording() {
     // close any existing chunks if necessary
     insertReorderBarrier(false);
     mRecorder.restoreToCount(1);
+    // drop any recycled child drawables this recording did not claim
+    mDisplayList->trimRecycledChildren();
     return mDisplayList.release();
 }
 
@@ -117,18 +119,23 @@ void SkiaRecordingCanvas::drawLayer(uirenderer::DeferredLayerUpdater* layerUpdat
 
 
 void SkiaRecordingCanvas::drawRenderNode(uirenderer::RenderNode* renderNode) {
-    // Record the child node. Drawable dtor will be invoked when mChildNodes deque is cleared.
-    mDisplayList->mChildNodes.emplace_back(renderNode, asSkCanvas(), true, mCurrentBarrier);
-    auto& renderNodeDrawable = mDisplayList->mChildNodes.back();
+    // Claim a drawable recycled from the previous recording if the child order is unchanged,
+    // otherwise record a new one. Drawable dtor will be invoked when mChildNodes deque is cleared.
+    RenderNodeDrawable* renderNodeDrawable = mDisplayList->reuseChildNode(
+            renderNode, asSkCanvas(), true, mCurrentBarrier != nullptr);
+    if (!renderNodeDrawable) {
+        mDisplayList->mChildNodes.emplace_back(renderNode, asSkCanvas(), true, mCurrentBarrier);
+        renderNodeDrawable = &mDisplayList->mChildNodes.back();
+    }
     if (Properties::getRenderPipelineType() == RenderPipelineType::SkiaVulkan) {
         // Put Vulkan WebViews with non-rectangular clips in a HW layer
         renderNode->mutateStagingProperties().setClipMayBeComplex(mRecorder.isClipMayBeComplex());
     }
-    drawDrawable(&renderNodeDrawable);
+    drawDrawable(renderNodeDrawable);
 
     // use staging property, since recording on UI thread
     if (renderNode->stagingProperties().isProjectionReceiver()) {
-        mDisplayList->mProjectionReceiver = &renderNodeDrawable;
+        mDisplayList->mProjectionReceiver = renderNodeDrawable;
     }
 }
 
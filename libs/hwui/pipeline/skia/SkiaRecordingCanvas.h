@@ -76,6 +76,11 @@ public:
                                     uirenderer::GlFunctorLifecycleListener* listener) override;
     void drawWebViewFunctor(int functor) override;
 
+protected:
+    // Recorded text replays later on the RenderThread, so new glyph strikes
+    // are worth rasterizing ahead of time on the CommonPool.
+    virtual bool prewarmsGlyphs() const override { return true; }
+
 private:
     RecordingCanvas mRecorder;
     std::unique_ptr<SkiaDisplayList> mDisplayList;
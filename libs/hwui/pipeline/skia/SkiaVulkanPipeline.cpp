@@ -93,7 +93,7 @@ bool SkiaVulkanPipeline::draw(const Frame& frame, const SkRect& screenDirty, con
     return true;
 }
 
-bool SkiaVulkanPipeline::swapBuffers(const Frame& frame, bool drew, const SkRect& screenDirty,
+bool SkiaVulkanPipeline::swapBuffers(const Frame& frame, bool drew, const DamageRegion& screenDirty,
                                      FrameInfo* currentFrameInfo, bool* requireSwap) {
     *requireSwap = drew;
 
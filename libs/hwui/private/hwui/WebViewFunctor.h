@@ -73,6 +73,12 @@ ANDROID_API int WebViewFunctor_create(void* data, const WebViewFunctorCallbacks&
 // and it should be considered alive & active until that point.
 ANDROID_API void WebViewFunctor_release(int functor);
 
+// May be called on any thread. Opts the functor into the change-detection handshake: after the
+// first call, onSync is only delivered for frames where new content has been reported since the
+// last delivered sync, so static content skips the callback entirely and reuses the previously
+// synced state. Functors that never call this keep receiving every sync as before.
+ANDROID_API void WebViewFunctor_reportContentChanged(int functor);
+
 }  // namespace android::uirenderer
 
 #endif  // FRAMEWORKS_BASE_WEBVIEWFUNCTOR_H
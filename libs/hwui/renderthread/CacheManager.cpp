@@ -68,13 +68,51 @@ void CacheManager::reset(sk_sp<GrContext> context) {
 
     if (context) {
         mGrContext = std::move(context);
-        mGrContext->setResourceCacheLimit(mMaxResourceBytes);
+        mGrContext->setResourceCacheLimit(resourceBudget());
+    }
+}
+
+size_t CacheManager::resourceBudget() const {
+    switch (mMemoryPolicy) {
+        case MemoryPolicy::SystemOverlay:
+            return mMaxResourceBytes * Properties::overlayCachePercent / 100;
+        case MemoryPolicy::AlwaysOn:
+            return mMaxResourceBytes * Properties::alwaysOnCachePercent / 100;
+        case MemoryPolicy::Default:
+            break;
+    }
+    return mMaxResourceBytes;
+}
+
+size_t CacheManager::cpuFontCacheBudget() const {
+    switch (mMemoryPolicy) {
+        case MemoryPolicy::SystemOverlay:
+            return mMaxCpuFontCacheBytes * Properties::overlayCachePercent / 100;
+        case MemoryPolicy::AlwaysOn:
+            return mMaxCpuFontCacheBytes * Properties::alwaysOnCachePercent / 100;
+        case MemoryPolicy::Default:
+            break;
+    }
+    return mMaxCpuFontCacheBytes;
+}
+
+void CacheManager::setMemoryPolicy(MemoryPolicy policy) {
+    if (policy == mMemoryPolicy) {
+        return;
+    }
+    mMemoryPolicy = policy;
+    // Lowering a limit purges down to the new budget right away; raising one
+    // just lets the working set grow back on demand.
+    SkGraphics::SetFontCacheLimit(cpuFontCacheBudget());
+    if (mGrContext) {
+        mGrContext->setResourceCacheLimit(resourceBudget());
     }
 }
 
 void CacheManager::destroy() {
     // cleanup any caches here as the GrContext is about to go away...
     mGrContext.reset(nullptr);
+    mShadersPrecompiled = false;
 }
 
 class CommonPoolExecutor : public SkExecutor {
@@ -96,6 +134,10 @@ void CacheManager::configureContext(GrContextOptions* contextOptions, const void
     contextOptions->fGpuPathRenderers &= ~GpuPathRenderers::kCoverageCounting;
 }
 
+// Maximum resource bytes released per incremental trim slice. Sized so a slice stays well under
+// a millisecond of driver deletion work and fits in the idle window after a swap.
+static constexpr size_t kTrimSliceBytes = 1 * 1024 * 1024;
+
 void CacheManager::trimMemory(TrimMemoryMode mode) {
     if (!mGrContext) {
         return;
@@ -105,24 +147,55 @@ void CacheManager::trimMemory(TrimMemoryMode mode) {
 
     switch (mode) {
         case TrimMemoryMode::Complete:
+            // Critical pressure: purge everything synchronously, superseding any
+            // incremental trim still in flight.
+            mTrimPending = false;
             mGrContext->freeGpuResources();
             SkGraphics::PurgeAllCaches();
+            // We must sync the cpu to make sure deletions of resources still queued up on the
+            // GPU actually happen.
+            mGrContext->flush(kSyncCpu_GrFlushFlag, 0, nullptr);
             break;
         case TrimMemoryMode::UiHidden:
-            // Here we purge all the unlocked scratch resources and then toggle the resources cache
-            // limits between the background and max amounts. This causes the unlocked resources
-            // that have persistent data to be purged in LRU order.
-            mGrContext->purgeUnlockedResources(true);
-            mGrContext->setResourceCacheLimit(mBackgroundResourceBytes);
-            mGrContext->setResourceCacheLimit(mMaxResourceBytes);
+            // UI_HIDDEN can arrive while other windows of the process are still animating, and
+            // purging the whole cache in one go stalls the RenderThread for several ms
+            // mid-scroll. Toggle the CPU font cache limits here (cheap) and arm the incremental
+            // trimmer for the GPU side; performPendingTrim() drains it in bounded slices from
+            // the post-swap idle window.
+            mTrimPending = true;
             SkGraphics::SetFontCacheLimit(mBackgroundCpuFontCacheBytes);
-            SkGraphics::SetFontCacheLimit(mMaxCpuFontCacheBytes);
+            SkGraphics::SetFontCacheLimit(cpuFontCacheBudget());
             break;
     }
+}
 
-    // We must sync the cpu to make sure deletions of resources still queued up on the GPU actually
-    // happen.
+bool CacheManager::performPendingTrim() {
+    if (!mTrimPending) {
+        return false;
+    }
+    if (!mGrContext) {
+        mTrimPending = false;
+        return false;
+    }
+    ATRACE_NAME("CacheManager::performPendingTrim");
+
+    size_t bytesUsed = 0;
+    mGrContext->getResourceCacheUsage(nullptr, &bytesUsed);
+    const size_t retentionBytes = std::min(mBackgroundResourceBytes, resourceBudget());
+    if (bytesUsed > retentionBytes && mGrContext->getResourceCachePurgeableBytes() > 0) {
+        // Release a bounded amount in LRU order, preferring scratch resources. Unlocked scratch
+        // that fits under the background budget is left for reuse; honoring the frame deadline
+        // matters more than the last few megabytes.
+        mGrContext->purgeUnlockedResources(
+                std::min(kTrimSliceBytes, bytesUsed - retentionBytes), true);
+        return true;
+    }
+
+    // Retention target reached. Sync the cpu once to make sure deletions of resources still
+    // queued up on the GPU actually happen.
+    mTrimPending = false;
     mGrContext->flush(kSyncCpu_GrFlushFlag, 0, nullptr);
+    return false;
 }
 
 void CacheManager::trimStaleResources() {
@@ -187,6 +260,16 @@ void CacheManager::dumpMemoryUsage(String8& log, const RenderState* renderState)
 }
 
 void CacheManager::onFrameCompleted() {
+    // The frame just swapped, so this is the idle window where a slice of any
+    // pending incremental trim is least likely to push the next frame over deadline.
+    performPendingTrim();
+    if (!mShadersPrecompiled && mGrContext) {
+        // Replay the shader programs persisted by previous runs once the first
+        // frame is out of the way, so the driver compiles happen between frames
+        // instead of the first time each effect is drawn.
+        mShadersPrecompiled = true;
+        skiapipeline::ShaderCache::get().precompileShaders(mGrContext.get());
+    }
     if (ATRACE_ENABLED()) {
         static skiapipeline::ATraceMemoryDump tracer;
         tracer.startFrame();
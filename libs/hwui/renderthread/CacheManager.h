@@ -24,6 +24,8 @@
 #include <utils/String8.h>
 #include <vector>
 
+#include "Properties.h"
+
 namespace android {
 
 class Surface;
@@ -45,10 +47,22 @@ public:
     void configureContext(GrContextOptions* context, const void* identity, ssize_t size);
 #endif
     void trimMemory(TrimMemoryMode mode);
+    /**
+     * Re-tunes the GrContext resource cache and Skia font cache budgets for the given process
+     * class. Called at lifecycle transitions (see RenderProxy::setProcessMemoryPolicy); shrinking
+     * the limits purges the caches down to the new budget immediately.
+     */
+    void setMemoryPolicy(MemoryPolicy policy);
+    /**
+     * Runs at most one bounded slice of a trim armed by trimMemory(UiHidden), so the purge work
+     * lands in post-swap idle windows instead of stalling a frame. Returns true while more work
+     * remains.
+     */
+    bool performPendingTrim();
     void trimStaleResources();
     void dumpMemoryUsage(String8& log, const RenderState* renderState = nullptr);
 
-    size_t getCacheSize() const { return mMaxResourceBytes; }
+    size_t getCacheSize() const { return resourceBudget(); }
     size_t getBackgroundCacheSize() const { return mBackgroundResourceBytes; }
     void onFrameCompleted();
 
@@ -62,9 +76,17 @@ private:
 #endif
     void destroy();
 
+    // Budgets currently in effect, i.e. the defaults scaled by the policy's
+    // retention percentage from Properties.
+    size_t resourceBudget() const;
+    size_t cpuFontCacheBudget() const;
+
     const size_t mMaxSurfaceArea;
+    MemoryPolicy mMemoryPolicy = MemoryPolicy::Default;
 #ifdef __ANDROID__ // Layoutlib does not support hardware acceleration
     sk_sp<GrContext> mGrContext;
+    bool mShadersPrecompiled = false;
+    bool mTrimPending = false;
 #endif
 
     const size_t mMaxResourceBytes;
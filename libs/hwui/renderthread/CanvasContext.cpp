@@ -195,6 +195,7 @@ void CanvasContext::setSurface(ANativeWindow* window, bool enableTimeout) {
         // its frame stats disabled automatically.
         native_window_enable_frame_timestamps(mNativeSurface->getNativeWindow(), true);
     } else {
+        mAnimatingOnRenderThread = false;
         mRenderThread.removeFrameCallback(this);
         mGenerationID++;
     }
@@ -206,6 +207,7 @@ void CanvasContext::setSwapBehavior(SwapBehavior swapBehavior) {
 
 bool CanvasContext::pauseSurface() {
     mGenerationID++;
+    mAnimatingOnRenderThread = false;
     return mRenderThread.removeFrameCallback(this);
 }
 
@@ -214,6 +216,7 @@ void CanvasContext::setStopped(bool stopped) {
         mStopped = stopped;
         if (mStopped) {
             mGenerationID++;
+            mAnimatingOnRenderThread = false;
             mRenderThread.removeFrameCallback(this);
             mRenderPipeline->onStop();
         } else if (mIsDirty && hasSurface()) {
@@ -395,6 +398,9 @@ void CanvasContext::prepareTree(TreeInfo& info, int64_t* uiFrameInfo, int64_t sy
     }
 
     bool postedFrameCallback = false;
+    // Self-driving only counts when actual RT animators are running; a merely
+    // dropped frame reposts too, but the UI thread still owns that content.
+    mAnimatingOnRenderThread = false;
     if (info.out.hasAnimations || !info.out.canDrawThisFrame) {
         if (CC_UNLIKELY(!Properties::enableRTAnimations)) {
             info.out.requiresUiRedraw = true;
@@ -404,6 +410,7 @@ void CanvasContext::prepareTree(TreeInfo& info, int64_t* uiFrameInfo, int64_t sy
             // as we will just end up fighting the UI thread.
             mRenderThread.postFrameCallback(this);
             postedFrameCallback = true;
+            mAnimatingOnRenderThread = info.out.hasAnimations;
         }
     }
 
@@ -426,6 +433,7 @@ void CanvasContext::prepareTree(TreeInfo& info, int64_t* uiFrameInfo, int64_t sy
 }
 
 void CanvasContext::stopDrawing() {
+    mAnimatingOnRenderThread = false;
     mRenderThread.removeFrameCallback(this);
     mAnimationContext->pauseAnimators();
     mGenerationID++;
@@ -442,7 +450,10 @@ void CanvasContext::setPresentTime() {
     const auto frameIntervalNanos = mRenderThread.timeLord().frameIntervalNanos();
     if (mFixedRenderAhead) {
         renderAhead = std::min(mRenderAheadDepth, mRenderAheadCapacity);
-    } else if (frameIntervalNanos < 15_ms) {
+    } else if (frameIntervalNanos < 15_ms && willLikelyMissLatch()) {
+        // High refresh rates leave a sync window too small for slow frames. Only buy the
+        // extra frame of queue depth when the measured pipeline needs it, so windows that
+        // render quickly keep minimum input latency.
         renderAhead = std::min(1, static_cast<int>(mRenderAheadCapacity));
     }
 
@@ -454,9 +465,21 @@ void CanvasContext::setPresentTime() {
     native_window_set_buffers_timestamp(mNativeSurface->getNativeWindow(), presentTime);
 }
 
+bool CanvasContext::willLikelyMissLatch() const {
+    if (mExpectedFrameDuration == 0) {
+        // No history yet; assume the worst so a new window doesn't open with a jank.
+        return true;
+    }
+    const nsecs_t deadline =
+            mRenderThread.timeLord().frameIntervalNanos() - mLatchDeadlineOffsetNanos;
+    // Allow for some scheduling noise on top of the prediction.
+    return mExpectedFrameDuration + 500_us > deadline;
+}
+
 void CanvasContext::draw() {
-    SkRect dirty;
-    mDamageAccumulator.finish(&dirty);
+    DamageRegion dirtyRegion;
+    mDamageAccumulator.finish(&dirtyRegion);
+    SkRect dirty = dirtyRegion.computeBounds();
 
     if (dirty.isEmpty() && Properties::skipEmptyFrames && !surfaceRequiresRedraw()) {
         mCurrentFrameInfo->addFlag(FrameInfoFlags::SkippedFrame);
@@ -476,6 +499,19 @@ void CanvasContext::draw() {
 
     SkRect windowDirty = computeDirtyRect(frame, &dirty);
 
+    // The rects accumulated this frame describe what changed on screen; the
+    // bounding windowDirty only widens to the full window when the frame needs
+    // a complete repaint (new surface, resize, ...). Feeding the individual
+    // rects to the swap damage below lets the compositor skip the clean area
+    // in between, e.g. when only two far-apart corners were dirtied.
+    DamageRegion screenDirtyRegion;
+    if (windowDirty == SkRect::MakeIWH(frame.width(), frame.height())) {
+        screenDirtyRegion.set(windowDirty);
+    } else {
+        screenDirtyRegion = dirtyRegion;
+        screenDirtyRegion.intersect(windowDirty);
+    }
+
     bool drew = mRenderPipeline->draw(frame, windowDirty, dirty, mLightGeometry, &mLayerUpdateQueue,
                                       mContentDrawBounds, mOpaque, mLightInfo, mRenderNodes,
                                       &(profiler()));
@@ -486,8 +522,8 @@ void CanvasContext::draw() {
 
     bool requireSwap = false;
     int error = OK;
-    bool didSwap =
-            mRenderPipeline->swapBuffers(frame, drew, windowDirty, mCurrentFrameInfo, &requireSwap);
+    bool didSwap = mRenderPipeline->swapBuffers(frame, drew, screenDirtyRegion, mCurrentFrameInfo,
+                                                &requireSwap);
 
     mIsDirty = false;
 
@@ -548,6 +584,12 @@ void CanvasContext::draw() {
     // TODO: Use a fence for real completion?
     mCurrentFrameInfo->markFrameCompleted();
 
+    // Feed the latch predictor. The weighted average converges within a few frames while
+    // riding out one-off hiccups.
+    const nsecs_t frameDuration = mCurrentFrameInfo->duration(FrameInfoIndex::SyncStart,
+                                                              FrameInfoIndex::FrameCompleted);
+    mExpectedFrameDuration = (3 * mExpectedFrameDuration + frameDuration) / 4;
+
 #if LOG_FRAMETIME_MMA
     float thisFrame = mCurrentFrameInfo->duration(FrameInfoIndex::IssueDrawCommandsStart,
                                                   FrameInfoIndex::FrameCompleted) /
@@ -683,6 +725,15 @@ void CanvasContext::destroyHardwareResources() {
     }
 }
 
+// Keeps an incremental trim progressing when no windows are drawing; while frames are being
+// produced the slices run from CacheManager::onFrameCompleted in the post-swap idle window
+// instead, and this just reschedules until the trim completes.
+static void drainPendingTrim(RenderThread& thread) {
+    if (thread.cacheManager().performPendingTrim()) {
+        thread.queue().postDelayed(4_ms, [&thread]() { drainPendingTrim(thread); });
+    }
+}
+
 void CanvasContext::trimMemory(RenderThread& thread, int level) {
     ATRACE_CALL();
     if (!thread.getGrContext()) return;
@@ -692,6 +743,7 @@ void CanvasContext::trimMemory(RenderThread& thread, int level) {
         thread.destroyRenderingContext();
     } else if (level >= TRIM_MEMORY_UI_HIDDEN) {
         thread.cacheManager().trimMemory(CacheManager::TrimMemoryMode::UiHidden);
+        drainPendingTrim(thread);
     }
 }
 
@@ -129,6 +129,13 @@ public:
     virtual void doFrame() override;
     void prepareAndDraw(RenderNode* node);
 
+    /**
+     * True while the last frame scheduled its successor directly on the RenderThread, i.e. only
+     * RT-driven animators (VectorDrawable, RenderNodeAnimator) are active and upcoming frames
+     * replay without a UI-thread sync. The owner can skip waking the UI thread while this holds.
+     */
+    bool isAnimatingOnRenderThread() const { return mAnimatingOnRenderThread; }
+
     void buildLayer(RenderNode* node);
     void markLayerInUse(RenderNode* node);
 
@@ -195,6 +202,15 @@ public:
     // Must be called before setSurface
     void setRenderAheadDepth(int renderAhead);
 
+    /**
+     * Hints how long before the next vsync this window's buffer must be queued to make the
+     * compositor's latch. Feeds the present-time prediction; 0 means the latch happens at the
+     * vsync itself.
+     */
+    void setLatchDeadlineHint(nsecs_t deadlineOffsetNanos) {
+        mLatchDeadlineOffsetNanos = deadlineOffsetNanos;
+    }
+
     SkISize getNextFrameSize() const;
 
 private:
@@ -211,6 +227,7 @@ private:
     bool isSwapChainStuffed();
     bool surfaceRequiresRedraw();
     void setPresentTime();
+    bool willLikelyMissLatch() const;
 
     SkRect computeDirtyRect(const Frame& frame, SkRect* dirty);
 
@@ -229,10 +246,16 @@ private:
     // CanvasContext is dirty if it has received an update that it has not
     // painted onto its surface.
     bool mIsDirty = false;
+    // See isAnimatingOnRenderThread(). Only written on the RenderThread.
+    bool mAnimatingOnRenderThread = false;
     SwapBehavior mSwapBehavior = SwapBehavior::kSwap_default;
     bool mFixedRenderAhead = false;
     uint32_t mRenderAheadDepth = 0;
     uint32_t mRenderAheadCapacity = 0;
+    // Weighted moving average of recent SyncStart..FrameCompleted durations, used to predict
+    // whether the next frame will make its latch deadline.
+    nsecs_t mExpectedFrameDuration = 0;
+    nsecs_t mLatchDeadlineOffsetNanos = 0;
     struct SwapHistory {
         SkRect damage;
         nsecs_t vsyncTime;
@@ -26,6 +26,7 @@
 #include <string>
 #include <vector>
 
+#include "DamageAccumulator.h"
 #include "Frame.h"
 #include "Properties.h"
 #include "utils/Color.h"
@@ -465,15 +466,17 @@ bool EglManager::damageRequiresSwap() {
     return EglExtensions.setDamage && mSwapBehavior == SwapBehavior::BufferAge;
 }
 
-bool EglManager::swapBuffers(const Frame& frame, const SkRect& screenDirty) {
+bool EglManager::swapBuffers(const Frame& frame, const DamageRegion& screenDirty) {
     if (CC_UNLIKELY(Properties::waitForGpuCompletion)) {
         ATRACE_NAME("Finishing GPU work");
         fence();
     }
 
-    EGLint rects[4];
-    frame.map(screenDirty, rects);
-    eglSwapBuffersWithDamageKHR(mEglDisplay, frame.mSurface, rects, screenDirty.isEmpty() ? 0 : 1);
+    EGLint rects[4 * DamageRegion::kMaxRects];
+    for (int i = 0; i < screenDirty.count(); i++) {
+        frame.map(screenDirty[i], rects + 4 * i);
+    }
+    eglSwapBuffersWithDamageKHR(mEglDisplay, frame.mSurface, rects, screenDirty.count());
 
     EGLint err = eglGetError();
     if (CC_LIKELY(err == EGL_SUCCESS)) {
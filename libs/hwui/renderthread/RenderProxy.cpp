@@ -121,6 +121,11 @@ int RenderProxy::syncAndDrawFrame() {
     return mDrawFrameTask.drawFrame();
 }
 
+bool RenderProxy::isAnimatingOnRenderThread() {
+    return mRenderThread.queue().runSync(
+            [this]() -> bool { return mContext->isAnimatingOnRenderThread(); });
+}
+
 void RenderProxy::destroy() {
     // destroyCanvasAndSurface() needs a fence as when it returns the
     // underlying BufferQueue is going to be released from under
@@ -190,6 +195,21 @@ void RenderProxy::trimMemory(int level) {
     }
 }
 
+void RenderProxy::setProcessMemoryPolicy(int policy) {
+    if (policy < static_cast<int>(MemoryPolicy::Default) ||
+        policy > static_cast<int>(MemoryPolicy::AlwaysOn)) {
+        ALOGW("Ignoring unknown memory policy %d", policy);
+        return;
+    }
+    // Unlike trimMemory we do create the RenderThread if needed: always-on
+    // processes classify themselves at startup, before their first frame, and
+    // the policy must stick around for when rendering begins.
+    RenderThread& thread = RenderThread::getInstance();
+    thread.queue().post([&thread, policy]() {
+        thread.cacheManager().setMemoryPolicy(static_cast<MemoryPolicy>(policy));
+    });
+}
+
 void RenderProxy::overrideProperty(const char* name, const char* value) {
     // expensive, but block here since name/value pointers owned by caller
     RenderThread::getInstance().queue().runSync(
@@ -314,6 +334,12 @@ void RenderProxy::setRenderAheadDepth(int renderAhead) {
             [context = mContext, renderAhead] { context->setRenderAheadDepth(renderAhead); });
 }
 
+void RenderProxy::setLatchDeadlineHint(int64_t deadlineOffsetNanos) {
+    mRenderThread.queue().post([context = mContext, deadlineOffsetNanos] {
+        context->setLatchDeadlineHint(deadlineOffsetNanos);
+    });
+}
+
 int RenderProxy::copySurfaceInto(ANativeWindow* window, int left, int top, int right, int bottom,
                                  SkBitmap* bitmap) {
     auto& thread = RenderThread::getInstance();
@@ -322,6 +348,22 @@ int RenderProxy::copySurfaceInto(ANativeWindow* window, int left, int top, int r
     }));
 }
 
+void RenderProxy::copySurfaceIntoAsync(ANativeWindow* window, int left, int top, int right,
+                                       int bottom, SkBitmap* bitmap,
+                                       std::function<void(int)>&& callback) {
+    auto& thread = RenderThread::getInstance();
+    ANativeWindow_acquire(window);
+    thread.queue().post([&thread, window, srcRect = Rect(left, top, right, bottom), bitmap,
+                         callback = std::move(callback)]() mutable {
+        thread.readback().copySurfaceIntoAsync(
+                window, srcRect, bitmap, [callback = std::move(callback)](CopyResult result) {
+                    callback(static_cast<int>(result));
+                });
+        // The source buffer has been acquired from the window by now, if it ever will be.
+        ANativeWindow_release(window);
+    });
+}
+
 void RenderProxy::prepareToDraw(Bitmap& bitmap) {
     // If we haven't spun up a hardware accelerated window yet, there's no
     // point in precaching these bitmaps as it can't impact jank.
@@ -22,6 +22,8 @@
 #include <cutils/compiler.h>
 #include <utils/Functor.h>
 
+#include <functional>
+
 #include "../FrameMetricsObserver.h"
 #include "../IContextFactory.h"
 #include "DrawFrameTask.h"
@@ -80,6 +82,13 @@ public:
     ANDROID_API void setWideGamut(bool wideGamut);
     ANDROID_API int64_t* frameInfo();
     ANDROID_API int syncAndDrawFrame();
+    /**
+     * Returns true while only RenderThread-driven animators (VectorDrawable,
+     * RenderNodeAnimator) are active and the RenderThread is replaying frames
+     * itself, without a UI-thread sync. The UI thread can skip scheduling
+     * traversals for unchanged trees while this holds.
+     */
+    ANDROID_API bool isAnimatingOnRenderThread();
     ANDROID_API void destroy();
 
     ANDROID_API static void invokeFunctor(Functor* functor, bool waitForCompletion);
@@ -94,6 +103,9 @@ public:
 
     ANDROID_API void destroyHardwareResources();
     ANDROID_API static void trimMemory(int level);
+    // Takes a uirenderer::MemoryPolicy value; reclassifies the process so
+    // CacheManager can re-tune its cache budgets at lifecycle transitions.
+    ANDROID_API static void setProcessMemoryPolicy(int policy);
     ANDROID_API static void overrideProperty(const char* name, const char* value);
 
     ANDROID_API void fence();
@@ -141,8 +153,23 @@ public:
      */
     ANDROID_API void setRenderAheadDepth(int renderAhead);
 
+    /**
+     * Hints how long before the next vsync this window's buffer must be queued to make the
+     * compositor's latch, in nanoseconds. Used by the frame pacing prediction; 0 (the
+     * default) means the latch happens at the vsync itself.
+     */
+    ANDROID_API void setLatchDeadlineHint(int64_t deadlineOffsetNanos);
+
     ANDROID_API static int copySurfaceInto(ANativeWindow* window, int left, int top, int right,
                                            int bottom, SkBitmap* bitmap);
+    /**
+     * Queues a copy of the surface's last queued buffer into the bitmap without blocking the
+     * calling thread or RenderThread on the GPU transfer. The callback receives a CopyResult
+     * code and runs on RenderThread; the bitmap must stay valid until it does.
+     */
+    ANDROID_API static void copySurfaceIntoAsync(ANativeWindow* window, int left, int top,
+                                                 int right, int bottom, SkBitmap* bitmap,
+                                                 std::function<void(int)>&& callback);
     ANDROID_API static void prepareToDraw(Bitmap& bitmap);
 
     static int copyHWBitmapInto(Bitmap* hwBitmap, SkBitmap* bitmap);
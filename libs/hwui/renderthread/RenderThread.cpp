@@ -168,6 +168,13 @@ void RenderThread::initThreadLocals() {
     mRenderState = new RenderState(*this);
     mVkManager = new VulkanManager();
     mCacheManager = new CacheManager();
+
+    if (Properties::getRenderPipelineType() == RenderPipelineType::SkiaVulkan) {
+        // Warm the Vulkan instance, device and queues (and with them the disk-backed
+        // pipeline cache) while the thread is otherwise idle, so the first window
+        // doesn't pay the full driver initialization cost in its first frame.
+        queue().post([this]() { requireVkContext(); });
+    }
 }
 
 void RenderThread::setupFrameInterval() {
@@ -494,7 +494,7 @@ static void destroy_semaphore(void* context) {
     }
 }
 
-void VulkanManager::swapBuffers(VulkanSurface* surface, const SkRect& dirtyRect) {
+void VulkanManager::swapBuffers(VulkanSurface* surface, const DamageRegion& dirtyRegion) {
     if (CC_UNLIKELY(Properties::waitForGpuCompletion)) {
         ATRACE_NAME("Finishing GPU work");
         mDeviceWaitIdle(mDevice);
@@ -543,7 +543,7 @@ void VulkanManager::swapBuffers(VulkanSurface* surface, const SkRect& dirtyRect)
     }
     destroy_semaphore(destroyInfo);
 
-    surface->presentCurrentBuffer(dirtyRect, fenceFd);
+    surface->presentCurrentBuffer(dirtyRegion, fenceFd);
 }
 
 void VulkanManager::destroySurface(VulkanSurface* surface) {
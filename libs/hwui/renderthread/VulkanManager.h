@@ -64,7 +64,7 @@ public:
     void destroySurface(VulkanSurface* surface);
 
     Frame dequeueNextBuffer(VulkanSurface* surface);
-    void swapBuffers(VulkanSurface* surface, const SkRect& dirtyRect);
+    void swapBuffers(VulkanSurface* surface, const DamageRegion& dirtyRegion);
 
     // Cleans up all the global state in the VulkanManger.
     void destroy();
@@ -436,23 +436,26 @@ VulkanSurface::NativeBufferInfo* VulkanSurface::dequeueNativeBuffer() {
     return bufferInfo;
 }
 
-bool VulkanSurface::presentCurrentBuffer(const SkRect& dirtyRect, int semaphoreFd) {
-    if (!dirtyRect.isEmpty()) {
+bool VulkanSurface::presentCurrentBuffer(const DamageRegion& dirtyRegion, int semaphoreFd) {
+    if (!dirtyRegion.isEmpty()) {
 
-        // native_window_set_surface_damage takes a rectangle in prerotated space
+        // native_window_set_surface_damage takes rectangles in prerotated space
         // with a bottom-left origin. That is, top > bottom.
-        // The dirtyRect is also in prerotated space, so we just need to switch it to
-        // a bottom-left origin space.
-
-        SkIRect irect;
-        dirtyRect.roundOut(&irect);
-        android_native_rect_t aRect;
-        aRect.left = irect.left();
-        aRect.top = logicalHeight() - irect.top();
-        aRect.right = irect.right();
-        aRect.bottom = logicalHeight() - irect.bottom();
-
-        int err = native_window_set_surface_damage(mNativeWindow.get(), &aRect, 1);
+        // The dirty rects are also in prerotated space, so we just need to switch
+        // them to a bottom-left origin space.
+
+        android_native_rect_t aRects[DamageRegion::kMaxRects];
+        for (int i = 0; i < dirtyRegion.count(); i++) {
+            SkIRect irect;
+            dirtyRegion[i].roundOut(&irect);
+            aRects[i].left = irect.left();
+            aRects[i].top = logicalHeight() - irect.top();
+            aRects[i].right = irect.right();
+            aRects[i].bottom = logicalHeight() - irect.bottom();
+        }
+
+        int err = native_window_set_surface_damage(mNativeWindow.get(), aRects,
+                                                   dirtyRegion.count());
         ALOGE_IF(err != 0, "native_window_set_surface_damage failed: %s (%d)", strerror(-err), err);
     }
 
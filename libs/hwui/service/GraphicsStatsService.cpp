@@ -16,6 +16,7 @@
 
 #include "GraphicsStatsService.h"
 
+#include <cutils/ashmem.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <google/protobuf/io/zero_copy_stream_impl_lite.h>
@@ -562,6 +563,29 @@ void GraphicsStatsService::finishDumpInMemory(Dump* dump, AStatsEventList* data,
     delete dump;
 }
 
+bool GraphicsStatsService::mergeProfileDataFromAshmem(int ashmemFd, ProfileData* output) {
+    int regionSize = ashmem_get_size_region(ashmemFd);
+    if (regionSize < static_cast<int>(sizeof(ProfileData))) {
+        ALOGW("Ashmem region on fd %d is too small! Received %d, required %u", ashmemFd,
+              regionSize, static_cast<unsigned int>(sizeof(ProfileData)));
+        return false;
+    }
+    void* addr = mmap(nullptr, sizeof(ProfileData), PROT_READ, MAP_SHARED, ashmemFd, 0);
+    if (addr == MAP_FAILED) {
+        int err = errno;
+        ALOGW("Failed to mmap profile data from fd %d, errno=%d (%s)", ashmemFd, err,
+              strerror(err));
+        return false;
+    }
+    // The owning process keeps updating its region while we read, so a
+    // snapshot taken mid-frame may be off by the frame in flight. That's fine
+    // for histogram telemetry and what keeps the pull free of any round trip
+    // into the app.
+    output->mergeWith(*reinterpret_cast<const ProfileData*>(addr));
+    munmap(addr, sizeof(ProfileData));
+    return true;
+}
+
 
 } /* namespace uirenderer */
 } /* namespace android */
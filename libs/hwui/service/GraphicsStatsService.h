@@ -57,6 +57,13 @@ public:
     ANDROID_API static void finishDumpInMemory(Dump* dump, AStatsEventList* data,
                                                bool lastFullDay);
 
+    // Fleet-telemetry pull path. Each process already renders its ProfileData
+    // into the ashmem region handed out by GraphicsStatsService.java; this maps
+    // that region read-only and merges the histograms into output. A caller
+    // holding the registered fds can therefore snapshot every process with one
+    // mmap+merge each and no binder round trip into the apps.
+    ANDROID_API static bool mergeProfileDataFromAshmem(int ashmemFd, ProfileData* output);
+
     // Visible for testing
     static bool parseFromFile(const std::string& path, protos::GraphicsStatsProto* output);
 };
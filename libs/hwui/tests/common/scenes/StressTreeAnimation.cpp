@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TestSceneBase.h"
+
+#include <cmath>
+
+/**
+ * Parameterized full-pipeline stress scene: builds a balanced tree of render nodes and
+ * re-records a fixed percentage of the leaves every frame, so prepareTree, recording, flush
+ * and swap are all exercised with a controlled tree shape. The registered variants sweep node
+ * count, depth, damage rate and hardware layer count; run them through macrobench with
+ * --benchmark_format=json to track the per-stage percentiles.
+ */
+template <int NODES, int DEPTH, int DAMAGE_PERCENT, int LAYERS>
+class StressTreeAnimation : public TestScene {
+public:
+    static TestScene* create(const TestScene::Options&) {
+        return new StressTreeAnimation<NODES, DEPTH, DAMAGE_PERCENT, LAYERS>();
+    }
+
+    void createContent(int width, int height, Canvas& canvas) override {
+        // Pick a branching factor so the tree reaches roughly NODES nodes at depth DEPTH.
+        mBranchFactor = std::max(2, (int)std::ceil(std::pow(NODES, 1.0 / DEPTH)));
+        int budget = NODES;
+        sp<RenderNode> root = buildNode(DEPTH, 0, 0, width, height, budget);
+
+        canvas.drawColor(0xFFFFFFFF, SkBlendMode::kSrcOver);
+        canvas.drawRenderNode(root.get());
+        mRoot = root;
+    }
+
+    void doFrame(int frameNr) override {
+        size_t damaged = (mLeaves.size() * DAMAGE_PERCENT + 99) / 100;
+        SkColor color = TestUtils::interpolateColor((frameNr % 150) / 150.0f, 0xFFF44336,
+                                                    0xFF2196F3);
+        for (size_t i = 0; i < damaged; i++) {
+            // Rotate through the leaves so damage isn't pinned to one corner of the screen.
+            auto& leaf = mLeaves[(frameNr * damaged + i) % mLeaves.size()];
+            TestUtils::recordNode(*leaf, [color](Canvas& canvas) {
+                canvas.drawColor(color, SkBlendMode::kSrcOver);
+            });
+        }
+    }
+
+private:
+    sp<RenderNode> buildNode(int depth, int left, int top, int right, int bottom, int& budget) {
+        budget--;
+        if (depth == 0 || budget <= 0) {
+            sp<RenderNode> leaf = TestUtils::createNode(
+                    left, top, right, bottom, [](RenderProperties& props, Canvas& canvas) {
+                        canvas.drawColor(0xFF4CAF50, SkBlendMode::kSrcOver);
+                    });
+            mLeaves.push_back(leaf);
+            return leaf;
+        }
+        std::vector<sp<RenderNode>> children;
+        int childWidth = std::max(1, (right - left) / mBranchFactor);
+        for (int i = 0; i < mBranchFactor && budget > 0; i++) {
+            children.push_back(buildNode(depth - 1, left + i * childWidth, top,
+                                         left + (i + 1) * childWidth, bottom, budget));
+        }
+        bool isLayer = mLayerCount < LAYERS;
+        if (isLayer) mLayerCount++;
+        sp<RenderNode> node = TestUtils::createNode(
+                left, top, right, bottom,
+                [children, isLayer](RenderProperties& props, Canvas& canvas) {
+                    if (isLayer) {
+                        props.mutateLayerProperties().setType(LayerType::RenderLayer);
+                    }
+                    for (auto& child : children) {
+                        canvas.drawRenderNode(child.get());
+                    }
+                });
+        return node;
+    }
+
+    sp<RenderNode> mRoot;
+    std::vector<sp<RenderNode>> mLeaves;
+    int mBranchFactor = 2;
+    int mLayerCount = 0;
+};
+
+static TestScene::Registrar _StressTree(TestScene::Info{
+        "stresstree", "A balanced tree of 256 nodes, depth 4, 25% of leaves damaged per frame.",
+        StressTreeAnimation<256, 4, 25, 0>::create});
+
+static TestScene::Registrar _StressTreeWide(TestScene::Info{
+        "stresstree_wide", "A shallow, wide tree of 512 nodes at depth 2, 25% damage per frame.",
+        StressTreeAnimation<512, 2, 25, 0>::create});
+
+static TestScene::Registrar _StressTreeDeep(TestScene::Info{
+        "stresstree_deep", "A narrow tree of 256 nodes at depth 8, 25% damage per frame.",
+        StressTreeAnimation<256, 8, 25, 0>::create});
+
+static TestScene::Registrar _StressTreeLayers(TestScene::Info{
+        "stresstree_layers",
+        "A tree of 256 nodes, depth 4, 25% damage per frame with 16 hardware layers.",
+        StressTreeAnimation<256, 4, 25, 16>::create});
+
+static TestScene::Registrar _StressTreeFullDamage(TestScene::Info{
+        "stresstree_fulldamage",
+        "A tree of 256 nodes, depth 4 where every leaf re-records every frame.",
+        StressTreeAnimation<256, 4, 100, 0>::create});
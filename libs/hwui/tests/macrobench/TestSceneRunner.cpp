@@ -15,6 +15,8 @@
  */
 
 #include "AnimationContext.h"
+#include "FrameInfo.h"
+#include "FrameMetricsObserver.h"
 #include "RenderNode.h"
 #include "renderthread/RenderProxy.h"
 #include "renderthread/RenderTask.h"
@@ -28,6 +30,11 @@
 #include <log/log.h>
 #include <ui/PixelFormat.h>
 
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <vector>
+
 using namespace android;
 using namespace android::uirenderer;
 using namespace android::uirenderer::renderthread;
@@ -62,9 +69,51 @@ private:
     T mAverage;
 };
 
+// Collects the FrameInfo stream of every completed frame and breaks it down into the pipeline
+// stages, so per-stage percentiles can be reported next to the overall frame time.
+class FrameStatsCollector : public FrameMetricsObserver {
+public:
+    struct Stage {
+        const char* name;
+        FrameInfoIndex start;
+        FrameInfoIndex end;
+    };
+
+    static constexpr std::array<Stage, 5> kStages = {
+            Stage{"record", FrameInfoIndex::Vsync, FrameInfoIndex::SyncQueued},
+            Stage{"sync", FrameInfoIndex::SyncStart, FrameInfoIndex::IssueDrawCommandsStart},
+            Stage{"draw", FrameInfoIndex::IssueDrawCommandsStart, FrameInfoIndex::SwapBuffers},
+            Stage{"swap", FrameInfoIndex::SwapBuffers, FrameInfoIndex::FrameCompleted},
+            Stage{"total", FrameInfoIndex::IntendedVsync, FrameInfoIndex::FrameCompleted},
+    };
+
+    void notify(const int64_t* buffer) override {
+        std::lock_guard _lock{mLock};
+        for (size_t i = 0; i < kStages.size(); i++) {
+            mDurations[i].push_back(buffer[static_cast<int>(kStages[i].end)] -
+                                    buffer[static_cast<int>(kStages[i].start)]);
+        }
+    }
+
+    double percentileInMs(size_t stage, int percentile) {
+        std::lock_guard _lock{mLock};
+        auto& samples = mDurations[stage];
+        if (samples.empty()) return 0;
+        std::sort(samples.begin(), samples.end());
+        size_t index = (samples.size() - 1) * percentile / 100;
+        return samples[index] / 1000000.0;
+    }
+
+private:
+    std::mutex mLock;
+    std::array<std::vector<int64_t>, kStages.size()> mDurations;
+};
+
+constexpr std::array<FrameStatsCollector::Stage, 5> FrameStatsCollector::kStages;
+
 void outputBenchmarkReport(const TestScene::Info& info, const TestScene::Options& opts,
                            benchmark::BenchmarkReporter* reporter, RenderProxy* proxy,
-                           double durationInS) {
+                           FrameStatsCollector* stats, double durationInS) {
     using namespace benchmark;
 
     struct ReportInfo {
@@ -105,6 +154,25 @@ void outputBenchmarkReport(const TestScene::Info& info, const TestScene::Options
             reporter->ReportRuns(reports);
         }
     }
+
+    // Per-stage breakdown of the same frames, one pseudo-run per stage and percentile; with
+    // --benchmark_format=json this is directly machine-readable.
+    if (stats) {
+        for (size_t stage = 0; stage < FrameStatsCollector::kStages.size(); stage++) {
+            for (auto& ri : REPORTS) {
+                reports[0].run_name.function_name = info.name;
+                reports[0].run_name.function_name += "_";
+                reports[0].run_name.function_name += FrameStatsCollector::kStages[stage].name;
+                reports[0].run_name.function_name += ri.suffix;
+                durationInS = stats->percentileInMs(stage, ri.percentile) / 1000.0;
+                reports[0].real_accumulated_time = durationInS;
+                reports[0].cpu_accumulated_time = durationInS;
+                reports[0].iterations = 1;
+                reports[0].counters["items_per_second"] = 0;
+                reporter->ReportRuns(reports);
+            }
+        }
+    }
 }
 
 void run(const TestScene::Info& info, const TestScene::Options& opts,
@@ -152,6 +220,13 @@ void run(const TestScene::Info& info, const TestScene::Options& opts,
     proxy->resetProfileInfo();
     proxy->fence();
 
+    // Only collect the per-stage breakdown when vsync is real; offscreen runs report fps.
+    sp<FrameStatsCollector> stats;
+    if (reporter && !opts.renderOffscreen) {
+        stats = new FrameStatsCollector();
+        proxy->addFrameMetricsObserver(stats.get());
+    }
+
     if (opts.renderAhead) {
         usleep(33000);
     }
@@ -182,8 +257,12 @@ void run(const TestScene::Info& info, const TestScene::Options& opts,
     nsecs_t end = systemTime(SYSTEM_TIME_MONOTONIC);
 
     if (reporter) {
-        outputBenchmarkReport(info, opts, reporter, proxy.get(), (end - start) / (double)s2ns(1));
+        outputBenchmarkReport(info, opts, reporter, proxy.get(), stats.get(),
+                              (end - start) / (double)s2ns(1));
     } else {
         proxy->dumpProfileInfo(STDOUT_FILENO, DumpFlags::JankStats);
     }
+    if (stats) {
+        proxy->removeFrameMetricsObserver(stats.get());
+    }
 }
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "hwui/Bitmap.h"
+
+#include <SkImageInfo.h>
+
+#include <string.h>
+
+using namespace android;
+
+static sk_sp<Bitmap> createFilledBitmap(const SkImageInfo& info, uint8_t value, bool immutable) {
+    sk_sp<Bitmap> bitmap = Bitmap::allocateHeapBitmap(info);
+    memset(bitmap->pixels(), value, bitmap->getAllocationByteCount());
+    if (immutable) {
+        bitmap->setImmutable();
+    }
+    return bitmap;
+}
+
+TEST(Bitmap, makeImageInternsSmallImmutableContent) {
+    SkImageInfo info = SkImageInfo::MakeN32Premul(16, 16);
+
+    // Identical immutable content must map to one shared image, so the GPU sees
+    // a single texture for all copies.
+    sk_sp<Bitmap> first = createFilledBitmap(info, 0x42, true);
+    sk_sp<Bitmap> second = createFilledBitmap(info, 0x42, true);
+    EXPECT_EQ(first->makeImage()->uniqueID(), second->makeImage()->uniqueID());
+
+    // Different content gets its own image.
+    sk_sp<Bitmap> different = createFilledBitmap(info, 0x24, true);
+    EXPECT_NE(first->makeImage()->uniqueID(), different->makeImage()->uniqueID());
+
+    // Mutable bitmaps are never shared, even with matching content.
+    sk_sp<Bitmap> mutableCopy = createFilledBitmap(info, 0x42, false);
+    EXPECT_NE(first->makeImage()->uniqueID(), mutableCopy->makeImage()->uniqueID());
+}
@@ -74,8 +74,11 @@ RENDERTHREAD_SKIA_PIPELINE_TEST(CacheManager, trimMemory) {
     const size_t purgeableBytes = grContext->getResourceCachePurgeableBytes();
     ASSERT_TRUE(renderThread.cacheManager().getBackgroundCacheSize() < purgeableBytes);
 
-    // UI hidden and make sure only some got purged (unique should remain)
+    // UI hidden arms an incremental trim; drain all its slices, then make sure only some got
+    // purged (unique should remain)
     renderThread.cacheManager().trimMemory(CacheManager::TrimMemoryMode::UiHidden);
+    while (renderThread.cacheManager().performPendingTrim()) {
+    }
     ASSERT_TRUE(0 < grContext->getResourceCachePurgeableBytes());
     ASSERT_TRUE(renderThread.cacheManager().getBackgroundCacheSize() > getCacheUsage(grContext));
 
@@ -83,3 +86,23 @@ RENDERTHREAD_SKIA_PIPELINE_TEST(CacheManager, trimMemory) {
     renderThread.cacheManager().trimMemory(CacheManager::TrimMemoryMode::Complete);
     ASSERT_TRUE(0 == grContext->getResourceCachePurgeableBytes());
 }
+
+RENDERTHREAD_SKIA_PIPELINE_TEST(CacheManager, memoryPolicy) {
+    GrContext* grContext = renderThread.getGrContext();
+    ASSERT_TRUE(grContext != nullptr);
+
+    const size_t defaultBudget = renderThread.cacheManager().getCacheSize();
+    ASSERT_EQ(defaultBudget, grContext->getResourceCacheLimit());
+
+    // An always-on process keeps only a fraction of the default budget, and the
+    // GrContext limit follows the reclassification immediately.
+    renderThread.cacheManager().setMemoryPolicy(MemoryPolicy::AlwaysOn);
+    const size_t alwaysOnBudget = renderThread.cacheManager().getCacheSize();
+    ASSERT_LT(alwaysOnBudget, defaultBudget);
+    ASSERT_EQ(alwaysOnBudget, grContext->getResourceCacheLimit());
+
+    // Returning to the foreground restores the full budget.
+    renderThread.cacheManager().setMemoryPolicy(MemoryPolicy::Default);
+    ASSERT_EQ(defaultBudget, renderThread.cacheManager().getCacheSize());
+    ASSERT_EQ(defaultBudget, grContext->getResourceCacheLimit());
+}
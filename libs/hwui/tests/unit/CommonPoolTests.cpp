@@ -50,10 +50,19 @@ TEST(DISABLED_CommonPool, threadCount) {
     for (auto& f : futures) {
         threads.insert(f.get());
     }
-    EXPECT_EQ(threads.size(), CommonPool::THREAD_COUNT);
+    EXPECT_EQ(threads.size(), static_cast<size_t>(CommonPool::threadCount()));
     EXPECT_EQ(0, threads.count(gettid()));
 }
 
+TEST(CommonPool, postBackground) {
+    std::atomic_bool ran(false);
+    CommonPool::postBackground([&ran] { ran = true; });
+    for (int i = 0; !ran && i < 1000; i++) {
+        usleep(1);
+    }
+    EXPECT_TRUE(ran) << "Failed to flip atomic after 1 second";
+}
+
 TEST(CommonPool, singleThread) {
     std::mutex mutex;
     std::condition_variable fence;
@@ -101,7 +110,7 @@ TEST(DISABLED_CommonPool, fullQueue) {
     std::mutex lock;
     std::condition_variable fence;
     bool signaled = false;
-    static constexpr auto QUEUE_COUNT = CommonPool::THREAD_COUNT + CommonPool::QUEUE_SIZE + 10;
+    static constexpr auto QUEUE_COUNT = CommonPool::MAX_THREAD_COUNT + CommonPool::QUEUE_SIZE + 10;
     std::atomic_int queuedCount{0};
     std::array<std::future<void>, QUEUE_COUNT> futures;
 
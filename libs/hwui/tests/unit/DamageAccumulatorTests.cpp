@@ -101,6 +101,40 @@ TEST(DamageAccumulator, basicRenderNode) {
     ASSERT_EQ(SkRect::MakeLTRB(100, 100, 125, 125), dirty);
 }
 
+// Test that disjoint dirty areas survive as separate rects instead of being
+// unioned into one large rect
+TEST(DamageAccumulator, disjointRegion) {
+    DamageAccumulator da;
+    DamageRegion region;
+    da.pushTransform(&Matrix4::identity());
+    da.dirty(0, 0, 25, 25);
+    da.dirty(500, 500, 525, 525);
+    da.popTransform();
+    da.finish(&region);
+    ASSERT_EQ(2, region.count());
+    EXPECT_EQ(SkRect::MakeLTRB(0, 0, 25, 25), region[0]);
+    EXPECT_EQ(SkRect::MakeLTRB(500, 500, 525, 525), region[1]);
+    EXPECT_EQ(SkRect::MakeLTRB(0, 0, 525, 525), region.computeBounds());
+}
+
+// Test that the region stays bounded and merging prefers nearby rects
+TEST(DamageAccumulator, boundedRegion) {
+    DamageRegion region;
+    region.setEmpty();
+    for (int i = 0; i < 2 * DamageRegion::kMaxRects; i++) {
+        region.add(SkRect::MakeXYWH(i * 100, i * 100, 50, 50));
+    }
+    ASSERT_LE(region.count(), DamageRegion::kMaxRects);
+    SkRect bounds = region.computeBounds();
+    EXPECT_EQ(SkRect::MakeLTRB(0, 0, 750, 750), bounds);
+
+    // Overlapping damage folds into the existing rect rather than taking a slot
+    region.set(SkRect::MakeLTRB(0, 0, 50, 50));
+    region.add(SkRect::MakeLTRB(25, 25, 75, 75));
+    ASSERT_EQ(1, region.count());
+    EXPECT_EQ(SkRect::MakeLTRB(0, 0, 75, 75), region[0]);
+}
+
 TEST(DamageAccumulator, perspectiveTransform) {
     DamageAccumulator da;
     RenderNode node1;
@@ -19,8 +19,10 @@
 #include "protos/graphicsstats.pb.h"
 #include "service/GraphicsStatsService.h"
 
+#include <cutils/ashmem.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -160,3 +162,31 @@ TEST(GraphicsStats, merge) {
         EXPECT_EQ(expectedBucket, loadedProto.histogram().Get(i).render_millis());
     }
 }
+
+TEST(GraphicsStats, mergeFromAshmem) {
+    int fd = ashmem_create_region("test_profile_data", sizeof(ProfileData));
+    ASSERT_GE(fd, 0);
+    void* addr = mmap(nullptr, sizeof(ProfileData), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ASSERT_NE(MAP_FAILED, addr);
+    MockProfileData* shared = new (addr) MockProfileData;
+    shared->editTotalFrameCount() = 42;
+    shared->editJankFrameCount() = 7;
+    shared->editFrameCounts()[3] = 12;
+
+    MockProfileData collected;
+    collected.editTotalFrameCount() = 8;
+    collected.editFrameCounts()[3] = 2;
+    EXPECT_TRUE(GraphicsStatsService::mergeProfileDataFromAshmem(fd, &collected));
+    EXPECT_EQ(50u, collected.totalFrameCount());
+    EXPECT_EQ(7u, collected.jankFrameCount());
+    EXPECT_EQ(14u, collected.editFrameCounts()[3]);
+
+    munmap(addr, sizeof(ProfileData));
+    close(fd);
+
+    // A region too small to hold a ProfileData must be rejected
+    int smallFd = ashmem_create_region("test_profile_data_small", 16);
+    ASSERT_GE(smallFd, 0);
+    EXPECT_FALSE(GraphicsStatsService::mergeProfileDataFromAshmem(smallFd, &collected));
+    close(smallFd);
+}
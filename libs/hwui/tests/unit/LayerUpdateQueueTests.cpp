@@ -69,6 +69,34 @@ TEST(LayerUpdateQueue, enqueueUnion) {
     EXPECT_EQ(Rect(10, 10, 40, 40), queue.entries()[0].damage);
 }
 
+TEST(LayerUpdateQueue, enqueueDisjointRects) {
+    sp<RenderNode> a = createSyncedNode(400, 400);
+
+    LayerUpdateQueue queue;
+    queue.enqueueLayerWithDamage(a.get(), Rect(10, 10, 20, 20));
+    queue.enqueueLayerWithDamage(a.get(), Rect(300, 300, 320, 320));
+
+    // Disjoint damage is tracked as separate regions, the union only summarizes.
+    EXPECT_EQ(1u, queue.entries().size());
+    ASSERT_EQ(2u, queue.entries()[0].damageRects.size());
+    EXPECT_EQ(Rect(10, 10, 20, 20), queue.entries()[0].damageRects[0]);
+    EXPECT_EQ(Rect(300, 300, 320, 320), queue.entries()[0].damageRects[1]);
+    EXPECT_EQ(Rect(10, 10, 320, 320), queue.entries()[0].damage);
+
+    // Overlapping damage merges into the region it touches.
+    queue.enqueueLayerWithDamage(a.get(), Rect(15, 15, 30, 30));
+    ASSERT_EQ(2u, queue.entries()[0].damageRects.size());
+    EXPECT_EQ(Rect(10, 10, 30, 30), queue.entries()[0].damageRects[0]);
+
+    // Exceeding the cap collapses the regions back to the union.
+    queue.enqueueLayerWithDamage(a.get(), Rect(100, 10, 110, 20));
+    queue.enqueueLayerWithDamage(a.get(), Rect(200, 10, 210, 20));
+    ASSERT_EQ(4u, queue.entries()[0].damageRects.size());
+    queue.enqueueLayerWithDamage(a.get(), Rect(10, 300, 20, 310));
+    ASSERT_EQ(1u, queue.entries()[0].damageRects.size());
+    EXPECT_EQ(queue.entries()[0].damage, queue.entries()[0].damageRects[0]);
+}
+
 TEST(LayerUpdateQueue, clear) {
     sp<RenderNode> a = createSyncedNode(100, 100);
 
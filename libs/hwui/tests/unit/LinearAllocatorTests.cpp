@@ -86,6 +86,33 @@ TEST(LinearAllocator, rewind) {
     EXPECT_EQ(1, destroyed);
 }
 
+TEST(LinearAllocator, fullRewind) {
+    int destroyed[10] = {0};
+    LinearAllocator la;
+    for (int i = 0; i < 10; i++) {
+        la.create<TestUtils::SignalingDtor>(destroyed + i);
+        la.alloc<char>(200);
+    }
+    size_t allocated = la.allocatedSize();
+    la.rewind();
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(1, destroyed[i]);
+    }
+    EXPECT_EQ(0u, la.usedSize());
+
+    // Refilling with the same pattern must reuse the retained pages.
+    int destroyedAgain[10] = {0};
+    for (int i = 0; i < 10; i++) {
+        la.create<TestUtils::SignalingDtor>(destroyedAgain + i);
+        la.alloc<char>(200);
+    }
+    EXPECT_EQ(allocated, la.allocatedSize());
+    la.rewind();
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(1, destroyedAgain[i]);
+    }
+}
+
 TEST(LinearStdAllocator, simpleAllocate) {
     LinearAllocator la;
     LinearStdAllocator<void*> stdAllocator(la);
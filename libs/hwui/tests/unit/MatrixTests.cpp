@@ -35,6 +35,43 @@ TEST(Matrix, mapRect_emptyScaleSkew) {
     EXPECT_FALSE(empty.isEmpty()) << "Empty 'line' rect doesn't remain empty when skewed.";
 }
 
+TEST(Matrix, loadMultiply) {
+    Matrix4 a;
+    a.loadRotate(30);
+    a.translate(5, -10);
+    a.scale(2, 3, 1);
+
+    Matrix4 b;
+    b.loadScale(10, 10, 1);
+    b.skew(0.1f, 0.2f);
+
+    Matrix4 product;
+    product.loadMultiply(a, b);
+
+    // Each column of the product must be 'a' applied to the matching column of 'b'.
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            float expected = 0;
+            for (int k = 0; k < 4; k++) {
+                expected += a.data[k * 4 + j] * b.data[i * 4 + k];
+            }
+            EXPECT_NEAR(expected, product.data[i * 4 + j], 1e-4f)
+                    << "mismatch at column " << i << ", row " << j;
+        }
+    }
+}
+
+TEST(Matrix, mapRect_skewCorners) {
+    // Skew, so the four-corner path runs instead of the simple scale/translate one
+    Matrix4 skewMatrix;
+    skewMatrix.loadIdentity();
+    skewMatrix.skew(0.5f, 0.0f);
+
+    Rect rect(10, 20, 30, 40);
+    skewMatrix.mapRect(rect);
+    EXPECT_EQ(Rect(20, 20, 50, 40), rect);
+}
+
 TEST(Matrix, mapRect_emptyRotate) {
     // Skew, so we don't hit identity/translate/simple fast paths
     Matrix4 skewMatrix;
@@ -57,6 +57,29 @@ TEST(RenderNodeDrawable, create) {
     ASSERT_EQ(drawable.getRecordedMatrix(), canvas.getTotalMatrix());
 }
 
+TEST(RenderNodeDrawable, contentBounds) {
+    DisplayListData boundedDL;
+    RecordingCanvas canvas;
+    canvas.reset(&boundedDL, SkIRect::MakeWH(200, 400));
+    SkPaint paint;
+    canvas.drawRect(SkRect::MakeLTRB(10, 20, 30, 40), paint);
+    canvas.translate(100, 100);
+    canvas.drawRect(SkRect::MakeLTRB(0, 0, 10, 10), paint);
+    ASSERT_TRUE(boundedDL.hasContentBounds());
+    EXPECT_EQ(SkRect::MakeLTRB(10, 20, 110, 110), boundedDL.contentBounds());
+
+    // A draw whose extent is only known at draw time leaves the bounds unknown.
+    DisplayListData unboundedDL;
+    canvas.reset(&unboundedDL, SkIRect::MakeWH(200, 400));
+    canvas.drawPaint(paint);
+    EXPECT_FALSE(unboundedDL.hasContentBounds());
+
+    // Resetting the list makes the (empty) bounds known again.
+    unboundedDL.reset();
+    ASSERT_TRUE(unboundedDL.hasContentBounds());
+    EXPECT_TRUE(unboundedDL.contentBounds().isEmpty());
+}
+
 namespace {
 
 static void drawOrderedRect(Canvas* canvas, uint8_t expectedDrawOrder) {
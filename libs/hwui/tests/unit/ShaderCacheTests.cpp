@@ -60,6 +60,14 @@ public:
     static bool validateCache(ShaderCache& cache, std::vector<T> hash) {
         return cache.validateCache(hash.data(), hash.size() * sizeof(T));
     }
+
+    /**
+     * "warmUpKeyCount" returns the number of shader keys remembered for warm-up.
+     */
+    static size_t warmUpKeyCount(ShaderCache& cache) {
+        std::lock_guard<std::mutex> lock(cache.mMutex);
+        return cache.mWarmUpKeys.size();
+    }
 };
 
 } /* namespace skiapipeline */
@@ -279,4 +287,44 @@ TEST(ShaderCacheTest, testCacheValidation) {
     remove(cacheFile1.c_str());
 }
 
+TEST(ShaderCacheTest, testWarmUpKeyIndex) {
+    if (!folderExist(getExternalStorageFolder())) {
+        // don't run the test if external storage folder is not available
+        return;
+    }
+    std::string cacheFile1 = getExternalStorageFolder() + "/shaderCacheTest1";
+
+    // remove any test files from previous test run
+    int deleteFile = remove(cacheFile1.c_str());
+    ASSERT_TRUE(0 == deleteFile || ENOENT == errno);
+
+    // the cache starts with no warm-up keys
+    ShaderCache::get().setFilename(cacheFile1.c_str());
+    ShaderCacheTestUtils::setSaveDelay(ShaderCache::get(), 0);  // disable deferred save
+    ShaderCache::get().initShaderDiskCache();
+    ASSERT_EQ(0u, ShaderCacheTestUtils::warmUpKeyCount(ShaderCache::get()));
+
+    // store two shaders and overwrite one of them; only distinct keys are remembered
+    sk_sp<SkData> inVS;
+    setShader(inVS, "sassas");
+    ShaderCache::get().store(GrProgramDescTest(100), *inVS.get());
+    setShader(inVS, "someVS");
+    ShaderCache::get().store(GrProgramDescTest(432), *inVS.get());
+    setShader(inVS, "ewData1");
+    ShaderCache::get().store(GrProgramDescTest(432), *inVS.get());
+    ASSERT_EQ(2u, ShaderCacheTestUtils::warmUpKeyCount(ShaderCache::get()));
+
+    // store content to disk, release the in-memory cache and verify the key
+    // index is restored along with the blobs
+    ShaderCacheTestUtils::terminate(ShaderCache::get(), true);
+    ShaderCache::get().initShaderDiskCache();
+    ASSERT_EQ(2u, ShaderCacheTestUtils::warmUpKeyCount(ShaderCache::get()));
+    sk_sp<SkData> outVS;
+    ASSERT_NE((outVS = ShaderCache::get().load(GrProgramDescTest(100))), sk_sp<SkData>());
+    ASSERT_TRUE(checkShader(outVS, "sassas"));
+
+    ShaderCacheTestUtils::terminate(ShaderCache::get(), false);
+    remove(cacheFile1.c_str());
+}
+
 }  // namespace
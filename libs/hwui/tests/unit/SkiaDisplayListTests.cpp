@@ -71,6 +71,31 @@ TEST(SkiaDisplayList, reset) {
     ASSERT_FALSE(skiaDL->mProjectionReceiver);
 }
 
+TEST(SkiaDisplayList, recycleChildNodes) {
+    sp<RenderNode> nodeA = new RenderNode();
+    sp<RenderNode> nodeB = new RenderNode();
+    SkCanvas dummyCanvas;
+
+    SkiaDisplayList skiaDL;
+    skiaDL.mChildNodes.emplace_back(nodeA.get(), &dummyCanvas);
+    skiaDL.mChildNodes.emplace_back(nodeB.get(), &dummyCanvas);
+
+    // resetting while keeping children arms them for reuse by the next recording
+    skiaDL.reset(true);
+    ASSERT_EQ(2u, skiaDL.mChildNodes.size());
+
+    RenderNodeDrawable* reused = skiaDL.reuseChildNode(nodeA.get(), &dummyCanvas, true, false);
+    ASSERT_EQ(&skiaDL.mChildNodes[0], reused);
+
+    // a mismatching node drops the remaining recycled drawables
+    ASSERT_EQ(nullptr, skiaDL.reuseChildNode(nodeA.get(), &dummyCanvas, true, false));
+    ASSERT_EQ(1u, skiaDL.mChildNodes.size());
+
+    // a plain reset destroys the children as before
+    skiaDL.reset();
+    ASSERT_TRUE(skiaDL.mChildNodes.empty());
+}
+
 TEST(SkiaDisplayList, reuseDisplayList) {
     sp<RenderNode> renderNode = new RenderNode();
     std::unique_ptr<SkiaDisplayList> availableList;
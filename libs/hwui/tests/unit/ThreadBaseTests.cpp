@@ -49,6 +49,19 @@ TEST(ThreadBase, post) {
     ASSERT_TRUE(ran) << "Failed to flip atomic after 1 second";
 }
 
+TEST(ThreadBase, postOrder) {
+    // All of these run on the queue's thread, so no locking is needed on the vector.
+    std::vector<int> order;
+    for (int i = 0; i < 10; i++) {
+        queue().post([&order, i]() { order.push_back(i); });
+    }
+    queue().runSync([]() {});
+    ASSERT_EQ(10u, order.size());
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(i, order[i]);
+    }
+}
+
 TEST(ThreadBase, postDelay) {
     using clock = WorkQueue::clock;
 
@@ -273,6 +273,26 @@ TEST(PathParser, parseStringForData) {
     }
 }
 
+TEST(PathParser, parseStringForDataCached) {
+    const char* pathString = "M 1 1 L 5 5 c 9.8 7 8 9 8 10";
+    PathParser::ParseResult result;
+    PathData first;
+    PathParser::getPathDataFromAsciiString(&first, &result, pathString, strlen(pathString));
+    EXPECT_FALSE(result.failureOccurred);
+
+    // A second parse of the same string is served from the intern cache and must match.
+    PathData second;
+    PathParser::getPathDataFromAsciiString(&second, &result, pathString, strlen(pathString));
+    EXPECT_FALSE(result.failureOccurred);
+    EXPECT_EQ(first, second);
+
+    // Cached results are copies; mutating one parse must not leak into the next.
+    second.points[0] = 42;
+    PathData third;
+    PathParser::getPathDataFromAsciiString(&third, &result, pathString, strlen(pathString));
+    EXPECT_EQ(first, third);
+}
+
 TEST(VectorDrawableUtils, createSkPathFromPathData) {
     for (const TestData& testData : sTestDataSet) {
         SkPath expectedPath;
@@ -409,5 +429,23 @@ TEST(VectorDrawable, drawPathWithoutIncrementingShaderRefCount) {
     EXPECT_TRUE(shader->unique());
 }
 
+TEST(VectorDrawable, prefetchBitmapUpdate) {
+    sp<VectorDrawableRoot> tree(new VectorDrawableRoot(new VectorDrawable::Group()));
+    tree->mutateProperties()->setViewportSize(5, 5);
+    tree->mutateProperties()->setScaledSize(5, 5);
+    ASSERT_TRUE(tree->isDirty());
+
+    // Collecting a prefetched rasterization must leave a clean, correctly
+    // sized cache bitmap behind.
+    tree->prefetchBitmapUpdate();
+    Bitmap& bitmap = tree->getBitmapUpdateIfDirty();
+    EXPECT_FALSE(tree->isDirty());
+    EXPECT_EQ(5, bitmap.width());
+    EXPECT_EQ(5, bitmap.height());
+
+    // With nothing dirty and no prefetch in flight, the same bitmap is reused.
+    EXPECT_EQ(&bitmap, &tree->getBitmapUpdateIfDirty());
+}
+
 }  // namespace uirenderer
 }  // namespace android
@@ -81,6 +81,52 @@ TEST(WebViewFunctor, createSyncHandleGLES) {
     EXPECT_EQ(1, counts.destroyed);
 }
 
+TEST(WebViewFunctor, skipSyncWhenContentUnchanged) {
+    int functor = WebViewFunctor_create(
+            nullptr, TestUtils::createMockFunctor(RenderMode::OpenGL_ES), RenderMode::OpenGL_ES);
+    ASSERT_NE(-1, functor);
+    auto handle = WebViewFunctorManager::instance().handleFor(functor);
+    ASSERT_TRUE(handle);
+    WebViewFunctor_release(functor);
+    auto& counts = TestUtils::countsForFunctor(functor);
+
+    // Without the opt-in handshake every sync is delivered.
+    TestUtils::runOnRenderThreadUnmanaged([&](auto&) {
+        WebViewSyncData syncData;
+        syncData.applyForceDark = false;
+        handle->sync(syncData);
+        handle->sync(syncData);
+    });
+    EXPECT_EQ(2, counts.sync);
+    EXPECT_EQ(0u, handle->skippedSyncCount());
+
+    // After opting in, the reported change is delivered and unchanged frames are skipped.
+    WebViewFunctor_reportContentChanged(functor);
+    TestUtils::runOnRenderThreadUnmanaged([&](auto&) {
+        WebViewSyncData syncData;
+        syncData.applyForceDark = false;
+        handle->sync(syncData);
+        handle->sync(syncData);
+        handle->sync(syncData);
+    });
+    EXPECT_EQ(3, counts.sync);
+    EXPECT_EQ(2u, handle->skippedSyncCount());
+
+    // A change in the sync payload is always delivered, reported content or not.
+    TestUtils::runOnRenderThreadUnmanaged([&](auto&) {
+        WebViewSyncData syncData;
+        syncData.applyForceDark = true;
+        handle->sync(syncData);
+    });
+    EXPECT_EQ(4, counts.sync);
+
+    handle.clear();
+    TestUtils::runOnRenderThreadUnmanaged([](renderthread::RenderThread&) {
+        // fence
+    });
+    EXPECT_EQ(1, counts.destroyed);
+}
+
 TEST(WebViewFunctor, createSyncDrawGLES) {
     int functor = WebViewFunctor_create(
             nullptr, TestUtils::createMockFunctor(RenderMode::OpenGL_ES), RenderMode::OpenGL_ES);
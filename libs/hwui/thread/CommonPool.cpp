@@ -16,21 +16,38 @@
 
 #include "CommonPool.h"
 
+#include <android-base/properties.h>
 #include <sys/resource.h>
 #include <utils/Trace.h>
+#include "Properties.h"
 #include "renderthread/RenderThread.h"
 
+#include <algorithm>
 #include <array>
+#include <thread>
 
 namespace android {
 namespace uirenderer {
 
-CommonPool::CommonPool() {
+int CommonPool::threadCount() {
+    static const int sThreadCount = [] {
+        int count = base::GetIntProperty(PROPERTY_TASK_THREAD_COUNT, 0);
+        if (count <= 0) {
+            // Half the cores, so the pool scales up on big devices without
+            // competing with the RenderThread and GPU on small ones.
+            const int cores = static_cast<int>(std::thread::hardware_concurrency());
+            count = std::clamp(cores / 2, 2, 4);
+        }
+        return std::min(count, static_cast<int>(MAX_THREAD_COUNT));
+    }();
+    return sThreadCount;
+}
+
+CommonPool::CommonPool() : mThreadCount(threadCount()) {
     ATRACE_CALL();
 
     CommonPool* pool = this;
-    // Create 2 workers
-    for (int i = 0; i < THREAD_COUNT; i++) {
+    for (int i = 0; i < mThreadCount; i++) {
         std::thread worker([pool, i] {
             {
                 std::array<char, 20> name{"hwuiTask"};
@@ -55,18 +72,23 @@ CommonPool& CommonPool::instance() {
 }
 
 void CommonPool::post(Task&& task) {
-    instance().enqueue(std::move(task));
+    instance().enqueue(std::move(task), false /* background */);
+}
+
+void CommonPool::postBackground(Task&& task) {
+    instance().enqueue(std::move(task), true /* background */);
 }
 
-void CommonPool::enqueue(Task&& task) {
+void CommonPool::enqueue(Task&& task, bool background) {
     std::unique_lock lock(mLock);
-    while (!mWorkQueue.hasSpace()) {
+    auto& queue = background ? mBackgroundQueue : mWorkQueue;
+    while (!queue.hasSpace()) {
         lock.unlock();
         usleep(100);
         lock.lock();
     }
-    mWorkQueue.push(std::move(task));
-    if (mWaitingThreads == THREAD_COUNT || (mWaitingThreads > 0 && mWorkQueue.size() > 1)) {
+    queue.push(std::move(task));
+    if (mWaitingThreads == mThreadCount || (mWaitingThreads > 0 && queue.size() > 1)) {
         mCondition.notify_one();
     }
 }
@@ -74,15 +96,19 @@ void CommonPool::enqueue(Task&& task) {
 void CommonPool::workerLoop() {
     std::unique_lock lock(mLock);
     while (true) {
-        if (!mWorkQueue.hasWork()) {
+        if (!mWorkQueue.hasWork() && !mBackgroundQueue.hasWork()) {
             mWaitingThreads++;
             mCondition.wait(lock);
             mWaitingThreads--;
         }
         // Need to double-check that work is still available now that we have the lock
         // It may have already been grabbed by a different thread
-        while (mWorkQueue.hasWork()) {
-            auto work = mWorkQueue.pop();
+        //
+        // The frame-critical lane is always drained before the background lane
+        // is even looked at; background work is re-checked after every task so
+        // a burst of frame work preempts a queued backlog of uploads.
+        while (mWorkQueue.hasWork() || mBackgroundQueue.hasWork()) {
+            auto work = mWorkQueue.hasWork() ? mWorkQueue.pop() : mBackgroundQueue.pop();
             lock.unlock();
             work();
             lock.lock();
@@ -96,7 +122,7 @@ void CommonPool::waitForIdle() {
 
 void CommonPool::doWaitForIdle() {
     std::unique_lock lock(mLock);
-    while (mWaitingThreads != THREAD_COUNT) {
+    while (mWaitingThreads != mThreadCount || mWorkQueue.hasWork() || mBackgroundQueue.hasWork()) {
         lock.unlock();
         usleep(100);
         lock.lock();
@@ -104,4 +130,4 @@ void CommonPool::doWaitForIdle() {
 }
 
 }  // namespace uirenderer
-}  // namespace android
\ No newline at end of file
+}  // namespace android
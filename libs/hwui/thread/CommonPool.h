@@ -77,11 +77,22 @@ class CommonPool {
 
 public:
     using Task = std::function<void()>;
-    static constexpr auto THREAD_COUNT = 2;
+    static constexpr auto MAX_THREAD_COUNT = 8;
     static constexpr auto QUEUE_SIZE = 128;
 
+    // The number of worker threads, decided once at pool creation from the core
+    // count and overridable with debug.hwui.task_thread_count.
+    static int threadCount();
+
+    // Queues a task on the frame-critical lane. Tasks posted here are always
+    // dispatched ahead of background work.
     static void post(Task&& func);
 
+    // Queues a task on the background lane. Workers only pull from this lane
+    // when no frame-critical work is pending, so long-running jobs such as
+    // capture file writes never delay tasks a frame is waiting on.
+    static void postBackground(Task&& func);
+
     template <class F>
     static auto async(F&& func) -> std::future<decltype(func())> {
         typedef std::packaged_task<decltype(func())()> task_t;
@@ -106,15 +117,17 @@ private:
     CommonPool();
     ~CommonPool() {}
 
-    void enqueue(Task&&);
+    void enqueue(Task&&, bool background);
     void doWaitForIdle();
 
     void workerLoop();
 
+    const int mThreadCount;
     std::mutex mLock;
     std::condition_variable mCondition;
     int mWaitingThreads = 0;
     ArrayQueue<Task, QUEUE_SIZE> mWorkQueue;
+    ArrayQueue<Task, QUEUE_SIZE> mBackgroundQueue;
 };
 
 }  // namespace uirenderer
@@ -22,6 +22,7 @@
 #include <log/log.h>
 #include <utils/Timers.h>
 
+#include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <future>
@@ -55,11 +56,32 @@ private:
         std::function<void()> work;
     };
 
+    /**
+     * Node of the lock-free immediate queue. Producers push with a CAS on mImmediateHead, which
+     * therefore holds the tasks in reverse submission order; the consumer takes the whole chain
+     * with one exchange and reverses it before running, restoring FIFO order.
+     */
+    struct ImmediateTask {
+        std::function<void()> work;
+        ImmediateTask* next = nullptr;
+    };
+
 public:
     WorkQueue(std::function<void()>&& wakeFunc, std::mutex& lock)
             : mWakeFunc(move(wakeFunc)), mLock(lock) {}
 
+    ~WorkQueue() {
+        ImmediateTask* task = mImmediateHead.exchange(nullptr, std::memory_order_acquire);
+        while (task) {
+            ImmediateTask* next = task->next;
+            delete task;
+            task = next;
+        }
+    }
+
     void process() {
+        processImmediate();
+
         auto now = clock::now();
         std::vector<WorkItem> toProcess;
         {
@@ -91,7 +113,9 @@ public:
 
     template <class F>
     void post(F&& func) {
-        postAt(0, std::forward<F>(func));
+        // The common cross-thread path: skips the timed queue's mutex and sorted insert
+        // entirely. Timed work still goes through postAt/postDelayed.
+        pushImmediate(new ImmediateTask{std::function<void()>(std::forward<F>(func))});
     }
 
     template <class F>
@@ -110,6 +134,9 @@ public:
     };
 
     nsecs_t nextWakeup(std::unique_lock<std::mutex>& lock) {
+        if (mImmediateHead.load(std::memory_order_acquire)) {
+            return 0;
+        }
         if (mWorkQueue.empty()) {
             return std::numeric_limits<nsecs_t>::max();
         } else {
@@ -118,6 +145,37 @@ public:
     }
 
 private:
+    void pushImmediate(ImmediateTask* task) {
+        ImmediateTask* head = mImmediateHead.load(std::memory_order_relaxed);
+        do {
+            task->next = head;
+        } while (!mImmediateHead.compare_exchange_weak(head, task, std::memory_order_release,
+                                                       std::memory_order_relaxed));
+        // Only the push that found the queue empty needs to wake the consumer; it drains the
+        // whole chain, covering anything pushed behind us.
+        if (!task->next) {
+            mWakeFunc();
+        }
+    }
+
+    void processImmediate() {
+        ImmediateTask* head = mImmediateHead.exchange(nullptr, std::memory_order_acquire);
+        // Reverse the chain to restore submission order, then run the whole batch.
+        ImmediateTask* fifo = nullptr;
+        while (head) {
+            ImmediateTask* next = head->next;
+            head->next = fifo;
+            fifo = head;
+            head = next;
+        }
+        while (fifo) {
+            fifo->work();
+            ImmediateTask* next = fifo->next;
+            delete fifo;
+            fifo = next;
+        }
+    }
+
     void enqueue(WorkItem&& item) {
         bool needsWakeup;
         {
@@ -135,6 +193,11 @@ private:
 
     std::function<void()> mWakeFunc;
 
+    // Immediate work posted cross-thread; a lock-free MPSC intrusive stack, see pushImmediate().
+    std::atomic<ImmediateTask*> mImmediateHead{nullptr};
+
+    // Timed work; stays under the mutex since postAt/postDelayed are rare and need the sorted
+    // insert for nextWakeup().
     std::mutex& mLock;
     std::vector<WorkItem> mWorkQueue;
 };
@@ -80,7 +80,10 @@ public:
     Page* next() { return mNextPage; }
     void setNext(Page* next) { mNextPage = next; }
 
-    Page() : mNextPage(0) {}
+    // allocatedSize is the full size of the underlying allocation, header included,
+    // so a rewound page can be reused as bump space without consulting the
+    // allocator's current page-size ramp.
+    explicit Page(size_t allocatedSize) : mNextPage(0), mAllocatedSize(allocatedSize) {}
 
     void* operator new(size_t /*size*/, void* buf) { return buf; }
 
@@ -88,9 +91,12 @@ public:
 
     void* end(int pageSize) { return (void*)(((size_t)start()) + pageSize); }
 
+    size_t allocatedSize() const { return mAllocatedSize; }
+
 private:
     Page(const Page& /*other*/) {}
     Page* mNextPage;
+    size_t mAllocatedSize;
 };
 
 LinearAllocator::LinearAllocator()
@@ -125,7 +131,7 @@ void* LinearAllocator::start(Page* p) {
 }
 
 void* LinearAllocator::end(Page* p) {
-    return ((char*)p) + mPageSize;
+    return ((char*)p) + p->allocatedSize();
 }
 
 bool LinearAllocator::fitsInCurrentPage(size_t size) {
@@ -135,6 +141,13 @@ bool LinearAllocator::fitsInCurrentPage(size_t size) {
 void LinearAllocator::ensureNext(size_t size) {
     if (fitsInCurrentPage(size)) return;
 
+    // Advance through pages retained by rewind() before growing the chain.
+    while (mCurrentPage && mCurrentPage->next()) {
+        mCurrentPage = mCurrentPage->next();
+        mNext = start(mCurrentPage);
+        if (fitsInCurrentPage(size)) return;
+    }
+
     if (mCurrentPage && mPageSize < MAX_PAGE_SIZE) {
         mPageSize = min(MAX_PAGE_SIZE, mPageSize * 2);
         mMaxAllocSize = mPageSize * MAX_WASTE_RATIO;
@@ -202,6 +215,18 @@ void LinearAllocator::runDestructorFor(void* addr) {
     }
 }
 
+void LinearAllocator::rewind() {
+    while (mDtorList) {
+        auto node = mDtorList;
+        mDtorList = node->next;
+        node->dtor(node->addr);
+    }
+    mCurrentPage = mPages;
+    mNext = mCurrentPage ? start(mCurrentPage) : nullptr;
+    // Every page is empty again; the stats treat retained-but-unused space as wasted.
+    mWastedSpace = mTotalAllocated;
+}
+
 void LinearAllocator::rewindIfLastAlloc(void* ptr, size_t allocSize) {
     // First run the destructor as running the destructor will
     // also rewind for the DestructorNode allocation which will
@@ -222,7 +247,7 @@ LinearAllocator::Page* LinearAllocator::newPage(size_t pageSize) {
     mTotalAllocated += pageSize;
     mPageCount++;
     void* buf = malloc(pageSize);
-    return new (buf) Page();
+    return new (buf) Page(pageSize);
 }
 
 static const char* toSize(size_t value, float& result) {
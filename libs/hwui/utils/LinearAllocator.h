@@ -91,6 +91,14 @@ public:
         return reinterpret_cast<T*>(allocImpl(sizeof(T) * count));
     }
 
+    /**
+     * Runs the destructors of all created objects and resets the allocator to the start of its
+     * page chain. The pages themselves are retained, so a caller with a steady allocation
+     * pattern (such as re-recording a display list every frame) releases everything wholesale
+     * and refills with pure pointer bumps instead of fresh page mallocs.
+     */
+    void rewind();
+
     /**
      * Attempt to deallocate the given buffer, with the LinearAllocator attempting to rewind its
      * state if possible.
@@ -119,6 +119,64 @@ void AIncidentReportArgs_addHeader(AIncidentReportArgs* args, uint8_t const* buf
  */
 int AIncidentReportArgs_takeReport(AIncidentReportArgs* args);
 
+// Progress events delivered to an AIncidentReport_StatusCallback.
+enum {
+    /**
+     * The report has been accepted by incidentd and has started running.
+     */
+    INCIDENT_REPORT_EVENT_STARTED = 1,
+
+    /**
+     * A section changed state. The section id is passed in the callback's
+     * section parameter and its status in the status parameter.
+     */
+    INCIDENT_REPORT_EVENT_SECTION_STATUS = 2,
+
+    /**
+     * The report completed and all data has been written to the stream.
+     */
+    INCIDENT_REPORT_EVENT_FINISHED = 3,
+
+    /**
+     * The report failed; the stream may end without further data.
+     */
+    INCIDENT_REPORT_EVENT_FAILED = 4
+};
+
+// Section status values, sync with android.os.IIncidentReportStatusListener.
+enum {
+    /**
+     * The section has started being gathered.
+     */
+    INCIDENT_REPORT_SECTION_STATUS_STARTING = 1,
+
+    /**
+     * The section has been gathered and written to the stream.
+     */
+    INCIDENT_REPORT_SECTION_STATUS_FINISHED = 2
+};
+
+/**
+ * Callback invoked as a streamed incident report progresses. The event
+ * parameter is one of the INCIDENT_REPORT_EVENT_* constants; section and
+ * status are only meaningful for INCIDENT_REPORT_EVENT_SECTION_STATUS and
+ * are 0 otherwise. Callbacks are delivered on a binder thread, not the
+ * thread that requested the report.
+ */
+typedef void (*AIncidentReport_StatusCallback)(void* cookie, int event, int section, int status);
+
+/**
+ * Initiate taking the report described in the args object, streaming the
+ * report data to the given fd as sections complete instead of saving it on
+ * the device. The call returns as soon as the request is handed to
+ * incidentd; it does not block for the duration of the report. The fd is
+ * duplicated and the caller keeps ownership of it. The callback may be null
+ * if progress events are not wanted. Returns 0 on success, and non-zero
+ * otherwise.
+ */
+int AIncidentReportArgs_takeReportToStream(AIncidentReportArgs* args, int fd,
+        AIncidentReport_StatusCallback callback, void* cookie);
+
 #if __cplusplus
 } // extern "C"
 #endif // __cplusplus
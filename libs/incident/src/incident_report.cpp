@@ -18,19 +18,98 @@
 
 #include <incident/incident_report.h>
 
+#include <android-base/unique_fd.h>
+#include <android/os/BnIncidentReportStatusListener.h>
 #include <android/os/IIncidentManager.h>
 #include <android/os/IncidentReportArgs.h>
 #include <binder/IServiceManager.h>
 #include <binder/Status.h>
+#include <fcntl.h>
 #include <log/log.h>
 
+#include <mutex>
+
+using android::IBinder;
 using android::sp;
+using android::wp;
+using android::base::unique_fd;
 using android::binder::Status;
 using android::os::IncidentReportArgs;
 using android::os::IIncidentManager;
 using std::string;
 using std::vector;
 
+namespace {
+
+// A single cached connection to incidentd shared by every request this
+// process makes. The death recipient drops the connection when incidentd
+// dies, so the next request reconnects instead of talking to a dead binder.
+std::mutex gServiceLock;
+sp<IIncidentManager> gService;
+
+class IncidentDeathRecipient : public IBinder::DeathRecipient {
+public:
+    virtual void binderDied(const wp<IBinder>& /*who*/) {
+        std::lock_guard<std::mutex> lock(gServiceLock);
+        gService = nullptr;
+    }
+};
+
+sp<IncidentDeathRecipient> gDeathRecipient = new IncidentDeathRecipient();
+
+sp<IIncidentManager> getIncidentService() {
+    std::lock_guard<std::mutex> lock(gServiceLock);
+    if (gService == nullptr) {
+        sp<IIncidentManager> service = android::interface_cast<IIncidentManager>(
+                android::defaultServiceManager()->getService(android::String16("incident")));
+        if (service != nullptr) {
+            android::IInterface::asBinder(service)->linkToDeath(gDeathRecipient);
+            gService = service;
+        }
+    }
+    return gService;
+}
+
+// Forwards the binder status callbacks to the C callback.
+class StatusListener : public android::os::BnIncidentReportStatusListener {
+public:
+    StatusListener(AIncidentReport_StatusCallback callback, void* cookie)
+            : mCallback(callback), mCookie(cookie) {
+    }
+
+    virtual Status onReportStarted() {
+        mCallback(mCookie, INCIDENT_REPORT_EVENT_STARTED, 0, 0);
+        return Status::ok();
+    }
+
+    virtual Status onReportSectionStatus(int32_t section, int32_t status) {
+        mCallback(mCookie, INCIDENT_REPORT_EVENT_SECTION_STATUS, section, status);
+        return Status::ok();
+    }
+
+    virtual Status onReportServiceStatus(const android::String16& /*service*/,
+            int32_t /*status*/) {
+        // Service names can't be surfaced through the int-based C callback.
+        return Status::ok();
+    }
+
+    virtual Status onReportFinished() {
+        mCallback(mCookie, INCIDENT_REPORT_EVENT_FINISHED, 0, 0);
+        return Status::ok();
+    }
+
+    virtual Status onReportFailed() {
+        mCallback(mCookie, INCIDENT_REPORT_EVENT_FAILED, 0, 0);
+        return Status::ok();
+    }
+
+private:
+    AIncidentReport_StatusCallback mCallback;
+    void* mCookie;
+};
+
+}  // namespace
+
 AIncidentReportArgs* AIncidentReportArgs_init() {
     return reinterpret_cast<AIncidentReportArgs*>(new IncidentReportArgs());
 }
@@ -72,8 +151,7 @@ void AIncidentReportArgs_addHeader(AIncidentReportArgs* args, uint8_t const* buf
 int AIncidentReportArgs_takeReport(AIncidentReportArgs* argp) {
     IncidentReportArgs* args = reinterpret_cast<IncidentReportArgs*>(argp);
 
-    sp<IIncidentManager> service = android::interface_cast<IIncidentManager>(
-            android::defaultServiceManager()->getService(android::String16("incident")));
+    sp<IIncidentManager> service = getIncidentService();
     if (service == nullptr) {
         ALOGW("Failed to fetch incident service.");
         return false;
@@ -81,3 +159,28 @@ int AIncidentReportArgs_takeReport(AIncidentReportArgs* argp) {
     Status s = service->reportIncident(*args);
     return s.transactionError();
 }
+
+int AIncidentReportArgs_takeReportToStream(AIncidentReportArgs* argp, int fd,
+        AIncidentReport_StatusCallback callback, void* cookie) {
+    IncidentReportArgs* args = reinterpret_cast<IncidentReportArgs*>(argp);
+
+    sp<IIncidentManager> service = getIncidentService();
+    if (service == nullptr) {
+        ALOGW("Failed to fetch incident service.");
+        return -1;
+    }
+
+    unique_fd stream(fcntl(fd, F_DUPFD_CLOEXEC, 0));
+    if (stream.get() < 0) {
+        ALOGW("Failed to dup stream fd %d.", fd);
+        return -1;
+    }
+
+    sp<StatusListener> listener;
+    if (callback != nullptr) {
+        listener = new StatusListener(callback, cookie);
+    }
+
+    Status s = service->reportIncidentToStream(*args, listener, std::move(stream));
+    return s.transactionError();
+}
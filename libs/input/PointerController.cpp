@@ -71,6 +71,13 @@ PointerController::PointerController(const sp<PointerControllerPolicyInterface>&
         mPolicy(policy), mLooper(looper), mSpriteController(spriteController) {
     mHandler = new WeakMessageHandler(this);
     mCallback = new WeakLooperCallback(this);
+    mLatencyTracker = new PointerLatencyTracker();
+
+    // The listener runs on a binder thread and must not retain this controller,
+    // so hand it the tracker directly.
+    sp<PointerLatencyTracker> latencyTracker = mLatencyTracker;
+    mSpriteController->setTransactionCompletedListener(
+            [latencyTracker](nsecs_t timestamp) { latencyTracker->noteMovePresented(timestamp); });
 
     if (mDisplayEventReceiver.initCheck() == NO_ERROR) {
         mLooper->addFd(mDisplayEventReceiver.getFd(), Looper::POLL_CALLBACK,
@@ -104,6 +111,7 @@ PointerController::PointerController(const sp<PointerControllerPolicyInterface>&
 
 PointerController::~PointerController() {
     mLooper->removeMessages(mHandler);
+    mSpriteController->setTransactionCompletedListener(nullptr);
 
     AutoMutex _l(mLock);
 
@@ -183,6 +191,7 @@ void PointerController::setPosition(float x, float y) {
 void PointerController::setPositionLocked(float x, float y) {
     float minX, minY, maxX, maxY;
     if (getBoundsLocked(&minX, &minY, &maxX, &maxY)) {
+        mLatencyTracker->noteMoveReceived(systemTime(SYSTEM_TIME_MONOTONIC));
         if (x <= minX) {
             mLocked.pointerX = minX;
         } else if (x >= maxX) {
@@ -17,6 +17,7 @@
 #ifndef _UI_POINTER_CONTROLLER_H
 #define _UI_POINTER_CONTROLLER_H
 
+#include "PointerLatencyTracker.h"
 #include "SpriteController.h"
 
 #include <map>
@@ -112,6 +113,10 @@ public:
     void setInactivityTimeout(InactivityTimeout inactivityTimeout);
     void reloadPointerResources();
 
+    /* Returns the tracker aggregating move-to-presentation latency.  Its ashmem fd
+     * can be handed to test infrastructure to read the histogram out of process. */
+    sp<PointerLatencyTracker> getLatencyTracker() const { return mLatencyTracker; }
+
 private:
     static const size_t MAX_RECYCLED_SPRITES = 12;
     static const size_t MAX_SPOTS = 12;
@@ -146,6 +151,7 @@ private:
     sp<SpriteController> mSpriteController;
     sp<WeakMessageHandler> mHandler;
     sp<LooperCallback> mCallback;
+    sp<PointerLatencyTracker> mLatencyTracker;
 
     DisplayEventReceiver mDisplayEventReceiver;
 
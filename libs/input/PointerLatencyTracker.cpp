@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PointerLatencyTracker"
+
+#include "PointerLatencyTracker.h"
+
+#include <algorithm>
+#include <new>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <android-base/stringprintf.h>
+#include <cutils/ashmem.h>
+#include <log/log.h>
+
+namespace android {
+
+PointerLatencyTracker::PointerLatencyTracker()
+      : mAshmemFd(-1), mPage(nullptr), mIsMapped(false), mPendingMoveTime(0) {
+    int fd = ashmem_create_region("PointerLatency", sizeof(Page));
+    if (fd >= 0) {
+        void* addr = mmap(nullptr, sizeof(Page), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr != MAP_FAILED) {
+            mAshmemFd = fd;
+            mPage = new (addr) Page();
+            mIsMapped = true;
+        } else {
+            ALOGW("Failed to map pointer latency region, err %d %s", errno, strerror(errno));
+            close(fd);
+        }
+    } else {
+        ALOGW("Failed to create pointer latency region, err %d %s", errno, strerror(errno));
+    }
+    if (mPage == nullptr) {
+        // Keep aggregating locally so dump() still works without the fd.
+        mPage = new Page();
+    }
+    mPage->version = Page::VERSION;
+    mPage->statsStartTime = systemTime(SYSTEM_TIME_MONOTONIC);
+}
+
+PointerLatencyTracker::~PointerLatencyTracker() {
+    if (mIsMapped) {
+        mPage->~Page();
+        munmap(mPage, sizeof(Page));
+        close(mAshmemFd);
+    } else {
+        delete mPage;
+    }
+}
+
+void PointerLatencyTracker::noteMoveReceived(nsecs_t when) {
+    mPage->totalMoves.fetch_add(1, std::memory_order_relaxed);
+
+    // Only adopt the timestamp if no move is pending so that coalesced moves
+    // keep the receipt time of the oldest one.
+    nsecs_t expected = 0;
+    mPendingMoveTime.compare_exchange_strong(expected, when, std::memory_order_relaxed);
+}
+
+void PointerLatencyTracker::noteMovePresented(nsecs_t when) {
+    nsecs_t received = mPendingMoveTime.exchange(0, std::memory_order_relaxed);
+    if (received == 0 || when < received) {
+        return;
+    }
+
+    const int64_t latencyMs = ns2ms(when - received);
+    size_t index;
+    if (latencyMs < static_cast<int64_t>(Page::NUM_FINE_BUCKETS)) {
+        index = latencyMs;
+    } else {
+        const int64_t coarse = (latencyMs - Page::NUM_FINE_BUCKETS) / 10;
+        index = Page::NUM_FINE_BUCKETS +
+                std::min(static_cast<size_t>(coarse), Page::NUM_COARSE_BUCKETS - 1);
+    }
+    mPage->buckets[index].fetch_add(1, std::memory_order_relaxed);
+    mPage->recordedMoves.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t PointerLatencyTracker::latencyMsForBucketIndex(size_t index) {
+    if (index < Page::NUM_FINE_BUCKETS) {
+        return index;
+    }
+    return Page::NUM_FINE_BUCKETS + (index - Page::NUM_FINE_BUCKETS) * 10;
+}
+
+void PointerLatencyTracker::dump(std::string& out) const {
+    base::StringAppendF(&out, "Pointer latency: %u moves received, %u presented\n",
+            mPage->totalMoves.load(std::memory_order_relaxed),
+            mPage->recordedMoves.load(std::memory_order_relaxed));
+    out += "Histogram:";
+    for (size_t i = 0; i < Page::NUM_BUCKETS; i++) {
+        uint32_t count = mPage->buckets[i].load(std::memory_order_relaxed);
+        if (count != 0) {
+            base::StringAppendF(&out, " %ums=%u", latencyMsForBucketIndex(i), count);
+        }
+    }
+    out += "\n";
+}
+
+} // namespace android
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _UI_POINTER_LATENCY_TRACKER_H
+#define _UI_POINTER_LATENCY_TRACKER_H
+
+#include <atomic>
+#include <string>
+
+#include <utils/RefBase.h>
+#include <utils/Timers.h>
+
+namespace android {
+
+/*
+ * Aggregates the latency between receiving a pointer move and the sprite
+ * update that carries it being presented on screen.
+ *
+ * The histogram lives in an ashmem region (following the hwui ProfileData
+ * pattern) so test infrastructure can map the fd read-only and sample
+ * pointer-path latency from a production build without attaching to the
+ * process.
+ */
+class PointerLatencyTracker : public RefBase {
+public:
+    /* Layout of the shared-memory region.  All counters are plain 32-bit
+     * atomics so a concurrent reader sees torn-free values. */
+    struct Page {
+        static constexpr uint32_t VERSION = 1;
+
+        /* Buckets [0, NUM_FINE_BUCKETS) count latencies in 1ms increments.
+         * The following buckets count 10ms increments; the last bucket
+         * absorbs everything beyond the histogram range. */
+        static constexpr size_t NUM_FINE_BUCKETS = 32;
+        static constexpr size_t NUM_COARSE_BUCKETS = 16;
+        static constexpr size_t NUM_BUCKETS = NUM_FINE_BUCKETS + NUM_COARSE_BUCKETS;
+
+        uint32_t version;
+        std::atomic<uint32_t> totalMoves;
+        std::atomic<uint32_t> recordedMoves;
+        std::atomic<int64_t> statsStartTime;
+        std::atomic<uint32_t> buckets[NUM_BUCKETS];
+    };
+
+    PointerLatencyTracker();
+
+    /* Called when a pointer move is received from the input pipeline. */
+    void noteMoveReceived(nsecs_t when);
+
+    /* Called when the sprite transaction containing the move was presented. */
+    void noteMovePresented(nsecs_t when);
+
+    /* Returns the ashmem fd backing the histogram, or -1 if the region could
+     * not be created.  The tracker retains ownership of the fd. */
+    int getAshmemFd() const { return mAshmemFd; }
+
+    void dump(std::string& out) const;
+
+    /* Lower bound, in milliseconds, of the latency range bucket `index` counts. */
+    static uint32_t latencyMsForBucketIndex(size_t index);
+
+protected:
+    virtual ~PointerLatencyTracker();
+
+private:
+    int mAshmemFd;
+    Page* mPage;
+    bool mIsMapped;
+
+    /* Receipt time of the oldest move that has not been presented yet, or 0.
+     * Coalesced moves are attributed to the oldest one so the histogram
+     * reflects how long input waited, not how often it was batched. */
+    std::atomic<nsecs_t> mPendingMoveTime;
+};
+
+} // namespace android
+
+#endif // _UI_POINTER_LATENCY_TRACKER_H
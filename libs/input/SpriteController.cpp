@@ -19,8 +19,13 @@
 
 #include "SpriteController.h"
 
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include <log/log.h>
 #include <utils/String8.h>
+#include <utils/Timers.h>
 #include <gui/Surface.h>
 
 #include <android/graphics/bitmap.h>
@@ -72,6 +77,13 @@ void SpriteController::closeTransaction() {
     }
 }
 
+void SpriteController::setTransactionCompletedListener(
+        const std::function<void(nsecs_t timestamp)>& listener) {
+    AutoMutex _l(mLock);
+
+    mLocked.transactionCompletedListener = listener;
+}
+
 void SpriteController::invalidateSpriteLocked(const sp<SpriteImpl>& sprite) {
     bool wasEmpty = mLocked.invalidatedSprites.isEmpty();
     mLocked.invalidatedSprites.push(sprite);
@@ -142,9 +154,12 @@ void SpriteController::doUpdateSprites() {
         }
     }
 
-    // Resize and/or reparent sprites if needed.
+    // Resize and/or reparent sprites if needed.  Resizes must be applied before
+    // the affected surfaces are drawn, but everything else queued here can ride
+    // along with the single transaction applied at the end of the cycle.
     SurfaceComposerClient::Transaction t;
-    bool needApplyTransaction = false;
+    bool needEarlyApplyTransaction = false;
+    bool havePendingTransactionOps = false;
     for (size_t i = 0; i < numSprites; i++) {
         SpriteUpdate& update = updates.editItemAt(i);
         if (update.state.surfaceControl == nullptr) {
@@ -156,7 +171,7 @@ void SpriteController::doUpdateSprites() {
             int32_t desiredHeight = update.state.icon.bitmap.getInfo().height;
             if (update.state.surfaceWidth < desiredWidth
                     || update.state.surfaceHeight < desiredHeight) {
-                needApplyTransaction = true;
+                needEarlyApplyTransaction = true;
 
                 t.setSize(update.state.surfaceControl,
                         desiredWidth, desiredHeight);
@@ -175,14 +190,18 @@ void SpriteController::doUpdateSprites() {
         // If surface is a new one, we have to set right layer stack.
         if (update.surfaceChanged || update.state.dirty & DIRTY_DISPLAY_ID) {
             t.setLayerStack(update.state.surfaceControl, update.state.displayId);
-            needApplyTransaction = true;
+            havePendingTransactionOps = true;
         }
     }
-    if (needApplyTransaction) {
+    if (needEarlyApplyTransaction) {
         t.apply();
+        havePendingTransactionOps = false;
     }
 
-    // Redraw sprites if needed.
+    // Redraw sprites if needed.  Each sprite draws into its own surface, so when
+    // several sprites are dirty at once (multi-pointer spots) the rendering is
+    // fanned out to one worker thread per sprite.
+    std::vector<size_t> spritesToRender;
     for (size_t i = 0; i < numSprites; i++) {
         SpriteUpdate& update = updates.editItemAt(i);
 
@@ -193,42 +212,29 @@ void SpriteController::doUpdateSprites() {
 
         if (update.state.surfaceControl != NULL && !update.state.surfaceDrawn
                 && update.state.wantSurfaceVisible()) {
-            sp<Surface> surface = update.state.surfaceControl->getSurface();
-            ANativeWindow_Buffer outBuffer;
-            status_t status = surface->lock(&outBuffer, NULL);
-            if (status) {
-                ALOGE("Error %d locking sprite surface before drawing.", status);
-            } else {
-                graphics::Paint paint;
-                paint.setBlendMode(ABLEND_MODE_SRC);
-
-                graphics::Canvas canvas(outBuffer, (int32_t) surface->getBuffersDataSpace());
-                canvas.drawBitmap(update.state.icon.bitmap, 0, 0, &paint);
-
-                const int iconWidth = update.state.icon.bitmap.getInfo().width;
-                const int iconHeight = update.state.icon.bitmap.getInfo().height;
-
-                if (outBuffer.width > iconWidth) {
-                    paint.setBlendMode(ABLEND_MODE_CLEAR); // clear to transparent
-                    canvas.drawRect({iconWidth, 0, outBuffer.width, iconHeight}, paint);
-                }
-                if (outBuffer.height > iconHeight) {
-                    paint.setBlendMode(ABLEND_MODE_CLEAR); // clear to transparent
-                    canvas.drawRect({0, iconHeight, outBuffer.width, outBuffer.height}, paint);
-                }
-
-                status = surface->unlockAndPost();
-                if (status) {
-                    ALOGE("Error %d unlocking and posting sprite surface after drawing.", status);
-                } else {
-                    update.state.surfaceDrawn = true;
-                    update.surfaceChanged = surfaceChanged = true;
-                }
-            }
+            spritesToRender.push_back(i);
+        }
+    }
+    if (spritesToRender.size() == 1) {
+        renderSprite(updates.editItemAt(spritesToRender[0]));
+    } else if (!spritesToRender.empty()) {
+        std::vector<std::thread> workers;
+        workers.reserve(spritesToRender.size());
+        for (size_t index : spritesToRender) {
+            SpriteUpdate& update = updates.editItemAt(index);
+            workers.emplace_back([this, &update] { renderSprite(update); });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+    for (size_t index : spritesToRender) {
+        if (updates.itemAt(index).surfaceChanged) {
+            surfaceChanged = true;
         }
     }
 
-    needApplyTransaction = false;
+    bool needApplyTransaction = havePendingTransactionOps;
     for (size_t i = 0; i < numSprites; i++) {
         SpriteUpdate& update = updates.editItemAt(i);
 
@@ -305,6 +311,26 @@ void SpriteController::doUpdateSprites() {
     }
 
     if (needApplyTransaction) {
+        std::function<void(nsecs_t)> completedListener;
+        { // acquire lock
+            AutoMutex _l(mLock);
+            completedListener = mLocked.transactionCompletedListener;
+        } // release lock
+
+        if (completedListener != nullptr) {
+            // The context owns a copy of the listener until the callback fires.
+            auto* context = new std::function<void(nsecs_t)>(std::move(completedListener));
+            t.addTransactionCompletedCallback(
+                    [](void* context, nsecs_t latchTime, const sp<Fence>& /*presentFence*/,
+                            const std::vector<SurfaceControlStats>& /*stats*/) {
+                        std::unique_ptr<std::function<void(nsecs_t)>> listener(
+                                static_cast<std::function<void(nsecs_t)>*>(context));
+                        (*listener)(latchTime >= 0 ? latchTime
+                                                   : systemTime(SYSTEM_TIME_MONOTONIC));
+                    },
+                    context);
+        }
+
         status_t status = t.apply();
         if (status) {
             ALOGE("Error applying Surface transaction");
@@ -334,6 +360,42 @@ void SpriteController::doUpdateSprites() {
     updates.clear();
 }
 
+void SpriteController::renderSprite(SpriteUpdate& update) {
+    sp<Surface> surface = update.state.surfaceControl->getSurface();
+    ANativeWindow_Buffer outBuffer;
+    status_t status = surface->lock(&outBuffer, NULL);
+    if (status) {
+        ALOGE("Error %d locking sprite surface before drawing.", status);
+        return;
+    }
+
+    graphics::Paint paint;
+    paint.setBlendMode(ABLEND_MODE_SRC);
+
+    graphics::Canvas canvas(outBuffer, (int32_t) surface->getBuffersDataSpace());
+    canvas.drawBitmap(update.state.icon.bitmap, 0, 0, &paint);
+
+    const int iconWidth = update.state.icon.bitmap.getInfo().width;
+    const int iconHeight = update.state.icon.bitmap.getInfo().height;
+
+    if (outBuffer.width > iconWidth) {
+        paint.setBlendMode(ABLEND_MODE_CLEAR); // clear to transparent
+        canvas.drawRect({iconWidth, 0, outBuffer.width, iconHeight}, paint);
+    }
+    if (outBuffer.height > iconHeight) {
+        paint.setBlendMode(ABLEND_MODE_CLEAR); // clear to transparent
+        canvas.drawRect({0, iconHeight, outBuffer.width, outBuffer.height}, paint);
+    }
+
+    status = surface->unlockAndPost();
+    if (status) {
+        ALOGE("Error %d unlocking and posting sprite surface after drawing.", status);
+    } else {
+        update.state.surfaceDrawn = true;
+        update.surfaceChanged = true;
+    }
+}
+
 void SpriteController::doDisposeSurfaces() {
     // Collect disposed surfaces.
     Vector<sp<SurfaceControl> > disposedSurfaces;
@@ -349,6 +411,22 @@ void SpriteController::doDisposeSurfaces() {
     disposedSurfaces.clear();
 }
 
+graphics::Bitmap SpriteController::obtainIconBitmapLocked(const graphics::Bitmap& bitmap) {
+    auto it = mLocked.iconBitmapCache.find(bitmap.get());
+    if (it != mLocked.iconBitmapCache.end()) {
+        return it->second.copy;
+    }
+
+    graphics::Bitmap copy = bitmap.copy(ANDROID_BITMAP_FORMAT_RGBA_8888);
+    if (copy.isValid()) {
+        if (mLocked.iconBitmapCache.size() >= MAX_ICON_BITMAP_CACHE_SIZE) {
+            mLocked.iconBitmapCache.clear();
+        }
+        mLocked.iconBitmapCache.emplace(bitmap.get(), CachedIconBitmap{bitmap, copy});
+    }
+    return copy;
+}
+
 void SpriteController::ensureSurfaceComposerClient() {
     if (mSurfaceComposerClient == NULL) {
         mSurfaceComposerClient = new SurfaceComposerClient();
@@ -392,21 +470,27 @@ void SpriteController::SpriteImpl::setIcon(const SpriteIcon& icon) {
 
     uint32_t dirty;
     if (icon.isValid()) {
-        mLocked.state.icon.bitmap = icon.bitmap.copy(ANDROID_BITMAP_FORMAT_RGBA_8888);
-        if (!mLocked.state.icon.isValid()
+        graphics::Bitmap copy = mController->obtainIconBitmapLocked(icon.bitmap);
+        const bool sameBitmap = mLocked.state.icon.isValid()
+                && mLocked.state.icon.bitmap.get() == copy.get();
+        mLocked.state.icon.bitmap = copy;
+        dirty = sameBitmap ? 0 : DIRTY_BITMAP;
+        if (!sameBitmap
                 || mLocked.state.icon.hotSpotX != icon.hotSpotX
                 || mLocked.state.icon.hotSpotY != icon.hotSpotY) {
             mLocked.state.icon.hotSpotX = icon.hotSpotX;
             mLocked.state.icon.hotSpotY = icon.hotSpotY;
-            dirty = DIRTY_BITMAP | DIRTY_HOTSPOT;
-        } else {
-            dirty = DIRTY_BITMAP;
+            dirty |= DIRTY_HOTSPOT;
         }
 
         if (mLocked.state.icon.style != icon.style) {
             mLocked.state.icon.style = icon.style;
             dirty |= DIRTY_ICON_STYLE;
         }
+
+        if (dirty == 0) {
+            return; // the sprite is already showing this exact icon
+        }
     } else if (mLocked.state.icon.isValid()) {
         mLocked.state.icon.bitmap.reset();
         dirty = DIRTY_BITMAP | DIRTY_HOTSPOT | DIRTY_ICON_STYLE;
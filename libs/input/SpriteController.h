@@ -17,6 +17,9 @@
 #ifndef _UI_SPRITES_H
 #define _UI_SPRITES_H
 
+#include <functional>
+#include <unordered_map>
+
 #include <utils/RefBase.h>
 #include <utils/Looper.h>
 
@@ -155,6 +158,11 @@ public:
     virtual void openTransaction();
     virtual void closeTransaction();
 
+    /* Sets a listener that is invoked, on an arbitrary thread, with the presentation
+     * timestamp each time a sprite update transaction has been shown on screen.
+     * Pass nullptr to remove the listener. */
+    void setTransactionCompletedListener(const std::function<void(nsecs_t timestamp)>& listener);
+
 private:
     enum {
         MSG_UPDATE_SPRITES,
@@ -268,6 +276,18 @@ private:
         bool surfaceChanged;
     };
 
+    /* Caches the RGBA copy made of an icon bitmap, keyed by the bitmap the client
+     * passed to setIcon().  Icons are immutable once handed to a sprite, so setting
+     * the same bitmap on several sprites (or repeatedly, as cursor animations and
+     * multi-pointer spots do) reuses one shared copy instead of re-copying the
+     * pixels for every call.  The source reference keeps the key bitmap alive. */
+    struct CachedIconBitmap {
+        graphics::Bitmap source;
+        graphics::Bitmap copy;
+    };
+
+    static constexpr size_t MAX_ICON_BITMAP_CACHE_SIZE = 16;
+
     mutable Mutex mLock;
 
     sp<Looper> mLooper;
@@ -279,16 +299,20 @@ private:
     struct Locked {
         Vector<sp<SpriteImpl> > invalidatedSprites;
         Vector<sp<SurfaceControl> > disposedSurfaces;
+        std::unordered_map<ABitmap*, CachedIconBitmap> iconBitmapCache;
+        std::function<void(nsecs_t timestamp)> transactionCompletedListener;
         uint32_t transactionNestingCount;
         bool deferredSpriteUpdate;
     } mLocked; // guarded by mLock
 
     void invalidateSpriteLocked(const sp<SpriteImpl>& sprite);
     void disposeSurfaceLocked(const sp<SurfaceControl>& surfaceControl);
+    graphics::Bitmap obtainIconBitmapLocked(const graphics::Bitmap& bitmap);
 
     void handleMessage(const Message& message);
     void doUpdateSprites();
     void doDisposeSurfaces();
+    void renderSprite(SpriteUpdate& update);
 
     void ensureSurfaceComposerClient();
     sp<SurfaceControl> obtainSurface(int32_t width, int32_t height);
@@ -23,6 +23,7 @@
 #include <utils/RefBase.h>
 
 #include <stdint.h>
+#include <sys/uio.h>
 #include <vector>
 
 namespace android {
@@ -96,6 +97,15 @@ public:
      */
     size_t currentToWrite();
 
+    /**
+     * Fills iov with up to iovCount writeable regions starting at the write pointer,
+     * allocating new buffers as needed, so data can be read into the buffer with a
+     * single readv() call. Returns the number of regions filled, which is less than
+     * iovCount only if allocation fails. The write pointer is not moved; call
+     * wp()->move() with the number of bytes actually written.
+     */
+    size_t writeBuffers(struct iovec* iov, size_t iovCount);
+
     /**
      * Write a single byte to the buffer.
      */
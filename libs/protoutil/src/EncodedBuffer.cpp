@@ -156,6 +156,29 @@ EncodedBuffer::currentToWrite()
     return mChunkSize - mWp.offset();
 }
 
+size_t
+EncodedBuffer::writeBuffers(struct iovec* iov, size_t iovCount)
+{
+    size_t filled = 0;
+    Pointer p = mWp.copy();
+    while (filled < iovCount) {
+        if (p.index() > mBuffers.size()) break;
+        if (p.index() == mBuffers.size()) {
+            uint8_t* buf = (uint8_t*)mmap(NULL, mChunkSize, PROT_READ | PROT_WRITE,
+                    MAP_ANONYMOUS|MAP_PRIVATE, -1, 0);
+
+            if (buf == NULL) break; // This indicates NO_MEMORY
+
+            mBuffers.push_back(buf);
+        }
+        iov[filled].iov_base = at(p);
+        iov[filled].iov_len = mChunkSize - p.offset();
+        p.move(iov[filled].iov_len);
+        filled++;
+    }
+    return filled;
+}
+
 void
 EncodedBuffer::writeRawByte(uint8_t val)
 {
@@ -22,6 +22,11 @@
 #include <android/util/protobuf.h>
 #include <android/util/ProtoOutputStream.h>
 #include <cutils/log.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Number of buffer chunks gathered into a single writev() call when flushing.
+#define FLUSH_IOV_COUNT 16
 
 namespace android {
 namespace util {
@@ -464,18 +469,49 @@ ProtoOutputStream::size()
     return mBuffer->size();
 }
 
+/**
+ * Write the gathered regions to fd, continuing after partial writes.
+ */
+static bool
+writevFully(int fd, struct iovec* iov, int iovCount)
+{
+    while (iovCount > 0) {
+        ssize_t amt = TEMP_FAILURE_RETRY(writev(fd, iov, iovCount));
+        if (amt < 0) return false;
+        while (iovCount > 0 && (size_t)amt >= iov->iov_len) {
+            amt -= iov->iov_len;
+            iov++;
+            iovCount--;
+        }
+        if (iovCount > 0) {
+            iov->iov_base = (uint8_t*)iov->iov_base + amt;
+            iov->iov_len -= amt;
+        }
+    }
+    return true;
+}
+
 bool
 ProtoOutputStream::flush(int fd)
 {
     if (fd < 0) return false;
     if (!compact()) return false;
 
+    // Gather the buffer's chunks so large protos don't pay one write
+    // syscall per chunk.
     sp<ProtoReader> reader = mBuffer->read();
     while (reader->readBuffer() != NULL) {
-        if (!android::base::WriteFully(fd, reader->readBuffer(), reader->currentToRead())) {
+        struct iovec iov[FLUSH_IOV_COUNT];
+        int iovCount = 0;
+        while (iovCount < FLUSH_IOV_COUNT && reader->readBuffer() != NULL) {
+            iov[iovCount].iov_base = const_cast<uint8_t*>(reader->readBuffer());
+            iov[iovCount].iov_len = reader->currentToRead();
+            reader->move(iov[iovCount].iov_len);
+            iovCount++;
+        }
+        if (!writevFully(fd, iov, iovCount)) {
             return false;
         }
-        reader->move(reader->currentToRead());
     }
     return true;
 }
@@ -101,6 +101,33 @@ TEST(EncodedBufferTest, WriteVarint) {
     expectPointer(buffer->ep(), expected_buffer_size);
 }
 
+TEST(EncodedBufferTest, WriteBuffers) {
+    sp<EncodedBuffer> buffer = new EncodedBuffer(TEST_CHUNK_SIZE);
+    buffer->writeRawByte(1);
+
+    struct iovec iov[3];
+    EXPECT_EQ(buffer->writeBuffers(iov, 3), 3UL);
+    EXPECT_EQ(iov[0].iov_len, buffer->currentToWrite());
+
+    // Fill the regions in stream order and commit them with a single move.
+    size_t total = 0;
+    for (size_t i = 0; i < 3; i++) {
+        uint8_t* data = static_cast<uint8_t*>(iov[i].iov_base);
+        for (size_t j = 0; j < iov[i].iov_len; j++) {
+            data[j] = (total++) & 0x7F;
+        }
+    }
+    buffer->wp()->move(total);
+    EXPECT_EQ(buffer->size(), total + 1);
+
+    sp<ProtoReader> reader = buffer->read();
+    EXPECT_EQ(reader->next(), 1);
+    for (size_t i = 0; i < total; i++) {
+        EXPECT_EQ(reader->next(), i & 0x7F);
+    }
+    EXPECT_FALSE(reader->hasNext());
+}
+
 TEST(EncodedBufferTest, Edit) {
     sp<EncodedBuffer> buffer = new EncodedBuffer(TEST_CHUNK_SIZE);
     buffer->writeRawFixed64(0xdeadbeefdeadbeef);
@@ -502,15 +502,12 @@ static void ImageReader_imageRelease(JNIEnv* env, jobject thiz, jobject image)
     ALOGV("%s: Image (format: 0x%x) has been released", __FUNCTION__, ctx->getBufferFormat());
 }
 
-static jint ImageReader_imageSetup(JNIEnv* env, jobject thiz, jobject image) {
-    ALOGV("%s:", __FUNCTION__);
-    JNIImageReaderContext* ctx = ImageReader_getContext(env, thiz);
-    if (ctx == NULL) {
-        jniThrowException(env, "java/lang/IllegalStateException",
-                "ImageReader is not initialized or was already closed");
-        return -1;
-    }
-
+// Acquires the next buffer item and runs the non-opaque format sanity checks
+// shared by the single and batched setup paths. On success *outBuffer holds
+// the acquired item; on failure an ACQUIRE_* code (or -1 with a pending
+// exception) is returned and any checked-out item is back in the pool.
+static jint ImageReader_acquireBufferItem(JNIEnv* env, JNIImageReaderContext* ctx,
+        BufferItem** outBuffer) {
     BufferItemConsumer* bufferConsumer = ctx->getBufferConsumer();
     BufferItem* buffer = ctx->getBufferItem();
     if (buffer == NULL) {
@@ -598,6 +595,25 @@ static jint ImageReader_imageSetup(JNIEnv* env, jobject thiz, jobject image) {
 
     }
 
+    *outBuffer = buffer;
+    return ACQUIRE_SUCCESS;
+}
+
+static jint ImageReader_imageSetup(JNIEnv* env, jobject thiz, jobject image) {
+    ALOGV("%s:", __FUNCTION__);
+    JNIImageReaderContext* ctx = ImageReader_getContext(env, thiz);
+    if (ctx == NULL) {
+        jniThrowException(env, "java/lang/IllegalStateException",
+                "ImageReader is not initialized or was already closed");
+        return -1;
+    }
+
+    BufferItem* buffer = NULL;
+    jint res = ImageReader_acquireBufferItem(env, ctx, &buffer);
+    if (res != ACQUIRE_SUCCESS) {
+        return res;
+    }
+
     // Set SurfaceImage instance member variables
     Image_setBufferItem(env, image, buffer);
     env->SetLongField(image, gSurfaceImageClassInfo.mTimestamp,
@@ -614,6 +630,87 @@ static jint ImageReader_imageSetup(JNIEnv* env, jobject thiz, jobject image) {
     return ACQUIRE_SUCCESS;
 }
 
+// Fixed-size per-image record written into the batched setup descriptor
+// table, in native byte order. Must match the managed reader of the table.
+struct ImageBatchDescriptor {
+    jlong timestamp;
+    jlong frameNumber;
+    jint transform;
+    jint scalingMode;
+    jint width;
+    jint height;
+};
+
+// Acquires up to images.length available images in one JNI transition. For
+// each acquired image the native buffer is attached to the next element of
+// images and one ImageBatchDescriptor is written into the direct ByteBuffer
+// table, so the managed layer populates its fields without per-field JNI
+// accesses. Buffers are not locked or mapped here; plane mapping stays
+// deferred until the image's planes are first requested, after the producer
+// fence has signaled. Returns the number of images acquired, or -1 with a
+// pending exception.
+static jint ImageReader_imageSetupBatch(JNIEnv* env, jobject thiz, jobjectArray images,
+        jobject descriptorTable) {
+    ALOGV("%s:", __FUNCTION__);
+    JNIImageReaderContext* ctx = ImageReader_getContext(env, thiz);
+    if (ctx == NULL) {
+        jniThrowException(env, "java/lang/IllegalStateException",
+                "ImageReader is not initialized or was already closed");
+        return -1;
+    }
+
+    void* tableBase = env->GetDirectBufferAddress(descriptorTable);
+    jlong tableCapacity = env->GetDirectBufferCapacity(descriptorTable);
+    if (tableBase == NULL || tableCapacity < 0) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                "descriptor table must be a direct ByteBuffer");
+        return -1;
+    }
+
+    jsize maxImages = env->GetArrayLength(images);
+    jlong maxRecords = tableCapacity / static_cast<jlong>(sizeof(ImageBatchDescriptor));
+    if (maxRecords < maxImages) {
+        maxImages = static_cast<jsize>(maxRecords);
+    }
+    ImageBatchDescriptor* records = static_cast<ImageBatchDescriptor*>(tableBase);
+
+    jint count = 0;
+    while (count < maxImages) {
+        BufferItem* buffer = NULL;
+        jint res = ImageReader_acquireBufferItem(env, ctx, &buffer);
+        if (res != ACQUIRE_SUCCESS) {
+            if (env->ExceptionCheck()) {
+                return -1;
+            }
+            break; // out of buffers or at the acquired-image limit
+        }
+
+        jobject image = env->GetObjectArrayElement(images, count);
+        if (image == NULL) {
+            ctx->getBufferConsumer()->releaseBuffer(*buffer);
+            ctx->returnBufferItem(buffer);
+            break;
+        }
+        Image_setBufferItem(env, image, buffer);
+        env->DeleteLocalRef(image);
+
+        ImageBatchDescriptor& record = records[count];
+        record.timestamp = buffer->mTimestamp;
+        record.frameNumber = buffer->mFrameNumber;
+        auto transform = buffer->mTransform;
+        if (buffer->mTransformToDisplayInverse) {
+            transform |= NATIVE_WINDOW_TRANSFORM_INVERSE_DISPLAY;
+        }
+        record.transform = static_cast<jint>(transform);
+        record.scalingMode = static_cast<jint>(buffer->mScalingMode);
+        record.width = getBufferWidth(buffer);
+        record.height = getBufferHeight(buffer);
+        count++;
+    }
+
+    return count;
+}
+
 static jint ImageReader_detachImage(JNIEnv* env, jobject thiz, jobject image) {
     ALOGV("%s:", __FUNCTION__);
     JNIImageReaderContext* ctx = ImageReader_getContext(env, thiz);
@@ -833,6 +930,8 @@ static const JNINativeMethod gImageReaderMethods[] = {
     {"nativeClose",            "()V",                        (void*)ImageReader_close },
     {"nativeReleaseImage",     "(Landroid/media/Image;)V",   (void*)ImageReader_imageRelease },
     {"nativeImageSetup",       "(Landroid/media/Image;)I",   (void*)ImageReader_imageSetup },
+    {"nativeImageSetupBatch",  "([Landroid/media/Image;Ljava/nio/ByteBuffer;)I",
+                                                             (void*)ImageReader_imageSetupBatch },
     {"nativeGetSurface",       "()Landroid/view/Surface;",   (void*)ImageReader_getSurface },
     {"nativeDetachImage",      "(Landroid/media/Image;)I",   (void*)ImageReader_detachImage },
     {"nativeDiscardFreeBuffers", "()V",                      (void*)ImageReader_discardFreeBuffers }
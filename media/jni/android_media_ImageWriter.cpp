@@ -33,6 +33,7 @@
 #include <private/android/AHardwareBufferHelpers.h>
 #include <jni.h>
 #include <nativehelper/JNIHelp.h>
+#include <nativehelper/ScopedPrimitiveArray.h>
 
 #include <stdint.h>
 #include <inttypes.h>
@@ -779,6 +780,122 @@ static jint ImageWriter_attachAndQueueImage(JNIEnv* env, jobject thiz, jlong nat
     return res;
 }
 
+// Batch version of attachAndQueueImage: attaches and queues a whole array of
+// (buffer, timestamp, fence) tuples in one JNI call, paying the sticky window
+// state (crop, transform, scaling mode) once per batch instead of once per
+// image. Each fence is handed to queueBuffer unwaited, as in the single-image
+// path; the consumer resolves it. Returns the number of images queued, and
+// throws describing the first failure, so the caller knows which tuples were
+// consumed.
+static jint ImageWriter_attachAndQueueImages(JNIEnv* env, jobject thiz, jlong nativeCtx,
+        jlongArray nativeBuffers, jint imageFormat, jlongArray timestamps, jintArray fences,
+        jint left, jint top, jint right, jint bottom, jint transform, jint scalingMode) {
+    ALOGV("%s", __FUNCTION__);
+    JNIImageWriterContext* const ctx = reinterpret_cast<JNIImageWriterContext *>(nativeCtx);
+    if (ctx == NULL || thiz == NULL) {
+        jniThrowException(env, "java/lang/IllegalStateException",
+                "ImageWriterContext is not initialized");
+        return 0;
+    }
+
+    if (isFormatOpaque(imageFormat) != isFormatOpaque(ctx->getBufferFormat())) {
+        jniThrowException(env, "java/lang/IllegalStateException",
+                "Trying to attach an opaque image into a non-opaque ImageWriter, or vice versa");
+        return 0;
+    }
+
+    ScopedLongArrayRO buffers(env, nativeBuffers);
+    ScopedLongArrayRO timestampsNs(env, timestamps);
+    ScopedIntArrayRO fenceFds(env, fences);
+    if (buffers.get() == NULL || timestampsNs.get() == NULL || fenceFds.get() == NULL) {
+        return 0;
+    }
+    const size_t count = buffers.size();
+    if (timestampsNs.size() != count || fenceFds.size() != count) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                "buffers, timestamps and fences must be the same length");
+        return 0;
+    }
+
+    sp<Surface> surface = ctx->getProducer();
+    sp<ANativeWindow> anw = surface;
+    status_t res = OK;
+
+    // Crop, transform and scaling mode are sticky window state shared by the
+    // whole batch; only the timestamp changes per image.
+    android_native_rect_t cropRect;
+    cropRect.left = left;
+    cropRect.top = top;
+    cropRect.right = right;
+    cropRect.bottom = bottom;
+    res = native_window_set_crop(anw.get(), &cropRect);
+    if (res != OK) {
+        jniThrowRuntimeException(env, "Set crop rect failed");
+        return 0;
+    }
+    res = native_window_set_buffers_transform(anw.get(), transform);
+    if (res != OK) {
+        jniThrowRuntimeException(env, "Set transform failed");
+        return 0;
+    }
+    res = native_window_set_scaling_mode(anw.get(), scalingMode);
+    if (res != OK) {
+        jniThrowRuntimeException(env, "Set scaling mode failed");
+        return 0;
+    }
+
+    size_t queued = 0;
+    for (; queued < count; queued++) {
+        // Images are guaranteed to be from ImageReader at this point, so it is
+        // safe to cast to BufferItem pointers.
+        BufferItem* buffer = reinterpret_cast<BufferItem*>(buffers[queued]);
+        if (buffer == NULL) {
+            jniThrowException(env, "java/lang/IllegalStateException",
+                    "Image is not initialized or already closed");
+            return queued;
+        }
+
+        res = surface->attachBuffer(buffer->mGraphicBuffer.get());
+        if (res != OK) {
+            ALOGE("%s: Attach image %zu failed: %s (%d)",
+                    __FUNCTION__, queued, strerror(-res), res);
+            if (res == NO_INIT) {
+                jniThrowException(env, "java/lang/IllegalStateException",
+                        "Surface has been abandoned");
+            } else {
+                jniThrowRuntimeException(env, "nativeAttachImage failed!!!");
+            }
+            return queued;
+        }
+
+        res = native_window_set_buffers_timestamp(anw.get(), timestampsNs[queued]);
+        if (res != OK) {
+            jniThrowRuntimeException(env, "Set timestamp failed");
+            return queued;
+        }
+
+        // Because onBufferReleased may be called before queueBuffer() returns,
+        // queue the "attached" flag before calling queueBuffer. In case
+        // queueBuffer() fails, remove it from the queue.
+        ctx->queueAttachedFlag(true);
+        res = anw->queueBuffer(anw.get(), buffer->mGraphicBuffer.get(), fenceFds[queued]);
+        if (res != OK) {
+            ALOGE("%s: Queue buffer %zu failed: %s (%d)",
+                    __FUNCTION__, queued, strerror(-res), res);
+            ctx->dequeueAttachedFlag();
+            if (res == NO_INIT) {
+                jniThrowException(env, "java/lang/IllegalStateException",
+                        "Surface has been abandoned");
+            } else {
+                jniThrowRuntimeException(env, "Queue input buffer failed");
+            }
+            return queued;
+        }
+    }
+
+    return queued;
+}
+
 // --------------------------Image methods---------------------------------------
 
 static void Image_getNativeContext(JNIEnv* env, jobject thiz,
@@ -1011,6 +1128,7 @@ static JNINativeMethod gImageWriterMethods[] = {
                                                               (void*)ImageWriter_init },
     {"nativeClose",              "(J)V",                      (void*)ImageWriter_close },
     {"nativeAttachAndQueueImage", "(JJIJIIIIII)I",          (void*)ImageWriter_attachAndQueueImage },
+    {"nativeAttachAndQueueImages", "(J[JI[J[IIIIIII)I",     (void*)ImageWriter_attachAndQueueImages },
     {"nativeDequeueInputImage", "(JLandroid/media/Image;)V",  (void*)ImageWriter_dequeueImage },
     {"nativeQueueInputImage",   "(JLandroid/media/Image;JIIIIII)V",  (void*)ImageWriter_queueImage },
     {"cancelImage",             "(JLandroid/media/Image;)V",   (void*)ImageWriter_cancelImage },
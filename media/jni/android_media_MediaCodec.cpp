@@ -413,12 +413,19 @@ status_t JMediaCodec::dequeueInputBuffer(size_t *index, int64_t timeoutUs) {
     return mCodec->dequeueInputBuffer(index, timeoutUs);
 }
 
+status_t JMediaCodec::dequeueOutputBuffer(
+        size_t *index, size_t *offset, size_t *size, int64_t *presentationTimeUs,
+        uint32_t *flags, int64_t timeoutUs) {
+    return mCodec->dequeueOutputBuffer(
+            index, offset, size, presentationTimeUs, flags, timeoutUs);
+}
+
 status_t JMediaCodec::dequeueOutputBuffer(
         JNIEnv *env, jobject bufferInfo, size_t *index, int64_t timeoutUs) {
     size_t size, offset;
     int64_t timeUs;
     uint32_t flags;
-    status_t err = mCodec->dequeueOutputBuffer(
+    status_t err = dequeueOutputBuffer(
             index, &offset, &size, &timeUs, &flags, timeoutUs);
 
     if (err != OK) {
@@ -2320,6 +2327,114 @@ static jint android_media_MediaCodec_dequeueOutputBuffer(
     return throwExceptionAsNecessary(env, err);
 }
 
+// One input command in the batched io command table. The layout is shared
+// with the managed command ring writer; fields are in native byte order and
+// the record is 8-byte aligned. status is written back per command.
+struct MediaCodecInputCommand {
+    jint index;
+    jint offset;
+    jint size;
+    jint flags;
+    jlong timestampUs;
+    jint status;
+    jint reserved;
+};
+
+// One drained output buffer in the batched io result table. For an info code
+// ending the drain (format or buffers changed), index holds the
+// DEQUEUE_INFO_* value and the remaining fields are zero.
+struct MediaCodecOutputRecord {
+    jint index;
+    jint offset;
+    jint size;
+    jint flags;
+    jlong timestampUs;
+};
+
+// Queues up to inputCount pending input buffers from the command table, then
+// drains every ready output buffer without waiting into the output table, all
+// in one JNI transition. Input commands are processed in order and each gets
+// its status written back; queueing stops at the first failure. Output
+// draining stops when no buffer is ready, when the output table is full, or
+// at a format/buffers-changed info code, which is stored in that record's
+// index field. Returns the number of output records written, or -1 with a
+// pending exception.
+static jint android_media_MediaCodec_native_batchedIo(
+        JNIEnv *env, jobject thiz, jobject inputTable, jint inputCount, jobject outputTable) {
+    ALOGV("android_media_MediaCodec_native_batchedIo");
+
+    sp<JMediaCodec> codec = getMediaCodec(env, thiz);
+
+    if (codec == NULL || codec->initCheck() != OK) {
+        throwExceptionAsNecessary(env, INVALID_OPERATION);
+        return -1;
+    }
+
+    MediaCodecInputCommand *commands = NULL;
+    if (inputCount > 0) {
+        commands = static_cast<MediaCodecInputCommand *>(
+                env->GetDirectBufferAddress(inputTable));
+        jlong inputCapacity = env->GetDirectBufferCapacity(inputTable);
+        if (commands == NULL
+                || inputCapacity / (jlong)sizeof(MediaCodecInputCommand) < inputCount) {
+            throwExceptionAsNecessary(env, BAD_VALUE, ACTION_CODE_FATAL,
+                    "input command table must be a direct ByteBuffer with inputCount records");
+            return -1;
+        }
+    }
+    MediaCodecOutputRecord *records = static_cast<MediaCodecOutputRecord *>(
+            env->GetDirectBufferAddress(outputTable));
+    jlong outputCapacity = env->GetDirectBufferCapacity(outputTable);
+    if (records == NULL || outputCapacity < 0) {
+        throwExceptionAsNecessary(env, BAD_VALUE, ACTION_CODE_FATAL,
+                "output record table must be a direct ByteBuffer");
+        return -1;
+    }
+    jlong maxRecords = outputCapacity / (jlong)sizeof(MediaCodecOutputRecord);
+
+    for (jint i = 0; i < inputCount; i++) {
+        MediaCodecInputCommand &cmd = commands[i];
+        AString errorDetailMsg;
+        status_t err = codec->queueInputBuffer(
+                cmd.index, cmd.offset, cmd.size, cmd.timestampUs, cmd.flags, &errorDetailMsg);
+        cmd.status = err;
+        if (err != OK) {
+            break;
+        }
+    }
+
+    jint count = 0;
+    while (count < maxRecords) {
+        size_t index, offset, size;
+        int64_t timeUs;
+        uint32_t flags;
+        status_t err = codec->dequeueOutputBuffer(
+                &index, &offset, &size, &timeUs, &flags, 0 /* timeoutUs */);
+        MediaCodecOutputRecord &record = records[count];
+        if (err == OK) {
+            record.index = (jint)index;
+            record.offset = (jint)offset;
+            record.size = (jint)size;
+            record.flags = (jint)flags;
+            record.timestampUs = timeUs;
+            count++;
+        } else if (err == -EAGAIN) {
+            break;
+        } else if (err == INFO_FORMAT_CHANGED || err == INFO_OUTPUT_BUFFERS_CHANGED) {
+            record = MediaCodecOutputRecord{};
+            record.index = (err == INFO_FORMAT_CHANGED)
+                    ? DEQUEUE_INFO_OUTPUT_FORMAT_CHANGED : DEQUEUE_INFO_OUTPUT_BUFFERS_CHANGED;
+            count++;
+            break;
+        } else {
+            throwExceptionAsNecessary(env, err);
+            return -1;
+        }
+    }
+
+    return count;
+}
+
 static void android_media_MediaCodec_releaseOutputBuffer(
         JNIEnv *env, jobject thiz,
         jint index, jboolean render, jboolean updatePTS, jlong timestampNs) {
@@ -3178,6 +3293,9 @@ static const JNINativeMethod gMethods[] = {
     { "native_dequeueOutputBuffer", "(Landroid/media/MediaCodec$BufferInfo;J)I",
       (void *)android_media_MediaCodec_dequeueOutputBuffer },
 
+    { "native_batchedIo", "(Ljava/nio/ByteBuffer;ILjava/nio/ByteBuffer;)I",
+      (void *)android_media_MediaCodec_native_batchedIo },
+
     { "releaseOutputBuffer", "(IZZJ)V",
       (void *)android_media_MediaCodec_releaseOutputBuffer },
 
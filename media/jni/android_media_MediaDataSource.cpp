@@ -32,7 +32,8 @@
 namespace android {
 
 JMediaDataSource::JMediaDataSource(JNIEnv* env, jobject source)
-    : mJavaObjStatus(OK), mSizeIsCached(false), mCachedSize(0), mMemory(NULL) {
+    : mJavaObjStatus(OK), mSizeIsCached(false), mCachedSize(0), mMemory(NULL),
+      mReadDirectMethod(NULL), mByteBufferObj(NULL), mBytesRead(0), mReadCount(0) {
     mMediaDataSourceObj = env->NewGlobalRef(source);
     CHECK(mMediaDataSourceObj != NULL);
 
@@ -46,6 +47,14 @@ JMediaDataSource::JMediaDataSource(JNIEnv* env, jobject source)
     mCloseMethod = env->GetMethodID(mediaDataSourceClass.get(), "close", "()V");
     CHECK(mCloseMethod != NULL);
 
+    // The direct-buffer overload is optional; sources without it fall back to
+    // the byte[] contract.
+    mReadDirectMethod = env->GetMethodID(mediaDataSourceClass.get(), "readAt",
+            "(JLjava/nio/ByteBuffer;I)I");
+    if (mReadDirectMethod == NULL) {
+        env->ExceptionClear();
+    }
+
     ScopedLocalRef<jbyteArray> tmp(env, env->NewByteArray(kBufferSize));
     mByteArrayObj = (jbyteArray)env->NewGlobalRef(tmp.get());
     CHECK(mByteArrayObj != NULL);
@@ -54,6 +63,14 @@ JMediaDataSource::JMediaDataSource(JNIEnv* env, jobject source)
     mMemory = memoryDealer->allocate(kBufferSize);
     if (mMemory == NULL) {
         ALOGE("Failed to allocate memory!");
+    } else if (mReadDirectMethod != NULL) {
+        ScopedLocalRef<jobject> buffer(env,
+                env->NewDirectByteBuffer(mMemory->unsecurePointer(), kBufferSize));
+        if (buffer.get() != NULL) {
+            mByteBufferObj = env->NewGlobalRef(buffer.get());
+        } else if (env->ExceptionCheck()) {
+            env->ExceptionClear();
+        }
     }
 }
 
@@ -61,6 +78,9 @@ JMediaDataSource::~JMediaDataSource() {
     JNIEnv* env = AndroidRuntime::getJNIEnv();
     env->DeleteGlobalRef(mMediaDataSourceObj);
     env->DeleteGlobalRef(mByteArrayObj);
+    if (mByteBufferObj != NULL) {
+        env->DeleteGlobalRef(mByteBufferObj);
+    }
 }
 
 sp<IMemory> JMediaDataSource::getIMemory() {
@@ -79,8 +99,16 @@ ssize_t JMediaDataSource::readAt(off64_t offset, size_t size) {
     }
 
     JNIEnv* env = AndroidRuntime::getJNIEnv();
-    jint numread = env->CallIntMethod(mMediaDataSourceObj, mReadMethod,
-            (jlong)offset, mByteArrayObj, (jint)0, (jint)size);
+    jint numread;
+    if (mByteBufferObj != NULL) {
+        // The source writes directly into the shared memory region; no copy
+        // back out of the VM is needed afterwards.
+        numread = env->CallIntMethod(mMediaDataSourceObj, mReadDirectMethod,
+                (jlong)offset, mByteBufferObj, (jint)size);
+    } else {
+        numread = env->CallIntMethod(mMediaDataSourceObj, mReadMethod,
+                (jlong)offset, mByteArrayObj, (jint)0, (jint)size);
+    }
     if (env->ExceptionCheck()) {
         ALOGW("An exception occurred in readAt()");
         LOGW_EX(env);
@@ -105,8 +133,12 @@ ssize_t JMediaDataSource::readAt(off64_t offset, size_t size) {
     }
 
     ALOGV("readAt %lld / %zu => %d.", (long long)offset, size, numread);
-    env->GetByteArrayRegion(mByteArrayObj, 0, numread,
-        (jbyte*)mMemory->unsecurePointer());
+    if (mByteBufferObj == NULL) {
+        env->GetByteArrayRegion(mByteArrayObj, 0, numread,
+            (jbyte*)mMemory->unsecurePointer());
+    }
+    mBytesRead += numread;
+    ++mReadCount;
     return numread;
 }
 
@@ -157,7 +189,10 @@ uint32_t JMediaDataSource::getFlags() {
 }
 
 String8 JMediaDataSource::toString() {
-    return String8::format("JMediaDataSource(pid %d, uid %d)", getpid(), getuid());
+    Mutex::Autolock lock(mLock);
+    return String8::format("JMediaDataSource(pid %d, uid %d, %s, %u reads, %llu bytes)",
+            getpid(), getuid(), mByteBufferObj != NULL ? "direct" : "byte[]",
+            mReadCount, (unsigned long long)mBytesRead);
 }
 
 }  // namespace android
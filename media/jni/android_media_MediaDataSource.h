@@ -32,6 +32,11 @@ namespace android {
 // If the java DataSource returns an error or throws an exception it
 // will be considered to be in a broken state, and the only further call this
 // will make is to close().
+//
+// Sources that implement the optional readAt(long, ByteBuffer, int) overload
+// are handed a direct ByteBuffer wrapping the shared IMemory region, so their
+// data lands in the binder transport buffer without the intermediate byte[]
+// copy. The overload must write starting at position 0.
 class JMediaDataSource : public BnDataSource {
 public:
     enum {
@@ -67,6 +72,15 @@ private:
     jmethodID mCloseMethod;
     jbyteArray mByteArrayObj;
 
+    // Direct ByteBuffer over mMemory for sources implementing the zero-copy
+    // readAt overload; NULL when the source only has the byte[] variant.
+    jmethodID mReadDirectMethod;
+    jobject mByteBufferObj;
+
+    // Per-source throughput counters, reported by toString() in dumps.
+    uint64_t mBytesRead;
+    uint32_t mReadCount;
+
     DISALLOW_EVIL_CONSTRUCTORS(JMediaDataSource);
 };
 
@@ -26,6 +26,7 @@
 #include "android_os_Parcel.h"
 #include "jni.h"
 #include <nativehelper/JNIHelp.h>
+#include <nativehelper/ScopedLocalRef.h>
 
 #include <android/hardware/drm/1.3/IDrmFactory.h>
 #include <binder/Parcel.h>
@@ -439,6 +440,10 @@ static sp<IDrm> GetDrm(JNIEnv *env, jobject thiz) {
     return jdrm ? jdrm->getDrm() : NULL;
 }
 
+static sp<JDrm> GetJDrm(JNIEnv *env, jobject thiz) {
+    return (JDrm *)env->GetLongField(thiz, gFields.context);
+}
+
 JDrm::JDrm(
         JNIEnv *env, jobject thiz, const uint8_t uuid[16],
         const String8 &appPackageName) {
@@ -547,7 +552,52 @@ void JDrm::sendSessionLostState(
     notify(DrmPlugin::kDrmPluginEventSessionLostState, 0, &args);
 }
 
+status_t JDrm::prewarmSessions(DrmPlugin::SecurityLevel level, size_t count) {
+    if (mDrm == NULL) {
+        return NO_INIT;
+    }
+    for (size_t i = 0; i < count; i++) {
+        Vector<uint8_t> sessionId;
+        status_t err = mDrm->openSession(level, sessionId);
+        if (err != OK) {
+            // Sessions opened so far stay in the pool.
+            return err;
+        }
+        Mutex::Autolock lock(mWarmSessionLock);
+        mWarmSessions.push_back(std::make_pair(level, sessionId));
+    }
+    return OK;
+}
+
+bool JDrm::takeWarmSession(DrmPlugin::SecurityLevel level, Vector<uint8_t> *sessionId) {
+    Mutex::Autolock lock(mWarmSessionLock);
+    for (auto it = mWarmSessions.begin(); it != mWarmSessions.end(); ++it) {
+        if (it->first == level) {
+            *sessionId = it->second;
+            mWarmSessions.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JDrm::closeWarmSessions() {
+    List<std::pair<DrmPlugin::SecurityLevel, Vector<uint8_t>>> sessions;
+    {
+        Mutex::Autolock lock(mWarmSessionLock);
+        sessions = mWarmSessions;
+        mWarmSessions.clear();
+    }
+    if (mDrm == NULL) {
+        return;
+    }
+    for (const auto &session : sessions) {
+        mDrm->closeSession(session.second);
+    }
+}
+
 void JDrm::disconnect() {
+    closeWarmSessions();
     if (mDrm != NULL) {
         mDrm->destroyPlugin();
         mDrm.clear();
@@ -1042,6 +1092,12 @@ static jbyteArray android_media_MediaDrm_openSession(
         return NULL;
     }
 
+    // A prewarmed session avoids the synchronous HAL round trip entirely.
+    sp<JDrm> jdrm = GetJDrm(env, thiz);
+    if (jdrm != NULL && jdrm->takeWarmSession(level, &sessionId)) {
+        return VectorToJByteArray(env, sessionId);
+    }
+
     status_t err = drm->openSession(level, sessionId);
 
     if (throwExceptionAsNecessary(env, err, "Failed to open session")) {
@@ -1051,64 +1107,65 @@ static jbyteArray android_media_MediaDrm_openSession(
     return VectorToJByteArray(env, sessionId);
 }
 
-static void android_media_MediaDrm_closeSession(
-    JNIEnv *env, jobject thiz, jbyteArray jsessionId) {
-    sp<IDrm> drm = GetDrm(env, thiz);
+static void android_media_MediaDrm_prewarmSessions(
+        JNIEnv *env, jobject thiz, jint jlevel, jint count) {
+    sp<JDrm> jdrm = GetJDrm(env, thiz);
 
-    if (!CheckSession(env, drm, jsessionId)) {
+    if (jdrm == NULL || !CheckDrm(env, jdrm->getDrm())) {
         return;
     }
 
-    Vector<uint8_t> sessionId(JByteArrayToVector(env, jsessionId));
+    DrmPlugin::SecurityLevel level = jintToSecurityLevel(jlevel);
+    if (level == DrmPlugin::kSecurityLevelUnknown) {
+        jniThrowException(env, "java/lang/IllegalArgumentException", "Invalid security level");
+        return;
+    }
+    if (count <= 0) {
+        jniThrowException(env, "java/lang/IllegalArgumentException", "Invalid session count");
+        return;
+    }
 
-    status_t err = drm->closeSession(sessionId);
+    status_t err = jdrm->prewarmSessions(level, count);
 
-    throwExceptionAsNecessary(env, err, "Failed to close session");
+    throwExceptionAsNecessary(env, err, "Failed to prewarm sessions");
 }
 
-static jobject android_media_MediaDrm_getKeyRequest(
-    JNIEnv *env, jobject thiz, jbyteArray jsessionId, jbyteArray jinitData,
-    jstring jmimeType, jint jkeyType, jobject joptParams) {
+static void android_media_MediaDrm_closeSession(
+    JNIEnv *env, jobject thiz, jbyteArray jsessionId) {
     sp<IDrm> drm = GetDrm(env, thiz);
 
     if (!CheckSession(env, drm, jsessionId)) {
-        return NULL;
+        return;
     }
 
     Vector<uint8_t> sessionId(JByteArrayToVector(env, jsessionId));
 
-    Vector<uint8_t> initData;
-    if (jinitData != NULL) {
-        initData = JByteArrayToVector(env, jinitData);
-    }
+    status_t err = drm->closeSession(sessionId);
 
-    String8 mimeType;
-    if (jmimeType != NULL) {
-        mimeType = JStringToString8(env, jmimeType);
-    }
+    throwExceptionAsNecessary(env, err, "Failed to close session");
+}
 
-    DrmPlugin::KeyType keyType;
+static bool jintToKeyType(JNIEnv *env, jint jkeyType, DrmPlugin::KeyType *keyType) {
     if (jkeyType == gKeyTypes.kKeyTypeStreaming) {
-        keyType = DrmPlugin::kKeyType_Streaming;
+        *keyType = DrmPlugin::kKeyType_Streaming;
     } else if (jkeyType == gKeyTypes.kKeyTypeOffline) {
-        keyType = DrmPlugin::kKeyType_Offline;
+        *keyType = DrmPlugin::kKeyType_Offline;
     } else if (jkeyType == gKeyTypes.kKeyTypeRelease) {
-        keyType = DrmPlugin::kKeyType_Release;
+        *keyType = DrmPlugin::kKeyType_Release;
     } else {
         jniThrowException(env, "java/lang/IllegalArgumentException",
                           "invalid keyType");
-        return NULL;
-    }
-
-    KeyedVector<String8, String8> optParams;
-    if (joptParams != NULL) {
-        bool isOK;
-        optParams = HashMapToKeyedVector(env, joptParams, &isOK);
-        if (!isOK) {
-            return NULL;
-        }
+        return false;
     }
+    return true;
+}
 
+// Issues one getKeyRequest and wraps the result in a MediaDrm.KeyRequest
+// object. Returns NULL with an exception pending on failure.
+static jobject makeKeyRequest(
+        JNIEnv *env, const sp<IDrm> &drm, const Vector<uint8_t> &sessionId,
+        const Vector<uint8_t> &initData, const String8 &mimeType,
+        DrmPlugin::KeyType keyType, const KeyedVector<String8, String8> &optParams) {
     Vector<uint8_t> request;
     String8 defaultUrl;
     DrmPlugin::KeyRequestType keyRequestType;
@@ -1166,6 +1223,127 @@ static jobject android_media_MediaDrm_getKeyRequest(
     return keyObj;
 }
 
+static jobject android_media_MediaDrm_getKeyRequest(
+    JNIEnv *env, jobject thiz, jbyteArray jsessionId, jbyteArray jinitData,
+    jstring jmimeType, jint jkeyType, jobject joptParams) {
+    sp<IDrm> drm = GetDrm(env, thiz);
+
+    if (!CheckSession(env, drm, jsessionId)) {
+        return NULL;
+    }
+
+    Vector<uint8_t> sessionId(JByteArrayToVector(env, jsessionId));
+
+    Vector<uint8_t> initData;
+    if (jinitData != NULL) {
+        initData = JByteArrayToVector(env, jinitData);
+    }
+
+    String8 mimeType;
+    if (jmimeType != NULL) {
+        mimeType = JStringToString8(env, jmimeType);
+    }
+
+    DrmPlugin::KeyType keyType;
+    if (!jintToKeyType(env, jkeyType, &keyType)) {
+        return NULL;
+    }
+
+    KeyedVector<String8, String8> optParams;
+    if (joptParams != NULL) {
+        bool isOK;
+        optParams = HashMapToKeyedVector(env, joptParams, &isOK);
+        if (!isOK) {
+            return NULL;
+        }
+    }
+
+    return makeKeyRequest(env, drm, sessionId, initData, mimeType, keyType, optParams);
+}
+
+// Batch version of getKeyRequest for multi-track content: one JNI call
+// producing a KeyRequest per (session, initData, mimeType) tuple, sharing
+// the key type and optional parameters. Returns NULL with an exception
+// pending if any request fails.
+static jobjectArray android_media_MediaDrm_getKeyRequests(
+    JNIEnv *env, jobject thiz, jobjectArray jsessionIds, jobjectArray jinitDatas,
+    jobjectArray jmimeTypes, jint jkeyType, jobject joptParams) {
+    sp<IDrm> drm = GetDrm(env, thiz);
+
+    if (!CheckDrm(env, drm)) {
+        return NULL;
+    }
+    if (jsessionIds == NULL) {
+        jniThrowException(env, "java/lang/IllegalArgumentException", "sessionIds is null");
+        return NULL;
+    }
+    const jsize count = env->GetArrayLength(jsessionIds);
+    if ((jinitDatas != NULL && env->GetArrayLength(jinitDatas) != count) ||
+        (jmimeTypes != NULL && env->GetArrayLength(jmimeTypes) != count)) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                          "sessionIds, initDatas and mimeTypes must be the same length");
+        return NULL;
+    }
+
+    DrmPlugin::KeyType keyType;
+    if (!jintToKeyType(env, jkeyType, &keyType)) {
+        return NULL;
+    }
+
+    KeyedVector<String8, String8> optParams;
+    if (joptParams != NULL) {
+        bool isOK;
+        optParams = HashMapToKeyedVector(env, joptParams, &isOK);
+        if (!isOK) {
+            return NULL;
+        }
+    }
+
+    jclass clazz;
+    FIND_CLASS(clazz, "android/media/MediaDrm$KeyRequest");
+    jobjectArray keyObjs = env->NewObjectArray(count, clazz, NULL);
+    if (keyObjs == NULL) {
+        return NULL;
+    }
+
+    for (jsize i = 0; i < count; i++) {
+        ScopedLocalRef<jbyteArray> jsessionId(env,
+                (jbyteArray)env->GetObjectArrayElement(jsessionIds, i));
+        if (jsessionId.get() == NULL) {
+            jniThrowException(env, "java/lang/IllegalArgumentException", "sessionId is null");
+            return NULL;
+        }
+        Vector<uint8_t> sessionId(JByteArrayToVector(env, jsessionId.get()));
+
+        Vector<uint8_t> initData;
+        if (jinitDatas != NULL) {
+            ScopedLocalRef<jbyteArray> jinitData(env,
+                    (jbyteArray)env->GetObjectArrayElement(jinitDatas, i));
+            if (jinitData.get() != NULL) {
+                initData = JByteArrayToVector(env, jinitData.get());
+            }
+        }
+
+        String8 mimeType;
+        if (jmimeTypes != NULL) {
+            ScopedLocalRef<jstring> jmimeType(env,
+                    (jstring)env->GetObjectArrayElement(jmimeTypes, i));
+            if (jmimeType.get() != NULL) {
+                mimeType = JStringToString8(env, jmimeType.get());
+            }
+        }
+
+        ScopedLocalRef<jobject> keyObj(env,
+                makeKeyRequest(env, drm, sessionId, initData, mimeType, keyType, optParams));
+        if (keyObj.get() == NULL) {
+            return NULL;
+        }
+        env->SetObjectArrayElement(keyObjs, i, keyObj.get());
+    }
+
+    return keyObjs;
+}
+
 static jbyteArray android_media_MediaDrm_provideKeyResponse(
     JNIEnv *env, jobject thiz, jbyteArray jsessionId, jbyteArray jresponse) {
     sp<IDrm> drm = GetDrm(env, thiz);
@@ -1192,6 +1370,61 @@ static jbyteArray android_media_MediaDrm_provideKeyResponse(
     return VectorToJByteArray(env, keySetId);
 }
 
+// Batch version of provideKeyResponse. Responses are applied in array order;
+// if one fails, an exception is thrown and earlier responses remain applied.
+static jobjectArray android_media_MediaDrm_provideKeyResponses(
+    JNIEnv *env, jobject thiz, jobjectArray jsessionIds, jobjectArray jresponses) {
+    sp<IDrm> drm = GetDrm(env, thiz);
+
+    if (!CheckDrm(env, drm)) {
+        return NULL;
+    }
+    if (jsessionIds == NULL || jresponses == NULL) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                          "sessionIds or responses is null");
+        return NULL;
+    }
+    const jsize count = env->GetArrayLength(jsessionIds);
+    if (env->GetArrayLength(jresponses) != count) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                          "sessionIds and responses must be the same length");
+        return NULL;
+    }
+
+    jclass byteArrayClazz = env->FindClass("[B");
+    jobjectArray keySetIds = env->NewObjectArray(count, byteArrayClazz, NULL);
+    if (keySetIds == NULL) {
+        return NULL;
+    }
+
+    for (jsize i = 0; i < count; i++) {
+        ScopedLocalRef<jbyteArray> jsessionId(env,
+                (jbyteArray)env->GetObjectArrayElement(jsessionIds, i));
+        ScopedLocalRef<jbyteArray> jresponse(env,
+                (jbyteArray)env->GetObjectArrayElement(jresponses, i));
+        if (jsessionId.get() == NULL || jresponse.get() == NULL) {
+            jniThrowException(env, "java/lang/IllegalArgumentException",
+                              "sessionId or key response is null");
+            return NULL;
+        }
+
+        Vector<uint8_t> sessionId(JByteArrayToVector(env, jsessionId.get()));
+        Vector<uint8_t> response(JByteArrayToVector(env, jresponse.get()));
+        Vector<uint8_t> keySetId;
+
+        status_t err = drm->provideKeyResponse(sessionId, response, keySetId);
+
+        if (throwExceptionAsNecessary(env, err, "Failed to handle key response")) {
+            return NULL;
+        }
+
+        ScopedLocalRef<jbyteArray> jkeySetId(env, VectorToJByteArray(env, keySetId));
+        env->SetObjectArrayElement(keySetIds, i, jkeySetId.get());
+    }
+
+    return keySetIds;
+}
+
 static void android_media_MediaDrm_removeKeys(
     JNIEnv *env, jobject thiz, jbyteArray jkeysetId) {
     sp<IDrm> drm = GetDrm(env, thiz);
@@ -1971,6 +2204,9 @@ static const JNINativeMethod gMethods[] = {
     { "openSession", "(I)[B",
       (void *)android_media_MediaDrm_openSession },
 
+    { "prewarmSessions", "(II)V",
+      (void *)android_media_MediaDrm_prewarmSessions },
+
     { "closeSession", "([B)V",
       (void *)android_media_MediaDrm_closeSession },
 
@@ -1978,9 +2214,16 @@ static const JNINativeMethod gMethods[] = {
       "Landroid/media/MediaDrm$KeyRequest;",
       (void *)android_media_MediaDrm_getKeyRequest },
 
+    { "getKeyRequests", "([[B[[B[Ljava/lang/String;ILjava/util/HashMap;)"
+      "[Landroid/media/MediaDrm$KeyRequest;",
+      (void *)android_media_MediaDrm_getKeyRequests },
+
     { "provideKeyResponse", "([B[B)[B",
       (void *)android_media_MediaDrm_provideKeyResponse },
 
+    { "provideKeyResponses", "([[B[[B)[[B",
+      (void *)android_media_MediaDrm_provideKeyResponses },
+
     { "removeKeys", "([B)V",
       (void *)android_media_MediaDrm_removeKeys },
 
@@ -24,8 +24,11 @@
 #include <mediadrm/IDrmClient.h>
 #include <hidl/HidlSupport.h>
 #include <utils/Errors.h>
+#include <utils/List.h>
 #include <utils/RefBase.h>
 
+#include <utility>
+
 namespace {
 
 struct ListenerArgs {
@@ -77,6 +80,15 @@ struct JDrm : public IDrmClient {
 
     status_t setListener(const sp<DrmListener>& listener);
 
+    // Warm session pool: opening a session costs a synchronous round trip to
+    // the DRM HAL, so sessions can be opened ahead of need and handed out by
+    // openSession without that latency. Pooled sessions are pristine (no key
+    // request has been issued on them), which is why closed sessions are
+    // never returned to the pool.
+    status_t prewarmSessions(DrmPlugin::SecurityLevel level, size_t count);
+    bool takeWarmSession(DrmPlugin::SecurityLevel level, Vector<uint8_t> *sessionId);
+    void closeWarmSessions();
+
     void disconnect();
 
 protected:
@@ -90,6 +102,9 @@ private:
     Mutex mNotifyLock;
     Mutex mLock;
 
+    Mutex mWarmSessionLock;
+    List<std::pair<DrmPlugin::SecurityLevel, Vector<uint8_t>>> mWarmSessions;
+
     static sp<IDrm> MakeDrm();
     static sp<IDrm> MakeDrm(const uint8_t uuid[16], const String8 &appPackageName);
 
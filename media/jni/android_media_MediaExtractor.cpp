@@ -239,6 +239,74 @@ status_t JMediaExtractor::readSampleData(
     return OK;
 }
 
+/*
+ * Reads consecutive samples into |data| and describes each one with a
+ * SampleBatchRecord, advancing past every sample it consumes. Unlike
+ * readSampleData this never touches managed objects, so a scan of a long
+ * recording pays one JNI transition per batch instead of several per sample.
+ *
+ * Stops when the data region or record table fills up or the source reaches
+ * end of stream; samples already read are always reported. A sample too large
+ * for the whole region fails with -ERANGE so the caller can tell it apart
+ * from an ordinary "come back with the rest" full batch.
+ */
+status_t JMediaExtractor::readSampleBatch(
+        void *data, size_t capacity, SampleBatchRecord *records,
+        size_t maxRecords, size_t *numRecords) {
+    *numRecords = 0;
+
+    size_t used = 0;
+    while (*numRecords < maxRecords) {
+        size_t sampleSize;
+        status_t err = mImpl->getSampleSize(&sampleSize);
+
+        if (err == ERROR_END_OF_STREAM) {
+            break;
+        } else if (err != OK) {
+            return *numRecords == 0 ? err : OK;
+        }
+
+        if (sampleSize > capacity - used) {
+            if (*numRecords == 0) {
+                return -ERANGE;
+            }
+            break;
+        }
+
+        sp<ABuffer> buffer = new ABuffer((char *)data + used, capacity - used);
+
+        err = mImpl->readSampleData(buffer);
+
+        if (err != OK) {
+            return *numRecords == 0 ? err : OK;
+        }
+
+        size_t trackIndex = 0;
+        int64_t sampleTimeUs = -1ll;
+        uint32_t sampleFlags = 0;
+        (void)getSampleTrackIndex(&trackIndex);
+        (void)getSampleTime(&sampleTimeUs);
+        (void)getSampleFlags(&sampleFlags);
+
+        SampleBatchRecord *record = &records[*numRecords];
+        record->offset = used;
+        record->timeUs = sampleTimeUs;
+        record->size = buffer->size();
+        record->trackIndex = trackIndex;
+        record->flags = sampleFlags;
+        record->reserved = 0;
+
+        used += buffer->size();
+        ++*numRecords;
+
+        if (mImpl->advance() != OK) {
+            break;
+        }
+    }
+
+    return OK;
+}
+
 status_t JMediaExtractor::getSampleTrackIndex(size_t *trackIndex) {
     return mImpl->getSampleTrackIndex(trackIndex);
 }
@@ -472,6 +540,44 @@ static jint android_media_MediaExtractor_readSampleData(
     return (jint) sampleSize;
 }
 
+static jint android_media_MediaExtractor_readSampleBatch(
+        JNIEnv *env, jobject thiz, jobject dataBuf, jobject recordBuf) {
+    sp<JMediaExtractor> extractor = getMediaExtractor(env, thiz);
+
+    if (extractor == NULL) {
+        jniThrowException(env, "java/lang/IllegalStateException", NULL);
+        return -1;
+    }
+
+    void *data = env->GetDirectBufferAddress(dataBuf);
+    jlong dataCapacity = env->GetDirectBufferCapacity(dataBuf);
+    void *records = env->GetDirectBufferAddress(recordBuf);
+    jlong recordCapacity = env->GetDirectBufferCapacity(recordBuf);
+
+    if (data == NULL || dataCapacity <= 0 || records == NULL
+            || recordCapacity < (jlong)sizeof(SampleBatchRecord)) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                "sample batch buffers must be direct ByteBuffers");
+        return -1;
+    }
+
+    size_t numRecords = 0;
+    status_t err = extractor->readSampleBatch(
+            data, dataCapacity, (SampleBatchRecord *)records,
+            recordCapacity / sizeof(SampleBatchRecord), &numRecords);
+
+    if (err == -ERANGE) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                "sample too large for the data region");
+        return -1;
+    } else if (err != OK) {
+        jniThrowException(env, "java/lang/IllegalArgumentException", NULL);
+        return -1;
+    }
+
+    return (jint)numRecords;
+}
+
 static jint android_media_MediaExtractor_getSampleTrackIndex(
         JNIEnv *env, jobject thiz) {
     sp<JMediaExtractor> extractor = getMediaExtractor(env, thiz);
@@ -944,6 +1050,9 @@ static const JNINativeMethod gMethods[] = {
     { "readSampleData", "(Ljava/nio/ByteBuffer;I)I",
         (void *)android_media_MediaExtractor_readSampleData },
 
+    { "readSampleBatch", "(Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;)I",
+        (void *)android_media_MediaExtractor_readSampleBatch },
+
     { "getSampleTrackIndex", "()I",
         (void *)android_media_MediaExtractor_getSampleTrackIndex },
 
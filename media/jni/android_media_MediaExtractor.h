@@ -34,6 +34,20 @@ struct IMediaHTTPService;
 class MetaData;
 struct NuMediaExtractor;
 
+/*
+ * Per-sample descriptor filled in by JMediaExtractor::readSampleBatch. The
+ * layout is shared with the managed side, which reads the records out of a
+ * direct ByteBuffer in native byte order; keep the two in sync.
+ */
+struct SampleBatchRecord {
+    jlong offset;      // byte offset of the sample payload in the data region
+    jlong timeUs;      // sample presentation time
+    jint size;         // sample payload size in bytes
+    jint trackIndex;   // source track of the sample
+    jint flags;        // MediaExtractor.SAMPLE_FLAG_* bits
+    jint reserved;
+};
+
 struct JMediaExtractor : public RefBase {
     JMediaExtractor(JNIEnv *env, jobject thiz);
 
@@ -59,6 +73,9 @@ struct JMediaExtractor : public RefBase {
 
     status_t advance();
     status_t readSampleData(jobject byteBuf, size_t offset, size_t *sampleSize);
+    status_t readSampleBatch(
+            void *data, size_t capacity, SampleBatchRecord *records,
+            size_t maxRecords, size_t *numRecords);
     status_t getSampleTrackIndex(size_t *trackIndex);
     status_t getSampleTime(int64_t *sampleTimeUs);
     status_t getSampleSize(size_t *sampleSize);
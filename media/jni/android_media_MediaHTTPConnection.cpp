@@ -18,6 +18,8 @@
 #define LOG_TAG "MediaHTTPConnection-JNI"
 #include <utils/Log.h>
 
+#include <string.h>
+
 #include <binder/MemoryDealer.h>
 #include <media/stagefright/foundation/ADebug.h>
 #include <nativehelper/ScopedLocalRef.h>
@@ -34,7 +36,13 @@ namespace android {
 JMediaHTTPConnection::JMediaHTTPConnection(JNIEnv *env, jobject thiz)
     : mClass(NULL),
       mObject(NULL),
-      mByteArrayObj(NULL) {
+      mByteArrayObj(NULL),
+      mPrefetchArrayObj(NULL),
+      mWindowOffset(0),
+      mFetchOffset(-1),
+      mFetchResult(0),
+      mReadAtMethod(NULL),
+      mExiting(false) {
     jclass clazz = env->GetObjectClass(thiz);
     CHECK(clazz != NULL);
 
@@ -48,11 +56,30 @@ JMediaHTTPConnection::JMediaHTTPConnection(JNIEnv *env, jobject thiz)
             env, env->NewByteArray(JMediaHTTPConnection::kBufferSize));
 
     mByteArrayObj = (jbyteArray)env->NewGlobalRef(tmp.get());
+
+    ScopedLocalRef<jbyteArray> prefetchTmp(
+            env, env->NewByteArray(JMediaHTTPConnection::kPrefetchSize));
+
+    mPrefetchArrayObj = (jbyteArray)env->NewGlobalRef(prefetchTmp.get());
+
+    mPrefetchThread =
+        std::thread(&JMediaHTTPConnection::prefetchThreadLoop, this);
 }
 
 JMediaHTTPConnection::~JMediaHTTPConnection() {
+    {
+        std::lock_guard<std::mutex> lock(mWindowLock);
+        mExiting = true;
+    }
+    mWindowCondition.notify_all();
+    if (mPrefetchThread.joinable()) {
+        mPrefetchThread.join();
+    }
+
     JNIEnv *env = AndroidRuntime::getJNIEnv();
 
+    env->DeleteGlobalRef(mPrefetchArrayObj);
+    mPrefetchArrayObj = NULL;
     env->DeleteGlobalRef(mByteArrayObj);
     mByteArrayObj = NULL;
     env->DeleteWeakGlobalRef(mObject);
@@ -69,6 +96,119 @@ jbyteArray JMediaHTTPConnection::getByteArrayObj() {
     return mByteArrayObj;
 }
 
+bool JMediaHTTPConnection::windowContainsLocked(off64_t offset) const {
+    return !mWindow.empty()
+            && offset >= mWindowOffset
+            && offset < mWindowOffset + (off64_t)mWindow.size();
+}
+
+jint JMediaHTTPConnection::readAt(
+        jmethodID readAtMethod, jlong offset, jint size) {
+    std::unique_lock<std::mutex> lock(mWindowLock);
+    mReadAtMethod = readAtMethod;
+
+    if (!windowContainsLocked(offset)) {
+        mFetchOffset = offset;
+        mWindowCondition.notify_all();
+        mWindowCondition.wait(lock, [this, offset] {
+            return mExiting || windowContainsLocked(offset) || mFetchOffset < 0;
+        });
+
+        if (mExiting) {
+            return -1;
+        }
+
+        if (!windowContainsLocked(offset)) {
+            return mFetchResult <= 0 ? mFetchResult : 0;
+        }
+    }
+
+    size_t windowPos = offset - mWindowOffset;
+    size_t avail = mWindow.size() - windowPos;
+    jint n = size < (jint)avail ? size : (jint)avail;
+    memcpy(mMemory->unsecurePointer(), &mWindow[windowPos], n);
+
+    // Start refilling before the caller drains the tail of the window, so
+    // the next up-call overlaps with the caller consuming these bytes.
+    if (mFetchOffset < 0 && avail - n < kPrefetchSize / 2) {
+        mFetchOffset = mWindowOffset + mWindow.size();
+        mWindowCondition.notify_all();
+    }
+
+    return n;
+}
+
+void JMediaHTTPConnection::prefetchThreadLoop() {
+    JavaVM *vm = AndroidRuntime::getJavaVM();
+    JNIEnv *env = NULL;
+    if (vm->AttachCurrentThread(&env, NULL) != JNI_OK) {
+        ALOGE("failed to attach prefetch thread");
+        return;
+    }
+
+    std::vector<uint8_t> chunk;
+    for (;;) {
+        off64_t fetchOffset;
+        jmethodID readAtMethod;
+        {
+            std::unique_lock<std::mutex> lock(mWindowLock);
+            mWindowCondition.wait(lock, [this] {
+                return mExiting || mFetchOffset >= 0;
+            });
+
+            if (mExiting) {
+                break;
+            }
+
+            fetchOffset = mFetchOffset;
+            readAtMethod = mReadAtMethod;
+        }
+
+        jint n = -1;
+        jobject obj = env->NewLocalRef(mObject);
+        if (obj != NULL) {
+            n = env->CallIntMethod(
+                    obj, readAtMethod, (jlong)fetchOffset, mPrefetchArrayObj,
+                    (jint)kPrefetchSize);
+
+            // Exceptions cannot propagate out of a native thread; treat them
+            // like a failed read.
+            if (env->ExceptionCheck()) {
+                env->ExceptionClear();
+                n = -1;
+            }
+            env->DeleteLocalRef(obj);
+        }
+
+        chunk.clear();
+        if (n > 0) {
+            chunk.resize(n);
+            env->GetByteArrayRegion(
+                    mPrefetchArrayObj, 0, n, (jbyte *)chunk.data());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mWindowLock);
+            if (n > 0) {
+                // Keep the previous window on failure so short reads near
+                // end of stream do not evict still-useful data.
+                mWindow.swap(chunk);
+                mWindowOffset = fetchOffset;
+            }
+            mFetchResult = n;
+
+            // A reader may have requested a different window while this
+            // fetch was in flight; leave the request pending in that case.
+            if (mFetchOffset == fetchOffset) {
+                mFetchOffset = -1;
+            }
+        }
+        mWindowCondition.notify_all();
+    }
+
+    vm->DetachCurrentThread();
+}
+
 }  // namespace android
 
 using namespace android;
@@ -138,20 +278,7 @@ static jint android_media_MediaHTTPConnection_native_readAt(
         size = JMediaHTTPConnection::kBufferSize;
     }
 
-    jbyteArray byteArrayObj = conn->getByteArrayObj();
-
-    jint n = env->CallIntMethod(
-            thiz, gFields.readAtMethodID, offset, byteArrayObj, size);
-
-    if (n > 0) {
-        env->GetByteArrayRegion(
-                byteArrayObj,
-                0,
-                n,
-                (jbyte *)conn->getIMemory()->unsecurePointer());
-    }
-
-    return n;
+    return conn->readAt(gFields.readAtMethodID, offset, size);
 }
 
 static const JNINativeMethod gMethods[] = {
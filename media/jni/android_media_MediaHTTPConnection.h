@@ -19,6 +19,13 @@
 
 #include "jni.h"
 
+#include <sys/types.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <media/stagefright/foundation/ABase.h>
 #include <utils/RefBase.h>
 
@@ -30,6 +37,11 @@ class MemoryDealer;
 struct JMediaHTTPConnection : public RefBase {
     enum {
         kBufferSize = 32768,
+
+        // Size of the sliding readahead window. Each refill is a single
+        // readAt up-call, so this is also the number of bytes served
+        // natively per JNI round trip on a sequential scan.
+        kPrefetchSize = 512 * 1024,
     };
 
     JMediaHTTPConnection(JNIEnv *env, jobject thiz);
@@ -38,6 +50,11 @@ struct JMediaHTTPConnection : public RefBase {
 
     jbyteArray getByteArrayObj();
 
+    // Copies up to |size| bytes at |offset| into the shared IMemory region,
+    // asking the prefetch thread to refill the readahead window through
+    // |readAtMethod| on a miss or when the window is running low.
+    jint readAt(jmethodID readAtMethod, jlong offset, jint size);
+
 protected:
     virtual ~JMediaHTTPConnection();
 
@@ -45,10 +62,24 @@ private:
     jclass mClass;
     jweak mObject;
     jbyteArray mByteArrayObj;
+    jbyteArray mPrefetchArrayObj;
 
     sp<MemoryDealer> mDealer;
     sp<IMemory> mMemory;
 
+    std::mutex mWindowLock;
+    std::condition_variable mWindowCondition;
+    std::vector<uint8_t> mWindow;  // prefetched bytes starting at mWindowOffset
+    off64_t mWindowOffset;
+    off64_t mFetchOffset;          // window the prefetch thread should load, -1 if idle
+    jint mFetchResult;
+    jmethodID mReadAtMethod;
+    bool mExiting;
+    std::thread mPrefetchThread;
+
+    void prefetchThreadLoop();
+    bool windowContainsLocked(off64_t offset) const;
+
     DISALLOW_EVIL_CONSTRUCTORS(JMediaHTTPConnection);
 };
 
@@ -18,7 +18,9 @@
 //#define LOG_NDEBUG 0
 #define LOG_TAG "MediaMetadataRetrieverJNI"
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 #include <assert.h>
 #include <utils/Log.h>
 #include <utils/threads.h>
@@ -27,6 +29,7 @@
 #include <media/mediametadataretriever.h>
 #include <media/mediascanner.h>
 #include <nativehelper/ScopedLocalRef.h>
+#include <nativehelper/ScopedPrimitiveArray.h>
 #include <private/media/VideoFrame.h>
 
 #include "jni.h"
@@ -397,6 +400,85 @@ static jobject android_media_MediaMetadataRetriever_getFrameAtTime(
     return getBitmapFromVideoFrame(env, videoFrame, dst_width, dst_height, colorFormat);
 }
 
+// Batch version of getFrameAtTime for thumbnail strips and scrubbers. The
+// requested timestamps are retrieved in ascending order so the underlying
+// extractor walks the file in one forward demux pass instead of seeking
+// back and forth, while the returned list keeps the caller's order (with
+// null entries for frames that could not be decoded).
+static jobject android_media_MediaMetadataRetriever_getFramesAtTimes(
+        JNIEnv *env, jobject thiz, jlongArray timesUs, jint option,
+        jint dst_width, jint dst_height, jobject params)
+{
+    sp<MediaMetadataRetriever> retriever = getRetriever(env, thiz);
+    if (retriever == 0) {
+        jniThrowException(env, "java/lang/IllegalStateException", "No retriever available");
+        return NULL;
+    }
+    if (timesUs == NULL) {
+        jniThrowException(env, "java/lang/IllegalArgumentException", "Null timestamp array");
+        return NULL;
+    }
+    ScopedLongArrayRO times(env, timesUs);
+    const size_t count = times.size();
+    ALOGV("getFramesAtTimes: %zu frames option: %d dst width: %d height: %d",
+            count, option, dst_width, dst_height);
+
+    // Match getFrameAtTime's default of RGB_565.
+    AndroidBitmapFormat colorFormat = getColorFormat(env, params, ANDROID_BITMAP_FORMAT_RGB_565);
+    setOutConfig(env, params, colorFormat);
+
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+            [&times](size_t a, size_t b) { return times[a] < times[b]; });
+
+    std::vector<jobject> bitmaps(count, nullptr);
+    size_t decoded = 0;
+    for (size_t i : order) {
+        sp<IMemory> frameMemory = retriever->getFrameAtTime(times[i], option, colorFormat);
+        if (frameMemory == 0) {
+            ALOGE("getFramesAtTimes: frame at %lld us is a NULL pointer",
+                    (long long)times[i]);
+            continue;
+        }
+        // TODO: Using unsecurePointer() has some associated security pitfalls
+        //       (see declaration for details).
+        //       Either document why it is safe in this case or address the
+        //       issue (e.g. by copying).
+        VideoFrame *videoFrame = static_cast<VideoFrame *>(frameMemory->unsecurePointer());
+        if (videoFrame == NULL) {
+            continue;
+        }
+        bitmaps[i] = getBitmapFromVideoFrame(env, videoFrame, dst_width, dst_height, colorFormat);
+        if (bitmaps[i] != NULL) {
+            decoded++;
+        }
+    }
+
+    if (decoded == 0) {
+        jniThrowException(env,
+                "java/lang/IllegalStateException", "No frames from retriever");
+        return NULL;
+    }
+
+    jobject arrayList = env->NewObject(fields.arrayListClazz, fields.arrayListInit);
+    if (arrayList == NULL) {
+        jniThrowException(env,
+                "java/lang/IllegalStateException", "Can't create bitmap array");
+        return NULL;
+    }
+    for (size_t i = 0; i < count; i++) {
+        env->CallBooleanMethod(arrayList, fields.arrayListAdd, bitmaps[i]);
+        if (bitmaps[i] != NULL) {
+            env->DeleteLocalRef(bitmaps[i]);
+        }
+    }
+
+    return arrayList;
+}
+
 static jobject android_media_MediaMetadataRetriever_getImageAtIndex(
         JNIEnv *env, jobject thiz, jint index, jobject params)
 {
@@ -710,6 +792,8 @@ static const JNINativeMethod nativeMethods[] = {
                 (void *)android_media_MediaMetadataRetriever_setDataSourceCallback},
         {"_getFrameAtTime", "(JIIILandroid/media/MediaMetadataRetriever$BitmapParams;)Landroid/graphics/Bitmap;",
                 (void *)android_media_MediaMetadataRetriever_getFrameAtTime},
+        {"_getFramesAtTimes", "([JIIILandroid/media/MediaMetadataRetriever$BitmapParams;)Ljava/util/List;",
+                (void *)android_media_MediaMetadataRetriever_getFramesAtTimes},
         {
             "_getImageAtIndex",
             "(ILandroid/media/MediaMetadataRetriever$BitmapParams;)Landroid/graphics/Bitmap;",
@@ -371,6 +371,39 @@ uint64_t MediaEvent::getAudioHandle() {
     return mDataId;
 }
 
+/////////////// FilterEventRing ///////////////////////
+
+FilterEventRing::FilterEventRing(size_t capacity)
+        : mEntries(capacity), mHead(0), mTail(0), mCount(0), mDropped(0) {}
+
+bool FilterEventRing::push(const FilterRingEvent& event) {
+    std::lock_guard<std::mutex> lock(mLock);
+    if (mCount == mEntries.size()) {
+        mDropped++;
+        return false;
+    }
+    mEntries[mHead] = event;
+    mHead = (mHead + 1) % mEntries.size();
+    mCount++;
+    return true;
+}
+
+size_t FilterEventRing::pop(FilterRingEvent* out, size_t maxCount) {
+    std::lock_guard<std::mutex> lock(mLock);
+    size_t popped = 0;
+    while (popped < maxCount && mCount > 0) {
+        out[popped++] = mEntries[mTail];
+        mTail = (mTail + 1) % mEntries.size();
+        mCount--;
+    }
+    return popped;
+}
+
+uint64_t FilterEventRing::droppedCount() {
+    std::lock_guard<std::mutex> lock(mLock);
+    return mDropped;
+}
+
 /////////////// FilterCallback ///////////////////////
 
 jobjectArray FilterCallback::getSectionEvent(
@@ -602,12 +635,86 @@ jobjectArray FilterCallback::getTemiEvent(
     return arr;
 }
 
+// Routes bulk data events into the filter's native event ring, if one is
+// attached. Returns true when the events were consumed natively and must not
+// be posted to the managed layer. Media, record and TEMI events carry native
+// handles or variable-length payloads and always take the managed path, as do
+// status callbacks.
+bool FilterCallback::dispatchToEventRing(const std::vector<DemuxFilterEvent::Event>& events) {
+    if (events.empty()) {
+        return false;
+    }
+    switch (events[0].getDiscriminator()) {
+        case DemuxFilterEvent::Event::hidl_discriminator::section:
+        case DemuxFilterEvent::Event::hidl_discriminator::pes:
+        case DemuxFilterEvent::Event::hidl_discriminator::download:
+        case DemuxFilterEvent::Event::hidl_discriminator::ipPayload:
+            break;
+        default:
+            return false;
+    }
+
+    sp<Filter> filter = mFilterRef.promote();
+    if (filter == NULL) {
+        return false;
+    }
+    std::shared_ptr<FilterEventRing> ring = std::atomic_load(&filter->mEventRing);
+    if (ring == nullptr) {
+        return false;
+    }
+
+    for (int i = 0; i < events.size(); i++) {
+        auto event = events[i];
+        FilterRingEvent entry = {};
+        entry.type = static_cast<uint32_t>(event.getDiscriminator());
+        switch (event.getDiscriminator()) {
+            case DemuxFilterEvent::Event::hidl_discriminator::section: {
+                DemuxFilterSectionEvent sectionEvent = event.section();
+                entry.tableId = static_cast<int32_t>(sectionEvent.tableId);
+                entry.version = static_cast<int32_t>(sectionEvent.version);
+                entry.sectionNum = static_cast<int32_t>(sectionEvent.sectionNum);
+                entry.dataLength = static_cast<int64_t>(sectionEvent.dataLength);
+                break;
+            }
+            case DemuxFilterEvent::Event::hidl_discriminator::pes: {
+                DemuxFilterPesEvent pesEvent = event.pes();
+                entry.streamId = static_cast<int32_t>(pesEvent.streamId);
+                entry.mpuSequenceNumber = static_cast<int32_t>(pesEvent.mpuSequenceNumber);
+                entry.dataLength = static_cast<int64_t>(pesEvent.dataLength);
+                break;
+            }
+            case DemuxFilterEvent::Event::hidl_discriminator::download: {
+                DemuxFilterDownloadEvent downloadEvent = event.download();
+                entry.itemId = static_cast<int32_t>(downloadEvent.itemId);
+                entry.mpuSequenceNumber = static_cast<int32_t>(downloadEvent.mpuSequenceNumber);
+                entry.itemFragmentIndex = static_cast<int32_t>(downloadEvent.itemFragmentIndex);
+                entry.lastItemFragmentIndex =
+                        static_cast<int32_t>(downloadEvent.lastItemFragmentIndex);
+                entry.dataLength = static_cast<int64_t>(downloadEvent.dataLength);
+                break;
+            }
+            case DemuxFilterEvent::Event::hidl_discriminator::ipPayload: {
+                entry.dataLength = static_cast<int64_t>(event.ipPayload().dataLength);
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+        ring->push(entry);
+    }
+    return true;
+}
+
 Return<void> FilterCallback::onFilterEvent(const DemuxFilterEvent& filterEvent) {
     ALOGD("FilterCallback::onFilterEvent");
 
     JNIEnv *env = AndroidRuntime::getJNIEnv();
 
     std::vector<DemuxFilterEvent::Event> events = filterEvent.events;
+    if (dispatchToEventRing(events)) {
+        return Void();
+    }
     jclass eventClazz = env->FindClass("android/media/tv/tuner/filter/FilterEvent");
     jobjectArray array = env->NewObjectArray(events.size(), eventClazz, NULL);
 
@@ -673,6 +780,7 @@ void FilterCallback::setFilter(const sp<Filter> filter) {
     ALOGD("FilterCallback::setFilter");
     mFilter = filter->mFilterObj;
     mIFilter = filter->mFilterSp;
+    mFilterRef = filter;
 }
 
 FilterCallback::~FilterCallback() {
@@ -3108,6 +3216,52 @@ static jint android_media_tv_Tuner_read_filter_fmq(
     return copyData(env, filterSp->mFilterMQ, filterSp->mFilterMQEventFlag, buffer, offset, size);
 }
 
+// Attaches (capacity > 0) or detaches (capacity == 0) a native event ring to
+// the filter. While a ring is attached, section, PES, download and IP payload
+// events are pushed into the ring for a native consumer instead of being
+// posted to the managed callback; all other events and status changes keep
+// the managed path.
+static jint android_media_tv_Tuner_configure_event_ring(
+        JNIEnv *env, jobject filter, jint capacity) {
+    sp<Filter> filterSp = getFilter(env, filter);
+    if (filterSp == NULL) {
+        ALOGD("Failed to configure event ring: filter not found");
+        return (jint) Result::NOT_INITIALIZED;
+    }
+    if (capacity < 0) {
+        return (jint) Result::INVALID_ARGUMENT;
+    }
+    std::shared_ptr<FilterEventRing> ring =
+            capacity == 0 ? nullptr : std::make_shared<FilterEventRing>(capacity);
+    std::atomic_store(&filterSp->mEventRing, ring);
+    return (jint) Result::SUCCESS;
+}
+
+// Drains packed FilterRingEvent records into a direct ByteBuffer and returns
+// the number of records written. Native consumers holding the Filter pointer
+// can instead pop the ring directly without any JNI transition.
+static jint android_media_tv_Tuner_read_event_ring(JNIEnv *env, jobject filter, jobject buffer) {
+    sp<Filter> filterSp = getFilter(env, filter);
+    if (filterSp == NULL) {
+        jniThrowException(env, "java/lang/IllegalStateException",
+                "Failed to read event ring: filter not found");
+        return 0;
+    }
+    std::shared_ptr<FilterEventRing> ring = std::atomic_load(&filterSp->mEventRing);
+    if (ring == nullptr) {
+        return 0;
+    }
+    void* base = env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (base == NULL || capacity < 0) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                "event buffer must be a direct ByteBuffer");
+        return 0;
+    }
+    return static_cast<jint>(ring->pop(static_cast<FilterRingEvent*>(base),
+            capacity / static_cast<jlong>(sizeof(FilterRingEvent))));
+}
+
 static jint android_media_tv_Tuner_close_filter(JNIEnv *env, jobject filter) {
     sp<IFilter> iFilterSp = getFilter(env, filter)->getIFilter();
     if (iFilterSp == NULL) {
@@ -3709,6 +3863,9 @@ static const JNINativeMethod gFilterMethods[] = {
     { "nativeStopFilter", "()I", (void *)android_media_tv_Tuner_stop_filter },
     { "nativeFlushFilter", "()I", (void *)android_media_tv_Tuner_flush_filter },
     { "nativeRead", "([BJJ)I", (void *)android_media_tv_Tuner_read_filter_fmq },
+    { "nativeConfigureEventRing", "(I)I", (void *)android_media_tv_Tuner_configure_event_ring },
+    { "nativeReadEventRing", "(Ljava/nio/ByteBuffer;)I",
+            (void *)android_media_tv_Tuner_read_event_ring },
     { "nativeClose", "()I", (void *)android_media_tv_Tuner_close_filter },
 };
 
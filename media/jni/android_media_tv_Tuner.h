@@ -23,8 +23,11 @@
 #include <C2ParamDef.h>
 #include <fmq/MessageQueue.h>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <utils/Mutex.h>
 #include <utils/RefBase.h>
 
@@ -133,6 +136,43 @@ struct MediaEvent : public RefBase {
     std::weak_ptr<C2Buffer> mC2Buffer;
 };
 
+// One packed entry in a filter's native event ring. Only the fields relevant
+// to the entry's event type are populated; the rest stay zero. The layout is
+// shared with consumers draining the ring through a direct ByteBuffer, so
+// fields are fixed-size and 8-byte aligned.
+struct FilterRingEvent {
+    uint32_t type;              // DemuxFilterEvent::Event discriminator value
+    int32_t streamId;           // pes
+    int32_t tableId;            // section
+    int32_t version;            // section
+    int32_t sectionNum;         // section
+    int32_t mpuSequenceNumber;  // pes, download
+    int32_t itemId;             // download
+    int32_t itemFragmentIndex;  // download
+    int32_t lastItemFragmentIndex; // download
+    int32_t reserved;
+    int64_t dataLength;
+};
+
+// Lossy bounded ring between a filter's HIDL callback thread and a native
+// consumer. When attached to a filter, bulk data events are pushed here
+// instead of being posted to the managed layer; pushing into a full ring
+// drops the event and counts the loss.
+struct FilterEventRing {
+    explicit FilterEventRing(size_t capacity);
+    bool push(const FilterRingEvent& event);
+    size_t pop(FilterRingEvent* out, size_t maxCount);
+    uint64_t droppedCount();
+
+private:
+    std::mutex mLock;
+    std::vector<FilterRingEvent> mEntries;
+    size_t mHead;
+    size_t mTail;
+    size_t mCount;
+    uint64_t mDropped;
+};
+
 struct Filter : public RefBase {
     Filter(sp<IFilter> sp, jobject obj);
     ~Filter();
@@ -142,6 +182,9 @@ struct Filter : public RefBase {
     std::unique_ptr<MQ> mFilterMQ;
     EventFlag* mFilterMQEventFlag;
     jweak mFilterObj;
+    // Access with std::atomic_load/std::atomic_store; swapped while the HIDL
+    // callback thread may be dispatching events.
+    std::shared_ptr<FilterEventRing> mEventRing;
 };
 
 struct FilterCallback : public IFilterCallback {
@@ -153,6 +196,8 @@ struct FilterCallback : public IFilterCallback {
 private:
     jweak mFilter;
     sp<IFilter> mIFilter;
+    wp<Filter> mFilterRef;
+    bool dispatchToEventRing(const std::vector<DemuxFilterEvent::Event>& events);
     jobjectArray getSectionEvent(
             jobjectArray& arr, const std::vector<DemuxFilterEvent::Event>& events);
     jobjectArray getMediaEvent(
@@ -83,6 +83,16 @@ jboolean Java_android_filterfw_core_GLEnvironment_nativeInitWithCurrentContext(J
   return gl_env ? ToJBool(gl_env->InitWithCurrentContext()) : JNI_FALSE;
 }
 
+jboolean Java_android_filterfw_core_GLEnvironment_nativeInitWithSharedContext(JNIEnv* env,
+                                                                              jobject thiz,
+                                                                              jobject shared_env) {
+  GLEnv* gl_env = ConvertFromJava<GLEnv>(env, thiz);
+  GLEnv* share_gl_env = ConvertFromJava<GLEnv>(env, shared_env);
+  return (gl_env && share_gl_env)
+      ? ToJBool(gl_env->InitWithSharedContext(share_gl_env))
+      : JNI_FALSE;
+}
+
 jboolean Java_android_filterfw_core_GLEnvironment_nativeIsActive(JNIEnv* env, jobject thiz) {
   GLEnv* gl_env = ConvertFromJava<GLEnv>(env, thiz);
   return gl_env ? ToJBool(gl_env->IsActive()) : JNI_FALSE;
@@ -35,6 +35,11 @@ Java_android_filterfw_core_GLEnvironment_nativeInitWithNewContext(JNIEnv* env, j
 JNIEXPORT jboolean JNICALL
 Java_android_filterfw_core_GLEnvironment_nativeInitWithCurrentContext(JNIEnv* env, jobject thiz);
 
+JNIEXPORT jboolean JNICALL
+Java_android_filterfw_core_GLEnvironment_nativeInitWithSharedContext(JNIEnv* env,
+                                                                     jobject thiz,
+                                                                     jobject shared_env);
+
 JNIEXPORT jboolean JNICALL
 Java_android_filterfw_core_GLEnvironment_nativeIsActive(JNIEnv* env, jobject thiz);
 
@@ -126,6 +126,27 @@ bool GLEnv::InitWithCurrentContext() {
          (surface() != EGL_NO_SURFACE);
 }
 
+// Chooses the EGL configuration all GLEnv-created contexts use.
+static bool ChooseEglConfig(EGLDisplay display, EGLConfig* config) {
+  EGLint numConfigs = -1;
+
+  // TODO(renn): Do we need the window bit here?
+  // TODO: Currently choosing the config that includes all
+  // This is not needed if the encoding is not being used
+  EGLint configAttribs[] = {
+    EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+    EGL_RED_SIZE, 8,
+    EGL_GREEN_SIZE, 8,
+    EGL_BLUE_SIZE, 8,
+    EGL_RECORDABLE_ANDROID, EGL_TRUE,
+    EGL_NONE
+  };
+
+  eglChooseConfig(display, configAttribs, config, 1, &numConfigs);
+  return numConfigs >= 1;
+}
+
 bool GLEnv::InitWithNewContext() {
   if (IsInitialized()) {
     ALOGE("GLEnv: Attempting to reinitialize environment!");
@@ -143,23 +164,7 @@ bool GLEnv::InitWithNewContext() {
 
   // Configure context/surface
   EGLConfig config;
-  EGLint numConfigs = -1;
-
-  // TODO(renn): Do we need the window bit here?
-  // TODO: Currently choosing the config that includes all
-  // This is not needed if the encoding is not being used
-  EGLint configAttribs[] = {
-    EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
-    EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
-    EGL_RED_SIZE, 8,
-    EGL_GREEN_SIZE, 8,
-    EGL_BLUE_SIZE, 8,
-    EGL_RECORDABLE_ANDROID, EGL_TRUE,
-    EGL_NONE
-  };
-
-  eglChooseConfig(display(), configAttribs, &config, 1, &numConfigs);
-  if (numConfigs < 1) {
+  if (!ChooseEglConfig(display(), &config)) {
     ALOGE("GLEnv::Init: No suitable EGL configuration found!");
     return false;
   }
@@ -188,6 +193,51 @@ bool GLEnv::InitWithNewContext() {
   return true;
 }
 
+bool GLEnv::InitWithSharedContext(GLEnv* share_env) {
+  if (IsInitialized()) {
+    ALOGE("GLEnv: Attempting to reinitialize environment!");
+    return false;
+  }
+  if (!share_env || !share_env->IsInitialized()) {
+    ALOGE("GLEnv: Attempting to share with an uninitialized environment!");
+    return false;
+  }
+
+  // The display stays owned by share_env; do not terminate it on teardown.
+  display_ = share_env->display();
+
+  EGLConfig config;
+  if (!ChooseEglConfig(display(), &config)) {
+    ALOGE("GLEnv::Init: No suitable EGL configuration found!");
+    return false;
+  }
+
+  // Create dummy surface using a GLConsumer
+  sp<IGraphicBufferProducer> producer;
+  sp<IGraphicBufferConsumer> consumer;
+  BufferQueue::createBufferQueue(&producer, &consumer);
+  surfaceTexture_ = new GLConsumer(consumer, 0, GLConsumer::TEXTURE_EXTERNAL,
+          true, false);
+  window_ = new Surface(producer);
+
+  surfaces_[0] = SurfaceWindowPair(eglCreateWindowSurface(display(), config, window_.get(), NULL), NULL);
+  if (CheckEGLError("eglCreateWindowSurface")) return false;
+
+  // Create a context in share_env's share group, so that textures and shader
+  // programs uploaded by one branch are visible to the others. Framebuffer
+  // objects are not shared by EGL and remain per-environment.
+  EGLint context_attribs[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+  contexts_[0] = eglCreateContext(display(),
+                                  config,
+                                  share_env->context(),
+                                  context_attribs);
+  if (CheckEGLError("eglCreateContext")) return false;
+
+  created_context_ = created_surface_ = true;
+
+  return true;
+}
+
 bool GLEnv::IsActive() const {
   ALOGV("IsActive()");
   return context() == eglGetCurrentContext()
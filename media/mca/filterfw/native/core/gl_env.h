@@ -82,6 +82,15 @@ class GLEnv {
     // this context is active already.
     bool InitWithCurrentContext();
 
+    // Inits a new GL environment whose context shares objects (textures and
+    // shader programs, but not framebuffer objects) with share_env's context.
+    // Use one shared environment per worker thread to run filters of
+    // independent graph branches concurrently. The display remains owned by
+    // share_env, so environments created this way must be torn down before
+    // the environment they share with. You must call Activate() on the worker
+    // thread before performing any GL operations.
+    bool InitWithSharedContext(GLEnv* share_env);
+
     // Activates the environment, and makes the associated GL context the
     // current context. Creates the environment, if it has not been created
     // already. Returns true if the activation was successful.
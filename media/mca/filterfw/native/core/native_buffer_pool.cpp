@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2011 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/native_buffer_pool.h"
+
+namespace android {
+namespace filterfw {
+
+NativeBufferPool* NativeBufferPool::Instance() {
+  static NativeBufferPool* instance = new NativeBufferPool();
+  return instance;
+}
+
+NativeBufferPool::NativeBufferPool() : stats_() {
+}
+
+NativeBufferPool::~NativeBufferPool() {
+  for (std::map<int, std::vector<uint8_t*> >::iterator it = buckets_.begin();
+       it != buckets_.end();
+       ++it) {
+    for (size_t i = 0; i < it->second.size(); ++i)
+      delete[] it->second[i];
+  }
+}
+
+int NativeBufferPool::BucketCapacity(int size) {
+  if (size <= 0 || size > kMaxBucketCapacity)
+    return 0;
+  int capacity = kMinBucketCapacity;
+  while (capacity < size)
+    capacity <<= 1;
+  return capacity;
+}
+
+uint8_t* NativeBufferPool::Obtain(int size, int* capacity) {
+  if (size <= 0)
+    return NULL;
+
+  const int bucket_capacity = BucketCapacity(size);
+  if (bucket_capacity > 0) {
+    std::lock_guard<std::mutex> lock(lock_);
+    ++stats_.obtained;
+    std::vector<uint8_t*>& bucket = buckets_[bucket_capacity];
+    if (!bucket.empty()) {
+      uint8_t* data = bucket.back();
+      bucket.pop_back();
+      ++stats_.reused;
+      stats_.pooled_bytes -= bucket_capacity;
+      *capacity = bucket_capacity;
+      return data;
+    }
+  }
+
+  *capacity = bucket_capacity > 0 ? bucket_capacity : size;
+  return new uint8_t[*capacity];
+}
+
+void NativeBufferPool::Release(uint8_t* data, int capacity) {
+  if (!data)
+    return;
+
+  if (BucketCapacity(capacity) == capacity) {
+    std::lock_guard<std::mutex> lock(lock_);
+    std::vector<uint8_t*>& bucket = buckets_[capacity];
+    if (bucket.size() < kMaxBuffersPerBucket &&
+        stats_.pooled_bytes + capacity <= kMaxPooledBytes) {
+      bucket.push_back(data);
+      ++stats_.recycled;
+      stats_.pooled_bytes += capacity;
+      return;
+    }
+    ++stats_.dropped;
+  }
+
+  delete[] data;
+}
+
+NativeBufferPool::Stats NativeBufferPool::GetStats() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return stats_;
+}
+
+} // namespace filterfw
+} // namespace android
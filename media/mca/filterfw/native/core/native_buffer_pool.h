@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2011 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_FILTERFW_CORE_NATIVE_BUFFER_POOL_H
+#define ANDROID_FILTERFW_CORE_NATIVE_BUFFER_POOL_H
+
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace android {
+namespace filterfw {
+
+// A process-wide pool of heap buffers, bucketed by power-of-two capacity.
+// Frames of the same format recycle each other's buffers across graph
+// iterations instead of hitting the allocator once per frame. The pool is
+// bounded both per bucket and in total; buffers that do not fit are freed.
+class NativeBufferPool {
+  public:
+    // A snapshot of the pool counters, for occupancy reporting.
+    struct Stats {
+      int64_t obtained;      // total number of Obtain() calls
+      int64_t reused;        // Obtain() calls served from a bucket
+      int64_t recycled;      // Release() calls that kept the buffer pooled
+      int64_t dropped;       // poolable buffers freed because the pool was full
+      int64_t pooled_bytes;  // bytes currently held in buckets
+    };
+
+    // Returns the process-wide pool instance.
+    static NativeBufferPool* Instance();
+
+    // Returns a buffer of at least size bytes and stores its actual capacity
+    // in capacity. Returns NULL if size is not positive.
+    uint8_t* Obtain(int size, int* capacity);
+
+    // Takes back a buffer handed out by Obtain(), or any buffer allocated
+    // with new uint8_t[capacity]. Only buffers whose capacity is an exact
+    // bucket size are pooled; anything else is freed immediately, so a
+    // recycled buffer can never be smaller than its bucket promises.
+    void Release(uint8_t* data, int capacity);
+
+    // Returns a snapshot of the pool counters.
+    Stats GetStats() const;
+
+  private:
+    enum {
+      kMinBucketCapacity = 4096,
+      kMaxBucketCapacity = 16 * 1024 * 1024,
+      kMaxBuffersPerBucket = 8,
+      kMaxPooledBytes = 32 * 1024 * 1024,
+    };
+
+    NativeBufferPool();
+    ~NativeBufferPool();
+
+    // Rounds size up to the capacity of the bucket that serves it, or
+    // returns 0 if the size is outside the pooled range.
+    static int BucketCapacity(int size);
+
+    mutable std::mutex lock_;
+    std::map<int, std::vector<uint8_t*> > buckets_;
+    Stats stats_;
+
+    NativeBufferPool(const NativeBufferPool&) = delete;
+    NativeBufferPool& operator=(const NativeBufferPool&) = delete;
+};
+
+} // namespace filterfw
+} // namespace android
+
+#endif  // ANDROID_FILTERFW_CORE_NATIVE_BUFFER_POOL_H
@@ -16,15 +16,18 @@
 
 #include "core/native_frame.h"
 
+#include "core/native_buffer_pool.h"
+
 namespace android {
 namespace filterfw {
 
 NativeFrame::NativeFrame(int size) : data_(NULL), size_(size), capacity_(size) {
-  data_ = capacity_ == 0 ? NULL : new uint8_t[capacity_];
+  if (capacity_ > 0)
+    data_ = NativeBufferPool::Instance()->Obtain(size, &capacity_);
 }
 
 NativeFrame::~NativeFrame() {
-  delete[] data_;
+  NativeBufferPool::Instance()->Release(data_, capacity_);
 }
 
 bool NativeFrame::WriteData(const uint8_t* data, int offset, int size) {
@@ -36,7 +39,7 @@ bool NativeFrame::WriteData(const uint8_t* data, int offset, int size) {
 }
 
 bool NativeFrame::SetData(uint8_t* data, int size) {
-  delete[] data_;
+  NativeBufferPool::Instance()->Release(data_, capacity_);
   size_ = capacity_ = size;
   data_ = data;
   return true;
@@ -23,7 +23,8 @@ namespace android {
 namespace filterfw {
 
 // A NativeFrame stores data in a memory buffer (on the heap). It is used for
-// data processing on the CPU.
+// data processing on the CPU. Buffers are recycled through the
+// NativeBufferPool, so the capacity may exceed the requested size.
 class NativeFrame {
   public:
     // Create an empty native frame.
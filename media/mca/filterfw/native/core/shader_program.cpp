@@ -23,6 +23,8 @@
 #include "core/shader_program.h"
 #include "core/vertex_frame.h"
 
+#include <map>
+#include <mutex>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -52,6 +54,104 @@ static void GetTileCoords(const float* b, float x, float y, float* xt, float* yt
   *yt = w0 * b[1] + w1 * b[3] + w2 * b[5] + w3 * b[7];
 }
 
+// Program binary cache ////////////////////////////////////////////////////////
+// Process-wide cache of linked program binaries, keyed by the concatenated
+// shader sources. Rebuilding a filter graph recreates the same programs, so a
+// hit replaces the GLSL compile and link with a single glProgramBinaryOES
+// upload. Requires the OES_get_program_binary extension; without it the cache
+// stays empty and programs compile from source as before.
+class ProgramBinaryCache {
+  public:
+    static ProgramBinaryCache* Instance() {
+      static ProgramBinaryCache* instance = new ProgramBinaryCache();
+      return instance;
+    }
+
+    // Creates a program from the cached binary stored under the given key.
+    // Returns 0 if there is no such binary, or binaries are unsupported.
+    GLuint CreateProgram(const std::string& key) {
+      if (!supported_)
+        return 0;
+
+      std::lock_guard<std::mutex> lock(lock_);
+      std::map<std::string, Binary>::iterator iter = binaries_.find(key);
+      if (iter == binaries_.end())
+        return 0;
+
+      GLuint program = glCreateProgram();
+      if (!program)
+        return 0;
+
+      program_binary_(program,
+                      iter->second.format,
+                      &iter->second.data[0],
+                      iter->second.data.size());
+
+      GLint linked = 0;
+      glGetProgramiv(program, GL_LINK_STATUS, &linked);
+      if (linked != GL_TRUE) {
+        // The driver rejected the binary (e.g. after a driver update); drop
+        // it and let the caller compile from source again.
+        glDeleteProgram(program);
+        binaries_.erase(iter);
+        return 0;
+      }
+      return program;
+    }
+
+    // Stores the binary of the given linked program under the given key.
+    void StoreProgram(const std::string& key, GLuint program) {
+      if (!supported_ || program == 0)
+        return;
+
+      GLint length = 0;
+      glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+      if (length <= 0)
+        return;
+
+      Binary binary;
+      binary.format = GL_NONE;
+      binary.data.resize(length);
+      GLsizei written = 0;
+      get_program_binary_(program, length, &written, &binary.format,
+                          &binary.data[0]);
+      if (written != length || GLEnv::CheckGLError("glGetProgramBinaryOES"))
+        return;
+
+      std::lock_guard<std::mutex> lock(lock_);
+      binaries_[key].format = binary.format;
+      binaries_[key].data.swap(binary.data);
+    }
+
+  private:
+    struct Binary {
+      GLenum format;
+      std::vector<uint8_t> data;
+    };
+
+    ProgramBinaryCache()
+        : supported_(false),
+          get_program_binary_(NULL),
+          program_binary_(NULL) {
+      get_program_binary_ = reinterpret_cast<PFNGLGETPROGRAMBINARYOESPROC>(
+          eglGetProcAddress("glGetProgramBinaryOES"));
+      program_binary_ = reinterpret_cast<PFNGLPROGRAMBINARYOESPROC>(
+          eglGetProcAddress("glProgramBinaryOES"));
+
+      GLint format_count = 0;
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &format_count);
+      supported_ = get_program_binary_ != NULL &&
+                   program_binary_ != NULL &&
+                   format_count > 0;
+    }
+
+    std::mutex lock_;
+    std::map<std::string, Binary> binaries_;
+    bool supported_;
+    PFNGLGETPROGRAMBINARYOESPROC get_program_binary_;
+    PFNGLPROGRAMBINARYOESPROC program_binary_;
+};
+
 // VertexAttrib implementation /////////////////////////////////////////////////
 ShaderProgram::VertexAttrib::VertexAttrib()
   : is_const(true),
@@ -85,7 +185,8 @@ ShaderProgram::ShaderProgram(GLEnv* gl_env, const std::string& fragment_shader)
     clears_(false),
     blending_(false),
     sfactor_(GL_SRC_ALPHA),
-    dfactor_(GL_ONE_MINUS_SRC_ALPHA) {
+    dfactor_(GL_ONE_MINUS_SRC_ALPHA),
+    uniforms_dirty_(false) {
   SetDefaultCoords();
 }
 
@@ -109,7 +210,8 @@ ShaderProgram::ShaderProgram(GLEnv* gl_env,
     clears_(false),
     blending_(false),
     sfactor_(GL_SRC_ALPHA),
-    dfactor_(GL_ONE_MINUS_SRC_ALPHA) {
+    dfactor_(GL_ONE_MINUS_SRC_ALPHA),
+    uniforms_dirty_(false) {
   SetDefaultCoords();
 }
 
@@ -259,23 +361,33 @@ bool ShaderProgram::CompileAndLink() {
     return false;
   }
 
-  // Compile vertex shader
-  vertex_shader_ = CompileShader(GL_VERTEX_SHADER,
-                                 vertex_shader_source_.c_str());
-  if (!vertex_shader_) {
-    ALOGE("Shader compilation failed!");
-    return false;
-  }
+  // Try a cached program binary first; a hit skips compilation entirely.
+  const std::string cache_key =
+      vertex_shader_source_ + '\0' + fragment_shader_source_;
+  program_ = ProgramBinaryCache::Instance()->CreateProgram(cache_key);
+
+  if (program_ == 0) {
+    // Compile vertex shader
+    vertex_shader_ = CompileShader(GL_VERTEX_SHADER,
+                                   vertex_shader_source_.c_str());
+    if (!vertex_shader_) {
+      ALOGE("Shader compilation failed!");
+      return false;
+    }
 
-  // Compile fragment shader
-  fragment_shader_ = CompileShader(GL_FRAGMENT_SHADER,
-                                   fragment_shader_source_.c_str());
-  if (!fragment_shader_)
-    return false;
+    // Compile fragment shader
+    fragment_shader_ = CompileShader(GL_FRAGMENT_SHADER,
+                                     fragment_shader_source_.c_str());
+    if (!fragment_shader_)
+      return false;
+
+    // Link
+    GLuint shaders[2] = { vertex_shader_, fragment_shader_ };
+    program_ = LinkProgram(shaders, 2);
 
-  // Link
-  GLuint shaders[2] = { vertex_shader_, fragment_shader_ };
-  program_ = LinkProgram(shaders, 2);
+    // Cache the linked binary for the next program with the same source.
+    ProgramBinaryCache::Instance()->StoreProgram(cache_key, program_);
+  }
 
   // Scan for all uniforms in the program
   ScanUniforms();
@@ -548,11 +660,80 @@ void ShaderProgram::Yield() {
   glFinish();
 }
 
+bool ShaderProgram::PushUniforms() {
+  if (!uniforms_dirty_)
+    return true;
+
+  for (PendingUniformMap::iterator iter = pending_uniforms_.begin();
+       iter != pending_uniforms_.end();
+       ++iter) {
+    PendingUniform& value = iter->second;
+    if (!value.dirty)
+      continue;
+
+    const ProgramVar var = iter->first;
+    switch(value.type) {
+      case GL_INT:
+        glUniform1iv(var, value.n, &value.ints[0]);
+        break;
+
+      case GL_INT_VEC2:
+        glUniform2iv(var, value.n, &value.ints[0]);
+        break;
+
+      case GL_INT_VEC3:
+        glUniform3iv(var, value.n, &value.ints[0]);
+        break;
+
+      case GL_INT_VEC4:
+        glUniform4iv(var, value.n, &value.ints[0]);
+        break;
+
+      case GL_FLOAT:
+        glUniform1fv(var, value.n, &value.floats[0]);
+        break;
+
+      case GL_FLOAT_VEC2:
+        glUniform2fv(var, value.n, &value.floats[0]);
+        break;
+
+      case GL_FLOAT_VEC3:
+        glUniform3fv(var, value.n, &value.floats[0]);
+        break;
+
+      case GL_FLOAT_VEC4:
+        glUniform4fv(var, value.n, &value.floats[0]);
+        break;
+
+      case GL_FLOAT_MAT2:
+        glUniformMatrix2fv(var, value.n, GL_FALSE, &value.floats[0]);
+        break;
+
+      case GL_FLOAT_MAT3:
+        glUniformMatrix3fv(var, value.n, GL_FALSE, &value.floats[0]);
+        break;
+
+      case GL_FLOAT_MAT4:
+        glUniformMatrix4fv(var, value.n, GL_FALSE, &value.floats[0]);
+        break;
+
+      default:
+        break;
+    };
+    value.dirty = false;
+  }
+  uniforms_dirty_ = false;
+  return !GLEnv::CheckGLError("Push Uniforms");
+}
+
 bool ShaderProgram::BeginDraw() {
   // Activate shader program
   if (!UseProgram())
     return false;
 
+  // Push dirty uniform values
+  PushUniforms();
+
   // Push vertex attributes
   PushAttributes();
 
@@ -672,24 +853,32 @@ bool ShaderProgram::SetUniformValue(ProgramVar var, int value) {
   if (!CheckVarValid(var))
     return false;
 
-  // Uniforms are local to the currently used program.
-  if (UseProgram()) {
-    glUniform1i(var, value);
-    return !GLEnv::CheckGLError("Set Uniform Value (int)");
-  }
-  return false;
+  // Defer the upload: it is flushed with the other dirty uniforms at the
+  // next draw.
+  PendingUniform& pending = pending_uniforms_[var];
+  pending.type = GL_INT;
+  pending.n = 1;
+  pending.ints.assign(1, value);
+  pending.floats.clear();
+  pending.dirty = true;
+  uniforms_dirty_ = true;
+  return true;
 }
 
 bool ShaderProgram::SetUniformValue(ProgramVar var, float value) {
   if (!CheckVarValid(var))
     return false;
 
-  // Uniforms are local to the currently used program.
-  if (UseProgram()) {
-    glUniform1f(var, value);
-    return !GLEnv::CheckGLError("Set Uniform Value (float)");
-  }
-  return false;
+  // Defer the upload: it is flushed with the other dirty uniforms at the
+  // next draw.
+  PendingUniform& pending = pending_uniforms_[var];
+  pending.type = GL_FLOAT;
+  pending.n = 1;
+  pending.floats.assign(1, value);
+  pending.ints.clear();
+  pending.dirty = true;
+  uniforms_dirty_ = true;
+  return true;
 }
 
 bool ShaderProgram::SetUniformValue(ProgramVar var,
@@ -702,45 +891,39 @@ bool ShaderProgram::SetUniformValue(ProgramVar var,
   if (count == 0)
     return false;
 
-  // Uniforms are local to the currently used program.
-  if (UseProgram()) {
-    // Get uniform information
-    GLint capacity;
-    GLenum type;
-    char name[128];
-    glGetActiveUniform(program_, IndexOfUniform(var), 128, NULL, &capacity, &type, name);
-
-    // Make sure passed values are compatible
-    const int components = GLEnv::NumberOfComponents(type);
-    if (!CheckValueCount("Uniform (int)", name, capacity, components, count)
-    ||  !CheckValueMult ("Uniform (int)", name, components, count))
-      return false;
-
-    // Set value based on type
-    const int n = count / components;
-    switch(type) {
-      case GL_INT:
-        glUniform1iv(var, n, values);
-        break;
-
-      case GL_INT_VEC2:
-        glUniform2iv(var, n, values);
-        break;
+  // Get uniform information
+  GLint capacity;
+  GLenum type;
+  char name[128];
+  glGetActiveUniform(program_, IndexOfUniform(var), 128, NULL, &capacity, &type, name);
 
-      case GL_INT_VEC3:
-        glUniform3iv(var, n, values);
-        break;
+  // Make sure passed values are compatible
+  const int components = GLEnv::NumberOfComponents(type);
+  if (!CheckValueCount("Uniform (int)", name, capacity, components, count)
+  ||  !CheckValueMult ("Uniform (int)", name, components, count))
+    return false;
 
-      case GL_INT_VEC4:
-        glUniform4iv(var, n, values);
-        break;
+  switch(type) {
+    case GL_INT:
+    case GL_INT_VEC2:
+    case GL_INT_VEC3:
+    case GL_INT_VEC4:
+      break;
 
-      default:
-        return false;
-    };
-    return !GLEnv::CheckGLError("Set Uniform Value");
-  }
-  return false;
+    default:
+      return false;
+  };
+
+  // Defer the upload: it is flushed with the other dirty uniforms at the
+  // next draw.
+  PendingUniform& pending = pending_uniforms_[var];
+  pending.type = type;
+  pending.n = count / components;
+  pending.ints.assign(values, values + count);
+  pending.floats.clear();
+  pending.dirty = true;
+  uniforms_dirty_ = true;
+  return true;
 }
 
 bool ShaderProgram::SetUniformValue(ProgramVar var,
@@ -753,57 +936,42 @@ bool ShaderProgram::SetUniformValue(ProgramVar var,
   if (count == 0)
     return false;
 
-  // Uniforms are local to the currently used program.
-  if (UseProgram()) {
-    // Get uniform information
-    GLint capacity;
-    GLenum type;
-    char name[128];
-    glGetActiveUniform(program_, IndexOfUniform(var), 128, NULL, &capacity, &type, name);
-
-    // Make sure passed values are compatible
-    const int components = GLEnv::NumberOfComponents(type);
-    if (!CheckValueCount("Uniform (float)", name, capacity, components, count)
-    ||  !CheckValueMult ("Uniform (float)", name, components, count))
-      return false;
-
-    // Set value based on type
-    const int n = count / components;
-    switch(type) {
-      case GL_FLOAT:
-        glUniform1fv(var, n, values);
-        break;
-
-      case GL_FLOAT_VEC2:
-        glUniform2fv(var, n, values);
-        break;
-
-      case GL_FLOAT_VEC3:
-        glUniform3fv(var, n, values);
-        break;
-
-      case GL_FLOAT_VEC4:
-        glUniform4fv(var, n, values);
-        break;
-
-      case GL_FLOAT_MAT2:
-        glUniformMatrix2fv(var, n, GL_FALSE, values);
-        break;
-
-      case GL_FLOAT_MAT3:
-        glUniformMatrix3fv(var, n, GL_FALSE, values);
-        break;
+  // Get uniform information
+  GLint capacity;
+  GLenum type;
+  char name[128];
+  glGetActiveUniform(program_, IndexOfUniform(var), 128, NULL, &capacity, &type, name);
 
-      case GL_FLOAT_MAT4:
-        glUniformMatrix4fv(var, n, GL_FALSE, values);
-        break;
+  // Make sure passed values are compatible
+  const int components = GLEnv::NumberOfComponents(type);
+  if (!CheckValueCount("Uniform (float)", name, capacity, components, count)
+  ||  !CheckValueMult ("Uniform (float)", name, components, count))
+    return false;
 
-      default:
-        return false;
-    };
-    return !GLEnv::CheckGLError("Set Uniform Value");
-  }
-  return false;
+  switch(type) {
+    case GL_FLOAT:
+    case GL_FLOAT_VEC2:
+    case GL_FLOAT_VEC3:
+    case GL_FLOAT_VEC4:
+    case GL_FLOAT_MAT2:
+    case GL_FLOAT_MAT3:
+    case GL_FLOAT_MAT4:
+      break;
+
+    default:
+      return false;
+  };
+
+  // Defer the upload: it is flushed with the other dirty uniforms at the
+  // next draw.
+  PendingUniform& pending = pending_uniforms_[var];
+  pending.type = type;
+  pending.n = count / components;
+  pending.floats.assign(values, values + count);
+  pending.ints.clear();
+  pending.dirty = true;
+  uniforms_dirty_ = true;
+  return true;
 }
 
 bool ShaderProgram::SetUniformValue(ProgramVar var, const std::vector<int>& values) {
@@ -829,6 +997,11 @@ bool ShaderProgram::SetUniformValue(const std::string& name, const Value& value)
 }
 
 Value ShaderProgram::GetUniformValue(const std::string& name) {
+  // Flush any deferred assignments first, so that we read back current
+  // values.
+  if (uniforms_dirty_ && UseProgram())
+    PushUniforms();
+
   ProgramVar var = GetUniform(name);
   if (CheckUniformValid(var)) {
     // Get uniform information
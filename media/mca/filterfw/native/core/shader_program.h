@@ -166,6 +166,10 @@ class ShaderProgram {
     // Such a type mismatch will result in failure to set the value (which will
     // remain untouched). Check the return value of the setters to determine
     // success.
+    // Values are validated when set, but uploaded to the driver in a single
+    // batch at the next draw. Repeated assignments to the same uniform between
+    // draws therefore cost one upload; errors the driver raises during the
+    // upload itself appear in the error log at draw time.
 
     // Returns the maximum number of uniforms supported by this implementation.
     static int MaxUniformCount();
@@ -433,6 +437,20 @@ class ShaderProgram {
       }
     };
 
+    // A uniform assignment that has been validated, but not yet uploaded to
+    // the driver. Dirty values are flushed in one batch by PushUniforms().
+    struct PendingUniform {
+      GLenum type;                // the GL type the value is uploaded as
+      int n;                      // number of type-sized elements
+      std::vector<int> ints;      // value data for int types
+      std::vector<float> floats;  // value data for float types
+      bool dirty;
+
+      PendingUniform() : type(GL_NONE), n(0), dirty(false) {
+      }
+    };
+    typedef std::map<ProgramVar, PendingUniform> PendingUniformMap;
+
     // Scans for all uniforms in the shader and creates index -> id map.
     void ScanUniforms();
 
@@ -494,6 +512,9 @@ class ShaderProgram {
     // Push all assigned attributes before rendering.
     bool PushAttributes();
 
+    // Upload all dirty uniform values to the (active) program.
+    bool PushUniforms();
+
     // Pop all assigned attributes after rendering.
     bool PopAttributes();
 
@@ -545,6 +566,12 @@ class ShaderProgram {
 
     // Map from uniform ids to indices
     std::map<ProgramVar, GLuint> uniform_indices_;
+
+    // Uniform values waiting to be uploaded at the next draw.
+    PendingUniformMap pending_uniforms_;
+
+    // True, iff pending_uniforms_ contains at least one dirty value.
+    bool uniforms_dirty_;
 };
 
 } // namespace filterfw
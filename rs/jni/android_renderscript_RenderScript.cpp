@@ -2194,6 +2194,186 @@ nScriptReduce(JNIEnv *_env, jobject _this, jlong con, jlong script, jint slot,
     }
 }
 
+// Opcodes for nScriptExecBatch. Must match the constants in
+// android.renderscript.RenderScript.
+enum {
+    BATCH_OP_ALLOCATION_SYNC_ALL = 1,
+    BATCH_OP_SCRIPT_FOR_EACH     = 2,
+};
+
+// Executes a batch of queued commands with a single JNI crossing. The
+// command stream is a flat int array; object handles are passed once in
+// 'handles' and referenced by index, and kernel parameter blobs are
+// passed once in 'params' and referenced by (offset, length) slices.
+//
+// BATCH_OP_ALLOCATION_SYNC_ALL:
+//   [op, allocIndex, bits]
+// BATCH_OP_SCRIPT_FOR_EACH:
+//   [op, scriptIndex, slot, aoutIndex (-1 for none), paramOffset,
+//    paramLength (0 for none), inCount, hasLimits,
+//    (6 limit ints if hasLimits), (inCount input allocIndexes)]
+static void
+nScriptExecBatch(JNIEnv *_env, jobject _this, jlong con, jintArray commands,
+                 jlongArray handles, jbyteArray params)
+{
+    if (kLogApi) {
+        ALOGD("nScriptExecBatch, con(%p), commands(%p), handles(%p), params(%p)",
+              (RsContext)con, commands, handles, params);
+    }
+
+    if (commands == nullptr || handles == nullptr) {
+        ALOGE("Batch command stream requires commands and handles.");
+        // TODO (b/20758983): Report back to Java and throw an exception
+        return;
+    }
+
+    const jint cmd_len = _env->GetArrayLength(commands);
+    jint *cmd_ptr = _env->GetIntArrayElements(commands, nullptr);
+    if (cmd_ptr == nullptr) {
+        ALOGE("Failed to get Java array elements");
+        // TODO (b/20758983): Report back to Java and throw an exception
+        return;
+    }
+
+    const jint handle_len = _env->GetArrayLength(handles);
+    jlong *handle_ptr = _env->GetLongArrayElements(handles, nullptr);
+    if (handle_ptr == nullptr) {
+        ALOGE("Failed to get Java array elements");
+        // TODO (b/20758983): Report back to Java and throw an exception
+        _env->ReleaseIntArrayElements(commands, cmd_ptr, JNI_ABORT);
+        return;
+    }
+
+    jint param_len = 0;
+    jbyte *param_ptr = nullptr;
+    if (params != nullptr) {
+        param_len = _env->GetArrayLength(params);
+        param_ptr = _env->GetByteArrayElements(params, nullptr);
+        if (param_ptr == nullptr) {
+            ALOGE("Failed to get Java array elements");
+            // TODO (b/20758983): Report back to Java and throw an exception
+            _env->ReleaseLongArrayElements(handles, handle_ptr, JNI_ABORT);
+            _env->ReleaseIntArrayElements(commands, cmd_ptr, JNI_ABORT);
+            return;
+        }
+    }
+
+    jint pos = 0;
+    while (pos < cmd_len) {
+        const jint op = cmd_ptr[pos++];
+        switch (op) {
+        case BATCH_OP_ALLOCATION_SYNC_ALL: {
+            if (pos + 2 > cmd_len) {
+                ALOGE("Malformed batch command stream: truncated sync at %i.", pos - 1);
+                goto batch_done;
+            }
+            const jint allocIndex = cmd_ptr[pos++];
+            const jint bits = cmd_ptr[pos++];
+            if (allocIndex < 0 || allocIndex >= handle_len) {
+                ALOGE("Malformed batch command stream: bad handle index %i.", allocIndex);
+                goto batch_done;
+            }
+            rsAllocationSyncAll((RsContext)con, (RsAllocation)handle_ptr[allocIndex],
+                                (RsAllocationUsageType)bits);
+            break;
+        }
+
+        case BATCH_OP_SCRIPT_FOR_EACH: {
+            if (pos + 7 > cmd_len) {
+                ALOGE("Malformed batch command stream: truncated launch at %i.", pos - 1);
+                goto batch_done;
+            }
+            const jint scriptIndex = cmd_ptr[pos++];
+            const jint slot = cmd_ptr[pos++];
+            const jint aoutIndex = cmd_ptr[pos++];
+            const jint paramOffset = cmd_ptr[pos++];
+            const jint paramLength = cmd_ptr[pos++];
+            const jint inCount = cmd_ptr[pos++];
+            const jint hasLimits = cmd_ptr[pos++];
+
+            if (scriptIndex < 0 || scriptIndex >= handle_len) {
+                ALOGE("Malformed batch command stream: bad handle index %i.", scriptIndex);
+                goto batch_done;
+            }
+            if (aoutIndex < -1 || aoutIndex >= handle_len) {
+                ALOGE("Malformed batch command stream: bad handle index %i.", aoutIndex);
+                goto batch_done;
+            }
+            if (paramLength < 0 || paramOffset < 0 || paramOffset > param_len - paramLength) {
+                ALOGE("Malformed batch command stream: bad parameter slice (%i, %i).",
+                      paramOffset, paramLength);
+                goto batch_done;
+            }
+            if (inCount < 0 || inCount > (jint)RS_KERNEL_MAX_ARGUMENTS) {
+                ALOGE("Too many arguments in kernel launch.");
+                // TODO (b/20758983): Report back to Java and throw an exception
+                goto batch_done;
+            }
+
+            RsScriptCall sc, *sca = nullptr;
+            uint32_t sc_size = 0;
+            if (hasLimits != 0) {
+                if (pos + 6 > cmd_len) {
+                    ALOGE("Malformed batch command stream: truncated limits at %i.", pos);
+                    goto batch_done;
+                }
+                sc.xStart     = cmd_ptr[pos++];
+                sc.xEnd       = cmd_ptr[pos++];
+                sc.yStart     = cmd_ptr[pos++];
+                sc.yEnd       = cmd_ptr[pos++];
+                sc.zStart     = cmd_ptr[pos++];
+                sc.zEnd       = cmd_ptr[pos++];
+                sc.strategy   = RS_FOR_EACH_STRATEGY_DONT_CARE;
+                sc.arrayStart = 0;
+                sc.arrayEnd = 0;
+                sc.array2Start = 0;
+                sc.array2End = 0;
+                sc.array3Start = 0;
+                sc.array3End = 0;
+                sc.array4Start = 0;
+                sc.array4End = 0;
+
+                sca = &sc;
+                sc_size = sizeof(sc);
+            }
+
+            RsAllocation in_allocs[RS_KERNEL_MAX_ARGUMENTS];
+            if (pos + inCount > cmd_len) {
+                ALOGE("Malformed batch command stream: truncated inputs at %i.", pos);
+                goto batch_done;
+            }
+            for (jint index = 0; index < inCount; index++) {
+                const jint inIndex = cmd_ptr[pos++];
+                if (inIndex < 0 || inIndex >= handle_len) {
+                    ALOGE("Malformed batch command stream: bad handle index %i.", inIndex);
+                    goto batch_done;
+                }
+                in_allocs[index] = (RsAllocation)handle_ptr[inIndex];
+            }
+
+            RsAllocation aout = (aoutIndex >= 0) ? (RsAllocation)handle_ptr[aoutIndex] : nullptr;
+
+            rsScriptForEachMulti((RsContext)con, (RsScript)handle_ptr[scriptIndex], slot,
+                                 in_allocs, inCount, aout,
+                                 (paramLength > 0) ? param_ptr + paramOffset : nullptr,
+                                 paramLength, sca, sc_size);
+            break;
+        }
+
+        default:
+            ALOGE("Malformed batch command stream: unknown opcode %i.", op);
+            goto batch_done;
+        }
+    }
+
+batch_done:
+    if (param_ptr != nullptr) {
+        _env->ReleaseByteArrayElements(params, param_ptr, JNI_ABORT);
+    }
+    _env->ReleaseLongArrayElements(handles, handle_ptr, JNI_ABORT);
+    _env->ReleaseIntArrayElements(commands, cmd_ptr, JNI_ABORT);
+}
+
 // -----------------------------------
 
 static jlong
@@ -2902,6 +3082,7 @@ static const JNINativeMethod methods[] = {
 
 {"rsnScriptForEach",                 "(JJI[JJ[B[I)V",                         (void*)nScriptForEach },
 {"rsnScriptReduce",                  "(JJI[JJ[I)V",                           (void*)nScriptReduce },
+{"rsnScriptExecBatch",               "(J[I[J[B)V",                            (void*)nScriptExecBatch },
 
 {"rsnScriptSetVarI",                 "(JJII)V",                               (void*)nScriptSetVarI },
 {"rsnScriptGetVarI",                 "(JJI)I",                                (void*)nScriptGetVarI },
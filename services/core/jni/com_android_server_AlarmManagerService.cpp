@@ -41,6 +41,10 @@
 
 #include <array>
 #include <memory>
+#include <mutex>
+#include <queue>
+#include <unordered_set>
+#include <vector>
 
 namespace android {
 
@@ -71,6 +75,28 @@ static const clockid_t android_alarm_to_clockid[N_ANDROID_TIMERFDS] = {
 
 typedef std::array<int, N_ANDROID_TIMERFDS> TimerFds;
 
+/* An alarm registered in the native min-heaps, in the clock domain of its
+   alarm type. Ordering is earliest-deadline-first. */
+struct PendingAlarm
+{
+    int64_t id;
+    int type;
+    struct timespec deadline;
+};
+
+static inline bool timespec_lte(const struct timespec &a, const struct timespec &b)
+{
+    return a.tv_sec < b.tv_sec || (a.tv_sec == b.tv_sec && a.tv_nsec <= b.tv_nsec);
+}
+
+struct PendingAlarmLater
+{
+    bool operator()(const PendingAlarm &a, const PendingAlarm &b) const
+    {
+        return !timespec_lte(a.deadline, b.deadline);
+    }
+};
+
 class AlarmImpl
 {
 public:
@@ -83,10 +109,28 @@ public:
     int waitForAlarm();
     int getTime(int type, struct itimerspec *spec);
 
+    int addAlarm(int type, const struct timespec &deadline, int64_t id);
+    bool removeAlarm(int64_t id);
+    size_t collectExpiredAlarms(int typeMask, int64_t windowMillis,
+            std::vector<int64_t> &outIds, size_t maxCount);
+    void getWakeStats(int64_t *outWakeups, int64_t *outDelivered, int64_t *outMaxBatch);
+
 private:
+    typedef std::priority_queue<PendingAlarm, std::vector<PendingAlarm>, PendingAlarmLater>
+            AlarmHeap;
+
+    void rearmLocked(int type);
+
     const TimerFds fds;
     const int epollfd;
     const int rtc_id;
+
+    std::mutex heap_lock;
+    AlarmHeap heaps[ANDROID_ALARM_TYPE_COUNT];
+    std::unordered_set<int64_t> removed_ids;
+    int64_t wakeup_count = 0;
+    int64_t delivered_count = 0;
+    int64_t max_batch = 0;
 };
 
 AlarmImpl::~AlarmImpl()
@@ -210,6 +254,105 @@ int AlarmImpl::waitForAlarm()
     return result;
 }
 
+/* Re-arms the timerfd for an alarm type to its earliest pending deadline,
+   discarding alarms that were removed while queued. The heap lock must be
+   held. */
+void AlarmImpl::rearmLocked(int type)
+{
+    AlarmHeap &heap = heaps[type];
+    while (!heap.empty() && removed_ids.erase(heap.top().id)) {
+        heap.pop();
+    }
+    if (heap.empty()) {
+        return;
+    }
+
+    struct timespec ts = heap.top().deadline;
+    if (set(type, &ts) < 0) {
+        ALOGE("Unable to re-arm timer %d: %s\n", type, strerror(errno));
+    }
+}
+
+int AlarmImpl::addAlarm(int type, const struct timespec &deadline, int64_t id)
+{
+    if (static_cast<size_t>(type) >= ANDROID_ALARM_TYPE_COUNT) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(heap_lock);
+    removed_ids.erase(id);
+
+    AlarmHeap &heap = heaps[type];
+    bool earliest = heap.empty() || !timespec_lte(heap.top().deadline, deadline);
+    heap.push({id, type, deadline});
+    if (earliest) {
+        struct timespec ts = deadline;
+        return set(type, &ts);
+    }
+    return 0;
+}
+
+bool AlarmImpl::removeAlarm(int64_t id)
+{
+    /* Removal is lazy: the id is dropped when it reaches the top of its heap.
+       A stale timerfd programming at worst causes one spurious wake. */
+    std::lock_guard<std::mutex> lock(heap_lock);
+    return removed_ids.insert(id).second;
+}
+
+size_t AlarmImpl::collectExpiredAlarms(int typeMask, int64_t windowMillis,
+        std::vector<int64_t> &outIds, size_t maxCount)
+{
+    std::lock_guard<std::mutex> lock(heap_lock);
+
+    for (size_t type = 0; type < ANDROID_ALARM_TYPE_COUNT; type++) {
+        if (!(typeMask & (1 << type))) {
+            continue;
+        }
+
+        struct timespec horizon;
+        if (clock_gettime(android_alarm_to_clockid[type], &horizon) < 0) {
+            continue;
+        }
+        horizon.tv_sec += windowMillis / 1000LL;
+        horizon.tv_nsec += (windowMillis % 1000LL) * 1000000LL;
+        if (horizon.tv_nsec >= 1000000000LL) {
+            horizon.tv_sec++;
+            horizon.tv_nsec -= 1000000000LL;
+        }
+
+        AlarmHeap &heap = heaps[type];
+        while (!heap.empty() && outIds.size() < maxCount) {
+            if (removed_ids.erase(heap.top().id)) {
+                heap.pop();
+                continue;
+            }
+            if (!timespec_lte(heap.top().deadline, horizon)) {
+                break;
+            }
+            outIds.push_back(heap.top().id);
+            heap.pop();
+        }
+        rearmLocked(type);
+    }
+
+    wakeup_count++;
+    delivered_count += outIds.size();
+    if (static_cast<int64_t>(outIds.size()) > max_batch) {
+        max_batch = outIds.size();
+    }
+    return outIds.size();
+}
+
+void AlarmImpl::getWakeStats(int64_t *outWakeups, int64_t *outDelivered, int64_t *outMaxBatch)
+{
+    std::lock_guard<std::mutex> lock(heap_lock);
+    *outWakeups = wakeup_count;
+    *outDelivered = delivered_count;
+    *outMaxBatch = max_batch;
+}
+
 static jint android_server_AlarmManagerService_setKernelTime(JNIEnv*, jobject, jlong nativeData, jlong millis)
 {
     AlarmImpl *impl = reinterpret_cast<AlarmImpl *>(nativeData);
@@ -451,12 +594,85 @@ static jint android_server_AlarmManagerService_waitForAlarm(JNIEnv*, jobject, jl
     return result;
 }
 
+static jint android_server_AlarmManagerService_addAlarm(JNIEnv*, jobject, jlong nativeData,
+        jint type, jlong seconds, jlong nanoseconds, jlong alarmId)
+{
+    AlarmImpl *impl = reinterpret_cast<AlarmImpl *>(nativeData);
+    struct timespec ts;
+    ts.tv_sec = seconds;
+    ts.tv_nsec = nanoseconds;
+
+    const int result = impl->addAlarm(type, ts, alarmId);
+    if (result < 0)
+    {
+        ALOGE("Unable to add alarm %lld at %lld.%09lld: %s\n",
+              static_cast<long long>(alarmId), static_cast<long long>(seconds),
+              static_cast<long long>(nanoseconds), strerror(errno));
+    }
+    return result >= 0 ? 0 : errno;
+}
+
+static jboolean android_server_AlarmManagerService_removeAlarm(JNIEnv*, jobject, jlong nativeData,
+        jlong alarmId)
+{
+    AlarmImpl *impl = reinterpret_cast<AlarmImpl *>(nativeData);
+    return impl->removeAlarm(alarmId);
+}
+
+/* Blocks until an alarm fires, then drains every registered alarm whose
+   deadline falls within windowMillis of the wake into alarmIdsOut. Returns the
+   expiration mask (including the time change bit) in the upper 32 bits and the
+   number of alarm ids written in the lower 32 bits, so one call per wake
+   replaces a wait plus a managed-heap scan. */
+static jlong android_server_AlarmManagerService_waitForAlarmBatch(JNIEnv* env, jobject,
+        jlong nativeData, jlong windowMillis, jlongArray alarmIdsOut)
+{
+    AlarmImpl *impl = reinterpret_cast<AlarmImpl *>(nativeData);
+    int result = 0;
+
+    do
+    {
+        result = impl->waitForAlarm();
+    } while (result < 0 && errno == EINTR);
+
+    if (result < 0)
+    {
+        ALOGE("Unable to wait on alarm: %s\n", strerror(errno));
+        return 0;
+    }
+
+    jsize capacity = env->GetArrayLength(alarmIdsOut);
+    std::vector<int64_t> ids;
+    size_t count = impl->collectExpiredAlarms(result, windowMillis, ids,
+            static_cast<size_t>(capacity));
+    if (count != 0) {
+        env->SetLongArrayRegion(alarmIdsOut, 0, count,
+                reinterpret_cast<const jlong *>(ids.data()));
+    }
+    return (static_cast<jlong>(result) << 32) | static_cast<jlong>(count);
+}
+
+static void android_server_AlarmManagerService_getWakeStats(JNIEnv* env, jobject,
+        jlong nativeData, jlongArray statsOut)
+{
+    AlarmImpl *impl = reinterpret_cast<AlarmImpl *>(nativeData);
+    int64_t stats[3];
+    impl->getWakeStats(&stats[0], &stats[1], &stats[2]);
+    if (env->GetArrayLength(statsOut) >= 3) {
+        env->SetLongArrayRegion(statsOut, 0, 3, reinterpret_cast<const jlong *>(stats));
+    }
+}
+
 static const JNINativeMethod sMethods[] = {
      /* name, signature, funcPtr */
     {"init", "()J", (void*)android_server_AlarmManagerService_init},
     {"close", "(J)V", (void*)android_server_AlarmManagerService_close},
     {"set", "(JIJJ)I", (void*)android_server_AlarmManagerService_set},
     {"waitForAlarm", "(J)I", (void*)android_server_AlarmManagerService_waitForAlarm},
+    {"addAlarm", "(JIJJJ)I", (void*)android_server_AlarmManagerService_addAlarm},
+    {"removeAlarm", "(JJ)Z", (void*)android_server_AlarmManagerService_removeAlarm},
+    {"waitForAlarmBatch", "(JJ[J)J", (void*)android_server_AlarmManagerService_waitForAlarmBatch},
+    {"getWakeStats", "(J[J)V", (void*)android_server_AlarmManagerService_getWakeStats},
     {"setKernelTime", "(JJ)I", (void*)android_server_AlarmManagerService_setKernelTime},
     {"setKernelTimezone", "(JI)I", (void*)android_server_AlarmManagerService_setKernelTimezone},
     {"getNextAlarm", "(JI)J", (void*)android_server_AlarmManagerService_getNextAlarm},
@@ -23,6 +23,7 @@
 #include "android_runtime/Log.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <asm/byteorder.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -31,6 +32,11 @@
 
 #include <usbhost/usbhost.h>
 
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
 #define MAX_DESCRIPTORS_LENGTH 4096
 
 namespace android
@@ -42,9 +48,21 @@ static struct parcel_file_descriptor_offsets_t
     jmethodID mConstructor;
 } gParcelFileDescriptorOffsets;
 
+static jclass class_string;
 static jmethodID method_usbDeviceAdded;
 static jmethodID method_usbDeviceRemoved;
 
+// Manufacturer/product strings keyed by (vendor id << 16 | product id).
+// Fetching them costs one control transfer each, and every port of a hub
+// carrying identical devices would otherwise repeat the same transfers
+// during an enumeration storm. Serial numbers identify the unit, so they
+// are always read fresh. Only touched on the usb host thread, but guarded
+// anyway since the cache is process state.
+static std::mutex gDeviceStringCacheLock;
+static std::unordered_map<uint32_t, std::pair<std::string, std::string>> gDeviceStringCache;
+static constexpr size_t kMaxCachedDeviceStrings = 64;
+static constexpr int kStringReadTimeoutMs = 500;
+
 static void checkAndClearExceptionFromCallback(JNIEnv* env, const char* methodName) {
     if (env->ExceptionCheck()) {
         ALOGE("An exception was thrown by callback '%s'.", methodName);
@@ -75,9 +93,65 @@ static int usb_device_added(const char *devAddress, void* clientData) {
         const jbyte* rawDescriptors = (const jbyte*)usb_device_get_raw_descriptors(device);
         env->SetByteArrayRegion(descriptorsArray, 0, numBytes, rawDescriptors);
 
+        // Read the standard strings while the device is already open so the
+        // Java side does not reopen it for per-string control transfers.
+        const uint32_t cacheKey =
+                ((uint32_t)__le16_to_cpu(deviceDesc->idVendor) << 16) |
+                __le16_to_cpu(deviceDesc->idProduct);
+        std::string manufacturer;
+        std::string product;
+        bool cached = false;
+        {
+            std::lock_guard<std::mutex> lock(gDeviceStringCacheLock);
+            auto it = gDeviceStringCache.find(cacheKey);
+            if (it != gDeviceStringCache.end()) {
+                manufacturer = it->second.first;
+                product = it->second.second;
+                cached = true;
+            }
+        }
+        if (!cached) {
+            char* str = usb_device_get_manufacturer_name(device, kStringReadTimeoutMs);
+            if (str) {
+                manufacturer = str;
+                free(str);
+            }
+            str = usb_device_get_product_name(device, kStringReadTimeoutMs);
+            if (str) {
+                product = str;
+                free(str);
+            }
+            std::lock_guard<std::mutex> lock(gDeviceStringCacheLock);
+            if (gDeviceStringCache.size() >= kMaxCachedDeviceStrings) {
+                gDeviceStringCache.clear();
+            }
+            gDeviceStringCache[cacheKey] = std::make_pair(manufacturer, product);
+        }
+        char* serial = usb_device_get_serial(device, kStringReadTimeoutMs);
+
+        // [manufacturer, product, serial]; empty reads stay null.
+        jobjectArray stringsArray = env->NewObjectArray(3, class_string, NULL);
+        if (!manufacturer.empty()) {
+            jstring str = env->NewStringUTF(manufacturer.c_str());
+            env->SetObjectArrayElement(stringsArray, 0, str);
+            env->DeleteLocalRef(str);
+        }
+        if (!product.empty()) {
+            jstring str = env->NewStringUTF(product.c_str());
+            env->SetObjectArrayElement(stringsArray, 1, str);
+            env->DeleteLocalRef(str);
+        }
+        if (serial) {
+            jstring str = env->NewStringUTF(serial);
+            env->SetObjectArrayElement(stringsArray, 2, str);
+            env->DeleteLocalRef(str);
+            free(serial);
+        }
+
         env->CallBooleanMethod(thiz, method_usbDeviceAdded,
-                deviceAddress, classID, subClassID, descriptorsArray);
+                deviceAddress, classID, subClassID, descriptorsArray, stringsArray);
 
+        env->DeleteLocalRef(stringsArray);
         env->DeleteLocalRef(descriptorsArray);
         env->DeleteLocalRef(deviceAddress);
 
@@ -154,11 +228,13 @@ int register_android_server_UsbHostManager(JNIEnv *env)
         return -1;
     }
     method_usbDeviceAdded =
-            env->GetMethodID(clazz, "usbDeviceAdded", "(Ljava/lang/String;II[B)Z");
+            env->GetMethodID(clazz, "usbDeviceAdded",
+                    "(Ljava/lang/String;II[B[Ljava/lang/String;)Z");
     if (method_usbDeviceAdded == NULL) {
         ALOGE("Can't find beginUsbDeviceAdded");
         return -1;
     }
+    class_string = (jclass)env->NewGlobalRef(env->FindClass("java/lang/String"));
     method_usbDeviceRemoved = env->GetMethodID(clazz, "usbDeviceRemoved",
             "(Ljava/lang/String;)V");
     if (method_usbDeviceRemoved == NULL) {
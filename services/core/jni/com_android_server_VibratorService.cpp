@@ -33,6 +33,9 @@
 #include <inttypes.h>
 #include <stdio.h>
 
+#include <mutex>
+#include <unordered_map>
+
 using android::hardware::Return;
 using android::hardware::Void;
 using android::hardware::vibrator::V1_0::EffectStrength;
@@ -429,17 +432,24 @@ static aidl::CompositeEffect effectFromJavaPrimitive(JNIEnv* env, jobject primit
     return effect;
 }
 
-static void vibratorPerformComposedEffect(JNIEnv* env, jclass, jobjectArray composition,
-                                   jobject vibration) {
-    auto hal = getHal<aidl::IVibrator>();
-    if (!hal) {
-        return;
-    }
+static std::vector<aidl::CompositeEffect> compileComposition(JNIEnv* env,
+        jobjectArray composition) {
     size_t size = env->GetArrayLength(composition);
     std::vector<aidl::CompositeEffect> effects;
+    effects.reserve(size);
     for (size_t i = 0; i < size; i++) {
         jobject element = env->GetObjectArrayElement(composition, i);
         effects.push_back(effectFromJavaPrimitive(env, element));
+        env->DeleteLocalRef(element);
+    }
+    return effects;
+}
+
+static void composeEffects(JNIEnv* env, const std::vector<aidl::CompositeEffect>& effects,
+        jobject vibration) {
+    auto hal = getHal<aidl::IVibrator>();
+    if (!hal) {
+        return;
     }
     sp<AidlVibratorCallback> effectCallback = new AidlVibratorCallback(env, vibration);
 
@@ -451,6 +461,49 @@ static void vibratorPerformComposedEffect(JNIEnv* env, jclass, jobjectArray comp
     }
 }
 
+static void vibratorPerformComposedEffect(JNIEnv* env, jclass, jobjectArray composition,
+                                   jobject vibration) {
+    composeEffects(env, compileComposition(env, composition), vibration);
+}
+
+// Compiled compositions keyed by a caller-computed 64-bit content hash.
+// Feedback effects (keyboard haptics) replay the same short compositions
+// hundreds of times a minute; on a hit the per-primitive JNI field reads and
+// the vector rebuild are skipped entirely. Bounded by wholesale eviction, the
+// same as the other fixed-size native caches.
+static std::mutex gCompiledEffectsLock;
+static std::unordered_map<jlong, std::vector<aidl::CompositeEffect>> gCompiledEffects;
+static constexpr size_t kMaxCompiledEffects = 64;
+
+static void vibratorPerformComposedEffectCached(JNIEnv* env, jclass, jlong effectHash,
+                                   jobjectArray composition, jobject vibration) {
+    const size_t size = env->GetArrayLength(composition);
+    std::vector<aidl::CompositeEffect> effects;
+    {
+        std::lock_guard<std::mutex> lock(gCompiledEffectsLock);
+        auto it = gCompiledEffects.find(effectHash);
+        // The length check guards against a caller whose hash collides across
+        // different compositions. The HAL call happens outside the lock.
+        if (it != gCompiledEffects.end() && it->second.size() == size) {
+            effects = it->second;
+        }
+    }
+    if (!effects.empty()) {
+        composeEffects(env, effects, vibration);
+        return;
+    }
+
+    effects = compileComposition(env, composition);
+    {
+        std::lock_guard<std::mutex> lock(gCompiledEffectsLock);
+        if (gCompiledEffects.size() >= kMaxCompiledEffects) {
+            gCompiledEffects.clear();
+        }
+        gCompiledEffects[effectHash] = effects;
+    }
+    composeEffects(env, effects, vibration);
+}
+
 static jlong vibratorGetCapabilities(JNIEnv*, jclass) {
     if (auto hal = getHal<aidl::IVibrator>()) {
         int32_t cap = 0;
@@ -491,6 +544,10 @@ static const JNINativeMethod method_table[] = {
          "([Landroid/os/VibrationEffect$Composition$PrimitiveEffect;Lcom/android/server/"
          "VibratorService$Vibration;)V",
          (void*)vibratorPerformComposedEffect},
+        {"vibratorPerformComposedEffectCached",
+         "(J[Landroid/os/VibrationEffect$Composition$PrimitiveEffect;Lcom/android/server/"
+         "VibratorService$Vibration;)V",
+         (void*)vibratorPerformComposedEffectCached},
         {"vibratorGetSupportedEffects", "()[I", (void*)vibratorGetSupportedEffects},
         {"vibratorSupportsExternalControl", "()Z", (void*)vibratorSupportsExternalControl},
         {"vibratorSetExternalControl", "(Z)V", (void*)vibratorSetExternalControl},
@@ -28,8 +28,10 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <android/hardware/power/1.0/IPower.h>
 #include <android/hardware/power/1.1/IPower.h>
@@ -245,6 +247,163 @@ static jint nativeWaitWakeup(JNIEnv *env, jobject clazz, jobject outBuf)
     return mergedreasonpos - mergedreason;
 }
 
+// ---- Columnar kernel wakeup source snapshot ----
+//
+// Parsing /d/wakeup_sources into per-wakelock Java objects on every poll is
+// a steady CPU tax. Instead the parse result is kept natively as one sample
+// per source, deltas against the previous poll are computed here, and the
+// whole snapshot is published column-major (one array per field) into a
+// direct buffer in a single JNI call. Sources keep their column index for
+// the life of the process, so the name table only needs to be re-fetched
+// when the generation in the snapshot header changes.
+
+#define WAKEUP_SOURCES_PATH "/d/wakeup_sources"
+#define WAKEUP_SOURCES_DEBUGFS_PATH "/sys/kernel/debug/wakeup_sources"
+
+struct WakeupSourceSample {
+    int64_t activeCount;
+    int64_t eventCount;
+    int64_t wakeupCount;
+    int64_t expireCount;
+    int64_t totalTimeMs;
+    int64_t preventSuspendTimeMs;
+};
+static constexpr int WAKEUP_SOURCE_FIELD_COUNT = 6;
+
+static std::mutex gWakeupSourceLock;
+static std::vector<std::string> gWakeupSourceNames;
+static std::unordered_map<std::string, size_t> gWakeupSourceIndex;
+static std::vector<WakeupSourceSample> gWakeupSourcePrev;
+static jint gWakeupSourceGeneration = 0;
+
+static int64_t wakeupSourceDelta(int64_t cur, int64_t prev) {
+    // A smaller current value means the kernel counter was reset.
+    return cur >= prev ? cur - prev : cur;
+}
+
+// Fills |outBuf| with: int32 sourceCount, int32 generation, then
+// WAKEUP_SOURCE_FIELD_COUNT columns of sourceCount int64 deltas each, in
+// WakeupSourceSample field order. Returns the source count, or -1 on error.
+static jint readWakeupSourceStats(JNIEnv *env, jobject clazz, jobject outBuf)
+{
+    if (outBuf == NULL) {
+        jniThrowException(env, "java/lang/NullPointerException", "null argument");
+        return -1;
+    }
+    char* out = (char*)env->GetDirectBufferAddress(outBuf);
+    jlong capacity = env->GetDirectBufferCapacity(outBuf);
+    if (out == NULL || capacity < 0) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                "buffer is not a direct buffer");
+        return -1;
+    }
+
+    FILE *fp = fopen(WAKEUP_SOURCES_PATH, "re");
+    if (fp == NULL) {
+        fp = fopen(WAKEUP_SOURCES_DEBUGFS_PATH, "re");
+    }
+    if (fp == NULL) {
+        ALOGE("Failed to open %s", WAKEUP_SOURCES_PATH);
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(gWakeupSourceLock);
+
+    // Parse the whole file, summing duplicate source names like the Java
+    // reader does, and registering newly seen sources.
+    std::unordered_map<size_t, WakeupSourceSample> current;
+    char line[256];
+    // Skip the header line.
+    if (fgets(line, sizeof(line), fp) == NULL) {
+        fclose(fp);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        char name[128];
+        int64_t activeCount, eventCount, wakeupCount, expireCount, activeSince;
+        int64_t totalTime, maxTime, lastChange, preventSuspendTime;
+        int matched = sscanf(line,
+                "%127s %" SCNd64 " %" SCNd64 " %" SCNd64 " %" SCNd64 " %" SCNd64
+                " %" SCNd64 " %" SCNd64 " %" SCNd64 " %" SCNd64,
+                name, &activeCount, &eventCount, &wakeupCount, &expireCount,
+                &activeSince, &totalTime, &maxTime, &lastChange, &preventSuspendTime);
+        if (matched < 9) {
+            continue;
+        }
+        if (matched == 9) {
+            // Older kernels have no prevent_suspend_time column.
+            preventSuspendTime = 0;
+        }
+
+        size_t index;
+        auto it = gWakeupSourceIndex.find(name);
+        if (it != gWakeupSourceIndex.end()) {
+            index = it->second;
+        } else {
+            index = gWakeupSourceNames.size();
+            gWakeupSourceNames.push_back(name);
+            gWakeupSourceIndex.emplace(name, index);
+            gWakeupSourcePrev.push_back({});
+            gWakeupSourceGeneration++;
+        }
+        WakeupSourceSample& sample = current[index];
+        sample.activeCount += activeCount;
+        sample.eventCount += eventCount;
+        sample.wakeupCount += wakeupCount;
+        sample.expireCount += expireCount;
+        sample.totalTimeMs += totalTime;
+        sample.preventSuspendTimeMs += preventSuspendTime;
+    }
+    fclose(fp);
+
+    const size_t count = gWakeupSourceNames.size();
+    const jlong needed = 2 * (jlong)sizeof(int32_t) +
+            (jlong)count * WAKEUP_SOURCE_FIELD_COUNT * sizeof(int64_t);
+    if (capacity < needed) {
+        ALOGE("Wakeup source snapshot needs %lld bytes, buffer has %lld",
+                (long long)needed, (long long)capacity);
+        return -1;
+    }
+
+    int32_t header[2] = { (int32_t)count, gWakeupSourceGeneration };
+    memcpy(out, header, sizeof(header));
+    int64_t* columns = (int64_t*)(out + sizeof(header));
+    // Sources absent from this poll keep their column slot with zero deltas.
+    memset(columns, 0, count * WAKEUP_SOURCE_FIELD_COUNT * sizeof(int64_t));
+    for (const auto& entry : current) {
+        const size_t i = entry.first;
+        const WakeupSourceSample& cur = entry.second;
+        WakeupSourceSample& prev = gWakeupSourcePrev[i];
+        columns[0 * count + i] = wakeupSourceDelta(cur.activeCount, prev.activeCount);
+        columns[1 * count + i] = wakeupSourceDelta(cur.eventCount, prev.eventCount);
+        columns[2 * count + i] = wakeupSourceDelta(cur.wakeupCount, prev.wakeupCount);
+        columns[3 * count + i] = wakeupSourceDelta(cur.expireCount, prev.expireCount);
+        columns[4 * count + i] = wakeupSourceDelta(cur.totalTimeMs, prev.totalTimeMs);
+        columns[5 * count + i] =
+                wakeupSourceDelta(cur.preventSuspendTimeMs, prev.preventSuspendTimeMs);
+        prev = cur;
+    }
+
+    return count;
+}
+
+// Returns the column-index-aligned source name table. Only needs to be
+// called when the generation reported by readWakeupSourceStats changes.
+static jobjectArray getWakeupSourceNames(JNIEnv *env, jobject clazz)
+{
+    std::lock_guard<std::mutex> lock(gWakeupSourceLock);
+    jobjectArray names = env->NewObjectArray(gWakeupSourceNames.size(),
+            env->FindClass("java/lang/String"), NULL);
+    if (names == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < gWakeupSourceNames.size(); i++) {
+        ScopedLocalRef<jstring> name(env, env->NewStringUTF(gWakeupSourceNames[i].c_str()));
+        env->SetObjectArrayElement(names, i, name.get());
+    }
+    return names;
+}
+
 // The caller must be holding gPowerHalMutex.
 static bool checkResultLocked(const Return<void> &ret, const char* function) {
     if (!ret.isOk()) {
@@ -947,6 +1106,8 @@ static void getRailEnergyPowerStats(JNIEnv* env, jobject /* clazz */, jobject jr
 
 static const JNINativeMethod method_table[] = {
     { "nativeWaitWakeup", "(Ljava/nio/ByteBuffer;)I", (void*)nativeWaitWakeup },
+    { "nativeReadWakeupSourceStats", "(Ljava/nio/ByteBuffer;)I", (void*)readWakeupSourceStats },
+    { "nativeGetWakeupSourceNames", "()[Ljava/lang/String;", (void*)getWakeupSourceNames },
     { "getLowPowerStats", "(Lcom/android/internal/os/RpmStats;)V", (void*)getLowPowerStats },
     { "getPlatformLowPowerStats", "(Ljava/nio/ByteBuffer;)I", (void*)getPlatformLowPowerStats },
     { "getSubsystemLowPowerStats", "(Ljava/nio/ByteBuffer;)I", (void*)getSubsystemLowPowerStats },
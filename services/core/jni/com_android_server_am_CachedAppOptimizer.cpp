@@ -19,11 +19,16 @@
 
 #include <dirent.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <string>
+#include <vector>
+
 #include <android-base/stringprintf.h>
 #include <android-base/file.h>
 
@@ -79,6 +84,82 @@ static void com_android_server_am_CachedAppOptimizer_compactSystem(JNIEnv *, job
     }
 }
 
+// Returns the resident set size of a process in bytes, or -1 if it cannot be
+// read (e.g. the process exited).
+static int64_t getProcessRss(int pid) {
+    std::string statm_path = StringPrintf("/proc/%d/statm", pid);
+    FILE* fp = fopen(statm_path.c_str(), "re");
+    if (fp == NULL) {
+        return -1;
+    }
+    long long totalPages, residentPages;
+    int matched = fscanf(fp, "%lld %lld", &totalPages, &residentPages);
+    fclose(fp);
+    if (matched != 2) {
+        return -1;
+    }
+    return residentPages * sysconf(_SC_PAGESIZE);
+}
+
+static int64_t monotonicTimeMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Compacts a prioritized list of processes in one JNI call, writing the given
+// action ("file", "anon" or "all") to /proc/pid/reclaim for each. Returns the
+// bytes of RSS reclaimed per pid, measured before/after each reclaim; entries
+// are 0 when nothing was reclaimed or the process vanished, and -1 for pids
+// that were skipped because the time budget ran out. Pids are processed in
+// array order, so the caller's highest-priority processes are compacted even
+// on a tight budget and it can resubmit the skipped tail later.
+static jlongArray com_android_server_am_CachedAppOptimizer_compactProcessBatch(
+        JNIEnv* env, jobject clazz, jintArray pidArray, jstring actionStr, jlong timeBudgetMs) {
+    jsize count = env->GetArrayLength(pidArray);
+    jlongArray resultArray = env->NewLongArray(count);
+    if (resultArray == NULL) {
+        return NULL;
+    }
+
+    const char* actionChars = env->GetStringUTFChars(actionStr, NULL);
+    if (actionChars == NULL) {
+        return NULL;
+    }
+    std::string action(actionChars);
+    env->ReleaseStringUTFChars(actionStr, actionChars);
+
+    std::vector<jint> pids(count);
+    env->GetIntArrayRegion(pidArray, 0, count, pids.data());
+    std::vector<jlong> reclaimed(count, -1);
+
+    const int64_t deadlineMs =
+            timeBudgetMs > 0 ? monotonicTimeMs() + timeBudgetMs : INT64_MAX;
+    for (jsize i = 0; i < count; i++) {
+        if (monotonicTimeMs() >= deadlineMs) {
+            break;
+        }
+        int pid = pids[i];
+        // Never compact system_server; see compactSystem above.
+        if (pid == getpid()) {
+            reclaimed[i] = 0;
+            continue;
+        }
+        int64_t rssBefore = getProcessRss(pid);
+        std::string reclaim_path = StringPrintf("/proc/%d/reclaim", pid);
+        if (!WriteStringToFile(action, reclaim_path)) {
+            reclaimed[i] = 0;
+            continue;
+        }
+        int64_t rssAfter = getProcessRss(pid);
+        reclaimed[i] = (rssBefore > 0 && rssAfter >= 0 && rssBefore > rssAfter)
+                ? rssBefore - rssAfter : 0;
+    }
+
+    env->SetLongArrayRegion(resultArray, 0, count, reclaimed.data());
+    return resultArray;
+}
+
 static void com_android_server_am_CachedAppOptimizer_enableFreezerInternal(
         JNIEnv *env, jobject clazz, jboolean enable) {
     bool success = true;
@@ -128,6 +209,8 @@ static jint com_android_server_am_CachedAppOptimizer_getBinderFreezeInfo(JNIEnv
 static const JNINativeMethod sMethods[] = {
     /* name, signature, funcPtr */
     {"compactSystem", "()V", (void*)com_android_server_am_CachedAppOptimizer_compactSystem},
+    {"compactProcessBatch", "([ILjava/lang/String;J)[J",
+        (void*)com_android_server_am_CachedAppOptimizer_compactProcessBatch},
     {"enableFreezerInternal", "(Z)V",
         (void*)com_android_server_am_CachedAppOptimizer_enableFreezerInternal},
     {"freezeBinder", "(IZ)V", (void*)com_android_server_am_CachedAppOptimizer_freezeBinder},
@@ -18,13 +18,21 @@
 
 #include <errno.h>
 #include <psi/psi.h>
+#include <stdio.h>
 #include <string.h>
 #include <sys/epoll.h>
+#include <sys/mman.h>
+#include <time.h>
 
 #include <jni.h>
 #include <nativehelper/JNIHelp.h>
+#include <nativehelper/ScopedPrimitiveArray.h>
 #include <utils/Log.h>
 
+#include <atomic>
+#include <new>
+#include <thread>
+
 namespace android {
 
 enum pressure_levels {
@@ -45,6 +53,193 @@ static constexpr int PSI_WINDOW_SIZE_US = 1000000;
 
 static int psi_epollfd = -1;
 
+// Configurable watch set. Unlike the fixed triggers above, these are set up
+// from Java with arbitrary (some/full, stall, window) tuples and serviced by
+// a native thread that publishes the current state into a page Java maps as
+// a direct ByteBuffer, so polling the level costs no JNI transition.
+static constexpr int MAX_WATCH_TRIGGERS = 8;
+
+// Layout of the level page. Written under a seqlock: kSeq is bumped to an odd
+// value before an update and an even value after, so a reader that sees the
+// same even value on both sides of its reads has a consistent snapshot.
+// All averages are in centi-percent to keep the page integer-only.
+struct MemPressurePage {
+    std::atomic<uint32_t> seq;
+    int32_t level;              // index of the highest firing trigger + 1, 0 = none
+    int32_t someAvg10;          // PSI some avg10
+    int32_t fullAvg10;          // PSI full avg10
+    int32_t fullAvg60;          // PSI full avg60
+    int32_t slope;              // someAvg10 trend, centi-percent per second
+    int64_t lastUpdateUptimeMs;
+};
+
+static MemPressurePage* watch_page = nullptr;
+static int watch_epollfd = -1;
+static int watch_trigger_count = 0;
+
+static int64_t uptime_millis() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static bool read_psi_averages(int32_t* some_avg10, int32_t* full_avg10, int32_t* full_avg60) {
+    FILE* file = fopen("/proc/pressure/memory", "re");
+    if (!file) {
+        return false;
+    }
+    char line[256];
+    bool found_some = false;
+    while (fgets(line, sizeof(line), file)) {
+        float avg10, avg60;
+        if (sscanf(line, "some avg10=%f avg60=%f", &avg10, &avg60) == 2) {
+            *some_avg10 = (int32_t)(avg10 * 100);
+            found_some = true;
+        } else if (sscanf(line, "full avg10=%f avg60=%f", &avg10, &avg60) == 2) {
+            *full_avg10 = (int32_t)(avg10 * 100);
+            *full_avg60 = (int32_t)(avg60 * 100);
+        }
+    }
+    fclose(file);
+    return found_some;
+}
+
+static void watch_loop() {
+    struct epoll_event events[MAX_WATCH_TRIGGERS];
+    int32_t level = 0;
+    int32_t prev_some_avg10 = -1;
+    int64_t prev_sample_ms = 0;
+
+    for (;;) {
+        // While pressure is up, re-evaluate every second like waitForPressure
+        // does; while quiet, wake occasionally anyway so the averages and the
+        // slope in the page stay fresh enough to predict the next episode.
+        int timeout_ms = level != 0 ? 1000 : 10000;
+        int nevents = TEMP_FAILURE_RETRY(
+            epoll_wait(watch_epollfd, events, watch_trigger_count, timeout_ms));
+        if (nevents == -1) {
+            ALOGE("epoll_wait failed while watching psi triggers: %s", strerror(errno));
+            return;
+        }
+
+        if (nevents == 0) {
+            level = 0;
+        }
+        for (int i = 0; i < nevents; i++) {
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                // should never happen unless psi got disabled in kernel
+                ALOGE("Memory pressure watch triggers are not available anymore");
+                return;
+            }
+            if ((int32_t)events[i].data.u32 > level) {
+                level = events[i].data.u32;
+            }
+        }
+
+        int32_t some_avg10 = 0;
+        int32_t full_avg10 = 0;
+        int32_t full_avg60 = 0;
+        int32_t slope = 0;
+        int64_t now_ms = uptime_millis();
+        if (read_psi_averages(&some_avg10, &full_avg10, &full_avg60)) {
+            if (prev_some_avg10 >= 0 && now_ms > prev_sample_ms) {
+                slope = (int32_t)((some_avg10 - prev_some_avg10) * 1000 /
+                                  (now_ms - prev_sample_ms));
+            }
+            prev_some_avg10 = some_avg10;
+            prev_sample_ms = now_ms;
+        }
+
+        uint32_t seq = watch_page->seq.load(std::memory_order_relaxed);
+        watch_page->seq.store(seq + 1, std::memory_order_release);
+        watch_page->level = level;
+        watch_page->someAvg10 = some_avg10;
+        watch_page->fullAvg10 = full_avg10;
+        watch_page->fullAvg60 = full_avg60;
+        watch_page->slope = slope;
+        watch_page->lastUpdateUptimeMs = now_ms;
+        watch_page->seq.store(seq + 2, std::memory_order_release);
+    }
+}
+
+// Sets up |count| psi triggers described by parallel arrays: full[i] selects
+// PSI_FULL over PSI_SOME, stallUs[i] and windowUs[i] are passed through to
+// init_psi_monitor. Trigger i reports as level i + 1, so callers should order
+// the tuples from least to most severe.
+static jint android_server_am_LowMemDetector_startWatch(JNIEnv* env, jobject, jintArray stallUs,
+                                                        jbooleanArray full, jintArray windowUs) {
+    if (watch_epollfd >= 0) {
+        ALOGE("Memory pressure watch is already running");
+        return -1;
+    }
+
+    ScopedIntArrayRO stalls(env, stallUs);
+    ScopedBooleanArrayRO fulls(env, full);
+    ScopedIntArrayRO windows(env, windowUs);
+    if (stalls.get() == nullptr || fulls.get() == nullptr || windows.get() == nullptr) {
+        return -1;
+    }
+    const size_t count = stalls.size();
+    if (count == 0 || count > MAX_WATCH_TRIGGERS ||
+        fulls.size() != count || windows.size() != count) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                          "Invalid psi trigger arrays");
+        return -1;
+    }
+
+    int epollfd = epoll_create(count);
+    if (epollfd == -1) {
+        ALOGE("epoll_create failed: %s", strerror(errno));
+        return -1;
+    }
+
+    int psi_fds[MAX_WATCH_TRIGGERS];
+    size_t registered = 0;
+    for (; registered < count; registered++) {
+        int fd = init_psi_monitor(fulls[registered] ? PSI_FULL : PSI_SOME,
+                                  stalls[registered], windows[registered]);
+        if (fd < 0 ||
+            register_psi_monitor(epollfd, fd, (void*)(uintptr_t)(registered + 1)) != 0) {
+            break;
+        }
+        psi_fds[registered] = fd;
+    }
+    if (registered < count) {
+        ALOGE("Failed to register psi watch trigger %zu", registered);
+        while (registered-- > 0) {
+            unregister_psi_monitor(epollfd, psi_fds[registered]);
+        }
+        close(epollfd);
+        return -1;
+    }
+
+    if (watch_page == nullptr) {
+        void* page = mmap(nullptr, sizeof(MemPressurePage), PROT_READ | PROT_WRITE,
+                          MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+        if (page == MAP_FAILED) {
+            ALOGE("Failed to map memory pressure level page: %s", strerror(errno));
+            while (registered-- > 0) {
+                unregister_psi_monitor(epollfd, psi_fds[registered]);
+            }
+            close(epollfd);
+            return -1;
+        }
+        watch_page = new (page) MemPressurePage();
+    }
+
+    watch_epollfd = epollfd;
+    watch_trigger_count = count;
+    std::thread(watch_loop).detach();
+    return 0;
+}
+
+static jobject android_server_am_LowMemDetector_getLevelPage(JNIEnv* env, jobject) {
+    if (watch_page == nullptr) {
+        return nullptr;
+    }
+    return env->NewDirectByteBuffer(watch_page, sizeof(MemPressurePage));
+}
+
 static jint android_server_am_LowMemDetector_init(JNIEnv*, jobject) {
     int epollfd;
     int low_psi_fd;
@@ -146,6 +341,10 @@ static const JNINativeMethod sMethods[] = {
     {"init", "()I", (void*)android_server_am_LowMemDetector_init},
     {"waitForPressure", "()I",
      (void*)android_server_am_LowMemDetector_waitForPressure},
+    {"startWatch", "([I[Z[I)I",
+     (void*)android_server_am_LowMemDetector_startWatch},
+    {"getLevelPage", "()Ljava/nio/ByteBuffer;",
+     (void*)android_server_am_LowMemDetector_getLevelPage},
 };
 
 int register_android_server_am_LowMemDetector(JNIEnv* env) {
@@ -16,11 +16,22 @@
 
 #define LOG_TAG "GpuService-JNI"
 
+#include <android-base/file.h>
+#include <android-base/unique_fd.h>
 #include <binder/IServiceManager.h>
 #include <graphicsenv/IGpuService.h>
+#include <gpu_capability_snapshot.h>
 #include <nativehelper/JNIHelp.h>
 #include <nativehelper/scoped_utf_chars.h>
 
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+
 namespace {
 
 static android::sp<android::IGpuService> getGpuService() {
@@ -46,10 +57,72 @@ void setUpdatableDriverPath_native(JNIEnv* env, jobject clazz, jstring jDriverPa
     gpuService->setUpdatableDriverPath(driverPath.c_str());
 }
 
+// Persists the GPU capability snapshot (see gpu_capability_snapshot.h) so
+// app processes can map it instead of probing the driver on every launch.
+// The write goes through a temp file and rename so readers never observe a
+// half-written snapshot.
+jboolean writeCapabilitySnapshot_native(JNIEnv* env, jobject clazz, jstring jPath,
+                                        jlong driverVersionCode, jlong driverBuildTime,
+                                        jboolean angleSupported, jstring jDriverVersionName,
+                                        jstring jExtensions) {
+    if (jPath == nullptr) {
+        jniThrowNullPointerException(env, nullptr);
+        return JNI_FALSE;
+    }
+    ScopedUtfChars path(env, jPath);
+    std::string driverVersionName;
+    if (jDriverVersionName != nullptr) {
+        ScopedUtfChars chars(env, jDriverVersionName);
+        driverVersionName = chars.c_str();
+    }
+    std::string extensions;
+    if (jExtensions != nullptr) {
+        ScopedUtfChars chars(env, jExtensions);
+        extensions = chars.c_str();
+    }
+
+    android::GpuCapabilitySnapshot header = {};
+    header.magic = android::GPU_CAPS_MAGIC;
+    header.version = android::GPU_CAPS_VERSION;
+    header.flags = angleSupported ? android::GPU_CAPS_FLAG_ANGLE_SUPPORTED : 0;
+    header.driverVersionCode = driverVersionCode;
+    header.driverBuildTime = driverBuildTime;
+    header.driverVersionNameOffset = sizeof(header);
+    header.driverVersionNameLength = driverVersionName.size();
+    header.extensionsOffset = header.driverVersionNameOffset + driverVersionName.size();
+    header.extensionsLength = extensions.size();
+    header.totalSize = header.extensionsOffset + extensions.size();
+
+    std::string tempPath = std::string(path.c_str()) + ".tmp";
+    android::base::unique_fd fd(
+            open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+    if (fd.get() < 0) {
+        ALOGE("Failed to create %s: %s", tempPath.c_str(), strerror(errno));
+        return JNI_FALSE;
+    }
+    if (!android::base::WriteFully(fd.get(), &header, sizeof(header)) ||
+        !android::base::WriteFully(fd.get(), driverVersionName.data(),
+                                   driverVersionName.size()) ||
+        !android::base::WriteFully(fd.get(), extensions.data(), extensions.size()) ||
+        fsync(fd.get()) != 0) {
+        ALOGE("Failed to write %s: %s", tempPath.c_str(), strerror(errno));
+        unlink(tempPath.c_str());
+        return JNI_FALSE;
+    }
+    if (rename(tempPath.c_str(), path.c_str()) != 0) {
+        ALOGE("Failed to rename %s to %s: %s", tempPath.c_str(), path.c_str(), strerror(errno));
+        unlink(tempPath.c_str());
+        return JNI_FALSE;
+    }
+    return JNI_TRUE;
+}
+
 static const JNINativeMethod gGpuServiceMethods[] = {
         /* name, signature, funcPtr */
         {"nSetUpdatableDriverPath", "(Ljava/lang/String;)V",
          reinterpret_cast<void*>(setUpdatableDriverPath_native)},
+        {"nWriteCapabilitySnapshot", "(Ljava/lang/String;JJZLjava/lang/String;Ljava/lang/String;)Z",
+         reinterpret_cast<void*>(writeCapabilitySnapshot_native)},
 };
 
 const char* const kGpuServiceName = "com/android/server/gpu/GpuService";
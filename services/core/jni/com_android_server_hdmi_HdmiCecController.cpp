@@ -32,6 +32,9 @@
 #include <utils/Looper.h>
 #include <utils/RefBase.h>
 
+#include <mutex>
+#include <vector>
+
 using ::android::hardware::tv::cec::V1_0::CecLogicalAddress;
 using ::android::hardware::tv::cec::V1_0::CecMessage;
 using ::android::hardware::tv::cec::V1_0::HdmiPortInfo;
@@ -51,6 +54,7 @@ namespace android {
 
 static struct {
     jmethodID handleIncomingCecCommand;
+    jmethodID handleIncomingCecCommands;
     jmethodID handleHotplug;
 } gHdmiCecControllerClassInfo;
 
@@ -81,6 +85,13 @@ public:
     void enableAudioReturnChannel(int port, bool flag);
     // Whether to hdmi device is connected to the given port.
     bool isConnected(int port);
+    // Install the native opcode filter. filter is a 256-bit mask as four
+    // words (or null to clear); filterPolls additionally drops header-only
+    // polling messages. Runs on the service thread.
+    void setOpcodeFilter(const uint64_t* filter, bool filterPolls);
+    // Deliver every queued incoming message in one Java up-call. Runs on the
+    // service thread.
+    void deliverPendingCecMessages();
 
     jobject getCallbacksObj() const {
         return mCallbacksObj;
@@ -98,23 +109,32 @@ private:
 
     static const int INVALID_PHYSICAL_ADDRESS = 0xFFFF;
 
+    bool isFilteredMessageLocked(const CecMessage& message) const;
+
     sp<IHdmiCec> mHdmiCec;
     jobject mCallbacksObj;
     sp<IHdmiCecCallback> mHdmiCecCallback;
     sp<Looper> mLooper;
+
+    // Guards the pending queue and the filter; taken briefly on the binder
+    // thread per incoming message.
+    std::mutex mPendingLock;
+    std::vector<CecMessage> mPendingMessages;
+    uint64_t mOpcodeFilter[4] = {};
+    bool mFilterPolls = false;
 };
 
 // Handler class to delegate incoming message to service thread.
 class HdmiCecEventHandler : public MessageHandler {
 public:
     enum EventType {
-        CEC_MESSAGE,
+        CEC_MESSAGE_BATCH,
         HOT_PLUG
     };
 
-    HdmiCecEventHandler(HdmiCecController* controller, const CecMessage& cecMessage)
-            : mController(controller),
-              mCecMessage(cecMessage) {}
+    // Batch delivery: the pending messages live in the controller.
+    explicit HdmiCecEventHandler(HdmiCecController* controller)
+            : mController(controller) {}
 
     HdmiCecEventHandler(HdmiCecController* controller, const HotplugEvent& hotplugEvent)
             : mController(controller),
@@ -124,8 +144,8 @@ public:
 
     void handleMessage(const Message& message) {
         switch (message.what) {
-        case EventType::CEC_MESSAGE:
-            propagateCecCommand(mCecMessage);
+        case EventType::CEC_MESSAGE_BATCH:
+            mController->deliverPendingCecMessages();
             break;
         case EventType::HOT_PLUG:
             propagateHotplugEvent(mHotplugEvent);
@@ -136,23 +156,16 @@ public:
         }
     }
 
-private:
-    // Propagate the message up to Java layer.
-    void propagateCecCommand(const CecMessage& message) {
-        JNIEnv* env = AndroidRuntime::getJNIEnv();
-        jint srcAddr = static_cast<jint>(message.initiator);
-        jint dstAddr = static_cast<jint>(message.destination);
-        jbyteArray body = env->NewByteArray(message.body.size());
-        const jbyte* bodyPtr = reinterpret_cast<const jbyte *>(message.body.data());
-        env->SetByteArrayRegion(body, 0, message.body.size(), bodyPtr);
-        env->CallVoidMethod(mController->getCallbacksObj(),
-                gHdmiCecControllerClassInfo.handleIncomingCecCommand, srcAddr,
-                dstAddr, body);
-        env->DeleteLocalRef(body);
-
-        checkAndClearExceptionFromCallback(env, __FUNCTION__);
+    // static
+    static void checkAndClearExceptionFromCallback(JNIEnv* env, const char* methodName) {
+        if (env->ExceptionCheck()) {
+            ALOGE("An exception was thrown by callback '%s'.", methodName);
+            LOGE_EX(env);
+            env->ExceptionClear();
+        }
     }
 
+private:
     void propagateHotplugEvent(const HotplugEvent& event) {
         // Note that this method should be called in service thread.
         JNIEnv* env = AndroidRuntime::getJNIEnv();
@@ -164,17 +177,7 @@ private:
         checkAndClearExceptionFromCallback(env, __FUNCTION__);
     }
 
-    // static
-    static void checkAndClearExceptionFromCallback(JNIEnv* env, const char* methodName) {
-        if (env->ExceptionCheck()) {
-            ALOGE("An exception was thrown by callback '%s'.", methodName);
-            LOGE_EX(env);
-            env->ExceptionClear();
-        }
-    }
-
     HdmiCecController* mController;
-    CecMessage mCecMessage;
     HotplugEvent mHotplugEvent;
 };
 
@@ -316,9 +319,95 @@ bool HdmiCecController::isConnected(int port) {
     return ret;
 }
 
+bool HdmiCecController::isFilteredMessageLocked(const CecMessage& message) const {
+    if (message.body.size() == 0) {
+        // Polling messages are header-only.
+        return mFilterPolls;
+    }
+    const uint8_t opcode = static_cast<uint8_t>(message.body[0]);
+    return (mOpcodeFilter[opcode >> 6] >> (opcode & 63)) & 1;
+}
+
+void HdmiCecController::setOpcodeFilter(const uint64_t* filter, bool filterPolls) {
+    std::lock_guard<std::mutex> lock(mPendingLock);
+    for (int i = 0; i < 4; ++i) {
+        mOpcodeFilter[i] = (filter != nullptr) ? filter[i] : 0;
+    }
+    mFilterPolls = filterPolls;
+}
+
+void HdmiCecController::deliverPendingCecMessages() {
+    std::vector<CecMessage> messages;
+    {
+        std::lock_guard<std::mutex> lock(mPendingLock);
+        messages.swap(mPendingMessages);
+    }
+    if (messages.empty()) {
+        return;
+    }
+
+    JNIEnv* env = AndroidRuntime::getJNIEnv();
+    const jsize count = messages.size();
+    jintArray srcAddrs = env->NewIntArray(count);
+    jintArray dstAddrs = env->NewIntArray(count);
+    jclass byteArrayClass = env->FindClass("[B");
+    jobjectArray bodies = env->NewObjectArray(count, byteArrayClass, NULL);
+    if (srcAddrs == NULL || dstAddrs == NULL || bodies == NULL) {
+        HdmiCecEventHandler::checkAndClearExceptionFromCallback(env, __FUNCTION__);
+        return;
+    }
+
+    std::vector<jint> addrs(count);
+    for (jsize i = 0; i < count; ++i) {
+        addrs[i] = static_cast<jint>(messages[i].initiator);
+    }
+    env->SetIntArrayRegion(srcAddrs, 0, count, addrs.data());
+    for (jsize i = 0; i < count; ++i) {
+        addrs[i] = static_cast<jint>(messages[i].destination);
+    }
+    env->SetIntArrayRegion(dstAddrs, 0, count, addrs.data());
+
+    for (jsize i = 0; i < count; ++i) {
+        jbyteArray body = env->NewByteArray(messages[i].body.size());
+        if (body == NULL) {
+            HdmiCecEventHandler::checkAndClearExceptionFromCallback(env, __FUNCTION__);
+            return;
+        }
+        const jbyte* bodyPtr = reinterpret_cast<const jbyte *>(messages[i].body.data());
+        env->SetByteArrayRegion(body, 0, messages[i].body.size(), bodyPtr);
+        env->SetObjectArrayElement(bodies, i, body);
+        env->DeleteLocalRef(body);
+    }
+
+    env->CallVoidMethod(mCallbacksObj,
+            gHdmiCecControllerClassInfo.handleIncomingCecCommands, srcAddrs, dstAddrs, bodies);
+    HdmiCecEventHandler::checkAndClearExceptionFromCallback(env, __FUNCTION__);
+
+    env->DeleteLocalRef(srcAddrs);
+    env->DeleteLocalRef(dstAddrs);
+    env->DeleteLocalRef(bodies);
+    env->DeleteLocalRef(byteArrayClass);
+}
+
 Return<void> HdmiCecController::HdmiCecCallback::onCecMessage(const CecMessage& message) {
-    sp<HdmiCecEventHandler> handler(new HdmiCecEventHandler(mController, message));
-    mController->mLooper->sendMessage(handler, HdmiCecEventHandler::EventType::CEC_MESSAGE);
+    bool firstPending;
+    {
+        std::lock_guard<std::mutex> lock(mController->mPendingLock);
+        if (mController->isFilteredMessageLocked(message)) {
+            // Bus chatter the service would discard anyway; drop it here so
+            // the service thread never wakes.
+            return Void();
+        }
+        mController->mPendingMessages.push_back(message);
+        firstPending = (mController->mPendingMessages.size() == 1);
+    }
+    // Only the message that makes the queue non-empty posts a wake; a burst
+    // arriving before the service thread drains rides along in one batch.
+    if (firstPending) {
+        sp<HdmiCecEventHandler> handler(new HdmiCecEventHandler(mController));
+        mController->mLooper->sendMessage(handler,
+                HdmiCecEventHandler::EventType::CEC_MESSAGE_BATCH);
+    }
     return Void();
 }
 
@@ -351,6 +440,8 @@ static jlong nativeInit(JNIEnv* env, jclass clazz, jobject callbacksObj,
 
     GET_METHOD_ID(gHdmiCecControllerClassInfo.handleIncomingCecCommand, clazz,
             "handleIncomingCecCommand", "(II[B)V");
+    GET_METHOD_ID(gHdmiCecControllerClassInfo.handleIncomingCecCommands, clazz,
+            "handleIncomingCecCommands", "([I[I[[B)V");
     GET_METHOD_ID(gHdmiCecControllerClassInfo.handleHotplug, clazz,
             "handleHotplug", "(IZ)V");
 
@@ -426,6 +517,26 @@ static void nativeEnableAudioReturnChannel(JNIEnv* env, jclass clazz, jlong cont
     controller->enableAudioReturnChannel(port, enabled == JNI_TRUE);
 }
 
+static void nativeSetOpcodeFilter(JNIEnv* env, jclass clazz, jlong controllerPtr,
+        jlongArray filter, jboolean filterPolls) {
+    HdmiCecController* controller = reinterpret_cast<HdmiCecController*>(controllerPtr);
+    if (filter == NULL) {
+        controller->setOpcodeFilter(NULL, filterPolls == JNI_TRUE);
+        return;
+    }
+    if (env->GetArrayLength(filter) != 4) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                "Opcode filter must be a 256-bit mask as four longs");
+        return;
+    }
+    ScopedLongArrayRO words(env, filter);
+    uint64_t mask[4];
+    for (int i = 0; i < 4; ++i) {
+        mask[i] = static_cast<uint64_t>(words[i]);
+    }
+    controller->setOpcodeFilter(mask, filterPolls == JNI_TRUE);
+}
+
 static jboolean nativeIsConnected(JNIEnv* env, jclass clazz, jlong controllerPtr, jint port) {
     HdmiCecController* controller = reinterpret_cast<HdmiCecController*>(controllerPtr);
     return controller->isConnected(port) ? JNI_TRUE : JNI_FALSE ;
@@ -448,6 +559,7 @@ static const JNINativeMethod sMethods[] = {
     { "nativeSetOption", "(JIZ)V", (void *) nativeSetOption },
     { "nativeSetLanguage", "(JLjava/lang/String;)V", (void *) nativeSetLanguage },
     { "nativeEnableAudioReturnChannel", "(JIZ)V", (void *) nativeEnableAudioReturnChannel },
+    { "nativeSetOpcodeFilter", "(J[JZ)V", (void *) nativeSetOpcodeFilter },
     { "nativeIsConnected", "(JI)Z", (void *) nativeIsConnected },
 };
 
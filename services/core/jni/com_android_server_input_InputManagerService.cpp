@@ -30,14 +30,19 @@
 #include <atomic>
 #include <cinttypes>
 #include <limits.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include <android-base/parseint.h>
 #include <android-base/stringprintf.h>
 #include <android_runtime/AndroidRuntime.h>
 #include <android_runtime/Log.h>
 
+#include <cutils/ashmem.h>
+
 #include <utils/Log.h>
 #include <utils/Looper.h>
 #include <utils/threads.h>
+#include <utils/Timers.h>
 #include <utils/Trace.h>
 
 #include <binder/IServiceManager.h>
@@ -182,6 +187,32 @@ static std::string getStringElementFromJavaArray(JNIEnv* env, jobjectArray array
     return result;
 }
 
+// --- Input pipeline telemetry ---
+
+// Per-display queueing latency counters, published to the managed layer as a
+// direct ByteBuffer over an ashmem page so they can be read without binder
+// calls. All counters increase monotonically; readers compute averages from
+// the totals. Slots are claimed lazily as events arrive for new displays.
+static constexpr uint32_t INPUT_TELEMETRY_VERSION = 1;
+static constexpr uint32_t INPUT_TELEMETRY_MAX_DISPLAYS = 8;
+
+struct InputTelemetrySlot {
+    std::atomic<int32_t> displayId; // ADISPLAY_ID_NONE while unclaimed
+    std::atomic<uint32_t> keyCount;
+    std::atomic<uint64_t> keyLatencyTotalNs;
+    std::atomic<uint64_t> keyLatencyMaxNs;
+    std::atomic<uint32_t> motionCount;
+    std::atomic<uint64_t> motionLatencyTotalNs;
+    std::atomic<uint64_t> motionLatencyMaxNs;
+};
+
+struct InputTelemetryPage {
+    uint32_t version;
+    uint32_t slotCount;
+    InputTelemetrySlot slots[INPUT_TELEMETRY_MAX_DISPLAYS];
+};
+
+
 // --- NativeInputManager ---
 
 class NativeInputManager : public virtual RefBase,
@@ -196,6 +227,8 @@ public:
 
     inline sp<InputManager> getInputManager() const { return mInputManager; }
 
+    inline InputTelemetryPage* getTelemetryPage() const { return mTelemetryPage; }
+
     void dump(std::string& dump);
 
     void setDisplayViewports(JNIEnv* env, jobjectArray viewportObjArray);
@@ -310,6 +343,12 @@ private:
 
     std::atomic<bool> mInteractive;
 
+    // Pipeline telemetry page; null if the ashmem region could not be created.
+    int mTelemetryFd;
+    InputTelemetryPage* mTelemetryPage;
+
+    void initializeTelemetryPage();
+    void recordQueueingLatency(int32_t displayId, nsecs_t eventTime, bool motion);
     void updateInactivityTimeoutLocked();
     void handleInterceptActions(jint wmActions, nsecs_t when, uint32_t& policyFlags);
     void ensureSpriteControllerLocked();
@@ -342,6 +381,8 @@ NativeInputManager::NativeInputManager(jobject contextObj,
     }
     mInteractive = true;
 
+    initializeTelemetryPage();
+
     mInputManager = new InputManager(this, this);
     defaultServiceManager()->addService(String16("inputflinger"),
             mInputManager, false);
@@ -351,6 +392,78 @@ NativeInputManager::~NativeInputManager() {
     JNIEnv* env = jniEnv();
 
     env->DeleteGlobalRef(mServiceObj);
+
+    if (mTelemetryPage != nullptr) {
+        munmap(mTelemetryPage, sizeof(InputTelemetryPage));
+    }
+    if (mTelemetryFd >= 0) {
+        close(mTelemetryFd);
+    }
+}
+
+void NativeInputManager::initializeTelemetryPage() {
+    mTelemetryPage = nullptr;
+    mTelemetryFd = ashmem_create_region("InputPipelineTelemetry", sizeof(InputTelemetryPage));
+    if (mTelemetryFd < 0) {
+        ALOGW("Could not create input telemetry region, telemetry disabled.");
+        return;
+    }
+    void* page = mmap(nullptr, sizeof(InputTelemetryPage), PROT_READ | PROT_WRITE, MAP_SHARED,
+            mTelemetryFd, 0);
+    if (page == MAP_FAILED) {
+        ALOGW("Could not map input telemetry region, telemetry disabled.");
+        close(mTelemetryFd);
+        mTelemetryFd = -1;
+        return;
+    }
+    // The region is zero-filled; counters start at zero and only the header
+    // and the unclaimed-slot sentinels need explicit initialization.
+    mTelemetryPage = static_cast<InputTelemetryPage*>(page);
+    mTelemetryPage->version = INPUT_TELEMETRY_VERSION;
+    mTelemetryPage->slotCount = INPUT_TELEMETRY_MAX_DISPLAYS;
+    for (uint32_t i = 0; i < INPUT_TELEMETRY_MAX_DISPLAYS; i++) {
+        mTelemetryPage->slots[i].displayId.store(ADISPLAY_ID_NONE, std::memory_order_relaxed);
+    }
+}
+
+void NativeInputManager::recordQueueingLatency(int32_t displayId, nsecs_t eventTime, bool motion) {
+    if (mTelemetryPage == nullptr) {
+        return;
+    }
+    nsecs_t latency = systemTime(SYSTEM_TIME_MONOTONIC) - eventTime;
+    if (latency < 0) {
+        latency = 0;
+    }
+
+    InputTelemetrySlot* slot = nullptr;
+    for (uint32_t i = 0; i < INPUT_TELEMETRY_MAX_DISPLAYS; i++) {
+        int32_t id = mTelemetryPage->slots[i].displayId.load(std::memory_order_relaxed);
+        if (id == ADISPLAY_ID_NONE) {
+            // Claim the slot for this display; on a lost race the slot may now
+            // belong to this display anyway.
+            if (mTelemetryPage->slots[i].displayId.compare_exchange_strong(
+                    id, displayId, std::memory_order_relaxed)) {
+                id = displayId;
+            }
+        }
+        if (id == displayId) {
+            slot = &mTelemetryPage->slots[i];
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        return; // more displays than slots; drop the sample
+    }
+
+    std::atomic<uint32_t>& count = motion ? slot->motionCount : slot->keyCount;
+    std::atomic<uint64_t>& totalNs = motion ? slot->motionLatencyTotalNs : slot->keyLatencyTotalNs;
+    std::atomic<uint64_t>& maxNs = motion ? slot->motionLatencyMaxNs : slot->keyLatencyMaxNs;
+    count.fetch_add(1, std::memory_order_relaxed);
+    totalNs.fetch_add(latency, std::memory_order_relaxed);
+    uint64_t prevMax = maxNs.load(std::memory_order_relaxed);
+    while (static_cast<uint64_t>(latency) > prevMax
+            && !maxNs.compare_exchange_weak(prevMax, latency, std::memory_order_relaxed)) {
+    }
 }
 
 void NativeInputManager::dump(std::string& dump) {
@@ -368,6 +481,31 @@ void NativeInputManager::dump(std::string& dump) {
         dump += StringPrintf(INDENT "Show Touches: %s\n", toString(mLocked.showTouches));
         dump += StringPrintf(INDENT "Pointer Capture Enabled: %s\n", toString(mLocked.pointerCapture));
     }
+    if (mTelemetryPage != nullptr) {
+        dump += INDENT "Queueing Latency:\n";
+        for (uint32_t i = 0; i < INPUT_TELEMETRY_MAX_DISPLAYS; i++) {
+            const InputTelemetrySlot& slot = mTelemetryPage->slots[i];
+            int32_t displayId = slot.displayId.load(std::memory_order_relaxed);
+            if (displayId == ADISPLAY_ID_NONE) {
+                continue;
+            }
+            uint32_t keyCount = slot.keyCount.load(std::memory_order_relaxed);
+            uint32_t motionCount = slot.motionCount.load(std::memory_order_relaxed);
+            dump += StringPrintf(INDENT INDENT "Display %" PRId32
+                    ": keys=%" PRIu32 " (avg %" PRIu64 "us, max %" PRIu64 "us)"
+                    ", motions=%" PRIu32 " (avg %" PRIu64 "us, max %" PRIu64 "us)\n",
+                    displayId, keyCount,
+                    keyCount != 0
+                            ? slot.keyLatencyTotalNs.load(std::memory_order_relaxed)
+                                    / keyCount / 1000 : 0,
+                    slot.keyLatencyMaxNs.load(std::memory_order_relaxed) / 1000,
+                    motionCount,
+                    motionCount != 0
+                            ? slot.motionLatencyTotalNs.load(std::memory_order_relaxed)
+                                    / motionCount / 1000 : 0,
+                    slot.motionLatencyMaxNs.load(std::memory_order_relaxed) / 1000);
+        }
+    }
     dump += "\n";
 
     mInputManager->getReader()->dump(dump);
@@ -987,6 +1125,7 @@ bool NativeInputManager::filterInputEvent(const InputEvent* inputEvent, uint32_t
 void NativeInputManager::interceptKeyBeforeQueueing(const KeyEvent* keyEvent,
         uint32_t& policyFlags) {
     ATRACE_CALL();
+    recordQueueingLatency(keyEvent->getDisplayId(), keyEvent->getEventTime(), false /*motion*/);
     // Policy:
     // - Ignore untrusted events and pass them along.
     // - Ask the window manager what to do with normal events and trusted injected events.
@@ -1025,6 +1164,7 @@ void NativeInputManager::interceptKeyBeforeQueueing(const KeyEvent* keyEvent,
 void NativeInputManager::interceptMotionBeforeQueueing(const int32_t displayId, nsecs_t when,
         uint32_t& policyFlags) {
     ATRACE_CALL();
+    recordQueueingLatency(displayId, when, true /*motion*/);
     // Policy:
     // - Ignore untrusted events and pass them along.
     // - No special filtering for injected events required at this time.
@@ -1749,6 +1889,19 @@ static void nativeSetMotionClassifierEnabled(JNIEnv* /* env */, jclass /* clazz
     im->setMotionClassifierEnabled(enabled);
 }
 
+// Returns the pipeline telemetry page as a direct ByteBuffer, or null if the
+// page could not be created. The buffer stays valid for the lifetime of the
+// input manager and must be treated as read-only by the managed layer.
+static jobject nativeGetPipelineTelemetry(JNIEnv* env, jclass /* clazz */, jlong ptr) {
+    NativeInputManager* im = reinterpret_cast<NativeInputManager*>(ptr);
+
+    InputTelemetryPage* page = im->getTelemetryPage();
+    if (page == nullptr) {
+        return nullptr;
+    }
+    return env->NewDirectByteBuffer(page, sizeof(InputTelemetryPage));
+}
+
 // ----------------------------------------------------------------------------
 
 static const JNINativeMethod gInputManagerMethods[] = {
@@ -1807,6 +1960,8 @@ static const JNINativeMethod gInputManagerMethods[] = {
         {"nativeCanDispatchToDisplay", "(JII)Z", (void*)nativeCanDispatchToDisplay},
         {"nativeNotifyPortAssociationsChanged", "(J)V", (void*)nativeNotifyPortAssociationsChanged},
         {"nativeSetMotionClassifierEnabled", "(JZ)V", (void*)nativeSetMotionClassifierEnabled},
+        {"nativeGetPipelineTelemetry", "(J)Ljava/nio/ByteBuffer;",
+         (void*)nativeGetPipelineTelemetry},
 };
 
 #define FIND_CLASS(var, className) \
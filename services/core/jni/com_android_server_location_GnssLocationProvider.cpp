@@ -46,6 +46,7 @@
 #include <linux/in.h>
 #include <linux/in6.h>
 #include <pthread.h>
+#include <stdlib.h>
 #include <string.h>
 #include <utils/SystemClock.h>
 
@@ -84,6 +85,7 @@ static jmethodID method_reportGeofenceRemoveStatus;
 static jmethodID method_reportGeofencePauseStatus;
 static jmethodID method_reportGeofenceResumeStatus;
 static jmethodID method_reportMeasurementData;
+static jmethodID method_reportMeasurementDataBuffer;
 static jmethodID method_reportAntennaInfo;
 static jmethodID method_reportNavigationMessages;
 static jmethodID method_reportLocationBatch;
@@ -1295,6 +1297,219 @@ void GnssAntennaInfoCallback::reportAntennaInfo(JNIEnv* env, const jobject anten
     checkAndClearExceptionFromCallback(env, __FUNCTION__);
 }
 
+/*
+ * Fixed-layout records for batched measurement delivery. One clock record
+ * followed by measurementCount measurement records is written into a reusable
+ * native-order direct ByteBuffer and handed to the managed layer once per
+ * epoch, replacing per-measurement object construction and setter upcalls.
+ * Layouts must match the managed-side decoder; fields absent from older HAL
+ * versions are zero and unflagged.
+ */
+struct GnssClockRecord {
+    int64_t timeNs;
+    int64_t fullBiasNs;
+    int64_t elapsedRealtimeNs;
+    double biasNs;
+    double biasUncertaintyNs;
+    double driftNsps;
+    double driftUncertaintyNsps;
+    double timeUncertaintyNs;
+    double elapsedRealtimeUncertaintyNs;
+    float referenceCarrierFrequencyHzForIsb;
+    int32_t leapSecond;
+    int32_t hwClockDiscontinuityCount;
+    int32_t referenceConstellationTypeForIsb;  // -1 when no ISB reference
+    uint32_t flags;                            // GnssClockFlags
+    uint32_t elapsedRealtimeFlags;             // ElapsedRealtimeFlags
+    uint32_t measurementCount;
+    char referenceCodeTypeForIsb[8];           // NUL-terminated, truncated to fit
+};
+
+struct GnssMeasurementRecord {
+    double timeOffsetNs;
+    int64_t receivedSvTimeInNs;
+    int64_t receivedSvTimeUncertaintyInNs;
+    double cn0DbHz;
+    double basebandCn0DbHz;
+    double pseudorangeRateMps;
+    double pseudorangeRateUncertaintyMps;
+    double accumulatedDeltaRangeM;
+    double accumulatedDeltaRangeUncertaintyM;
+    double snrDb;
+    double agcLevelDb;
+    double fullInterSignalBiasNs;
+    double fullInterSignalBiasUncertaintyNs;
+    double satelliteInterSignalBiasNs;
+    double satelliteInterSignalBiasUncertaintyNs;
+    float carrierFrequencyHz;
+    int32_t svid;
+    int32_t constellationType;
+    int32_t state;
+    int32_t accumulatedDeltaRangeState;
+    int32_t multipathIndicator;
+    uint32_t flags;                            // GnssMeasurementFlags
+    char codeType[8];                          // NUL-terminated, truncated to fit
+};
+
+/*
+ * The batch buffer is reused across epochs and only reallocated when an epoch
+ * needs more room. Measurement callbacks arrive on a single HIDL thread, so no
+ * locking is needed.
+ */
+static jobject sMeasurementBatchBufferObj = nullptr;
+static void* sMeasurementBatchBufferData = nullptr;
+static size_t sMeasurementBatchBufferSize = 0;
+
+static void* ensureMeasurementBatchBuffer(JNIEnv* env, size_t size) {
+    if (size <= sMeasurementBatchBufferSize) {
+        return sMeasurementBatchBufferData;
+    }
+    if (sMeasurementBatchBufferObj != nullptr) {
+        env->DeleteGlobalRef(sMeasurementBatchBufferObj);
+        sMeasurementBatchBufferObj = nullptr;
+        free(sMeasurementBatchBufferData);
+        sMeasurementBatchBufferData = nullptr;
+        sMeasurementBatchBufferSize = 0;
+    }
+    void* data = malloc(size);
+    if (data == nullptr) {
+        return nullptr;
+    }
+    jobject localRef = env->NewDirectByteBuffer(data, size);
+    if (localRef == nullptr) {
+        free(data);
+        return nullptr;
+    }
+    sMeasurementBatchBufferObj = env->NewGlobalRef(localRef);
+    env->DeleteLocalRef(localRef);
+    sMeasurementBatchBufferData = data;
+    sMeasurementBatchBufferSize = size;
+    return data;
+}
+
+static void fillGnssMeasurementRecord(
+        const IGnssMeasurementCallback_V1_0::GnssMeasurement* measurement,
+        GnssMeasurementRecord* record) {
+    memset(record, 0, sizeof(*record));
+    record->flags = static_cast<uint32_t>(measurement->flags);
+    record->svid = static_cast<int32_t>(measurement->svid);
+    record->constellationType = static_cast<int32_t>(measurement->constellation);
+    record->timeOffsetNs = measurement->timeOffsetNs;
+    record->state = static_cast<int32_t>(measurement->state);
+    record->receivedSvTimeInNs = measurement->receivedSvTimeInNs;
+    record->receivedSvTimeUncertaintyInNs = measurement->receivedSvTimeUncertaintyInNs;
+    record->cn0DbHz = measurement->cN0DbHz;
+    record->pseudorangeRateMps = measurement->pseudorangeRateMps;
+    record->pseudorangeRateUncertaintyMps = measurement->pseudorangeRateUncertaintyMps;
+    // Half Cycle state not reported from Hardware in V1_0
+    record->accumulatedDeltaRangeState =
+            static_cast<int32_t>(measurement->accumulatedDeltaRangeState) &
+            ~ADR_STATE_HALF_CYCLE_REPORTED;
+    record->accumulatedDeltaRangeM = measurement->accumulatedDeltaRangeM;
+    record->accumulatedDeltaRangeUncertaintyM = measurement->accumulatedDeltaRangeUncertaintyM;
+    record->carrierFrequencyHz = measurement->carrierFrequencyHz;
+
+    // Intentionally not copying deprecated fields of carrierCycles,
+    // carrierPhase, carrierPhaseUncertainty
+
+    record->multipathIndicator = static_cast<int32_t>(measurement->multipathIndicator);
+    record->snrDb = measurement->snrDb;
+    record->agcLevelDb = measurement->agcLevelDb;
+}
+
+static void fillGnssMeasurementRecord(
+        const IGnssMeasurementCallback_V1_1::GnssMeasurement* measurement_V1_1,
+        GnssMeasurementRecord* record) {
+    fillGnssMeasurementRecord(&(measurement_V1_1->v1_0), record);
+
+    // Set the V1_1 flag, and mark that new field has valid information for Java Layer
+    record->accumulatedDeltaRangeState =
+            static_cast<int32_t>(measurement_V1_1->accumulatedDeltaRangeState) |
+            ADR_STATE_HALF_CYCLE_REPORTED;
+}
+
+static void fillGnssMeasurementRecord(
+        const IGnssMeasurementCallback_V2_0::GnssMeasurement* measurement_V2_0,
+        GnssMeasurementRecord* record) {
+    fillGnssMeasurementRecord(&(measurement_V2_0->v1_1), record);
+
+    strlcpy(record->codeType, measurement_V2_0->codeType.c_str(), sizeof(record->codeType));
+
+    // Overwrite with v2_0.state since v2_0->v1_1->v1_0.state is deprecated.
+    record->state = static_cast<int32_t>(measurement_V2_0->state);
+
+    // Overwrite with v2_0.constellation since v2_0->v1_1->v1_0.constellation is deprecated.
+    record->constellationType = static_cast<int32_t>(measurement_V2_0->constellation);
+}
+
+static void fillGnssMeasurementRecord(
+        const IGnssMeasurementCallback_V2_1::GnssMeasurement* measurement_V2_1,
+        GnssMeasurementRecord* record) {
+    fillGnssMeasurementRecord(&(measurement_V2_1->v2_0), record);
+
+    record->flags = static_cast<uint32_t>(measurement_V2_1->flags);
+    record->basebandCn0DbHz = measurement_V2_1->basebandCN0DbHz;
+    record->fullInterSignalBiasNs = measurement_V2_1->fullInterSignalBiasNs;
+    record->fullInterSignalBiasUncertaintyNs = measurement_V2_1->fullInterSignalBiasUncertaintyNs;
+    record->satelliteInterSignalBiasNs = measurement_V2_1->satelliteInterSignalBiasNs;
+    record->satelliteInterSignalBiasUncertaintyNs =
+            measurement_V2_1->satelliteInterSignalBiasUncertaintyNs;
+}
+
+static void fillGnssClockRecord(const IGnssMeasurementCallback_V1_0::GnssClock& clock,
+        GnssClockRecord* record) {
+    record->flags = static_cast<uint32_t>(clock.gnssClockFlags);
+    record->leapSecond = static_cast<int32_t>(clock.leapSecond);
+    record->timeNs = clock.timeNs;
+    record->timeUncertaintyNs = clock.timeUncertaintyNs;
+    record->fullBiasNs = clock.fullBiasNs;
+    record->biasNs = clock.biasNs;
+    record->biasUncertaintyNs = clock.biasUncertaintyNs;
+    record->driftNsps = clock.driftNsps;
+    record->driftUncertaintyNsps = clock.driftUncertaintyNsps;
+    record->hwClockDiscontinuityCount = clock.hwClockDiscontinuityCount;
+}
+
+static void fillGnssClockRecord(const IGnssMeasurementCallback_V2_1::GnssClock& clock,
+        GnssClockRecord* record) {
+    record->referenceConstellationTypeForIsb =
+            static_cast<int32_t>(clock.referenceSignalTypeForIsb.constellation);
+    record->referenceCarrierFrequencyHzForIsb =
+            clock.referenceSignalTypeForIsb.carrierFrequencyHz;
+    strlcpy(record->referenceCodeTypeForIsb,
+            clock.referenceSignalTypeForIsb.codeType.c_str(),
+            sizeof(record->referenceCodeTypeForIsb));
+    fillGnssClockRecord(clock.v1_0, record);
+}
+
+static void fillGnssClockRecord(const IGnssMeasurementCallback_V1_0::GnssData& data,
+        GnssClockRecord* record) {
+    fillGnssClockRecord(data.clock, record);
+}
+
+static void fillGnssClockRecord(const IGnssMeasurementCallback_V1_1::GnssData& data,
+        GnssClockRecord* record) {
+    fillGnssClockRecord(data.clock, record);
+}
+
+static void fillGnssClockRecord(const IGnssMeasurementCallback_V2_0::GnssData& data,
+        GnssClockRecord* record) {
+    record->elapsedRealtimeFlags = static_cast<uint32_t>(data.elapsedRealtime.flags);
+    record->elapsedRealtimeNs = static_cast<int64_t>(data.elapsedRealtime.timestampNs);
+    record->elapsedRealtimeUncertaintyNs =
+            static_cast<double>(data.elapsedRealtime.timeUncertaintyNs);
+    fillGnssClockRecord(data.clock, record);
+}
+
+static void fillGnssClockRecord(const IGnssMeasurementCallback_V2_1::GnssData& data,
+        GnssClockRecord* record) {
+    record->elapsedRealtimeFlags = static_cast<uint32_t>(data.elapsedRealtime.flags);
+    record->elapsedRealtimeNs = static_cast<int64_t>(data.elapsedRealtime.timestampNs);
+    record->elapsedRealtimeUncertaintyNs =
+            static_cast<double>(data.elapsedRealtime.timeUncertaintyNs);
+    fillGnssClockRecord(data.clock, record);
+}
+
 /*
  * GnssMeasurementCallback implements the callback methods required for the
  * GnssMeasurement interface.
@@ -1307,22 +1522,11 @@ struct GnssMeasurementCallback : public IGnssMeasurementCallback_V2_1 {
     Return<void> gnssMeasurementCb(const IGnssMeasurementCallback_V1_1::GnssData& data) override;
     Return<void> GnssMeasurementCb(const IGnssMeasurementCallback_V1_0::GnssData& data) override;
  private:
-    template<class T>
-    void translateSingleGnssMeasurement(const T* measurement, JavaObject& object);
-
-    template<class T>
-    jobjectArray translateAllGnssMeasurements(JNIEnv* env, const T* measurements, size_t count);
-
     template<class T>
     void translateAndSetGnssData(const T& data);
 
     template<class T>
     size_t getMeasurementCount(const T& data);
-
-    template<class T>
-    void translateGnssClock(JavaObject& object, const T& data);
-
-    void setMeasurementData(JNIEnv* env, jobject clock, jobjectArray measurementArray);
 };
 
 Return<void> GnssMeasurementCallback::gnssMeasurementCb_2_1(
@@ -1353,16 +1557,28 @@ template<class T>
 void GnssMeasurementCallback::translateAndSetGnssData(const T& data) {
     JNIEnv* env = getJniEnv();
 
-    JavaObject gnssClockJavaObject(env, class_gnssClock, method_gnssClockCtor);
-    translateGnssClock(gnssClockJavaObject, data);
-    jobject clock = gnssClockJavaObject.get();
-
     size_t count = getMeasurementCount(data);
-    jobjectArray measurementArray = translateAllGnssMeasurements(env, data.measurements.data(), count);
-    setMeasurementData(env, clock, measurementArray);
+    size_t size = sizeof(GnssClockRecord) + count * sizeof(GnssMeasurementRecord);
+    void* buffer = ensureMeasurementBatchBuffer(env, size);
+    if (buffer == nullptr) {
+        ALOGE("%s: could not allocate measurement batch buffer", __func__);
+        return;
+    }
+
+    GnssClockRecord* clockRecord = static_cast<GnssClockRecord*>(buffer);
+    memset(clockRecord, 0, sizeof(*clockRecord));
+    clockRecord->referenceConstellationTypeForIsb = -1;
+    fillGnssClockRecord(data, clockRecord);
+    clockRecord->measurementCount = count;
 
-    env->DeleteLocalRef(clock);
-    env->DeleteLocalRef(measurementArray);
+    GnssMeasurementRecord* records = reinterpret_cast<GnssMeasurementRecord*>(clockRecord + 1);
+    for (size_t i = 0; i < count; ++i) {
+        fillGnssMeasurementRecord(&(data.measurements.data()[i]), &records[i]);
+    }
+
+    env->CallVoidMethod(mCallbacksObj, method_reportMeasurementDataBuffer,
+            sMeasurementBatchBufferObj, static_cast<jint>(count));
+    checkAndClearExceptionFromCallback(env, __FUNCTION__);
 }
 
 template<>
@@ -1376,241 +1592,6 @@ size_t GnssMeasurementCallback::getMeasurementCount(const T& data) {
     return data.measurements.size();
 }
 
-// Preallocate object as: JavaObject object(env, "android/location/GnssMeasurement");
-template<>
-void GnssMeasurementCallback::translateSingleGnssMeasurement
-        <IGnssMeasurementCallback_V1_0::GnssMeasurement>(
-        const IGnssMeasurementCallback_V1_0::GnssMeasurement* measurement,
-        JavaObject& object) {
-    uint32_t flags = static_cast<uint32_t>(measurement->flags);
-
-    SET(Svid, static_cast<int32_t>(measurement->svid));
-    SET(ConstellationType, static_cast<int32_t>(measurement->constellation));
-    SET(TimeOffsetNanos, measurement->timeOffsetNs);
-    SET(State, static_cast<int32_t>(measurement->state));
-    SET(ReceivedSvTimeNanos, measurement->receivedSvTimeInNs);
-    SET(ReceivedSvTimeUncertaintyNanos,
-        measurement->receivedSvTimeUncertaintyInNs);
-    SET(Cn0DbHz, measurement->cN0DbHz);
-    SET(PseudorangeRateMetersPerSecond, measurement->pseudorangeRateMps);
-    SET(PseudorangeRateUncertaintyMetersPerSecond,
-        measurement->pseudorangeRateUncertaintyMps);
-    SET(AccumulatedDeltaRangeState,
-        (static_cast<int32_t>(measurement->accumulatedDeltaRangeState) &
-        ~ADR_STATE_HALF_CYCLE_REPORTED)); // Half Cycle state not reported from Hardware in V1_0
-    SET(AccumulatedDeltaRangeMeters, measurement->accumulatedDeltaRangeM);
-    SET(AccumulatedDeltaRangeUncertaintyMeters,
-        measurement->accumulatedDeltaRangeUncertaintyM);
-
-    if (flags & static_cast<uint32_t>(GnssMeasurementFlags::HAS_CARRIER_FREQUENCY)) {
-        SET(CarrierFrequencyHz, measurement->carrierFrequencyHz);
-    }
-
-    // Intentionally not copying deprecated fields of carrierCycles,
-    // carrierPhase, carrierPhaseUncertainty
-
-    SET(MultipathIndicator, static_cast<int32_t>(measurement->multipathIndicator));
-
-    if (flags & static_cast<uint32_t>(GnssMeasurementFlags::HAS_SNR)) {
-        SET(SnrInDb, measurement->snrDb);
-    }
-
-    if (flags & static_cast<uint32_t>(GnssMeasurementFlags::HAS_AUTOMATIC_GAIN_CONTROL)) {
-        SET(AutomaticGainControlLevelInDb, measurement->agcLevelDb);
-    }
-}
-
-// Preallocate object as: JavaObject object(env, "android/location/GnssMeasurement");
-template<>
-void GnssMeasurementCallback::translateSingleGnssMeasurement
-        <IGnssMeasurementCallback_V1_1::GnssMeasurement>(
-        const IGnssMeasurementCallback_V1_1::GnssMeasurement* measurement_V1_1,
-        JavaObject& object) {
-    translateSingleGnssMeasurement(&(measurement_V1_1->v1_0), object);
-
-    // Set the V1_1 flag, and mark that new field has valid information for Java Layer
-    SET(AccumulatedDeltaRangeState,
-            (static_cast<int32_t>(measurement_V1_1->accumulatedDeltaRangeState) |
-            ADR_STATE_HALF_CYCLE_REPORTED));
-}
-
-// Preallocate object as: JavaObject object(env, "android/location/GnssMeasurement");
-template<>
-void GnssMeasurementCallback::translateSingleGnssMeasurement
-        <IGnssMeasurementCallback_V2_0::GnssMeasurement>(
-        const IGnssMeasurementCallback_V2_0::GnssMeasurement* measurement_V2_0,
-        JavaObject& object) {
-    JNIEnv* env = getJniEnv();
-    translateSingleGnssMeasurement(&(measurement_V2_0->v1_1), object);
-
-    jstring codeType = env->NewStringUTF(measurement_V2_0->codeType.c_str());
-    SET(CodeType, codeType);
-
-    // Overwrite with v2_0.state since v2_0->v1_1->v1_0.state is deprecated.
-    SET(State, static_cast<int32_t>(measurement_V2_0->state));
-
-    // Overwrite with v2_0.constellation since v2_0->v1_1->v1_0.constellation is deprecated.
-    SET(ConstellationType, static_cast<int32_t>(measurement_V2_0->constellation));
-
-    if (codeType) {
-        env->DeleteLocalRef(codeType);
-    }
-}
-
-// Preallocate object as: JavaObject object(env, "android/location/GnssMeasurement");
-template<>
-void GnssMeasurementCallback::translateSingleGnssMeasurement
-        <IGnssMeasurementCallback_V2_1::GnssMeasurement>(
-        const IGnssMeasurementCallback_V2_1::GnssMeasurement* measurement_V2_1,
-        JavaObject& object) {
-    translateSingleGnssMeasurement(&(measurement_V2_1->v2_0), object);
-
-    SET(BasebandCn0DbHz, measurement_V2_1->basebandCN0DbHz);
-
-    if (measurement_V2_1->flags & GnssMeasurementFlags::HAS_FULL_ISB) {
-        SET(FullInterSignalBiasNanos, measurement_V2_1->fullInterSignalBiasNs);
-    }
-
-    if (measurement_V2_1->flags & GnssMeasurementFlags::HAS_FULL_ISB_UNCERTAINTY) {
-        SET(FullInterSignalBiasUncertaintyNanos,
-            measurement_V2_1->fullInterSignalBiasUncertaintyNs);
-    }
-
-    if (measurement_V2_1->flags & GnssMeasurementFlags::HAS_SATELLITE_ISB) {
-        SET(SatelliteInterSignalBiasNanos, measurement_V2_1->satelliteInterSignalBiasNs);
-    }
-
-    if (measurement_V2_1->flags & GnssMeasurementFlags::HAS_SATELLITE_ISB_UNCERTAINTY) {
-        SET(SatelliteInterSignalBiasUncertaintyNanos,
-            measurement_V2_1->satelliteInterSignalBiasUncertaintyNs);
-    }
-}
-
-template<class T>
-void GnssMeasurementCallback::translateGnssClock(JavaObject& object, const T& data) {
-    translateGnssClock(object, data.clock);
-}
-
-template<>
-void GnssMeasurementCallback::translateGnssClock(
-       JavaObject& object, const IGnssMeasurementCallback_V1_0::GnssClock& clock) {
-    uint32_t flags = static_cast<uint32_t>(clock.gnssClockFlags);
-    if (flags & static_cast<uint32_t>(GnssClockFlags::HAS_LEAP_SECOND)) {
-        SET(LeapSecond, static_cast<int32_t>(clock.leapSecond));
-    }
-
-    if (flags & static_cast<uint32_t>(GnssClockFlags::HAS_TIME_UNCERTAINTY)) {
-        SET(TimeUncertaintyNanos, clock.timeUncertaintyNs);
-    }
-
-    if (flags & static_cast<uint32_t>(GnssClockFlags::HAS_FULL_BIAS)) {
-        SET(FullBiasNanos, clock.fullBiasNs);
-    }
-
-    if (flags & static_cast<uint32_t>(GnssClockFlags::HAS_BIAS)) {
-        SET(BiasNanos, clock.biasNs);
-    }
-
-    if (flags & static_cast<uint32_t>(GnssClockFlags::HAS_BIAS_UNCERTAINTY)) {
-        SET(BiasUncertaintyNanos, clock.biasUncertaintyNs);
-    }
-
-    if (flags & static_cast<uint32_t>(GnssClockFlags::HAS_DRIFT)) {
-        SET(DriftNanosPerSecond, clock.driftNsps);
-    }
-
-    if (flags & static_cast<uint32_t>(GnssClockFlags::HAS_DRIFT_UNCERTAINTY)) {
-        SET(DriftUncertaintyNanosPerSecond, clock.driftUncertaintyNsps);
-    }
-
-    SET(TimeNanos, clock.timeNs);
-    SET(HardwareClockDiscontinuityCount, clock.hwClockDiscontinuityCount);
-}
-
-template<>
-void GnssMeasurementCallback::translateGnssClock(
-       JavaObject& object, const IGnssMeasurementCallback_V2_1::GnssClock& clock) {
-    JNIEnv* env = getJniEnv();
-    SET(ReferenceConstellationTypeForIsb,
-            static_cast<int32_t>(clock.referenceSignalTypeForIsb.constellation));
-    SET(ReferenceCarrierFrequencyHzForIsb, clock.referenceSignalTypeForIsb.carrierFrequencyHz);
-
-    jstring referenceCodeTypeForIsb =
-            env->NewStringUTF(clock.referenceSignalTypeForIsb.codeType.c_str());
-    SET(ReferenceCodeTypeForIsb, referenceCodeTypeForIsb);
-
-    translateGnssClock(object, clock.v1_0);
-
-    if (referenceCodeTypeForIsb) {
-        env->DeleteLocalRef(referenceCodeTypeForIsb);
-    }
-}
-
-template<>
-void GnssMeasurementCallback::translateGnssClock(
-       JavaObject& object, const IGnssMeasurementCallback_V2_0::GnssData& data) {
-    auto elapsedRealtime = data.elapsedRealtime;
-    uint16_t flags = static_cast<uint16_t>(elapsedRealtime.flags);
-    if (flags & ElapsedRealtimeFlags::HAS_TIMESTAMP_NS) {
-        SET(ElapsedRealtimeNanos, static_cast<uint64_t>(elapsedRealtime.timestampNs));
-    }
-    if (flags & ElapsedRealtimeFlags::HAS_TIME_UNCERTAINTY_NS) {
-        SET(ElapsedRealtimeUncertaintyNanos, static_cast<double>(elapsedRealtime.timeUncertaintyNs));
-    }
-    translateGnssClock(object, data.clock);
-}
-
-template<>
-void GnssMeasurementCallback::translateGnssClock(
-       JavaObject& object, const IGnssMeasurementCallback_V2_1::GnssData& data) {
-    auto elapsedRealtime = data.elapsedRealtime;
-    uint16_t flags = static_cast<uint16_t>(elapsedRealtime.flags);
-    if (flags & ElapsedRealtimeFlags::HAS_TIMESTAMP_NS) {
-        SET(ElapsedRealtimeNanos, static_cast<uint64_t>(elapsedRealtime.timestampNs));
-    }
-    if (flags & ElapsedRealtimeFlags::HAS_TIME_UNCERTAINTY_NS) {
-        SET(ElapsedRealtimeUncertaintyNanos, static_cast<double>(elapsedRealtime.timeUncertaintyNs));
-    }
-    translateGnssClock(object, data.clock);
-}
-
-template<class T>
-jobjectArray GnssMeasurementCallback::translateAllGnssMeasurements(JNIEnv* env,
-        const T* measurements,
-        size_t count) {
-    if (count == 0) {
-        return nullptr;
-    }
-
-    jobjectArray gnssMeasurementArray = env->NewObjectArray(
-            count,
-            class_gnssMeasurement,
-            nullptr /* initialElement */);
-
-    for (uint16_t i = 0; i < count; ++i) {
-        JavaObject object(env, class_gnssMeasurement, method_gnssMeasurementCtor);
-        translateSingleGnssMeasurement(&(measurements[i]), object);
-        jobject gnssMeasurement = object.get();
-        env->SetObjectArrayElement(gnssMeasurementArray, i, gnssMeasurement);
-        env->DeleteLocalRef(gnssMeasurement);
-    }
-
-    return gnssMeasurementArray;
-}
-
-void GnssMeasurementCallback::setMeasurementData(JNIEnv* env, jobject clock,
-                             jobjectArray measurementArray) {
-    jobject gnssMeasurementsEvent = env->NewObject(class_gnssMeasurementsEvent,
-                                                   method_gnssMeasurementsEventCtor,
-                                                   clock,
-                                                   measurementArray);
-
-    env->CallVoidMethod(mCallbacksObj, method_reportMeasurementData,
-                      gnssMeasurementsEvent);
-    checkAndClearExceptionFromCallback(env, __FUNCTION__);
-    env->DeleteLocalRef(gnssMeasurementsEvent);
-}
-
 /*
  * MeasurementCorrectionsCallback implements callback methods of interface
  * IMeasurementCorrectionsCallback.hal.
@@ -1971,6 +1952,10 @@ static void android_location_GnssLocationProvider_class_init_native(JNIEnv* env,
             clazz,
             "reportMeasurementData",
             "(Landroid/location/GnssMeasurementsEvent;)V");
+    method_reportMeasurementDataBuffer = env->GetMethodID(
+            clazz,
+            "reportMeasurementDataBuffer",
+            "(Ljava/nio/ByteBuffer;I)V");
     method_reportNavigationMessages = env->GetMethodID(
             clazz,
             "reportNavigationMessage",
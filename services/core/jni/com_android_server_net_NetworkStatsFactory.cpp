@@ -20,6 +20,9 @@
 #include <inttypes.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <jni.h>
@@ -60,6 +63,63 @@ static struct {
     jfieldID operations;
 } gNetworkStatsClassInfo;
 
+// Interface names recur on every poll, so intern them as global refs instead
+// of allocating a fresh jstring per row per snapshot.
+static std::mutex gIfaceCacheLock;
+static std::unordered_map<std::string, jstring> gIfaceCache;
+
+static jstring internIface(JNIEnv* env, const char* iface) {
+    std::lock_guard<std::mutex> guard(gIfaceCacheLock);
+    auto it = gIfaceCache.find(iface);
+    if (it != gIfaceCache.end()) {
+        return it->second;
+    }
+    ScopedLocalRef<jstring> local(env, env->NewStringUTF(iface));
+    if (local.get() == NULL) {
+        return NULL;
+    }
+    jstring global = static_cast<jstring>(env->NewGlobalRef(local.get()));
+    gIfaceCache.emplace(iface, global);
+    return global;
+}
+
+// Previous snapshot for the incremental collection mode, keyed by
+// (iface, uid, set, tag). Generations detect keys that disappear between
+// polls (e.g. after a counter reset) so the cache does not grow unbounded.
+struct StatsKey {
+    std::string iface;
+    uint32_t uid;
+    uint32_t set;
+    uint32_t tag;
+
+    bool operator==(const StatsKey& other) const {
+        return uid == other.uid && set == other.set && tag == other.tag
+                && iface == other.iface;
+    }
+};
+
+struct StatsKeyHash {
+    size_t operator()(const StatsKey& key) const {
+        size_t h = std::hash<std::string>()(key.iface);
+        h = h * 31 + key.uid;
+        h = h * 31 + key.set;
+        h = h * 31 + key.tag;
+        return h;
+    }
+};
+
+struct StatsSnapshotEntry {
+    uint64_t rxBytes;
+    uint64_t rxPackets;
+    uint64_t txBytes;
+    uint64_t txPackets;
+    uint64_t generation;
+};
+
+static std::mutex gSnapshotLock;
+static std::unordered_map<StatsKey, StatsSnapshotEntry, StatsKeyHash> gPreviousSnapshot;
+static uint64_t gSnapshotGeneration = 0;
+
 static jobjectArray get_string_array(JNIEnv* env, jobject obj, jfieldID field, int size, bool grow)
 {
     if (!grow) {
@@ -249,8 +309,7 @@ static int statsLinesToNetworkStats(JNIEnv* env, jclass clazz, jobject stats,
     if (operations.get() == NULL) return -1;
 
     for (int i = 0; i < size; i++) {
-        ScopedLocalRef<jstring> ifaceString(env, env->NewStringUTF(lines[i].iface));
-        env->SetObjectArrayElement(iface.get(), i, ifaceString.get());
+        env->SetObjectArrayElement(iface.get(), i, internIface(env, lines[i].iface));
 
         uid[i] = lines[i].uid;
         set[i] = lines[i].set;
@@ -282,10 +341,9 @@ static int statsLinesToNetworkStats(JNIEnv* env, jclass clazz, jobject stats,
     return 0;
 }
 
-static int readNetworkStatsDetail(JNIEnv* env, jclass clazz, jobject stats, jstring path,
-                                  jint limitUid, jobjectArray limitIfacesObj, jint limitTag,
-                                  jboolean useBpfStats) {
-
+static int collectNetworkStatsDetail(JNIEnv* env, jstring path, jint limitUid,
+                                     jobjectArray limitIfacesObj, jint limitTag,
+                                     jboolean useBpfStats, std::vector<stats_line>* lines) {
     std::vector<std::string> limitIfaces;
     if (limitIfacesObj != NULL && env->GetArrayLength(limitIfacesObj) > 0) {
         int num = env->GetArrayLength(limitIfacesObj);
@@ -297,11 +355,9 @@ static int readNetworkStatsDetail(JNIEnv* env, jclass clazz, jobject stats, jstr
             }
         }
     }
-    std::vector<stats_line> lines;
-
 
     if (useBpfStats) {
-        if (parseBpfNetworkStatsDetail(&lines, limitIfaces, limitTag, limitUid) < 0)
+        if (parseBpfNetworkStatsDetail(lines, limitIfaces, limitTag, limitUid) < 0)
             return -1;
     } else {
         ScopedUtfChars path8(env, path);
@@ -309,14 +365,92 @@ static int readNetworkStatsDetail(JNIEnv* env, jclass clazz, jobject stats, jstr
             ALOGE("the qtaguid legacy path is invalid: %s", path8.c_str());
             return -1;
         }
-        if (legacyReadNetworkStatsDetail(&lines, limitIfaces, limitTag,
+        if (legacyReadNetworkStatsDetail(lines, limitIfaces, limitTag,
                                          limitUid, path8.c_str()) < 0)
             return -1;
     }
+    return 0;
+}
 
+static int readNetworkStatsDetail(JNIEnv* env, jclass clazz, jobject stats, jstring path,
+                                  jint limitUid, jobjectArray limitIfacesObj, jint limitTag,
+                                  jboolean useBpfStats) {
+    std::vector<stats_line> lines;
+    if (collectNetworkStatsDetail(env, path, limitUid, limitIfacesObj, limitTag, useBpfStats,
+                                  &lines) < 0) {
+        return -1;
+    }
     return statsLinesToNetworkStats(env, clazz, stats, lines);
 }
 
+/**
+ * Incremental variant of readNetworkStatsDetail: compares the snapshot against
+ * the previous call and only returns rows whose counters moved by at least
+ * minDelta bytes+packets in total. Returned values are still cumulative; the
+ * managed caller must treat omitted rows as unchanged, not as reset. A row
+ * whose counters go backwards (counter reset) is always returned.
+ */
+static int readNetworkStatsDetailIncremental(JNIEnv* env, jclass clazz, jobject stats,
+                                             jstring path, jint limitUid,
+                                             jobjectArray limitIfacesObj, jint limitTag,
+                                             jboolean useBpfStats, jlong minDelta) {
+    std::vector<stats_line> lines;
+    if (collectNetworkStatsDetail(env, path, limitUid, limitIfacesObj, limitTag, useBpfStats,
+                                  &lines) < 0) {
+        return -1;
+    }
+
+    std::vector<stats_line> changed;
+    changed.reserve(lines.size());
+    {
+        std::lock_guard<std::mutex> guard(gSnapshotLock);
+        const uint64_t generation = ++gSnapshotGeneration;
+        for (const stats_line& s : lines) {
+            StatsKey key = {s.iface, s.uid, s.set, s.tag};
+            auto it = gPreviousSnapshot.find(key);
+            bool keep;
+            if (it == gPreviousSnapshot.end()) {
+                keep = true;
+                gPreviousSnapshot.emplace(std::move(key),
+                        StatsSnapshotEntry{s.rxBytes, s.rxPackets, s.txBytes, s.txPackets,
+                                           generation});
+            } else {
+                StatsSnapshotEntry& prev = it->second;
+                if (s.rxBytes < prev.rxBytes || s.rxPackets < prev.rxPackets
+                        || s.txBytes < prev.txBytes || s.txPackets < prev.txPackets) {
+                    // Counter reset; always report it.
+                    keep = true;
+                } else {
+                    uint64_t delta = (s.rxBytes - prev.rxBytes) + (s.rxPackets - prev.rxPackets)
+                            + (s.txBytes - prev.txBytes) + (s.txPackets - prev.txPackets);
+                    keep = delta >= static_cast<uint64_t>(minDelta > 0 ? minDelta : 1);
+                }
+                if (keep) {
+                    prev.rxBytes = s.rxBytes;
+                    prev.rxPackets = s.rxPackets;
+                    prev.txBytes = s.txBytes;
+                    prev.txPackets = s.txPackets;
+                }
+                prev.generation = generation;
+            }
+            if (keep) {
+                changed.push_back(s);
+            }
+        }
+        // Drop keys that vanished from the snapshot so the cache tracks the
+        // live key set.
+        for (auto it = gPreviousSnapshot.begin(); it != gPreviousSnapshot.end();) {
+            if (it->second.generation != generation) {
+                it = gPreviousSnapshot.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    return statsLinesToNetworkStats(env, clazz, stats, changed);
+}
+
 static int readNetworkStatsDev(JNIEnv* env, jclass clazz, jobject stats) {
     std::vector<stats_line> lines;
 
@@ -330,6 +464,9 @@ static const JNINativeMethod gMethods[] = {
         { "nativeReadNetworkStatsDetail",
                 "(Landroid/net/NetworkStats;Ljava/lang/String;I[Ljava/lang/String;IZ)I",
                 (void*) readNetworkStatsDetail },
+        { "nativeReadNetworkStatsDetailIncremental",
+                "(Landroid/net/NetworkStats;Ljava/lang/String;I[Ljava/lang/String;IZJ)I",
+                (void*) readNetworkStatsDetailIncremental },
         { "nativeReadNetworkStatsDev", "(Landroid/net/NetworkStats;)I",
                 (void*) readNetworkStatsDev },
 };
@@ -28,6 +28,8 @@
 #include <sys/eventfd.h>
 #include <sys/poll.h>
 
+#include <algorithm>
+#include <atomic>
 #include <charconv>
 #include <chrono>
 #include <span>
@@ -126,6 +128,22 @@ static bool sendRequest(int fd, RequestType requestType, FileIdx fileIdx = -1,
     return android::base::WriteFully(fd, &command, sizeof(command));
 }
 
+static void appendRequest(std::vector<RequestCommand>* requests, RequestType requestType,
+                          FileIdx fileIdx = -1, BlockIdx blockIdx = -1) {
+    requests->push_back(RequestCommand{.magic = INCR,
+                                       .requestType = static_cast<int16_t>(be16toh(requestType)),
+                                       .fileIdx = static_cast<int16_t>(be16toh(fileIdx)),
+                                       .blockIdx = static_cast<int32_t>(be32toh(blockIdx))});
+}
+
+static bool sendRequests(int fd, const std::vector<RequestCommand>& requests) {
+    if (requests.empty()) {
+        return true;
+    }
+    return android::base::WriteFully(fd, requests.data(),
+                                     requests.size() * sizeof(RequestCommand));
+}
+
 static int waitForDataOrSignal(int fd, int event_fd) {
     struct pollfd pfds[2] = {{fd, POLLIN, 0}, {event_fd, POLLIN, 0}};
     // Wait indefinitely until either data is ready or stop signal is received
@@ -426,14 +444,15 @@ private:
             return false;
         }
 
-        std::vector<char> buffer;
-        buffer.reserve(BUFFER_SIZE);
-
-        std::vector<IncFsDataBlock> blocks;
-        blocks.reserve(BLOCKS_COUNT);
-
-        unique_fd streamingFd;
-        MetadataMode streamingMode;
+        // Open all the inputs up front: the file lookups go through JNI and have to stay
+        // on this attached thread.
+        struct FileCopyJob {
+            base::unique_fd incfsFd;
+            InputDescs inputs;
+            std::string name;
+        };
+        std::vector<FileCopyJob> localJobs;  // independent fd-backed inputs
+        std::vector<FileCopyJob> streamJobs; // inputs read from the shared stdin stream
         for (auto&& file : addedFiles) {
             auto inputs = openInputs(env, jni, shellCommand, file.size, file.metadata);
             if (inputs.empty()) {
@@ -444,7 +463,7 @@ private:
             }
 
             const auto fileId = IncFs_FileIdFromMetadata(file.metadata);
-            const base::unique_fd incfsFd(mIfs->openForSpecialOps(fileId).release());
+            base::unique_fd incfsFd(mIfs->openForSpecialOps(fileId).release());
             if (incfsFd < 0) {
                 ALOGE("Failed to open an IncFS file for metadata: %.*s, final file name is: %s. "
                       "Error %d",
@@ -452,17 +471,73 @@ private:
                 return false;
             }
 
-            for (auto&& input : inputs) {
+            const bool local = std::none_of(inputs.begin(), inputs.end(), [](const auto& input) {
+                return input.waitOnEof || input.streaming;
+            });
+            auto& jobs = local ? localJobs : streamJobs;
+            jobs.push_back(FileCopyJob{std::move(incfsFd), std::move(inputs), file.name});
+        }
+
+        // Local files write their hash tree and data blocks into separate IncFS fds, so
+        // the files are installed concurrently: hash installation for one file overlaps
+        // data transfer for the others instead of serializing behind it.
+        std::atomic<bool> copyFailed{false};
+        std::atomic<size_t> nextJob{0};
+        auto copyJobs = [this, &localJobs, &copyFailed, &nextJob]() {
+            std::vector<char> buffer;
+            buffer.reserve(BUFFER_SIZE);
+            std::vector<IncFsDataBlock> blocks;
+            blocks.reserve(BLOCKS_COUNT);
+            size_t index;
+            while (!copyFailed && (index = nextJob.fetch_add(1)) < localJobs.size()) {
+                auto& job = localJobs[index];
+                for (auto&& input : job.inputs) {
+                    if (!copyToIncFs(job.incfsFd, input.size, input.kind, input.fd,
+                                     input.waitOnEof, &buffer, &blocks)) {
+                        ALOGE("Failed to copy data to IncFS file, final file name is: %s. "
+                              "Error %d",
+                              job.name.c_str(), errno);
+                        copyFailed = true;
+                        break;
+                    }
+                }
+            }
+        };
+        const auto numThreads = std::min(
+                localJobs.size(), size_t(std::max(1u, std::thread::hardware_concurrency())));
+        if (numThreads <= 1) {
+            copyJobs();
+        } else {
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < numThreads; ++i) {
+                threads.emplace_back(copyJobs);
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+        if (copyFailed) {
+            return false;
+        }
+
+        std::vector<char> buffer;
+        buffer.reserve(BUFFER_SIZE);
+
+        std::vector<IncFsDataBlock> blocks;
+        blocks.reserve(BLOCKS_COUNT);
+
+        unique_fd streamingFd;
+        MetadataMode streamingMode;
+        for (auto& job : streamJobs) {
+            for (auto&& input : job.inputs) {
                 if (input.streaming && !streamingFd.ok()) {
                     streamingFd.reset(dup(input.fd));
                     streamingMode = input.mode;
                 }
-                if (!copyToIncFs(incfsFd, input.size, input.kind, input.fd, input.waitOnEof,
+                if (!copyToIncFs(job.incfsFd, input.size, input.kind, input.fd, input.waitOnEof,
                                  &buffer, &blocks)) {
-                    ALOGE("Failed to copy data to IncFS file for metadata: %.*s, final file name "
-                          "is: %s. "
-                          "Error %d",
-                          int(file.metadata.size), file.metadata.data, file.name, errno);
+                    ALOGE("Failed to copy data to IncFS file, final file name is: %s. Error %d",
+                          job.name.c_str(), errno);
                     return false;
                 }
             }
@@ -649,6 +724,13 @@ private:
             return;
         }
         CHECK(mIfs);
+        // A batch of misses arrives in the order the app touched its pages, so the requests
+        // preserve that order: each newly touched file gets a PREFETCH so the host streams it
+        // ahead of the reader, followed by the individual misses. The whole batch goes out in
+        // one write instead of one syscall and one stream packet per request.
+        std::vector<RequestCommand> requests;
+        requests.reserve(2 * pendingReads.size());
+        std::vector<FileIdx> newFileRequests;
         for (auto&& pendingRead : pendingReads) {
             const android::dataloader::FileId& fileId = pendingRead.id;
             const auto blockIdx = static_cast<BlockIdx>(pendingRead.block);
@@ -661,11 +743,17 @@ private:
                       android::incfs::toString(fileId).c_str());
                 continue;
             }
-            if (mRequestedFiles.insert(fileIdx).second &&
-                !sendRequest(mOutFd, PREFETCH, fileIdx, blockIdx)) {
+            if (mRequestedFiles.insert(fileIdx).second) {
+                newFileRequests.push_back(fileIdx);
+                appendRequest(&requests, PREFETCH, fileIdx, blockIdx);
+            }
+            appendRequest(&requests, BLOCK_MISSING, fileIdx, blockIdx);
+        }
+        if (!sendRequests(mOutFd, requests)) {
+            // Resend the prefetch requests with the next batch of misses.
+            for (FileIdx fileIdx : newFileRequests) {
                 mRequestedFiles.erase(fileIdx);
             }
-            sendRequest(mOutFd, BLOCK_MISSING, fileIdx, blockIdx);
         }
     }
 
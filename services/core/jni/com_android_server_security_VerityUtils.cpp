@@ -17,6 +17,7 @@
 #define LOG_TAG "VerityUtils"
 
 #include <nativehelper/JNIHelp.h>
+#include <nativehelper/ScopedLocalRef.h>
 #include <nativehelper/ScopedPrimitiveArray.h>
 #include <nativehelper/ScopedUtfChars.h>
 #include "jni.h"
@@ -33,23 +34,23 @@
 
 #include <android-base/unique_fd.h>
 
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
 namespace android {
 
 namespace {
 
-int enableFsverity(JNIEnv* env, jobject /* clazz */, jstring filePath, jbyteArray signature) {
-    ScopedUtfChars path(env, filePath);
-    if (path.c_str() == nullptr) {
-        return EINVAL;
-    }
-    ::android::base::unique_fd rfd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+// Issues FS_IOC_ENABLE_VERITY for one file. Returns 0 or an errno. The ioctl
+// blocks while the kernel hashes the whole file to build its Merkle tree.
+int enableFsverityForFile(const char* path, const uint8_t* signature, size_t signatureSize) {
+    ::android::base::unique_fd rfd(open(path, O_RDONLY | O_CLOEXEC));
     if (rfd.get() < 0) {
         return errno;
     }
-    ScopedByteArrayRO signature_bytes(env, signature);
-    if (signature_bytes.get() == nullptr) {
-        return EINVAL;
-    }
 
     fsverity_enable_arg arg = {};
     arg.version = 1;
@@ -57,8 +58,8 @@ int enableFsverity(JNIEnv* env, jobject /* clazz */, jstring filePath, jbyteArra
     arg.block_size = 4096;
     arg.salt_size = 0;
     arg.salt_ptr = reinterpret_cast<uintptr_t>(nullptr);
-    arg.sig_size = signature_bytes.size();
-    arg.sig_ptr = reinterpret_cast<uintptr_t>(signature_bytes.get());
+    arg.sig_size = signatureSize;
+    arg.sig_ptr = reinterpret_cast<uintptr_t>(signature);
 
     if (ioctl(rfd.get(), FS_IOC_ENABLE_VERITY, &arg) < 0) {
         return errno;
@@ -66,6 +67,91 @@ int enableFsverity(JNIEnv* env, jobject /* clazz */, jstring filePath, jbyteArra
     return 0;
 }
 
+int enableFsverity(JNIEnv* env, jobject /* clazz */, jstring filePath, jbyteArray signature) {
+    ScopedUtfChars path(env, filePath);
+    if (path.c_str() == nullptr) {
+        return EINVAL;
+    }
+    ScopedByteArrayRO signature_bytes(env, signature);
+    if (signature_bytes.get() == nullptr) {
+        return EINVAL;
+    }
+    return enableFsverityForFile(path.c_str(),
+            reinterpret_cast<const uint8_t*>(signature_bytes.get()), signature_bytes.size());
+}
+
+// Enables fs-verity on a batch of files across a worker pool, overlapping the
+// kernel's per-file Merkle-tree hashing, and returns one errno per file
+// (0 on success). One call covers the whole partition's worth of files.
+jintArray enableFsverityBatch(JNIEnv* env, jobject /* clazz */, jobjectArray filePaths,
+                              jobjectArray signatures, jint numThreads) {
+    if (filePaths == nullptr || signatures == nullptr) {
+        jniThrowNullPointerException(env, nullptr);
+        return nullptr;
+    }
+    const jsize count = env->GetArrayLength(filePaths);
+    if (env->GetArrayLength(signatures) != count) {
+        jniThrowException(env, "java/lang/IllegalArgumentException",
+                "filePaths and signatures must be the same length");
+        return nullptr;
+    }
+
+    // Copy everything out of the VM first; workers must not touch JNIEnv.
+    std::vector<std::string> paths(count);
+    std::vector<std::vector<uint8_t>> sigs(count);
+    for (jsize i = 0; i < count; ++i) {
+        ScopedLocalRef<jstring> jPath(env, (jstring)env->GetObjectArrayElement(filePaths, i));
+        ScopedLocalRef<jbyteArray> jSig(env,
+                (jbyteArray)env->GetObjectArrayElement(signatures, i));
+        if (jPath.get() == nullptr || jSig.get() == nullptr) {
+            jniThrowNullPointerException(env, nullptr);
+            return nullptr;
+        }
+        ScopedUtfChars path(env, jPath.get());
+        ScopedByteArrayRO sig(env, jSig.get());
+        if (path.c_str() == nullptr || sig.get() == nullptr) {
+            return nullptr;
+        }
+        paths[i] = path.c_str();
+        sigs[i].assign(sig.get(), sig.get() + sig.size());
+    }
+
+    std::vector<jint> results(count, 0);
+    if (count > 0) {
+        size_t threadCount = std::max(1, numThreads);
+        threadCount = std::min(threadCount, (size_t)count);
+        threadCount = std::min(threadCount,
+                std::max<size_t>(1, std::thread::hardware_concurrency()));
+
+        std::atomic<size_t> nextFile(0);
+        auto worker = [&]() {
+            size_t i;
+            while ((i = nextFile.fetch_add(1)) < (size_t)count) {
+                results[i] = enableFsverityForFile(paths[i].c_str(),
+                        sigs[i].empty() ? nullptr : sigs[i].data(), sigs[i].size());
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < threadCount; ++t) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : workers) {
+            thread.join();
+        }
+    }
+
+    jintArray resultArray = env->NewIntArray(count);
+    if (resultArray == nullptr) {
+        return nullptr;
+    }
+    if (count > 0) {
+        env->SetIntArrayRegion(resultArray, 0, count, results.data());
+    }
+    return resultArray;
+}
+
 // Returns whether the file has fs-verity enabled.
 // 0 if it is not present, 1 if is present, and -errno if there was an error.
 int statxForFsverity(JNIEnv *env, jobject /* clazz */, jstring filePath) {
@@ -87,6 +173,7 @@ int statxForFsverity(JNIEnv *env, jobject /* clazz */, jstring filePath) {
 
 const JNINativeMethod sMethods[] = {
         {"enableFsverityNative", "(Ljava/lang/String;[B)I", (void *)enableFsverity},
+        {"enableFsverityBatchNative", "([Ljava/lang/String;[[BI)[I", (void *)enableFsverityBatch},
         {"statxForFsverityNative", "(Ljava/lang/String;)I", (void *)statxForFsverity},
 };
 
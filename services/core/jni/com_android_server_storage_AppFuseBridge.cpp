@@ -25,6 +25,8 @@
 #include <libappfuse/FuseBuffer.h>
 #include <nativehelper/JNIHelp.h>
 
+#include <sys/socket.h>
+
 namespace android {
 namespace {
 
@@ -116,6 +118,22 @@ jint com_android_server_storage_AppFuseBridge_add_bridge(
         return -1;
     }
 
+    // A FUSE read reply carries up to a 128KB payload plus headers. Size the
+    // proxy socket buffers so a whole message moves in one send/recv instead
+    // of fragmenting into several wakeups per chunk, which is what large
+    // sequential transfers (USB file streaming) otherwise pay.
+    constexpr int kProxyBufferSize = 256 * 1024;
+    for (const auto& fd : proxyFd) {
+        if (setsockopt(fd.get(), SOL_SOCKET, SO_SNDBUF, &kProxyBufferSize,
+                       sizeof(kProxyBufferSize)) != 0 ||
+            setsockopt(fd.get(), SOL_SOCKET, SO_RCVBUF, &kProxyBufferSize,
+                       sizeof(kProxyBufferSize)) != 0) {
+            // Not fatal; the bridge still works with the default buffers.
+            PLOG(WARNING) << "Failed to resize proxy socket buffers";
+            break;
+        }
+    }
+
     if (!loop->AddBridge(mountId, std::move(devFd), std::move(proxyFd[0]))) {
         return -1;
     }
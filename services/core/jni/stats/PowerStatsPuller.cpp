@@ -20,6 +20,7 @@
 #include <android/hardware/power/stats/1.0/IPowerStats.h>
 #include <log/log.h>
 #include <statslog.h>
+#include <utils/Timers.h>
 
 #include <vector>
 
@@ -42,6 +43,37 @@ static std::mutex gPowerStatsHalMutex;
 static bool gPowerStatsExist = true; // Initialized to ensure making a first attempt.
 static std::vector<RailInfo> gRailInfo;
 
+// Rail energy data is cumulative and changes slowly, so when several statsd
+// configs pull this atom at (nearly) the same time they can all be served from
+// one HAL collection. Results younger than this window are replayed from the
+// cache instead of making another getEnergyData() round trip.
+static constexpr int64_t kEnergyDataFreshNs = ms2ns(1000);
+static std::vector<EnergyData> gCachedEnergyData;
+static int64_t gCachedEnergyDataTimeNs = 0;
+
+// Writes one ON_DEVICE_POWER_MEASUREMENT event for the given rail sample.
+// Returns false if the sample refers to a rail we have no info for.
+// The caller must be holding gPowerStatsHalMutex.
+static bool writeEnergyDataLocked(const EnergyData& energyData, AStatsEventList* data) {
+    if (energyData.index >= gRailInfo.size()) {
+        ALOGE("power.stats getEnergyData() returned an invalid rail index %u.", energyData.index);
+        return false;
+    }
+    const RailInfo& rail = gRailInfo[energyData.index];
+
+    AStatsEvent* event = AStatsEventList_addStatsEvent(data);
+    AStatsEvent_setAtomId(event, android::util::ON_DEVICE_POWER_MEASUREMENT);
+    AStatsEvent_writeString(event, rail.subsysName.c_str());
+    AStatsEvent_writeString(event, rail.railName.c_str());
+    AStatsEvent_writeInt64(event, energyData.timestamp);
+    AStatsEvent_writeInt64(event, energyData.energy);
+    AStatsEvent_build(event);
+
+    ALOGV("power.stat: %s.%s: %llu, %llu", rail.subsysName.c_str(), rail.railName.c_str(),
+          (unsigned long long)energyData.timestamp, (unsigned long long)energyData.energy);
+    return true;
+}
+
 struct PowerStatsPullerDeathRecipient : virtual public hardware::hidl_death_recipient {
     virtual void serviceDied(uint64_t cookie,
                              const wp<android::hidl::base::V1_0::IBase>& who) override {
@@ -82,6 +114,17 @@ AStatsManager_PullAtomCallbackReturn PowerStatsPuller::Pull(int32_t atomTag,
                                                             AStatsEventList* data) {
     std::lock_guard<std::mutex> lock(gPowerStatsHalMutex);
 
+    // Serve concurrent pulls of the same atom from the last collection.
+    const int64_t nowNs = systemTime(SYSTEM_TIME_MONOTONIC);
+    if (!gCachedEnergyData.empty() && nowNs - gCachedEnergyDataTimeNs < kEnergyDataFreshNs) {
+        for (const EnergyData& energyData : gCachedEnergyData) {
+            if (!writeEnergyDataLocked(energyData, data)) {
+                return AStatsManager_PULL_SKIP;
+            }
+        }
+        return AStatsManager_PULL_SUCCESS;
+    }
+
     if (!getPowerStatsHalLocked()) {
         return AStatsManager_PULL_SKIP;
     }
@@ -115,41 +158,24 @@ AStatsManager_PullAtomCallbackReturn PowerStatsPuller::Pull(int32_t atomTag,
     // Pull getEnergyData and write the data out
     const hidl_vec<uint32_t> desiredRailIndices; // Empty vector indicates we want all.
     bool resultSuccess = true;
+    std::vector<EnergyData> energyDataSnapshot;
     Return<void> ret =
             gPowerStatsHal
                     ->getEnergyData(desiredRailIndices,
-                                    [&data, &resultSuccess](hidl_vec<EnergyData> energyDataList,
-                                                            Status status) {
+                                    [&data, &resultSuccess, &energyDataSnapshot](
+                                            hidl_vec<EnergyData> energyDataList, Status status) {
                                         resultSuccess = (status == Status::SUCCESS);
                                         if (!resultSuccess) return;
 
+                                        energyDataSnapshot.reserve(energyDataList.size());
                                         for (size_t i = 0; i < energyDataList.size(); i++) {
                                             const EnergyData& energyData = energyDataList[i];
 
-                                            if (energyData.index >= gRailInfo.size()) {
-                                                ALOGE("power.stats getEnergyData() returned an "
-                                                      "invalid rail index %u.",
-                                                      energyData.index);
+                                            if (!writeEnergyDataLocked(energyData, data)) {
                                                 resultSuccess = false;
                                                 return;
                                             }
-                                            const RailInfo& rail = gRailInfo[energyData.index];
-
-                                            AStatsEvent* event =
-                                                    AStatsEventList_addStatsEvent(data);
-                                            AStatsEvent_setAtomId(
-                                                    event,
-                                                    android::util::ON_DEVICE_POWER_MEASUREMENT);
-                                            AStatsEvent_writeString(event, rail.subsysName.c_str());
-                                            AStatsEvent_writeString(event, rail.railName.c_str());
-                                            AStatsEvent_writeInt64(event, energyData.timestamp);
-                                            AStatsEvent_writeInt64(event, energyData.energy);
-                                            AStatsEvent_build(event);
-
-                                            ALOGV("power.stat: %s.%s: %llu, %llu",
-                                                  rail.subsysName.c_str(), rail.railName.c_str(),
-                                                  (unsigned long long)energyData.timestamp,
-                                                  (unsigned long long)energyData.energy);
+                                            energyDataSnapshot.push_back(energyData);
                                         }
                                     });
     if (!resultSuccess || !ret.isOk()) {
@@ -157,6 +183,8 @@ AStatsManager_PullAtomCallbackReturn PowerStatsPuller::Pull(int32_t atomTag,
         gPowerStatsHal = nullptr;
         return AStatsManager_PULL_SKIP;
     }
+    gCachedEnergyData = std::move(energyDataSnapshot);
+    gCachedEnergyDataTimeNs = nowNs;
     return AStatsManager_PULL_SUCCESS;
 }
 
@@ -19,6 +19,7 @@
 
 #include <log/log.h>
 #include <statslog.h>
+#include <utils/Timers.h>
 
 #include <android/hardware/power/1.0/IPower.h>
 #include <android/hardware/power/1.1/IPower.h>
@@ -35,7 +36,9 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <string>
 #include <unordered_map>
+#include <vector>
 #include "SubsystemSleepStatePuller.h"
 
 using android::hardware::hidl_vec;
@@ -55,9 +58,41 @@ namespace android {
 namespace server {
 namespace stats {
 
-static std::function<AStatsManager_PullAtomCallbackReturn(int32_t atomTag, AStatsEventList* data)>
+// One SUBSYSTEM_SLEEP_STATE row. Every HAL variant reports the same shape:
+// a subsystem name, a sub-state (or voter) name and two cumulative counters.
+// Collecting rows instead of writing events directly lets Pull() cache the
+// last collection and replay it for near-simultaneous pulls.
+struct SleepStateRow {
+    std::string subsystemName;
+    std::string subStateName;
+    int64_t count;
+    int64_t timeMs;
+};
+
+static std::function<AStatsManager_PullAtomCallbackReturn(int32_t atomTag,
+                                                          std::vector<SleepStateRow>* rows)>
         gPuller = {};
 
+// Sleep state residency counters are cumulative and cheap to replay, so when
+// several statsd configs pull this atom at (nearly) the same time they share
+// one HAL collection. Rows younger than this window come from the cache.
+static constexpr int64_t kSleepStateRowsFreshNs = ms2ns(1000);
+static std::vector<SleepStateRow> gCachedRows;
+static int64_t gCachedRowsTimeNs = 0;
+static bool gCachedRowsValid = false;
+
+static void writeSleepStateRows(const std::vector<SleepStateRow>& rows, AStatsEventList* data) {
+    for (const SleepStateRow& row : rows) {
+        AStatsEvent* event = AStatsEventList_addStatsEvent(data);
+        AStatsEvent_setAtomId(event, android::util::SUBSYSTEM_SLEEP_STATE);
+        AStatsEvent_writeString(event, row.subsystemName.c_str());
+        AStatsEvent_writeString(event, row.subStateName.c_str());
+        AStatsEvent_writeInt64(event, row.count);
+        AStatsEvent_writeInt64(event, row.timeMs);
+        AStatsEvent_build(event);
+    }
+}
+
 static sp<android::hardware::power::V1_0::IPower> gPowerHalV1_0 = nullptr;
 static sp<android::hardware::power::V1_1::IPower> gPowerHalV1_1 = nullptr;
 static sp<android::hardware::power::stats::V1_0::IPowerStats> gPowerStatsHalV1_0 = nullptr;
@@ -176,8 +211,8 @@ static bool getPowerStatsHalLocked() {
 }
 
 // The caller must be holding gPowerHalMutex.
-static AStatsManager_PullAtomCallbackReturn getIPowerStatsDataLocked(int32_t atomTag,
-                                                                     AStatsEventList* data) {
+static AStatsManager_PullAtomCallbackReturn getIPowerStatsDataLocked(
+        int32_t atomTag, std::vector<SleepStateRow>* rows) {
     using android::hardware::power::stats::V1_0::Status;
 
     if(!getPowerStatsHalLocked()) {
@@ -186,7 +221,7 @@ static AStatsManager_PullAtomCallbackReturn getIPowerStatsDataLocked(int32_t ato
     // Get power entity state residency data
     bool success = false;
     Return<void> ret = gPowerStatsHalV1_0->getPowerEntityStateResidencyData(
-            {}, [&data, &success](auto results, auto status) {
+            {}, [&rows, &success](auto results, auto status) {
                 if (status == Status::NOT_SUPPORTED) {
                     ALOGW("getPowerEntityStateResidencyData is not supported");
                     success = false;
@@ -194,17 +229,13 @@ static AStatsManager_PullAtomCallbackReturn getIPowerStatsDataLocked(int32_t ato
                 }
                 for (auto result : results) {
                     for (auto stateResidency : result.stateResidencyData) {
-                        AStatsEvent* event = AStatsEventList_addStatsEvent(data);
-                        AStatsEvent_setAtomId(event, android::util::SUBSYSTEM_SLEEP_STATE);
-                        AStatsEvent_writeString(event,
-                                                gEntityNames.at(result.powerEntityId).c_str());
-                        AStatsEvent_writeString(event,
-                                                gStateNames.at(result.powerEntityId)
-                                                        .at(stateResidency.powerEntityStateId)
-                                                        .c_str());
-                        AStatsEvent_writeInt64(event, stateResidency.totalStateEntryCount);
-                        AStatsEvent_writeInt64(event, stateResidency.totalTimeInStateMs);
-                        AStatsEvent_build(event);
+                        rows->push_back({gEntityNames.at(result.powerEntityId),
+                                         gStateNames.at(result.powerEntityId)
+                                                 .at(stateResidency.powerEntityStateId),
+                                         static_cast<int64_t>(
+                                                 stateResidency.totalStateEntryCount),
+                                         static_cast<int64_t>(
+                                                 stateResidency.totalTimeInStateMs)});
                     }
                 }
                 success = true;
@@ -244,8 +275,8 @@ static bool getPowerHalLocked() {
 }
 
 // The caller must be holding gPowerHalMutex.
-static AStatsManager_PullAtomCallbackReturn getIPowerDataLocked(int32_t atomTag,
-                                                                AStatsEventList* data) {
+static AStatsManager_PullAtomCallbackReturn getIPowerDataLocked(
+        int32_t atomTag, std::vector<SleepStateRow>* rows) {
     using android::hardware::power::V1_0::Status;
 
     if(!getPowerHalLocked()) {
@@ -254,31 +285,24 @@ static AStatsManager_PullAtomCallbackReturn getIPowerDataLocked(int32_t atomTag,
 
         Return<void> ret;
         ret = gPowerHalV1_0->getPlatformLowPowerStats(
-                [&data](hidl_vec<PowerStatePlatformSleepState> states, Status status) {
+                [&rows](hidl_vec<PowerStatePlatformSleepState> states, Status status) {
                     if (status != Status::SUCCESS) return;
 
                     for (size_t i = 0; i < states.size(); i++) {
                         const PowerStatePlatformSleepState& state = states[i];
-                        AStatsEvent* event = AStatsEventList_addStatsEvent(data);
-                        AStatsEvent_setAtomId(event, android::util::SUBSYSTEM_SLEEP_STATE);
-                        AStatsEvent_writeString(event, state.name.c_str());
-                        AStatsEvent_writeString(event, "");
-                        AStatsEvent_writeInt64(event, state.totalTransitions);
-                        AStatsEvent_writeInt64(event, state.residencyInMsecSinceBoot);
-                        AStatsEvent_build(event);
+                        rows->push_back({state.name, "",
+                                         static_cast<int64_t>(state.totalTransitions),
+                                         static_cast<int64_t>(state.residencyInMsecSinceBoot)});
 
                         ALOGV("powerstate: %s, %lld, %lld, %d", state.name.c_str(),
                               (long long)state.residencyInMsecSinceBoot,
                               (long long)state.totalTransitions,
                               state.supportedOnlyInSuspend ? 1 : 0);
                         for (const auto& voter : state.voters) {
-                            AStatsEvent* event = AStatsEventList_addStatsEvent(data);
-                            AStatsEvent_setAtomId(event, android::util::SUBSYSTEM_SLEEP_STATE);
-                            AStatsEvent_writeString(event, state.name.c_str());
-                            AStatsEvent_writeString(event, voter.name.c_str());
-                            AStatsEvent_writeInt64(event, voter.totalNumberOfTimesVotedSinceBoot);
-                            AStatsEvent_writeInt64(event, voter.totalTimeInMsecVotedForSinceBoot);
-                            AStatsEvent_build(event);
+                            rows->push_back(
+                                    {state.name, voter.name,
+                                     static_cast<int64_t>(voter.totalNumberOfTimesVotedSinceBoot),
+                                     static_cast<int64_t>(voter.totalTimeInMsecVotedForSinceBoot)});
 
                             ALOGV("powerstatevoter: %s, %s, %lld, %lld", state.name.c_str(),
                                   voter.name.c_str(),
@@ -296,7 +320,7 @@ static AStatsManager_PullAtomCallbackReturn getIPowerDataLocked(int32_t atomTag,
                 android::hardware::power::V1_1::IPower::castFrom(gPowerHalV1_0);
         if (gPowerHal_1_1 != nullptr) {
             ret = gPowerHal_1_1->getSubsystemLowPowerStats(
-                    [&data](hidl_vec<PowerStateSubsystem> subsystems, Status status) {
+                    [&rows](hidl_vec<PowerStateSubsystem> subsystems, Status status) {
                         if (status != Status::SUCCESS) return;
 
                         if (subsystems.size() > 0) {
@@ -305,14 +329,11 @@ static AStatsManager_PullAtomCallbackReturn getIPowerDataLocked(int32_t atomTag,
                                 for (size_t j = 0; j < subsystem.states.size(); j++) {
                                     const PowerStateSubsystemSleepState& state =
                                             subsystem.states[j];
-                                    AStatsEvent* event = AStatsEventList_addStatsEvent(data);
-                                    AStatsEvent_setAtomId(event,
-                                                          android::util::SUBSYSTEM_SLEEP_STATE);
-                                    AStatsEvent_writeString(event, subsystem.name.c_str());
-                                    AStatsEvent_writeString(event, state.name.c_str());
-                                    AStatsEvent_writeInt64(event, state.totalTransitions);
-                                    AStatsEvent_writeInt64(event, state.residencyInMsecSinceBoot);
-                                    AStatsEvent_build(event);
+                                    rows->push_back(
+                                            {subsystem.name, state.name,
+                                             static_cast<int64_t>(state.totalTransitions),
+                                             static_cast<int64_t>(
+                                                     state.residencyInMsecSinceBoot)});
 
                                     ALOGV("subsystemstate: %s, %s, %lld, %lld, %lld",
                                           subsystem.name.c_str(), state.name.c_str(),
@@ -328,9 +349,11 @@ static AStatsManager_PullAtomCallbackReturn getIPowerDataLocked(int32_t atomTag,
 }
 
 // The caller must be holding gPowerHalMutex.
-std::function<AStatsManager_PullAtomCallbackReturn(int32_t atomTag, AStatsEventList* data)>
+std::function<AStatsManager_PullAtomCallbackReturn(int32_t atomTag,
+                                                   std::vector<SleepStateRow>* rows)>
 getPullerLocked() {
-    std::function<AStatsManager_PullAtomCallbackReturn(int32_t atomTag, AStatsEventList * data)>
+    std::function<AStatsManager_PullAtomCallbackReturn(int32_t atomTag,
+                                                       std::vector<SleepStateRow> * rows)>
             ret = {};
 
     // First see if power.stats HAL is available. Fall back to power HAL if
@@ -350,12 +373,28 @@ AStatsManager_PullAtomCallbackReturn SubsystemSleepStatePuller::Pull(int32_t ato
                                                                      AStatsEventList* data) {
     std::lock_guard<std::mutex> lock(gPowerHalMutex);
 
+    // Serve concurrent pulls of the same atom from the last collection.
+    const int64_t nowNs = systemTime(SYSTEM_TIME_MONOTONIC);
+    if (gCachedRowsValid && nowNs - gCachedRowsTimeNs < kSleepStateRowsFreshNs) {
+        writeSleepStateRows(gCachedRows, data);
+        return AStatsManager_PULL_SUCCESS;
+    }
+
     if(!gPuller) {
         gPuller = getPullerLocked();
     }
 
     if(gPuller) {
-        return gPuller(atomTag, data);
+        std::vector<SleepStateRow> rows;
+        AStatsManager_PullAtomCallbackReturn result = gPuller(atomTag, &rows);
+        if (result != AStatsManager_PULL_SUCCESS) {
+            return result;
+        }
+        writeSleepStateRows(rows, data);
+        gCachedRows = std::move(rows);
+        gCachedRowsTimeNs = nowNs;
+        gCachedRowsValid = true;
+        return AStatsManager_PULL_SUCCESS;
     }
 
     ALOGE("Unable to load Power Hal or power.stats HAL");
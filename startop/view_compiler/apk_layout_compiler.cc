@@ -24,8 +24,13 @@
 #include "androidfw/AssetManager2.h"
 #include "androidfw/ResourceTypes.h"
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <locale>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #include "android-base/stringprintf.h"
 
@@ -80,6 +85,15 @@ bool CanCompileLayout(ResXMLParser* parser) {
 }
 
 namespace {
+
+// A layout in the APK being compiled, with its XML tree parsed out of the assets.
+struct LayoutCompilationJob {
+  std::string layout_path;
+  std::string layout_name;
+  std::unique_ptr<android::ResXMLTree> xml_tree;
+  bool can_compile = false;
+};
+
 void CompileApkAssetsLayouts(const std::unique_ptr<const android::ApkAssets>& assets,
                              CompilationTarget target, std::ostream& target_out) {
   android::AssetManager2 resources;
@@ -95,11 +109,9 @@ void CompileApkAssetsLayouts(const std::unique_ptr<const android::ApkAssets>& as
     first = false;
   }
 
-  dex::DexBuilder dex_file;
-  dex::ClassBuilder compiled_view{
-      dex_file.MakeClass(StringPrintf("%s.CompiledView", package_name.c_str()))};
-  std::vector<dex::MethodBuilder> methods;
-
+  // Open and parse every layout's XML tree. The AssetManager is not thread-safe, so this
+  // phase stays on a single thread.
+  std::vector<LayoutCompilationJob> jobs;
   assets->GetAssetsProvider()->ForEachFile("res/", [&](const android::StringPiece& s,
                                                        android::FileType) {
     if (s == "layout") {
@@ -113,45 +125,81 @@ void CompileApkAssetsLayouts(const std::unique_ptr<const android::ApkAssets>& as
         CHECK(android::kInvalidCookie != cookie);
         const auto dynamic_ref_table = resources.GetDynamicRefTableForCookie(cookie);
         CHECK(nullptr != dynamic_ref_table);
-        android::ResXMLTree xml_tree{dynamic_ref_table};
-        xml_tree.setTo(asset->getBuffer(/*wordAligned=*/true),
-                       asset->getLength(),
-                       /*copy_data=*/true);
-        android::ResXMLParser parser{xml_tree};
-        parser.restart();
-        if (CanCompileLayout(&parser)) {
-          parser.restart();
-          const std::string layout_name = startop::util::FindLayoutNameFromFilename(layout_path);
-          ResXmlVisitorAdapter adapter{&parser};
-          switch (target) {
-            case CompilationTarget::kDex: {
-              methods.push_back(compiled_view.CreateMethod(
-                  layout_name,
-                  dex::Prototype{dex::TypeDescriptor::FromClassname("android.view.View"),
-                                 dex::TypeDescriptor::FromClassname("android.content.Context"),
-                                 dex::TypeDescriptor::Int()}));
-              DexViewBuilder builder(&methods.back());
-              builder.Start();
-              LayoutCompilerVisitor visitor{&builder};
-              adapter.Accept(&visitor);
-              builder.Finish();
-              methods.back().Encode();
-              break;
-            }
-            case CompilationTarget::kJavaLanguage: {
-              JavaLangViewBuilder builder{package_name, layout_name, target_out};
-              builder.Start();
-              LayoutCompilerVisitor visitor{&builder};
-              adapter.Accept(&visitor);
-              builder.Finish();
-              break;
-            }
-          }
-        }
+        auto xml_tree = std::make_unique<android::ResXMLTree>(dynamic_ref_table);
+        xml_tree->setTo(asset->getBuffer(/*wordAligned=*/true),
+                        asset->getLength(),
+                        /*copy_data=*/true);
+        jobs.push_back(LayoutCompilationJob{layout_path,
+                                            startop::util::FindLayoutNameFromFilename(layout_path),
+                                            std::move(xml_tree)});
       });
     }
   });
 
+  // Validating a layout only walks its own tree, so the batch is checked on multiple threads.
+  std::atomic<size_t> next_job{0};
+  auto validate_jobs = [&jobs, &next_job]() {
+    size_t index;
+    while ((index = next_job.fetch_add(1)) < jobs.size()) {
+      android::ResXMLParser parser{*jobs[index].xml_tree};
+      parser.restart();
+      jobs[index].can_compile = CanCompileLayout(&parser);
+    }
+  };
+  const size_t num_threads = std::min(
+      jobs.size(), static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency())));
+  if (num_threads <= 1) {
+    validate_jobs();
+  } else {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_threads; i++) {
+      threads.emplace_back(validate_jobs);
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+
+  // The DexBuilder interns strings and types into pools shared by every method, so code
+  // generation stays on a single thread.
+  dex::DexBuilder dex_file;
+  dex::ClassBuilder compiled_view{
+      dex_file.MakeClass(StringPrintf("%s.CompiledView", package_name.c_str()))};
+  std::vector<dex::MethodBuilder> methods;
+
+  for (const LayoutCompilationJob& job : jobs) {
+    if (!job.can_compile) {
+      continue;
+    }
+    android::ResXMLParser parser{*job.xml_tree};
+    parser.restart();
+    ResXmlVisitorAdapter adapter{&parser};
+    switch (target) {
+      case CompilationTarget::kDex: {
+        methods.push_back(compiled_view.CreateMethod(
+            job.layout_name,
+            dex::Prototype{dex::TypeDescriptor::FromClassname("android.view.View"),
+                           dex::TypeDescriptor::FromClassname("android.content.Context"),
+                           dex::TypeDescriptor::Int()}));
+        DexViewBuilder builder(&methods.back());
+        builder.Start();
+        LayoutCompilerVisitor visitor{&builder};
+        adapter.Accept(&visitor);
+        builder.Finish();
+        methods.back().Encode();
+        break;
+      }
+      case CompilationTarget::kJavaLanguage: {
+        JavaLangViewBuilder builder{package_name, job.layout_name, target_out};
+        builder.Start();
+        LayoutCompilerVisitor visitor{&builder};
+        adapter.Accept(&visitor);
+        builder.Finish();
+        break;
+      }
+    }
+  }
+
   if (target == CompilationTarget::kDex) {
     slicer::MemView image{dex_file.CreateImage()};
     target_out.write(image.ptr<const char>(), image.size());
@@ -27,10 +27,14 @@
 
 #include "tinyxml2.h"
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace {
@@ -91,6 +95,45 @@ void CompileLayout(XMLDocument* xml, Builder* builder) {
   xml->Accept(&adapter);
 }
 
+// One input layout file, with its parsed XML document and validation result.
+struct LayoutFile {
+  explicit LayoutFile(string filename) : filename{std::move(filename)} {}
+
+  string filename;
+  string layout_name;
+  XMLDocument xml;
+  bool can_compile = false;
+  string error_message;
+};
+
+// Parses and validates every input layout. Each file is independent of the others, so the
+// batch is spread across threads before the single-threaded code generation.
+void ParseLayoutFiles(std::vector<std::unique_ptr<LayoutFile>>* layouts) {
+  std::atomic<size_t> next_index{0};
+  auto parse_files = [layouts, &next_index]() {
+    size_t index;
+    while ((index = next_index.fetch_add(1)) < layouts->size()) {
+      LayoutFile* layout = (*layouts)[index].get();
+      layout->xml.LoadFile(layout->filename.c_str());
+      layout->layout_name = FindLayoutNameFromFilename(layout->filename);
+      layout->can_compile = startop::CanCompileLayout(layout->xml, &layout->error_message);
+    }
+  };
+  const size_t num_threads = std::min(
+      layouts->size(), static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency())));
+  if (num_threads <= 1) {
+    parse_files();
+    return;
+  }
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(parse_files);
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
 }  // end namespace
 
 int main(int argc, char** argv) {
@@ -134,39 +177,57 @@ int main(int argc, char** argv) {
     return 0;
   }
 
-  const char* const filename = argv[kFileNameParam];
-  const string layout_name = startop::util::FindLayoutNameFromFilename(filename);
+  std::vector<std::unique_ptr<LayoutFile>> layouts;
+  for (int i = kFileNameParam; i < argc; i++) {
+    layouts.push_back(std::make_unique<LayoutFile>(argv[i]));
+  }
 
-  XMLDocument xml;
-  xml.LoadFile(filename);
+  if (layouts.empty()) {
+    gflags::ShowUsageWithFlags(argv[kProgramName]);
+    return 1;
+  }
 
-  string message{};
-  if (!startop::CanCompileLayout(xml, &message)) {
-    LOG(ERROR) << "Layout not supported: " << message;
+  if (!FLAGS_dex && layouts.size() > 1) {
+    LOG(ERROR) << "Java language output supports a single layout per invocation";
     return 1;
   }
 
+  ParseLayoutFiles(&layouts);
+
+  for (const auto& layout : layouts) {
+    if (!layout->can_compile) {
+      LOG(ERROR) << "Layout not supported: " << layout->error_message;
+      return 1;
+    }
+  }
+
   if (FLAGS_dex) {
+    // All layouts in the batch share one DexBuilder, and with it one string and type-id
+    // pool, and compile into methods of a single CompiledView class.
     DexBuilder dex_file;
     string class_name = StringPrintf("%s.CompiledView", FLAGS_package.c_str());
     ClassBuilder compiled_view{dex_file.MakeClass(class_name)};
-    MethodBuilder method{compiled_view.CreateMethod(
-        layout_name,
-        Prototype{TypeDescriptor::FromClassname("android.view.View"),
-                  TypeDescriptor::FromClassname("android.content.Context"),
-                  TypeDescriptor::Int()})};
-    startop::DexViewBuilder builder{&method};
-    CompileLayout(&xml, &builder);
-    method.Encode();
+    std::vector<MethodBuilder> methods;
+    for (const auto& layout : layouts) {
+      methods.push_back(compiled_view.CreateMethod(
+          layout->layout_name,
+          Prototype{TypeDescriptor::FromClassname("android.view.View"),
+                    TypeDescriptor::FromClassname("android.content.Context"),
+                    TypeDescriptor::Int()}));
+      startop::DexViewBuilder builder{&methods.back()};
+      CompileLayout(&layout->xml, &builder);
+      methods.back().Encode();
+    }
 
     slicer::MemView image{dex_file.CreateImage()};
 
     (is_stdout ? std::cout : outfile).write(image.ptr<const char>(), image.size());
   } else {
     // Generate Java language output.
-    JavaLangViewBuilder builder{FLAGS_package, layout_name, is_stdout ? std::cout : outfile};
+    LayoutFile* layout = layouts.front().get();
+    JavaLangViewBuilder builder{FLAGS_package, layout->layout_name, is_stdout ? std::cout : outfile};
 
-    CompileLayout(&xml, &builder);
+    CompileLayout(&layout->xml, &builder);
   }
   return 0;
 }
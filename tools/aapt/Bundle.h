@@ -56,7 +56,8 @@ public:
           mManifestPackageNameOverride(NULL), mInstrumentationPackageNameOverride(NULL),
           mAutoAddOverlay(false), mGenDependencies(false), mNoVersionVectors(false),
           mNoVersionTransitions(false),
-          mCrunchedOutputDir(NULL), mProguardFile(NULL), mMainDexProguardFile(NULL),
+          mCrunchedOutputDir(NULL), mImageCacheDir(NULL), mProguardFile(NULL),
+          mMainDexProguardFile(NULL),
           mAndroidManifestFile(NULL), mPublicOutputFile(NULL),
           mRClassDir(NULL), mResourceIntermediatesDir(NULL), mManifestMinSdkVersion(NULL),
           mMinSdkVersion(NULL), mTargetSdkVersion(NULL), mMaxSdkVersion(NULL),
@@ -150,6 +151,8 @@ public:
     void addAssetSourceDir(const char* dir) { mAssetSourceDirs.insertAt(dir,0); }
     const char* getCrunchedOutputDir() const { return mCrunchedOutputDir; }
     void setCrunchedOutputDir(const char* dir) { mCrunchedOutputDir = dir; }
+    const char* getImageCacheDir() const { return mImageCacheDir; }
+    void setImageCacheDir(const char* dir) { mImageCacheDir = dir; }
     const char* getProguardFile() const { return mProguardFile; }
     void setProguardFile(const char* file) { mProguardFile = file; }
     const char* getMainDexProguardFile() const { return mMainDexProguardFile; }
@@ -309,6 +312,7 @@ private:
     bool        mNoVersionVectors;
     bool        mNoVersionTransitions;
     const char* mCrunchedOutputDir;
+    const char* mImageCacheDir;
     const char* mProguardFile;
     const char* mMainDexProguardFile;
     const char* mAndroidManifestFile;
@@ -14,6 +14,14 @@
 #include <png.h>
 #include <zlib.h>
 
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
 // Change this to true for noisy debug output.
 static const bool kIsDebug = false;
 
@@ -1354,6 +1362,120 @@ static bool write_png_protected(png_structp write_ptr, String8& printableName, p
     return true;
 }
 
+// --- content-hash image cache ---
+//
+// With --image-cache-dir, the processed output of each PNG is kept across
+// builds, keyed by a hash of the source bytes plus the settings that affect
+// processing, so unchanged images skip 9-patch analysis and recompression.
+
+static uint64_t hashImageContents(const uint8_t* data, size_t size)
+{
+    // FNV-1a. The source size is also part of the cache file name, so an
+    // accidental collision additionally requires equal file sizes.
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static bool getImageCachePath(const Bundle* bundle, const sp<AaptFile>& file, String8* outPath)
+{
+    const char* cacheDir = bundle->getImageCacheDir();
+    if (cacheDir == NULL) {
+        return false;
+    }
+#ifdef _WIN32
+    _mkdir(cacheDir);
+#else
+    mkdir(cacheDir, S_IRUSR|S_IWUSR|S_IXUSR|S_IRGRP|S_IXGRP);
+#endif
+
+    FILE* fp = fopen(file->getSourceFile().string(), "rb");
+    if (fp == NULL) {
+        return false;
+    }
+    fseek(fp, 0, SEEK_END);
+    const long size = ftell(fp);
+    if (size <= 0) {
+        fclose(fp);
+        return false;
+    }
+    rewind(fp);
+    uint8_t* buf = (uint8_t*)malloc(size);
+    if (buf == NULL) {
+        fclose(fp);
+        return false;
+    }
+    const bool readOk = fread(buf, 1, size, fp) == (size_t)size;
+    fclose(fp);
+    if (!readOk) {
+        free(buf);
+        return false;
+    }
+    const uint64_t hash = hashImageContents(buf, size);
+    free(buf);
+
+    // 9-patch analysis depends on the source name, and the grayscale tolerance
+    // changes the recompressed output, so both are part of the key.
+    const String8& path = file->getPath();
+    const size_t nameLen = path.length();
+    const char* name = path.string();
+    const bool isNinePatch = nameLen > 6 && name[nameLen-5] == '9' && name[nameLen-6] == '.';
+
+    char key[64];
+    snprintf(key, sizeof(key), "%016llx_%ld_%d%s.png", (unsigned long long)hash, size,
+             bundle->getGrayscaleTolerance(), isNinePatch ? "_9" : "");
+    *outPath = String8(cacheDir);
+    outPath->appendPath(key);
+    return true;
+}
+
+static bool loadCachedImage(const String8& cachePath, const sp<AaptFile>& file)
+{
+    FILE* fp = fopen(cachePath.string(), "rb");
+    if (fp == NULL) {
+        return false;
+    }
+    fseek(fp, 0, SEEK_END);
+    const long size = ftell(fp);
+    rewind(fp);
+    bool ok = size > 0;
+    if (ok) {
+        uint8_t* buf = (uint8_t*)malloc(size);
+        ok = buf != NULL && fread(buf, 1, size, fp) == (size_t)size
+                && file->writeData(buf, size) == NO_ERROR;
+        free(buf);
+    }
+    fclose(fp);
+    if (!ok) {
+        file->clearData();
+    }
+    return ok;
+}
+
+static void storeCachedImage(const String8& cachePath, const sp<AaptFile>& file)
+{
+    // Write to a temporary name and rename, so concurrent workers (or aapt
+    // invocations sharing the cache) never observe a partial file.
+    String8 tmpPath(cachePath);
+    char suffix[48];
+    snprintf(suffix, sizeof(suffix), ".%d.%p.tmp", (int)getpid(), (void*)file.get());
+    tmpPath.append(suffix);
+
+    FILE* fp = fopen(tmpPath.string(), "wb");
+    if (fp == NULL) {
+        return;
+    }
+    const bool ok = fwrite(file->getData(), 1, file->getSize(), fp) == file->getSize();
+    fclose(fp);
+    if (!ok || rename(tmpPath.string(), cachePath.string()) != 0) {
+        // Either the write failed, or another writer already published this
+        // key (in which case the contents are identical anyway).
+        remove(tmpPath.string());
+    }
+}
+
 status_t preProcessImage(const Bundle* bundle, const sp<AaptAssets>& /* assets */,
                          const sp<AaptFile>& file, String8* /* outNewLeafName */)
 {
@@ -1370,6 +1492,15 @@ status_t preProcessImage(const Bundle* bundle, const sp<AaptAssets>& /* assets *
 
     String8 printableName(file->getPrintableSource());
 
+    String8 cachePath;
+    const bool useCache = getImageCachePath(bundle, file, &cachePath);
+    if (useCache && loadCachedImage(cachePath, file)) {
+        if (bundle->getVerbose()) {
+            printf("Processing image: %s (cache hit)\n", printableName.string());
+        }
+        return NO_ERROR;
+    }
+
     if (bundle->getVerbose()) {
         printf("Processing image: %s\n", printableName.string());
     }
@@ -1428,6 +1559,10 @@ status_t preProcessImage(const Bundle* bundle, const sp<AaptAssets>& /* assets *
 
     error = NO_ERROR;
 
+    if (useCache) {
+        storeCachedImage(cachePath, file);
+    }
+
     if (bundle->getVerbose()) {
         fseek(fp, 0, SEEK_END);
         size_t oldSize = (size_t)ftell(fp);
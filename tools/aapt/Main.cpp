@@ -229,6 +229,9 @@ void usage(void)
         "   --output-text-symbols\n"
         "       Generates a text file containing the resource symbols of the R class in the\n"
         "       specified folder.\n"
+        "   --image-cache-dir\n"
+        "       Cache processed images in the specified folder, keyed by the source\n"
+        "       content, so unchanged images are not reprocessed on later builds.\n"
         "   --ignore-assets\n"
         "       Assets to be ignored. Default pattern is:\n"
         "       %s\n"
@@ -686,6 +689,16 @@ int main(int argc, char* const argv[])
                         goto bail;
                     }
                     bundle.setOutputTextSymbols(argv[0]);
+                } else if (strcmp(cp, "-image-cache-dir") == 0) {
+                    argc--;
+                    argv++;
+                    if (!argc) {
+                        fprintf(stderr, "ERROR: No argument supplied for '--image-cache-dir' option\n");
+                        wantUsage = true;
+                        goto bail;
+                    }
+                    convertPath(argv[0]);
+                    bundle.setImageCacheDir(argv[0]);
                 } else if (strcmp(cp, "-product") == 0) {
                     argc--;
                     argv++;
@@ -11,6 +11,7 @@
 #include "ResourceFilter.h"
 #include "ResourceIdCache.h"
 #include "SdkConstants.h"
+#include "WorkQueue.h"
 
 #include <algorithm>
 #include <androidfw/ResourceTypes.h>
@@ -36,6 +37,9 @@ static const bool kPrintStringMetrics = false;
 
 static const char* kAttrPrivateType = "^attr-private";
 
+// Number of threads used to build type chunks when flattening the table.
+static const size_t kMaxFlattenThreads = 4;
+
 status_t compileXmlFile(const Bundle* bundle,
                         const sp<AaptAssets>& assets,
                         const String16& resourceName,
@@ -2873,6 +2877,223 @@ ResourceTable::validateLocalizations(void)
     return err;
 }
 
+// Builds the typeSpec and type chunks for a single type into the given buffer.
+// All offsets inside these chunks are relative to the chunks themselves and all
+// entry string indices were already assigned when the string pools were built,
+// so each type can be flattened independently and the buffers concatenated into
+// the package chunk in type order afterwards.
+static status_t flattenTypeChunks(Bundle* bundle, const sp<const ResourceFilter>& filter,
+        const sp<ResourceTable::Type>& t, size_t ti, bool filterable, bool skipEntireType,
+        const sp<AaptFile>& data, Vector<bool>* validResources)
+{
+    const size_t N = t->getOrderedConfigs().size();
+
+    // Until a non-NO_ENTRY value has been written for a resource,
+    // that resource is invalid; validResources[i] represents
+    // the item at t->getOrderedConfigs().itemAt(i).
+    validResources->insertAt(false, 0, N);
+
+    // First write the typeSpec chunk, containing information about
+    // each resource entry in this type.
+    {
+        const size_t typeSpecSize = sizeof(ResTable_typeSpec) + sizeof(uint32_t)*N;
+        const size_t typeSpecStart = data->getSize();
+        ResTable_typeSpec* tsHeader = (ResTable_typeSpec*)
+            (((uint8_t*)data->editData(typeSpecStart+typeSpecSize)) + typeSpecStart);
+        if (tsHeader == NULL) {
+            fprintf(stderr, "ERROR: out of memory creating ResTable_typeSpec\n");
+            return NO_MEMORY;
+        }
+        memset(tsHeader, 0, sizeof(*tsHeader));
+        tsHeader->header.type = htods(RES_TABLE_TYPE_SPEC_TYPE);
+        tsHeader->header.headerSize = htods(sizeof(*tsHeader));
+        tsHeader->header.size = htodl(typeSpecSize);
+        tsHeader->id = ti+1;
+        tsHeader->entryCount = htodl(N);
+
+        uint32_t* typeSpecFlags = (uint32_t*)
+            (((uint8_t*)data->editData())
+                + typeSpecStart + sizeof(ResTable_typeSpec));
+        memset(typeSpecFlags, 0, sizeof(uint32_t)*N);
+
+        for (size_t ei=0; ei<N; ei++) {
+            sp<ResourceTable::ConfigList> cl = t->getOrderedConfigs().itemAt(ei);
+            if (cl == NULL) {
+                continue;
+            }
+
+            if (cl->getPublic()) {
+                typeSpecFlags[ei] |= htodl(ResTable_typeSpec::SPEC_PUBLIC);
+            }
+
+            if (skipEntireType) {
+                continue;
+            }
+
+            const size_t CN = cl->getEntries().size();
+            for (size_t ci=0; ci<CN; ci++) {
+                if (filterable && !filter->match(cl->getEntries().keyAt(ci))) {
+                    continue;
+                }
+                for (size_t cj=ci+1; cj<CN; cj++) {
+                    if (filterable && !filter->match(cl->getEntries().keyAt(cj))) {
+                        continue;
+                    }
+                    typeSpecFlags[ei] |= htodl(
+                        cl->getEntries().keyAt(ci).diff(cl->getEntries().keyAt(cj)));
+                }
+            }
+        }
+    }
+
+    if (skipEntireType) {
+        return NO_ERROR;
+    }
+
+    // We need to write one type chunk for each configuration for
+    // which we have entries in this type.
+    const SortedVector<ConfigDescription> uniqueConfigs = t->getUniqueConfigs();
+
+    const size_t typeSize = sizeof(ResTable_type) + sizeof(uint32_t)*N;
+
+    const size_t NC = uniqueConfigs.size();
+    for (size_t ci=0; ci<NC; ci++) {
+        const ConfigDescription& config = uniqueConfigs[ci];
+
+        if (kIsDebug) {
+            printf("Writing config %zu config: imsi:%d/%d lang:%c%c cnt:%c%c "
+                "orien:%d ui:%d touch:%d density:%d key:%d inp:%d nav:%d sz:%dx%d "
+                "sw%ddp w%ddp h%ddp layout:%d\n",
+                ti + 1,
+                config.mcc, config.mnc,
+                config.language[0] ? config.language[0] : '-',
+                config.language[1] ? config.language[1] : '-',
+                config.country[0] ? config.country[0] : '-',
+                config.country[1] ? config.country[1] : '-',
+                config.orientation,
+                config.uiMode,
+                config.touchscreen,
+                config.density,
+                config.keyboard,
+                config.inputFlags,
+                config.navigation,
+                config.screenWidth,
+                config.screenHeight,
+                config.smallestScreenWidthDp,
+                config.screenWidthDp,
+                config.screenHeightDp,
+                config.screenLayout);
+        }
+
+        if (filterable && !filter->match(config)) {
+            continue;
+        }
+
+        const size_t typeStart = data->getSize();
+
+        ResTable_type* tHeader = (ResTable_type*)
+            (((uint8_t*)data->editData(typeStart+typeSize)) + typeStart);
+        if (tHeader == NULL) {
+            fprintf(stderr, "ERROR: out of memory creating ResTable_type\n");
+            return NO_MEMORY;
+        }
+
+        memset(tHeader, 0, sizeof(*tHeader));
+        tHeader->header.type = htods(RES_TABLE_TYPE_TYPE);
+        tHeader->header.headerSize = htods(sizeof(*tHeader));
+        tHeader->id = ti+1;
+        tHeader->entryCount = htodl(N);
+        tHeader->entriesStart = htodl(typeSize);
+        tHeader->config = config;
+        if (kIsDebug) {
+            printf("Writing type %zu config: imsi:%d/%d lang:%c%c cnt:%c%c "
+                "orien:%d ui:%d touch:%d density:%d key:%d inp:%d nav:%d sz:%dx%d "
+                "sw%ddp w%ddp h%ddp layout:%d\n",
+                ti + 1,
+                tHeader->config.mcc, tHeader->config.mnc,
+                tHeader->config.language[0] ? tHeader->config.language[0] : '-',
+                tHeader->config.language[1] ? tHeader->config.language[1] : '-',
+                tHeader->config.country[0] ? tHeader->config.country[0] : '-',
+                tHeader->config.country[1] ? tHeader->config.country[1] : '-',
+                tHeader->config.orientation,
+                tHeader->config.uiMode,
+                tHeader->config.touchscreen,
+                tHeader->config.density,
+                tHeader->config.keyboard,
+                tHeader->config.inputFlags,
+                tHeader->config.navigation,
+                tHeader->config.screenWidth,
+                tHeader->config.screenHeight,
+                tHeader->config.smallestScreenWidthDp,
+                tHeader->config.screenWidthDp,
+                tHeader->config.screenHeightDp,
+                tHeader->config.screenLayout);
+        }
+        tHeader->config.swapHtoD();
+
+        // Build the entries inside of this type.
+        for (size_t ei=0; ei<N; ei++) {
+            sp<ResourceTable::ConfigList> cl = t->getOrderedConfigs().itemAt(ei);
+            sp<ResourceTable::Entry> e = NULL;
+            if (cl != NULL) {
+                e = cl->getEntries().valueFor(config);
+            }
+
+            // Set the offset for this entry in its type.
+            uint32_t* index = (uint32_t*)
+                (((uint8_t*)data->editData())
+                    + typeStart + sizeof(ResTable_type));
+            if (e != NULL) {
+                index[ei] = htodl(data->getSize()-typeStart-typeSize);
+
+                // Create the entry.
+                ssize_t amt = e->flatten(bundle, data, cl->getPublic());
+                if (amt < 0) {
+                    return amt;
+                }
+                validResources->editItemAt(ei) = true;
+            } else {
+                index[ei] = htodl(ResTable_type::NO_ENTRY);
+            }
+        }
+
+        // Fill in the rest of the type information.
+        tHeader = (ResTable_type*)
+            (((uint8_t*)data->editData()) + typeStart);
+        tHeader->header.size = htodl(data->getSize()-typeStart);
+    }
+
+    return NO_ERROR;
+}
+
+class TypeChunkWorkUnit : public WorkQueue::WorkUnit {
+public:
+    TypeChunkWorkUnit(Bundle* bundle, const sp<const ResourceFilter>& filter,
+            const sp<ResourceTable::Type>& t, size_t ti, bool filterable, bool skipEntireType,
+            const sp<AaptFile>& data, Vector<bool>* validResources, status_t* result) :
+            mBundle(bundle), mFilter(filter), mType(t), mTypeIndex(ti), mFilterable(filterable),
+            mSkipEntireType(skipEntireType), mData(data), mValidResources(validResources),
+            mResult(result) {
+    }
+
+    virtual bool run() {
+        *mResult = flattenTypeChunks(mBundle, mFilter, mType, mTypeIndex, mFilterable,
+                mSkipEntireType, mData, mValidResources);
+        return true; // flatten the remaining types even on error; it is reported after finish()
+    }
+
+private:
+    Bundle* mBundle;
+    sp<const ResourceFilter> mFilter;
+    sp<ResourceTable::Type> mType;
+    size_t mTypeIndex;
+    bool mFilterable;
+    bool mSkipEntireType;
+    sp<AaptFile> mData;
+    Vector<bool>* mValidResources;
+    status_t* mResult;
+};
+
 status_t ResourceTable::flatten(Bundle* bundle, const sp<const ResourceFilter>& filter,
         const sp<AaptFile>& dest,
         const bool isBase)
@@ -3062,200 +3283,68 @@ status_t ResourceTable::flatten(Bundle* bundle, const sp<const ResourceFilter>&
             }
         }
 
-        // Build the type chunks inside of this package.
-        for (size_t ti=0; ti<N; ti++) {
-            // Retrieve them in the same order as the type string block.
-            size_t len;
-            String16 typeName(p->getTypeStrings().stringAt(ti, &len));
-            sp<Type> t = p->getTypes().valueFor(typeName);
-            LOG_ALWAYS_FATAL_IF(t == NULL && typeName != String16("<empty>"),
-                                "Type name %s not found",
-                                String8(typeName).string());
-            if (t == NULL) {
-                continue;
-            }
-            const bool filterable = (typeName != mipmap16);
-            const bool skipEntireType = (typeName == mipmap16 && !isBase);
-
-            const size_t N = t != NULL ? t->getOrderedConfigs().size() : 0;
-
-            // Until a non-NO_ENTRY value has been written for a resource,
-            // that resource is invalid; validResources[i] represents
-            // the item at t->getOrderedConfigs().itemAt(i).
-            Vector<bool> validResources;
-            validResources.insertAt(false, 0, N);
-            
-            // First write the typeSpec chunk, containing information about
-            // each resource entry in this type.
-            {
-                const size_t typeSpecSize = sizeof(ResTable_typeSpec) + sizeof(uint32_t)*N;
-                const size_t typeSpecStart = data->getSize();
-                ResTable_typeSpec* tsHeader = (ResTable_typeSpec*)
-                    (((uint8_t*)data->editData(typeSpecStart+typeSpecSize)) + typeSpecStart);
-                if (tsHeader == NULL) {
-                    fprintf(stderr, "ERROR: out of memory creating ResTable_typeSpec\n");
-                    return NO_MEMORY;
+        // Build the type chunks inside of this package. Each type's chunks are
+        // self-contained, so they are built into per-type buffers on worker
+        // threads and concatenated in type order below.
+        Vector<sp<Type> > flatTypes;
+        flatTypes.insertAt(sp<Type>(), 0, N);
+        Vector<sp<AaptFile> > typeDatas;
+        typeDatas.insertAt(sp<AaptFile>(), 0, N);
+        Vector<Vector<bool> > typeValidResources;
+        typeValidResources.insertAt(Vector<bool>(), 0, N);
+        Vector<status_t> typeResults;
+        typeResults.insertAt(NO_ERROR, 0, N);
+
+        {
+            WorkQueue wq(kMaxFlattenThreads, false);
+            for (size_t ti=0; ti<N; ti++) {
+                // Retrieve them in the same order as the type string block.
+                size_t len;
+                String16 typeName(p->getTypeStrings().stringAt(ti, &len));
+                sp<Type> t = p->getTypes().valueFor(typeName);
+                LOG_ALWAYS_FATAL_IF(t == NULL && typeName != String16("<empty>"),
+                                    "Type name %s not found",
+                                    String8(typeName).string());
+                if (t == NULL) {
+                    continue;
                 }
-                memset(tsHeader, 0, sizeof(*tsHeader));
-                tsHeader->header.type = htods(RES_TABLE_TYPE_SPEC_TYPE);
-                tsHeader->header.headerSize = htods(sizeof(*tsHeader));
-                tsHeader->header.size = htodl(typeSpecSize);
-                tsHeader->id = ti+1;
-                tsHeader->entryCount = htodl(N);
-                
-                uint32_t* typeSpecFlags = (uint32_t*)
-                    (((uint8_t*)data->editData())
-                        + typeSpecStart + sizeof(ResTable_typeSpec));
-                memset(typeSpecFlags, 0, sizeof(uint32_t)*N);
-
-                for (size_t ei=0; ei<N; ei++) {
-                    sp<ConfigList> cl = t->getOrderedConfigs().itemAt(ei);
-                    if (cl == NULL) {
-                        continue;
-                    }
-
-                    if (cl->getPublic()) {
-                        typeSpecFlags[ei] |= htodl(ResTable_typeSpec::SPEC_PUBLIC);
-                    }
-
-                    if (skipEntireType) {
-                        continue;
-                    }
-
-                    const size_t CN = cl->getEntries().size();
-                    for (size_t ci=0; ci<CN; ci++) {
-                        if (filterable && !filter->match(cl->getEntries().keyAt(ci))) {
-                            continue;
-                        }
-                        for (size_t cj=ci+1; cj<CN; cj++) {
-                            if (filterable && !filter->match(cl->getEntries().keyAt(cj))) {
-                                continue;
-                            }
-                            typeSpecFlags[ei] |= htodl(
-                                cl->getEntries().keyAt(ci).diff(cl->getEntries().keyAt(cj)));
-                        }
-                    }
+                const bool filterable = (typeName != mipmap16);
+                const bool skipEntireType = (typeName == mipmap16 && !isBase);
+
+                flatTypes.editItemAt(ti) = t;
+                typeDatas.editItemAt(ti) = new AaptFile(String8(), AaptGroupEntry(), String8());
+
+                TypeChunkWorkUnit* w = new TypeChunkWorkUnit(bundle, filter, t, ti,
+                        filterable, skipEntireType, typeDatas[ti],
+                        &typeValidResources.editItemAt(ti), &typeResults.editItemAt(ti));
+                if (wq.schedule(w) != NO_ERROR) {
+                    // The queue is not accepting more work; build this type inline.
+                    w->run();
+                    delete w;
                 }
             }
-            
-            if (skipEntireType) {
+            wq.finish();
+        }
+
+        for (size_t ti=0; ti<N; ti++) {
+            const sp<Type>& t = flatTypes[ti];
+            if (t == NULL) {
                 continue;
             }
-
-            // We need to write one type chunk for each configuration for
-            // which we have entries in this type.
-            SortedVector<ConfigDescription> uniqueConfigs;
-            if (t != NULL) {
-                uniqueConfigs = t->getUniqueConfigs();
+            if (typeResults[ti] != NO_ERROR) {
+                return typeResults[ti];
             }
-            
-            const size_t typeSize = sizeof(ResTable_type) + sizeof(uint32_t)*N;
-            
-            const size_t NC = uniqueConfigs.size();
-            for (size_t ci=0; ci<NC; ci++) {
-                const ConfigDescription& config = uniqueConfigs[ci];
-
-                if (kIsDebug) {
-                    printf("Writing config %zu config: imsi:%d/%d lang:%c%c cnt:%c%c "
-                        "orien:%d ui:%d touch:%d density:%d key:%d inp:%d nav:%d sz:%dx%d "
-                        "sw%ddp w%ddp h%ddp layout:%d\n",
-                        ti + 1,
-                        config.mcc, config.mnc,
-                        config.language[0] ? config.language[0] : '-',
-                        config.language[1] ? config.language[1] : '-',
-                        config.country[0] ? config.country[0] : '-',
-                        config.country[1] ? config.country[1] : '-',
-                        config.orientation,
-                        config.uiMode,
-                        config.touchscreen,
-                        config.density,
-                        config.keyboard,
-                        config.inputFlags,
-                        config.navigation,
-                        config.screenWidth,
-                        config.screenHeight,
-                        config.smallestScreenWidthDp,
-                        config.screenWidthDp,
-                        config.screenHeightDp,
-                        config.screenLayout);
-                }
-                      
-                if (filterable && !filter->match(config)) {
-                    continue;
-                }
-                
-                const size_t typeStart = data->getSize();
-
-                ResTable_type* tHeader = (ResTable_type*)
-                    (((uint8_t*)data->editData(typeStart+typeSize)) + typeStart);
-                if (tHeader == NULL) {
-                    fprintf(stderr, "ERROR: out of memory creating ResTable_type\n");
-                    return NO_MEMORY;
-                }
-
-                memset(tHeader, 0, sizeof(*tHeader));
-                tHeader->header.type = htods(RES_TABLE_TYPE_TYPE);
-                tHeader->header.headerSize = htods(sizeof(*tHeader));
-                tHeader->id = ti+1;
-                tHeader->entryCount = htodl(N);
-                tHeader->entriesStart = htodl(typeSize);
-                tHeader->config = config;
-                if (kIsDebug) {
-                    printf("Writing type %zu config: imsi:%d/%d lang:%c%c cnt:%c%c "
-                        "orien:%d ui:%d touch:%d density:%d key:%d inp:%d nav:%d sz:%dx%d "
-                        "sw%ddp w%ddp h%ddp layout:%d\n",
-                        ti + 1,
-                        tHeader->config.mcc, tHeader->config.mnc,
-                        tHeader->config.language[0] ? tHeader->config.language[0] : '-',
-                        tHeader->config.language[1] ? tHeader->config.language[1] : '-',
-                        tHeader->config.country[0] ? tHeader->config.country[0] : '-',
-                        tHeader->config.country[1] ? tHeader->config.country[1] : '-',
-                        tHeader->config.orientation,
-                        tHeader->config.uiMode,
-                        tHeader->config.touchscreen,
-                        tHeader->config.density,
-                        tHeader->config.keyboard,
-                        tHeader->config.inputFlags,
-                        tHeader->config.navigation,
-                        tHeader->config.screenWidth,
-                        tHeader->config.screenHeight,
-                        tHeader->config.smallestScreenWidthDp,
-                        tHeader->config.screenWidthDp,
-                        tHeader->config.screenHeightDp,
-                        tHeader->config.screenLayout);
-                }
-                tHeader->config.swapHtoD();
-
-                // Build the entries inside of this type.
-                for (size_t ei=0; ei<N; ei++) {
-                    sp<ConfigList> cl = t->getOrderedConfigs().itemAt(ei);
-                    sp<Entry> e = NULL;
-                    if (cl != NULL) {
-                        e = cl->getEntries().valueFor(config);
-                    }
 
-                    // Set the offset for this entry in its type.
-                    uint32_t* index = (uint32_t*)
-                        (((uint8_t*)data->editData())
-                            + typeStart + sizeof(ResTable_type));
-                    if (e != NULL) {
-                        index[ei] = htodl(data->getSize()-typeStart-typeSize);
-
-                        // Create the entry.
-                        ssize_t amt = e->flatten(bundle, data, cl->getPublic());
-                        if (amt < 0) {
-                            return amt;
-                        }
-                        validResources.editItemAt(ei) = true;
-                    } else {
-                        index[ei] = htodl(ResTable_type::NO_ENTRY);
-                    }
-                }
+            status_t err = data->writeData(typeDatas[ti]->getData(), typeDatas[ti]->getSize());
+            if (err != NO_ERROR) {
+                fprintf(stderr, "ERROR: out of memory appending type chunk\n");
+                return err;
+            }
 
-                // Fill in the rest of the type information.
-                tHeader = (ResTable_type*)
-                    (((uint8_t*)data->editData()) + typeStart);
-                tHeader->header.size = htodl(data->getSize()-typeStart);
+            const String16 typeName(t->getName());
+            if (typeName == mipmap16 && !isBase) {
+                // Only the typeSpec chunk was written for this type.
+                continue;
             }
 
             // If we're building splits, then each invocation of the flattening
@@ -3264,7 +3353,8 @@ status_t ResourceTable::flatten(Bundle* bundle, const sp<const ResourceFilter>&
                 bool missing_entry = false;
                 const char* log_prefix = bundle->getErrorOnMissingConfigEntry() ?
                         "error" : "warning";
-                for (size_t i = 0; i < N; ++i) {
+                const Vector<bool>& validResources = typeValidResources[ti];
+                for (size_t i = 0; i < validResources.size(); ++i) {
                     if (!validResources[i]) {
                         sp<ConfigList> c = t->getOrderedConfigs().itemAt(i);
                         if (c != NULL) {
@@ -9,8 +9,10 @@
 #include "pseudolocalize.h"
 
 #include <utils/ByteOrder.h>
+#include <utils/FileMap.h>
 #include <errno.h>
 #include <string.h>
+#include <sys/stat.h>
 
 #ifndef _WIN32
 #define O_BINARY 0
@@ -600,23 +602,46 @@ sp<XMLNode> XMLNode::parse(const sp<AaptFile>& file)
     XML_SetCharacterDataHandler(parser, characterData);
     XML_SetCommentHandler(parser, commentData);
 
-    ssize_t len;
-    bool done;
-    do {
-        len = read(fd, buf, sizeof(buf));
-        done = len < (ssize_t)sizeof(buf);
-        if (len < 0) {
-            SourcePos(file->getSourceFile(), -1).error("Error reading file: %s\n", strerror(errno));
-            close(fd);
-            return NULL;
-        }
-        if (XML_Parse(parser, buf, len, done) == XML_STATUS_ERROR) {
+    // Map the source and hand the whole thing to the parser in one call,
+    // rather than copying it through a userspace buffer 16KB at a time.
+    // Falls back to the read loop if the file cannot be mapped.
+    struct stat fdStat;
+    FileMap sourceMap;
+    const char* mapData = NULL;
+    size_t mapSize = 0;
+    if (fstat(fd, &fdStat) == 0 && fdStat.st_size > 0 &&
+            sourceMap.create(file->getSourceFile().string(), fd, 0, fdStat.st_size, true)) {
+        mapData = (const char*)sourceMap.getDataPtr();
+        mapSize = sourceMap.getDataLength();
+    }
+
+    if (mapData != NULL) {
+        if (XML_Parse(parser, mapData, mapSize, true) == XML_STATUS_ERROR) {
             SourcePos(file->getSourceFile(), (int)XML_GetCurrentLineNumber(parser)).error(
                     "Error parsing XML: %s\n", XML_ErrorString(XML_GetErrorCode(parser)));
             close(fd);
             return NULL;
         }
-    } while (!done);
+    } else {
+        ssize_t len;
+        bool done;
+        do {
+            len = read(fd, buf, sizeof(buf));
+            done = len < (ssize_t)sizeof(buf);
+            if (len < 0) {
+                SourcePos(file->getSourceFile(), -1).error("Error reading file: %s\n",
+                        strerror(errno));
+                close(fd);
+                return NULL;
+            }
+            if (XML_Parse(parser, buf, len, done) == XML_STATUS_ERROR) {
+                SourcePos(file->getSourceFile(), (int)XML_GetCurrentLineNumber(parser)).error(
+                        "Error parsing XML: %s\n", XML_ErrorString(XML_GetErrorCode(parser)));
+                close(fd);
+                return NULL;
+            }
+        } while (!done);
+    }
 
     XML_ParserFree(parser);
     if (state.root == NULL) {
@@ -839,6 +864,14 @@ status_t XMLNode::addAttribute(const String16& ns, const String16& name,
     return NO_ERROR;
 }
 
+void XMLNode::reserveAttributes(size_t count)
+{
+    if (count > 0) {
+        mAttributes.setCapacity(count);
+        mAttributeOrder.setCapacity(count);
+    }
+}
+
 status_t XMLNode::removeAttribute(size_t index)
 {
     if (getType() == TYPE_CDATA) {
@@ -1248,6 +1281,12 @@ XMLNode::startElement(void *userData, const char *name, const char **atts)
     }
     st->stack.push(node);
 
+    size_t attrCount = 0;
+    while (atts[attrCount]) {
+        attrCount += 2;
+    }
+    node->reserveAttributes(attrCount / 2);
+
     for (int i = 0; atts[i]; i += 2) {
         splitName(atts[i], &ns16, &name16);
         node->addAttribute(ns16, name16, String16(atts[i+1]));
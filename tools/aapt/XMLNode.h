@@ -120,6 +120,10 @@ public:
     status_t addAttribute(const String16& ns, const String16& name,
                           const String16& value);
 
+    // Preallocates storage for the given number of attributes, so bulk
+    // attribute adds during parsing don't regrow the vectors one at a time.
+    void reserveAttributes(size_t count);
+
     status_t removeAttribute(size_t index);
 
     void setAttributeResID(size_t attrIdx, uint32_t resId);
@@ -171,10 +171,12 @@ StringPool::Ref StringPool::MakeRef(const StringPiece& str, const Context& conte
 
 StringPool::Ref StringPool::MakeRefImpl(const StringPiece& str, const Context& context,
                                         bool unique) {
+  const uint64_t hash = util::HashBytes64(str.data(), str.size());
   if (unique) {
-    auto range = indexed_strings_.equal_range(str);
+    auto range = indexed_strings_.equal_range(hash);
     for (auto iter = range.first; iter != range.second; ++iter) {
-      if (context.priority == iter->second->context.priority) {
+      if (context.priority == iter->second->context.priority &&
+          str == StringPiece(iter->second->value)) {
         return Ref(iter->second);
       }
     }
@@ -189,7 +191,7 @@ StringPool::Ref StringPool::MakeRefImpl(const StringPiece& str, const Context& c
 
   Entry* borrow = entry.get();
   strings_.emplace_back(std::move(entry));
-  indexed_strings_.insert(std::make_pair(StringPiece(borrow->value), borrow));
+  indexed_strings_.insert(std::make_pair(hash, borrow));
   return Ref(borrow);
 }
 
@@ -259,6 +261,7 @@ void StringPool::Merge(StringPool&& pool) {
   pool.styles_.clear();
   std::move(pool.strings_.begin(), pool.strings_.end(), std::back_inserter(strings_));
   pool.strings_.clear();
+  indexed_strings_.reserve(indexed_strings_.size() + pool.indexed_strings_.size());
   indexed_strings_.insert(pool.indexed_strings_.begin(), pool.indexed_strings_.end());
   pool.indexed_strings_.clear();
 
@@ -268,6 +271,7 @@ void StringPool::Merge(StringPool&& pool) {
 void StringPool::HintWillAdd(size_t string_count, size_t style_count) {
   strings_.reserve(strings_.size() + string_count);
   styles_.reserve(styles_.size() + style_count);
+  indexed_strings_.reserve(indexed_strings_.size() + string_count);
 }
 
 void StringPool::Prune() {
@@ -213,9 +213,19 @@ class StringPool {
   Ref MakeRefImpl(const android::StringPiece& str, const Context& context, bool unique);
   void ReAssignIndices();
 
+  // The dedup index is keyed by a precomputed 64-bit content hash instead of the string
+  // itself, so growing the table never rehashes string bytes and a probe only compares
+  // bytes when the full hashes already match. Keys are hashes, so the hasher is the
+  // identity function.
+  struct IdentityHash {
+    size_t operator()(uint64_t hash) const {
+      return static_cast<size_t>(hash);
+    }
+  };
+
   std::vector<std::unique_ptr<Entry>> strings_;
   std::vector<std::unique_ptr<StyleEntry>> styles_;
-  std::unordered_multimap<android::StringPiece, Entry*> indexed_strings_;
+  std::unordered_multimap<uint64_t, Entry*, IdentityHash> indexed_strings_;
 };
 
 }  // namespace aapt
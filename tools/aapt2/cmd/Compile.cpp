@@ -18,6 +18,7 @@
 
 #include <dirent.h>
 #include <string>
+#include <unordered_map>
 
 #include "android-base/errors.h"
 #include "android-base/file.h"
@@ -48,6 +49,7 @@
 #include "trace/TraceBuffer.h"
 #include "util/Files.h"
 #include "util/Maybe.h"
+#include "util/Parallel.h"
 #include "util/Util.h"
 #include "xml/XmlDom.h"
 #include "xml/XmlPullParser.h"
@@ -74,9 +76,32 @@ struct ResourcePathData {
   ConfigDescription config;
 };
 
+// Every file in a resource directory carries the same qualifier string, so each distinct
+// string is parsed once per compile and remembered, including parse failures.
+using ConfigCache = std::unordered_map<std::string, Maybe<ConfigDescription>>;
+
+static bool ParseConfigCached(const StringPiece& config_str, ConfigDescription* out_config,
+                              ConfigCache* config_cache) {
+  auto iter = config_cache->find(config_str.to_string());
+  if (iter == config_cache->end()) {
+    ConfigDescription config;
+    if (ConfigDescription::Parse(config_str, &config)) {
+      iter = config_cache->emplace(config_str.to_string(), config).first;
+    } else {
+      iter = config_cache->emplace(config_str.to_string(), Maybe<ConfigDescription>()).first;
+    }
+  }
+  if (!iter->second) {
+    return false;
+  }
+  *out_config = iter->second.value();
+  return true;
+}
+
 // Resource file paths are expected to look like: [--/res/]type[-config]/name
 static Maybe<ResourcePathData> ExtractResourcePathData(const std::string& path, const char dir_sep,
-                                                       std::string* out_error) {
+                                                       std::string* out_error,
+                                                       ConfigCache* config_cache) {
   std::vector<std::string> parts = util::Split(path, dir_sep);
   if (parts.size() < 2) {
     if (out_error) *out_error = "bad resource path";
@@ -91,7 +116,7 @@ static Maybe<ResourcePathData> ExtractResourcePathData(const std::string& path,
   size_t dash_pos = dir.find('-');
   if (dash_pos != std::string::npos) {
     config_str = dir_str.substr(dash_pos + 1, dir.size() - (dash_pos + 1));
-    if (!ConfigDescription::Parse(config_str, &config)) {
+    if (!ParseConfigCached(config_str, &config, config_cache)) {
       if (out_error) {
         std::stringstream err_str;
         err_str << "invalid configuration '" << config_str << "'";
@@ -643,11 +668,174 @@ class CompileContext : public IAaptContext {
   bool verbose_ = false;
 };
 
+// Records diagnostics emitted on a worker thread so they can be replayed on the main
+// thread once the parallel section is done, keeping the output in input order.
+class CapturedDiagnostics : public IDiagnostics {
+ public:
+  CapturedDiagnostics() = default;
+
+  void Log(Level level, DiagMessageActual& actual_msg) override {
+    captured_.emplace_back(level, actual_msg);
+  }
+
+  void ReplayTo(IDiagnostics* diag) {
+    for (std::pair<Level, DiagMessageActual>& msg : captured_) {
+      diag->Log(msg.first, msg.second);
+    }
+    captured_.clear();
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CapturedDiagnostics);
+
+  std::vector<std::pair<Level, DiagMessageActual>> captured_;
+};
+
+// Buffers archive entries written on a worker thread. Archive writers are not safe to
+// share between threads, so each compile job writes into one of these and the entries
+// are replayed into the real writer on the main thread, in input order.
+class BufferingArchiveWriter : public IArchiveWriter {
+ public:
+  BufferingArchiveWriter() = default;
+
+  bool WriteFile(const StringPiece& path, uint32_t flags, io::InputStream* in) override {
+    if (!StartEntry(path, flags)) {
+      return false;
+    }
+
+    const void* data = nullptr;
+    size_t len = 0;
+    while (in->Next(&data, &len)) {
+      if (!Write(data, static_cast<int>(len))) {
+        return false;
+      }
+    }
+
+    if (in->HadError()) {
+      error_ = in->GetError();
+      return false;
+    }
+    return FinishEntry();
+  }
+
+  bool StartEntry(const StringPiece& path, uint32_t flags) override {
+    entries_.push_back(BufferedEntry{path.to_string(), flags, {}});
+    return true;
+  }
+
+  bool FinishEntry() override {
+    return true;
+  }
+
+  bool Write(const void* buffer, int size) override {
+    entries_.back().data.append(reinterpret_cast<const char*>(buffer),
+                                static_cast<size_t>(size));
+    return true;
+  }
+
+  bool HadError() const override {
+    return !error_.empty();
+  }
+
+  std::string GetError() const override {
+    return error_;
+  }
+
+  // Writes the buffered entries to writer and drops them. Returns false on the first
+  // entry the writer rejects.
+  bool ReplayTo(IArchiveWriter* writer) {
+    for (BufferedEntry& entry : entries_) {
+      io::StringInputStream in(entry.data);
+      if (!writer->WriteFile(entry.path, entry.flags, &in)) {
+        return false;
+      }
+    }
+    entries_.clear();
+    return true;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BufferingArchiveWriter);
+
+  struct BufferedEntry {
+    std::string path;
+    uint32_t flags;
+    std::string data;
+  };
+
+  std::vector<BufferedEntry> entries_;
+  std::string error_;
+};
+
+// Routes diagnostics to a per-job capture while delegating everything else to the
+// context the command was invoked with.
+class CompileJobContext : public IAaptContext {
+ public:
+  CompileJobContext(IAaptContext* base, IDiagnostics* diagnostics)
+      : base_(base), diagnostics_(diagnostics) {
+  }
+
+  PackageType GetPackageType() override {
+    return base_->GetPackageType();
+  }
+
+  SymbolTable* GetExternalSymbols() override {
+    return base_->GetExternalSymbols();
+  }
+
+  IDiagnostics* GetDiagnostics() override {
+    return diagnostics_;
+  }
+
+  const std::string& GetCompilationPackage() override {
+    return base_->GetCompilationPackage();
+  }
+
+  uint8_t GetPackageId() override {
+    return base_->GetPackageId();
+  }
+
+  NameMangler* GetNameMangler() override {
+    return base_->GetNameMangler();
+  }
+
+  bool IsVerbose() override {
+    return base_->IsVerbose();
+  }
+
+  int GetMinSdkVersion() override {
+    return base_->GetMinSdkVersion();
+  }
+
+  const std::set<std::string>& GetSplitNameDependencies() override {
+    return base_->GetSplitNameDependencies();
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CompileJobContext);
+
+  IAaptContext* base_;
+  IDiagnostics* diagnostics_;
+};
+
 int Compile(IAaptContext* context, io::IFileCollection* inputs, IArchiveWriter* output_writer,
              CompileOptions& options) {
   TRACE_CALL();
   bool error = false;
 
+  using CompileFunc = bool (*)(IAaptContext*, const CompileOptions&, const ResourcePathData&,
+                               io::IFile*, IArchiveWriter*, const std::string&);
+  struct CompileJob {
+    io::IFile* file;
+    ResourcePathData path_data;
+    CompileFunc compile_func;
+    std::string out_path;
+  };
+  std::vector<CompileJob> jobs;
+
+  // Qualifier parse results shared across all inputs of this compile.
+  ConfigCache config_cache;
+
   // Iterate over the input files in a stable, platform-independent manner
   auto file_iterator  = inputs->Iterator();
   while (file_iterator->HasNext()) {
@@ -667,7 +855,8 @@ int Compile(IAaptContext* context, io::IFileCollection* inputs, IArchiveWriter*
     // Extract resource type information from the full path
     std::string err_str;
     ResourcePathData path_data;
-    if (auto maybe_path_data = ExtractResourcePathData(path, inputs->GetDirSeparator(), &err_str)) {
+    if (auto maybe_path_data =
+            ExtractResourcePathData(path, inputs->GetDirSeparator(), &err_str, &config_cache)) {
       path_data = maybe_path_data.value();
     } else {
       context->GetDiagnostics()->Error(DiagMessage(file->GetSource()) << err_str);
@@ -710,9 +899,37 @@ int Compile(IAaptContext* context, io::IFileCollection* inputs, IArchiveWriter*
       continue;
     }
 
-    const std::string out_path = BuildIntermediateContainerFilename(path_data);
-    if (!compile_func(context, options, path_data, file, output_writer, out_path)) {
-      context->GetDiagnostics()->Error(DiagMessage(file->GetSource()) << "file failed to compile");
+    std::string out_path = BuildIntermediateContainerFilename(path_data);
+    jobs.push_back(CompileJob{file, std::move(path_data), compile_func, std::move(out_path)});
+  }
+
+  // Compile the files on worker threads. Each job buffers its archive entries and its
+  // diagnostics, which are replayed in input order afterwards, so both the emitted
+  // containers and the messages stay deterministic. --output-text-symbols makes every
+  // job write the same side file, so that mode stays single-threaded.
+  const size_t num_threads =
+      options.generate_text_symbols_path ? 1u : util::DefaultThreadCount();
+
+  std::vector<CapturedDiagnostics> job_diags(jobs.size());
+  std::vector<BufferingArchiveWriter> job_writers(jobs.size());
+  std::vector<uint8_t> job_failed(jobs.size(), 0u);
+
+  util::ParallelForEachIndex(
+      jobs.size(), num_threads,
+      [context, &options, &jobs, &job_diags, &job_writers, &job_failed](size_t index) {
+        const CompileJob& job = jobs[index];
+        CompileJobContext job_context(context, &job_diags[index]);
+        if (!job.compile_func(&job_context, options, job.path_data, job.file,
+                              &job_writers[index], job.out_path)) {
+          job_failed[index] = 1u;
+        }
+      });
+
+  for (size_t index = 0; index < jobs.size(); index++) {
+    job_diags[index].ReplayTo(context->GetDiagnostics());
+    if (job_failed[index] || !job_writers[index].ReplayTo(output_writer)) {
+      context->GetDiagnostics()->Error(DiagMessage(jobs[index].file->GetSource())
+                                       << "file failed to compile");
       error = true;
     }
   }
@@ -16,9 +16,13 @@
 
 #include "Dump.h"
 
+#include <unistd.h>
+
 #include <cinttypes>
+#include <cstdio>
 #include <vector>
 
+#include "android-base/file.h"
 #include "android-base/stringprintf.h"
 #include "androidfw/ConfigDescription.h"
 #include "androidfw/StringPiece.h"
@@ -32,10 +36,12 @@
 #include "format/binary/XmlFlattener.h"
 #include "format/proto/ProtoDeserialize.h"
 #include "io/FileStream.h"
+#include "io/StringStream.h"
 #include "io/ZipArchive.h"
 #include "process/IResourceTableConsumer.h"
 #include "text/Printer.h"
 #include "util/Files.h"
+#include "util/Util.h"
 
 using ::aapt::text::Printer;
 using ::android::StringPiece;
@@ -225,6 +231,65 @@ int DumpBadgerCommand::Action(const std::vector<std::string>& args) {
   return 1;
 }
 
+// Returns the badging cache file path for the APK, or nothing if the APK on disk could not
+// be fingerprinted. The file name holds a hash of the APK contents, the APK size and the
+// options that affect the output, so a changed APK naturally misses its stale entry.
+static Maybe<std::string> GetBadgingCachePath(const std::string& cache_dir, const Source& source,
+                                              const DumpManifestOptions& options) {
+  std::string contents;
+  if (!android::base::ReadFileToString(source.path, &contents, true /*follow_symlinks*/)) {
+    return {};
+  }
+
+  const uint64_t hash = util::HashBytes64(contents.data(), contents.size());
+  std::string path = cache_dir;
+  file::AppendPath(&path, StringPrintf("%016" PRIx64 "_%zu_%d.badging", hash, contents.size(),
+                                       options.include_meta_data ? 1 : 0));
+  return path;
+}
+
+int DumpBadgingCommand::Dump(LoadedApk* apk) {
+  Maybe<std::string> cache_path;
+  if (cache_dir_) {
+    file::mkdirs(cache_dir_.value());
+    cache_path = GetBadgingCachePath(cache_dir_.value(), apk->GetSource(), options_);
+  }
+
+  if (cache_path) {
+    std::string cached;
+    if (android::base::ReadFileToString(cache_path.value(), &cached, true /*follow_symlinks*/)) {
+      GetPrinter()->Print(cached);
+      return 0;
+    }
+  }
+
+  if (!cache_path) {
+    return DumpManifest(apk, options_, GetPrinter(), GetDiagnostics());
+  }
+
+  // Capture the output so it can be replayed from the cache the next time this APK is
+  // queried.
+  std::string output;
+  {
+    io::StringOutputStream output_stream(&output);
+    Printer printer(&output_stream);
+    if (DumpManifest(apk, options_, &printer, GetDiagnostics()) != 0) {
+      return 1;
+    }
+  }
+  GetPrinter()->Print(output);
+
+  // Publish through a temporary name and rename so a concurrent query never observes a
+  // partial entry.
+  const std::string temp_path = StringPrintf("%s.%d.tmp", cache_path.value().c_str(), getpid());
+  if (android::base::WriteStringToFile(output, temp_path)) {
+    if (std::rename(temp_path.c_str(), cache_path.value().c_str()) != 0) {
+      std::remove(temp_path.c_str());
+    }
+  }
+  return 0;
+}
+
 int DumpConfigsCommand::Dump(LoadedApk* apk) {
   ResourceTable* table = apk->GetResourceTable();
   if (!table) {
@@ -126,14 +126,18 @@ class DumpBadgingCommand : public DumpApkCommand {
     SetDescription("Print information extracted from the manifest of the APK.");
     AddOptionalSwitch("--include-meta-data", "Include meta-data information.",
                       &options_.include_meta_data);
+    AddOptionalFlag("--badging-cache-dir",
+                    "Directory in which to cache badging output, keyed by the APK contents.\n"
+                    "Re-queries of an unchanged APK print the cached output without\n"
+                    "re-extracting the manifest.",
+                    &cache_dir_);
   }
 
-  int Dump(LoadedApk* apk) override {
-    return DumpManifest(apk, options_, GetPrinter(), GetDiagnostics());
-  }
+  int Dump(LoadedApk* apk) override;
 
  private:
   DumpManifestOptions options_;
+  Maybe<std::string> cache_dir_;
 };
 
 class DumpConfigsCommand : public DumpApkCommand {
@@ -18,9 +18,9 @@
 
 #include <sys/stat.h>
 #include <cinttypes>
+#include <cstring>
 
 #include <algorithm>
-#include <queue>
 #include <unordered_map>
 #include <vector>
 
@@ -50,6 +50,7 @@
 #include "io/BigBufferStream.h"
 #include "io/FileStream.h"
 #include "io/FileSystem.h"
+#include "io/StringStream.h"
 #include "io/Util.h"
 #include "io/ZipArchive.h"
 #include "java/JavaClassGenerator.h"
@@ -69,6 +70,7 @@
 #include "split/TableSplitter.h"
 #include "trace/TraceBuffer.h"
 #include "util/Files.h"
+#include "util/Parallel.h"
 #include "xml/XmlDom.h"
 
 using ::aapt::io::FileInputStream;
@@ -220,16 +222,11 @@ class FeatureSplitSymbolTableDelegate : public DefaultSymbolTableDelegate {
   IAaptContext* context_;
 };
 
-static bool FlattenXml(IAaptContext* context, const xml::XmlResource& xml_res,
-                       const StringPiece& path, bool keep_raw_values, bool utf16,
-                       OutputFormat format, IArchiveWriter* writer) {
-  TRACE_CALL();
-  if (context->IsVerbose()) {
-    context->GetDiagnostics()->Note(DiagMessage(path) << "writing to archive (keep_raw_values="
-                                                      << (keep_raw_values ? "true" : "false")
-                                                      << ")");
-  }
-
+// Flattens the XML document to its serialized archive bytes without writing them anywhere,
+// so callers can reuse the result for identical inputs.
+static bool FlattenXmlToString(IAaptContext* context, const xml::XmlResource& xml_res,
+                               const StringPiece& path, bool keep_raw_values, bool utf16,
+                               OutputFormat format, std::string* out_str) {
   switch (format) {
     case OutputFormat::kApk: {
       BigBuffer buffer(1024);
@@ -241,9 +238,12 @@ static bool FlattenXml(IAaptContext* context, const xml::XmlResource& xml_res,
         return false;
       }
 
-      io::BigBufferInputStream input_stream(&buffer);
-      return io::CopyInputStreamToArchive(context, &input_stream, path.to_string(),
-                                          ArchiveEntry::kCompress, writer);
+      out_str->clear();
+      out_str->reserve(buffer.size());
+      for (const BigBuffer::Block& block : buffer) {
+        out_str->append(reinterpret_cast<const char*>(block.buffer.get()), block.size);
+      }
+      return true;
     } break;
 
     case OutputFormat::kProto: {
@@ -252,13 +252,32 @@ static bool FlattenXml(IAaptContext* context, const xml::XmlResource& xml_res,
       SerializeXmlOptions options;
       options.remove_empty_text_nodes = (path == kAndroidManifestPath);
       SerializeXmlResourceToPb(xml_res, &pb_node);
-      return io::CopyProtoToArchive(context, &pb_node, path.to_string(), ArchiveEntry::kCompress,
-                                    writer);
+      return pb_node.SerializeToString(out_str);
     } break;
   }
   return false;
 }
 
+static bool FlattenXml(IAaptContext* context, const xml::XmlResource& xml_res,
+                       const StringPiece& path, bool keep_raw_values, bool utf16,
+                       OutputFormat format, IArchiveWriter* writer) {
+  TRACE_CALL();
+  if (context->IsVerbose()) {
+    context->GetDiagnostics()->Note(DiagMessage(path) << "writing to archive (keep_raw_values="
+                                                      << (keep_raw_values ? "true" : "false")
+                                                      << ")");
+  }
+
+  std::string flattened;
+  if (!FlattenXmlToString(context, xml_res, path, keep_raw_values, utf16, format, &flattened)) {
+    return false;
+  }
+
+  io::StringInputStream input_stream(flattened);
+  return io::CopyInputStreamToArchive(context, &input_stream, path.to_string(),
+                                      ArchiveEntry::kCompress, writer);
+}
+
 // Inflates an XML file from the source path.
 static std::unique_ptr<xml::XmlResource> LoadXml(const std::string& path, IDiagnostics* diag) {
   TRACE_CALL();
@@ -348,8 +367,40 @@ class ResourceFileFlattener {
 
     // The destination to write this file to.
     std::string dst_path;
+
+    // For XML files that need to be relinked: the format the file was compiled as
+    // (captured before the file reference is retargeted to the output format), and the
+    // name and source to attribute to the inflated document.
+    ResourceFile::Type xml_type = ResourceFile::Type::kUnknown;
+    ResourceName name;
+    Source source;
+
+    // Fingerprint of the raw input bytes, for finding byte-identical inputs whose
+    // flattened output can be reused.
+    uint64_t content_hash = 0u;
+    size_t content_size = 0u;
   };
 
+  // One cached result in flattened_xml_cache_. The input file is kept so a fingerprint
+  // match can be confirmed with an exact byte comparison before the output is reused.
+  struct FlattenedXmlCacheEntry {
+    io::IFile* file;
+    size_t size;
+    ConfigDescription config;
+    std::string flattened;
+  };
+
+  // Opens and parses the XML file behind file_op into file_op->xml_to_flatten.
+  // Runs on worker threads, so failures are reported through out_error instead of
+  // diagnostics.
+  static bool ParseXmlToFlatten(FileOperation* file_op, std::string* out_error);
+
+  // Returns the flattened output of a previously linked file operation whose input bytes
+  // and configuration match file_op, or nullptr if there is none.
+  std::string* FindReusableFlattenedXml(const FileOperation& file_op);
+  void CacheFlattenedXml(const FileOperation& file_op, std::string flattened);
+  static bool InputContentsMatch(io::IFile* lhs, io::IFile* rhs, size_t size);
+
   std::vector<std::unique_ptr<xml::XmlResource>> LinkAndVersionXmlFile(ResourceTable* table,
                                                                        FileOperation* file_op);
 
@@ -357,6 +408,12 @@ class ResourceFileFlattener {
   IAaptContext* context_;
   proguard::KeepSet* keep_set_;
   XmlCompatVersioner::Rules rules_;
+
+  // Flattened output of already linked files, keyed by the fingerprint of their input
+  // bytes. Byte-identical inputs linked under the same configuration flatten to the same
+  // bytes, so duplicated resources (locale or density copies of the same document) are
+  // linked and flattened once per invocation.
+  std::unordered_map<uint64_t, std::vector<FlattenedXmlCacheEntry>> flattened_xml_cache_;
 };
 
 ResourceFileFlattener::ResourceFileFlattener(const ResourceFileFlattenerOptions& options,
@@ -499,6 +556,78 @@ static auto kDrawableVersions = std::map<std::string, ApiVersion>{
     { "adaptive-icon" , SDK_O },
 };
 
+bool ResourceFileFlattener::ParseXmlToFlatten(FileOperation* file_op, std::string* out_error) {
+  std::unique_ptr<io::IData> data = file_op->file_to_copy->OpenAsData();
+  if (!data) {
+    *out_error = "failed to open file";
+    return false;
+  }
+
+  file_op->content_hash = util::HashBytes64(data->data(), data->size());
+  file_op->content_size = data->size();
+
+  if (file_op->xml_type == ResourceFile::Type::kProtoXml) {
+    pb::XmlNode pb_xml_node;
+    if (!pb_xml_node.ParseFromArray(data->data(), static_cast<int>(data->size()))) {
+      *out_error = "failed to parse proto XML";
+      return false;
+    }
+
+    std::string error;
+    file_op->xml_to_flatten = DeserializeXmlResourceFromPb(pb_xml_node, &error);
+    if (file_op->xml_to_flatten == nullptr) {
+      *out_error = "failed to deserialize proto XML: " + error;
+      return false;
+    }
+  } else {
+    std::string error;
+    file_op->xml_to_flatten = xml::Inflate(data->data(), data->size(), &error);
+    if (file_op->xml_to_flatten == nullptr) {
+      *out_error = "failed to parse binary XML: " + error;
+      return false;
+    }
+  }
+
+  file_op->xml_to_flatten->file.config = file_op->config;
+  file_op->xml_to_flatten->file.source = file_op->source;
+  file_op->xml_to_flatten->file.name = file_op->name;
+  return true;
+}
+
+bool ResourceFileFlattener::InputContentsMatch(io::IFile* lhs, io::IFile* rhs, size_t size) {
+  if (lhs == rhs) {
+    return true;
+  }
+  std::unique_ptr<io::IData> lhs_data = lhs->OpenAsData();
+  std::unique_ptr<io::IData> rhs_data = rhs->OpenAsData();
+  return lhs_data != nullptr && rhs_data != nullptr && lhs_data->size() == size &&
+         rhs_data->size() == size && memcmp(lhs_data->data(), rhs_data->data(), size) == 0;
+}
+
+std::string* ResourceFileFlattener::FindReusableFlattenedXml(const FileOperation& file_op) {
+  const auto bucket = flattened_xml_cache_.find(file_op.content_hash);
+  if (bucket == flattened_xml_cache_.end()) {
+    return nullptr;
+  }
+  for (FlattenedXmlCacheEntry& entry : bucket->second) {
+    if (entry.size == file_op.content_size && entry.config == file_op.config &&
+        InputContentsMatch(entry.file, file_op.file_to_copy, entry.size)) {
+      return &entry.flattened;
+    }
+  }
+  return nullptr;
+}
+
+void ResourceFileFlattener::CacheFlattenedXml(const FileOperation& file_op,
+                                              std::string flattened) {
+  FlattenedXmlCacheEntry entry;
+  entry.file = file_op.file_to_copy;
+  entry.size = file_op.content_size;
+  entry.config = file_op.config;
+  entry.flattened = std::move(flattened);
+  flattened_xml_cache_[file_op.content_hash].push_back(std::move(entry));
+}
+
 bool ResourceFileFlattener::Flatten(ResourceTable* table, IArchiveWriter* archive_writer) {
   TRACE_CALL();
   bool error = false;
@@ -512,9 +641,8 @@ bool ResourceFileFlattener::Flatten(ResourceTable* table, IArchiveWriter* archiv
     for (auto& type : pkg->types) {
       // Sort by config and name, so that we get better locality in the zip file.
       config_sorted_files.clear();
-      std::queue<FileOperation> file_operations;
 
-      // Populate the queue with all files in the ResourceTable.
+      // Collect all files in the ResourceTable.
       for (auto& entry : type->entries) {
         for (auto& config_value : entry->values) {
           // WARNING! Do not insert or remove any resources while executing in this scope. It will
@@ -541,44 +669,12 @@ bool ResourceFileFlattener::Flatten(ResourceTable* table, IArchiveWriter* archiv
           if (type->type != ResourceType::kRaw &&
               (file_ref->type == ResourceFile::Type::kBinaryXml ||
                file_ref->type == ResourceFile::Type::kProtoXml)) {
-            std::unique_ptr<io::IData> data = file->OpenAsData();
-            if (!data) {
-              context_->GetDiagnostics()->Error(DiagMessage(file->GetSource())
-                                                << "failed to open file");
-              return false;
-            }
-
-            if (file_ref->type == ResourceFile::Type::kProtoXml) {
-              pb::XmlNode pb_xml_node;
-              if (!pb_xml_node.ParseFromArray(data->data(), static_cast<int>(data->size()))) {
-                context_->GetDiagnostics()->Error(DiagMessage(file->GetSource())
-                                                  << "failed to parse proto XML");
-                return false;
-              }
-
-              std::string error;
-              file_op.xml_to_flatten = DeserializeXmlResourceFromPb(pb_xml_node, &error);
-              if (file_op.xml_to_flatten == nullptr) {
-                context_->GetDiagnostics()->Error(DiagMessage(file->GetSource())
-                                                  << "failed to deserialize proto XML: " << error);
-                return false;
-              }
-            } else {
-              std::string error_str;
-              file_op.xml_to_flatten = xml::Inflate(data->data(), data->size(), &error_str);
-              if (file_op.xml_to_flatten == nullptr) {
-                context_->GetDiagnostics()->Error(DiagMessage(file->GetSource())
-                                                  << "failed to parse binary XML: " << error_str);
-                return false;
-              }
-            }
+            file_op.xml_type = file_ref->type;
+            file_op.name = ResourceName(pkg->name, type->type, entry->name);
+            file_op.source = file_ref->GetSource();
 
             // Update the type that this file will be written as.
             file_ref->type = XmlFileTypeForOutputFormat(options_.output_format);
-
-            file_op.xml_to_flatten->file.config = config_value->config;
-            file_op.xml_to_flatten->file.source = file_ref->GetSource();
-            file_op.xml_to_flatten->file.name = ResourceName(pkg->name, type->type, entry->name);
           }
 
           // NOTE(adamlesinski): Explicitly construct a StringPiece here, or
@@ -591,6 +687,32 @@ bool ResourceFileFlattener::Flatten(ResourceTable* table, IArchiveWriter* archiv
         }
       }
 
+      // Open and parse the XML documents in parallel. Each file inflates into its own
+      // XmlResource, so the work is independent; diagnostics are not thread-safe, so
+      // failures are recorded per file and reported after the join. Reference linking,
+      // versioning, and archive writes stay on this thread because they mutate the
+      // table, the keep set, and the writer.
+      std::vector<FileOperation*> xml_file_ops;
+      for (auto& map_entry : config_sorted_files) {
+        if (map_entry.second.xml_type != ResourceFile::Type::kUnknown) {
+          xml_file_ops.push_back(&map_entry.second);
+        }
+      }
+
+      std::vector<std::string> parse_errors(xml_file_ops.size());
+      util::ParallelForEachIndex(xml_file_ops.size(), util::DefaultThreadCount(),
+                                 [&xml_file_ops, &parse_errors](size_t index) {
+                                   ParseXmlToFlatten(xml_file_ops[index], &parse_errors[index]);
+                                 });
+
+      for (size_t i = 0; i < xml_file_ops.size(); i++) {
+        if (xml_file_ops[i]->xml_to_flatten == nullptr) {
+          context_->GetDiagnostics()->Error(
+              DiagMessage(xml_file_ops[i]->file_to_copy->GetSource()) << parse_errors[i]);
+          return false;
+        }
+      }
+
       // Now flatten the sorted values.
       for (auto& map_entry : config_sorted_files) {
         const ConfigDescription& config = map_entry.first.first;
@@ -611,6 +733,24 @@ bool ResourceFileFlattener::Flatten(ResourceTable* table, IArchiveWriter* archiv
             }
           }
 
+          // Reuse the flattened output of an already linked byte-identical input before
+          // linking from scratch. Skipped when proguard rules are collected, since every
+          // resource must then register its own keep rules during linking.
+          const bool reuse_flattened_xml = !options_.update_proguard_spec;
+          if (reuse_flattened_xml) {
+            if (std::string* flattened = FindReusableFlattenedXml(file_op)) {
+              if (context_->IsVerbose()) {
+                context_->GetDiagnostics()->Note(
+                    DiagMessage(file_op.xml_to_flatten->file.source)
+                    << "reusing flattened output of identical input for " << file_op.dst_path);
+              }
+              io::StringInputStream input_stream(*flattened);
+              error |= !io::CopyInputStreamToArchive(context_, &input_stream, file_op.dst_path,
+                                                     ArchiveEntry::kCompress, archive_writer);
+              continue;
+            }
+          }
+
           std::vector<std::unique_ptr<xml::XmlResource>> versioned_docs =
               LinkAndVersionXmlFile(table, &file_op);
           if (versioned_docs.empty()) {
@@ -642,8 +782,33 @@ bool ResourceFileFlattener::Flatten(ResourceTable* table, IArchiveWriter* archiv
               }
             }
 
-            error |= !FlattenXml(context_, *doc, dst_path, options_.keep_raw_values,
-                                 false /*utf16*/, options_.output_format, archive_writer);
+            std::string flattened;
+            if (!FlattenXmlToString(context_, *doc, dst_path, options_.keep_raw_values,
+                                    false /*utf16*/, options_.output_format, &flattened)) {
+              error = true;
+              continue;
+            }
+
+            if (context_->IsVerbose()) {
+              context_->GetDiagnostics()->Note(
+                  DiagMessage(dst_path) << "writing to archive (keep_raw_values="
+                                        << (options_.keep_raw_values ? "true" : "false") << ")");
+            }
+
+            io::StringInputStream input_stream(flattened);
+            if (!io::CopyInputStreamToArchive(context_, &input_stream, dst_path,
+                                              ArchiveEntry::kCompress, archive_writer)) {
+              error = true;
+              continue;
+            }
+
+            // Only cache when versioning produced no additional documents; reusing the
+            // output of a versioned file would also need to replay the file references
+            // it added to the table.
+            if (reuse_flattened_xml && versioned_docs.size() == 1 &&
+                doc->file.config == file_op.config) {
+              CacheFlattenedXml(file_op, std::move(flattened));
+            }
           }
         } else {
           error |= !io::CopyFileToArchive(context_, file_op.file_to_copy, file_op.dst_path,
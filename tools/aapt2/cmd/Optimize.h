@@ -100,6 +100,11 @@ class OptimizeCommand : public Command {
         "Enables encoding sparse entries using a binary search tree.\n"
             "This decreases APK size at the cost of resource retrieval performance.",
         &options_.table_flattener_options.use_sparse_entries);
+    AddOptionalSwitch("--deduplicate-entry-values",
+        "Whether to deduplicate entry values where the resource table allows it. Same entries \n"
+            "are most common with --collapse-resource-names, which makes entries that differ \n"
+            "only by resource name identical.",
+        &options_.table_flattener_options.deduplicate_entry_values);
     AddOptionalSwitch("--collapse-resource-names",
         "Collapses resource names to a single value in the key string pool. Resources can \n"
             "be exempted using the \"no_collapse\" directive in a file specified by "
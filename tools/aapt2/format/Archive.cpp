@@ -16,11 +16,14 @@
 
 #include "format/Archive.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include <zlib.h>
+
 #include "android-base/errors.h"
 #include "android-base/macros.h"
 #include "android-base/utf8.h"
@@ -128,6 +131,74 @@ class DirectoryWriter : public IArchiveWriter {
   std::string error_;
 };
 
+// Deflates up to the first 64KB of a rewindable stream to estimate whether the entry is
+// worth compressing at all. Entries holding already-compressed data would otherwise pay a
+// deflate pass over their entire contents, only for the not-compressed-enough check in
+// WriteFile to discard the result and rewrite them stored. On any zlib error this returns
+// true and the caller just attempts compression as before.
+bool SampleCompressesWell(io::InputStream* in) {
+  constexpr size_t kSampleSize = 64 * 1024;
+
+  z_stream stream = {};
+  if (deflateInit(&stream, Z_BEST_SPEED) != Z_OK) {
+    return true;
+  }
+
+  uint8_t out_buffer[8192];
+  size_t sampled = 0;
+  bool reached_eof = false;
+  bool zlib_error = false;
+
+  while (!zlib_error && sampled < kSampleSize) {
+    const void* data = nullptr;
+    size_t len = 0;
+    if (!in->Next(&data, &len)) {
+      reached_eof = !in->HadError();
+      break;
+    }
+
+    const size_t take = std::min(len, kSampleSize - sampled);
+    stream.next_in = const_cast<Bytef*>(static_cast<const Bytef*>(data));
+    stream.avail_in = static_cast<uInt>(take);
+    while (stream.avail_in != 0) {
+      stream.next_out = out_buffer;
+      stream.avail_out = sizeof(out_buffer);
+      if (deflate(&stream, Z_NO_FLUSH) != Z_OK) {
+        zlib_error = true;
+        break;
+      }
+    }
+    sampled += take;
+  }
+
+  int result = Z_OK;
+  while (!zlib_error && result != Z_STREAM_END) {
+    stream.next_out = out_buffer;
+    stream.avail_out = sizeof(out_buffer);
+    result = deflate(&stream, Z_FINISH);
+    if (result != Z_OK && result != Z_STREAM_END) {
+      zlib_error = true;
+    }
+  }
+
+  const size_t compressed = stream.total_out;
+  deflateEnd(&stream);
+
+  if (zlib_error) {
+    return true;
+  }
+
+  if (reached_eof) {
+    // The sample covered the entire entry, so the exact keep threshold from
+    // WriteFile applies.
+    return compressed + (compressed / 10) <= sampled;
+  }
+
+  // The sample is partial; only predict a stored entry when the sampled data
+  // did not shrink at all, so a compressible tail can still win below.
+  return compressed < sampled;
+}
+
 class ZipFileWriter : public IArchiveWriter {
  public:
   ZipFileWriter() = default;
@@ -183,6 +254,20 @@ class ZipFileWriter : public IArchiveWriter {
   }
 
   bool WriteFile(const StringPiece& path, uint32_t flags, io::InputStream* in) override {
+    // When a sample of the data shows the entry will not compress well enough
+    // to keep, store it up front instead of deflating all of it and having
+    // the check below discard and rewrite it.
+    if ((flags & ArchiveEntry::kCompress) != 0 && in->CanRewind()) {
+      const bool compresses = SampleCompressesWell(in);
+      if (!in->Rewind()) {
+        error_ = in->GetError();
+        return false;
+      }
+      if (!compresses) {
+        flags &= ~ArchiveEntry::kCompress;
+      }
+    }
+
     while (true) {
       if (!StartEntry(path, flags)) {
         return false;
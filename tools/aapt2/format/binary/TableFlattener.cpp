@@ -20,6 +20,7 @@
 #include <numeric>
 #include <sstream>
 #include <type_traits>
+#include <unordered_map>
 
 #include "android-base/logging.h"
 #include "android-base/macros.h"
@@ -34,6 +35,7 @@
 #include "format/binary/ResourceTypeExtensions.h"
 #include "trace/TraceBuffer.h"
 #include "util/BigBuffer.h"
+#include "util/Util.h"
 
 using namespace android;
 
@@ -240,13 +242,14 @@ class PackageFlattener {
  public:
   PackageFlattener(IAaptContext* context, ResourceTablePackage* package,
                    const std::map<size_t, std::string>* shared_libs, bool use_sparse_entries,
-                   bool collapse_key_stringpool,
+                   bool deduplicate_entry_values, bool collapse_key_stringpool,
                    const std::set<ResourceName>& name_collapse_exemptions)
       : context_(context),
         diag_(context->GetDiagnostics()),
         package_(package),
         shared_libs_(shared_libs),
         use_sparse_entries_(use_sparse_entries),
+        deduplicate_entry_values_(deduplicate_entry_values),
         collapse_key_stringpool_(collapse_key_stringpool),
         name_collapse_exemptions_(name_collapse_exemptions) {
   }
@@ -357,16 +360,43 @@ class PackageFlattener {
     offsets.resize(num_total_entries, 0xffffffffu);
 
     BigBuffer values_buffer(512);
+
+    // Hash of an entry's flattened bytes to the offset and bytes of each distinct entry
+    // already written, when deduplicating entry values.
+    std::unordered_map<uint64_t, std::vector<std::pair<uint32_t, std::string>>> dedup_index;
+
     for (FlatEntry& flat_entry : *entries) {
       CHECK(static_cast<size_t>(flat_entry.entry->id.value()) < num_total_entries);
-      offsets[flat_entry.entry->id.value()] = values_buffer.size();
-      if (!FlattenValue(&flat_entry, &values_buffer)) {
+
+      BigBuffer entry_buffer(512);
+      BigBuffer* out_buffer = deduplicate_entry_values_ ? &entry_buffer : &values_buffer;
+      uint32_t offset = values_buffer.size();
+      if (!FlattenValue(&flat_entry, out_buffer)) {
         diag_->Error(DiagMessage()
                      << "failed to flatten resource '"
                      << ResourceNameRef(package_->name, type->type, flat_entry.entry->name)
                      << "' for configuration '" << config << "'");
         return false;
       }
+
+      if (deduplicate_entry_values_) {
+        // If an identical entry was already written, point this entry's offset at it.
+        // Entries are always a multiple of 4 bytes long, so shared offsets stay aligned.
+        std::string bytes = entry_buffer.to_string();
+        const uint64_t hash = util::HashBytes64(bytes.data(), bytes.size());
+        std::vector<std::pair<uint32_t, std::string>>& candidates = dedup_index[hash];
+        auto iter = std::find_if(candidates.begin(), candidates.end(),
+                                 [&bytes](const std::pair<uint32_t, std::string>& candidate) {
+                                   return candidate.second == bytes;
+                                 });
+        if (iter != candidates.end()) {
+          offset = iter->first;
+        } else {
+          values_buffer.AppendBuffer(std::move(entry_buffer));
+          candidates.emplace_back(offset, std::move(bytes));
+        }
+      }
+      offsets[flat_entry.entry->id.value()] = offset;
     }
 
     bool sparse_encode = use_sparse_entries_;
@@ -701,6 +731,7 @@ class PackageFlattener {
   ResourceTablePackage* package_;
   const std::map<size_t, std::string>* shared_libs_;
   bool use_sparse_entries_;
+  bool deduplicate_entry_values_;
   StringPool type_pool_;
   StringPool key_pool_;
   bool collapse_key_stringpool_;
@@ -751,7 +782,8 @@ bool TableFlattener::Consume(IAaptContext* context, ResourceTable* table) {
     }
 
     PackageFlattener flattener(context, package.get(), &table->included_packages_,
-                               options_.use_sparse_entries, options_.collapse_key_stringpool,
+                               options_.use_sparse_entries, options_.deduplicate_entry_values,
+                               options_.collapse_key_stringpool,
                                options_.name_collapse_exemptions);
     if (!flattener.FlattenPackage(&package_buffer)) {
       return false;
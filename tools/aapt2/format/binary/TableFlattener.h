@@ -37,6 +37,13 @@ struct TableFlattenerOptions {
   // minSdk is O+.
   bool use_sparse_entries = false;
 
+  // When true, entries within a type/configuration chunk that flatten to identical
+  // bytes are written once and share an offset in the entry index, making the table
+  // smaller. Only safe for a final APK, since tools that edit the table in place may
+  // not expect aliased entries. Most effective combined with collapse_key_stringpool,
+  // which makes entries that differ only by name byte-identical.
+  bool deduplicate_entry_values = false;
+
   // When true, the key string pool in the final ResTable
   // is collapsed to a single entry. All resource entries
   // have name indices that point to this single value
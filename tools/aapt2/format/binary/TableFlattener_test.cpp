@@ -30,6 +30,7 @@ using namespace android;
 
 using ::testing::Gt;
 using ::testing::IsNull;
+using ::testing::Lt;
 using ::testing::NotNull;
 
 using PolicyFlags = android::ResTable_overlayable_policy_header::PolicyFlags;
@@ -615,6 +616,53 @@ TEST_F(TableFlattenerTest, ObfuscatingResourceNamesNoNameCollapseExemptionsSucce
                      ResourceId(0x7f050000), {}, Res_value::TYPE_STRING, (uint32_t)idx, 0u));
 }
 
+TEST_F(TableFlattenerTest, DeduplicatingEntryValuesSharesIdenticalEntries) {
+  std::unique_ptr<ResourceTable> table =
+      test::ResourceTableBuilder()
+          .SetPackageId("com.app.test", 0x7f)
+          .AddSimple("com.app.test:id/one", ResourceId(0x7f020000))
+          .AddSimple("com.app.test:id/two", ResourceId(0x7f020001))
+          .AddSimple("com.app.test:id/three", ResourceId(0x7f020002))
+          .AddValue("com.app.test:integer/one", ResourceId(0x7f030000),
+                    util::make_unique<BinaryPrimitive>(uint8_t(Res_value::TYPE_INT_DEC), 1u))
+          .AddValue("com.app.test:integer/two", ResourceId(0x7f030001),
+                    util::make_unique<BinaryPrimitive>(uint8_t(Res_value::TYPE_INT_DEC), 1u))
+          .Build();
+
+  // Collapsing the key string pool makes entries that differ only by name byte-identical.
+  TableFlattenerOptions options;
+  options.collapse_key_stringpool = true;
+
+  std::string content_without_dedup;
+  ASSERT_TRUE(Flatten(context_.get(), options, table.get(), &content_without_dedup));
+
+  options.deduplicate_entry_values = true;
+
+  std::string content_with_dedup;
+  ASSERT_TRUE(Flatten(context_.get(), options, table.get(), &content_with_dedup));
+
+  EXPECT_THAT(content_with_dedup.size(), Lt(content_without_dedup.size()));
+
+  // The deduplicated table must still resolve every resource.
+  ResTable res_table;
+  ASSERT_EQ(res_table.add(content_with_dedup.data(), content_with_dedup.size(), 1, true), NO_ERROR);
+
+  EXPECT_TRUE(Exists(&res_table, "com.app.test:id/0_resource_name_obfuscated",
+                     ResourceId(0x7f020000), {}, Res_value::TYPE_INT_BOOLEAN, 0u, 0u));
+
+  EXPECT_TRUE(Exists(&res_table, "com.app.test:id/0_resource_name_obfuscated",
+                     ResourceId(0x7f020001), {}, Res_value::TYPE_INT_BOOLEAN, 0u, 0u));
+
+  EXPECT_TRUE(Exists(&res_table, "com.app.test:id/0_resource_name_obfuscated",
+                     ResourceId(0x7f020002), {}, Res_value::TYPE_INT_BOOLEAN, 0u, 0u));
+
+  EXPECT_TRUE(Exists(&res_table, "com.app.test:integer/0_resource_name_obfuscated",
+                     ResourceId(0x7f030000), {}, Res_value::TYPE_INT_DEC, 1u, 0u));
+
+  EXPECT_TRUE(Exists(&res_table, "com.app.test:integer/0_resource_name_obfuscated",
+                     ResourceId(0x7f030001), {}, Res_value::TYPE_INT_DEC, 1u, 0u));
+}
+
 TEST_F(TableFlattenerTest, ObfuscatingResourceNamesWithNameCollapseExemptionsSucceeds) {
   std::unique_ptr<ResourceTable> table =
       test::ResourceTableBuilder()
@@ -16,8 +16,10 @@
 
 #include "io/ZipArchive.h"
 
+#include "android-base/macros.h"
 #include "utils/FileMap.h"
 #include "ziparchive/zip_archive.h"
+#include "ziparchive/zip_archive_stream_entry.h"
 
 #include "Source.h"
 #include "trace/TraceBuffer.h"
@@ -29,6 +31,92 @@ using ::android::StringPiece;
 namespace aapt {
 namespace io {
 
+namespace {
+
+// An InputStream that inflates a compressed ZIP entry on the fly, so that a single forward
+// pass over a large entry (eg. the resource table of a proto APK) never requires the whole
+// uncompressed contents to be resident in memory at once.
+class ZipEntryInputStream : public io::InputStream {
+ public:
+  ZipEntryInputStream(ZipArchiveHandle handle, const ZipEntry& entry)
+      : handle_(handle),
+        entry_(entry),
+        stream_(::ZipArchiveStreamEntry::Create(handle, entry)) {}
+
+  bool Next(const void** data, size_t* size) override {
+    if (HadError()) {
+      return false;
+    }
+
+    if (backup_bytes_ != 0u) {
+      *data = chunk_->data() + (chunk_->size() - backup_bytes_);
+      *size = backup_bytes_;
+      bytes_read_ += backup_bytes_;
+      backup_bytes_ = 0u;
+      return true;
+    }
+
+    chunk_ = stream_ != nullptr ? stream_->Read() : nullptr;
+    if (chunk_ == nullptr) {
+      // Read() returns null at both end-of-data and failure, so treat coming up short of the
+      // entry's uncompressed length as an error.
+      if (bytes_read_ != entry_.uncompressed_length) {
+        error_ = "failed to extract ZIP entry";
+      }
+      return false;
+    }
+
+    *data = chunk_->data();
+    *size = chunk_->size();
+    bytes_read_ += chunk_->size();
+    return true;
+  }
+
+  void BackUp(size_t count) override {
+    backup_bytes_ += count;
+    bytes_read_ -= count;
+  }
+
+  size_t ByteCount() const override {
+    return bytes_read_;
+  }
+
+  bool CanRewind() const override {
+    return true;
+  }
+
+  bool Rewind() override {
+    // Restart inflation from the beginning of the entry.
+    stream_ = ::ZipArchiveStreamEntry::Create(handle_, entry_);
+    chunk_ = nullptr;
+    bytes_read_ = 0u;
+    backup_bytes_ = 0u;
+    error_.clear();
+    return stream_ != nullptr;
+  }
+
+  bool HadError() const override {
+    return !error_.empty();
+  }
+
+  std::string GetError() const override {
+    return error_;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ZipEntryInputStream);
+
+  ZipArchiveHandle handle_;
+  ZipEntry entry_;
+  std::unique_ptr<::ZipArchiveStreamEntry> stream_;
+  const std::vector<uint8_t>* chunk_ = nullptr;
+  size_t bytes_read_ = 0u;
+  size_t backup_bytes_ = 0u;
+  std::string error_;
+};
+
+}  // namespace
+
 ZipFile::ZipFile(ZipArchiveHandle handle, const ZipEntry& entry,
                  const Source& source)
     : zip_handle_(handle), zip_entry_(entry), source_(source) {}
@@ -65,7 +153,15 @@ std::unique_ptr<IData> ZipFile::OpenAsData() {
 }
 
 std::unique_ptr<io::InputStream> ZipFile::OpenInputStream() {
-  return OpenAsData();
+  if (zip_entry_.method == kCompressStored || zip_entry_.uncompressed_length == 0) {
+    // Stored entries are mmapped by OpenAsData, which is already zero-copy.
+    return OpenAsData();
+  }
+
+  // Compressed entries are inflated a chunk at a time. Readers that make a single pass, like
+  // the protobuf parser consuming a proto APK's resource table, then never hold the whole
+  // uncompressed entry in memory alongside the structures they build from it.
+  return util::make_unique<ZipEntryInputStream>(zip_handle_, zip_entry_);
 }
 
 const Source& ZipFile::GetSource() const {
@@ -28,8 +28,9 @@
 namespace aapt {
 namespace io {
 
-// An IFile representing a file within a ZIP archive. If the file is compressed, it is uncompressed
-// and copied into memory when opened. Otherwise it is mmapped from the ZIP archive.
+// An IFile representing a file within a ZIP archive. If the file is compressed, OpenAsData
+// uncompresses and copies it into memory, while OpenInputStream inflates it incrementally.
+// Otherwise it is mmapped from the ZIP archive.
 class ZipFile : public IFile {
  public:
   ZipFile(::ZipArchiveHandle handle, const ::ZipEntry& entry, const Source& source);
@@ -16,6 +16,8 @@
 
 #include "link/ReferenceLinker.h"
 
+#include <mutex>
+
 #include "android-base/logging.h"
 #include "android-base/stringprintf.h"
 #include "androidfw/ResourceTypes.h"
@@ -29,6 +31,7 @@
 #include "process/IResourceTableConsumer.h"
 #include "process/SymbolTable.h"
 #include "trace/TraceBuffer.h"
+#include "util/Parallel.h"
 #include "util/Util.h"
 #include "xml/XmlUtil.h"
 
@@ -50,13 +53,17 @@ class ReferenceLinkerVisitor : public DescendingValueVisitor {
  public:
   using DescendingValueVisitor::Visit;
 
+  // string_pool_lock serializes allocations from the shared StringPool when
+  // visitors for different entries run on worker threads.
   ReferenceLinkerVisitor(const CallSite& callsite, IAaptContext* context, SymbolTable* symbols,
-                         StringPool* string_pool, xml::IPackageDeclStack* decl)
+                         StringPool* string_pool, xml::IPackageDeclStack* decl,
+                         std::mutex* string_pool_lock)
       : callsite_(callsite),
         context_(context),
         symbols_(symbols),
         package_decls_(decl),
-        string_pool_(string_pool) {}
+        string_pool_(string_pool),
+        string_pool_lock_(string_pool_lock) {}
 
   void Visit(Reference* ref) override {
     if (!ReferenceLinker::LinkReference(callsite_, ref, context_, symbols_, package_decls_)) {
@@ -140,6 +147,7 @@ class ReferenceLinkerVisitor : public DescendingValueVisitor {
         StringBuilder string_builder;
         string_builder.AppendText(*raw_string->value);
         if (string_builder) {
+          std::lock_guard<std::mutex> lock(*string_pool_lock_);
           transformed =
               util::make_unique<String>(string_pool_->MakeRef(string_builder.to_string()));
         }
@@ -157,9 +165,78 @@ class ReferenceLinkerVisitor : public DescendingValueVisitor {
   SymbolTable* symbols_;
   xml::IPackageDeclStack* package_decls_;
   StringPool* string_pool_;
+  std::mutex* string_pool_lock_;
   bool error_ = false;
 };
 
+// Serializes diagnostics emitted from linker worker threads; the wrapped
+// IDiagnostics implementations (and the stream behind them) are not
+// thread-safe.
+class LockedDiagnostics : public IDiagnostics {
+ public:
+  LockedDiagnostics(IDiagnostics* diag, std::mutex* lock) : diag_(diag), lock_(lock) {}
+
+  void Log(Level level, DiagMessageActual& actual_msg) override {
+    std::lock_guard<std::mutex> guard(*lock_);
+    diag_->Log(level, actual_msg);
+  }
+
+ private:
+  IDiagnostics* diag_;
+  std::mutex* lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(LockedDiagnostics);
+};
+
+// Forwards an IAaptContext, swapping in thread-safe diagnostics for use on
+// linker worker threads.
+class LockedContext : public IAaptContext {
+ public:
+  LockedContext(IAaptContext* context, IDiagnostics* diag) : context_(context), diag_(diag) {}
+
+  PackageType GetPackageType() override {
+    return context_->GetPackageType();
+  }
+
+  SymbolTable* GetExternalSymbols() override {
+    return context_->GetExternalSymbols();
+  }
+
+  IDiagnostics* GetDiagnostics() override {
+    return diag_;
+  }
+
+  const std::string& GetCompilationPackage() override {
+    return context_->GetCompilationPackage();
+  }
+
+  uint8_t GetPackageId() override {
+    return context_->GetPackageId();
+  }
+
+  NameMangler* GetNameMangler() override {
+    return context_->GetNameMangler();
+  }
+
+  bool IsVerbose() override {
+    return context_->IsVerbose();
+  }
+
+  int GetMinSdkVersion() override {
+    return context_->GetMinSdkVersion();
+  }
+
+  const std::set<std::string>& GetSplitNameDependencies() override {
+    return context_->GetSplitNameDependencies();
+  }
+
+ private:
+  IAaptContext* context_;
+  IDiagnostics* diag_;
+
+  DISALLOW_COPY_AND_ASSIGN(LockedContext);
+};
+
 class EmptyDeclStack : public xml::IPackageDeclStack {
  public:
   EmptyDeclStack() = default;
@@ -384,6 +461,14 @@ bool ReferenceLinker::Consume(IAaptContext* context, ResourceTable* table) {
   TRACE_NAME("ReferenceLinker::Consume");
   EmptyDeclStack decl_stack;
   bool error = false;
+
+  struct EntryLinkOp {
+    ResourceEntry* entry;
+    CallSite callsite;
+  };
+  std::vector<EntryLinkOp> attr_ops;
+  std::vector<EntryLinkOp> entry_ops;
+
   for (auto& package : table->packages) {
     // Since we're linking, each package must have a name.
     CHECK(!package->name.empty()) << "all packages being linked must have a name";
@@ -411,18 +496,58 @@ bool ReferenceLinker::Consume(IAaptContext* context, ResourceTable* table) {
         }
 
         // The context of this resource is the package in which it is defined.
-        const CallSite callsite{name.package};
-        ReferenceLinkerVisitor visitor(callsite, context, context->GetExternalSymbols(),
-                                       &table->string_pool, &decl_stack);
+        // Attribute entries are linked in their own serial pass: when the local
+        // table is a symbol source, linking a style looks attributes up and
+        // copies them, which must not happen while another thread is assigning
+        // IDs inside those same attributes.
+        const bool is_attr =
+            type->type == ResourceType::kAttr || type->type == ResourceType::kAttrPrivate;
+        (is_attr ? attr_ops : entry_ops).push_back(EntryLinkOp{entry.get(), CallSite{name.package}});
+      }
+    }
+  }
+
+  std::mutex diag_mutex;
+  std::mutex string_pool_mutex;
+  LockedDiagnostics locked_diagnostics(context->GetDiagnostics(), &diag_mutex);
+  LockedContext locked_context(context, &locked_diagnostics);
+
+  for (EntryLinkOp& op : attr_ops) {
+    ReferenceLinkerVisitor visitor(op.callsite, context, context->GetExternalSymbols(),
+                                   &table->string_pool, &decl_stack, &string_pool_mutex);
+    for (auto& config_value : op.entry->values) {
+      config_value->value->Accept(&visitor);
+    }
+    if (visitor.HasError()) {
+      error = true;
+    }
+  }
 
-        for (auto& config_value : entry->values) {
+  // With attributes linked, the remaining entries only mutate their own
+  // values; symbol lookups go through the (thread-safe) SymbolTable and the
+  // shared string pool and diagnostics are serialized by the mutexes above,
+  // so entries can be linked on worker threads. Errors are recorded per
+  // entry and folded in after the join.
+  std::vector<uint8_t> entry_errors(entry_ops.size(), 0);
+  util::ParallelForEachIndex(
+      entry_ops.size(), util::DefaultThreadCount(),
+      [&entry_ops, &entry_errors, &locked_context, &table, &decl_stack,
+       &string_pool_mutex](size_t index) {
+        EntryLinkOp& op = entry_ops[index];
+        ReferenceLinkerVisitor visitor(op.callsite, &locked_context,
+                                       locked_context.GetExternalSymbols(), &table->string_pool,
+                                       &decl_stack, &string_pool_mutex);
+        for (auto& config_value : op.entry->values) {
           config_value->value->Accept(&visitor);
         }
-
         if (visitor.HasError()) {
-          error = true;
+          entry_errors[index] = 1;
         }
-      }
+      });
+
+  for (const uint8_t entry_error : entry_errors) {
+    if (entry_error) {
+      error = true;
     }
   }
   return !error;
@@ -17,10 +17,12 @@
 #include "optimize/ResourceDeduper.h"
 
 #include <algorithm>
+#include <vector>
 
 #include "DominatorTree.h"
 #include "ResourceTable.h"
 #include "trace/TraceBuffer.h"
+#include "util/Parallel.h"
 
 using android::ConfigDescription;
 
@@ -113,13 +115,21 @@ static void DedupeEntry(IAaptContext* context, ResourceEntry* entry) {
 
 bool ResourceDeduper::Consume(IAaptContext* context, ResourceTable* table) {
   TRACE_CALL();
+  std::vector<ResourceEntry*> entries;
   for (auto& package : table->packages) {
     for (auto& type : package->types) {
       for (auto& entry : type->entries) {
-        DedupeEntry(context, entry.get());
+        entries.push_back(entry.get());
       }
     }
   }
+
+  // Each entry builds its dominator tree and removes dominated values independently of every
+  // other entry, so the work is spread across threads. Verbose mode logs a note for each
+  // removed value, so it stays on a single thread to keep diagnostics in table order.
+  const size_t num_threads = context->IsVerbose() ? 1u : util::DefaultThreadCount();
+  util::ParallelForEachIndex(entries.size(), num_threads,
+                             [&](size_t index) { DedupeEntry(context, entries[index]); });
   return true;
 }
 
@@ -21,6 +21,7 @@
 
 #include "ResourceTable.h"
 #include "trace/TraceBuffer.h"
+#include "util/Parallel.h"
 
 using android::ConfigDescription;
 
@@ -147,13 +148,19 @@ static void CollapseVersions(int min_sdk, ResourceEntry* entry) {
 bool VersionCollapser::Consume(IAaptContext* context, ResourceTable* table) {
   TRACE_NAME("VersionCollapser::Consume");
   const int min_sdk = context->GetMinSdkVersion();
+  std::vector<ResourceEntry*> entries;
   for (auto& package : table->packages) {
     for (auto& type : package->types) {
       for (auto& entry : type->entries) {
-        CollapseVersions(min_sdk, entry.get());
+        entries.push_back(entry.get());
       }
     }
   }
+
+  // Each entry's values are collapsed independently of every other entry, so the work is
+  // spread across threads.
+  util::ParallelForEachIndex(entries.size(), util::DefaultThreadCount(),
+                             [&](size_t index) { CollapseVersions(min_sdk, entries[index]); });
   return true;
 }
 
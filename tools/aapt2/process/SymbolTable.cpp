@@ -42,9 +42,14 @@ namespace aapt {
 
 SymbolTable::SymbolTable(NameMangler* mangler)
     : mangler_(mangler),
-      delegate_(util::make_unique<DefaultSymbolTableDelegate>()),
-      cache_(200),
-      id_cache_(200) {
+      delegate_(util::make_unique<DefaultSymbolTableDelegate>()) {
+}
+
+void SymbolTable::ClearNameCache() {
+  for (NameCacheShard& shard : cache_shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.symbols.clear();
+  }
 }
 
 void SymbolTable::SetDelegate(std::unique_ptr<ISymbolTableDelegate> delegate) {
@@ -52,7 +57,7 @@ void SymbolTable::SetDelegate(std::unique_ptr<ISymbolTableDelegate> delegate) {
   delegate_ = std::move(delegate);
 
   // Clear the cache in case this delegate changes the order of lookup.
-  cache_.clear();
+  ClearNameCache();
 }
 
 void SymbolTable::AppendSource(std::unique_ptr<ISymbolSource> source) {
@@ -67,7 +72,7 @@ void SymbolTable::PrependSource(std::unique_ptr<ISymbolSource> source) {
 
   // We must clear the cache in case we did a lookup before adding this
   // resource.
-  cache_.clear();
+  ClearNameCache();
 }
 
 const SymbolTable::Symbol* SymbolTable::FindByName(const ResourceName& name) {
@@ -83,8 +88,13 @@ const SymbolTable::Symbol* SymbolTable::FindByName(const ResourceName& name) {
   }
 
   // We store the name unmangled in the cache, so look it up as-is.
-  if (const std::shared_ptr<Symbol>& s = cache_.get(*name_with_package)) {
-    return s.get();
+  NameCacheShard& shard = cache_shards_[hash_type(*name_with_package) % kNumShards];
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto iter = shard.symbols.find(*name_with_package);
+    if (iter != shard.symbols.end()) {
+      return iter->second.get();
+    }
   }
 
   // The name was not found in the cache. Mangle it (if necessary) and find it in our sources.
@@ -96,48 +106,61 @@ const SymbolTable::Symbol* SymbolTable::FindByName(const ResourceName& name) {
     mangled_name = &mangled_name_impl.value();
   }
 
-  std::unique_ptr<Symbol> symbol = delegate_->FindByName(*mangled_name, sources_);
+  std::unique_ptr<Symbol> symbol;
+  {
+    std::lock_guard<std::mutex> lock(sources_mutex_);
+    symbol = delegate_->FindByName(*mangled_name, sources_);
+  }
   if (symbol == nullptr) {
     return nullptr;
   }
 
-  // Take ownership of the symbol into a shared_ptr. We do this because
-  // LruCache doesn't support unique_ptr.
+  // Take ownership of the symbol into a shared_ptr, because the same Symbol
+  // may also be interned in the ID cache.
   std::shared_ptr<Symbol> shared_symbol(std::move(symbol));
 
-  // Since we look in the cache with the unmangled, but package prefixed
-  // name, we must put the same name into the cache.
-  cache_.put(*name_with_package, shared_symbol);
-
   if (shared_symbol->id) {
     // The symbol has an ID, so we can also cache this!
-    id_cache_.put(shared_symbol->id.value(), shared_symbol);
+    IdCacheShard& id_shard = id_cache_shards_[hash_type(shared_symbol->id.value()) % kNumShards];
+    std::lock_guard<std::mutex> lock(id_shard.mutex);
+    id_shard.symbols.emplace(shared_symbol->id.value(), shared_symbol);
   }
 
-  // Returns the raw pointer. Callers are not expected to hold on to this
-  // between calls to Find*.
-  return shared_symbol.get();
+  // Since we look in the cache with the unmangled, but package prefixed
+  // name, we must put the same name into the cache. If another thread
+  // interned the same name while we were looking it up, keep its Symbol so
+  // every caller sees the same pointer.
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto result = shard.symbols.emplace(*name_with_package, std::move(shared_symbol));
+  return result.first->second.get();
 }
 
 const SymbolTable::Symbol* SymbolTable::FindById(const ResourceId& id) {
-  if (const std::shared_ptr<Symbol>& s = id_cache_.get(id)) {
-    return s.get();
+  IdCacheShard& shard = id_cache_shards_[hash_type(id) % kNumShards];
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto iter = shard.symbols.find(id);
+    if (iter != shard.symbols.end()) {
+      return iter->second.get();
+    }
   }
 
   // We did not find it in the cache, so look through the sources.
-  std::unique_ptr<Symbol> symbol = delegate_->FindById(id, sources_);
+  std::unique_ptr<Symbol> symbol;
+  {
+    std::lock_guard<std::mutex> lock(sources_mutex_);
+    symbol = delegate_->FindById(id, sources_);
+  }
   if (symbol == nullptr) {
     return nullptr;
   }
 
-  // Take ownership of the symbol into a shared_ptr. We do this because LruCache
-  // doesn't support unique_ptr.
+  // Intern the result; if another thread raced us here, keep its Symbol so
+  // every caller sees the same pointer.
   std::shared_ptr<Symbol> shared_symbol(std::move(symbol));
-  id_cache_.put(id, shared_symbol);
-
-  // Returns the raw pointer. Callers are not expected to hold on to this
-  // between calls to Find*.
-  return shared_symbol.get();
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto result = shard.symbols.emplace(id, std::move(shared_symbol));
+  return result.first->second.get();
 }
 
 const SymbolTable::Symbol* SymbolTable::FindByReference(const Reference& ref) {
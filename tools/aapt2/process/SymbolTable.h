@@ -19,13 +19,14 @@
 
 #include <algorithm>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "android-base/macros.h"
 #include "androidfw/Asset.h"
 #include "androidfw/AssetManager2.h"
 #include "utils/JenkinsHash.h"
-#include "utils/LruCache.h"
 
 #include "Resource.h"
 #include "ResourceTable.h"
@@ -86,29 +87,62 @@ class SymbolTable {
   // cause the existing cache to be cleared.
   void PrependSource(std::unique_ptr<ISymbolSource> source);
 
-  // NOTE: Never hold on to the result between calls to FindByXXX. The
-  // results are stored in a cache which may evict entries on subsequent calls.
+  // The FindByXXX methods may be called concurrently from multiple threads.
+  // NOTE: The returned Symbol stays valid until the set of sources or the
+  // delegate changes (SetDelegate/PrependSource); never hold on to it across
+  // those calls.
   const Symbol* FindByName(const ResourceName& name);
 
-  // NOTE: Never hold on to the result between calls to FindByXXX. The
-  // results are stored in a cache which may evict entries on subsequent calls.
+  // NOTE: See the threading and lifetime notes on FindByName.
   const Symbol* FindById(const ResourceId& id);
 
   // Let's the ISymbolSource decide whether looking up by name or ID is faster,
   // if both are available.
-  // NOTE: Never hold on to the result between calls to FindByXXX. The
-  // results are stored in a cache which may evict entries on subsequent calls.
+  // NOTE: See the threading and lifetime notes on FindByName.
   const Symbol* FindByReference(const Reference& ref);
 
  private:
+  // Lookup results are interned in hash shards, each behind its own lock, so
+  // concurrent lookups only contend when they hash to the same shard. Entries
+  // are never evicted: callers keep raw Symbol pointers between calls, which
+  // eviction from another thread would invalidate. Misses fall through to the
+  // sources under sources_mutex_, since the sources (AssetManager2 in
+  // particular) keep single-threaded caches of their own.
+  static const size_t kNumShards = 16;
+
+  struct ResourceNameHasher {
+    size_t operator()(const ResourceName& name) const {
+      return hash_type(name);
+    }
+  };
+
+  struct ResourceIdHasher {
+    size_t operator()(const ResourceId& id) const {
+      return hash_type(id);
+    }
+  };
+
+  // We use shared_ptr because the same Symbol can be interned under both its
+  // name and its ID.
+  struct NameCacheShard {
+    std::mutex mutex;
+    std::unordered_map<ResourceName, std::shared_ptr<Symbol>, ResourceNameHasher> symbols;
+  };
+
+  struct IdCacheShard {
+    std::mutex mutex;
+    std::unordered_map<ResourceId, std::shared_ptr<Symbol>, ResourceIdHasher> symbols;
+  };
+
+  void ClearNameCache();
+
   NameMangler* mangler_;
   std::unique_ptr<ISymbolTableDelegate> delegate_;
   std::vector<std::unique_ptr<ISymbolSource>> sources_;
+  std::mutex sources_mutex_;
 
-  // We use shared_ptr because unique_ptr is not supported and
-  // we need automatic deletion.
-  android::LruCache<ResourceName, std::shared_ptr<Symbol>> cache_;
-  android::LruCache<ResourceId, std::shared_ptr<Symbol>> id_cache_;
+  NameCacheShard cache_shards_[kNumShards];
+  IdCacheShard id_cache_shards_[kNumShards];
 
   DISALLOW_COPY_AND_ASSIGN(SymbolTable);
 };
@@ -35,7 +35,8 @@ void* BigBuffer::NextBlockImpl(size_t size) {
     }
   }
 
-  const size_t actual_size = std::max(block_size_, size);
+  const size_t actual_size = std::max(next_block_size_, size);
+  next_block_size_ = std::min(next_block_size_ * 2u, kMaxBlockSize);
 
   Block block = {};
 
@@ -64,15 +65,18 @@ void* BigBuffer::NextBlock(size_t* out_size) {
     }
   }
 
+  const size_t actual_size = next_block_size_;
+  next_block_size_ = std::min(next_block_size_ * 2u, kMaxBlockSize);
+
   // Zero-allocate the block's buffer.
   Block block = {};
-  block.buffer = std::unique_ptr<uint8_t[]>(new uint8_t[block_size_]());
+  block.buffer = std::unique_ptr<uint8_t[]>(new uint8_t[actual_size]());
   CHECK(block.buffer);
-  block.size = block_size_;
-  block.block_size_ = block_size_;
+  block.size = actual_size;
+  block.block_size_ = actual_size;
   blocks_.push_back(std::move(block));
-  size_ += block_size_;
-  *out_size = block_size_;
+  size_ += actual_size;
+  *out_size = actual_size;
   return blocks_.back().buffer.get();
 }
 
@@ -122,6 +122,11 @@ class BigBuffer {
  private:
   DISALLOW_COPY_AND_ASSIGN(BigBuffer);
 
+  /**
+   * Largest block allocation the geometric growth will reach.
+   */
+  constexpr static size_t kMaxBlockSize = 4u * 1024u * 1024u;
+
   /**
    * Returns a pointer to a buffer of the requested size.
    * The buffer is zero-initialized.
@@ -129,15 +134,25 @@ class BigBuffer {
   void* NextBlockImpl(size_t size);
 
   size_t block_size_;
+
+  /**
+   * Size of the next block to allocate. Starts at block_size_ and doubles with
+   * every allocated block up to kMaxBlockSize, so buffers that end up holding
+   * megabytes (like a flattened resource table) take a handful of allocations
+   * and downstream write calls instead of thousands of fixed-size blocks.
+   */
+  size_t next_block_size_;
+
   size_t size_;
   std::vector<Block> blocks_;
 };
 
 inline BigBuffer::BigBuffer(size_t block_size)
-    : block_size_(block_size), size_(0) {}
+    : block_size_(block_size), next_block_size_(block_size), size_(0) {}
 
 inline BigBuffer::BigBuffer(BigBuffer&& rhs) noexcept
     : block_size_(rhs.block_size_),
+      next_block_size_(rhs.next_block_size_),
       size_(rhs.size_),
       blocks_(std::move(rhs.blocks_)) {}
 
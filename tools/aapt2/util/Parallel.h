@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AAPT_UTIL_PARALLEL_H
+#define AAPT_UTIL_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace aapt {
+namespace util {
+
+// Returns the number of worker threads to use for parallel sections, which is the
+// hardware concurrency when it is known and 1 otherwise.
+inline size_t DefaultThreadCount() {
+  return std::max<size_t>(1u, std::thread::hardware_concurrency());
+}
+
+// Invokes body(index) for every index in [0, count), distributing indices across at
+// most num_threads worker threads, and blocks until every index has been processed.
+// Indices are handed out one at a time, so uneven task sizes balance naturally.
+//
+// body is invoked concurrently and must only touch shared state that is safe to
+// access from multiple threads; record per-index results (including errors) into
+// pre-sized storage and act on them after this returns.
+template <typename Body>
+void ParallelForEachIndex(size_t count, size_t num_threads, const Body& body) {
+  const size_t thread_count = std::min(count, std::max<size_t>(1u, num_threads));
+  if (thread_count <= 1) {
+    for (size_t index = 0; index < count; index++) {
+      body(index);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next_index(0);
+  std::vector<std::thread> workers;
+  workers.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; i++) {
+    workers.emplace_back([count, &next_index, &body]() {
+      while (true) {
+        const size_t index = next_index.fetch_add(1u, std::memory_order_relaxed);
+        if (index >= count) {
+          return;
+        }
+        body(index);
+      }
+    });
+  }
+
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+}  // namespace util
+}  // namespace aapt
+
+#endif  // AAPT_UTIL_PARALLEL_H
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "util/Parallel.h"
+
+#include <atomic>
+#include <vector>
+
+#include "test/Test.h"
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+namespace aapt {
+
+TEST(ParallelTest, VisitsEveryIndexExactlyOnce) {
+  const size_t count = 1000u;
+  std::vector<std::atomic<int>> visits(count);
+  for (std::atomic<int>& visit : visits) {
+    visit = 0;
+  }
+
+  util::ParallelForEachIndex(count, 4u, [&visits](size_t index) { visits[index]++; });
+
+  for (const std::atomic<int>& visit : visits) {
+    EXPECT_THAT(visit.load(), Eq(1));
+  }
+}
+
+TEST(ParallelTest, EmptyRangeInvokesNothing) {
+  std::atomic<int> calls(0);
+  util::ParallelForEachIndex(0u, 4u, [&calls](size_t index) { calls++; });
+  EXPECT_THAT(calls.load(), Eq(0));
+}
+
+TEST(ParallelTest, MoreThreadsThanWork) {
+  std::atomic<int> calls(0);
+  util::ParallelForEachIndex(2u, 16u, [&calls](size_t index) { calls++; });
+  EXPECT_THAT(calls.load(), Eq(2));
+}
+
+TEST(ParallelTest, SingleThreadRunsInline) {
+  std::vector<size_t> order;
+  util::ParallelForEachIndex(3u, 1u, [&order](size_t index) { order.push_back(index); });
+  EXPECT_THAT(order, ElementsAre(0u, 1u, 2u));
+}
+
+}  // namespace aapt
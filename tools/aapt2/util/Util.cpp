@@ -202,6 +202,15 @@ Maybe<std::string> GetFullyQualifiedClassName(const StringPiece& package,
   return result;
 }
 
+uint64_t HashBytes64(const void* data, size_t len) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
 const char* GetToolName() {
   static const char* const sToolName = "Android Asset Packaging Tool (aapt)";
   return sToolName;
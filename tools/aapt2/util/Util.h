@@ -98,6 +98,10 @@ bool IsAndroidSplitName(const android::StringPiece& str);
 Maybe<std::string> GetFullyQualifiedClassName(const android::StringPiece& package,
                                               const android::StringPiece& class_name);
 
+// Hashes the given range of bytes with 64-bit FNV-1a. The result is stable across runs
+// and platforms, so it is safe to use for content fingerprints.
+uint64_t HashBytes64(const void* data, size_t len);
+
 // Retrieves the formatted name of aapt2.
 const char* GetToolName();
 
@@ -18,6 +18,8 @@
 #include <utils/SortedVector.h>
 #include <utils/Vector.h>
 
+#include "aapt/AaptUtil.h"
+
 #include "Grouper.h"
 #include "Rule.h"
 #include "RuleGenerator.h"
@@ -32,6 +34,45 @@ SplitSelector::SplitSelector() {
 
 SplitSelector::SplitSelector(const Vector<SplitDescription>& splits)
     : mGroups(groupByMutualExclusivity(splits)) {
+    buildGroupIndex();
+}
+
+static uint32_t languageKey(const ConfigDescription& config) {
+    return (((uint32_t)(uint8_t)config.language[0]) << 8) | (uint8_t)config.language[1];
+}
+
+void SplitSelector::buildGroupIndex() {
+    mGroupIndex.clear();
+    const size_t groupCount = mGroups.size();
+    for (size_t i = 0; i < groupCount; i++) {
+        const SortedVector<SplitDescription>& splits = mGroups[i];
+        GroupIndex index;
+        index.kind = GroupIndex::kLinear;
+        index.languageKey = 0;
+
+        const size_t splitCount = splits.size();
+        bool allAbi = splitCount > 0;
+        for (size_t j = 0; j < splitCount; j++) {
+            if (splits[j].abi == abi::Variant_none || splits[j].config.density != 0) {
+                allAbi = false;
+                break;
+            }
+        }
+
+        if (allAbi) {
+            index.kind = GroupIndex::kAbi;
+            for (size_t j = 0; j < splitCount; j++) {
+                // The group is sorted by variant, so each bucket stays sorted.
+                AaptUtil::appendValue(index.abiBuckets, (int) abi::getFamily(splits[j].abi),
+                        splits[j]);
+            }
+        } else if (splitCount == 1 && splits[0].abi == abi::Variant_none
+                && splits[0].config.density == 0 && splits[0].config.language[0] != 0) {
+            index.kind = GroupIndex::kLanguage;
+            index.languageKey = languageKey(splits[0].config);
+        }
+        mGroupIndex.add(index);
+    }
 }
 
 static void selectBestFromGroup(const SortedVector<SplitDescription>& splits,
@@ -58,9 +99,48 @@ static void selectBestFromGroup(const SortedVector<SplitDescription>& splits,
 
 Vector<SplitDescription> SplitSelector::getBestSplits(const SplitDescription& target) const {
     Vector<SplitDescription> bestSplits;
+    const uint32_t targetLanguage = languageKey(target.config);
+    const int targetFamily = (int) abi::getFamily(target.abi);
+
     const size_t groupCount = mGroups.size();
     for (size_t i = 0; i < groupCount; i++) {
-        selectBestFromGroup(mGroups[i], target, bestSplits);
+        const GroupIndex& index = mGroupIndex[i];
+        switch (index.kind) {
+            case GroupIndex::kAbi: {
+                // All members of an ABI group share one config, so only the
+                // highest variant at or below the target's can win: anything
+                // lower loses isBetterThan to it and anything higher fails
+                // match. Descend the family's sorted bucket to find it.
+                const ssize_t bucketIndex = index.abiBuckets.indexOfKey(targetFamily);
+                if (bucketIndex < 0) {
+                    break;
+                }
+                const Vector<SplitDescription>& bucket = index.abiBuckets.valueAt(bucketIndex);
+                for (ssize_t j = bucket.size() - 1; j >= 0; j--) {
+                    if ((int) bucket[j].abi <= (int) target.abi) {
+                        if (bucket[j].match(target)) {
+                            bestSplits.add(bucket[j]);
+                        }
+                        break;
+                    }
+                }
+                break;
+            }
+
+            case GroupIndex::kLanguage:
+                // A split whose language bytes differ from the target's can
+                // never match, so the full evaluation only runs for the
+                // target's own language.
+                if (index.languageKey == targetLanguage) {
+                    selectBestFromGroup(mGroups[i], target, bestSplits);
+                }
+                break;
+
+            case GroupIndex::kLinear:
+            default:
+                selectBestFromGroup(mGroups[i], target, bestSplits);
+                break;
+        }
     }
     return bestSplits;
 }
@@ -36,7 +36,31 @@ public:
     android::KeyedVector<SplitDescription, android::sp<Rule> > getRules() const;
 
 private:
+    // Per-group index precomputed at construction so that selection does not
+    // have to evaluate every split against the target:
+    //  - kAbi groups bucket their members by ABI family; the best member is
+    //    the highest variant at or below the target's, found by descending
+    //    the sorted bucket.
+    //  - kLanguage groups are skipped entirely unless the target's language
+    //    bytes equal the group's.
+    //  - kLinear groups (density groups and anything unclassified) keep the
+    //    original exhaustive scan, which is exact for the density axis.
+    struct GroupIndex {
+        enum Kind {
+            kLinear,
+            kAbi,
+            kLanguage,
+        };
+
+        Kind kind;
+        android::KeyedVector<int, android::Vector<SplitDescription> > abiBuckets;
+        uint32_t languageKey;
+    };
+
+    void buildGroupIndex();
+
     android::Vector<android::SortedVector<SplitDescription> > mGroups;
+    android::Vector<GroupIndex> mGroupIndex;
 };
 
 } // namespace split